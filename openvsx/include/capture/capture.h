@@ -52,6 +52,7 @@
 #include "capture_tcp.h"
 #include "capture_rtmp.h"
 #include "capture_socket.h"
+#include "capture_rcvworker.h"
 #include "capture_dummy.h"
 #include "capture_pkt_rtmp.h"
 #include "capture_appsp.h"
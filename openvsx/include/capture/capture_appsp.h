@@ -65,6 +65,8 @@ typedef struct CAPTURE_CBDATA_SP_H263 {
 
 #define CAPTURE_SP_FLAG_H264_HAVESPS        0x0100
 #define CAPTURE_SP_FLAG_H264_HAVEPPS        0x0200
+#define CAPTURE_SP_FLAG_DIRECTFRAMEQ        0x0400  // frame is assembled in the output queue
+                                                    // write slot instead of tmpFrameBuf
 
 //
 // Callback context for each packet of a processed stream
@@ -113,6 +115,7 @@ typedef struct CAPTURE_CBDATA {
                              // of referring back to STREAMER_CFG_T VID_ENCODER_FBREQUEST_T
   const char *outDir;
   int overWriteOutput;
+  CAPTURE_PROFILE_T *pProfile;
 } CAPTURE_CBDATA_T;
 
 
@@ -37,6 +37,7 @@ typedef struct CAPTURE_STORE_CBDATA {
 
 int capture_cbWriteFile(void *pArg, const void *pData, uint32_t szData);
 int capture_cbWriteBuf(void *pArg, const void *pData, uint32_t szData);
+int capture_cbWriteQueue(void *pArg, const void *pData, uint32_t szData);
 int capture_addCompleteFrameToQ(CAPTURE_CBDATA_SP_T *pSp, uint32_t ts);
 void capture_initCbData(CAPTURE_CBDATA_T *pCbData, const char *outDir, int overWriteOutput);
 void capture_deleteCbData(CAPTURE_CBDATA_T *pCbData);
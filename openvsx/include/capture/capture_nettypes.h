@@ -131,6 +131,8 @@ typedef struct CAPTURE_DESCR_COMMON {
   float                          frtcp_rr_intervalsec;
   int                            rtcp_reply_from_mcast;
   enum CAPTURE_FRAME_DROP_POLICY rtp_frame_drop_policy;
+  unsigned int                   rcvbuf_max;         // SO_RCVBUF growth limit on kernel drops, 0 - off
+  unsigned int                   rcvthreads;         // RTP receive worker threads, 0 - off
   int                            caphighprio;
   int                            xmithighprio;
   int                            caprealtime;
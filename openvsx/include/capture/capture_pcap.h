@@ -33,7 +33,9 @@ typedef int (*PROCESS_NETSAMPLE_DATA)(FILE_STREAM_T *, unsigned char *, unsigned
 
 int cap_pcapStart(const char *iface, const char *outDir, int isFile, 
                       const CAPTURE_FILTER_T filters[], unsigned int numFilters,
-                      int overwriteOut, int promiscuous);
+                      int overwriteOut, int promiscuous, unsigned int ringThreads);
+int cap_pcapBench(const char *path, const CAPTURE_FILTER_T filters[], unsigned int numFilters,
+                  unsigned int loops);
 
 
 #endif // __CAPTURE_PCAPXX_H__
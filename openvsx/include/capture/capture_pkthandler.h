@@ -38,6 +38,13 @@ const CAPTURE_STREAM_T *capture_onUdpSockPkt(CAPTURE_STATE_T *pState,
                                              const struct sockaddr *pSaSrc,
                                              const struct sockaddr *pSaDst,
                                              struct timeval *ptv,
+                                             int rcvDelayUs,
                                              const struct NETIO_SOCK *pnetsock);
 
+int capture_getUdpSockFilterIdx(const CAPTURE_STATE_T *pState,
+                                const unsigned char *pData,
+                                unsigned int len,
+                                const struct sockaddr *pSaSrc,
+                                const struct sockaddr *pSaDst);
+
 #endif // __CAPTURE_PKT_HANDLER_H__
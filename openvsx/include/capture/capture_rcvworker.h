@@ -0,0 +1,104 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+
+#ifndef __CAPTURE_RCVWORKER_H__
+#define __CAPTURE_RCVWORKER_H__
+
+#include "capture_sockettypes.h"
+
+#define CAPTURE_RCVWORKERS_MAX         4
+#define CAPTURE_RCVWORKER_QUEUE_SZ     0x200000
+#define CAPTURE_RCVWORKER_SSRCS_MAX    16
+
+//
+// A received RTP datagram queued for processing on a capture receive worker thread.
+// The record is followed by SOCKET_LIST_PREBUF_SZ bytes of header room and the packet data.
+//
+typedef struct CAPTURE_RCVWORKER_PKT {
+  uint32_t                      szRecord;    // record length including the data, 0 marks a wrap
+  unsigned int                  idxSock;
+  unsigned int                  len;
+  int                           rcvDelayUs;
+  struct timeval                tv;
+  struct sockaddr_storage       saSrc;
+} CAPTURE_RCVWORKER_PKT_T;
+
+#define CAPTURE_RCVWORKER_PKT_DATA(p)  (((unsigned char *) (p)) + sizeof(CAPTURE_RCVWORKER_PKT_T) + \
+                                        SOCKET_LIST_PREBUF_SZ)
+
+typedef void (* CAPTURE_RCVWORKER_CB_ONPKT) (void *pCbData, CAPTURE_RCVWORKER_PKT_T *pPkt);
+
+struct CAPTURE_RCVWORKERS;
+
+//
+// Single producer, single consumer byte ring drained by one worker thread
+//
+typedef struct CAPTURE_RCVWORKER {
+  struct CAPTURE_RCVWORKERS    *pWorkers;
+  unsigned int                  id;
+  unsigned char                *pBuf;
+  unsigned int                  szBuf;
+  unsigned int                  idxWr;       // owned by the producer
+  unsigned int                  idxRd;       // owned by the worker
+  unsigned int                  szUsed;
+  int                           waiting;
+  pthread_cond_t                cond;
+  unsigned int                  numSsrcs;
+  uint64_t                      numPkts;
+  uint64_t                      numDropped;
+  TIME_VAL                      tmLastDropLog;
+} CAPTURE_RCVWORKER_T;
+
+typedef struct CAPTURE_RCVWORKER_SSRC {
+  uint32_t                      ssrc;
+  unsigned int                  idxSock;
+  int                           idxFilter;
+  uint8_t                       idxWorker;
+} CAPTURE_RCVWORKER_SSRC_T;
+
+typedef struct CAPTURE_RCVWORKERS {
+  pthread_mutex_t               mtx;
+  pthread_cond_t                condDone;
+  unsigned int                  numWorkers;
+  unsigned int                  numRunning;
+  int                           shutdown;
+  CAPTURE_RCVWORKER_CB_ONPKT    cbOnPkt;
+  void                         *pCbData;
+  CAPTURE_RCVWORKER_T           workers[CAPTURE_RCVWORKERS_MAX];
+  unsigned int                  numSsrcs;
+  CAPTURE_RCVWORKER_SSRC_T      ssrcs[CAPTURE_RCVWORKER_SSRCS_MAX];
+  char                          tid_tag[LOGUTIL_TAG_LENGTH];
+} CAPTURE_RCVWORKERS_T;
+
+int capture_rcvworkers_start(CAPTURE_RCVWORKERS_T *pWorkers, unsigned int numWorkers,
+                             CAPTURE_RCVWORKER_CB_ONPKT cbOnPkt, void *pCbData);
+void capture_rcvworkers_stop(CAPTURE_RCVWORKERS_T *pWorkers);
+int capture_rcvworkers_enqueue(CAPTURE_RCVWORKERS_T *pWorkers, unsigned int idxSock,
+                               const unsigned char *pData, unsigned int len,
+                               const struct sockaddr_storage *psaSrc, const struct timeval *ptv,
+                               int rcvDelayUs, int idxFilter);
+
+
+#endif // __CAPTURE_RCVWORKER_H__
@@ -73,6 +73,7 @@ CAPTURE_STATE_T *rtp_captureCreate(unsigned int numStreams,
 int rtp_captureFlush(CAPTURE_STATE_T *pState);
 void rtp_capturePrint(const CAPTURE_STATE_T *pState, FILE *fp);
 void rtp_capturePrintLog(const CAPTURE_STATE_T *pState, int logLevel);
+int rtp_captureGetDropStats(const CAPTURE_STATE_T *pState, unsigned int idx, CAPTURE_DROP_STATS_T *pStats);
 int capture_delete_stream(CAPTURE_STATE_T *pState, CAPTURE_STREAM_T *pStream);
 
 
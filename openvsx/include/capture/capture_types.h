@@ -157,12 +157,14 @@ typedef struct COLLECT_STREAM_PKTDATA {
     COLLECT_STREAM_PKTDATA_RTP_T  rtp;
     COLLECT_STREAM_PKTDATA_TCP_T  tcp;
   } u;
-  struct timeval                  tv;
+  struct timeval                  tv;         // arrival time, from the kernel if PKT_FLAGS_RCVTS_KERNEL
   COLLECT_STREAM_PKTPAYLOAD_T     payload;    // packet payload
   int                             flags;
+  uint32_t                        rcvDelayUs; // kernel receive to application dequeue delay
 } COLLECT_STREAM_PKTDATA_T;
 
 #define PKT_FLAGS_DTMF2833                    0x01
+#define PKT_FLAGS_RCVTS_KERNEL                0x02
 
 
 typedef struct COLLECT_STREAM_PKT {
@@ -175,9 +177,6 @@ typedef struct COLLECT_STREAM_PKT {
 #define MAX_FILES_CREATED_PER_CAPTURE            4
 
 
-#define CAPTURE_JTBUF_FLAG_IN_STREAM             1
-#define CAPTURE_JTBUF_FLAG_RX                    2
-
 #define RTP_JTBUF_PKT_BUFSZ_ETH                  1460
 #define RTP_JTBUF_PKT_BUFSZ_LOCAL                12408    // Multiple of mpeg2-ts 188
                                                           // for efficient pktqueue
@@ -210,7 +209,6 @@ typedef struct CAPTURE_JTBUF_PKT_NACK {
 } CAPTURE_JTBUF_PKT_NACK_T;
 
 typedef struct CAPTURE_JTBUF_PKT {
-  int32_t                             rcvFlag;
   COLLECT_STREAM_PKTDATA_T            pktData;
   CAPTURE_JTBUF_PKT_NACK_T            nack;
   CAPTURE_JTBUF_PKTDATA_POOL_ENTRY_T *pPoolBuf;
@@ -218,11 +216,15 @@ typedef struct CAPTURE_JTBUF_PKT {
 
 typedef struct CAPTURE_JTBUF {
 
-  unsigned int idxPkt;        // idx pending packet to be played, which may wait for rx of out-of-order pkts
+  unsigned int idxPkt;        // idx of the last played packet, always (startingSeq & maskPkts)
   unsigned int idxPktStored;  // idx of latest rx packet
-  unsigned int sizePkts;      // max number of elements in pPkts
-  unsigned int startingSeq;
+  unsigned int sizePkts;      // number of elements in pPkts, a power of 2 indexed by (seq & maskPkts)
+  unsigned int maskPkts;
+  unsigned int depthPkts;     // max reorder window, which may be less than sizePkts
+  unsigned int startingSeq;   // seq of the last played packet
+  unsigned int highestSeq;    // highest stored seq, (highestSeq - startingSeq) packets are pending
   unsigned int flushedAll;
+  uint64_t *pRxBitmap;        // bit set for each pPkts element holding a received packet not yet played
   CAPTURE_JTBUF_PKT_T *pPkts;
   CAPTURE_JTBUF_PKTDATA_POOL_T pool;
 } CAPTURE_JTBUF_T;
@@ -456,6 +458,13 @@ typedef struct CAPTURE_STREAM {
   int                      numSeqIncrOk;
   int                      numSeqIncrInvalid;
   unsigned int             numSeqnoNacked;
+  unsigned int             numSeqReordered;     // received behind the highest stored seq
+  unsigned int             maxReorderDepth;     // largest seq distance of a reordered packet
+  unsigned int             numSeqLateDropped;   // received after the seq was played or declared lost
+  unsigned int             numSeqDuplicate;
+  uint64_t                 numRcvDelay;         // packets with a kernel receive timestamp
+  uint64_t                 rcvDelayUsTot;
+  uint32_t                 rcvDelayUsMax;
   unsigned int             frameDeltaHz;
   struct timeval           lastTsChangeTv;
   unsigned int             ts0;
@@ -467,6 +476,7 @@ typedef struct CAPTURE_STREAM {
   int                      fir_send_intervalms;
   int                      appremb_send_intervalms;
   struct CAPTURE_ABR      *pRembAbr;
+  CAPTURE_ABR_T            rembAbr;             // REMB bitrate estimation state of this stream
   // stream start time is stored in hdr.tvStart.tv_sec
   COLLECT_STREAM_HDR_T     hdr;
   CAPTURE_JTBUF_T         *pjtBuf;
@@ -501,6 +511,43 @@ typedef struct CAPTURE_FILTERS {
   CAPTURE_FILTER_T filters[CAPTURE_MAX_FILTERS_PCAP];
 } CAPTURE_FILTERS_T;
 
+//
+// Input loss of a capture socket split by where it occurred
+//
+typedef struct CAPTURE_DROP_STATS {
+  uint64_t      kernelDrops;    // datagrams dropped by the local socket receive queue (SO_RXQ_OVFL)
+  uint64_t      netLoss;        // RTP sequence gaps not accounted for by kernelDrops
+  unsigned int  rcvBufSz;       // current socket receive buffer size
+} CAPTURE_DROP_STATS_T;
+
+//
+// Optional per-stage timing of the capture packet path, collected only when
+// a profile is attached, such as by the pcap replay benchmark
+//
+typedef struct CAPTURE_PROFILE_STAGE {
+  uint64_t      ns;
+  uint64_t      num;
+} CAPTURE_PROFILE_STAGE_T;
+
+typedef struct CAPTURE_PROFILE {
+  CAPTURE_PROFILE_STAGE_T rtp;      // capture_processRtp, including all of the stages below
+  CAPTURE_PROFILE_STAGE_T lookup;   // stream lookup or creation in capture_processRtp
+  CAPTURE_PROFILE_STAGE_T depkt;    // per-codec depacketizer callbacks, including queue insertion
+  CAPTURE_PROFILE_STAGE_T queue;    // complete frame queue insertion
+} CAPTURE_PROFILE_T;
+
+//
+// Counters of CAPTURE_STATE_T which may be updated by multiple receive threads
+//
+#if defined(WIN32)
+#define CAPTURE_STATE_ATOMIC_INC(p)  InterlockedIncrement64((LONGLONG *) (p))
+#else // WIN32
+#define CAPTURE_STATE_ATOMIC_INC(p)  __sync_add_and_fetch((p), 1)
+#endif // WIN32
+
+#define CAPTURE_PROFILE_ADD(stage, tm0)  do { (stage).ns += (timer_GetTimeNs() - (tm0)); \
+                                            (stage).num++; } while(0)
+
 
 //
 // Main reference point for all packet capture
@@ -510,6 +557,10 @@ typedef struct CAPTURE_STATE {
   long long numPkts;                  
   long long numRtpPkts;               
   long long numUdprawPkts;
+  // datagrams dropped by the kernel on receive queue overflow, indexed by capture socket
+  long long numKernelDrops[CAPTURE_MAX_FILTERS_PCAP];
+  // capture socket index of each filter, or -1, used to attribute numKernelDrops to streams
+  int filterSockIdx[CAPTURE_MAX_FILTERS_PCAP];
   //unsigned int numFilters;
   CAPTURE_FILTERS_T filt;
   //CAPTURE_FILTER_T filters[CAPTURE_MAX_FILTERS_PCAP];
@@ -521,7 +572,6 @@ typedef struct CAPTURE_STATE {
   CAPTURE_JTBUF_T jtBufAud;
   CAPTURE_JTBUF_T *pjtBufVid;
   CAPTURE_JTBUF_T *pjtBufAud;
-  CAPTURE_ABR_T   rembAbr;
   pthread_mutex_t mutexStreams;
 
   //
@@ -530,6 +580,8 @@ typedef struct CAPTURE_STATE {
   CAPTURE_CB_ONSTREAMADD     cbOnStreamAdd;
   void *pCbUserData;  // This should always be CAPTURE_CBDATA_T
 
+  CAPTURE_PROFILE_T *pProfile;
+
 } CAPTURE_STATE_T;
 
 
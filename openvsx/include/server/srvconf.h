@@ -38,6 +38,11 @@
 //
 #define SRV_LISTENER_MAX          8 
 
+//
+// Maximum SO_REUSEPORT accept sockets (and accept threads) per listener
+//
+#define SRV_LISTENER_SHARDS_MAX   16
+
 
 #define SRV_CONF_KEY_AVCTHUMB              "thumb"
 #define SRV_CONF_KEY_AVCTHUMBLOG           "thumbLog"
@@ -67,6 +72,8 @@
 #define SRV_CONF_KEY_ALLOWLIST             "allowList"
 #define SRV_CONF_KEY_DENYLIST              "denyList"
 #define SRV_CONF_KEY_STATUSALLOWLIST       "statusAllowList"
+#define SRV_CONF_KEY_RATELIMITIP           "rateLimitIp"
+#define SRV_CONF_KEY_RATELIMITSUBNET       "rateLimitSubnet"
 #define SRV_CONF_KEY_FRAME_THIN            "FrameThin"
 #define SRV_CONF_KEY_OUTQ_PREALLOC         "preallocBuffers"
 #define SRV_CONF_KEY_THREAD_STACKSIZE      "threadStackSize"
@@ -100,6 +107,8 @@
 #define SRV_CONF_KEY_IPADDRHOST            "localHost"
 #define SRV_CONF_KEY_LICFILE               "license"
 #define SRV_CONF_KEY_LISTEN                "listen"
+#define SRV_CONF_KEY_LISTENSHARDS          "listenerShards"
+#define SRV_CONF_KEY_LISTENCPUAFFINITY     "listenerCpuAffinity"
 #define SRV_CONF_KEY_LIVE                  "live"
 #define SRV_CONF_KEY_LIVEMAX               "liveMax"
 #define SRV_CONF_KEY_LIVEPWD               "password"
@@ -127,6 +136,8 @@
 #define SRV_CONF_KEY_RTPMAXPLAYOUTDELAY    "RTPMaxPlayoutDelay"
 #define SRV_CONF_KEY_RTPMAXVIDPLAYOUTDELAY "RTPMaxVideoPlayoutDelay"
 #define SRV_CONF_KEY_RTPMAXAUDPLAYOUTDELAY "RTPMaxAudioPlayoutDelay"
+#define SRV_CONF_KEY_RTPRCVBUFMAX          "RTPCaptureReceiveBufferMax"
+#define SRV_CONF_KEY_RTPRCVTHREADS         "RTPCaptureReceiveThreads"
 
 #define SRV_CONF_KEY_RTCP_RR_INTERVAL       "RTCPReceiverReportInterval"
 #define SRV_CONF_KEY_RTCP_SR_INTERVAL       "RTCPSenderReportInterval"
@@ -150,6 +161,8 @@
 #define SRV_CONF_KEY_DTLSRTPHANDSHAKETMTMS "DTLSRTPHandshakeTimeoutMs"
 #define SRV_CONF_KEY_DTLSRTCPADDITIONALMS  "DTLSRTCPHandshakeAdditionalMs"
 #define SRV_CONF_KEY_DTLSRTCPADDITIONALGIVEUPMS "DTLSRTCPHandshakeAdditionalGiveupMs"
+#define SRV_CONF_KEY_SRTPENCRYPTONCE       "SRTPEncryptOnce"
+#define SRV_CONF_KEY_SRTPXMITTHREADS       "SRTPOutputThreads"
 
 #define SRV_CONF_KEY_STREAMSTATSPATH       "outputStatisticsFile"
 #define SRV_CONF_KEY_STREAMSTATSINTERVALMS "outputStatisticsIntervalMs"
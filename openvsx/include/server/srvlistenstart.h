@@ -34,6 +34,7 @@
 #endif // WIN32
 
 #include "srvcmd.h"
+#include "srvratelimit.h"
 
 typedef enum SRV_ADDR_FILTER_TYPE {
   SRV_ADDR_FILTER_TYPE_ALLOW         = 0x01,
@@ -59,11 +60,16 @@ typedef struct SRV_LISTENER_CFG {
   struct sockaddr_storage         sa;
   NETIO_FLAG_T                    netflags;
   NETIO_SOCK_T                   *pnetsockSrv;
+  unsigned int                    numShards; // number of SO_REUSEPORT accept sockets / threads
+  int                             cpuAffinity; // pin each accept shard thread to a CPU core
+  NETIO_SOCK_T                   *pnetsockShards[SRV_LISTENER_SHARDS_MAX]; // shards [1 .. numShards - 1]
+  volatile int                    shardsRunning; // shard accept threads not yet joined
   POOL_T                         *pConnPool;
   enum URL_CAPABILITY             urlCapabilities;
   struct AUTH_CREDENTIALS_STORE  *pAuthStore;
   const char                     *pAuthTokenId;
   SRV_ADDR_FILTER_T              *pfilters;
+  SRV_RATELIMIT_T                *pRateLimit; // per client IP / subnet admission control
   char                            tid_tag[LOGUTIL_TAG_LENGTH];
   struct SRV_START_CFG           *pCfg;
 } SRV_LISTENER_CFG_T;
@@ -71,6 +77,7 @@ typedef struct SRV_LISTENER_CFG {
 typedef struct SRV_START_CFG {
 
   SRV_LISTENER_CFG_T    listenMedia[SRV_LISTENER_MAX];
+  SRV_RATELIMIT_T       rateLimit;
 
   unsigned int       maxrtp;
   const unsigned int *prtspsessiontimeout;
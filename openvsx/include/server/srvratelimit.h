@@ -0,0 +1,138 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+
+#ifndef __SRV_RATELIMIT_H__
+#define __SRV_RATELIMIT_H__
+
+#include "unixcompat.h"
+#include "pthread_compat.h"
+#include "timers.h"
+
+#ifndef WIN32
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#endif // WIN32
+
+//
+// Number of independently locked partitions of the rate limiter hash table
+//
+#define SRV_RATELIMIT_STRIPES              16
+
+//
+// Number of hash chains (power of 2)
+//
+#define SRV_RATELIMIT_HASH_SIZE            4096
+
+//
+// Maximum number of tracked source address and subnet entries
+//
+#define SRV_RATELIMIT_ENTRIES_MAX          65536 
+
+//
+// An entry without any active connection is reclaimed after this idle time
+//
+#define SRV_RATELIMIT_IDLE_MS              30000
+
+#define SRV_RATELIMIT_SUBNET_PREFIX4_DEFAULT  24
+#define SRV_RATELIMIT_SUBNET_PREFIX6_DEFAULT  64
+
+typedef enum SRV_RATELIMIT_RC {
+  SRV_RATELIMIT_RC_OK                = 0,
+  SRV_RATELIMIT_RC_CONNRATE          = -1,
+  SRV_RATELIMIT_RC_CONCURRENT        = -2,
+  SRV_RATELIMIT_RC_REQRATE           = -3
+} SRV_RATELIMIT_RC_T;
+
+#define SRV_RATELIMIT_RC_STR(rc) ((rc) == SRV_RATELIMIT_RC_CONNRATE ? "connection rate" : \
+                                  (rc) == SRV_RATELIMIT_RC_CONCURRENT ? "concurrent connections" : \
+                                  (rc) == SRV_RATELIMIT_RC_REQRATE ? "request rate" : "ok")
+
+typedef struct SRV_RATELIMIT_LIMITS {
+  unsigned int                  connPerSec;    // new connections per second (0 = unlimited)
+  unsigned int                  maxConcurrent; // concurrent connections (0 = unlimited)
+  unsigned int                  reqPerSec;     // HTTP requests per second (0 = unlimited)
+} SRV_RATELIMIT_LIMITS_T;
+
+typedef struct SRV_RATELIMIT_CFG {
+  SRV_RATELIMIT_LIMITS_T        ip;            // limits per source IP address
+  SRV_RATELIMIT_LIMITS_T        subnet;        // limits per source subnet
+  unsigned int                  subnetPrefix4; // IPv4 subnet mask bits
+  unsigned int                  subnetPrefix6; // IPv6 subnet prefix bits
+} SRV_RATELIMIT_CFG_T;
+
+#define SRV_RATELIMIT_LIMITS_SET(plimits) ((plimits)->connPerSec > 0 || (plimits)->maxConcurrent > 0 || \
+                                           (plimits)->reqPerSec > 0)
+
+typedef struct SRV_RATELIMIT_BUCKET {
+  int64_t                       milliTokens;
+  TIME_VAL                      tvLast;
+} SRV_RATELIMIT_BUCKET_T;
+
+typedef struct SRV_RATELIMIT_ENTRY {
+  int                           isSubnet;
+  sa_family_t                   family;
+  unsigned char                 addr[16];
+  SRV_RATELIMIT_BUCKET_T        conn;
+  SRV_RATELIMIT_BUCKET_T        req;
+  unsigned int                  numConcurrent;
+  TIME_VAL                      tvLastSeen;
+  struct SRV_RATELIMIT_ENTRY   *pnext;
+} SRV_RATELIMIT_ENTRY_T;
+
+typedef struct SRV_RATELIMIT_STRIPE {
+  pthread_mutex_t               mtx;
+  unsigned int                  numEntries;
+} SRV_RATELIMIT_STRIPE_T;
+
+typedef struct SRV_RATELIMIT_STATS {
+  uint64_t                      admitted;
+  uint64_t                      rejectedConnRate;
+  uint64_t                      rejectedConcurrent;
+  uint64_t                      rejectedReqRate;
+  uint64_t                      rejectedSubnet;
+  uint64_t                      tableFull;
+} SRV_RATELIMIT_STATS_T;
+
+typedef struct SRV_RATELIMIT {
+  int                           active;
+  SRV_RATELIMIT_CFG_T           cfg;
+  SRV_RATELIMIT_ENTRY_T       **ppHashTable;
+  SRV_RATELIMIT_STRIPE_T        stripes[SRV_RATELIMIT_STRIPES];
+  pthread_mutex_t               mtxStats;
+  SRV_RATELIMIT_STATS_T         stats;
+} SRV_RATELIMIT_T;
+
+int srv_ratelimit_parse(const char *str, SRV_RATELIMIT_LIMITS_T *pLimits, unsigned int *pPrefix);
+int srv_ratelimit_init(SRV_RATELIMIT_T *pRateLimit, const SRV_RATELIMIT_CFG_T *pCfg);
+void srv_ratelimit_close(SRV_RATELIMIT_T *pRateLimit);
+SRV_RATELIMIT_RC_T srv_ratelimit_onconnect(SRV_RATELIMIT_T *pRateLimit, const struct sockaddr *psa);
+void srv_ratelimit_ondisconnect(SRV_RATELIMIT_T *pRateLimit, const struct sockaddr *psa);
+SRV_RATELIMIT_RC_T srv_ratelimit_onrequest(SRV_RATELIMIT_T *pRateLimit, const struct sockaddr *psa);
+int srv_ratelimit_dump(SRV_RATELIMIT_T *pRateLimit, char *buf, unsigned int szbuf);
+
+
+#endif // __SRV_RATELIMIT_H__
@@ -33,6 +33,8 @@
 #include "stream/stream_srtp.h"
 #include "stream/stream_dtls.h"
 #include "stream/stream_rtcp.h"
+#include "stream/stream_rtpdests.h"
+#include "stream/stream_xmit_srtp.h"
 #include "stream_outfmt.h"
 
 
@@ -193,6 +195,7 @@ typedef struct STREAM_RTP_MULTI {
   STREAM_RTP_DEST_T           *pdests;
   const unsigned int           maxDests;
   unsigned int                 numDests; // number of STREAM_RTP_DEST with .isactive set
+  STREAM_RTP_DESTS_T           destTable; // free slot list, active snapshot and RTCP port index of pdests
   STREAM_RTP_INIT_T            init;
 
   PACKETGEN_PKT_UDP_T          packet;
@@ -217,6 +220,7 @@ typedef struct STREAM_RTP_MULTI {
 
   struct STREAM_RTP_MULTI     *pheadall;
   STREAM_DTLS_CTXT_T           dtls;
+  STREAMXMIT_SRTP_T            xmitSrtp; // SRTP protection of packets fanned out to multiple destinations
   int                          overlappingPorts; // there are overlapping rtp/rtcp ports among multiple 
                                                  // listeners, so inbound rtcp packets may not come back on
                                                  // the same socket it was sent out on.
@@ -0,0 +1,120 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#ifndef __STREAM_RTP_DESTS_H__
+#define __STREAM_RTP_DESTS_H__
+
+#include "unixcompat.h"
+#include "pthread_compat.h"
+
+//
+// Destination table index for STREAM_RTP_MULTI_T::pdests
+//
+// Destination slots are allocated from a free list and the set of active slots is published 
+// as an immutable snapshot.  The packet send loop only iterates the current snapshot and never 
+// takes a lock.  Adding or removing a destination publishes a new snapshot and retires the old 
+// one, which is only freed once all readers which may still reference it have exited.
+//
+// A hash index of each destination's RTCP address and port is used to match incoming RTCP to a 
+// destination.
+//
+
+#if defined(WIN32)
+#define STREAM_RTP_DESTS_ATOMIC_INC(p)     InterlockedIncrement((LONG *) (p))
+#define STREAM_RTP_DESTS_ATOMIC_DEC(p)     InterlockedDecrement((LONG *) (p))
+#define STREAM_RTP_DESTS_BARRIER()         MemoryBarrier()
+#else // WIN32
+#define STREAM_RTP_DESTS_ATOMIC_INC(p)     __sync_add_and_fetch((p), 1)
+#define STREAM_RTP_DESTS_ATOMIC_DEC(p)     __sync_sub_and_fetch((p), 1)
+#define STREAM_RTP_DESTS_BARRIER()         __sync_synchronize()
+#endif // WIN32
+
+typedef struct STREAM_RTP_DESTS_ACTIVE {
+  unsigned int                        numDests;
+  struct STREAM_RTP_DESTS_ACTIVE     *pnext;       // link in the retired list
+  unsigned int                        idxDests[1]; // numDests active pdests indexes
+} STREAM_RTP_DESTS_ACTIVE_T;
+
+typedef struct STREAM_RTP_DESTS_NODE {
+  int                                 inuse;       // slot has been allocated
+  int                                 inhash;
+  uint32_t                            addrKey;     // hashed RTCP address key
+  uint16_t                            port;        // hashed RTCP port (network byte order)
+  int                                 next;        // next slot in hash chain or -1
+  int                                 posActive;   // position in pActiveIdxs or -1
+} STREAM_RTP_DESTS_NODE_T;
+
+typedef struct STREAM_RTP_DESTS {
+  int                                 active;
+  unsigned int                        maxDests;
+
+  //
+  // Writer side state, protected by the owning STREAM_RTP_MULTI_T::mtx
+  //
+  STREAM_RTP_DESTS_NODE_T            *pNodes;
+  unsigned int                       *pFreeIdxs;
+  unsigned int                        numFree;
+  unsigned int                       *pActiveIdxs;
+  unsigned int                        numActive;
+  int                                *pHashBuckets;
+  unsigned int                        hashSize;
+
+  //
+  // Published snapshot read by the send loop
+  //
+  STREAM_RTP_DESTS_ACTIVE_T * volatile pPublished;
+  volatile unsigned int               epoch;
+  volatile int                        readers[2];
+  pthread_mutex_t                     mtxRetired;
+  STREAM_RTP_DESTS_ACTIVE_T          *pRetired;
+} STREAM_RTP_DESTS_T;
+
+int stream_rtpdests_init(STREAM_RTP_DESTS_T *pTable, unsigned int maxDests);
+void stream_rtpdests_close(STREAM_RTP_DESTS_T *pTable);
+
+//
+// Writer functions called with the owning STREAM_RTP_MULTI_T::mtx held
+//
+int stream_rtpdests_alloc(STREAM_RTP_DESTS_T *pTable);
+int stream_rtpdests_release(STREAM_RTP_DESTS_T *pTable, unsigned int idxDest);
+int stream_rtpdests_activate(STREAM_RTP_DESTS_T *pTable, unsigned int idxDest, const struct sockaddr *psaRtcp);
+int stream_rtpdests_deactivate(STREAM_RTP_DESTS_T *pTable, unsigned int idxDest);
+int stream_rtpdests_rehash(STREAM_RTP_DESTS_T *pTable, unsigned int idxDest, const struct sockaddr *psaRtcp);
+int stream_rtpdests_lookup_first(const STREAM_RTP_DESTS_T *pTable, const struct sockaddr *psaRtcp);
+int stream_rtpdests_lookup_next(const STREAM_RTP_DESTS_T *pTable, int idxDest);
+
+//
+// Frees retired snapshots.  Must not be called with STREAM_RTP_MULTI_T::mtx held since it waits
+// for any send loop reader to exit.
+//
+void stream_rtpdests_reclaim(STREAM_RTP_DESTS_T *pTable);
+
+//
+// Reader functions used by the send loop
+//
+const STREAM_RTP_DESTS_ACTIVE_T *stream_rtpdests_read_lock(STREAM_RTP_DESTS_T *pTable, unsigned int *pEpoch);
+void stream_rtpdests_read_unlock(STREAM_RTP_DESTS_T *pTable, unsigned int epoch);
+
+
+#endif // __STREAM_RTP_DESTS_H__
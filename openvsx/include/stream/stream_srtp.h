@@ -83,6 +83,17 @@ int srtp_streamType(const char *streamTypeStr, SRTP_AUTH_TYPE_T *pAuthType, SRTP
 int srtp_createKey(SRTP_CTXT_T *pCtxt);
 int srtp_encryptPacket(const SRTP_CTXT_T *pCtxt, const unsigned char *pIn, unsigned int lenIn,
                        unsigned char *pOut, unsigned int *pLenOut, int rtcp);
+//
+// Returns 1 if the SRTP output of pCtxtSrc for the RTP packet sequence number seq is identical to
+// what pCtxt would produce, allowing the protected packet to be reused.
+//
+int srtp_canShareEncryptedPacket(const SRTP_CTXT_T *pCtxt, const SRTP_CTXT_T *pCtxtSrc, uint16_t seq);
+
+//
+// Advances the output packet index of pCtxt for an RTP packet which was not protected by this
+// context because the output of another context was reused.
+//
+int srtp_skipEncryptPacket(const SRTP_CTXT_T *pCtxt, uint16_t seq);
 int srtp_initOutputStream(SRTP_CTXT_T *pCtxt, uint32_t ssrc, int rtcp);
 int srtp_closeOutputStream(SRTP_CTXT_T *pCtxt);
 
@@ -0,0 +1,95 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#ifndef __STREAM_XMIT_SRTP_H__
+#define __STREAM_XMIT_SRTP_H__
+
+#include "unixcompat.h"
+#include "pthread_compat.h"
+
+//
+// SRTP protection of an RTP packet fanned out to multiple destinations of a STREAM_RTP_MULTI_T
+//
+// Destinations whose SRTP contexts would produce identical output, such as SDES keyed
+// destinations sharing the same key, have the packet protected only once.  Destinations with
+// unique keys, such as DTLS-SRTP, may have their packets protected in parallel by a shared
+// worker pool.  All protection for a packet completes before any destination is sent that 
+// packet, preserving the packet order of each destination.
+//
+
+#define STREAMXMIT_SRTP_THREADS_MAX          16
+#define STREAMXMIT_SRTP_PARALLEL_MIN          4   // min destinations needing protection to use the pool 
+#define STREAMXMIT_SRTP_GROUPS_MAX            8   // max unique shared contexts tracked per packet
+
+typedef struct STREAMXMIT_SRTP_RESULT {
+  uint32_t                      pktId;     // STREAMXMIT_SRTP_T::pktId this result is valid for
+  int                           rc;        // srtp_dtls_protect return code
+  int                           idxSrc;    // destination index which protected the output
+  unsigned int                  idxBuf;    // pBufs slot holding the protected output
+} STREAMXMIT_SRTP_RESULT_T;
+
+typedef struct STREAMXMIT_SRTP {
+  int                           active;    // 0 uninitialized, 1 enabled, -1 disabled
+  int                           encryptOnce;
+  int                           usePool;
+  unsigned int                  maxDests;
+  uint32_t                      pktId;
+  const unsigned char          *pData;     // unprotected packet currently being fanned out
+  unsigned int                  len;
+  STREAMXMIT_SRTP_RESULT_T     *pResults;  // maxDests
+  unsigned char                *pBufs;     // numBufs * STREAMXMIT_SRTP_BUF_SZ protected output
+  unsigned int                  numBufs;   // peak number of destinations requiring protection
+  unsigned int                 *pIdxSrcs;  // destinations requiring protection for the current packet
+  unsigned int                  numSrcs;
+  uint64_t                      numProtected;
+  uint64_t                      numReused;
+  uint64_t                      numParallel;
+} STREAMXMIT_SRTP_T;
+
+struct STREAM_RTP_MULTI;
+struct STREAM_RTP_DEST;
+struct STREAM_RTP_DESTS_ACTIVE;
+
+//
+// Protects the RTP packet for all eligible active destinations prior to the send loop 
+// Destinations with a non-zero pXmitDestRc entry are skipped by the send loop and are not protected
+//
+int streamxmit_srtp_prepare(struct STREAM_RTP_MULTI *pRtp, const struct STREAM_RTP_DESTS_ACTIVE *pActive,
+                            const int *pXmitDestRc, const unsigned char *pData, unsigned int len);
+
+//
+// Invalidates any protected output after the send loop
+//
+void streamxmit_srtp_done(struct STREAM_RTP_MULTI *pRtp);
+
+//
+// Returns 1 and the srtp_dtls_protect result if the packet has already been protected for the destination
+//
+int streamxmit_srtp_lookup(const struct STREAM_RTP_DEST *pDest, const unsigned char *pData, unsigned int len,
+                           int *prc, const unsigned char **ppOut);
+
+void streamxmit_srtp_close(struct STREAM_RTP_MULTI *pRtp);
+
+
+#endif // __STREAM_XMIT_SRTP_H__
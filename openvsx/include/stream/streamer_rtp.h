@@ -85,6 +85,8 @@ typedef struct STREAMER_CFG_RTP {
   uint32_t                      timestamp; // TODO: implement
   DTLS_TIMEOUT_CFG_T            dtlsTimeouts;
   int                           do_setup_turn;
+  int                           srtpEncryptOnce;  // protect once for destinations with identical SRTP contexts
+  unsigned int                  srtpXmitThreads;  // SRTP output protection worker threads
 } STREAMER_CFG_RTP_T;
 
 typedef enum STREAMER_SHARED_STATE {
@@ -102,6 +104,7 @@ typedef struct STREAMER_SHARED_CTXT {
   struct RTCP_NOTIFY_CTXT      *pRtcpNotifyCtxt;  // cfgrtp.rtp_useCaptureSrcPort RTCP notify context from 
                                                   //stream_rtp to capture_socket
   STREAMER_SHARED_STATE_T       state;
+  CAPTURE_DROP_STATS_T          capDrops[2];      // capture socket loss counters published for /status
   pthread_mutex_t               mtxRtcpHdlr;
   TURN_THREAD_CTXT_T            turnThreadCtxt;
 } STREAMER_SHARED_CTXT_T;
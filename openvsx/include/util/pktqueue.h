@@ -121,6 +121,7 @@ typedef struct PKTQUEUE {
   THROUGHPUT_STATS_T *pstats;
   PKTQUEUE_PKT_T     *pkts;
   PKTQUEUE_PKT_T     *pktTmp;
+  PKTQUEUE_PKT_T     *pktWr;          // writer owned staging slot used by writepktdirect
   int                 ownTmpPkt;
   pthread_mutex_t     mtx;  
   pthread_mutex_t     mtxRd;  
@@ -176,6 +177,10 @@ void pktqueue_setrdr(PKTQUEUE_T *pQ, int force);
 enum PKTQUEUE_RC pktqueue_addpartialpkt(PKTQUEUE_T *pQ, const unsigned char *pData, 
                                         unsigned int len, PKTQ_EXTRADATA_T *pXtra, 
                                         int endingPkt, int overwrite);
+unsigned char *pktqueue_writepktdirect(PKTQUEUE_T *pQ, unsigned int len);
+unsigned int pktqueue_writepktdirect_len(const PKTQUEUE_T *pQ);
+void pktqueue_writepktdirect_abort(PKTQUEUE_T *pQ);
+enum PKTQUEUE_RC pktqueue_writepktdirect_done(PKTQUEUE_T *pQ, PKTQ_EXTRADATA_T *pXtra, int keyframe);
 const PKTQUEUE_PKT_T *pktqueue_readpktdirect(PKTQUEUE_T *pQ);
 int pktqueue_readpktdirect_havenext(PKTQUEUE_T *pQ);
 int pktqueue_readpktdirect_done(PKTQUEUE_T *pQ);
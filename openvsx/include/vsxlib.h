@@ -197,6 +197,30 @@ typedef struct MIXER_CFG {
     */
   int highPriority;
 
+  /**
+    *
+    * Set to > 0 to run the conference on a shared pool of this many mixer
+    * worker threads driven by a single tick scheduler, instead of dedicated
+    * mixer and participant output threads.
+    *
+    */
+  int schedulerWorkers;
+
+  /**
+    *
+    * Set to > 0 to only mix the top N active speakers.  Listeners which are not
+    * an active speaker all receive the same common mix.
+    *
+    */
+  int maxSpeakers;
+
+  /**
+    *
+    * Minimum duration in ms that a selected active speaker remains selected
+    *
+    */
+  int speakerHoldMs;
+
   /**
     *
     * Set to 1 to include each mixer source audio in the output
@@ -917,6 +941,23 @@ typedef struct VSXLIB_STREAM_PARAMS {
    */
    SRTP_CFG_T srtpCfgs[IXCODE_VIDEO_OUT_MAX];
 
+  /**
+   *
+   * SRTP protect an output packet only once for all destinations sharing
+   * identical SRTP keying, such as SDES keyed destinations.
+   *
+   */
+  int srtpEncryptOnce;
+
+  /**
+   *
+   * Number of worker threads used to SRTP protect output packets in parallel
+   * when an output has multiple uniquely keyed destinations, such as DTLS-SRTP.
+   * 0 protects all packets on the streamer thread.
+   *
+   */
+  unsigned int srtpXmitThreads;
+
   /**
    *
    * Transcoder configuration parameters
@@ -1095,6 +1136,22 @@ typedef struct VSXLIB_STREAM_PARAMS {
    */
   unsigned int httpmax;
 
+  /**
+   *
+   * Number of SO_REUSEPORT listening sockets, each with its own accept thread,
+   * opened for every media server listening address and port.
+   * 0 or 1 uses a single listening socket.
+   *
+   */
+  unsigned int listenershards;
+
+  /**
+   *
+   * Pin each listener accept thread to a CPU core when using listenershards
+   *
+   */
+  int listenercpuaffinity;
+
   /**
    *
    * HTTP tslive server listening address and port string
@@ -1450,6 +1507,25 @@ typedef struct VSXLIB_STREAM_PARAMS {
    */
   const char *statusallowlist;
 
+  /**
+   *
+   * Per source IP address admission control of incoming server connections.
+   * CSV of 'conn=<new connections per second>,concurrent=<max connections>,
+   * req=<HTTP requests per second>'.  A value of 0 or an omitted element is 
+   * unlimited.
+   *
+   */
+  const char *ratelimitip;
+
+  /**
+   *
+   * Per source subnet admission control of incoming server connections.
+   * Same format as ratelimitip with an optional 'prefix=<mask bits>' element
+   * (default /24 for IPv4, /64 for IPv6).
+   *
+   */
+  const char *ratelimitsubnet;
+
   /**
    *
    * SSL certificate path
@@ -1782,6 +1858,35 @@ typedef struct VSXLIB_STREAM_PARAMS {
    */
   int capture_rtp_frame_drop_policy;
 
+  /**
+   *
+   * Upper limit in bytes to which the RTP capture socket receive buffer (SO_RCVBUF)
+   * may be grown when the kernel reports datagrams dropped due to receive queue
+   * overflow.  0 (default) keeps the receive buffer size fixed.
+   *
+   */
+  unsigned int capture_rcvbuf_max;
+
+  /**
+   *
+   * Number of capture receive worker threads used to process received RTP packets
+   * off the socket reader thread.  Each RTP stream (SSRC) is processed by a single
+   * worker, preserving packet order.  0 (default) processes packets on the socket 
+   * reader thread.  When capturing from a network interface this is the number of
+   * capture ring threads sharing the interface through a hashed packet fanout group.
+   *
+   */
+  unsigned int capture_rcvthreads;
+
+  /**
+   *
+   * Number of passes of the pcap replay benchmark.  When non-zero, a pcap capture
+   * file input is fed through the capture pipeline as fast as possible and 
+   * throughput, per-stage timing and allocation counts are reported.
+   *
+   */
+  unsigned int capture_bench;
+
   /**
     *
     * FIR (Full Intra Request) RTCP configuration
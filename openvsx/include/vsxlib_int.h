@@ -158,6 +158,7 @@ int vsxlib_ssl_initclient(NETIO_SOCK_T *pnetsock);
 void vsxlib_closeaddrfilter(struct SRV_ADDR_FILTER **ppAddrFilter);
 int vsxlib_parseaddrfilters(struct SRV_LISTENER_CFG *pListenerCfg, const char *acceptList, 
                             const char *denyList, const char *statusUrlList);
+int vsxlib_initratelimit(SRV_RATELIMIT_T *pRateLimit, const VSXLIB_STREAM_PARAMS_T *pParams);
 int vsxlib_matchaddrfilters(const SRV_ADDR_FILTER_T *pAddrFilters, const struct sockaddr *psa,
                             SRV_ADDR_FILTER_TYPE_T type);
 //int vsxlib_init_srtp(STREAMER_DEST_CFG_T *pdestsCfg, unsigned int numChannels, const SRTP_CFG_T *pSrtpCfg);
@@ -74,6 +74,7 @@ enum XCODE_CFG_ENABLED {
   XCODE_CFG_IPC_RUNNING       = 3
 };
 enum XCODE_CFG_ENABLED xcode_enabled(int printerror);
+int xcode_benchmark(const char *path);
 
 
 #endif // __XCODE_ALLH__
@@ -31,6 +31,11 @@
 #define CHAR_PRINTABLE(c) ((c) >= 32 && (c) < 127)
 #define CHAR_NUMERIC(c) ((c) >= '0' && (c) <= '9')
 
+typedef struct AVC_MEM_STATS {
+  unsigned long long numAllocs;   // successful avc_calloc / avc_realloc / avc_recalloc calls
+  unsigned long long numFrees;    // avc_free calls releasing memory
+} AVC_MEM_STATS_T;
+
 int avc_istextchar(const unsigned char c); // replacement for isascii
 int avc_strip_nl(char *str, size_t sz, int stripws);
 char *avc_dequote(const char *p, char *buf, unsigned int szbuf);
@@ -38,6 +43,8 @@ void *avc_calloc(size_t count, size_t size);
 void *avc_realloc(void *porig, size_t size);
 void *avc_recalloc(void *porig, size_t size, size_t size_orig);
 void avc_free(void **pp);
+void avc_enableMemStats(int enable);
+void avc_getMemStats(AVC_MEM_STATS_T *pStats);
 void avc_dumpHex(void *fp, const unsigned char *buf, unsigned int len, int ascii);
 const char *avc_getPrintableDuration(unsigned long long duration, unsigned int timescale);
 const unsigned char *avc_binstrstr(const unsigned char *buf,
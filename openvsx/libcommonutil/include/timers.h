@@ -54,6 +54,7 @@ typedef long long TIME_VAL;
 
 
 TIME_VAL timer_GetTime();
+TIME_VAL timer_GetTimeNs();
 int timer_calibrateTimers();
 int timer_getPreciseTime(struct timeval *ptv);
 
@@ -28,6 +28,19 @@
 #include "commonutil.h"
 #include "vsx_dbg.h"
 
+//
+// Allocation counting is off unless enabled through avc_enableMemStats, so the allocators
+// only pay for a plain flag check
+//
+#if defined(__GNUC__)
+#define AVC_MEM_STATS_INC(n)  do { if(g_avc_memstats_enabled) { \
+                                     __sync_fetch_and_add(&(n), 1); } } while(0)
+#else // __GNUC__
+#define AVC_MEM_STATS_INC(n)  do { if(g_avc_memstats_enabled) { (n)++; } } while(0)
+#endif // __GNUC__
+
+static int g_avc_memstats_enabled;
+static AVC_MEM_STATS_T g_avc_memstats;
 
 int avc_isnumeric(const char *s) {
 
@@ -51,6 +64,8 @@ void *avc_calloc(size_t count, size_t size) {
 
   if((p = calloc(count, size)) == NULL) {
     LOG(X_CRITICAL("Failed to calloc %d x %d"), count, size);
+  } else {
+    AVC_MEM_STATS_INC(g_avc_memstats.numAllocs);
   }
 
   VSX_DEBUG_MEM( LOG(X_DEBUG("MEM - avc_calloc %d x %d = %d at 0x%x"), count, size, count * size, p); );
@@ -66,6 +81,8 @@ void *avc_realloc(void *porig, size_t size) {
     return NULL;
   }
 
+  AVC_MEM_STATS_INC(g_avc_memstats.numAllocs);
+
   VSX_DEBUG_MEM( LOG(X_DEBUG("MEM - avc_realloc 0x%x, %d now at 0x%x"), porig, size, p); );
 
   return p;
@@ -103,6 +120,18 @@ void avc_free(void **pp) {
     VSX_DEBUG_MEM( LOG(X_DEBUG("MEM - avc_free at 0x%x"), *pp); );
     free(*pp);
     *pp = NULL;
+    AVC_MEM_STATS_INC(g_avc_memstats.numFrees);
+  }
+}
+
+void avc_enableMemStats(int enable) {
+  g_avc_memstats_enabled = enable;
+}
+
+void avc_getMemStats(AVC_MEM_STATS_T *pStats) {
+  if(pStats) {
+    pStats->numAllocs = g_avc_memstats.numAllocs;
+    pStats->numFrees = g_avc_memstats.numFrees;
   }
 }
 
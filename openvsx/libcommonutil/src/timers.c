@@ -50,6 +50,21 @@ TIME_VAL timer_GetTime() {
   return return_val;
 }
 
+TIME_VAL timer_GetTimeNs() {
+  static LARGE_INTEGER freq;
+  LARGE_INTEGER time;
+
+  if(freq.QuadPart == 0) {
+    QueryPerformanceFrequency(&freq);
+  }
+
+  if(freq.QuadPart > 0 && QueryPerformanceCounter(&time) != 0) {
+    return (TIME_VAL)( (double)time.QuadPart * 1000000000.0 / (double)freq.QuadPart);
+  }
+
+  return 0;
+}
+
 
 int timer_calibrateTimers() {
 
@@ -153,6 +168,7 @@ int timer_getPreciseTime(struct timeval *ptv) {
 
 #else
 #include <sys/time.h>
+#include <time.h>
 
 TIME_VAL timer_GetTime() {
   struct timeval tv;
@@ -160,6 +176,15 @@ TIME_VAL timer_GetTime() {
   return ((TIME_VAL)tv.tv_sec * TIME_VAL_US) + tv.tv_usec;
 }
 
+//
+// Monotonic nanosecond clock for interval measurement, not wall clock time
+//
+TIME_VAL timer_GetTimeNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((TIME_VAL)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
 int timer_calibrateTimers() {
   return 0;
 }
@@ -28,13 +28,38 @@
 #include "pktcommon.h"
 #include "pthread_compat.h"
 
+#if defined(__linux__)
+//
+// AF_PACKET TPACKET_V3 mmap ring capture backend for live interfaces
+//
+#define PKTCAPTURE_HAVE_RING                 1
+#endif // __linux__
+
+#define PKTCAPTURE_RING_THREADS_MAX          8
+#define PKTCAPTURE_RING_BLOCK_SZ             (1 << 20)
+#define PKTCAPTURE_RING_BLOCKS               32
+#define PKTCAPTURE_RING_BLOCK_TMO_MS         10
+#define PKTCAPTURE_SNAPLEN_DEFAULT           0xffff
+
+#define PKTCAPTURE_SNAPLEN(p)  ((p)->snaplen > 0 ? (p)->snaplen : PKTCAPTURE_SNAPLEN_DEFAULT)
+
 typedef void (*CAPTURE_PKT_HANDLER) (unsigned char *pArg, 
                                      const struct pcap_pkthdr *pkthdr, 
                                      const unsigned char *packet) ;
+
+typedef struct PCAP_CAPTURE_RING_STATS {
+  unsigned long long packets;          // packets seen by the kernel, including drops
+  unsigned long long drops;            // packets dropped because the ring was full
+  unsigned long long freezes;          // number of times the ring queue was frozen
+  unsigned long long blocks;           // ring blocks handed to the packet handler
+  unsigned int numThreads;
+} PCAP_CAPTURE_RING_STATS_T;
+
 typedef struct PCAP_CAPTURE_PROPERTIES {
   CAPTURE_PKT_HANDLER pktHandler;
   const char *iface;
   int promiscuous;
+  unsigned int snaplen; // bytes captured per packet, 0 for PKTCAPTURE_SNAPLEN_DEFAULT
   void *userCbData;
 
   void *pcap_fp;
@@ -45,6 +70,18 @@ typedef struct PCAP_CAPTURE_PROPERTIES {
   int is_running; // should be atomic_t
   pthread_t capture_thread;
   pthread_attr_t capture_attr;
+
+  //
+  // When use_ring is set, live interface capture uses the TPACKET_V3 ring
+  // instead of pcap_loop.  ring_threads > 1 spreads flows across capture
+  // threads with PACKET_FANOUT_HASH.  Calls to pktHandler are still serialized,
+  // and any one flow is always delivered on the same thread.
+  //
+  int use_ring;
+  unsigned int ring_threads;
+  void *pRing;
+  PCAP_CAPTURE_RING_STATS_T ringStats;
+
 #ifndef DISABLE_PCAP
   unsigned char bpfProg[32];
 #endif // DISABLE_PCAP
@@ -63,6 +100,7 @@ struct pcap_stat *capture_GetStats(PCAP_CAPTURE_PROPERTIES_T *p);
 const char *capture_GetInterface(PCAP_CAPTURE_PROPERTIES_T *p);
 void *capture_GetPcap(PCAP_CAPTURE_PROPERTIES_T *p);
 int capture_IsRunning(PCAP_CAPTURE_PROPERTIES_T *p);
+void capture_Close(PCAP_CAPTURE_PROPERTIES_T *p);
 
 
 
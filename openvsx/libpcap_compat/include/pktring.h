@@ -0,0 +1,41 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#ifndef __PACKET_RING_H__
+#define __PACKET_RING_H__
+
+#include "pktcapture.h"
+
+#if defined(PKTCAPTURE_HAVE_RING)
+
+int pktring_Open(PCAP_CAPTURE_PROPERTIES_T *p);
+int pktring_Run(PCAP_CAPTURE_PROPERTIES_T *p);
+int pktring_Stop(PCAP_CAPTURE_PROPERTIES_T *p);
+int pktring_GetStats(PCAP_CAPTURE_PROPERTIES_T *p, PCAP_CAPTURE_RING_STATS_T *pStats);
+void pktring_Close(PCAP_CAPTURE_PROPERTIES_T *p);
+void pktring_Free(PCAP_CAPTURE_PROPERTIES_T *p);
+
+#endif // PKTCAPTURE_HAVE_RING
+
+#endif // __PACKET_RING_H__
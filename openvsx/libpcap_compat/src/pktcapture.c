@@ -37,9 +37,10 @@
 #include "logutil.h"
 #include "pktcapture.h"
 #include "pktcommon.h"
+#include "pktring.h"
 
 
-#ifdef DISABLE_PCAP
+#if defined(DISABLE_PCAP) && !defined(PKTCAPTURE_HAVE_RING)
 
 int capture_Start(PCAP_CAPTURE_PROPERTIES_T *p) {
   return -1;
@@ -69,12 +70,16 @@ void *capture_GetPcap(PCAP_CAPTURE_PROPERTIES_T *p) {
 int capture_IsRunning(PCAP_CAPTURE_PROPERTIES_T *p) {
   return 0;
 }
+void capture_Close(PCAP_CAPTURE_PROPERTIES_T *p) {
+}
 
 
 #else // DISABLE_PCAP
 
 //static PCAP_CAPTURE_PROPERTIES_T g_pcapProps;
 
+#ifndef DISABLE_PCAP
+
 static int capture_close(PCAP_CAPTURE_PROPERTIES_T *p) {
 
   if(p->pcap_fp) {
@@ -124,7 +129,7 @@ static int capture_init(PCAP_CAPTURE_PROPERTIES_T *p) {
   if(p->open_dev) {
 
     if ((p->pcap_fp = pcap_open_live(p->device,	
-                  0xffff, // size
+                  PKTCAPTURE_SNAPLEN(p), // size
                   p->promiscuous,
                   1000,	 // read timeout
                   errbuf // error buffer
@@ -167,11 +172,38 @@ static int capture_init(PCAP_CAPTURE_PROPERTIES_T *p) {
 	return 0;
 }
 
+#endif // DISABLE_PCAP
+
+#if defined(PKTCAPTURE_HAVE_RING)
+
+static int captureRingProc(PCAP_CAPTURE_PROPERTIES_T *p) {
+
+  LOG(X_DEBUG("Capture ring thread starting"));
+
+  if(pktring_Open(p) != 0) {
+    pktring_Free(p);
+    return -1;
+  }
+
+  p->open_dev_rc = 1;
+
+  pktring_Run(p);
+
+  pktring_Close(p);
+  LOG(X_DEBUG("Capture ring thread ending"));
+  p->is_running = 0;
+
+  return 0;
+}
+
+#endif // PKTCAPTURE_HAVE_RING
+
 
 
 static void *captureProc(void *arg) {
 
   PCAP_CAPTURE_PROPERTIES_T *p = (PCAP_CAPTURE_PROPERTIES_T *) arg;
+#ifndef DISABLE_PCAP
   struct pcap_pkthdr *pPkthdr = NULL;
   unsigned char *packet = NULL;
   unsigned int pktCnt = 0u;
@@ -181,6 +213,28 @@ static void *captureProc(void *arg) {
   struct pcap_pkthdr pktHdr;
   pPkthdr = &pktHdr;
 #endif // WIN32
+#endif // DISABLE_PCAP
+
+#if defined(PKTCAPTURE_HAVE_RING)
+  if(p->open_dev && p->use_ring) {
+    if(captureRingProc(p) == 0) {
+      return NULL;
+    }
+#ifndef DISABLE_PCAP
+    LOG(X_WARNING("Unable to use capture ring on '%s', falling back to pcap"), p->device);
+#endif // DISABLE_PCAP
+  }
+#endif // PKTCAPTURE_HAVE_RING
+
+#ifdef DISABLE_PCAP
+
+  if(!p->open_dev || !p->use_ring) {
+    LOG(X_ERROR("Capture of '%s' requires pcap support"), p->device);
+  }
+  p->open_dev_rc = -1;
+  p->is_running = 0;
+
+#else // DISABLE_PCAP
 
   LOG(X_DEBUG("Capture thread starting"));
 
@@ -231,6 +285,8 @@ static void *captureProc(void *arg) {
   LOG(X_DEBUG("Capture thread ending after reading %u packets"), pktCnt);
   p->is_running = 0;
 
+#endif // DISABLE_PCAP
+
   return NULL;
 }
 
@@ -286,6 +342,26 @@ struct pcap_stat *capture_GetStats(PCAP_CAPTURE_PROPERTIES_T *p) {
     return &stat;
   }
 
+#if defined(PKTCAPTURE_HAVE_RING)
+  if(p->pRing) {
+
+    //
+    // Ring drop and freeze counters are also kept in ringStats 
+    //
+    if(pktring_GetStats(p, &p->ringStats) != 0) {
+      return NULL;
+    }
+    stat.ps_recv = (unsigned int) p->ringStats.packets;
+    stat.ps_drop = (unsigned int) p->ringStats.drops;
+    stat.ps_ifdrop = 0;
+    return &stat;
+  }
+#endif // PKTCAPTURE_HAVE_RING
+
+#ifdef DISABLE_PCAP
+  return NULL;
+#else // DISABLE_PCAP
+
   if(p->pcap_fp == NULL) {
     return NULL;
   }
@@ -295,6 +371,7 @@ struct pcap_stat *capture_GetStats(PCAP_CAPTURE_PROPERTIES_T *p) {
   }
 
   return &stat;
+#endif // DISABLE_PCAP
 }
 
 int capture_Start(PCAP_CAPTURE_PROPERTIES_T *p) {
@@ -349,6 +426,12 @@ int capture_Start(PCAP_CAPTURE_PROPERTIES_T *p) {
 
 int capture_Stop(PCAP_CAPTURE_PROPERTIES_T *p) {
 
+#if defined(PKTCAPTURE_HAVE_RING)
+  if(p->pRing) {
+    return pktring_Stop(p);
+  }
+#endif // PKTCAPTURE_HAVE_RING
+
 #ifdef WIN32
   pcap_breakloop((pcap_t *) p->pcap_fp);
 #endif // WIN32
@@ -364,4 +447,12 @@ int capture_IsRunning(PCAP_CAPTURE_PROPERTIES_T *p) {
   return p->is_running;
 }
 
+void capture_Close(PCAP_CAPTURE_PROPERTIES_T *p) {
+
+#if defined(PKTCAPTURE_HAVE_RING)
+  pktring_Free(p);
+#endif // PKTCAPTURE_HAVE_RING
+
+}
+
 #endif // DISABLE_PCAP
@@ -0,0 +1,558 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#include <stdio.h>
+#include "unixcompat.h"
+#include "pthread_compat.h"
+#include "pcap_compat.h"
+#include "logutil.h"
+#include "pktcapture.h"
+#include "pktring.h"
+
+#if defined(PKTCAPTURE_HAVE_RING)
+
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/filter.h>
+
+#define PKTRING_POLL_TMO_MS          200
+
+typedef struct PKTRING_SOCK {
+  int                       fd;
+  unsigned char            *pMap;
+  size_t                    mapSz;
+  unsigned int              idxBlock;
+  unsigned long long        blocks;
+  pthread_t                 tid;
+  int                       haveThread;
+  struct PKTRING           *pRing;
+} PKTRING_SOCK_T;
+
+typedef struct PKTRING {
+  PKTRING_SOCK_T            socks[PKTCAPTURE_RING_THREADS_MAX];
+  unsigned int              numSocks;
+  unsigned int              blockSz;
+  unsigned int              numBlocks;
+  unsigned int              snaplen;
+  volatile int              doExit;
+  pthread_mutex_t           mtx;
+  pthread_mutex_t           mtxHandler;  // serializes pktHandler across fanout threads
+  PCAP_CAPTURE_RING_STATS_T stats;  // accumulated PACKET_STATISTICS, which reset on every read
+  struct sock_fprog         fprog;
+  CAPTURE_PKT_HANDLER       pktHandler;
+  void                     *userCbData;
+} PKTRING_T;
+
+//
+// The kernel copies the length returned by the socket filter, so a snaplen below the
+// default still needs a program to truncate the captured packets when nothing is filtered
+//
+static int ring_snaplenfilter(unsigned int snaplen, struct sock_fprog *pfprog) {
+  struct sock_filter insns[] = {
+    BPF_STMT(BPF_RET | BPF_K,             snaplen)
+  };
+
+  if(snaplen >= PKTCAPTURE_SNAPLEN_DEFAULT) {
+    return 0;
+  }
+
+  if(!(pfprog->filter = (struct sock_filter *) malloc(sizeof(insns)))) {
+    return -1;
+  }
+  memcpy(pfprog->filter, insns, sizeof(insns));
+  pfprog->len = sizeof(insns) / sizeof(insns[0]);
+
+  return 0;
+}
+
+#ifdef DISABLE_PCAP
+
+static int ring_compilefilter_builtin(const char *filter, unsigned int snaplen, 
+                                      struct sock_fprog *pfprog) {
+  unsigned int proto = 0;
+
+  //
+  // Without libpcap only the transport filters used by the capture layer are
+  // understood.  The program accepts IPv4 or IPv6 (no extension headers) frames
+  // carrying the given protocol.
+  //
+  if(!strcmp(filter, "udp")) {
+    proto = IPPROTO_UDP;
+  } else if(!strcmp(filter, "tcp")) {
+    proto = IPPROTO_TCP;
+  } else {
+    LOG(X_WARNING("Capture ring filter '%s' not supported without pcap.  Capturing unfiltered."), filter);
+    return ring_snaplenfilter(snaplen, pfprog);
+  }
+
+  {
+    struct sock_filter insns[] = {
+      BPF_STMT(BPF_LD  | BPF_H   | BPF_ABS, 12),                // ethertype
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   ETH_P_IPV6, 0, 2),
+      BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, 20),                // ip6_nxt
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   proto, 3, 4),
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   ETH_P_IP, 0, 3),
+      BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, 23),                // ip_p
+      BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   proto, 0, 1),
+      BPF_STMT(BPF_RET | BPF_K,             snaplen),
+      BPF_STMT(BPF_RET | BPF_K,             0)
+    };
+
+    if(!(pfprog->filter = (struct sock_filter *) malloc(sizeof(insns)))) {
+      return -1;
+    }
+    memcpy(pfprog->filter, insns, sizeof(insns));
+    pfprog->len = sizeof(insns) / sizeof(insns[0]);
+  }
+
+  return 0;
+}
+
+#endif // DISABLE_PCAP
+
+static int ring_compilefilter(const char *device, const char *filter, unsigned int snaplen,
+                              struct sock_fprog *pfprog) {
+#ifndef DISABLE_PCAP
+  pcap_t *pdead;
+  struct bpf_program bpfProg;
+#endif // DISABLE_PCAP
+
+  pfprog->filter = NULL;
+  pfprog->len = 0;
+
+  if(filter[0] == '\0') {
+    return ring_snaplenfilter(snaplen, pfprog);
+  }
+
+#ifndef DISABLE_PCAP
+
+  if(!(pdead = pcap_open_dead(DLT_EN10MB, snaplen))) {
+    return -1;
+  }
+
+  if(pcap_compile(pdead, &bpfProg, filter, 1, 0xffffffff) == -1) {
+    LOG(X_ERROR("Unable to compile filter '%s' for '%s'"), filter, device);
+    pcap_close(pdead);
+    return -1;
+  }
+
+  //
+  // struct bpf_insn and struct sock_filter share the classic BPF layout
+  //
+  if((pfprog->filter = (struct sock_filter *) malloc(bpfProg.bf_len * sizeof(struct sock_filter)))) {
+    memcpy(pfprog->filter, bpfProg.bf_insns, bpfProg.bf_len * sizeof(struct sock_filter));
+    pfprog->len = bpfProg.bf_len;
+  }
+
+  pcap_freecode(&bpfProg);
+  pcap_close(pdead);
+
+  return pfprog->filter ? 0 : -1;
+
+#else // DISABLE_PCAP
+
+  return ring_compilefilter_builtin(filter, snaplen, pfprog);
+
+#endif // DISABLE_PCAP
+}
+
+static void ring_closesock(PKTRING_SOCK_T *pSock) {
+
+  if(pSock->pMap && pSock->pMap != MAP_FAILED) {
+    munmap(pSock->pMap, pSock->mapSz);
+  }
+  pSock->pMap = NULL;
+
+  if(pSock->fd >= 0) {
+    close(pSock->fd);
+    pSock->fd = -1;
+  }
+}
+
+static int ring_opensock(PKTRING_T *pRing, PKTRING_SOCK_T *pSock, const PCAP_CAPTURE_PROPERTIES_T *p,
+                         int ifindex, int fanoutId) {
+  int val;
+  struct tpacket_req3 req;
+  struct sockaddr_ll sall;
+  struct packet_mreq mreq;
+
+  pSock->pRing = pRing;
+  pSock->idxBlock = 0;
+
+  if((pSock->fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL))) < 0) {
+    LOG(X_ERROR("Unable to create packet socket for '%s': %s"), p->device, strerror(errno));
+    return -1;
+  }
+
+  val = TPACKET_V3;
+  if(setsockopt(pSock->fd, SOL_PACKET, PACKET_VERSION, &val, sizeof(val)) != 0) {
+    LOG(X_ERROR("Unable to set TPACKET_V3 for '%s': %s"), p->device, strerror(errno));
+    return -1;
+  }
+
+  //
+  // Attach the filter before the ring is bound so that no unfiltered packets are queued
+  //
+  if(pRing->fprog.filter &&
+     setsockopt(pSock->fd, SOL_SOCKET, SO_ATTACH_FILTER, &pRing->fprog, sizeof(pRing->fprog)) != 0) {
+    LOG(X_ERROR("Unable to attach filter '%s' for '%s': %s"), p->filter, p->device, strerror(errno));
+    return -1;
+  }
+
+  memset(&req, 0, sizeof(req));
+  req.tp_block_size = pRing->blockSz;
+  req.tp_block_nr = pRing->numBlocks;
+  req.tp_frame_size = TPACKET_ALIGN(TPACKET_ALIGN(TPACKET3_HDRLEN) + 16 + pRing->snaplen);
+  req.tp_frame_nr = (req.tp_block_size / req.tp_frame_size) * req.tp_block_nr;
+  req.tp_retire_blk_tov = PKTCAPTURE_RING_BLOCK_TMO_MS;
+
+  if(setsockopt(pSock->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) != 0) {
+    LOG(X_ERROR("Unable to create %u x %u capture ring for '%s': %s"), 
+                req.tp_block_nr, req.tp_block_size, p->device, strerror(errno));
+    return -1;
+  }
+
+  pSock->mapSz = (size_t) req.tp_block_size * req.tp_block_nr;
+  if((pSock->pMap = mmap(NULL, pSock->mapSz, PROT_READ | PROT_WRITE, MAP_SHARED, 
+                         pSock->fd, 0)) == MAP_FAILED) {
+    pSock->pMap = NULL;
+    LOG(X_ERROR("Unable to map %u bytes capture ring for '%s': %s"), 
+                (unsigned int) pSock->mapSz, p->device, strerror(errno));
+    return -1;
+  }
+
+  memset(&sall, 0, sizeof(sall));
+  sall.sll_family = AF_PACKET;
+  sall.sll_protocol = htons(ETH_P_ALL);
+  sall.sll_ifindex = ifindex;
+
+  if(bind(pSock->fd, (struct sockaddr *) &sall, sizeof(sall)) != 0) {
+    LOG(X_ERROR("Unable to bind capture ring to '%s': %s"), p->device, strerror(errno));
+    return -1;
+  }
+
+  //
+  // Promiscuous membership is dropped by the kernel when the socket is closed
+  //
+  if(p->promiscuous) {
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.mr_ifindex = ifindex;
+    mreq.mr_type = PACKET_MR_PROMISC;
+    if(setsockopt(pSock->fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+      LOG(X_WARNING("Unable to set promiscuous mode on '%s': %s"), p->device, strerror(errno));
+    }
+  }
+
+  if(fanoutId >= 0) {
+    val = (fanoutId & 0xffff) | ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16);
+    if(setsockopt(pSock->fd, SOL_PACKET, PACKET_FANOUT, &val, sizeof(val)) != 0) {
+      LOG(X_ERROR("Unable to join capture fanout group 0x%x on '%s': %s"), 
+                  fanoutId, p->device, strerror(errno));
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static void ring_readstats(PKTRING_T *pRing) {
+  unsigned int idx;
+  struct tpacket_stats_v3 st;
+  socklen_t len;
+
+  //
+  // The kernel resets the counters on each read, tp_packets already includes tp_drops
+  //
+  for(idx = 0; idx < pRing->numSocks; idx++) {
+    if(pRing->socks[idx].fd < 0) {
+      continue;
+    }
+    len = sizeof(st);
+    memset(&st, 0, sizeof(st));
+    if(getsockopt(pRing->socks[idx].fd, SOL_PACKET, PACKET_STATISTICS, &st, &len) == 0) {
+      pRing->stats.packets += st.tp_packets;
+      pRing->stats.drops += st.tp_drops;
+      pRing->stats.freezes += st.tp_freeze_q_cnt;
+    }
+  }
+
+}
+
+static void ring_procblock(PKTRING_T *pRing, struct tpacket_block_desc *pbd) {
+  struct tpacket3_hdr *ppd;
+  struct pcap_pkthdr pkthdr;
+  unsigned int idx;
+  unsigned int numPkts = pbd->hdr.bh1.num_pkts;
+
+  ppd = (struct tpacket3_hdr *) ((unsigned char *) pbd + pbd->hdr.bh1.offset_to_first_pkt);
+
+  for(idx = 0; idx < numPkts; idx++) {
+
+    pkthdr.ts.tv_sec = ppd->tp_sec;
+    pkthdr.ts.tv_usec = ppd->tp_nsec / 1000;
+    pkthdr.caplen = ppd->tp_snaplen;
+    pkthdr.len = ppd->tp_len;
+
+    pRing->pktHandler(pRing->userCbData, &pkthdr, (unsigned char *) ppd + ppd->tp_mac);
+
+    ppd = (struct tpacket3_hdr *) ((unsigned char *) ppd + ppd->tp_next_offset);
+  }
+
+}
+
+static void *ring_sockproc(void *pArg) {
+  PKTRING_SOCK_T *pSock = (PKTRING_SOCK_T *) pArg;
+  PKTRING_T *pRing = pSock->pRing;
+  struct tpacket_block_desc *pbd;
+  struct pollfd pfd;
+
+  memset(&pfd, 0, sizeof(pfd));
+  pfd.fd = pSock->fd;
+  pfd.events = POLLIN | POLLERR;
+
+  while(!pRing->doExit) {
+
+    pbd = (struct tpacket_block_desc *) (pSock->pMap + ((size_t) pSock->idxBlock * pRing->blockSz));
+
+    if(!(pbd->hdr.bh1.block_status & TP_STATUS_USER)) {
+      if(poll(&pfd, 1, PKTRING_POLL_TMO_MS) < 0 && errno != EINTR) {
+        LOG(X_ERROR("Capture ring poll failed: %s"), strerror(errno));
+        break;
+      }
+      continue;
+    }
+
+    __sync_synchronize();
+
+    //
+    // Hand every packet in the retired block to the handler, then return the
+    // whole block to the kernel at once.  The handler is not required to be reentrant,
+    // so fanout threads only poll and retire their own blocks concurrently.
+    //
+    if(pRing->numSocks > 1) {
+      pthread_mutex_lock(&pRing->mtxHandler);
+      ring_procblock(pRing, pbd);
+      pthread_mutex_unlock(&pRing->mtxHandler);
+    } else {
+      ring_procblock(pRing, pbd);
+    }
+
+    __sync_synchronize();
+    pbd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+
+    pSock->blocks++;
+    if(++pSock->idxBlock >= pRing->numBlocks) {
+      pSock->idxBlock = 0;
+    }
+  }
+
+  return NULL;
+}
+
+int pktring_Open(PCAP_CAPTURE_PROPERTIES_T *p) {
+  PKTRING_T *pRing;
+  unsigned int idx;
+  int ifindex;
+  int fanoutId = -1;
+
+  if(!p || p->pRing) {
+    return -1;
+  }
+
+  if((ifindex = if_nametoindex(p->device)) <= 0) {
+    LOG(X_CRITICAL("Unable to find network interface. '%s'"), p->device);
+    return -1;
+  }
+
+  if(!(pRing = (PKTRING_T *) calloc(1, sizeof(PKTRING_T)))) {
+    return -1;
+  }
+
+  pthread_mutex_init(&pRing->mtx, NULL);
+  pthread_mutex_init(&pRing->mtxHandler, NULL);
+  pRing->blockSz = PKTCAPTURE_RING_BLOCK_SZ;
+  pRing->numBlocks = PKTCAPTURE_RING_BLOCKS;
+  pRing->snaplen = PKTCAPTURE_SNAPLEN(p);
+  pRing->pktHandler = p->pktHandler;
+  pRing->userCbData = p->userCbData;
+  if((pRing->numSocks = p->ring_threads) > PKTCAPTURE_RING_THREADS_MAX) {
+    pRing->numSocks = PKTCAPTURE_RING_THREADS_MAX;
+  } else if(pRing->numSocks == 0) {
+    pRing->numSocks = 1;
+  }
+  for(idx = 0; idx < PKTCAPTURE_RING_THREADS_MAX; idx++) {
+    pRing->socks[idx].fd = -1;
+  }
+  p->pRing = pRing;
+
+  if(ring_compilefilter(p->device, p->filter, pRing->snaplen, &pRing->fprog) != 0) {
+    pktring_Close(p);
+    return -1;
+  }
+
+  if(pRing->numSocks > 1) {
+    fanoutId = (getpid() ^ (((unsigned long) pRing) >> 4)) & 0xffff;
+  }
+
+  for(idx = 0; idx < pRing->numSocks; idx++) {
+    if(ring_opensock(pRing, &pRing->socks[idx], p, ifindex, fanoutId) != 0) {
+      pktring_Close(p);
+      return -1;
+    }
+  }
+
+  pRing->stats.numThreads = pRing->numSocks;
+
+  LOG(X_INFO("Listening on interface '%s' %s %s using %u x %u KB capture ring%s"), 
+       p->device, pkt_FindDevDescr(p->device), (p->promiscuous ? "(promiscuous)" : ""),
+       pRing->numBlocks, pRing->blockSz / 1024, pRing->numSocks > 1 ? "s" : "");
+  if(pRing->numSocks > 1) {
+    LOG(X_DEBUG("Capture ring fanout group 0x%x hashing flows across %u threads"), 
+                fanoutId, pRing->numSocks);
+  }
+
+  return 0;
+}
+
+int pktring_Run(PCAP_CAPTURE_PROPERTIES_T *p) {
+  PKTRING_T *pRing;
+  unsigned int idx;
+  pthread_attr_t attr;
+
+  if(!p || !(pRing = (PKTRING_T *) p->pRing)) {
+    return -1;
+  }
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+  for(idx = 1; idx < pRing->numSocks; idx++) {
+    if(pthread_create(&pRing->socks[idx].tid, &attr, ring_sockproc, &pRing->socks[idx]) != 0) {
+      LOG(X_ERROR("Cannot create capture ring thread %u"), idx);
+      pRing->doExit = 1;
+      break;
+    }
+    pRing->socks[idx].haveThread = 1;
+  }
+
+  pthread_attr_destroy(&attr);
+
+  ring_sockproc(&pRing->socks[0]);
+
+  for(idx = 1; idx < pRing->numSocks; idx++) {
+    if(pRing->socks[idx].haveThread) {
+      pthread_join(pRing->socks[idx].tid, NULL);
+      pRing->socks[idx].haveThread = 0;
+    }
+  }
+
+  return 0;
+}
+
+int pktring_Stop(PCAP_CAPTURE_PROPERTIES_T *p) {
+  PKTRING_T *pRing;
+
+  if(!p || !(pRing = (PKTRING_T *) p->pRing)) {
+    return -1;
+  }
+
+  pRing->doExit = 1;
+
+  return 0;
+}
+
+int pktring_GetStats(PCAP_CAPTURE_PROPERTIES_T *p, PCAP_CAPTURE_RING_STATS_T *pStats) {
+  PKTRING_T *pRing;
+  unsigned int idx;
+
+  if(!p || !(pRing = (PKTRING_T *) p->pRing) || !pStats) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&pRing->mtx);
+
+  ring_readstats(pRing);
+  pRing->stats.blocks = 0;
+  for(idx = 0; idx < pRing->numSocks; idx++) {
+    pRing->stats.blocks += pRing->socks[idx].blocks;
+  }
+  memcpy(pStats, &pRing->stats, sizeof(PCAP_CAPTURE_RING_STATS_T));
+
+  pthread_mutex_unlock(&pRing->mtx);
+
+  return 0;
+}
+
+void pktring_Close(PCAP_CAPTURE_PROPERTIES_T *p) {
+  PKTRING_T *pRing;
+  unsigned int idx;
+
+  if(!p || !(pRing = (PKTRING_T *) p->pRing)) {
+    return;
+  }
+
+  //
+  // Keep the ring context so that the final statistics remain readable until pktring_Free
+  //
+  pthread_mutex_lock(&pRing->mtx);
+
+  ring_readstats(pRing);
+  for(idx = 0; idx < pRing->numSocks; idx++) {
+    ring_closesock(&pRing->socks[idx]);
+  }
+
+  if(pRing->fprog.filter) {
+    free(pRing->fprog.filter);
+    pRing->fprog.filter = NULL;
+  }
+
+  pthread_mutex_unlock(&pRing->mtx);
+
+}
+
+void pktring_Free(PCAP_CAPTURE_PROPERTIES_T *p) {
+  PKTRING_T *pRing;
+
+  if(!p || !(pRing = (PKTRING_T *) p->pRing)) {
+    return;
+  }
+
+  pktring_Close(p);
+  p->pRing = NULL;
+  pthread_mutex_destroy(&pRing->mtx);
+  pthread_mutex_destroy(&pRing->mtxHandler);
+  free(pRing);
+}
+
+#endif // PKTCAPTURE_HAVE_RING
@@ -197,6 +197,7 @@ int capture_cbOnStreamAdd(void *pCbUserData,
   //TODO: (re)init the pSp and its stream contents...
   if(pSp->pCapAction) {
     pSp->pCapAction->tmpFrameBuf.idx = 0;
+    pktqueue_writepktdirect_abort(pSp->pCapAction->pQueue);
     pktqueue_reset(pSp->pCapAction->pQueue, 0);
   }
   memset(&pSp->u, 0, sizeof(pSp->u));
@@ -564,6 +565,17 @@ int capture_cbWriteBuf(void *pArg, const void *pData, uint32_t szData) {
   return szData;
 }
 
+int capture_cbWriteQueue(void *pArg, const void *pData, uint32_t szData) {
+  unsigned char *pDst;
+
+  if(!(pDst = pktqueue_writepktdirect((PKTQUEUE_T *) pArg, szData))) {
+    return -1;
+  }
+  memcpy(pDst, pData, szData);
+
+  return szData;
+}
+
 static int capture_analyze_fbarray(const CAPTURE_FBARRAY_T *pCaptureFbArray) {
   int rc = 0;
   unsigned int idx;
@@ -682,9 +694,17 @@ int capture_addCompleteFrameToQ(CAPTURE_CBDATA_SP_T *pSp, uint32_t ts) {
   int idxRdDelta = 0;
   int64_t ptsDelta;
   uint32_t clockHz;
+  unsigned int lenFrame;
+  TIME_VAL tmProfile = 0;
 
   clockHz = pSp->pStream->pFilter->u_seqhdrs.vid.common.clockHz;
 
+  if((pSp->spFlags & CAPTURE_SP_FLAG_DIRECTFRAMEQ)) {
+    lenFrame = pktqueue_writepktdirect_len(pSp->pCapAction->pQueue);
+  } else {
+    lenFrame = pSp->pCapAction->tmpFrameBuf.idx;
+  }
+
   //
   // Add any capture statistics to the input feedback array which controls
   // sending requests for IDRs 
@@ -697,6 +717,9 @@ int capture_addCompleteFrameToQ(CAPTURE_CBDATA_SP_T *pSp, uint32_t ts) {
 
     LOG(X_WARNING("Dropping damaged frame ts: %u / %u"), ts, clockHz);
     pSp->spFlags &= ~CAPTURE_SP_FLAG_DROPFRAME;
+    if((pSp->spFlags & CAPTURE_SP_FLAG_DIRECTFRAMEQ)) {
+      pktqueue_writepktdirect_abort(pSp->pCapAction->pQueue);
+    }
 
   } else {
 
@@ -706,7 +729,7 @@ int capture_addCompleteFrameToQ(CAPTURE_CBDATA_SP_T *pSp, uint32_t ts) {
     VSX_DEBUG_INFRAME(
       LOG(X_DEBUG("INFRAME  - capture-queue-frame [id:%d,rd:%d,wr:%d], len:%d, ts: %u/%uHz (%.3f), flags: 0x%x"), 
                    pSp->pCapAction->pQueue->cfg.id, pSp->pCapAction->pQueue->idxRd, 
-                   pSp->pCapAction->pQueue->idxWr, pSp->pCapAction->tmpFrameBuf.idx, 
+                   pSp->pCapAction->pQueue->idxWr, lenFrame, 
                    ts, clockHz, PTSF(xtra.tm.pts), pSp->spFlags););
 
     xtra.tm.dts = 0;
@@ -737,9 +760,25 @@ static int g_fdh264; if(g_fdh264==0) g_fdh264=open("test.h264", O_RDWR | O_CREAT
 
     numOverwritten =  pSp->pCapAction->pQueue->numOverwritten;
 
-    rc = pktqueue_addpkt(pSp->pCapAction->pQueue, pSp->pCapAction->tmpFrameBuf.buf,
-                         pSp->pCapAction->tmpFrameBuf.idx, &xtra,
-                         ((pSp->spFlags & CAPTURE_SP_FLAG_KEYFRAME) ? 1 : 0));
+    if(pSp->pAllStreams->pProfile) {
+      tmProfile = timer_GetTimeNs();
+    }
+
+    if((pSp->spFlags & CAPTURE_SP_FLAG_DIRECTFRAMEQ)) {
+      //
+      // The frame has already been assembled in the queue write slot
+      //
+      rc = pktqueue_writepktdirect_done(pSp->pCapAction->pQueue, &xtra,
+                                        ((pSp->spFlags & CAPTURE_SP_FLAG_KEYFRAME) ? 1 : 0));
+    } else {
+      rc = pktqueue_addpkt(pSp->pCapAction->pQueue, pSp->pCapAction->tmpFrameBuf.buf,
+                           lenFrame, &xtra,
+                           ((pSp->spFlags & CAPTURE_SP_FLAG_KEYFRAME) ? 1 : 0));
+    }
+
+    if(pSp->pAllStreams->pProfile) {
+      CAPTURE_PROFILE_ADD(pSp->pAllStreams->pProfile->queue, tmProfile);
+    }
 
     if(pSp->pCapAction->pQueue->idxRd < pSp->pCapAction->pQueue->idxWr) {
       idxRdDelta = pSp->pCapAction->pQueue->idxWr - pSp->pCapAction->pQueue->idxRd;
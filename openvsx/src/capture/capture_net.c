@@ -23,6 +23,7 @@
 
 
 #include "vsx_common.h"
+#include "pktcapture.h"
 
 #if defined(VSX_HAVE_CAPTURE)
 
@@ -1533,7 +1534,7 @@ int capture_net_sync(CAPTURE_LOCAL_DESCR_T *pLocalCfg,
 
     rc = cap_pcapStart(pLocalCfg->common.localAddrs[0], pRecordCfg->outDir, 1, 
                        pLocalCfg->common.filt.filters, pLocalCfg->common.filt.numFilters, 
-                       pRecordCfg->overwriteOut, 0);
+                       pRecordCfg->overwriteOut, 0, 0);
 
   } else 
 #endif // DISABLE_PCAP
@@ -1583,7 +1584,7 @@ int capture_net_sync(CAPTURE_LOCAL_DESCR_T *pLocalCfg,
     LOG(X_ERROR("RTMP synchronous capture not implemented.  Please specify a stream output."));
     return -1;
   }
-#ifndef DISABLE_PCAP
+#if !defined(DISABLE_PCAP) || defined(PKTCAPTURE_HAVE_RING)
 
   //
   // Assume input is the name of local pcap interface
@@ -1596,7 +1597,8 @@ int capture_net_sync(CAPTURE_LOCAL_DESCR_T *pLocalCfg,
 
     rc = cap_pcapStart(pLocalCfg->common.localAddrs[0], pRecordCfg->outDir, 0, 
                        pLocalCfg->common.filt.filters, pLocalCfg->common.filt.numFilters, 
-                       pRecordCfg->overwriteOut, pLocalCfg->common.promiscuous);
+                       pRecordCfg->overwriteOut, pLocalCfg->common.promiscuous,
+                       pLocalCfg->common.rcvthreads);
   } else {
     return -1;
   }
@@ -27,15 +27,30 @@
 
 #if defined(VSX_HAVE_CAPTURE)
 
+#define CAPTURE_PCAP_STOP_TMO_MS      3000
+
 static void captureFreePcap(PCAP_CAPTURE_PROPERTIES_T *pCapture) {
   CAPTURE_STATE_T *pState;
+  TIME_VAL tmStart;
 
   if(pCapture) {
 
+    //
+    // Capture ring threads may be blocked in poll or handing a block to capture_onRawPkt, 
+    // so wait for the capture thread to join them before the ring is unmapped
+    //
     if(capture_IsRunning(pCapture)) {
       capture_Stop(pCapture);
-      usleep(20000);
+      tmStart = timer_GetTime();
+      while(capture_IsRunning(pCapture)) {
+        if((timer_GetTime() - tmStart) / TIME_VAL_MS > CAPTURE_PCAP_STOP_TMO_MS) {
+          LOG(X_WARNING("Capture thread did not stop after %d ms"), CAPTURE_PCAP_STOP_TMO_MS);
+          return;
+        }
+        usleep(20000);
+      }
     }
+    capture_Close(pCapture);
 
     if((pState = (CAPTURE_STATE_T *) pCapture->userCbData)) {
       rtp_captureFree(pState);
@@ -72,10 +87,16 @@ static PCAP_CAPTURE_PROPERTIES_T *captureCreatePcap(unsigned int numStreams,
 static void capturePrintPcap(PCAP_CAPTURE_PROPERTIES_T *pCapture, FILE *fp) {
   struct pcap_stat *pCapStats = NULL;
 
-  pCapStats = capture_GetStats(pCapture);
-
-  fprintf(fp, "\n(pcap rx:%u drop:%u)", 
-          pCapStats->ps_recv, pCapStats->ps_drop);
+  if((pCapStats = capture_GetStats(pCapture))) {
+    if(pCapture->pRing) {
+      fprintf(fp, "\n(ring rx:%u drop:%u freeze:%llu blocks:%llu threads:%u)", 
+              pCapStats->ps_recv, pCapStats->ps_drop, pCapture->ringStats.freezes, 
+              pCapture->ringStats.blocks, pCapture->ringStats.numThreads);
+    } else {
+      fprintf(fp, "\n(pcap rx:%u drop:%u)", 
+              pCapStats->ps_recv, pCapStats->ps_drop);
+    }
+  }
 
   rtp_capturePrint((CAPTURE_STATE_T *) pCapture->userCbData, fp);
 
@@ -83,7 +104,7 @@ static void capturePrintPcap(PCAP_CAPTURE_PROPERTIES_T *pCapture, FILE *fp) {
 
 int cap_pcapStart(const char *iface, const char *outDir, int isFile, 
                       const CAPTURE_FILTER_T filters[], unsigned int numFilters,
-                      int overwriteOut, int promiscuous) {
+                      int overwriteOut, int promiscuous, unsigned int ringThreads) {
 
   PCAP_CAPTURE_PROPERTIES_T *pCapture;
   CAPTURE_STATE_T *pState;
@@ -134,6 +155,10 @@ int cap_pcapStart(const char *iface, const char *outDir, int isFile,
   } else {
     pCapture->promiscuous = promiscuous;
     capture_SetInterface(pCapture, iface);
+#if defined(PKTCAPTURE_HAVE_RING)
+    pCapture->use_ring = 1;
+    pCapture->ring_threads = ringThreads;
+#endif // PKTCAPTURE_HAVE_RING
   }
   //TODO: check filter trans filter for tcp/udp
 
@@ -171,6 +196,432 @@ int cap_pcapStart(const char *iface, const char *outDir, int isFile,
 
 
 
+//
+// Maximum speed pcap replay benchmark
+//
+// The whole capture file is loaded into memory and every packet is handed 
+// straight to capture_onRawPkt, going through RTP stream lookup, the jitter buffer, 
+// the codec depacketizers and the frame queues without any sockets, pacing or sleeps.
+// The pcap file is parsed here rather than through libpcap so that the benchmark
+// is also available in DISABLE_PCAP builds.
+//
+
+#define PCAPBENCH_MAGIC_US        0xa1b2c3d4
+#define PCAPBENCH_MAGIC_NS        0xa1b23c4d
+#define PCAPBENCH_LINKTYPE_NULL   0         // BSD loopback, 4 byte address family header
+#define PCAPBENCH_LINKTYPE_EN10MB 1         // Ethernet
+#define PCAPBENCH_FRAMEQ_SLOTS    64
+
+typedef struct PCAPBENCH_FILE_HDR {
+  uint32_t magic;
+  uint16_t version_major;
+  uint16_t version_minor;
+  int32_t  thiszone;
+  uint32_t sigfigs;
+  uint32_t snaplen;
+  uint32_t linktype;
+} PCAPBENCH_FILE_HDR_T;
+
+typedef struct PCAPBENCH_REC_HDR {
+  uint32_t ts_sec;
+  uint32_t ts_frac;
+  uint32_t incl_len;
+  uint32_t orig_len;
+} PCAPBENCH_REC_HDR_T;
+
+typedef struct PCAPBENCH_PKT {
+  struct pcap_pkthdr        hdr;
+  const unsigned char      *pData;
+} PCAPBENCH_PKT_T;
+
+typedef struct PCAPBENCH_CTXT {
+  CAPTURE_CBDATA_T          cbData;   // must be first, depacketizer callbacks map pSp->pAllStreams back to the context
+  CAP_ASYNC_DESCR_T         capCfg;
+  CAPTURE_CB_ONPKT          cbOnPkt[CAPTURE_MAX_STREAMS];
+  CAPTURE_PKT_ACTION_DESCR_T capActions[CAPTURE_MAX_FILTERS_PCAP];
+  CAPTURE_FILTER_T          filters[CAPTURE_MAX_FILTERS_PCAP];
+  unsigned int              numFilters;
+  CAPTURE_PROFILE_T         profile;
+  unsigned char            *pFileData;
+  unsigned char            *pWorkData;  // per pass copy, capture_onRawPkt converts headers in place
+  unsigned int              szData;
+  PCAPBENCH_PKT_T          *pPkts;
+  unsigned int              numPkts;
+  unsigned long long        numFramesRead;
+  TIME_VAL                  nsDrain;
+} PCAPBENCH_CTXT_T;
+
+static uint32_t pcapbench_get32(uint32_t val, int swap) {
+  return swap ? ((val >> 24) | ((val >> 8) & 0xff00) | ((val << 8) & 0xff0000) | (val << 24)) : val;
+}
+
+static int pcapbench_load(PCAPBENCH_CTXT_T *pCtxt, const char *path) {
+  FILE_HANDLE fp;
+  struct stat st;
+  PCAPBENCH_FILE_HDR_T fileHdr;
+  PCAPBENCH_REC_HDR_T recHdr;
+  uint32_t magic;
+  uint32_t linktype;
+  int swap = 0;
+  int nsec = 0;
+  unsigned int idx;
+  unsigned int maxPkts;
+  unsigned int sz;
+
+  if(fileops_stat(path, &st) != 0 || st.st_size <= sizeof(PCAPBENCH_FILE_HDR_T) || 
+     st.st_size > 0x7fffffff) {
+    LOG(X_ERROR("Invalid capture file %s"), path);
+    return -1;
+  }
+  sz = (unsigned int) st.st_size;
+
+  if((fp = fileops_Open(path, O_RDONLY)) == FILEOPS_INVALID_FP) {
+    LOG(X_ERROR("Unable to open file for reading: %s"), path);
+    return -1;
+  }
+
+  if(!(pCtxt->pFileData = (unsigned char *) avc_calloc(1, sz)) ||
+     !(pCtxt->pWorkData = (unsigned char *) avc_calloc(1, sz))) {
+    fileops_Close(fp);
+    return -1;
+  }
+
+  if(fileops_Read(pCtxt->pFileData, 1, sz, fp) != sz) {
+    LOG(X_ERROR("Unable to read %u bytes from %s"), sz, path);
+    fileops_Close(fp);
+    return -1;
+  }
+  fileops_Close(fp);
+
+  memcpy(&fileHdr, pCtxt->pFileData, sizeof(fileHdr));
+  if((magic = fileHdr.magic) == PCAPBENCH_MAGIC_US || magic == PCAPBENCH_MAGIC_NS) {
+    swap = 0;
+  } else if((magic = pcapbench_get32(fileHdr.magic, 1)) == PCAPBENCH_MAGIC_US || 
+            magic == PCAPBENCH_MAGIC_NS) {
+    swap = 1;
+  } else {
+    LOG(X_ERROR("%s is not a pcap capture file"), path);
+    return -1;
+  }
+  nsec = (magic == PCAPBENCH_MAGIC_NS);
+
+  //
+  // capture_onRawPkt only parses Ethernet and loopback link layer headers
+  //
+  if((linktype = pcapbench_get32(fileHdr.linktype, swap)) != PCAPBENCH_LINKTYPE_EN10MB &&
+     linktype != PCAPBENCH_LINKTYPE_NULL) {
+    LOG(X_ERROR("%s has unsupported link type %u.  Only Ethernet and loopback captures are supported"), 
+        path, linktype);
+    return -1;
+  }
+
+  //
+  // Every record has at least a header, which bounds the number of packets
+  //
+  maxPkts = (sz - sizeof(PCAPBENCH_FILE_HDR_T)) / sizeof(PCAPBENCH_REC_HDR_T);
+  if(!(pCtxt->pPkts = (PCAPBENCH_PKT_T *) avc_calloc(maxPkts + 1, sizeof(PCAPBENCH_PKT_T)))) {
+    return -1;
+  }
+
+  idx = sizeof(PCAPBENCH_FILE_HDR_T);
+  while(idx + sizeof(PCAPBENCH_REC_HDR_T) <= sz) {
+
+    memcpy(&recHdr, &pCtxt->pFileData[idx], sizeof(recHdr));
+    idx += sizeof(PCAPBENCH_REC_HDR_T);
+
+    pCtxt->pPkts[pCtxt->numPkts].hdr.caplen = pcapbench_get32(recHdr.incl_len, swap);
+    pCtxt->pPkts[pCtxt->numPkts].hdr.len = pcapbench_get32(recHdr.orig_len, swap);
+    pCtxt->pPkts[pCtxt->numPkts].hdr.ts.tv_sec = pcapbench_get32(recHdr.ts_sec, swap);
+    pCtxt->pPkts[pCtxt->numPkts].hdr.ts.tv_usec = pcapbench_get32(recHdr.ts_frac, swap) / (nsec ? 1000 : 1);
+
+    if(pCtxt->pPkts[pCtxt->numPkts].hdr.caplen > sz - idx) {
+      LOG(X_WARNING("Truncated capture record %u in %s"), pCtxt->numPkts, path);
+      break;
+    }
+
+    pCtxt->pPkts[pCtxt->numPkts].pData = &pCtxt->pWorkData[idx];
+    idx += pCtxt->pPkts[pCtxt->numPkts].hdr.caplen;
+    pCtxt->numPkts++;
+  }
+
+  pCtxt->szData = sz;
+  LOG(X_DEBUG("Loaded %u packets (%u bytes) from %s"), pCtxt->numPkts, sz, path);
+
+  return pCtxt->numPkts > 0 ? 0 : -1;
+}
+
+static int pcapbench_cbOnPkt(void *pUserData, const COLLECT_STREAM_PKTDATA_T *pPkt) {
+  CAPTURE_CBDATA_SP_T *pSp = (CAPTURE_CBDATA_SP_T *) pUserData;
+  PCAPBENCH_CTXT_T *pCtxt = (PCAPBENCH_CTXT_T *) pSp->pAllStreams;
+  TIME_VAL tm0;
+  int rc;
+
+  tm0 = timer_GetTimeNs();
+  rc = pCtxt->cbOnPkt[pSp - pCtxt->cbData.sp](pUserData, pPkt);
+  CAPTURE_PROFILE_ADD(pCtxt->profile.depkt, tm0);
+
+  return rc;
+}
+
+static int pcapbench_cbOnStreamAdd(void *pCbUserData, 
+                                   CAPTURE_STREAM_T *pStream, 
+                                   const COLLECT_STREAM_HDR_T *pktHdr,
+                                   const char *filepath) {
+  PCAPBENCH_CTXT_T *pCtxt = (PCAPBENCH_CTXT_T *) pCbUserData;
+  CAPTURE_CBDATA_SP_T *pSp;
+  int rc;
+
+  if((rc = capture_cbOnStreamAdd(pCbUserData, pStream, pktHdr, filepath)) < 0) {
+    return rc;
+  }
+
+  //
+  // Interpose on the depacketizer to time it
+  //
+  if(pStream->cbOnPkt && (pSp = (CAPTURE_CBDATA_SP_T *) pStream->pCbUserData)) {
+    pCtxt->cbOnPkt[pSp - pCtxt->cbData.sp] = pStream->cbOnPkt;
+    pStream->cbOnPkt = pcapbench_cbOnPkt;
+  }
+
+  return rc;
+}
+
+static void pcapbench_drain(PCAPBENCH_CTXT_T *pCtxt) {
+  unsigned int idx;
+  PKTQUEUE_T *pQ;
+  TIME_VAL tm0;
+
+  //
+  // Consume queued frames as the stream output reader would
+  //
+  tm0 = timer_GetTimeNs();
+
+  for(idx = 0; idx < pCtxt->numFilters; idx++) {
+    if(!(pQ = pCtxt->capActions[idx].pQueue)) {
+      continue;
+    }
+    while(pktqueue_havepkt(pQ) && pktqueue_readpktdirect(pQ)) {
+      pktqueue_readpktdirect_done(pQ);
+      pCtxt->numFramesRead++;
+    }
+  }
+
+  pCtxt->nsDrain += timer_GetTimeNs() - tm0;
+}
+
+static int pcapbench_setupFilters(PCAPBENCH_CTXT_T *pCtxt, 
+                                  const CAPTURE_FILTER_T filters[], 
+                                  unsigned int numFilters) {
+  unsigned int idx;
+  CAPTURE_FILTER_T *pFilter;
+  CAPTURE_PKT_ACTION_DESCR_T *pCapAction;
+
+  pCtxt->numFilters = MIN(numFilters, CAPTURE_MAX_FILTERS_PCAP);
+
+  for(idx = 0; idx < pCtxt->numFilters; idx++) {
+
+    pFilter = &pCtxt->filters[idx];
+    pCapAction = &pCtxt->capActions[idx];
+    memcpy(pFilter, &filters[idx], sizeof(CAPTURE_FILTER_T));
+
+    if(!codectype_isVid(pFilter->mediaType) && !codectype_isAud(pFilter->mediaType)) {
+      continue;
+    }
+
+    if(codectype_isVid(pFilter->mediaType) && pFilter->u_seqhdrs.vid.common.clockHz == 0) {
+      pFilter->u_seqhdrs.vid.common.clockHz = 90000;
+    }
+
+    if(!(pCapAction->pQueue = stream_createFrameQ(codectype_isVid(pFilter->mediaType) ? 
+                                                   STREAM_FRAMEQ_TYPE_VID_NETFRAMES :
+                                                   STREAM_FRAMEQ_TYPE_AUD_NETFRAMES,
+                                                  PCAPBENCH_FRAMEQ_SLOTS, 0))) {
+      return -1;
+    }
+    pktqueue_setrdr(pCapAction->pQueue, 0);
+
+    pCapAction->tmpFrameBuf.sz = MAX(pCapAction->pQueue->cfg.maxPktLen, 
+                                     pCapAction->pQueue->cfg.growMaxPktLen);
+    if(!(pCapAction->tmpFrameBuf.buf = avc_calloc(1, pCapAction->tmpFrameBuf.sz))) {
+      return -1;
+    }
+
+    pCapAction->cmd = CAPTURE_PKT_ACTION_QUEUEFRAME;
+    pFilter->pCapAction = pCapAction;
+  }
+
+  return 0;
+}
+
+static void pcapbench_free(PCAPBENCH_CTXT_T *pCtxt) {
+  unsigned int idx;
+
+  for(idx = 0; idx < pCtxt->numFilters; idx++) {
+    pktqueue_destroy(pCtxt->capActions[idx].pQueue);
+    pCtxt->capActions[idx].pQueue = NULL;
+    if(pCtxt->capActions[idx].tmpFrameBuf.buf) {
+      avc_free((void **) &pCtxt->capActions[idx].tmpFrameBuf.buf);
+    }
+  }
+
+  capture_deleteCbData(&pCtxt->cbData);
+
+  if(pCtxt->pPkts) {
+    avc_free((void **) &pCtxt->pPkts);
+  }
+  if(pCtxt->pFileData) {
+    avc_free((void **) &pCtxt->pFileData);
+  }
+  if(pCtxt->pWorkData) {
+    avc_free((void **) &pCtxt->pWorkData);
+  }
+}
+
+static void pcapbench_printStage(FILE *fp, const char *descr, TIME_VAL ns, unsigned long long num, 
+                                 unsigned long long numPkts) {
+  fprintf(fp, "  %-28s %10.1f ns/pkt", descr, numPkts > 0 ? (double) ns / numPkts : 0);
+  if(num > 0) {
+    fprintf(fp, " %10.1f ns/call (%"LL64"u calls)", (double) ns / num, num);
+  }
+  fprintf(fp, "\n");
+}
+
+int cap_pcapBench(const char *path, const CAPTURE_FILTER_T filters[], unsigned int numFilters,
+                  unsigned int loops) {
+  PCAPBENCH_CTXT_T *pCtxt;
+  CAPTURE_STATE_T *pState = NULL;
+  unsigned int loop;
+  unsigned int idx;
+  TIME_VAL tm0, tm1;
+  TIME_VAL nsTotal = 0;
+  TIME_VAL nsFlush = 0;
+  const CAPTURE_PROFILE_T *pProf;
+  unsigned long long numPkts = 0;
+  unsigned long long numRtpPkts = 0;
+  unsigned long long numFrames;
+  AVC_MEM_STATS_T mem0, mem1;
+  unsigned long long numAllocs = 0;
+  unsigned long long numFrees = 0;
+  int rc = 0;
+
+  if(!(pCtxt = (PCAPBENCH_CTXT_T *) avc_calloc(1, sizeof(PCAPBENCH_CTXT_T)))) {
+    return -1;
+  }
+
+  capture_initCbData(&pCtxt->cbData, NULL, 0);
+  pCtxt->cbData.pCfg = &pCtxt->capCfg;
+  pCtxt->cbData.pProfile = &pCtxt->profile;
+
+  if(loops == 0) {
+    loops = 1;
+  }
+
+  if(pcapbench_load(pCtxt, path) < 0 || 
+     pcapbench_setupFilters(pCtxt, filters, numFilters) < 0) {
+    pcapbench_free(pCtxt);
+    avc_free((void **) &pCtxt);
+    return -1;
+  }
+
+  avc_enableMemStats(1);
+
+  for(loop = 0; loop < loops && !g_proc_exit; loop++) {
+
+    //
+    // Each pass uses a fresh capture state so that RTP sequence numbers start anew
+    //
+    if(!(pState = rtp_captureCreate(CAPTURE_DB_MAX_STREAMS_PCAP, CAPTURE_RTP_JTBUF_SZ_PKTS, 
+                                    CAPTURE_RTP_JTBUF_SZ_PKTS, RTP_JTBUF_PKT_BUFSZ_DEFAULT, 
+                                    1000, 1000))) {
+      rc = -1;
+      break;
+    }
+
+    pState->pProfile = &pCtxt->profile;
+    if(pCtxt->numFilters > 0) {
+      pState->pCbUserData = &pCtxt->cbData;
+      pState->cbOnStreamAdd = pcapbench_cbOnStreamAdd;
+      memcpy(&pState->filt.filters[0], &pCtxt->filters[0], 
+             pCtxt->numFilters * sizeof(CAPTURE_FILTER_T));
+      pState->filt.numFilters = pCtxt->numFilters;
+    }
+
+    memcpy(pCtxt->pWorkData, pCtxt->pFileData, pCtxt->szData);
+
+    avc_getMemStats(&mem0);
+    tm0 = timer_GetTimeNs();
+
+    for(idx = 0; idx < pCtxt->numPkts; idx++) {
+      capture_onRawPkt((unsigned char *) pState, &pCtxt->pPkts[idx].hdr, pCtxt->pPkts[idx].pData);
+      pcapbench_drain(pCtxt);
+    }
+
+    tm1 = timer_GetTimeNs();
+    rtp_captureFlush(pState);
+    nsFlush += timer_GetTimeNs() - tm1;
+
+    pcapbench_drain(pCtxt);
+    nsTotal += timer_GetTimeNs() - tm0;
+
+    avc_getMemStats(&mem1);
+    numAllocs += mem1.numAllocs - mem0.numAllocs;
+    numFrees += mem1.numFrees - mem0.numFrees;
+
+    numPkts += (unsigned long long) pState->numPkts;
+    numRtpPkts += (unsigned long long) pState->numRtpPkts;
+
+    if(loop == loops - 1) {
+      rtp_capturePrint(pState, stderr);
+    }
+
+    rtp_captureFree(pState);
+    pState = NULL;
+
+    for(idx = 0; idx < pCtxt->cbData.maxStreams; idx++) {
+      pCtxt->cbData.sp[idx].inuse = 0;
+    }
+  }
+
+  avc_enableMemStats(0);
+
+  pProf = &pCtxt->profile;
+  numFrames = pProf->queue.num;
+
+  fprintf(stderr, "\npcap replay benchmark %s\n", path);
+  fprintf(stderr, "  passes: %u, packets: %"LL64"u, rtp packets: %"LL64"u, frames queued: %"LL64"u, "
+                  "frames read: %"LL64"u\n", loop, numPkts, numRtpPkts, numFrames, pCtxt->numFramesRead);
+  fprintf(stderr, "  elapsed: %.3f ms, %.0f pkts/s, %.0f frames/s\n", 
+          (double) nsTotal / 1000000.0,
+          nsTotal > 0 ? (double) numPkts * 1000000000.0 / nsTotal : 0,
+          nsTotal > 0 ? (double) numFrames * 1000000000.0 / nsTotal : 0);
+
+  //
+  // The stages add up to the total.  Jitter buffer time includes the end of pass flush, 
+  // less the depacketizer callbacks it makes.
+  //
+  pcapbench_printStage(stderr, "total", nsTotal, 0, numPkts);
+  pcapbench_printStage(stderr, "parse and filter", 
+                       nsTotal - pCtxt->nsDrain - nsFlush - (TIME_VAL) pProf->rtp.ns, 0, numPkts);
+  pcapbench_printStage(stderr, "rtp stream lookup", 
+                       (TIME_VAL) pProf->lookup.ns, pProf->lookup.num, numPkts);
+  pcapbench_printStage(stderr, "jitter buffer", 
+                       (TIME_VAL) pProf->rtp.ns + nsFlush - (TIME_VAL) pProf->lookup.ns - 
+                       (TIME_VAL) pProf->depkt.ns, pProf->rtp.num, numPkts);
+  pcapbench_printStage(stderr, "depacketize", (TIME_VAL) pProf->depkt.ns - (TIME_VAL) pProf->queue.ns,
+                       pProf->depkt.num, numPkts);
+  pcapbench_printStage(stderr, "frame queue insert", 
+                       (TIME_VAL) pProf->queue.ns, pProf->queue.num, numPkts);
+  pcapbench_printStage(stderr, "frame queue read", pCtxt->nsDrain, pCtxt->numFramesRead, numPkts);
+  fprintf(stderr, "  allocations: %"LL64"u (%.3f per pkt), frees: %"LL64"u\n", 
+          numAllocs, numPkts > 0 ? (double) numAllocs / numPkts : 0, numFrees);
+
+  pcapbench_free(pCtxt);
+  avc_free((void **) &pCtxt);
+
+  return rc;
+}
+
+
 /*
 int testpcap(const char *path) {
   FILE_STREAM_T fStreamOut;
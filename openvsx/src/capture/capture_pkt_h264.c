@@ -270,6 +270,15 @@ static int onCompleteFrame(CAPTURE_CBDATA_SP_T *pSp, uint32_t ts) {
   return capture_addCompleteFrameToQ(pSp, ts);
 }
 
+static unsigned int getFrameLen(const CAPTURE_CBDATA_SP_T *pSp) {
+
+  if((pSp->spFlags & CAPTURE_SP_FLAG_DIRECTFRAMEQ)) {
+    return pktqueue_writepktdirect_len(pSp->pCapAction->pQueue);
+  } else {
+    return pSp->pCapAction->tmpFrameBuf.idx;
+  }
+}
+
 int cbOnPkt_h264(void *pUserData, const COLLECT_STREAM_PKTDATA_T *pPkt) {
   int rc = 0;
   CAPTURE_CBDATA_SP_T *pSp = (CAPTURE_CBDATA_SP_T *) pUserData;
@@ -307,7 +316,17 @@ int cbOnPkt_h264(void *pUserData, const COLLECT_STREAM_PKTDATA_T *pPkt) {
     queueFr = 1;
   }
 
-  if(queueFr) {
+  if(queueFr && pSp->pCapAction->pQueue && pSp->pCapAction->pQueue->cfg.type == PKTQ_TYPE_DEFAULT) {
+
+    //
+    // Write NAL payloads directly into the output queue write slot, avoiding an 
+    // intermediate copy through tmpFrameBuf
+    //
+    cbData.pCbDataArg = pSp->pCapAction->pQueue;
+    cbData.cbStoreData = capture_cbWriteQueue;
+    pSp->spFlags |= CAPTURE_SP_FLAG_DIRECTFRAMEQ;
+
+  } else if(queueFr) {
 
     if(!pSp->pCapAction->tmpFrameBuf.buf || pSp->pCapAction->tmpFrameBuf.sz <= 0) {
       return -1;
@@ -324,7 +343,7 @@ int cbOnPkt_h264(void *pUserData, const COLLECT_STREAM_PKTDATA_T *pPkt) {
   }
 
 
-  if(queueFr && pSp->pCapAction->tmpFrameBuf.idx > 0 && 
+  if(queueFr && getFrameLen(pSp) > 0 && 
      pSp->lastPktTs != pPkt->u.rtp.ts) { 
     //fprintf(stderr, "queing h264 (prior) %d seq:%d ts:%u,now:%u, flags:0x%x\n", pSp->pCapAction->tmpFrameBuf.idx, pPkt->u.rtp.seq, pSp->lastPktTs, pPkt->u.rtp.ts, pSp->spFlags);
 
@@ -354,7 +373,7 @@ int cbOnPkt_h264(void *pUserData, const COLLECT_STREAM_PKTDATA_T *pPkt) {
 
   if(queueFr && (pPkt->u.rtp.marksz & PKTDATA_RTP_MASK_MARKER)) { 
 
-    if(pSp->pCapAction->tmpFrameBuf.idx == 0) {
+    if(getFrameLen(pSp) == 0) {
       pSp->spFlags |= (CAPTURE_SP_FLAG_DAMAGEDFRAME | CAPTURE_SP_FLAG_DROPFRAME);
     }
     //fprintf(stderr, "queing h264 (marker) %d seq:%d ts:%u, flags:0x%x\n", pSp->pCapAction->tmpFrameBuf.idx, pPkt->u.rtp.seq, pPkt->u.rtp.ts, pSp->spFlags);
@@ -130,21 +130,28 @@ static int pass_filter_tcpraw(const CAPTURE_FILTER_T *pFilter,
 }
 
 
-static int pass_filter_rtp(const CAPTURE_FILTER_T *pFilter,
-                           const COLLECT_STREAM_PKT_T *pkt) {
+static int pass_filter_rtphdr(const CAPTURE_FILTER_T *pFilter,
+                              uint32_t ssrc,
+                              uint8_t payloadType) {
 
   if(pFilter->haveRtpSsrcFilter && 
-     pFilter->ssrcFilter != pkt->hdr.key.ssrc) {
+     pFilter->ssrcFilter != ssrc) {
     return 0;
   }
   if(pFilter->haveRtpPtFilter &&
-     pFilter->payloadType != pkt->hdr.payloadType) {
+     pFilter->payloadType != payloadType) {
     return 0;
   } 
 
   return 1;
 }
 
+static int pass_filter_rtp(const CAPTURE_FILTER_T *pFilter,
+                           const COLLECT_STREAM_PKT_T *pkt) {
+
+  return pass_filter_rtphdr(pFilter, pkt->hdr.key.ssrc, pkt->hdr.payloadType);
+}
+
 static const CAPTURE_FILTER_T *get_filter_tcpraw(const CAPTURE_STATE_T *pState,
                                                  const struct ip *pip,
                                                  const struct ip6_hdr *pip6,
@@ -213,7 +220,7 @@ static const CAPTURE_FILTER_T *get_filter_udprtp(const CAPTURE_STATE_T *pState,
   return NULL;
 }
 
-static int have_filter_rtp(CAPTURE_STATE_T *pState) {
+static int have_filter_rtp(const CAPTURE_STATE_T *pState) {
   unsigned int idx;
 
   for(idx = 0; idx < pState->filt.numFilters; idx++) {
@@ -227,9 +234,14 @@ static int have_filter_rtp(CAPTURE_STATE_T *pState) {
 }
 
 
+//
+// rcvDelayUs is the delay from the kernel receive timestamp in pkthdr->ts until the packet was read
+// by the application, or < 0 if pkthdr->ts is not a kernel receive timestamp.
+//
 static const CAPTURE_STREAM_T *capture_onRawPkt_int(unsigned char *pArg, 
                                                     const struct pcap_pkthdr *pkthdr, 
                                                     const unsigned char *packet, 
+                                                    int rcvDelayUs,
                                                     const NETIO_SOCK_T *pnetsock) {
 
   uint16_t *pus;
@@ -246,12 +258,12 @@ static const CAPTURE_STREAM_T *capture_onRawPkt_int(unsigned char *pArg,
   const CAPTURE_STREAM_T *pStream = NULL;
   const CAPTURE_FILTER_T *pFilter = NULL;
   CAPTURE_STATE_T *pState = (CAPTURE_STATE_T *) pArg;
+  TIME_VAL tmProfile;
 
   char delme[3][64];
 
   if(pState) {
-    // maybe move this to inside of mutex lock
-    pState->numPkts++;
+    CAPTURE_STATE_ATOMIC_INC(&pState->numPkts);
   }
 
   if(pkthdr == NULL || packet == NULL) {
@@ -406,12 +418,23 @@ static const CAPTURE_STREAM_T *capture_onRawPkt_int(unsigned char *pArg,
                          pkthdr,
                          &pkt))) {
 
+        if(rcvDelayUs >= 0) {
+          pkt.data.flags |= PKT_FLAGS_RCVTS_KERNEL;
+          pkt.data.rcvDelayUs = rcvDelayUs;
+        }
+
         //if(pState->filt.numFilters > 0) {
         pFilter = get_filter_udprtp(pState, &pkt);      
 
         if(pState->filt.numFilters == 0 || pFilter != NULL) {
 //fprintf(stdout, "filtered rtp pkt %s->%s pt:%u,ssrc=0x%x\n", delme[0], delme[1], pkt.hdr.payloadType,pkt.hdr.key.ssrc);
-          pStream = capture_processRtp(pState, &pkt, pFilter);
+          if(pState->pProfile) {
+            tmProfile = timer_GetTimeNs();
+            pStream = capture_processRtp(pState, &pkt, pFilter);
+            CAPTURE_PROFILE_ADD(pState->pProfile->rtp, tmProfile);
+          } else {
+            pStream = capture_processRtp(pState, &pkt, pFilter);
+          }
         }else {
 //fprintf(stdout, "discarded rtp pkt %s->%s pt:%u,ssrc=0x%x\n", delme[0], delme[1], pkt.hdr.payloadType,pkt.hdr.key.ssrc);
         }
@@ -453,7 +476,67 @@ void capture_onRawPkt(unsigned char *pArg,
                       const struct pcap_pkthdr *pkthdr, 
                       const unsigned char *packet) {
 
-  (void) capture_onRawPkt_int(pArg, pkthdr, packet, NULL);
+  (void) capture_onRawPkt_int(pArg, pkthdr, packet, -1, NULL);
+}
+
+//
+// Returns the index of the capture filter which capture_onUdpSockPkt will use for the given
+// UDP socket payload, or -1 if the packet does not match any filter
+//
+int capture_getUdpSockFilterIdx(const CAPTURE_STATE_T *pState,
+                                const unsigned char *pData,
+                                unsigned int len,
+                                const struct sockaddr *pSaSrc,
+                                const struct sockaddr *pSaDst) {
+  unsigned int idx;
+  struct ip pktIp4;
+  struct ip *p_pktIp4 = NULL;
+  struct ip6_hdr pktIp6;
+  struct ip6_hdr *p_pktIp6 = NULL;
+  struct udphdr pktUdp;
+  const CAPTURE_FILTER_T *pFilter;
+  uint32_t ssrc;
+  uint8_t payloadType;
+
+  if(pState->filt.numFilters == 0) {
+    return -1;
+  }
+
+  if(pSaSrc->sa_family == AF_INET6) {
+    p_pktIp6 = &pktIp6;
+  } else {
+    pktIp4.ip_v = 4;
+    pktIp4.ip_src = ((const struct sockaddr_in *) pSaSrc)->sin_addr;
+    pktIp4.ip_dst = ((const struct sockaddr_in *) pSaDst)->sin_addr;
+    p_pktIp4 = &pktIp4;
+  }
+
+  pktUdp.source = ntohs(PINET_PORT(pSaSrc));
+  pktUdp.dest = ntohs(PINET_PORT(pSaDst));
+
+  if(!(pFilter = get_filter_udpraw(pState, p_pktIp4, p_pktIp6, &pktUdp))) {
+    return -1;
+  }
+
+  if(have_filter_rtp(pState)) {
+
+    if(len < RTP_HEADER_LEN) {
+      return -1;
+    }
+
+    payloadType = pData[1] & RTP_PT_MASK;
+    ssrc = htonl(*((const uint32_t *) &pData[8]));
+
+    for(idx = 0; idx < pState->filt.numFilters; idx++) {
+      if(pass_filter_rtphdr(&pState->filt.filters[idx], ssrc, payloadType) &&
+         pass_filter_udpraw(&pState->filt.filters[idx], p_pktIp4, p_pktIp6, &pktUdp)) {
+        return (int) idx;
+      }
+    }
+    return -1;
+  }
+
+  return (int) (pFilter - pState->filt.filters);
 }
 
 const CAPTURE_STREAM_T *capture_onUdpSockPkt(CAPTURE_STATE_T *pState, 
@@ -463,6 +546,7 @@ const CAPTURE_STREAM_T *capture_onUdpSockPkt(CAPTURE_STATE_T *pState,
                                              const struct sockaddr *pSaSrc, 
                                              const struct sockaddr *pSaDst,
                                              struct timeval *ptv,
+                                             int rcvDelayUs,
                                              const NETIO_SOCK_T *pnetsock) {
 
   struct udphdr *pudp = (struct udphdr *) (pData - 8);
@@ -516,7 +600,7 @@ const CAPTURE_STREAM_T *capture_onUdpSockPkt(CAPTURE_STATE_T *pState,
   pkthdr.ts.tv_sec = ptv->tv_sec;
   pkthdr.ts.tv_usec = ptv->tv_usec;
   
-  return capture_onRawPkt_int((unsigned char *) pState, &pkthdr, (unsigned char *) peth, pnetsock); 
+  return capture_onRawPkt_int((unsigned char *) pState, &pkthdr, (unsigned char *) peth, rcvDelayUs, pnetsock); 
 }
 
 #endif // VSX_HAVE_CAPTURE
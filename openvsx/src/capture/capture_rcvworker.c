@@ -0,0 +1,328 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+
+
+#include "vsx_common.h"
+
+#if defined(VSX_HAVE_CAPTURE)
+
+#define RCVWORKER_ALIGN(sz)           (((sz) + 7) & ~7)
+#define RCVWORKER_DROP_LOG_MS         2000
+
+//
+// Capture receive workers take the RTP processing (SRTP decryption, jitter buffering and 
+// depacketization) off the socket reader thread.  The reader queues each received RTP datagram
+// to the worker which owns its SSRC, so the packets of a stream are always processed in
+// arrival order by the same thread.  Streams matching the same capture filter share its SRTP 
+// context and depacketizer state, so they are kept on the same worker.  A filter without a payload
+// type filter matches every payload type on its socket, so this includes payload type changes.
+//
+
+static void rcvworker_proc(void *pArg) {
+  CAPTURE_RCVWORKER_T *pWorker = (CAPTURE_RCVWORKER_T *) pArg;
+  CAPTURE_RCVWORKERS_T *pWorkers = pWorker->pWorkers;
+  CAPTURE_RCVWORKER_PKT_T *pPkt;
+  char tid_tag[LOGUTIL_TAG_LENGTH + 16];
+
+  pthread_mutex_lock(&pWorkers->mtx);
+  snprintf(tid_tag, sizeof(tid_tag), "%s-%u", pWorkers->tid_tag, pWorker->id);
+  pthread_mutex_unlock(&pWorkers->mtx);
+  logutil_tid_add(pthread_self(), tid_tag);
+
+  pthread_mutex_lock(&pWorkers->mtx);
+
+  while(!g_proc_exit) {
+
+    if(pWorker->szUsed == 0) {
+      if(pWorkers->shutdown) {
+        break;
+      }
+      pWorker->waiting = 1;
+      pthread_cond_wait(&pWorker->cond, &pWorkers->mtx);
+      pWorker->waiting = 0;
+      continue;
+    }
+
+    pthread_mutex_unlock(&pWorkers->mtx);
+
+    //
+    // Records never straddle the end of the ring.  A zero length record means the
+    // producer continued at the start.
+    //
+    pPkt = (CAPTURE_RCVWORKER_PKT_T *) &pWorker->pBuf[pWorker->idxRd];
+
+    if(pPkt->szRecord == 0) {
+
+      pthread_mutex_lock(&pWorkers->mtx);
+      pWorker->szUsed -= (pWorker->szBuf - pWorker->idxRd);
+      pWorker->idxRd = 0;
+
+    } else {
+
+      pWorkers->cbOnPkt(pWorkers->pCbData, pPkt);
+
+      pthread_mutex_lock(&pWorkers->mtx);
+      pWorker->szUsed -= pPkt->szRecord;
+      if((pWorker->idxRd += pPkt->szRecord) >= pWorker->szBuf) {
+        pWorker->idxRd = 0;
+      }
+    }
+
+  }
+
+  pWorkers->numRunning--;
+  pthread_cond_broadcast(&pWorkers->condDone);
+  pthread_mutex_unlock(&pWorkers->mtx);
+
+  logutil_tid_remove(pthread_self());
+}
+
+int capture_rcvworkers_start(CAPTURE_RCVWORKERS_T *pWorkers, unsigned int numWorkers,
+                             CAPTURE_RCVWORKER_CB_ONPKT cbOnPkt, void *pCbData) {
+  CAPTURE_RCVWORKER_T *pWorker;
+  pthread_t ptd;
+  pthread_attr_t attr;
+  const char *s;
+  unsigned int idx;
+  int rc = 0;
+
+  if(!pWorkers || !cbOnPkt || numWorkers <= 0) {
+    return -1;
+  }
+
+  memset(pWorkers, 0, sizeof(CAPTURE_RCVWORKERS_T));
+  pthread_mutex_init(&pWorkers->mtx, NULL);
+  pthread_cond_init(&pWorkers->condDone, NULL);
+  pWorkers->cbOnPkt = cbOnPkt;
+  pWorkers->pCbData = pCbData;
+
+  if((s = logutil_tid_lookup(pthread_self(), 0)) && s[0] != '\0') {
+    snprintf(pWorkers->tid_tag, sizeof(pWorkers->tid_tag), "%s-rcv", s);
+  } else {
+    snprintf(pWorkers->tid_tag, sizeof(pWorkers->tid_tag), "caprcv");
+  }
+
+  for(idx = 0; idx < MIN(numWorkers, CAPTURE_RCVWORKERS_MAX); idx++) {
+    pWorker = &pWorkers->workers[idx];
+    pWorker->pWorkers = pWorkers;
+    pWorker->id = idx;
+    pWorker->szBuf = CAPTURE_RCVWORKER_QUEUE_SZ;
+    if(!(pWorker->pBuf = (unsigned char *) avc_calloc(1, pWorker->szBuf))) {
+      rc = -1;
+      break;
+    }
+    pthread_cond_init(&pWorker->cond, NULL);
+    pWorkers->numWorkers++;
+  }
+
+  pthread_mutex_lock(&pWorkers->mtx);
+
+  for(idx = 0; rc >= 0 && idx < pWorkers->numWorkers; idx++) {
+
+    PHTREAD_INIT_ATTR(&attr);
+
+    if(pthread_create(&ptd, &attr, (void *) rcvworker_proc, (void *) &pWorkers->workers[idx]) != 0) {
+      LOG(X_ERROR("Unable to create capture receive worker thread"));
+      rc = -1;
+    } else {
+      pWorkers->numRunning++;
+    }
+  }
+
+  pthread_mutex_unlock(&pWorkers->mtx);
+
+  if(rc < 0) {
+    capture_rcvworkers_stop(pWorkers);
+    return rc;
+  }
+
+  LOG(X_DEBUG("Started %u capture receive worker thread(s)"), pWorkers->numWorkers);
+
+  return rc;
+}
+
+void capture_rcvworkers_stop(CAPTURE_RCVWORKERS_T *pWorkers) {
+  unsigned int idx;
+
+  if(!pWorkers || pWorkers->numWorkers == 0) {
+    return;
+  }
+
+  //
+  // Workers drain any queued packets before exiting
+  //
+  pthread_mutex_lock(&pWorkers->mtx);
+  pWorkers->shutdown = 1;
+  for(idx = 0; idx < pWorkers->numWorkers; idx++) {
+    pthread_cond_signal(&pWorkers->workers[idx].cond);
+  }
+  while(pWorkers->numRunning > 0) {
+    pthread_cond_wait(&pWorkers->condDone, &pWorkers->mtx);
+  }
+  pthread_mutex_unlock(&pWorkers->mtx);
+
+  for(idx = 0; idx < pWorkers->numWorkers; idx++) {
+    if(pWorkers->workers[idx].numDropped > 0) {
+      LOG(X_WARNING("Capture receive worker %u dropped %"LL64"u of %"LL64"u packets on queue overflow"),
+          idx, pWorkers->workers[idx].numDropped, 
+          pWorkers->workers[idx].numPkts + pWorkers->workers[idx].numDropped);
+    }
+    avc_free((void **) &pWorkers->workers[idx].pBuf);
+    pthread_cond_destroy(&pWorkers->workers[idx].cond);
+  }
+
+  pthread_cond_destroy(&pWorkers->condDone);
+  pthread_mutex_destroy(&pWorkers->mtx);
+  pWorkers->numWorkers = 0;
+}
+
+//
+// Returns the worker owning the RTP stream with the given SSRC.  Only called by the producer.
+//
+static CAPTURE_RCVWORKER_T *rcvworker_steer(CAPTURE_RCVWORKERS_T *pWorkers, unsigned int idxSock,
+                                            uint32_t ssrc, int idxFilter) {
+  CAPTURE_RCVWORKER_SSRC_T *pSsrc;
+  unsigned int idx;
+  int idxWorker = -1;
+  int idxWorkerSsrc = -1;
+
+  for(idx = 0; idx < pWorkers->numSsrcs; idx++) {
+    pSsrc = &pWorkers->ssrcs[idx];
+    if(pSsrc->idxFilter == idxFilter && (idxFilter >= 0 || pSsrc->idxSock == idxSock)) {
+      if(pSsrc->ssrc == ssrc && pSsrc->idxSock == idxSock) {
+        return &pWorkers->workers[pSsrc->idxWorker];
+      } else if(idxWorker < 0) {
+        idxWorker = pSsrc->idxWorker;
+      }
+    } else if(idxWorkerSsrc < 0 && pSsrc->ssrc == ssrc && pSsrc->idxSock == idxSock) {
+      idxWorkerSsrc = pSsrc->idxWorker;
+    }
+  }
+
+  //
+  // All the streams matching the same capture filter, or the same socket when no filter matches,
+  // are kept on one worker.  A stream whose packets now match another filter, such as after a 
+  // payload type change, brings that filter onto its worker if no other worker is using it yet.
+  // Otherwise a new stream is placed on the worker with the fewest streams.
+  //
+  if(idxWorker < 0) {
+    idxWorker = idxWorkerSsrc;
+  }
+  if(idxWorker < 0) {
+    idxWorker = 0;
+    for(idx = 1; idx < pWorkers->numWorkers; idx++) {
+      if(pWorkers->workers[idx].numSsrcs < pWorkers->workers[idxWorker].numSsrcs) {
+        idxWorker = idx;
+      }
+    }
+  }
+
+  if(pWorkers->numSsrcs < CAPTURE_RCVWORKER_SSRCS_MAX) {
+    pSsrc = &pWorkers->ssrcs[pWorkers->numSsrcs++];
+    pSsrc->ssrc = ssrc;
+    pSsrc->idxSock = idxSock;
+    pSsrc->idxFilter = idxFilter;
+    pSsrc->idxWorker = idxWorker;
+    pWorkers->workers[idxWorker].numSsrcs++;
+
+    LOG(X_DEBUG("Capture receive worker %d assigned ssrc:0x%x, filter:%d on socket[%u]"), 
+        idxWorker, ssrc, idxFilter, idxSock);
+  }
+
+  return &pWorkers->workers[idxWorker];
+}
+
+int capture_rcvworkers_enqueue(CAPTURE_RCVWORKERS_T *pWorkers, unsigned int idxSock,
+                               const unsigned char *pData, unsigned int len,
+                               const struct sockaddr_storage *psaSrc, const struct timeval *ptv,
+                               int rcvDelayUs, int idxFilter) {
+  CAPTURE_RCVWORKER_T *pWorker;
+  CAPTURE_RCVWORKER_PKT_T *pPkt;
+  unsigned int szRecord;
+  unsigned int szTail = 0;
+  uint32_t ssrc = 0;
+  TIME_VAL tm;
+
+  if(len >= RTP_HEADER_LEN) {
+    ssrc = htonl(*((const uint32_t *) &pData[8]));
+  }
+
+  pWorker = rcvworker_steer(pWorkers, idxSock, ssrc, idxFilter);
+  szRecord = RCVWORKER_ALIGN(sizeof(CAPTURE_RCVWORKER_PKT_T) + SOCKET_LIST_PREBUF_SZ + len);
+
+  if(pWorker->idxWr + szRecord > pWorker->szBuf) {
+    szTail = pWorker->szBuf - pWorker->idxWr;
+  }
+
+  pthread_mutex_lock(&pWorkers->mtx);
+
+  if(pWorker->szUsed + szTail + szRecord > pWorker->szBuf) {
+    pWorker->numDropped++;
+    pthread_mutex_unlock(&pWorkers->mtx);
+
+    if(((tm = timer_GetTime()) - pWorker->tmLastDropLog) / TIME_VAL_MS > RCVWORKER_DROP_LOG_MS) {
+      LOG(X_WARNING("Capture receive worker %u queue full, dropped %"LL64"u packets"), 
+          pWorker->id, pWorker->numDropped);
+      pWorker->tmLastDropLog = tm;
+    }
+    return -1;
+  }
+
+  pthread_mutex_unlock(&pWorkers->mtx);
+
+  //
+  // The space from idxWr up to the worker's unconsumed data is owned by the producer
+  //
+  if(szTail > 0) {
+    ((CAPTURE_RCVWORKER_PKT_T *) &pWorker->pBuf[pWorker->idxWr])->szRecord = 0;
+    pWorker->idxWr = 0;
+  }
+
+  pPkt = (CAPTURE_RCVWORKER_PKT_T *) &pWorker->pBuf[pWorker->idxWr];
+  pPkt->szRecord = szRecord;
+  pPkt->idxSock = idxSock;
+  pPkt->len = len;
+  pPkt->rcvDelayUs = rcvDelayUs;
+  pPkt->tv.tv_sec = ptv->tv_sec;
+  pPkt->tv.tv_usec = ptv->tv_usec;
+  memcpy(&pPkt->saSrc, psaSrc, sizeof(pPkt->saSrc));
+  memcpy(CAPTURE_RCVWORKER_PKT_DATA(pPkt), pData, len);
+
+  if((pWorker->idxWr += szRecord) >= pWorker->szBuf) {
+    pWorker->idxWr = 0;
+  }
+
+  pthread_mutex_lock(&pWorkers->mtx);
+  pWorker->szUsed += szTail + szRecord;
+  pWorker->numPkts++;
+  if(pWorker->waiting) {
+    pthread_cond_signal(&pWorker->cond);
+  }
+  pthread_mutex_unlock(&pWorkers->mtx);
+
+  return 0;
+}
+
+#endif // VSX_HAVE_CAPTURE
@@ -32,6 +32,22 @@
 
 #define RTP_SEQ_INCR_MIN          1
 
+//
+// The jitter buffer is a ring of packet slots indexed directly by (seq & maskPkts), with a bitmap 
+// marking the slots which hold a received packet pending playout.  The pending window spans from 
+// startingSeq (last played) to highestSeq (highest stored), so insertion, gap detection and finding
+// the length of the next contiguous run to play do not require walking the slots.
+//
+#define JTBUF_BITMAP_BITS          64
+#define JTBUF_SLOT(pj, seq)        ((seq) & (pj)->maskPkts)
+#define JTBUF_PENDING(pj)          ((uint16_t) ((pj)->highestSeq - (pj)->startingSeq))
+#define JTBUF_SEQ_DELTA(seq, prev) ((int16_t) ((uint16_t) (seq) - (uint16_t) (prev)))
+#define JTBUF_RX_WORD(pj, idx)     ((pj)->pRxBitmap[(idx) / JTBUF_BITMAP_BITS])
+#define JTBUF_RX_BIT(idx)          ((uint64_t) 1 << ((idx) % JTBUF_BITMAP_BITS))
+#define JTBUF_RX_ISSET(pj, idx)    (JTBUF_RX_WORD(pj, idx) & JTBUF_RX_BIT(idx))
+#define JTBUF_RX_SET(pj, idx)      (JTBUF_RX_WORD(pj, idx) |= JTBUF_RX_BIT(idx))
+#define JTBUF_RX_CLR(pj, idx)      (JTBUF_RX_WORD(pj, idx) &= ~JTBUF_RX_BIT(idx))
+
 static int capture_flushJtBuf(CAPTURE_STATE_T *pState, CAPTURE_STREAM_T *pStream, const COLLECT_STREAM_PKT_T *pPkt);
 
 static CAPTURE_JTBUF_PKTDATA_POOL_ENTRY_T *jtbufpool_get(CAPTURE_JTBUF_PKTDATA_POOL_T *pPool) {
@@ -91,10 +107,81 @@ static void jtbuf_close(CAPTURE_JTBUF_T *pjtBuf) {
     jtbufpool_free(&pjtBuf->pool);
     avc_free((void **) &pjtBuf->pPkts);
   }
+  if(pjtBuf->pRxBitmap) {
+    avc_free((void **) &pjtBuf->pRxBitmap);
+  }
   pjtBuf->pool.maxEntries = 0;
   pjtBuf->pool.entryBufSz = 0;
   pjtBuf->sizePkts = 0;
+  pjtBuf->maskPkts = 0;
+  pjtBuf->depthPkts = 0;
+
+}
+
+static void jtbuf_reset(CAPTURE_JTBUF_T *pjtBuf) {
+  unsigned int idx;
+
+  //
+  // Return any payload buffers still held by pending packets of a prior stream
+  //
+  for(idx = 0; idx < pjtBuf->sizePkts; idx++) {
+    if(pjtBuf->pPkts[idx].pPoolBuf) {
+      jtbufpool_put(&pjtBuf->pool, pjtBuf->pPkts[idx].pPoolBuf);
+    }
+  }
+
+  memset(pjtBuf->pPkts, 0, pjtBuf->sizePkts * sizeof(CAPTURE_JTBUF_PKT_T));
+  memset(pjtBuf->pRxBitmap, 0, pjtBuf->sizePkts / JTBUF_BITMAP_BITS * sizeof(uint64_t));
+  pjtBuf->idxPkt = 0;
+  pjtBuf->idxPktStored = 0;
+  pjtBuf->startingSeq = 0;
+  pjtBuf->highestSeq = 0;
+  pjtBuf->flushedAll = 0;
+}
+
+static unsigned int jtbuf_ctz64(uint64_t val) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(val);
+#else // __GNUC__
+  unsigned int count = 0;
+
+  while(!(val & 1)) {
+    val >>= 1;
+    count++;
+  }
+  return count;
+#endif // __GNUC__
+}
+
+//
+// Returns the number of consecutive received packets starting at slot idxPkt, up to max
+//
+static unsigned int jtbuf_runlen(const CAPTURE_JTBUF_T *pjtBuf, unsigned int idxPkt, unsigned int max) {
+  unsigned int run = 0;
+  unsigned int bit, ones;
+  uint64_t val;
+
+  while(run < max) {
+
+    bit = idxPkt % JTBUF_BITMAP_BITS;
+
+    //
+    // Count the trailing set bits from this slot until the end of the bitmap word
+    //
+    if((val = ~(JTBUF_RX_WORD(pjtBuf, idxPkt) >> bit)) == 0) {
+      ones = JTBUF_BITMAP_BITS;
+    } else {
+      ones = jtbuf_ctz64(val);
+    }
+    run += ones;
+
+    if(ones < JTBUF_BITMAP_BITS - bit) {
+      break;
+    }
+    idxPkt = JTBUF_SLOT(pjtBuf, idxPkt + ones);
+  }
 
+  return MIN(run, max);
 }
 
 void rtp_captureFree(CAPTURE_STATE_T *pState) {
@@ -111,8 +198,6 @@ void rtp_captureFree(CAPTURE_STATE_T *pState) {
   jtbuf_close(&pState->jtBufAud);
   pState->pjtBufAud = NULL;
 
-  capture_abr_close(&pState->rembAbr);
-
   if(pState->pStreams) {
     for(idxStream = 0; idxStream < pState->maxStreams; idxStream++) {
       pStream = &pState->pStreams[idxStream];
@@ -121,6 +206,10 @@ void rtp_captureFree(CAPTURE_STATE_T *pState) {
     //  free(pState->pStreams[idxStream].jtBuf.pPkts);
     //}
 
+      if(pStream->rembAbr.payloadBitrate.samples) {
+        capture_abr_close(&pStream->rembAbr);
+      }
+
       if(pStream->pFilter) {
         srtp_closeInputStream((SRTP_CTXT_T *) &pStream->pFilter->srtps[0]);
         srtp_closeInputStream((SRTP_CTXT_T *) &pStream->pFilter->srtps[1]);
@@ -139,6 +228,7 @@ void rtp_captureFree(CAPTURE_STATE_T *pState) {
 
 
 static int jtbuf_init(CAPTURE_JTBUF_T *pjtBuf, unsigned int jtBufSzPkts, unsigned int jtBufPktBufSz) {
+  unsigned int sizePkts = JTBUF_BITMAP_BITS;
 
   jtbuf_close(pjtBuf);
 
@@ -146,13 +236,27 @@ static int jtbuf_init(CAPTURE_JTBUF_T *pjtBuf, unsigned int jtBufSzPkts, unsigne
     return 0;
   }
 
-  if((pjtBuf->pPkts = (CAPTURE_JTBUF_PKT_T *) avc_calloc(jtBufSzPkts, sizeof(CAPTURE_JTBUF_PKT_T))) == NULL) {
+  //
+  // The slot count is rounded up to a power of 2 while the reorder window remains jtBufSzPkts
+  //
+  while(sizePkts < jtBufSzPkts) {
+    sizePkts <<= 1;
+  }
+
+  if((pjtBuf->pPkts = (CAPTURE_JTBUF_PKT_T *) avc_calloc(sizePkts, sizeof(CAPTURE_JTBUF_PKT_T))) == NULL) {
+    return -1;
+  }
+
+  if((pjtBuf->pRxBitmap = (uint64_t *) avc_calloc(sizePkts / JTBUF_BITMAP_BITS, sizeof(uint64_t))) == NULL) {
+    avc_free((void **) &pjtBuf->pPkts);
     return -1;
   }
 
   pjtBuf->pool.maxEntries = jtBufSzPkts;
   pjtBuf->pool.entryBufSz = jtBufPktBufSz;
-  pjtBuf->sizePkts = jtBufSzPkts;
+  pjtBuf->sizePkts = sizePkts;
+  pjtBuf->maskPkts = sizePkts - 1;
+  pjtBuf->depthPkts = jtBufSzPkts;
 
   //LOG(X_DEBUG("JTBUF - created 0x%x pool size %d%d sizePkts:%d"), pjtBuf, pjtBuf->pool.maxEntries, pjtBuf->pool.entryBufSz, pjtBuf->sizePkts);
 
@@ -167,6 +271,7 @@ CAPTURE_STATE_T *rtp_captureCreate(unsigned int maxStreams,
                                    unsigned int cfgMaxVidRtpGapWaitTmMs,
                                    unsigned int cfgMaxAudRtpGapWaitTmMs) {
   CAPTURE_STATE_T *pState = NULL;
+  unsigned int idx;
   //unsigned int idxStream;
 
   if(maxStreams < 1) {
@@ -198,6 +303,10 @@ CAPTURE_STATE_T *rtp_captureCreate(unsigned int maxStreams,
     pState->pjtBufAud = &pState->jtBufAud;
   }
 
+  for(idx = 0; idx < CAPTURE_MAX_FILTERS_PCAP; idx++) {
+    pState->filterSockIdx[idx] = -1;
+  }
+
   pState->maxStreams = maxStreams;
   pState->cfgMaxVidRtpGapWaitTmMs = cfgMaxVidRtpGapWaitTmMs; 
   pState->cfgMaxAudRtpGapWaitTmMs = cfgMaxAudRtpGapWaitTmMs; 
@@ -329,6 +438,13 @@ static void init_stream(CAPTURE_STATE_T *pState, CAPTURE_STREAM_T *pStream,
   pStream->numSeqIncrOk = 0;
   pStream->numSeqIncrInvalid = 0;
   pStream->numSeqnoNacked = 0;
+  pStream->numSeqReordered = 0;
+  pStream->maxReorderDepth = 0;
+  pStream->numSeqLateDropped = 0;
+  pStream->numSeqDuplicate = 0;
+  pStream->numRcvDelay = 0;
+  pStream->rcvDelayUsTot = 0;
+  pStream->rcvDelayUsMax = 0;
   pStream->frameDeltaHz = 0;
   pStream->lastTsChangeTv.tv_sec = 0;
   pStream->lastTsChangeTv.tv_usec = 0;
@@ -352,11 +468,9 @@ static void init_stream(CAPTURE_STATE_T *pState, CAPTURE_STREAM_T *pStream,
   //LOG(X_DEBUG("INIT_STREAM-2 isvid: %d, pState->pjtBufVid: 0x%x, 0x%x, pStream->pjtBuf: 0x%x"), isvid, pState->pjtBufVid, pState->pjtBufAud, pStream->pjtBuf);
 
   if(pStream->pjtBuf && pStream->pjtBuf->pPkts) {
-    memset(pStream->pjtBuf->pPkts, 0, pStream->pjtBuf->sizePkts * sizeof(CAPTURE_JTBUF_PKT_T));
-     pStream->pjtBuf->idxPkt = 0;
-     pStream->pjtBuf->idxPktStored = 0;
-   }
-   pStream->pFilter = NULL;
+    jtbuf_reset(pStream->pjtBuf);
+  }
+  pStream->pFilter = NULL;
 
   pStream->strSrcDst[0] = '\0';
 
@@ -505,23 +619,20 @@ static void dump_jtbuf(CAPTURE_STREAM_T *pStream) {
 
   idxPkt = pStream->pjtBuf->idxPkt;
 
-  fprintf(stderr, "jtbuf: idxPkt:%d, idxPktStored:%d, startingSeq:%d, sizePkts:%d\n", 
-          pStream->pjtBuf->idxPkt, pStream->pjtBuf->idxPktStored, pStream->pjtBuf->startingSeq, pStream->pjtBuf->sizePkts);
+  fprintf(stderr, "jtbuf: idxPkt:%d, idxPktStored:%d, startingSeq:%d, highestSeq:%d, sizePkts:%d\n", 
+          pStream->pjtBuf->idxPkt, pStream->pjtBuf->idxPktStored, pStream->pjtBuf->startingSeq, 
+          pStream->pjtBuf->highestSeq, pStream->pjtBuf->sizePkts);
 
-  for(count = 0; count < pStream->pjtBuf->sizePkts; count++) {
+  for(count = 0; count < JTBUF_PENDING(pStream->pjtBuf); count++) {
 
-    if(++idxPkt >= pStream->pjtBuf->sizePkts) {
-      idxPkt = 0;
-    }
+    idxPkt = JTBUF_SLOT(pStream->pjtBuf, idxPkt + 1);
 
-    fprintf(stderr, "[%d] seq:%d, ts:%u, len:%d, tv:%u.%u flag:0x%x %s%s  nack.tvLastNack:%u.%u", idxPkt, 
+    fprintf(stderr, "[%d] seq:%d, ts:%u, len:%d, tv:%u.%u %s  nack.tvLastNack:%u.%u", idxPkt, 
        pStream->pjtBuf->pPkts[idxPkt].pktData.u.rtp.seq,
        pStream->pjtBuf->pPkts[idxPkt].pktData.u.rtp.ts,
        PKTCAPLEN(pStream->pjtBuf->pPkts[idxPkt].pktData.payload),
        pStream->pjtBuf->pPkts[idxPkt].pktData.tv.tv_sec, pStream->pjtBuf->pPkts[idxPkt].pktData.tv.tv_usec,
-       pStream->pjtBuf->pPkts[idxPkt].rcvFlag,
-       pStream->pjtBuf->pPkts[idxPkt].rcvFlag & CAPTURE_JTBUF_FLAG_IN_STREAM ? "in-stream " : "", 
-       pStream->pjtBuf->pPkts[idxPkt].rcvFlag & CAPTURE_JTBUF_FLAG_RX ? "rcvd " : "",
+       JTBUF_RX_ISSET(pStream->pjtBuf, idxPkt) ? "rcvd " : "",
        pStream->pjtBuf->pPkts[idxPkt].nack.tvLastNack.tv_sec, pStream->pjtBuf->pPkts[idxPkt].nack.tvLastNack.tv_usec);
   fprintf(stderr, "\n");
   }
@@ -534,6 +645,7 @@ static void dump_jtbuf(CAPTURE_STREAM_T *pStream) {
 static int jtbuf_createNACKs(CAPTURE_STREAM_T *pStream, const struct timeval *ptv) {
   int rc = 0;
   unsigned int count, idxPkt;
+  unsigned int pending;
   unsigned int seqNumOffset;
   int haveStartSeqnum = 0;
   uint16_t seqnum;
@@ -562,26 +674,19 @@ static int jtbuf_createNACKs(CAPTURE_STREAM_T *pStream, const struct timeval *pt
   //LOG(X_DEBUG("jtbuf_createNACK tv:%u.%u"), ptv->tv_sec, ptv->tv_usec);
   //fprintf(stderr, "jtbuf: idxPkt:%d, idxPktStored:%d, startingSeq:%d, sizePkts:%d\n", pStream->pjtBuf->idxPkt, pStream->pjtBuf->idxPktStored, pStream->pjtBuf->startingSeq, pStream->pjtBuf->sizePkts);
   seqnum = pStream->pjtBuf->startingSeq;
+  pending = JTBUF_PENDING(pStream->pjtBuf);
 
-  for(count = 0; count < pStream->pjtBuf->sizePkts; count++) {
-
-    if(++idxPkt >= pStream->pjtBuf->sizePkts) {
-      idxPkt = 0;
-    }
+  //
+  // Only the slots within the pending window, following the last played packet, are checked
+  //
+  for(count = 0; count < pending; count++) {
 
+    idxPkt = JTBUF_SLOT(pStream->pjtBuf, idxPkt + 1);
     seqnum++;
 
-    //LOG(X_DEBUG("jtbuf_donack checking jtBuf[%d].rcvFlag:0x%x, seq:%d"), idxPkt, pStream->pjtBuf->pPkts[idxPkt].rcvFlag, seqnum);
-
-    if(!(pStream->pjtBuf->pPkts[idxPkt].rcvFlag & (CAPTURE_JTBUF_FLAG_IN_STREAM))) {
-      //LOG(X_DEBUG("jtbuf_donack jtBuf[%d] breaking"), idxPkt);
-
-      //
-      // The ringbuffer packet slot is invalid or was already processed
-      //
-      break;
+    //LOG(X_DEBUG("jtbuf_donack checking jtBuf[%d] seq:%d"), idxPkt, seqnum);
 
-    } else if((pStream->pjtBuf->pPkts[idxPkt].rcvFlag & (CAPTURE_JTBUF_FLAG_RX))) {
+    if(JTBUF_RX_ISSET(pStream->pjtBuf, idxPkt)) {
       //LOG(X_DEBUG("jtbuf_donack jtBuf[%d] continue cuz its been received"), idxPkt);
 
       //
@@ -656,14 +761,12 @@ static int jtbuf_createNACKs(CAPTURE_STREAM_T *pStream, const struct timeval *pt
     TIME_TV_SET(pStream->pjtBuf->pPkts[idxPkt].nack.tvLastNack, *ptv);
    
 /*
-    fprintf(stderr, "[%d] seq:%d, ts:%u, len:%d, tv:%u.%u flag:0x%x %s%s  ", idxPkt, 
+    fprintf(stderr, "[%d] seq:%d, ts:%u, len:%d, tv:%u.%u %s  ", idxPkt, 
        pStream->pjtBuf->pPkts[idxPkt].pktData.u.rtp.seq,
        pStream->pjtBuf->pPkts[idxPkt].pktData.u.rtp.ts,
        PKTCAPLEN(pStream->pjtBuf->pPkts[idxPkt].pktData.payload),
        pStream->pjtBuf->pPkts[idxPkt].pktData.tv.tv_sec, pStream->pjtBuf->pPkts[idxPkt].pktData.tv.tv_usec,
-       pStream->pjtBuf->pPkts[idxPkt].rcvFlag,
-       pStream->pjtBuf->pPkts[idxPkt].rcvFlag & CAPTURE_JTBUF_FLAG_IN_STREAM ? "in-stream " : "", 
-       pStream->pjtBuf->pPkts[idxPkt].rcvFlag & CAPTURE_JTBUF_FLAG_RX ? "rcvd " : "");
+       JTBUF_RX_ISSET(pStream->pjtBuf, idxPkt) ? "rcvd " : "");
   fprintf(stderr, "\n");
 */
   }
@@ -687,24 +790,60 @@ static int jtbuf_createNACKs(CAPTURE_STREAM_T *pStream, const struct timeval *pt
   return rc;
 }
 
+//
+// Plays out the contiguous run of received packets following the last played packet
+//
+static void jtbuf_playout(CAPTURE_STREAM_T *pStream) {
+  CAPTURE_JTBUF_T *pjtBuf = pStream->pjtBuf;
+  CAPTURE_JTBUF_PKT_T *pJtBufPkt;
+  unsigned int idxPkt = JTBUF_SLOT(pjtBuf, pjtBuf->idxPkt + 1);
+  unsigned int run = jtbuf_runlen(pjtBuf, idxPkt, JTBUF_PENDING(pjtBuf));
+
+  while(run-- > 0) {
+
+    pJtBufPkt = &pjtBuf->pPkts[idxPkt];
+    //pStream->highestRcvdTs = pJtBufPkt->pktData.u.rtp.ts;
+
+    if(pStream->cbOnPkt) {
+
+      capture_calc_jitter(pJtBufPkt, pStream);
+
+      //LOG(X_DEBUG("---calling cbOnPkt(reorder:2) seq:%u, sz:%u rtp ts:%u caplen:%d len:%d, tm:%u,%u, %uHz, numPkts:%d"),pJtBufPkt->pktData.u.rtp.seq, (pJtBufPkt->pktData.u.rtp.marksz & PKTDATA_RTP_MASK_SZ), pJtBufPkt->pktData.u.rtp.ts, PKTCAPLEN(pJtBufPkt->pktData.payload), PKTWIRELEN(pJtBufPkt->pktData.payload), pJtBufPkt->pktData.tv.tv_sec, pJtBufPkt->pktData.tv.tv_usec, pStream->clockHz, pStream->numPkts);
+
+      pStream->cbOnPkt(pStream->pCbUserData, &(pJtBufPkt->pktData));
+    }
+    pjtBuf->startingSeq = pJtBufPkt->pktData.u.rtp.seq;
+    pStream->rtcpRR.pktcnt++;
+
+    if(pJtBufPkt->pPoolBuf) {
+      jtbufpool_put(&pjtBuf->pool, pJtBufPkt->pPoolBuf);
+      pJtBufPkt->pPoolBuf = NULL;
+    }
+    JTBUF_RX_CLR(pjtBuf, idxPkt);
+    pJtBufPkt->nack.tvLastNack.tv_sec = 0;
+    pjtBuf->idxPkt = idxPkt;
+
+    idxPkt = JTBUF_SLOT(pjtBuf, idxPkt + 1);
+  }
+
+}
+
 static int capture_reorderPkt(CAPTURE_STATE_T *pState, 
                               CAPTURE_STREAM_T *pStream, 
                               const COLLECT_STREAM_PKT_T *pPkt) {
-  unsigned short seq;
   int seqDelta = 0;
-  int seqTmp;
   int seqRoll;
   int rc;
-  unsigned int idxPkt;
+  unsigned int pending;
   unsigned int idxPktStore;
+  CAPTURE_JTBUF_T *pjtBuf = pStream->pjtBuf;
   CAPTURE_JTBUF_PKT_T *pJtBufPkt = NULL;
 
-  if(!pStream->pjtBuf) {
+  if(!pjtBuf) {
     return -1;
   }
   
-  idxPkt = pStream->pjtBuf->idxPkt;
-  pJtBufPkt = &pStream->pjtBuf->pPkts[idxPkt];
+  pJtBufPkt = &pjtBuf->pPkts[pjtBuf->idxPkt];
 
   pStream->numBytesPayload += PKTWIRELEN(pPkt->data.payload);
   pStream->numBytes += (pPkt->data.u.rtp.marksz & PKTDATA_RTP_MASK_SZ);
@@ -714,62 +853,51 @@ static int capture_reorderPkt(CAPTURE_STATE_T *pState,
   }
 
   if(pStream->numPkts == 1) {  
+    pjtBuf->idxPkt = JTBUF_SLOT(pjtBuf, pPkt->data.u.rtp.seq);
+    pJtBufPkt = &pjtBuf->pPkts[pjtBuf->idxPkt];
     memcpy(&pJtBufPkt->pktData, &pPkt->data, sizeof(COLLECT_STREAM_PKTDATA_T));
     //LOG(X_DEBUG("---calling cbOnPkt(reorder:1) pStream 0x%x pUserD:0x%x, numPkts:%d,cbOnPkt:0x%x"), pStream, pStream->pCbUserData, pStream->numPkts, pStream->cbOnPkt);
     //pStream->highestRcvdTs = pJtBufPkt->pktData.u.rtp.ts;
     if(pStream->cbOnPkt) {
       pStream->cbOnPkt(pStream->pCbUserData, &pJtBufPkt->pktData);
     }
-    pStream->pjtBuf->idxPktStored = idxPkt;
-    pStream->pjtBuf->startingSeq = pPkt->data.u.rtp.seq;
+    pjtBuf->idxPktStored = pjtBuf->idxPkt;
+    pjtBuf->startingSeq = pjtBuf->highestSeq = pPkt->data.u.rtp.seq;
     pStream->rtcpRR.pktcnt++;
     pStream->rtcpRR.rr.seqhighest = pPkt->data.u.rtp.seq;
     return 0;
   }
     
-  seqRoll = DID_UINT16_ROLL(pPkt->data.u.rtp.seq, pJtBufPkt->pktData.u.rtp.seq);
+  seqRoll = DID_UINT16_ROLL(pPkt->data.u.rtp.seq, pjtBuf->startingSeq);
   if(seqRoll) {
     pStream->rtcpRR.seqRolls++; 
   }
   pStream->rtcpRR.rr.seqhighest = pPkt->data.u.rtp.seq;
 
-  seqDelta = seqTmp = RTP_SEQ_DELTA(pPkt->data.u.rtp.seq, pJtBufPkt->pktData.u.rtp.seq);
+  seqDelta = JTBUF_SEQ_DELTA(pPkt->data.u.rtp.seq, pjtBuf->startingSeq);
 
 //  if(pPkt->hdr.payloadType==100) LOG(X_DEBUG("rtp pt:%d, ssrc:0x%x, ts:%d seq:%d delta:%d tsdelta:%d/%d, seqDelta:%d"), pPkt->hdr.payloadType, pPkt->hdr.key.ssrc, pPkt->data.u.rtp.ts, pPkt->data.u.rtp.seq, seqDelta,RTP_TS_DELTA(pPkt->data.u.rtp.ts, pJtBufPkt->pktData.u.rtp.ts), pStream->clockHz, seqDelta);
 
-  if(seqDelta < 0) {
+  if(seqDelta <= 0) {
 
-    if(pPkt->data.u.rtp.seq < pStream->pjtBuf->startingSeq) {
-      LOG(X_WARNING("Late %spacket will be discarded seq: %d < seq: %d, ssrc: 0x%x, ts: %u"), 
-          CAPTURE_STREAM_TYPESTR(pState, pStream),
-          pPkt->data.u.rtp.seq, pJtBufPkt->pktData.u.rtp.seq, pPkt->hdr.key.ssrc, pPkt->data.u.rtp.ts);
-      return 0;
-    }
-
-  } else if(seqDelta > (int) pStream->pjtBuf->sizePkts) {
-    seqTmp = pStream->pjtBuf->sizePkts;
-  }
-    
-  for(seq = 0; seq < seqTmp; seq++) {
-    if(++idxPkt >= pStream->pjtBuf->sizePkts) {
-      idxPkt = 0;
-    }
-    if(seq < seqTmp - 1 && !(pStream->pjtBuf->pPkts[idxPkt].rcvFlag & CAPTURE_JTBUF_FLAG_IN_STREAM)) {
-      pStream->pjtBuf->pPkts[idxPkt].rcvFlag |= CAPTURE_JTBUF_FLAG_IN_STREAM;
-      pStream->pjtBuf->pPkts[idxPkt].nack.tvLastNack.tv_sec = 0;
-    }
+    //
+    // The sequence number was already played out or declared lost
+    //
+    pStream->numSeqLateDropped++;
+    LOG(X_WARNING("Late %spacket will be discarded seq: %d < seq: %d, ssrc: 0x%x, ts: %u"), 
+        CAPTURE_STREAM_TYPESTR(pState, pStream),
+        pPkt->data.u.rtp.seq, pjtBuf->startingSeq, pPkt->hdr.key.ssrc, pPkt->data.u.rtp.ts);
+    return 0;
   }
 
-  idxPktStore = idxPkt;
-
-  if(seqDelta >= (int) pStream->pjtBuf->sizePkts || 
+  if(seqDelta >= (int) pjtBuf->depthPkts || 
      (seqDelta > 1 && pStream->clockHz > 0 && pStream->maxRtpGapWaitTmMs > 0 && 
     (float) (1000.0 * RTP_TS_DELTA(pPkt->data.u.rtp.ts, pJtBufPkt->pktData.u.rtp.ts) / pStream->clockHz) > 
     (float) pStream->maxRtpGapWaitTmMs)) { 
 
     LOG(X_WARNING("Flushing %s RTP jitter buffer at seq:%d (%d/%d) after waiting %.2f(/%u) ms"), 
         IS_CAP_FILTER_AUD(pStream->pFilter->mediaType) ? "audio" : "video",
-        pPkt->data.u.rtp.seq, seqDelta, pStream->pjtBuf->sizePkts, 
+        pPkt->data.u.rtp.seq, seqDelta, pjtBuf->depthPkts, 
         pStream->clockHz > 0 ? (float) (1000.0 * RTP_TS_DELTA(pPkt->data.u.rtp.ts, 
      pJtBufPkt->pktData.u.rtp.ts) / pStream->clockHz) : 0, pStream->maxRtpGapWaitTmMs);
 
@@ -780,33 +908,55 @@ static int capture_reorderPkt(CAPTURE_STATE_T *pState,
     // us when there are multiple lost gaps within the jitter buffer.
     //
     rc = capture_flushJtBuf(pState, pStream, ((pStream->pFilter->enableNack &&
-                                              seqDelta < (int) pStream->pjtBuf->sizePkts) ? pPkt : NULL));
+                                              seqDelta < (int) pjtBuf->depthPkts) ? pPkt : NULL));
 
-    if(rc + 1 >= pStream->pjtBuf->sizePkts) {
+    if(rc + 1 >= pjtBuf->depthPkts) {
       rc = seqDelta - 1;
     } 
     LOG(X_WARNING("Detected RTP %d packets lost pt:%d at seq:%u, ts:%u"), rc, 
         pPkt->hdr.payloadType, pJtBufPkt->pktData.u.rtp.seq, pJtBufPkt->pktData.u.rtp.ts);
     pStream->rtcpRR.pktdropcnt += rc;
-    if(pStream->pjtBuf->flushedAll) {
-      idxPktStore = idxPkt = 0;
-      pStream->pjtBuf->idxPkt = pStream->pjtBuf->sizePkts - 1;
-    } else {
-      idxPktStore = idxPkt;
-      idxPkt = pStream->pjtBuf->idxPkt;
-      // preserve idxPkt and pStream->pjtBuf->idxPkt, pStream->pjtBuf->idxPktStored
+
+    if(pjtBuf->flushedAll) {
+      //
+      // Restart the pending window immediately prior to this packet
+      //
+      pjtBuf->startingSeq = pjtBuf->highestSeq = (uint16_t) (pPkt->data.u.rtp.seq - 1);
+      pjtBuf->idxPkt = JTBUF_SLOT(pjtBuf, pjtBuf->startingSeq);
+      seqDelta = 1;
+    } else if((seqDelta = JTBUF_SEQ_DELTA(pPkt->data.u.rtp.seq, pjtBuf->startingSeq)) <= 0) {
+      pStream->numSeqLateDropped++;
+      return 0;
     }
-    //LOG(X_DEBUG("cbOnPkt(flush)... after flushedAll:%d, flushing rc: %d, idxPkt:%d, idxPktStore:%d, seqDelta:%d, pjtBuf->idxPkt:%d, pjtBuf->idxPktStored:%d"), pStream->pjtBuf->flushedAll, rc, idxPkt, idxPktStore, seqDelta, pStream->pjtBuf->idxPkt, pStream->pjtBuf->idxPktStored);    
+    //LOG(X_DEBUG("cbOnPkt(flush)... after flushedAll:%d, flushing rc: %d, seqDelta:%d, pjtBuf->idxPkt:%d, pjtBuf->idxPktStored:%d"), pjtBuf->flushedAll, rc, seqDelta, pjtBuf->idxPkt, pjtBuf->idxPktStored);    
 
   //} else if(seqDelta > 1 && pStream->pFilter->enableNack > 0) {
   //  jtbuf_createNACKs(pStream, &pPkt->data.tv);
   }
+
+  idxPktStore = JTBUF_SLOT(pjtBuf, pPkt->data.u.rtp.seq);
+
+  if(JTBUF_RX_ISSET(pjtBuf, idxPktStore)) {
+    pStream->numSeqDuplicate++;
+    return 0;
+  }
+
+  if(seqDelta < (int) (pending = JTBUF_PENDING(pjtBuf))) {
+    //
+    // This packet fills a gap behind the highest stored sequence number
+    //
+    pStream->numSeqReordered++;
+    if(pending - seqDelta > pStream->maxReorderDepth) {
+      pStream->maxReorderDepth = pending - seqDelta;
+    }
+  } else {
+    pjtBuf->highestSeq = pPkt->data.u.rtp.seq;
+  }
   
-  memcpy(&pStream->pjtBuf->pPkts[idxPktStore].pktData, &pPkt->data, 
-         sizeof(COLLECT_STREAM_PKTDATA_T));
-  pStream->pjtBuf->pPkts[idxPktStore].rcvFlag = CAPTURE_JTBUF_FLAG_RX | CAPTURE_JTBUF_FLAG_IN_STREAM;
-  pStream->pjtBuf->pPkts[idxPktStore].nack.tvLastNack.tv_sec = 0;
-  pStream->pjtBuf->idxPktStored = idxPktStore;
+  memcpy(&pjtBuf->pPkts[idxPktStore].pktData, &pPkt->data, sizeof(COLLECT_STREAM_PKTDATA_T));
+  JTBUF_RX_SET(pjtBuf, idxPktStore);
+  pjtBuf->pPkts[idxPktStore].nack.tvLastNack.tv_sec = 0;
+  pjtBuf->idxPktStored = idxPktStore;
 
   if(seqDelta > 1 && pStream->pFilter->enableNack > 0) {
     //dump_jtbuf(pStream);
@@ -815,56 +965,26 @@ static int capture_reorderPkt(CAPTURE_STATE_T *pState,
 
   //if(pStream->pFilter->nackFbSize) dump_jtbuf(pStream);
 
-  if((idxPkt = pStream->pjtBuf->idxPkt + 1) >= pStream->pjtBuf->sizePkts) {
-      idxPkt = 0;
-  }
-
-  while((pStream->pjtBuf->pPkts[idxPkt].rcvFlag & CAPTURE_JTBUF_FLAG_RX)) {
-
-    pJtBufPkt = &pStream->pjtBuf->pPkts[idxPkt];
-    //pStream->highestRcvdTs = pJtBufPkt->pktData.u.rtp.ts;
-
-    if(pStream->cbOnPkt) {
-
-      capture_calc_jitter(pJtBufPkt, pStream);
-
-      //LOG(X_DEBUG("---calling cbOnPkt(reorder:2) seq:%u, sz:%u rtp ts:%u caplen:%d len:%d, tm:%u,%u, %uHz, numPkts:%d"),pJtBufPkt->pktData.u.rtp.seq, (pJtBufPkt->pktData.u.rtp.marksz & PKTDATA_RTP_MASK_SZ), pJtBufPkt->pktData.u.rtp.ts, PKTCAPLEN(pJtBufPkt->pktData.payload), PKTWIRELEN(pJtBufPkt->pktData.payload), pJtBufPkt->pktData.tv.tv_sec, pJtBufPkt->pktData.tv.tv_usec, pStream->clockHz, pStream->numPkts);
-
-      pStream->cbOnPkt(pStream->pCbUserData, &(pJtBufPkt->pktData));
-    }
-    pStream->pjtBuf->startingSeq = pJtBufPkt->pktData.u.rtp.seq;
-    pStream->rtcpRR.pktcnt++;
-
-    if(pJtBufPkt->pPoolBuf) {
-      jtbufpool_put(&pStream->pjtBuf->pool, pJtBufPkt->pPoolBuf);
-      pJtBufPkt->pPoolBuf = NULL;
-    }
-    pJtBufPkt->rcvFlag = 0;
-    pJtBufPkt->nack.tvLastNack.tv_sec = 0;
-    pStream->pjtBuf->idxPkt = idxPkt;
-
-    if(++idxPkt >= pStream->pjtBuf->sizePkts) {
-      idxPkt = 0;
-    }
-
-  }
+  jtbuf_playout(pStream);
 
   //
   // Need to preserve the packet payload since this (future) packet is being kept around
   // to preserve sequence order
   //
-  if(pStream->pjtBuf->pPkts[pStream->pjtBuf->idxPktStored].rcvFlag != 0) {
+  if(JTBUF_RX_ISSET(pjtBuf, pjtBuf->idxPktStored)) {
 
-    pJtBufPkt = &pStream->pjtBuf->pPkts[pStream->pjtBuf->idxPktStored];
+    pJtBufPkt = &pjtBuf->pPkts[pjtBuf->idxPktStored];
 
-    if(PKTCAPLEN(pJtBufPkt->pktData.payload) > pStream->pjtBuf->pool.entryBufSz) {
+    if(PKTCAPLEN(pJtBufPkt->pktData.payload) > pjtBuf->pool.entryBufSz) {
       LOG(X_WARNING("Payload payload too large for jitter buffer %d > %d"), 
-               PKTCAPLEN(pJtBufPkt->pktData.payload), pStream->pjtBuf->pool.entryBufSz);
+               PKTCAPLEN(pJtBufPkt->pktData.payload), pjtBuf->pool.entryBufSz);
+      JTBUF_RX_CLR(pjtBuf, pjtBuf->idxPktStored);
       return 0;
     } else if(pJtBufPkt->pPoolBuf == NULL) {
-      if((pJtBufPkt->pPoolBuf = jtbufpool_get(&pStream->pjtBuf->pool)) == NULL) {
+      if((pJtBufPkt->pPoolBuf = jtbufpool_get(&pjtBuf->pool)) == NULL) {
         LOG(X_ERROR("Failed to get reordering packet buffer from pool of size %d/%d."), 
-                    pStream->pjtBuf->pool.numAllocEntries, pStream->pjtBuf->pool.maxEntries);
+                    pjtBuf->pool.numAllocEntries, pjtBuf->pool.maxEntries);
+        JTBUF_RX_CLR(pjtBuf, pjtBuf->idxPktStored);
         return -1;
       }
     }
@@ -881,80 +1001,79 @@ static int capture_reorderPkt(CAPTURE_STATE_T *pState,
 static int capture_flushJtBuf(CAPTURE_STATE_T *pState, CAPTURE_STREAM_T *pStream, const COLLECT_STREAM_PKT_T *pPkt) {
 
   unsigned int count;
+  unsigned int pending;
+  CAPTURE_JTBUF_T *pjtBuf = pStream->pjtBuf;
   CAPTURE_JTBUF_PKT_T *pJtBufPkt = NULL;
   COLLECT_STREAM_PKTDATA_T pkt;
   int numlost = 0;
   int stopFlushingOnGap = -1;
   float maxRtpGapWaitTmMs = 0;
 
+  if(!pjtBuf || !pjtBuf->pPkts) {
+    return 0;
+  }
+
   if(pPkt && pStream->clockHz > 0 && pStream->maxRtpGapWaitTmMs > 0) {
     maxRtpGapWaitTmMs = (float) pStream->maxRtpGapWaitTmMs - (.2f * (float) pStream->maxRtpGapWaitTmMs);
   }
 
-  for(count = 0; count < pStream->pjtBuf->sizePkts; count++) {
-
-    if(++pStream->pjtBuf->idxPkt >= pStream->pjtBuf->sizePkts) {
-      pStream->pjtBuf->idxPkt = 0;
-    }
-    pJtBufPkt = &pStream->pjtBuf->pPkts[pStream->pjtBuf->idxPkt];
+  pending = JTBUF_PENDING(pjtBuf);
 
-    if(pJtBufPkt->rcvFlag & CAPTURE_JTBUF_FLAG_IN_STREAM) {
+  for(count = 0; count < pending; count++) {
 
-      //pStream->highestRcvdTs = pJtBufPkt->pktData.u.rtp.ts;
+    pjtBuf->idxPkt = JTBUF_SLOT(pjtBuf, pjtBuf->idxPkt + 1);
+    pjtBuf->startingSeq = (uint16_t) (pjtBuf->startingSeq + 1);
+    pJtBufPkt = &pjtBuf->pPkts[pjtBuf->idxPkt];
 
-      if(pJtBufPkt->rcvFlag & CAPTURE_JTBUF_FLAG_RX) {
+    //pStream->highestRcvdTs = pJtBufPkt->pktData.u.rtp.ts;
 
-        if(pStream->cbOnPkt) {
-          //LOG(X_DEBUG("---calling cbOnPkt(flush) seq:%u, sz:%u rtp ts:%u caplen:%d len:%d"),pJtBufPkt->pktData.u.rtp.seq, (pJtBufPkt->pktData.u.rtp.marksz & PKTDATA_RTP_MASK_SZ), pJtBufPkt->pktData.u.rtp.ts, PKTCAPLEN(pJtBufPkt->pktData.payload), PKTWIRELEN(pJtBufPkt->pktData.payload));
+    if(JTBUF_RX_ISSET(pjtBuf, pjtBuf->idxPkt)) {
 
-          pStream->cbOnPkt(pStream->pCbUserData, &pJtBufPkt->pktData);
-        }
-        pStream->pjtBuf->startingSeq = pJtBufPkt->pktData.u.rtp.seq;
-        pStream->rtcpRR.pktcnt++;
-        if(stopFlushingOnGap == 0 && maxRtpGapWaitTmMs > 0.0f &&
-           (float) (1000.0 * RTP_TS_DELTA(pPkt->data.u.rtp.ts, pJtBufPkt->pktData.u.rtp.ts) / pStream->clockHz) <
-            maxRtpGapWaitTmMs) {
-          stopFlushingOnGap = 1;
-        }
+      if(pStream->cbOnPkt) {
+        //LOG(X_DEBUG("---calling cbOnPkt(flush) seq:%u, sz:%u rtp ts:%u caplen:%d len:%d"),pJtBufPkt->pktData.u.rtp.seq, (pJtBufPkt->pktData.u.rtp.marksz & PKTDATA_RTP_MASK_SZ), pJtBufPkt->pktData.u.rtp.ts, PKTCAPLEN(pJtBufPkt->pktData.payload), PKTWIRELEN(pJtBufPkt->pktData.payload));
 
-      } else {
+        pStream->cbOnPkt(pStream->pCbUserData, &pJtBufPkt->pktData);
+      }
+      pStream->rtcpRR.pktcnt++;
+      if(stopFlushingOnGap == 0 && maxRtpGapWaitTmMs > 0.0f &&
+         (float) (1000.0 * RTP_TS_DELTA(pPkt->data.u.rtp.ts, pJtBufPkt->pktData.u.rtp.ts) / pStream->clockHz) <
+          maxRtpGapWaitTmMs) {
+        stopFlushingOnGap = 1;
+      }
 
-        if(stopFlushingOnGap == -1) {
-          stopFlushingOnGap = 0;
-        } if(stopFlushingOnGap == 1) {
-          stopFlushingOnGap = 2;
-          if(pStream->pjtBuf->idxPkt > 0) {
-            pStream->pjtBuf->idxPkt--;
-          } else {
-            pStream->pjtBuf->idxPkt = pStream->pjtBuf->sizePkts - 1;
-          }
-          //LOG(X_DEBUG("---not calling cbOnPkt(flush) pJtBuf->idxPkt back to: %d"), pStream->pjtBuf->idxPkt);
-          break;
-        }
+    } else {
 
-        numlost++;
-        if(pStream->cbOnPkt) {
-          memset(&pkt, 0, sizeof(pkt));
-          //LOG(X_DEBUG("---calling cbOnPkt(flush) FLAG_XR not set"));
-          pStream->cbOnPkt(pStream->pCbUserData, &pkt);
-        }
+      if(stopFlushingOnGap == -1) {
+        stopFlushingOnGap = 0;
+      } if(stopFlushingOnGap == 1) {
+        stopFlushingOnGap = 2;
+        pjtBuf->idxPkt = JTBUF_SLOT(pjtBuf, pjtBuf->idxPkt - 1);
+        pjtBuf->startingSeq = (uint16_t) (pjtBuf->startingSeq - 1);
+        //LOG(X_DEBUG("---not calling cbOnPkt(flush) pJtBuf->idxPkt back to: %d"), pjtBuf->idxPkt);
+        break;
       }
 
-      pJtBufPkt->rcvFlag = 0;        
-      pJtBufPkt->nack.tvLastNack.tv_sec = 0;
-      if(pJtBufPkt->pPoolBuf) {
-        jtbufpool_put(&pStream->pjtBuf->pool, pJtBufPkt->pPoolBuf);
-        pJtBufPkt->pPoolBuf = NULL;
+      numlost++;
+      if(pStream->cbOnPkt) {
+        memset(&pkt, 0, sizeof(pkt));
+        //LOG(X_DEBUG("---calling cbOnPkt(flush) FLAG_XR not set"));
+        pStream->cbOnPkt(pStream->pCbUserData, &pkt);
       }
     }
 
+    JTBUF_RX_CLR(pjtBuf, pjtBuf->idxPkt);
+    pJtBufPkt->nack.tvLastNack.tv_sec = 0;
+    if(pJtBufPkt->pPoolBuf) {
+      jtbufpool_put(&pjtBuf->pool, pJtBufPkt->pPoolBuf);
+      pJtBufPkt->pPoolBuf = NULL;
+    }
+
   } 
 
   if(stopFlushingOnGap != 2) {
-    pStream->pjtBuf->idxPkt = 0;
-    pStream->pjtBuf->flushedAll = 1;
+    pjtBuf->flushedAll = 1;
   } else {
-    pStream->pjtBuf->flushedAll = 0;
+    pjtBuf->flushedAll = 0;
   }
 
   return numlost;
@@ -1055,6 +1174,7 @@ const CAPTURE_STREAM_T *capture_processRtp(CAPTURE_STATE_T *pState,
   int seqDelta;
   int tsDelta;
   int rc;
+  TIME_VAL tmProfile = 0;
 
   VSX_DEBUG_RTP(
     LOG(X_DEBUG("RTP - rtp-recv tv:%lu:%u ssrc:0x%x, pt:%u, seq:%u, mark:%u rtp ts:%u, len:%d, numPkts:%llu"), 
@@ -1086,6 +1206,10 @@ const CAPTURE_STREAM_T *capture_processRtp(CAPTURE_STATE_T *pState,
   }
   if(dropped_v||dropped_a) { LOG(X_DEBUG("DROP CAPTURE pt:%d, seq:%u (%d), ts:%u, vid-loss:%.2f%%, aud-loss;%.2f%%"),  (pPkt->hdr.payloadType & RTP_PT_MASK),  pPkt->data.u.rtp.seq, pPkt->data.u.rtp.seq - (dropped_v ? rcv_seq0_v : rcv_seq0_a), pPkt->data.u.rtp.ts, pkt_drop_percent_v *100.0f, pkt_drop_percent_a * 100.0f); return NULL;}
 #endif // (DROP_RTP)
+
+  if(pState->pProfile) {
+    tmProfile = timer_GetTimeNs();
+  }
   
   pthread_mutex_lock(&pState->mutexStreams);
 
@@ -1111,8 +1235,11 @@ const CAPTURE_STREAM_T *capture_processRtp(CAPTURE_STATE_T *pState,
     if(pFilter && codectype_isVid(pStream->pFilter->mediaType)) {
       pStream->fir_send_intervalms = FIR_INTERVAL_MS_XMIT_RTCP;
       pStream->appremb_send_intervalms = APPREMB_INTERVAL_MS_XMIT_RTCP;
-      capture_abr_init(&pState->rembAbr);
-      pStream->pRembAbr = &pState->rembAbr;
+      //
+      // Each stream has its own REMB state since streams may be processed by different receive workers
+      //
+      capture_abr_init(&pStream->rembAbr);
+      pStream->pRembAbr = &pStream->rembAbr;
     }
    
     //
@@ -1161,11 +1288,27 @@ const CAPTURE_STREAM_T *capture_processRtp(CAPTURE_STATE_T *pState,
 
   pthread_mutex_unlock(&pState->mutexStreams);
 
+  if(pState->pProfile) {
+    CAPTURE_PROFILE_ADD(pState->pProfile->lookup, tmProfile);
+  }
+
   //fprintf(stderr, "pStream: 0x%x pFilter: 0x%x numPkts:%llu, rtp-seq:%d, ssrc: 0x%x\n", pStream, pStream->pFilter, pStream->numPkts, pPkt->data.u.rtp.seq, pPkt->hdr.key.ssrc);
 
   pStream->numPkts++;
   pStream->tmLastPkt = ((TIME_VAL)pPkt->data.tv.tv_sec * TIME_VAL_US) + pPkt->data.tv.tv_usec;
 
+  //
+  // The arrival time is the kernel receive timestamp, so any host scheduling delay until the packet 
+  // was read is accounted for separately from network jitter
+  //
+  if(pPkt->data.flags & PKT_FLAGS_RCVTS_KERNEL) {
+    pStream->numRcvDelay++;
+    pStream->rcvDelayUsTot += pPkt->data.rcvDelayUs;
+    if(pPkt->data.rcvDelayUs > pStream->rcvDelayUsMax) {
+      pStream->rcvDelayUsMax = pPkt->data.rcvDelayUs;
+    }
+  }
+
   if(pStream->numPkts > 1) {
 
     pPktDataLast  = &pStream->pjtBuf->pPkts[pStream->pjtBuf->idxPktStored].pktData;
@@ -1340,6 +1483,7 @@ int capture_decodeUdpRaw(const struct ether_header *peth,
   pkt->data.payload.pRtp = NULL;
   pkt->data.tv.tv_sec = pkthdr->ts.tv_sec;
   pkt->data.tv.tv_usec = pkthdr->ts.tv_usec;
+  pkt->data.rcvDelayUs = 0;
 
   return 0;
 }
@@ -1463,6 +1607,51 @@ int capture_decodeRtp(const struct ether_header *peth,
   pkt->data.tv.tv_sec = pkthdr->ts.tv_sec;
   pkt->data.tv.tv_usec = pkthdr->ts.tv_usec;
   pkt->data.flags = 0;
+  pkt->data.rcvDelayUs = 0;
+
+  return 0;
+}
+
+//
+// Returns the index of the capture socket a stream was received on, or -1.  Audio and video
+// filters muxed onto one socket both map to that socket.
+//
+static int capture_streamSockIdx(const CAPTURE_STATE_T *pState, const CAPTURE_STREAM_T *pStream) {
+
+  if(pStream->pFilter && pStream->pFilter >= pState->filt.filters &&
+     pStream->pFilter < &pState->filt.filters[CAPTURE_MAX_FILTERS_PCAP]) {
+    return pState->filterSockIdx[pStream->pFilter - pState->filt.filters];
+  }
+
+  return -1;
+}
+
+//
+// Splits the RTP sequence gaps of all streams received on the capture socket idx into 
+// datagrams dropped by the local socket receive queue and those lost in the network.
+// A kernel drop also shows up as a sequence gap, so it is subtracted from the gap count.
+//
+int rtp_captureGetDropStats(const CAPTURE_STATE_T *pState, unsigned int idx, CAPTURE_DROP_STATS_T *pStats) {
+  unsigned int streamIdx;
+  uint64_t lost = 0;
+
+  if(!pState || !pStats || idx >= CAPTURE_MAX_FILTERS_PCAP) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&((CAPTURE_STATE_T *) pState)->mutexStreams);
+
+  for(streamIdx = 0; streamIdx < pState->maxStreams; streamIdx++) {
+    if(pState->pStreams[streamIdx].numPkts > 0 && 
+       capture_streamSockIdx(pState, &pState->pStreams[streamIdx]) == (int) idx) {
+      lost += MAX(pState->pStreams[streamIdx].rtcpRR.pktdroptot, pState->pStreams[streamIdx].rtcpRR.pktdropcnt);
+    }
+  }
+
+  pStats->kernelDrops = pState->numKernelDrops[idx];
+  pStats->netLoss = lost > pStats->kernelDrops ? lost - pStats->kernelDrops : 0;
+
+  pthread_mutex_unlock(&((CAPTURE_STATE_T *) pState)->mutexStreams);
 
   return 0;
 }
@@ -1471,13 +1660,18 @@ static int rtp_capturePrint2Buf(const CAPTURE_STATE_T *pState, char *buf, unsign
 
   int rc = 0;
   unsigned int idx, tmp;
+  unsigned int kernelDrops;
+  long long kernelDropsTot = 0;
+  int sockIdx;
   const COLLECT_STREAM_HDR_T  *pPktHdr;
   const COLLECT_STREAM_PKTDATA_T *pPktDataLast;
   uint64_t tsDelta;
   unsigned int idxbuf = 0;
-  char tmpBuf[64];
+  char tmpBuf[96];
   char tmpBuf2[64];
   char tmpBuf3[64];
+  char tmpBuf4[96];
+  char tmpBuf5[96];
   //uint64_t tvElapsedUs0;
   uint64_t tsElapsedHz0;
   double tsElapsedMs0;
@@ -1498,11 +1692,22 @@ static int rtp_capturePrint2Buf(const CAPTURE_STATE_T *pState, char *buf, unsign
     idxbuf += rc;
   }
 
+  for(idx = 0; idx < CAPTURE_MAX_FILTERS_PCAP; idx++) {
+    kernelDropsTot += pState->numKernelDrops[idx];
+  }
+
+  if(kernelDropsTot > 0 && (rc = snprintf(&buf[idxbuf], sz - idxbuf, ", kernel drops: %"LL64"u",
+                                          kernelDropsTot)) > 0) {
+    idxbuf += rc;
+  }
+
   for(idx = 0; idx < pState->maxStreams; idx++) {
 
     tmpBuf[0] = '\0';
     tmpBuf2[0] = '\0';
     tmpBuf3[0] = '\0';
+    tmpBuf4[0] = '\0';
+    tmpBuf5[0] = '\0';
 
     if(pState->pStreams[idx].numSeqIncrOk >= RTP_SEQ_INCR_MIN) {
       pPktHdr = &pState->pStreams[idx].hdr;
@@ -1513,7 +1718,14 @@ static int rtp_capturePrint2Buf(const CAPTURE_STATE_T *pState, char *buf, unsign
       
         tmp = MAX(pState->pStreams[idx].rtcpRR.pktdroptot, pState->pStreams[idx].rtcpRR.pktdropcnt);
         f = (float) tmp * 100.0f / pState->pStreams[idx].numPkts;
-        snprintf(tmpBuf, sizeof(tmpBuf), " lost:%u, %.2f%%,", tmp, f);
+        if((sockIdx = capture_streamSockIdx(pState, &pState->pStreams[idx])) >= 0 &&
+           pState->numKernelDrops[sockIdx] > 0) {
+          kernelDrops = (unsigned int) MIN(pState->numKernelDrops[sockIdx], tmp);
+          snprintf(tmpBuf, sizeof(tmpBuf), " lost:%u, %.2f%% (kernel:%u, network:%u),", 
+                   tmp, f, kernelDrops, tmp - kernelDrops);
+        } else {
+          snprintf(tmpBuf, sizeof(tmpBuf), " lost:%u, %.2f%%,", tmp, f);
+        }
       }
 
       if(pState->pStreams[idx].numSeqnoNacked > 0 && pState->pStreams[idx].numPkts > 0) {
@@ -1521,6 +1733,19 @@ static int rtp_capturePrint2Buf(const CAPTURE_STATE_T *pState, char *buf, unsign
         snprintf(tmpBuf3, sizeof(tmpBuf3), " nacked:%u, %.2f%%,", pState->pStreams[idx].numSeqnoNacked, f);
       }
 
+      if(pState->pStreams[idx].numSeqReordered > 0 || pState->pStreams[idx].numSeqLateDropped > 0 ||
+         pState->pStreams[idx].numSeqDuplicate > 0) {
+        snprintf(tmpBuf4, sizeof(tmpBuf4), " reordered:%u (max depth:%u), late:%u, duplicate:%u,", 
+                 pState->pStreams[idx].numSeqReordered, pState->pStreams[idx].maxReorderDepth,
+                 pState->pStreams[idx].numSeqLateDropped, pState->pStreams[idx].numSeqDuplicate);
+      }
+
+      if(pState->pStreams[idx].numRcvDelay > 0) {
+        snprintf(tmpBuf5, sizeof(tmpBuf5), " (kernel), dequeue delay avg:%.2fms, max:%.2fms",
+                 (double) pState->pStreams[idx].rcvDelayUsTot / pState->pStreams[idx].numRcvDelay / 1000.0,
+                 (double) pState->pStreams[idx].rcvDelayUsMax / 1000.0);
+      }
+
       durationUs = ((double)(pState->pStreams[idx].lastTsChangeTv.tv_sec - 
                      pPktHdr->tvStart.tv_sec) * TIME_VAL_US) +
                (pState->pStreams[idx].lastTsChangeTv.tv_usec - pPktHdr->tvStart.tv_usec);
@@ -1564,14 +1789,14 @@ static int rtp_capturePrint2Buf(const CAPTURE_STATE_T *pState, char *buf, unsign
         rfc3550jitterMs = 0.0f; 
       }
 
-      if((rc = snprintf(&buf[idxbuf], sz - idxbuf, "\nRTP %s, ssrc:0x%x, pt:%u, tos:0x%x, pkts:%"LL64"u,%s%s"
+      if((rc = snprintf(&buf[idxbuf], sz - idxbuf, "\nRTP %s, ssrc:0x%x, pt:%u, tos:0x%x, pkts:%"LL64"u,%s%s%s"
           " net:%.3fKbit/s, data:%.3fKbit/s,\nduration:%.3fs %.1fHz %.1ffps, seq:%u, ts:%uHz"
-          ", rfc-jitter: %.1fms, arrival delta:%lldms%s",
+          ", rfc-jitter: %.1fms%s, arrival delta:%lldms%s",
             pState->pStreams[idx].strSrcDst, 
             pPktHdr->key.ssrc,  pPktHdr->payloadType, pPktHdr->ipTos, 
-            pState->pStreams[idx].numPkts, tmpBuf, tmpBuf3, bwNet, bwPayload, 
+            pState->pStreams[idx].numPkts, tmpBuf, tmpBuf3, tmpBuf4, bwNet, bwPayload, 
             durationUs / TIME_VAL_US_FLOAT, clockHz, fps, pPktDataLast->u.rtp.seq, pPktDataLast->u.rtp.ts,
-            rfc3550jitterMs, deltaMs, tmpBuf2)) >= 0) {
+            rfc3550jitterMs, tmpBuf5, (long long) deltaMs, tmpBuf2)) >= 0) {
 
         idxbuf += rc;
       }
@@ -1442,7 +1442,7 @@ int capture_rtsp_onpkt_interleaved(RTSP_CLIENT_SESSION_T *pSession, CAP_ASYNC_DE
       }
     } else {
       if(!(pStream = capture_onUdpSockPkt(pState, &buf[4], dataLen, 0, (const struct sockaddr *) &saSrc, 
-                                          (const struct sockaddr *) &saDst, &tv, NULL))) {
+                                          (const struct sockaddr *) &saDst, &tv, -1, NULL))) {
         LOG(X_WARNING("RTSP interleaved RTP packet on channel %d, len:%d not processed"), channelId, dataLen);
       }
     }
@@ -30,6 +30,24 @@
 
 #if defined(VSX_HAVE_CAPTURE)
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define CAPTURE_SOCKET_EPOLL 1
+#if defined(SO_TIMESTAMPNS)
+#define CAPTURE_SOCKET_RCVTS 1
+#endif // SO_TIMESTAMPNS
+#if defined(SO_RXQ_OVFL)
+#define CAPTURE_SOCKET_RXQOVFL 1
+#endif // SO_RXQ_OVFL
+#endif // __linux__
+
+#if defined(CAPTURE_SOCKET_RCVTS) || defined(CAPTURE_SOCKET_RXQOVFL)
+#define CAPTURE_SOCKET_RECVMSG 1
+#endif // CAPTURE_SOCKET_RCVTS || CAPTURE_SOCKET_RXQOVFL
+
+#define CAPTURE_RCVBUF_GROW_INTERVAL_MS   1000
+#define CAPTURE_DROPSTATS_INTERVAL_MS     1000
+
 //#define IS_TURN_ENABLED(filter) (filter).stun.pTurn && (filter).turn.relay_active
 #define DEPRECATED_IS_TURN_ENABLED(filter) (filter).turn.relay_active
 #define IS_SOCK_TURN(pnetsock) ((pnetsock)->turn.use_turn_indication_in)
@@ -307,6 +325,9 @@ static int capture_openLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_FILTERS_T *
   CAPTURE_FILTER_T *pFilter = NULL;
   CAPTURE_FILTER_T *pFilterPeer = NULL;
   SOCKET_LIST_T *pSockList = pCfg->pSockList;
+#if defined(CAPTURE_SOCKET_RECVMSG)
+  int tmpval;
+#endif // CAPTURE_SOCKET_RECVMSG
 #if defined(VSX_HAVE_SSL_DTLS)
   DTLS_KEY_UPDATE_CTXT_T dtlsKeysUpdateCtxts[2];
   int dtls_handshake_client = 0;
@@ -346,6 +367,30 @@ static int capture_openLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_FILTERS_T *
     }
      LOG(X_DEBUG("Created RTP capture socket on port:%d"), htons(INET_PORT(pSockList->salist[idx])));
 
+#if defined(CAPTURE_SOCKET_RCVTS)
+    //
+    // Request a kernel receive timestamp with each datagram
+    //
+    tmpval = 1;
+    if(setsockopt(NETIOSOCK_FD(pSockList->netsockets[idx]), SOL_SOCKET, SO_TIMESTAMPNS, 
+                  (void *) &tmpval, sizeof(tmpval)) != 0) {
+      LOG(X_WARNING("Unable to set SO_TIMESTAMPNS on RTP capture socket port:%d "ERRNO_FMT_STR), 
+          htons(INET_PORT(pSockList->salist[idx])), ERRNO_FMT_ARGS);
+    }
+#endif // CAPTURE_SOCKET_RCVTS
+
+#if defined(CAPTURE_SOCKET_RXQOVFL)
+    //
+    // Request the count of datagrams dropped by the socket receive queue with each datagram
+    //
+    tmpval = 1;
+    if(setsockopt(NETIOSOCK_FD(pSockList->netsockets[idx]), SOL_SOCKET, SO_RXQ_OVFL, 
+                  (void *) &tmpval, sizeof(tmpval)) != 0) {
+      LOG(X_WARNING("Unable to set SO_RXQ_OVFL on RTP capture socket port:%d "ERRNO_FMT_STR), 
+          htons(INET_PORT(pSockList->salist[idx])), ERRNO_FMT_ARGS);
+    }
+#endif // CAPTURE_SOCKET_RXQOVFL
+
     if(net_setsocknonblock(NETIOSOCK_FD(pSockList->netsockets[idx]), 1) < 0) {
       capture_closeLocalSockets(pCfg, pFilt);
       return -1;
@@ -608,8 +653,22 @@ typedef struct CAPTURE_SOCKET_CTXT {
   TIME_VAL                       tmLastRtcpFir[SOCKET_LIST_MAX];
   TIME_VAL                       tmLastRtcpAppRemb[SOCKET_LIST_MAX];
   TIME_VAL                       tmlastpkt;
+  pthread_mutex_t                mtx;    // serializes RTCP feedback between the reader and receive workers
 } CAPTURE_SOCKET_CTXT_T;
 
+//
+// State shared by the socket reader with the capture receive workers
+//
+typedef struct CAPTURE_SOCKET_RCVCTXT {
+  CAP_ASYNC_DESCR_T             *pCfg;
+  CAPTURE_STATE_T               *pState;
+  CAPTURE_SOCKET_CTXT_T         *pCtxt;
+  pthread_mutex_t               *pmtx_sendonly;
+  const int                     *phave_sendonly_generator;
+  const int                     *psendonly;
+  const int                     *pno_output;
+} CAPTURE_SOCKET_RCVCTXT_T;
+
 static int send_rtcp_toxmitter(CAPTURE_SOCKET_CTXT_T *pCtxt,
                                const CAPTURE_STREAM_T *pStream,
                                SOCKET_LIST_T *pSockList, 
@@ -1353,6 +1412,477 @@ static int rcv_check_stun(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_FILTERS_T *pFilt,
 }
 
 
+//
+// Reads a datagram from an RTP capture socket.  If the kernel attached a receive timestamp, 
+// it is stored in ptvRcv, and if it attached the socket receive queue drop counter, it is 
+// stored in pRxqOvfl.  Otherwise ptvRcv and pRxqOvfl are left unchanged.
+//
+static int capture_recvfrom(SOCKET fd, unsigned char *pData, unsigned int szData,
+                            struct sockaddr_storage *psaSrc, int *plen, struct timeval *ptvRcv,
+                            uint32_t *pRxqOvfl) {
+#if defined(CAPTURE_SOCKET_RECVMSG)
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *pcmsg;
+#if defined(CAPTURE_SOCKET_RCVTS)
+  struct timespec ts;
+#endif // CAPTURE_SOCKET_RCVTS
+  union {
+    struct cmsghdr hdr;
+    unsigned char buf[CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t))];
+  } ctrl;
+  int rc;
+
+  iov.iov_base = pData;
+  iov.iov_len = szData;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name = psaSrc;
+  msg.msg_namelen = *plen;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = ctrl.buf;
+  msg.msg_controllen = sizeof(ctrl.buf);
+
+  if((rc = recvmsg(fd, &msg, 0)) > 0) {
+
+    *plen = msg.msg_namelen;
+
+    for(pcmsg = CMSG_FIRSTHDR(&msg); pcmsg; pcmsg = CMSG_NXTHDR(&msg, pcmsg)) {
+      if(pcmsg->cmsg_level != SOL_SOCKET) {
+        continue;
+      }
+#if defined(CAPTURE_SOCKET_RCVTS)
+      if(pcmsg->cmsg_type == SCM_TIMESTAMPNS) {
+        memcpy(&ts, CMSG_DATA(pcmsg), sizeof(ts));
+        ptvRcv->tv_sec = ts.tv_sec;
+        ptvRcv->tv_usec = ts.tv_nsec / 1000;
+      }
+#endif // CAPTURE_SOCKET_RCVTS
+#if defined(CAPTURE_SOCKET_RXQOVFL)
+      if(pcmsg->cmsg_type == SO_RXQ_OVFL) {
+        memcpy(pRxqOvfl, CMSG_DATA(pcmsg), sizeof(uint32_t));
+      }
+#endif // CAPTURE_SOCKET_RXQOVFL
+    }
+  }
+
+  return rc;
+
+#else // CAPTURE_SOCKET_RECVMSG
+
+  return recvfrom(fd, (void *) pData, szData, 0, (struct sockaddr *) psaSrc, (socklen_t *) plen);
+
+#endif // CAPTURE_SOCKET_RECVMSG
+}
+
+//
+// Per capture socket kernel drop accounting.  SO_RXQ_OVFL reports the cumulative count 
+// of datagrams the socket receive queue dropped, so only the increase since the last 
+// report is new loss.  When enabled, the socket receive buffer is doubled (up to the
+// configured limit) each time new drops are seen, at most once per grow interval.
+//
+typedef struct CAPTURE_SOCKDROPS {
+  SOCKET                    fds[SOCKET_LIST_MAX];       // socket the counters belong to
+  uint32_t                  rxqOvfl[SOCKET_LIST_MAX];   // last reported SO_RXQ_OVFL counter
+  unsigned int              rcvBufReq[SOCKET_LIST_MAX]; // last requested SO_RCVBUF
+  unsigned int              rcvBufSz[SOCKET_LIST_MAX];  // SO_RCVBUF as reported by the kernel
+  TIME_VAL                  tmGrow[SOCKET_LIST_MAX];
+  TIME_VAL                  tmPublish;
+} CAPTURE_SOCKDROPS_T;
+
+static unsigned int sockdrops_getrcvbuf(SOCKET fd) {
+  int sz = 0;
+  socklen_t len = sizeof(sz);
+
+  if(getsockopt(fd, SOL_SOCKET, SO_RCVBUF, (char *) &sz, &len) != 0 || sz < 0) {
+    return 0;
+  }
+
+  return (unsigned int) sz;
+}
+
+static void sockdrops_reset(CAPTURE_SOCKDROPS_T *pDrops, unsigned int idx, SOCKET fd) {
+  pDrops->fds[idx] = fd;
+  pDrops->rxqOvfl[idx] = 0;
+  pDrops->rcvBufReq[idx] = SOCK_RCVBUFSZ_UDP_DEFAULT;
+  pDrops->rcvBufSz[idx] = sockdrops_getrcvbuf(fd);
+  pDrops->tmGrow[idx] = 0;
+}
+
+static void sockdrops_init(CAPTURE_SOCKDROPS_T *pDrops, const CAP_ASYNC_DESCR_T *pCfg) {
+  unsigned int idx;
+
+  memset(pDrops, 0, sizeof(CAPTURE_SOCKDROPS_T));
+  for(idx = 0; idx < SOCKET_LIST_MAX; idx++) {
+    pDrops->fds[idx] = INVALID_SOCKET;
+  }
+
+  if(pCfg->pStreamerCfg) {
+    pthread_mutex_lock(&pCfg->pStreamerCfg->sharedCtxt.mtxRtcpHdlr);
+    memset(pCfg->pStreamerCfg->sharedCtxt.capDrops, 0, sizeof(pCfg->pStreamerCfg->sharedCtxt.capDrops));
+    pthread_mutex_unlock(&pCfg->pStreamerCfg->sharedCtxt.mtxRtcpHdlr);
+  }
+}
+
+static void sockdrops_growrcvbuf(CAPTURE_SOCKDROPS_T *pDrops, const CAP_ASYNC_DESCR_T *pCfg, 
+                                 unsigned int idx, uint32_t numDrops) {
+  TIME_VAL tm;
+  unsigned int rcvBufSzPrev;
+  int rcvBufReq;
+
+  if(pDrops->rcvBufReq[idx] >= pCfg->pcommon->rcvbuf_max ||
+     ((tm = timer_GetTime()) - pDrops->tmGrow[idx]) / TIME_VAL_MS < CAPTURE_RCVBUF_GROW_INTERVAL_MS) {
+    return;
+  }
+
+  pDrops->tmGrow[idx] = tm;
+  rcvBufSzPrev = pDrops->rcvBufSz[idx];
+  rcvBufReq = (int) MIN(pDrops->rcvBufReq[idx] * 2, pCfg->pcommon->rcvbuf_max);
+
+  if(setsockopt(pDrops->fds[idx], SOL_SOCKET, SO_RCVBUF, (char *) &rcvBufReq, sizeof(rcvBufReq)) != 0) {
+    LOG(X_WARNING("Unable to grow RTP capture socket port:%d receive buffer to %d "ERRNO_FMT_STR),
+        htons(INET_PORT(pCfg->pSockList->salist[idx])), rcvBufReq, ERRNO_FMT_ARGS);
+    pDrops->rcvBufReq[idx] = pCfg->pcommon->rcvbuf_max;
+    return;
+  }
+
+  pDrops->rcvBufReq[idx] = rcvBufReq;
+  pDrops->rcvBufSz[idx] = sockdrops_getrcvbuf(pDrops->fds[idx]);
+
+  if(pDrops->rcvBufSz[idx] <= rcvBufSzPrev) {
+    //
+    // The kernel limit (net.core.rmem_max) has been reached
+    //
+    LOG(X_WARNING("RTP capture socket port:%d receive buffer limited to %u bytes after %u kernel drops"),
+        htons(INET_PORT(pCfg->pSockList->salist[idx])), pDrops->rcvBufSz[idx], numDrops);
+    pDrops->rcvBufReq[idx] = pCfg->pcommon->rcvbuf_max;
+  } else {
+    LOG(X_INFO("Increased RTP capture socket port:%d receive buffer %u -> %u bytes after %u kernel drops"),
+        htons(INET_PORT(pCfg->pSockList->salist[idx])), rcvBufSzPrev, pDrops->rcvBufSz[idx], numDrops);
+  }
+
+}
+
+//
+// Maps each capture filter to the socket it is received on.  numKernelDrops is indexed by socket,
+// and audio and video filters muxed onto a single socket both map to socket 0.
+//
+static void sockdrops_mapfilters(CAPTURE_STATE_T *pState, const SOCKET_LIST_T *pSockList) {
+  unsigned int idx;
+
+  for(idx = 0; idx < CAPTURE_MAX_FILTERS_PCAP; idx++) {
+    if(idx >= pState->filt.numFilters) {
+      pState->filterSockIdx[idx] = -1;
+    } else if(pState->filt.numFilters == 2 && pSockList->numSockets == 1) {
+      pState->filterSockIdx[idx] = 0;
+    } else {
+      pState->filterSockIdx[idx] = idx < pSockList->numSockets ? (int) idx : -1;
+    }
+  }
+
+}
+
+//
+// Accounts for the SO_RXQ_OVFL counter received with a datagram on capture socket idx
+//
+static void sockdrops_update(CAPTURE_SOCKDROPS_T *pDrops, const CAP_ASYNC_DESCR_T *pCfg, 
+                             CAPTURE_STATE_T *pState, unsigned int idx, uint32_t rxqOvfl) {
+  SOCKET fd = NETIOSOCK_FD(pCfg->pSockList->netsockets[idx]);
+  uint32_t numDrops;
+
+  if(pDrops->fds[idx] != fd) {
+    sockdrops_reset(pDrops, idx, fd);
+  }
+
+  if((numDrops = rxqOvfl - pDrops->rxqOvfl[idx]) == 0) {
+    return;
+  }
+
+  pDrops->rxqOvfl[idx] = rxqOvfl;
+
+  if(idx < CAPTURE_MAX_FILTERS_PCAP) {
+    pState->numKernelDrops[idx] += numDrops;
+  }
+
+  LOG(X_DEBUG("RTP capture socket port:%d kernel dropped %u packets (total:%u)"),
+      htons(INET_PORT(pCfg->pSockList->salist[idx])), numDrops, rxqOvfl);
+
+  if(pCfg->pcommon->rcvbuf_max > 0) {
+    sockdrops_growrcvbuf(pDrops, pCfg, idx, numDrops);
+  }
+
+}
+
+//
+// Periodically publishes the per socket loss counters to the streamer for /status
+//
+static void sockdrops_publish(CAPTURE_SOCKDROPS_T *pDrops, const CAP_ASYNC_DESCR_T *pCfg, 
+                              const CAPTURE_STATE_T *pState) {
+  TIME_VAL tm;
+  unsigned int idx;
+  SOCKET fd;
+  CAPTURE_DROP_STATS_T stats[2];
+
+  if(!pCfg->pStreamerCfg ||
+     ((tm = timer_GetTime()) - pDrops->tmPublish) / TIME_VAL_MS < CAPTURE_DROPSTATS_INTERVAL_MS) {
+    return;
+  }
+
+  pDrops->tmPublish = tm;
+  memset(stats, 0, sizeof(stats));
+
+  for(idx = 0; idx < 2 && idx < pCfg->pSockList->numSockets; idx++) {
+    rtp_captureGetDropStats(pState, idx, &stats[idx]);
+    if(pDrops->fds[idx] != (fd = NETIOSOCK_FD(pCfg->pSockList->netsockets[idx]))) {
+      sockdrops_reset(pDrops, idx, fd);
+    }
+    stats[idx].rcvBufSz = pDrops->rcvBufSz[idx];
+  }
+
+  pthread_mutex_lock(&pCfg->pStreamerCfg->sharedCtxt.mtxRtcpHdlr);
+  memcpy(pCfg->pStreamerCfg->sharedCtxt.capDrops, stats, sizeof(stats));
+  pthread_mutex_unlock(&pCfg->pStreamerCfg->sharedCtxt.mtxRtcpHdlr);
+
+}
+
+//
+// Readiness multiplexer for the capture RTP / RTCP sockets.  On Linux each socket is registered
+// once with an epoll instance and is only re-registered when its socket list entry changes, so 
+// a wakeup costs nothing for idle sockets and descriptor values are not limited by FD_SETSIZE.
+// Other platforms rebuild an fd_set for select on every wait.
+//
+#define CAPTURE_SOCKMUX_RTP          0
+#define CAPTURE_SOCKMUX_RTCP         1
+#define CAPTURE_SOCKMUX_WAIT_MS      300
+#define CAPTURE_SOCKMUX_RESYNC_MS    2000
+
+#define CAPTURE_SOCKMUX_ISREADY(pMux, kind, idx) ((pMux)->ready[kind][idx])
+
+typedef struct CAPTURE_SOCKMUX {
+  SOCKET                    fds[2][SOCKET_LIST_MAX];    // registered descriptors for RTP, RTCP
+  unsigned char             ready[2][SOCKET_LIST_MAX];
+#if defined(CAPTURE_SOCKET_EPOLL)
+  int                       epollfd;
+  TIME_VAL                  tmResync;
+  struct epoll_event        events[2 * SOCKET_LIST_MAX];
+#else // CAPTURE_SOCKET_EPOLL
+  fd_set                    fdsetRd;
+  SOCKET                    fdHighest;
+#endif // CAPTURE_SOCKET_EPOLL
+} CAPTURE_SOCKMUX_T;
+
+static int sockmux_init(CAPTURE_SOCKMUX_T *pMux) {
+  unsigned int idx;
+
+  memset(pMux, 0, sizeof(CAPTURE_SOCKMUX_T));
+  for(idx = 0; idx < SOCKET_LIST_MAX; idx++) {
+    pMux->fds[CAPTURE_SOCKMUX_RTP][idx] = pMux->fds[CAPTURE_SOCKMUX_RTCP][idx] = INVALID_SOCKET;
+  }
+
+#if defined(CAPTURE_SOCKET_EPOLL)
+  if((pMux->epollfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+    LOG(X_ERROR("Capture socket epoll_create failed "ERRNO_FMT_STR), ERRNO_FMT_ARGS);
+    return -1;
+  }
+  pMux->tmResync = timer_GetTime();
+#endif // CAPTURE_SOCKET_EPOLL
+
+  return 0;
+}
+
+static void sockmux_close(CAPTURE_SOCKMUX_T *pMux) {
+#if defined(CAPTURE_SOCKET_EPOLL)
+  if(pMux->epollfd >= 0) {
+    close(pMux->epollfd);
+    pMux->epollfd = -1;
+  }
+#endif // CAPTURE_SOCKET_EPOLL
+}
+
+static SOCKET sockmux_getfd(const SOCKET_LIST_T *pSockList, int rtcp, int kind, unsigned int idx) {
+
+  if(idx >= pSockList->numSockets) {
+    return INVALID_SOCKET;
+  } else if(kind == CAPTURE_SOCKMUX_RTP) {
+    return NETIOSOCK_FD(pSockList->netsockets[idx]);
+  } else if(rtcp && INET_PORT(pSockList->salistRtcp[idx]) != INET_PORT(pSockList->salist[idx])) {
+    return NETIOSOCK_FD(pSockList->netsocketsRtcp[idx]);
+  }
+
+  return INVALID_SOCKET;
+}
+
+#if defined(CAPTURE_SOCKET_EPOLL)
+
+static void sockmux_register(CAPTURE_SOCKMUX_T *pMux, int kind, unsigned int idx, SOCKET fd) {
+  struct epoll_event ev;
+  SOCKET fdPrev = pMux->fds[kind][idx];
+  int op;
+  int rc;
+
+  //
+  // A closed socket has already been implicitly removed from the epoll set
+  //
+  if(fdPrev != INVALID_SOCKET && fdPrev != fd) {
+    epoll_ctl(pMux->epollfd, EPOLL_CTL_DEL, fdPrev, NULL);
+  }
+
+  pMux->fds[kind][idx] = fd;
+
+  if(fd == INVALID_SOCKET) {
+    return;
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.u32 = (kind << 16) | idx;
+  op = (fdPrev == fd ? EPOLL_CTL_MOD : EPOLL_CTL_ADD);
+
+  //
+  // Re-registering an unchanged descriptor handles the case where the socket was closed and the same
+  // descriptor value reused by a newly opened socket.
+  //
+  if((rc = epoll_ctl(pMux->epollfd, op, fd, &ev)) != 0 && op == EPOLL_CTL_MOD && errno == ENOENT) {
+    rc = epoll_ctl(pMux->epollfd, EPOLL_CTL_ADD, fd, &ev);
+  } else if(rc != 0 && op == EPOLL_CTL_ADD && errno == EEXIST) {
+    rc = epoll_ctl(pMux->epollfd, EPOLL_CTL_MOD, fd, &ev);
+  }
+
+  if(rc != 0) {
+    LOG(X_ERROR("Capture socket epoll registration failed for %s[%d] fd:%d "ERRNO_FMT_STR), 
+        kind == CAPTURE_SOCKMUX_RTP ? "rtp" : "rtcp", idx, fd, ERRNO_FMT_ARGS);
+  }
+}
+
+#endif // CAPTURE_SOCKET_EPOLL
+
+//
+// Synchronizes the multiplexer with the current contents of the socket list.  This is called before
+// each wait so that sockets added or removed at runtime are picked up.
+//
+static void sockmux_update(CAPTURE_SOCKMUX_T *pMux, const SOCKET_LIST_T *pSockList, int rtcp) {
+  unsigned int idx;
+  int kind;
+  SOCKET fd;
+#if defined(CAPTURE_SOCKET_EPOLL)
+  TIME_VAL tm = timer_GetTime();
+  int resync = 0;
+
+  if((tm - pMux->tmResync) / TIME_VAL_MS > CAPTURE_SOCKMUX_RESYNC_MS) {
+    pMux->tmResync = tm;
+    resync = 1;
+  }
+
+  for(kind = CAPTURE_SOCKMUX_RTP; kind <= CAPTURE_SOCKMUX_RTCP; kind++) {
+    for(idx = 0; idx < SOCKET_LIST_MAX; idx++) {
+      fd = sockmux_getfd(pSockList, rtcp, kind, idx);
+      if(fd != pMux->fds[kind][idx] || (resync && fd != INVALID_SOCKET)) {
+        sockmux_register(pMux, kind, idx, fd);
+      }
+    }
+  }
+
+#else // CAPTURE_SOCKET_EPOLL
+
+  pMux->fdHighest = 0;
+  FD_ZERO(&pMux->fdsetRd);
+
+  for(kind = CAPTURE_SOCKMUX_RTP; kind <= CAPTURE_SOCKMUX_RTCP; kind++) {
+    for(idx = 0; idx < SOCKET_LIST_MAX; idx++) {
+      if((fd = pMux->fds[kind][idx] = sockmux_getfd(pSockList, rtcp, kind, idx)) != INVALID_SOCKET) {
+        FD_SET(fd, &pMux->fdsetRd);
+        if(fd > pMux->fdHighest) {
+          pMux->fdHighest = fd;
+        }
+      }
+    }
+  }
+
+#endif // CAPTURE_SOCKET_EPOLL
+}
+
+//
+// Waits for any registered socket to become readable.  Returns the number of ready sockets, 
+// 0 on timeout, or < 0 on error.
+//
+static int sockmux_wait(CAPTURE_SOCKMUX_T *pMux) {
+  int rc;
+  unsigned int idx;
+  int kind;
+#if defined(CAPTURE_SOCKET_EPOLL)
+  int idxEv;
+#else // CAPTURE_SOCKET_EPOLL
+  struct timeval tv;
+#endif // CAPTURE_SOCKET_EPOLL
+
+  memset(pMux->ready, 0, sizeof(pMux->ready));
+
+#if defined(CAPTURE_SOCKET_EPOLL)
+
+  if((rc = epoll_wait(pMux->epollfd, pMux->events, sizeof(pMux->events) / sizeof(pMux->events[0]),
+                      CAPTURE_SOCKMUX_WAIT_MS)) < 0 && errno == EINTR) {
+    rc = 0;
+  }
+
+  for(idxEv = 0; idxEv < rc; idxEv++) {
+    kind = pMux->events[idxEv].data.u32 >> 16;
+    idx = pMux->events[idxEv].data.u32 & 0xffff;
+    if(kind <= CAPTURE_SOCKMUX_RTCP && idx < SOCKET_LIST_MAX) {
+      pMux->ready[kind][idx] = 1;
+    }
+  }
+
+#else // CAPTURE_SOCKET_EPOLL
+
+  tv.tv_sec = 0;
+  tv.tv_usec = CAPTURE_SOCKMUX_WAIT_MS * 1000;
+
+  if((rc = select(pMux->fdHighest + 1, &pMux->fdsetRd, NULL, NULL, &tv)) > 0) {
+    for(kind = CAPTURE_SOCKMUX_RTP; kind <= CAPTURE_SOCKMUX_RTCP; kind++) {
+      for(idx = 0; idx < SOCKET_LIST_MAX; idx++) {
+        if(pMux->fds[kind][idx] != INVALID_SOCKET && FD_ISSET(pMux->fds[kind][idx], &pMux->fdsetRd)) {
+          pMux->ready[kind][idx] = 1;
+        }
+      }
+    }
+  }
+
+#endif // CAPTURE_SOCKET_EPOLL
+
+  return rc;
+}
+
+//
+// Processes an RTP packet queued by the socket reader on a capture receive worker thread
+//
+static void capture_rcvworker_onpkt(void *pArg, CAPTURE_RCVWORKER_PKT_T *pPkt) {
+  CAPTURE_SOCKET_RCVCTXT_T *pRcvCtxt = (CAPTURE_SOCKET_RCVCTXT_T *) pArg;
+  SOCKET_LIST_T *pSockList = pRcvCtxt->pCfg->pSockList;
+  const CAPTURE_STREAM_T *pStream;
+  int have_sendonly_generator = *pRcvCtxt->phave_sendonly_generator;
+
+  if(have_sendonly_generator) {
+    pthread_mutex_lock(pRcvCtxt->pmtx_sendonly);
+  }
+
+  pStream = capture_onUdpSockPkt(pRcvCtxt->pState, CAPTURE_RCVWORKER_PKT_DATA(pPkt), pPkt->len, 
+                                 SOCKET_LIST_PREBUF_SZ, (const struct sockaddr *) &pPkt->saSrc,
+                                 (const struct sockaddr *) &pSockList->salist[pPkt->idxSock], &pPkt->tv, 
+                                 pPkt->rcvDelayUs, &pSockList->netsockets[pPkt->idxSock]);
+
+  if(have_sendonly_generator) {
+    pthread_mutex_unlock(pRcvCtxt->pmtx_sendonly);
+  }
+
+  if(pStream && !*pRcvCtxt->psendonly && !*pRcvCtxt->pno_output) {
+    pthread_mutex_lock(&pRcvCtxt->pCtxt->mtx);
+    send_rtcp_toxmitter(pRcvCtxt->pCtxt, pStream, pSockList, pPkt->idxSock, 
+                        (const struct sockaddr *) &pPkt->saSrc);
+    pthread_mutex_unlock(&pRcvCtxt->pCtxt->mtx);
+  }
+
+}
+
 static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, int rtcp, 
                             int update_delayed_output) {
   unsigned int idx = 0;
@@ -1360,9 +1890,15 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
   int rc;
   int pktlen;
   struct timeval tv;
+  struct timeval tvRcv;
+  struct timeval *ptvRcv;
+  int rcvDelayUs;
+  uint32_t rxqOvfl;
   struct sockaddr_storage saSrc;
-  SOCKET fdHighest;
-  fd_set fdsetRd;
+  CAPTURE_SOCKMUX_T mux;
+  CAPTURE_SOCKDROPS_T sockDrops;
+  CAPTURE_RCVWORKERS_T rcvWorkers;
+  CAPTURE_SOCKET_RCVCTXT_T rcvCtxt;
   int len;
   TIME_VAL tmprev, tm;
   int moreData;
@@ -1391,19 +1927,36 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
   memset(&saSrc, 0, sizeof(saSrc));
   ctxt.pCfg = pCfg;
   ctxt.tmlastpkt = tmprev = timer_GetTime();
+
+  if(sockmux_init(&mux) < 0) {
+    sockmux_close(&mux);
+    return -1;
+  }
+
+  sockdrops_init(&sockDrops, pCfg);
+
+  memset(&rcvWorkers, 0, sizeof(rcvWorkers));
+  rcvCtxt.pCfg = pCfg;
+  rcvCtxt.pState = pState;
+  rcvCtxt.pCtxt = &ctxt;
+  rcvCtxt.pmtx_sendonly = &mtx_sendonly;
+  rcvCtxt.phave_sendonly_generator = &have_sendonly_generator;
+  rcvCtxt.psendonly = &sendonly;
+  rcvCtxt.pno_output = &no_output;
+
   pthread_mutex_init(&mtx_sendonly, NULL);
+  pthread_mutex_init(&ctxt.mtx, NULL);
+
+  if(pCfg->pcommon->rcvthreads > 0 &&
+     capture_rcvworkers_start(&rcvWorkers, pCfg->pcommon->rcvthreads, capture_rcvworker_onpkt, &rcvCtxt) < 0) {
+    LOG(X_WARNING("Processing received packets on the capture socket thread"));
+  }
 
 //TIME_VAL tmdelme0 = timer_GetTime();;
   while(pCfg->running == STREAMER_STATE_RUNNING && g_proc_exit == 0) {
 
 //if(((timer_GetTime() - tmdelme0)/TIME_VAL_MS) > 2000 && pCfg->pStreamerCfg->xcode.vid.pip.active) { g_proc_exit=1; }
 
-    tv.tv_sec = 0;
-    tv.tv_usec = 300000;
-
-    fdHighest = 0;
-    FD_ZERO(&fdsetRd);
-
     //
     // If the input is sendonly then start the dummy input frame generator
     //
@@ -1474,34 +2027,12 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
       no_output = 0;
     }
 
-    for(idx = 0; idx < pSockList->numSockets; idx++) {
-
-      //
-      // Set any RTP / UDP sockets to listen
-      //
-      if(NETIOSOCK_FD(pSockList->netsockets[idx]) != INVALID_SOCKET) {
-        FD_SET(NETIOSOCK_FD(pSockList->netsockets[idx]), &fdsetRd);
-        if(NETIOSOCK_FD(pSockList->netsockets[idx]) > fdHighest) {
-          fdHighest = NETIOSOCK_FD(pSockList->netsockets[idx]);
-        }
-        //fprintf(stderr, "SET SOCKET RTP port:%d, fd:%d\n", ntohs(pSockList->salist[idx].sin_port), pSockList->netsockets[idx].sock);
-      }
-
-      //
-      // Set any RTCP sockets to listen
-      //
-      if(rtcp && INET_PORT(pSockList->salistRtcp[idx]) != INET_PORT(pSockList->salist[idx]) &&
-         NETIOSOCK_FD(pSockList->netsocketsRtcp[idx]) != INVALID_SOCKET) {
-        FD_SET(NETIOSOCK_FD(pSockList->netsocketsRtcp[idx]), &fdsetRd);
-        if(NETIOSOCK_FD(pSockList->netsocketsRtcp[idx]) > fdHighest) {
-          fdHighest = NETIOSOCK_FD(pSockList->netsocketsRtcp[idx]);
-        }
-        //fprintf(stderr, "SET SOCKET RTCP port:%d fd:%d\n", ntohs(pSockList->salistRtcp[idx].sin_port), pSockList->sockRtcp[idx]);
-      }
-
-    }
+    //
+    // Pick up any RTP / UDP and RTCP listener sockets which have been added or removed
+    //
+    sockmux_update(&mux, pSockList, rtcp);
 
-    if((pktlen = select(fdHighest + 1, &fdsetRd, NULL, NULL, &tv)) > 0) {
+    if((pktlen = sockmux_wait(&mux)) > 0) {
 
       moreData = 0;
 
@@ -1518,7 +2049,7 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
         //TODO: not sure - but FD_ISSET may have been always false on win xp
 #if !defined(WIN32)
           if(NETIOSOCK_FD(pSockList->netsockets[idx]) == INVALID_SOCKET || 
-             !FD_ISSET(NETIOSOCK_FD(pSockList->netsockets[idx]), &fdsetRd)) {
+             !CAPTURE_SOCKMUX_ISREADY(&mux, CAPTURE_SOCKMUX_RTP, idx)) {
             continue;
           }
 #endif // WIN32
@@ -1531,11 +2062,14 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
           is_dtls = 0;
           len = sizeof(struct sockaddr_storage);
           pStream = NULL;
-          if((pktlen = recvfrom(NETIOSOCK_FD(pSockList->netsockets[idx]), 
-                            (void *) pData, 
-                            szDataMax, 0,
-                            (struct sockaddr *) &saSrc, 
-                            (socklen_t *) &len)) > 0) {
+          tvRcv.tv_sec = 0;
+          rxqOvfl = 0;
+          if((pktlen = capture_recvfrom(NETIOSOCK_FD(pSockList->netsockets[idx]), pData, szDataMax,
+                                        &saSrc, &len, &tvRcv, &rxqOvfl)) > 0) {
+
+            if(rxqOvfl > 0) {
+              sockdrops_update(&sockDrops, pCfg, pState, idx, rxqOvfl);
+            }
 
             //LOG(X_DEBUG("local socket read[sock:%lu/%d]: %d time:%llu 0x%x pt:0x%x, ssrc:0x%x, sendonly:%d, rtcp:%d %s:%d->:%d"), idx,pSockList->numSockets, pktlen, timer_GetTime(), pData[0], pData[1]&0x7f, htonl(*((uint32_t *) (&pData[8]))), sendonly, rtcp, inet_ntoa(saSrc.sin_addr), htons(saSrc.sin_port), htons(pSockList->salist[idx].sin_port)); //logger_LogHex(S_DEBUG, pData, MIN(pktlen, 16), 1); 
 
@@ -1625,15 +2159,43 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
 
             } else if(!no_output && !sendonly && !is_stun && (!is_turn || is_turn_indication || is_turn_channeldata) && !is_dtls) {
 
-              if(have_sendonly_generator) {
-                pthread_mutex_lock(&mtx_sendonly);
+              //
+              // Prefer the kernel receive timestamp as the packet arrival time and keep track of how long
+              // the packet was queued before being read
+              //
+              if(tvRcv.tv_sec > 0) {
+                tm = timer_GetTime();
+                rcvDelayUs = (int) MIN(MAX(0, (int64_t) (tm - TIME_FROM_TIMEVAL(tvRcv))), 0x7fffffff);
+                ptvRcv = &tvRcv;
+              } else {
+                rcvDelayUs = -1;
+                ptvRcv = &tv;
               }
 
-              pStream = capture_onUdpSockPkt(pState, pData, pktlen, (pData - buf), (const struct sockaddr *) &saSrc, 
-                                   (const struct sockaddr *) &pSockList->salist[idx], &tv, &pSockList->netsockets[idx]);
+              if(rcvWorkers.numWorkers > 0) {
 
-              if(have_sendonly_generator) {
-                pthread_mutex_unlock(&mtx_sendonly);
+                //
+                // The worker owning this stream processes the packet and sends any RTCP feedback.
+                // Streams are steered by the capture filter they match since the filter state is 
+                // not shared across workers.
+                //
+                capture_rcvworkers_enqueue(&rcvWorkers, idx, pData, pktlen, &saSrc, ptvRcv, rcvDelayUs,
+                              capture_getUdpSockFilterIdx(pState, pData, pktlen, (const struct sockaddr *) &saSrc,
+                                                          (const struct sockaddr *) &pSockList->salist[idx]));
+
+              } else {
+
+                if(have_sendonly_generator) {
+                  pthread_mutex_lock(&mtx_sendonly);
+                }
+
+                pStream = capture_onUdpSockPkt(pState, pData, pktlen, (pData - buf), (const struct sockaddr *) &saSrc, 
+                                     (const struct sockaddr *) &pSockList->salist[idx], ptvRcv, rcvDelayUs,
+                                     &pSockList->netsockets[idx]);
+
+                if(have_sendonly_generator) {
+                  pthread_mutex_unlock(&mtx_sendonly);
+                }
               }
             }
             }
@@ -1646,8 +2208,10 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
             //
             // Send any RTCP packet(s) back to the RTP sender 
             //
-            if(!sendonly && !no_output) {
+            if(!sendonly && !no_output && pStream) {
+              pthread_mutex_lock(&ctxt.mtx);
               rc = send_rtcp_toxmitter(&ctxt, pStream, pSockList, idx, (const struct sockaddr *) &saSrc);
+              pthread_mutex_unlock(&ctxt.mtx);
             }
 
 #if defined(WIN32) && !defined(__MINGW32__)
@@ -1709,7 +2273,7 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
             //TODO: not sure - but FD_ISSET may have been always false on win xp
 #if !defined(WIN32)
             if(CAPTURE_RTCP_FD(pSockList, idx) == INVALID_SOCKET || 
-               !FD_ISSET(CAPTURE_RTCP_FD(pSockList, idx), &fdsetRd)) {
+               !CAPTURE_SOCKMUX_ISREADY(&mux, CAPTURE_SOCKMUX_RTCP, idx)) {
               continue;
             }
 #endif // WIN32
@@ -1810,6 +2374,7 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
       // Print any capture statistics
       //
       printCaptureStats(pCfg, pState, &tmprev);
+      sockdrops_publish(&sockDrops, pCfg, pState);
 
     } else if(pktlen == 0) {
 
@@ -1824,6 +2389,7 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
       // Print any capture statistics
       //
       printCaptureStats(pCfg, pState, &tmprev);
+      sockdrops_publish(&sockDrops, pCfg, pState);
 
       //
       // Check capture idle timeouts
@@ -1854,18 +2420,22 @@ static int readLocalSockets(CAP_ASYNC_DESCR_T *pCfg, CAPTURE_STATE_T *pState, in
       }
 
     } else {
-      LOG(X_ERROR("capture socket select returned: %d"), pktlen);
+      LOG(X_ERROR("capture socket wait returned: %d "ERRNO_FMT_STR), pktlen, ERRNO_FMT_ARGS);
       pktlen = -1;
       break;
     } 
 
   }
 
+  capture_rcvworkers_stop(&rcvWorkers);
+
   while(state_sendonly >= STREAMER_STATE_RUNNING) {
     state_sendonly = STREAMER_STATE_INTERRUPT;
     usleep(5000);
   }
+  pthread_mutex_destroy(&ctxt.mtx);
   pthread_mutex_destroy(&mtx_sendonly);
+  sockmux_close(&mux);
 
   return 0;
 }
@@ -2000,6 +2570,7 @@ fprintf(stderr, " telephone-evt.codec:%d, avail:%d\n", pState->filters[idx].tele
       capture_deleteCbData(&streamCbData);
       return -1;
     }
+    sockdrops_mapfilters(pState, pCfg->pSockList);
   }
 
   //
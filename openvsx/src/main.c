@@ -264,6 +264,10 @@ static void usage_capture(int argc, const const char *argv[]) {
       "   --auth-basic  Allow HTTP/RTSP Basic authentication (disabled by default)\n"
       "                 If not enabled, HTTP/RTSP Digest authentication is preferred\n"
       "   --auth-basic-force  Force HTTP/RTSP Basic authentication instead of Digest\n"
+      "   --capbench=[ number of passes ] Replay a pcap capture file through the capture,\n"
+      "                 depacketization and frame queue pipeline as fast as possible\n"
+      "                 and report throughput, per-stage timing and allocation counts\n"
+      "          eg. --capture=input.pcap --filter=\"pt=96, type=h264\" --capbench=10\n"
       "   --dir=[ output directory ]\n"
       "   --filter=[ packet filter string ] contains one or more of the following:\n"
       "          dst=[dest ip], src=[src ip], ip=[ip],\n"
@@ -301,6 +305,12 @@ static void usage_capture(int argc, const const char *argv[]) {
       "          0 - Do not drop frames with corruption from lost packets\n" 
       "          1 - (default) Drop frames with corruption at beginning\n" 
       "          2 - Drop frames with any corruption\n" 
+      "   --rtprcvbufmax=[ bytes ] Grow RTP capture socket receive buffer up to this size\n"
+      "                 when the kernel drops packets (default=0, disabled)\n"
+      "   --rtprcvthreads=[ number of threads ] Process received RTP streams on worker\n"
+      "                 threads, one thread per stream (default=0, disabled)\n"
+      "                 Also sets the number of fanout capture ring threads when\n"
+      "                 capturing from a network interface\n"
       "   --rtsp-interleaved  Use RTSP TCP interleaved mode\n"
       "                 This becomes the default setting when connecting to RTSP-SSL listener [rtsps://]\n"
       "                 Use --rtsp-interleaved=0 to force RTSP UDP/RTP with RTSP-SSL\n"
@@ -441,6 +451,11 @@ static void usage_stream(int argc, const const char *argv[]) {
       "   --streamstats=[ File path to dump output statistics (or stdout if omitted) ]\n"
       "   --token=[ Server Request Authorization Token Id ]\n"
       //"   --httpmax=[ max ] Max HTTP sessions (default=%d)\n"
+      "   --listenshards=[ count ] Number of SO_REUSEPORT accept sockets per server listener\n"
+      "   --listenaffinity Pin each server listener accept thread to a CPU core\n"
+      "   --ratelimitip=[ conn=<per sec>,concurrent=<max>,req=<per sec> ] Per client IP admission limits\n"
+      "   --ratelimitsubnet=[ conn=<per sec>,concurrent=<max>,req=<per sec>,prefix=<bits> ]\n"
+      "                 Per client subnet admission limits\n"
 
       "   --xcode=[ transcode configuration options or transcoder config file path ]\n"
       "                 A detailed parameter list can be found in 'etc"DIR_DELIMETER_STR"xcode.conf'\n"
@@ -562,6 +577,9 @@ static void usage_stream(int argc, const const char *argv[]) {
       "   --srtp        Use SRTP output\n"
       "   --srtpkey=[ Base64 encoded SRTP SDES key(s).  Unique a/v keys can be delimited by ',' ]\n"
       "                 For multiple output (eg., '--out2') use '--srtpkey2=', --srtpkey3='\n"
+      "   --srtponce=[ 0 | 1 ] SRTP protect once for destinations sharing the same key (default=1)\n"
+      "   --srtpthreads=[ number of threads ] Parallel SRTP protection of uniquely keyed\n"
+      "                 destinations, such as DTLS-SRTP (default=0, disabled)\n"
 
       "\n   Parameters affecting RTMP stream output\n\n"
       "   --rtmp=[ address:port ] RTMP broadcast server listener\n"
@@ -698,7 +716,10 @@ static void usage_conference(int argc, const const char *argv[]) {
       "   --mixer   Enable audio mixer (Enabled by default for conferencing mode)\n"
       "   --mixeragc=[ 1 | 0 ] Enable or disable mixer Acoustic Gain Control (default=1)\n"
       "   --mixerdenoise=[ 1 | 0 ] Enable or disable mixer Denoise filter (default=1)\n"
+      "   --mixerspeakers=[ n ] Only mix the n loudest active speakers (default=0, mix all)\n"
+      "   --mixerspeakerhold=[ ms ] Minimum time an active speaker remains mixed (default=600)\n"
       "   --mixervad=[ 1 | 0 ] Enable or disable mixer Voice Activity Detection (default=1)\n"
+      "   --mixerworkers=[ n ] Run the mixer on a shared pool of n worker threads (default=0, disabled)\n"
       "   --piphttp=[ address:port ] PIP control interface server listener (default=%s)\n"
       "                 Add / remove participants via the URL: http://[address]:[port]/pip\n"
       "   --piphttpmax=[ max ] Max simultaneous HTTP PIP control connections (default=0)\n"
@@ -729,6 +750,9 @@ static void usage_general(int argc, const const char *argv[]) {
       " --logfilemaxsize=[ log file max size in bytes ] (default=%dKB)\n"
       " --pid=[ pid output file path ] Write PID to specified file path\n"
       " --verbose=[ level ],-v,-vvv  Increase log verbosity (default=%d)\n"
+      " --xcodebench=[ benchmark file path ] Run an offline transcode throughput\n"
+      "                 benchmark of the 'xcode=' configurations listed in the file\n"
+      "                 and write per configuration JSON results. (eg. etc/xcodebench.conf)\n"
       "\n"
       //"   Show this help\n"
       //"\n"
@@ -866,6 +890,9 @@ enum CMD_OPT {
   CMD_OPT_MIXERSELF,
   CMD_OPT_MIXERAGC,
   CMD_OPT_MIXERDENOISE,
+  CMD_OPT_MIXERWORKERS,
+  CMD_OPT_MIXERSPEAKERS,
+  CMD_OPT_MIXERSPEAKERHOLD,
   CMD_OPT_PIPLAYOUT,
   CMD_OPT_PIPINPUT,
   CMD_OPT_PIPX,
@@ -937,10 +964,15 @@ enum CMD_OPT {
   CMD_OPT_APPREMB_XMITMINRATE,
   CMD_OPT_APPREMB_XMITFORCE,
   CMD_OPT_XCODE,
+  CMD_OPT_XCODEBENCH,
   CMD_OPT_LIVEPORT,
   CMD_OPT_LIVEMAX,
   CMD_OPT_LIVEPWD,
   CMD_OPT_HTTPMAX,
+  CMD_OPT_LISTENSHARDS,
+  CMD_OPT_LISTENCPUAFFINITY,
+  CMD_OPT_RATELIMITIP,
+  CMD_OPT_RATELIMITSUBNET,
   CMD_OPT_HTTPLIVEMAX,
   CMD_OPT_RTMPLIVEADDRPORT,
   CMD_OPT_RTMPTLIVEADDRPORT,
@@ -992,6 +1024,9 @@ enum CMD_OPT {
   CMD_OPT_RTCPSR,
   CMD_OPT_RTCPRR,
   CMD_OPT_RTPFRAMEDROPPOLICY,
+  CMD_OPT_RTPRCVBUFMAX,
+  CMD_OPT_RTPRCVTHREADS,
+  CMD_OPT_CAPBENCH,
   CMD_OPT_CONNECTRETRY,
   CMD_OPT_AVTYPE,
   CMD_OPT_AVOFFSETRTCP,
@@ -1030,6 +1065,8 @@ enum CMD_OPT {
   CMD_OPT_SRTPKEY2,
   CMD_OPT_SRTPKEY3,
   CMD_OPT_SRTP,
+  CMD_OPT_SRTPONCE,
+  CMD_OPT_SRTPTHREADS,
   CMD_OPT_DTLSSRTP,
   //CMD_OPT_DTLSCLIENT,
   CMD_OPT_DTLSSERVER,
@@ -1104,6 +1141,7 @@ int main(int argc, char *argv[]) {
   const char *arg_objid = NULL;
   const char *arg_stts = NULL;
   const char *arg_pidfile = NULL;
+  const char *arg_xcodebench = NULL;
   int have_arg_stream = 0;
   int have_arg_stts = 0;
   int have_arg_input = 0;
@@ -1203,6 +1241,10 @@ int main(int argc, char *argv[]) {
                  { "livemax",     required_argument,       NULL, CMD_OPT_LIVEMAX },
                  { "livepwd",     required_argument,       NULL, CMD_OPT_LIVEPWD },
                  { "httpmax",     required_argument,       NULL, CMD_OPT_HTTPMAX },
+                 { "listenshards",required_argument,       NULL, CMD_OPT_LISTENSHARDS },
+                 { "listenaffinity",optional_argument,     NULL, CMD_OPT_LISTENCPUAFFINITY },
+                 { "ratelimitip", required_argument,       NULL, CMD_OPT_RATELIMITIP },
+                 { "ratelimitsubnet", required_argument,   NULL, CMD_OPT_RATELIMITSUBNET },
                  //{ "logtime",     no_argument,             NULL, CMD_OPT_LOGTIME },
                  { "logfile",     optional_argument,       NULL, CMD_OPT_LOGPATH },
                  { "log",         optional_argument,       NULL, CMD_OPT_LOGPATH },
@@ -1294,6 +1336,9 @@ int main(int argc, char *argv[]) {
                  { "mixerself",   optional_argument,       NULL, CMD_OPT_MIXERSELF },
                  { "mixeragc",    optional_argument,       NULL, CMD_OPT_MIXERAGC },
                  { "mixerdenoise",optional_argument,       NULL, CMD_OPT_MIXERDENOISE },
+                 { "mixerworkers",required_argument,       NULL, CMD_OPT_MIXERWORKERS },
+                 { "mixerspeakers",required_argument,      NULL, CMD_OPT_MIXERSPEAKERS },
+                 { "mixerspeakerhold",required_argument,   NULL, CMD_OPT_MIXERSPEAKERHOLD },
 #endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
                  { "pip",         required_argument,       NULL, CMD_OPT_PIPINPUT },
                  { "pipx",        required_argument,       NULL, CMD_OPT_PIPX },
@@ -1328,6 +1373,9 @@ int main(int argc, char *argv[]) {
                  { "rtcpsr",      required_argument,       NULL, CMD_OPT_RTCPSR },
                  { "rtcprr",      optional_argument,       NULL, CMD_OPT_RTCPRR },
                  { "rtpframedrop",required_argument,       NULL, CMD_OPT_RTPFRAMEDROPPOLICY },
+                 { "rtprcvbufmax",required_argument,       NULL, CMD_OPT_RTPRCVBUFMAX },
+                 { "rtprcvthreads",required_argument,      NULL, CMD_OPT_RTPRCVTHREADS },
+                 { "capbench",    optional_argument,       NULL, CMD_OPT_CAPBENCH },
 
                  { "nackxmit",    optional_argument,       NULL, CMD_OPT_NACK_XMIT },
                  { "rembxmit",    optional_argument,       NULL, CMD_OPT_APPREMB_XMIT },
@@ -1366,6 +1414,8 @@ int main(int argc, char *argv[]) {
                  { "srtpkey2",    required_argument,       NULL, CMD_OPT_SRTPKEY1 },
                  { "srtpkey3",    required_argument,       NULL, CMD_OPT_SRTPKEY2 },
                  { "srtpkey4",    required_argument,       NULL, CMD_OPT_SRTPKEY3 },
+                 { "srtponce",    optional_argument,       NULL, CMD_OPT_SRTPONCE },
+                 { "srtpthreads", required_argument,       NULL, CMD_OPT_SRTPTHREADS },
                  //{ "stream",      optional_argument,       NULL, 's' },
                  { "stream",      optional_argument,       NULL, CMD_OPT_OUTPUT },
                  { "stream1",     required_argument,       NULL, CMD_OPT_OUTPUT0 },
@@ -1418,6 +1468,7 @@ int main(int argc, char *argv[]) {
                  { "vidq",        required_argument,       NULL, CMD_OPT_QUEUEVID },
                  { "extract",     optional_argument,       NULL, 'x' },
                  { "xcode",       required_argument,       NULL, CMD_OPT_XCODE },
+                 { "xcodebench",  required_argument,       NULL, CMD_OPT_XCODEBENCH },
 #if defined(CFG_HAVE_WIN32_SERVICE) && defined(WIN32) && !defined(__MINGW32__)
                  { "install",     no_argument,             NULL, CMD_OPT_INSTALL },
                  { "uninstall",   no_argument,             NULL, CMD_OPT_UNINSTALL },
@@ -1776,6 +1827,18 @@ int main(int argc, char *argv[]) {
       case CMD_OPT_HTTPMAX:
         streamParams.httpmax = atoi(optarg);
         break;
+      case CMD_OPT_LISTENSHARDS:
+        streamParams.listenershards = atoi(optarg);
+        break;
+      case CMD_OPT_LISTENCPUAFFINITY:
+        streamParams.listenercpuaffinity = (optarg && atoi(optarg) <= 0) ? BOOL_DISABLED_OVERRIDE : BOOL_ENABLED_OVERRIDE;
+        break;
+      case CMD_OPT_RATELIMITIP:
+        streamParams.ratelimitip = optarg;
+        break;
+      case CMD_OPT_RATELIMITSUBNET:
+        streamParams.ratelimitsubnet = optarg;
+        break;
       case CMD_OPT_RTPMAX:
         streamParams.rtplivemax = atoi(optarg);
         break;
@@ -2090,6 +2153,16 @@ int main(int argc, char *argv[]) {
         } else {
           streamParams.mixerCfg.denoise = 1;
         }
+        break;
+      case CMD_OPT_MIXERWORKERS:
+        streamParams.mixerCfg.schedulerWorkers = atoi(optarg);
+        break;
+      case CMD_OPT_MIXERSPEAKERS:
+        streamParams.mixerCfg.maxSpeakers = atoi(optarg);
+        break;
+      case CMD_OPT_MIXERSPEAKERHOLD:
+        streamParams.mixerCfg.speakerHoldMs = atoi(optarg);
+        break;
       case CMD_OPT_PIPINPUT:
         if(idxPipInputs < 1) {
           streamParams.pipCfg[idxPipInputs].input = optarg;
@@ -2222,6 +2295,15 @@ int main(int argc, char *argv[]) {
           streamParams.capture_rtp_frame_drop_policy = atoi(optarg);
         }
         break;
+      case CMD_OPT_RTPRCVBUFMAX:
+        streamParams.capture_rcvbuf_max = atoi(optarg);
+        break;
+      case CMD_OPT_RTPRCVTHREADS:
+        streamParams.capture_rcvthreads = atoi(optarg);
+        break;
+      case CMD_OPT_CAPBENCH:
+        streamParams.capture_bench = optarg ? atoi(optarg) : 1;
+        break;
       case CMD_OPT_NACK_RTPRETRANSMIT:
         streamParams.nackRtpRetransmitVideo = optarg ? atoi(optarg) : 1;
         break;
@@ -2388,6 +2470,12 @@ int main(int argc, char *argv[]) {
       case CMD_OPT_SRTP:
         streamParams.srtpCfgs[0].srtp = optarg ? atoi(optarg) : 1;
         break;
+      case CMD_OPT_SRTPONCE:
+        streamParams.srtpEncryptOnce = (optarg && atoi(optarg) == 0) ? BOOL_DISABLED_OVERRIDE : BOOL_ENABLED_OVERRIDE;
+        break;
+      case CMD_OPT_SRTPTHREADS:
+        streamParams.srtpXmitThreads = atoi(optarg);
+        break;
       case CMD_OPT_ENABLE_SYMLINK:
         streamParams.enable_symlink = (optarg && atoi(optarg) == 0) ? BOOL_DISABLED_OVERRIDE : BOOL_ENABLED_OVERRIDE;
         break;
@@ -2572,6 +2660,9 @@ int main(int argc, char *argv[]) {
         streamParams.strxcode = optarg;
         have_arg_stream = 1;
         break;
+      case CMD_OPT_XCODEBENCH:
+        arg_xcodebench = optarg;
+        break;
       case CMD_OPT_TEST:
         return runtests(optarg);
         break;
@@ -2731,6 +2822,10 @@ int main(int argc, char *argv[]) {
     return 0;
   }
 
+  if(arg_xcodebench) {
+    return xcode_benchmark(arg_xcodebench);
+  }
+
   if(action != ACTION_TYPE_DUMP_CONTAINER && !have_arg_stts) {
     banner(stdout);
   }
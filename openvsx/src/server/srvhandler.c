@@ -127,6 +127,17 @@ void srv_cmd_proc(void *pfuncarg) {
       break;
     }
 
+    //
+    // Per client address request rate admission control
+    //
+    if(srv_ratelimit_onrequest(pConn->pListenCfg->pRateLimit, (const struct sockaddr *) &pConn->sd.sa) !=
+       SRV_RATELIMIT_RC_OK) {
+      LOG(X_WARNING("HTTP request %s from %s:%d rejected by request rate limit"), pConn->phttpReq->puri,
+          FORMAT_NETADDR(pConn->sd.sa, tmps[0], sizeof(tmps[0])), ntohs(INET_PORT(pConn->sd.sa)));
+      rc = http_resp_error(&pConn->sd, pConn->phttpReq, HTTP_STATUS_SERVICEUNAVAIL, 1, NULL, NULL);
+      break;
+    }
+
      LOG(X_DEBUG("HTTP - request method: '%s', rc:%d, URI: %s%s"),
        pConn->phttpReq->method, rc, pConn->phttpReq->puri, http_req_dump_uri(pConn->phttpReq, buftmp, sizeof(buftmp)));
 
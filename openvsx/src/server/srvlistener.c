@@ -22,6 +22,10 @@
  */
 
 
+#if defined(__linux__)
+#define _GNU_SOURCE 1
+#endif // __linux__
+
 #include "vsx_common.h"
 
 
@@ -134,6 +138,7 @@ void thread_func_wrapper(void *pArg) {
   //fprintf(stderr, "%d THREAD_FUNC DONE pConn:0x%x inuse:%d\n", pthread_self(), wrap.pConn, wrap.pConn->pool.inuse);
 
   netio_closesocket(&wrap.pConn->sd.netsocket);
+  srv_ratelimit_ondisconnect(wrap.pConn->pListenCfg->pRateLimit, (const struct sockaddr *) &wrap.pConn->sd.sa);
   pool_return(wrap.pConnPool, &wrap.pConn->pool);
 
   logutil_tid_remove(pthread_self());
@@ -142,7 +147,7 @@ void thread_func_wrapper(void *pArg) {
 
 }
 
-int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
+static int srvlisten_acceptloop(SRV_LISTENER_CFG_T *pListenCfg, NETIO_SOCK_T *pnetsockSrv, void *thread_func) {
 
   int salen;
   THREAD_FUNC_WRAPPER_ARG_T wrapArg;
@@ -150,6 +155,7 @@ int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
   SOCKET_DESCR_T sdclient;
   int rc = -1;
   const char *s;
+  SRV_RATELIMIT_RC_T rcLimit;
   //pthread_cond_t cond;
   pthread_mutex_t mtx;
   TIME_VAL tv0, tv1;
@@ -159,7 +165,7 @@ int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
   int sockopt = 0;
 #endif // __APPLE__
 
-  if(!pListenCfg || !pListenCfg->pnetsockSrv || !pListenCfg->pConnPool || !thread_func || 
+  if(!pListenCfg || !pnetsockSrv || !pListenCfg->pConnPool || !thread_func || 
      pListenCfg->pConnPool->numElements <= 0) {
     return -1;
   }
@@ -168,7 +174,7 @@ int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
   memset(&sdclient.netsocket, 0, sizeof(sdclient.netsocket));
   //salen = sizeof(saSrv);
 
-  //if(getsockname(pListenCfg->pnetsockSrv->sock, (struct sockaddr *) &saSrv,  (socklen_t *) &salen) != 0) {
+  //if(getsockname(pnetsockSrv->sock, (struct sockaddr *) &saSrv,  (socklen_t *) &salen) != 0) {
   //  LOG(X_ERROR("getsockopt failed on server socket"));
   //}
 
@@ -179,11 +185,11 @@ int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
 
     salen = sizeof(sdclient.sa);
     if((NETIOSOCK_FD(sdclient.netsocket) = 
-                 accept(PNETIOSOCK_FD(pListenCfg->pnetsockSrv), (struct sockaddr *) &sdclient.sa, 
+                 accept(PNETIOSOCK_FD(pnetsockSrv), (struct sockaddr *) &sdclient.sa, 
                                       (socklen_t *) &salen)) == INVALID_SOCKET) {
       if(!g_proc_exit) {
         LOG(X_ERROR("%saccept failed on %s:%d"), 
-             ((pListenCfg->pnetsockSrv->flags & NETIO_FLAG_SSL_TLS) ? "SSL " : ""),
+             ((pnetsockSrv->flags & NETIO_FLAG_SSL_TLS) ? "SSL " : ""),
                  FORMAT_NETADDR(pListenCfg->sa, tmps[0], sizeof(tmps[0])), ntohs(INET_PORT(pListenCfg->sa)));
       }
       break;
@@ -193,7 +199,7 @@ int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
       break;
     }
 
-    sdclient.netsocket.flags = pListenCfg->pnetsockSrv->flags;
+    sdclient.netsocket.flags = pnetsockSrv->flags;
 
     if(vsxlib_matchaddrfilters(pListenCfg->pfilters, (const struct sockaddr *) &sdclient.sa,
                                SRV_ADDR_FILTER_TYPE_GLOBAL) != 0) {
@@ -206,6 +212,21 @@ int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
       continue;
     }
 
+    //
+    // Per client address admission control, applied before a connection thread is consumed
+    //
+    if((rcLimit = srv_ratelimit_onconnect(pListenCfg->pRateLimit, (const struct sockaddr *) &sdclient.sa)) !=
+       SRV_RATELIMIT_RC_OK) {
+
+      LOG(X_WARNING("Connection from %s:%d on %s:%d rejected by %s limit"), 
+           FORMAT_NETADDR(sdclient.sa, tmps[0], sizeof(tmps[0])), ntohs(INET_PORT(sdclient.sa)), 
+           FORMAT_NETADDR(pListenCfg->sa, tmps[1], sizeof(tmps[1])), ntohs(INET_PORT(pListenCfg->sa)),
+           SRV_RATELIMIT_RC_STR(rcLimit));
+
+      netio_closesocket(&sdclient.netsocket);
+      continue;
+    }
+
     //
     // Find an available client thread to process the client request
     //
@@ -215,6 +236,7 @@ int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
            pListenCfg->pConnPool->numElements, FORMAT_NETADDR(sdclient.sa, tmps[1], sizeof(tmps[1])),
            ntohs(INET_PORT(pListenCfg->sa)));
 
+      srv_ratelimit_ondisconnect(pListenCfg->pRateLimit, (const struct sockaddr *) &sdclient.sa);
       netio_closesocket(&sdclient.netsocket);
       continue;
     }
@@ -259,6 +281,7 @@ int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
           FORMAT_NETADDR(pListenCfg->sa, tmps[0], sizeof(tmps[0])), htons(INET_PORT(pListenCfg->sa)), 
           FORMAT_NETADDR(sdclient.sa, tmps[1], sizeof(tmps[1])), htons(INET_PORT(sdclient.sa)), rc, strerror(rc));
       netio_closesocket(&pConn->sd.netsocket);
+      srv_ratelimit_ondisconnect(pListenCfg->pRateLimit, (const struct sockaddr *) &pConn->sd.sa);
       pool_return(pListenCfg->pConnPool, &pConn->pool);
       wrapArg.flags = 0;
       //pthread_cond_broadcast(&cond);
@@ -310,7 +333,204 @@ int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
   return rc;
 }
 
+int srvlisten_loop(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func) {
+
+  if(!pListenCfg) {
+    return -1;
+  }
+
+  return srvlisten_acceptloop(pListenCfg, pListenCfg->pnetsockSrv, thread_func);
+}
+
+typedef struct SRVLISTEN_SHARD {
+  SRV_LISTENER_CFG_T         *pListenCfg;
+  NETIO_SOCK_T                netsock;
+  void                       *thread_func;
+  unsigned int                idxShard;
+  pthread_t                   ptd;
+  int                         rc;
+  char                        tid_tag[LOGUTIL_TAG_LENGTH];
+} SRVLISTEN_SHARD_T;
+
+static void srvlisten_setaffinity(const SRV_LISTENER_CFG_T *pListenCfg, unsigned int idxShard) {
+
+#if defined(__linux__) && !defined(ANDROID)
+
+  cpu_set_t cpusetAllowed;
+  cpu_set_t cpuset;
+  int numCpus;
+  int idxCpu;
+  int cpu;
+  int rc;
+
+  if(!pListenCfg->cpuAffinity) {
+    return;
+  }
+
+  //
+  // Pick the (idxShard % n)th of the n CPUs this process may run on, since online CPU
+  // ids are not necessarily contiguous and the process may be restricted to a subset
+  //
+  if(sched_getaffinity(0, sizeof(cpusetAllowed), &cpusetAllowed) != 0 ||
+     (numCpus = CPU_COUNT(&cpusetAllowed)) <= 0) {
+    LOG(X_WARNING("Unable to get allowed CPU set for listener shard[%d]"), idxShard);
+    return;
+  }
+
+  idxCpu = idxShard % numCpus;
+  for(cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if(CPU_ISSET(cpu, &cpusetAllowed) && idxCpu-- == 0) {
+      break;
+    }
+  }
+
+  if(cpu >= CPU_SETSIZE) {
+    return;
+  }
+
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+
+  if((rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset)) != 0) {
+    LOG(X_WARNING("Unable to set listener shard[%d] CPU affinity to core %d (%d %s)"), 
+        idxShard, cpu, rc, strerror(rc));
+  } else {
+    LOG(X_DEBUG("Listener shard[%d] pinned to CPU core %d"), idxShard, cpu);
+  }
+
+#endif // __linux__
+
+}
+
+static void srvlisten_shard_proc(void *pArg) {
+  SRVLISTEN_SHARD_T *pShard = (SRVLISTEN_SHARD_T *) pArg;
+
+  logutil_tid_add(pthread_self(), pShard->tid_tag);
 
+  srvlisten_setaffinity(pShard->pListenCfg, pShard->idxShard);
+
+  pShard->rc = srvlisten_acceptloop(pShard->pListenCfg, &pShard->netsock, pShard->thread_func);
+
+  logutil_tid_remove(pthread_self());
+
+}
+
+static void srvlisten_closeshard(SRV_LISTENER_CFG_T *pListenCfg, unsigned int idxShard) {
+
+  pthread_mutex_lock(&pListenCfg->mtx);
+
+  if(pListenCfg->pnetsockShards[idxShard]) {
+    //
+    // shutdown is needed to interrupt an accept blocked on another thread
+    //
+    if(PNETIOSOCK_FD(pListenCfg->pnetsockShards[idxShard]) != INVALID_SOCKET) {
+      shutdown(PNETIOSOCK_FD(pListenCfg->pnetsockShards[idxShard]), SHUT_RDWR);
+    }
+    netio_closesocket(pListenCfg->pnetsockShards[idxShard]);
+    pListenCfg->pnetsockShards[idxShard] = NULL;
+  }
+
+  pthread_mutex_unlock(&pListenCfg->mtx);
+}
+
+int srvlisten_loop_shards(SRV_LISTENER_CFG_T *pListenCfg, void *thread_func, int backlog) {
+
+  SRVLISTEN_SHARD_T *pShards = NULL;
+  SRVLISTEN_SHARD_T *pShard;
+  pthread_attr_t attrShard;
+  unsigned int numShards;
+  unsigned int idxShard;
+  unsigned int numStarted = 1;
+  const char *s;
+  char tmp[128];
+  int rc = 0;
+
+  if(!pListenCfg || !pListenCfg->pnetsockSrv) {
+    return -1;
+  }
+
+  if((numShards = MIN(pListenCfg->numShards, SRV_LISTENER_SHARDS_MAX)) <= 1) {
+    return srvlisten_loop(pListenCfg, thread_func);
+  }
+
+  if(!(pShards = (SRVLISTEN_SHARD_T *) avc_calloc(numShards, sizeof(SRVLISTEN_SHARD_T)))) {
+    return -1;
+  }
+
+  pListenCfg->shardsRunning = 1;
+
+  //
+  // Shard 0 is the already opened pListenCfg->pnetsockSrv, serviced by this thread.
+  // Every other shard gets its own SO_REUSEPORT socket bound to the same address and
+  // its own accept thread.  All shards share the listener connection pool, so the max 
+  // connection accounting and address filters are applied the same way for each shard.
+  //
+  for(idxShard = 1; idxShard < numShards; idxShard++) {
+
+    pShard = &pShards[idxShard];
+    pShard->pListenCfg = pListenCfg;
+    pShard->thread_func = thread_func;
+    pShard->idxShard = idxShard;
+    pShard->netsock.flags = pListenCfg->pnetsockSrv->flags;
+
+    if((PNETIOSOCK_FD(&pShard->netsock) = net_listen_reuseport((const struct sockaddr *) &pListenCfg->sa, 
+                                                                 backlog)) == INVALID_SOCKET) {
+      break;
+    }
+
+    pthread_mutex_lock(&pListenCfg->mtx);
+    pListenCfg->pnetsockShards[idxShard] = &pShard->netsock;
+    pthread_mutex_unlock(&pListenCfg->mtx);
+
+    if((s = logutil_tid_lookup(pthread_self(), 0)) && s[0] != '\0') {
+      snprintf(pShard->tid_tag, sizeof(pShard->tid_tag), "%s-s%u", s, idxShard);
+    }
+
+    //
+    // Shard threads are joinable so that the shard contexts and the listener mutex 
+    // are never released while a shard thread may still reference them
+    //
+    PHTREAD_INIT_ATTR(&attrShard);
+    pthread_attr_setdetachstate(&attrShard, PTHREAD_CREATE_JOINABLE);
+
+    if((rc = pthread_create(&pShard->ptd,
+                    &attrShard,
+                    (void *) srvlisten_shard_proc,
+                    (void *) pShard)) != 0) {
+      LOG(X_ERROR("Unable to create listener shard[%d] thread (%d %s)"), idxShard, rc, strerror(rc));
+      pthread_attr_destroy(&attrShard);
+      srvlisten_closeshard(pListenCfg, idxShard);
+      break;
+    }
+
+    pthread_attr_destroy(&attrShard);
+    numStarted++;
+  }
+
+  LOG(X_DEBUG("Started %d/%d listener accept shards on %s:%d"), numStarted, numShards, 
+      FORMAT_NETADDR(pListenCfg->sa, tmp, sizeof(tmp)), ntohs(INET_PORT(pListenCfg->sa)));
+
+  srvlisten_setaffinity(pListenCfg, 0);
+
+  rc = srvlisten_acceptloop(pListenCfg, pListenCfg->pnetsockSrv, thread_func);
+
+  //
+  // Shard 0 exited, so close all other shard sockets to have their accept threads exit
+  //
+  for(idxShard = 1; idxShard < numShards; idxShard++) {
+    srvlisten_closeshard(pListenCfg, idxShard);
+  }
+
+  for(idxShard = 1; idxShard < numStarted; idxShard++) {
+    pthread_join(pShards[idxShard].ptd, NULL);
+  }
+
+  pListenCfg->shardsRunning = 0;
+
+  avc_free((void **) &pShards);
+
+  return rc;
+}
 
 int srvlisten_matchAddrFilters(const CLIENT_CONN_T *pConn, SRV_ADDR_FILTER_TYPE_T type) {
 
@@ -65,7 +65,13 @@ static void srvlisten_media_proc(void *pArg) {
   memcpy(&sa, &pListenCfg->sa, sizeof(pListenCfg->sa));
   netsocksrv.flags = pListenCfg->netflags;
 
-  if((NETIOSOCK_FD(netsocksrv) = net_listen((const struct sockaddr *) &sa, backlog)) == INVALID_SOCKET) {
+  if(pListenCfg->numShards > 1) {
+    NETIOSOCK_FD(netsocksrv) = net_listen_reuseport((const struct sockaddr *) &sa, backlog);
+  } else {
+    NETIOSOCK_FD(netsocksrv) = net_listen((const struct sockaddr *) &sa, backlog);
+  }
+
+  if(NETIOSOCK_FD(netsocksrv) == INVALID_SOCKET) {
     logutil_tid_remove(pthread_self());
     return;
   }
@@ -209,7 +215,11 @@ static void srvlisten_media_proc(void *pArg) {
   //
   // Service any client connections on the live listening port
   //
-  rc = srvlisten_loop(pListenCfg, srv_cmd_proc);
+  if(pListenCfg->numShards > 1) {
+    rc = srvlisten_loop_shards(pListenCfg, srv_cmd_proc, backlog);
+  } else {
+    rc = srvlisten_loop(pListenCfg, srv_cmd_proc);
+  }
 
   pthread_mutex_lock(&pListenCfg->mtx);
   pListenCfg->pnetsockSrv = NULL; 
@@ -0,0 +1,489 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#include "vsx_common.h"
+
+
+typedef struct RATELIMIT_KEY {
+  int                      isSubnet;
+  sa_family_t              family;
+  unsigned char            addr[16];
+} RATELIMIT_KEY_T;
+
+static int cbparse_ratelimit(void *pArg, const char *p) {
+  SRV_RATELIMIT_LIMITS_T *pLimits = ((void **) pArg)[0];
+  unsigned int *pPrefix = ((void **) pArg)[1];
+  const char *pval;
+
+  if(!(pval = strchr(p, '='))) {
+    LOG(X_ERROR("Invalid rate limit parameter '%s'"), p);
+    return -1;
+  }
+  pval++;
+  MOVE_WHILE_SPACE(pval);
+
+  if(!strncasecmp(p, "conn", 4) && (p[4] == '=' || p[4] == ' ')) {
+    pLimits->connPerSec = atoi(pval);
+  } else if(!strncasecmp(p, "concurrent", 10)) {
+    pLimits->maxConcurrent = atoi(pval);
+  } else if(!strncasecmp(p, "req", 3)) {
+    pLimits->reqPerSec = atoi(pval);
+  } else if(!strncasecmp(p, "prefix", 6) && pPrefix) {
+    *pPrefix = atoi(pval);
+  } else {
+    LOG(X_ERROR("Unknown rate limit parameter '%s'"), p);
+    return -1;
+  }
+
+  return 0;
+}
+
+int srv_ratelimit_parse(const char *str, SRV_RATELIMIT_LIMITS_T *pLimits, unsigned int *pPrefix) {
+  void *arg[2];
+
+  if(!str || !pLimits) {
+    return -1;
+  }
+
+  arg[0] = pLimits;
+  arg[1] = pPrefix;
+
+  return strutil_parse_csv(cbparse_ratelimit, arg, str);
+}
+
+int srv_ratelimit_init(SRV_RATELIMIT_T *pRateLimit, const SRV_RATELIMIT_CFG_T *pCfg) {
+  unsigned int idx;
+
+  if(!pRateLimit || !pCfg) {
+    return -1;
+  }
+
+  memset(pRateLimit, 0, sizeof(SRV_RATELIMIT_T));
+
+  if(!SRV_RATELIMIT_LIMITS_SET(&pCfg->ip) && !SRV_RATELIMIT_LIMITS_SET(&pCfg->subnet)) {
+    return 0;
+  }
+
+  memcpy(&pRateLimit->cfg, pCfg, sizeof(pRateLimit->cfg));
+  if(pRateLimit->cfg.subnetPrefix4 == 0 || pRateLimit->cfg.subnetPrefix4 > ADDR_LEN_IPV4 * 8) {
+    pRateLimit->cfg.subnetPrefix4 = SRV_RATELIMIT_SUBNET_PREFIX4_DEFAULT;
+  }
+  if(pRateLimit->cfg.subnetPrefix6 == 0 || pRateLimit->cfg.subnetPrefix6 > ADDR_LEN_IPV6 * 8) {
+    pRateLimit->cfg.subnetPrefix6 = SRV_RATELIMIT_SUBNET_PREFIX6_DEFAULT;
+  }
+
+  if(!(pRateLimit->ppHashTable = (SRV_RATELIMIT_ENTRY_T **) avc_calloc(SRV_RATELIMIT_HASH_SIZE, 
+                                                                      sizeof(SRV_RATELIMIT_ENTRY_T *)))) {
+    return -1;
+  }
+
+  for(idx = 0; idx < SRV_RATELIMIT_STRIPES; idx++) {
+    pthread_mutex_init(&pRateLimit->stripes[idx].mtx, NULL);
+  }
+  pthread_mutex_init(&pRateLimit->mtxStats, NULL);
+
+  pRateLimit->active = 1;
+
+  LOG(X_DEBUG("Rate limit per IP conn/s:%u, concurrent:%u, req/s:%u, per subnet /%u /%u conn/s:%u, "
+              "concurrent:%u, req/s:%u"), 
+      pRateLimit->cfg.ip.connPerSec, pRateLimit->cfg.ip.maxConcurrent, pRateLimit->cfg.ip.reqPerSec,
+      pRateLimit->cfg.subnetPrefix4, pRateLimit->cfg.subnetPrefix6, pRateLimit->cfg.subnet.connPerSec, 
+      pRateLimit->cfg.subnet.maxConcurrent, pRateLimit->cfg.subnet.reqPerSec);
+
+  return 0;
+}
+
+void srv_ratelimit_close(SRV_RATELIMIT_T *pRateLimit) {
+  unsigned int idx;
+  SRV_RATELIMIT_ENTRY_T *pEntry, *pNext;
+
+  if(!pRateLimit || !pRateLimit->active) {
+    return;
+  }
+
+  pRateLimit->active = 0;
+
+  for(idx = 0; idx < SRV_RATELIMIT_HASH_SIZE; idx++) {
+    pEntry = pRateLimit->ppHashTable[idx];
+    while(pEntry) {
+      pNext = pEntry->pnext;
+      avc_free((void **) &pEntry);
+      pEntry = pNext;
+    }
+  }
+  avc_free((void **) &pRateLimit->ppHashTable);
+
+  for(idx = 0; idx < SRV_RATELIMIT_STRIPES; idx++) {
+    pthread_mutex_destroy(&pRateLimit->stripes[idx].mtx);
+  }
+  pthread_mutex_destroy(&pRateLimit->mtxStats);
+
+}
+
+static int ratelimit_makekey(const SRV_RATELIMIT_T *pRateLimit, const struct sockaddr *psa, 
+                             int isSubnet, RATELIMIT_KEY_T *pKey) {
+  unsigned int idx;
+  unsigned int len;
+  unsigned int prefix;
+
+  memset(pKey, 0, sizeof(RATELIMIT_KEY_T));
+  pKey->isSubnet = isSubnet;
+  pKey->family = psa->sa_family;
+
+  if(psa->sa_family == AF_INET6) {
+    len = ADDR_LEN_IPV6;
+    prefix = pRateLimit->cfg.subnetPrefix6;
+    memcpy(pKey->addr, &((const struct sockaddr_in6 *) psa)->sin6_addr, ADDR_LEN_IPV6);
+  } else if(psa->sa_family == AF_INET) {
+    len = ADDR_LEN_IPV4;
+    prefix = pRateLimit->cfg.subnetPrefix4;
+    memcpy(pKey->addr, &((const struct sockaddr_in *) psa)->sin_addr, ADDR_LEN_IPV4);
+  } else {
+    return -1;
+  }
+
+  if(isSubnet) {
+    for(idx = 0; idx < len; idx++) {
+      if(prefix >= 8) {
+        prefix -= 8;
+      } else {
+        pKey->addr[idx] &= (unsigned char) (0xff << (8 - prefix));
+        prefix = 0;
+      }
+    }
+  }
+
+  return 0;
+}
+
+static unsigned int ratelimit_hash(const RATELIMIT_KEY_T *pKey) {
+  unsigned int idx;
+  uint32_t hash = 2166136261u;
+
+  //
+  // FNV-1a
+  //
+  for(idx = 0; idx < sizeof(pKey->addr); idx++) {
+    hash = (hash ^ pKey->addr[idx]) * 16777619u;
+  }
+  hash = (hash ^ (pKey->isSubnet ? 1 : 0)) * 16777619u;
+
+  return hash & (SRV_RATELIMIT_HASH_SIZE - 1);
+}
+
+#define RATELIMIT_STRIPE(hash) ((hash) & (SRV_RATELIMIT_STRIPES - 1))
+
+//
+// Called with the stripe lock held.  Unused idle entries encountered in the chain are reclaimed, 
+// so the table does not grow without bound.
+//
+static SRV_RATELIMIT_ENTRY_T *ratelimit_lookup(SRV_RATELIMIT_T *pRateLimit, unsigned int hash,
+                                               const RATELIMIT_KEY_T *pKey, TIME_VAL tvNow, int create) {
+  SRV_RATELIMIT_ENTRY_T *pEntry;
+  SRV_RATELIMIT_ENTRY_T *pPrev = NULL;
+  SRV_RATELIMIT_STRIPE_T *pStripe = &pRateLimit->stripes[RATELIMIT_STRIPE(hash)];
+
+  pEntry = pRateLimit->ppHashTable[hash];
+
+  while(pEntry) {
+
+    if(pEntry->isSubnet == pKey->isSubnet && pEntry->family == pKey->family &&
+       !memcmp(pEntry->addr, pKey->addr, sizeof(pEntry->addr))) {
+      pEntry->tvLastSeen = tvNow;
+      return pEntry;
+    }
+
+    if(pEntry->numConcurrent == 0 && (tvNow - pEntry->tvLastSeen) / TIME_VAL_MS > SRV_RATELIMIT_IDLE_MS) {
+      if(pPrev) {
+        pPrev->pnext = pEntry->pnext;
+      } else {
+        pRateLimit->ppHashTable[hash] = pEntry->pnext;
+      }
+      pStripe->numEntries--;
+      avc_free((void **) &pEntry);
+      pEntry = pPrev ? pPrev->pnext : pRateLimit->ppHashTable[hash];
+      continue;
+    }
+
+    pPrev = pEntry;
+    pEntry = pEntry->pnext;
+  }
+
+  if(!create || pStripe->numEntries >= SRV_RATELIMIT_ENTRIES_MAX / SRV_RATELIMIT_STRIPES ||
+     !(pEntry = (SRV_RATELIMIT_ENTRY_T *) avc_calloc(1, sizeof(SRV_RATELIMIT_ENTRY_T)))) {
+    return NULL;
+  }
+
+  pEntry->isSubnet = pKey->isSubnet;
+  pEntry->family = pKey->family;
+  memcpy(pEntry->addr, pKey->addr, sizeof(pEntry->addr));
+  pEntry->tvLastSeen = tvNow;
+  pEntry->pnext = pRateLimit->ppHashTable[hash];
+  pRateLimit->ppHashTable[hash] = pEntry;
+  pStripe->numEntries++;
+
+  return pEntry;
+}
+
+//
+// Token bucket holding up to 1 second worth of tokens at the given rate 
+//
+static int bucket_take(SRV_RATELIMIT_BUCKET_T *pBucket, unsigned int ratePerSec, TIME_VAL tvNow) {
+  int64_t capacity;
+
+  if(ratePerSec == 0) {
+    return 0;
+  }
+
+  capacity = (int64_t) ratePerSec * 1000;
+
+  if(pBucket->tvLast == 0) {
+    pBucket->milliTokens = capacity;
+  } else if(tvNow > pBucket->tvLast) {
+    pBucket->milliTokens += (tvNow - pBucket->tvLast) * ratePerSec / TIME_VAL_MS;
+    if(pBucket->milliTokens > capacity) {
+      pBucket->milliTokens = capacity;
+    }
+  }
+  pBucket->tvLast = tvNow;
+
+  if(pBucket->milliTokens < 1000) {
+    return -1;
+  }
+
+  pBucket->milliTokens -= 1000;
+
+  return 0;
+}
+
+static void bucket_refund(SRV_RATELIMIT_BUCKET_T *pBucket, unsigned int ratePerSec) {
+  if(ratePerSec > 0) {
+    pBucket->milliTokens += 1000;
+  }
+}
+
+static void ratelimit_count(SRV_RATELIMIT_T *pRateLimit, SRV_RATELIMIT_RC_T rc, int isSubnet) {
+
+  pthread_mutex_lock(&pRateLimit->mtxStats);
+
+  switch(rc) {
+    case SRV_RATELIMIT_RC_OK:
+      pRateLimit->stats.admitted++;
+      break;
+    case SRV_RATELIMIT_RC_CONNRATE:
+      pRateLimit->stats.rejectedConnRate++;
+      break;
+    case SRV_RATELIMIT_RC_CONCURRENT:
+      pRateLimit->stats.rejectedConcurrent++;
+      break;
+    case SRV_RATELIMIT_RC_REQRATE:
+      pRateLimit->stats.rejectedReqRate++;
+      break;
+  }
+
+  if(isSubnet && rc != SRV_RATELIMIT_RC_OK) {
+    pRateLimit->stats.rejectedSubnet++;
+  }
+
+  pthread_mutex_unlock(&pRateLimit->mtxStats);
+}
+
+static SRV_RATELIMIT_RC_T ratelimit_connect(SRV_RATELIMIT_T *pRateLimit, const SRV_RATELIMIT_LIMITS_T *pLimits,
+                                            const struct sockaddr *psa, int isSubnet, TIME_VAL tvNow) {
+  RATELIMIT_KEY_T key;
+  unsigned int hash;
+  SRV_RATELIMIT_ENTRY_T *pEntry;
+  SRV_RATELIMIT_RC_T rc = SRV_RATELIMIT_RC_OK;
+
+  if(!SRV_RATELIMIT_LIMITS_SET(pLimits) || ratelimit_makekey(pRateLimit, psa, isSubnet, &key) < 0) {
+    return SRV_RATELIMIT_RC_OK;
+  }
+
+  hash = ratelimit_hash(&key);
+
+  pthread_mutex_lock(&pRateLimit->stripes[RATELIMIT_STRIPE(hash)].mtx);
+
+  if(!(pEntry = ratelimit_lookup(pRateLimit, hash, &key, tvNow, 1))) {
+    //
+    // Fail open if the table is exhausted
+    //
+    pthread_mutex_unlock(&pRateLimit->stripes[RATELIMIT_STRIPE(hash)].mtx);
+    pthread_mutex_lock(&pRateLimit->mtxStats);
+    pRateLimit->stats.tableFull++;
+    pthread_mutex_unlock(&pRateLimit->mtxStats);
+    return SRV_RATELIMIT_RC_OK;
+  }
+
+  if(pLimits->maxConcurrent > 0 && pEntry->numConcurrent >= pLimits->maxConcurrent) {
+    rc = SRV_RATELIMIT_RC_CONCURRENT;
+  } else if(bucket_take(&pEntry->conn, pLimits->connPerSec, tvNow) < 0) {
+    rc = SRV_RATELIMIT_RC_CONNRATE;
+  } else {
+    pEntry->numConcurrent++;
+  }
+
+  pthread_mutex_unlock(&pRateLimit->stripes[RATELIMIT_STRIPE(hash)].mtx);
+
+  return rc;
+}
+
+static void ratelimit_disconnect(SRV_RATELIMIT_T *pRateLimit, const SRV_RATELIMIT_LIMITS_T *pLimits,
+                                 const struct sockaddr *psa, int isSubnet, int refund) {
+  RATELIMIT_KEY_T key;
+  unsigned int hash;
+  SRV_RATELIMIT_ENTRY_T *pEntry;
+
+  if(!SRV_RATELIMIT_LIMITS_SET(pLimits) || ratelimit_makekey(pRateLimit, psa, isSubnet, &key) < 0) {
+    return;
+  }
+
+  hash = ratelimit_hash(&key);
+
+  pthread_mutex_lock(&pRateLimit->stripes[RATELIMIT_STRIPE(hash)].mtx);
+
+  if((pEntry = ratelimit_lookup(pRateLimit, hash, &key, timer_GetTime(), 0))) {
+    if(pEntry->numConcurrent > 0) {
+      pEntry->numConcurrent--;
+    }
+    if(refund) {
+      bucket_refund(&pEntry->conn, pLimits->connPerSec);
+    }
+  }
+
+  pthread_mutex_unlock(&pRateLimit->stripes[RATELIMIT_STRIPE(hash)].mtx);
+}
+
+SRV_RATELIMIT_RC_T srv_ratelimit_onconnect(SRV_RATELIMIT_T *pRateLimit, const struct sockaddr *psa) {
+  SRV_RATELIMIT_RC_T rc;
+  TIME_VAL tvNow;
+
+  if(!pRateLimit || !pRateLimit->active || !psa) {
+    return SRV_RATELIMIT_RC_OK;
+  }
+
+  tvNow = timer_GetTime();
+
+  if((rc = ratelimit_connect(pRateLimit, &pRateLimit->cfg.ip, psa, 0, tvNow)) != SRV_RATELIMIT_RC_OK) {
+    ratelimit_count(pRateLimit, rc, 0);
+    return rc;
+  }
+
+  if((rc = ratelimit_connect(pRateLimit, &pRateLimit->cfg.subnet, psa, 1, tvNow)) != SRV_RATELIMIT_RC_OK) {
+    //
+    // Undo the per IP accounting of the connection being rejected by the subnet limit
+    //
+    ratelimit_disconnect(pRateLimit, &pRateLimit->cfg.ip, psa, 0, 1);
+    ratelimit_count(pRateLimit, rc, 1);
+    return rc;
+  }
+
+  ratelimit_count(pRateLimit, rc, 0);
+
+  return rc;
+}
+
+void srv_ratelimit_ondisconnect(SRV_RATELIMIT_T *pRateLimit, const struct sockaddr *psa) {
+
+  if(!pRateLimit || !pRateLimit->active || !psa) {
+    return;
+  }
+
+  ratelimit_disconnect(pRateLimit, &pRateLimit->cfg.ip, psa, 0, 0);
+  ratelimit_disconnect(pRateLimit, &pRateLimit->cfg.subnet, psa, 1, 0);
+}
+
+static SRV_RATELIMIT_RC_T ratelimit_request(SRV_RATELIMIT_T *pRateLimit, unsigned int reqPerSec,
+                                            const struct sockaddr *psa, int isSubnet, TIME_VAL tvNow) {
+  RATELIMIT_KEY_T key;
+  unsigned int hash;
+  SRV_RATELIMIT_ENTRY_T *pEntry;
+  SRV_RATELIMIT_RC_T rc = SRV_RATELIMIT_RC_OK;
+
+  if(reqPerSec == 0 || ratelimit_makekey(pRateLimit, psa, isSubnet, &key) < 0) {
+    return SRV_RATELIMIT_RC_OK;
+  }
+
+  hash = ratelimit_hash(&key);
+
+  pthread_mutex_lock(&pRateLimit->stripes[RATELIMIT_STRIPE(hash)].mtx);
+
+  if((pEntry = ratelimit_lookup(pRateLimit, hash, &key, tvNow, 1)) &&
+     bucket_take(&pEntry->req, reqPerSec, tvNow) < 0) {
+    rc = SRV_RATELIMIT_RC_REQRATE;
+  }
+
+  pthread_mutex_unlock(&pRateLimit->stripes[RATELIMIT_STRIPE(hash)].mtx);
+
+  return rc;
+}
+
+SRV_RATELIMIT_RC_T srv_ratelimit_onrequest(SRV_RATELIMIT_T *pRateLimit, const struct sockaddr *psa) {
+  SRV_RATELIMIT_RC_T rc;
+  TIME_VAL tvNow;
+
+  if(!pRateLimit || !pRateLimit->active || !psa) {
+    return SRV_RATELIMIT_RC_OK;
+  }
+
+  tvNow = timer_GetTime();
+
+  if((rc = ratelimit_request(pRateLimit, pRateLimit->cfg.ip.reqPerSec, psa, 0, tvNow)) != SRV_RATELIMIT_RC_OK) {
+    ratelimit_count(pRateLimit, rc, 0);
+  } else if((rc = ratelimit_request(pRateLimit, pRateLimit->cfg.subnet.reqPerSec, psa, 1, tvNow)) != 
+            SRV_RATELIMIT_RC_OK) {
+    ratelimit_count(pRateLimit, rc, 1);
+  }
+
+  return rc;
+}
+
+int srv_ratelimit_dump(SRV_RATELIMIT_T *pRateLimit, char *buf, unsigned int szbuf) {
+  int rc = 0;
+  unsigned int idx;
+  unsigned int numEntries = 0;
+  SRV_RATELIMIT_STATS_T stats;
+
+  if(!pRateLimit || !pRateLimit->active || !buf) {
+    return 0;
+  }
+
+  for(idx = 0; idx < SRV_RATELIMIT_STRIPES; idx++) {
+    numEntries += pRateLimit->stripes[idx].numEntries;
+  }
+
+  pthread_mutex_lock(&pRateLimit->mtxStats);
+  memcpy(&stats, &pRateLimit->stats, sizeof(stats));
+  pthread_mutex_unlock(&pRateLimit->mtxStats);
+
+  if((rc = snprintf(buf, szbuf, "&rateLimitAdmitted=%"LL64"u&rateLimitRejectConnRate=%"LL64"u"
+                    "&rateLimitRejectConcurrent=%"LL64"u&rateLimitRejectReqRate=%"LL64"u"
+                    "&rateLimitRejectSubnet=%"LL64"u&rateLimitEntries=%u",
+                    (unsigned long long) stats.admitted, (unsigned long long) stats.rejectedConnRate, 
+                    (unsigned long long) stats.rejectedConcurrent, (unsigned long long) stats.rejectedReqRate,
+                    (unsigned long long) stats.rejectedSubnet, numEntries)) < 0) {
+    rc = 0;
+  }
+
+  return rc;
+}
@@ -37,6 +37,9 @@ static int ctrl_status_show_output(STREAMER_CFG_T *pStreamerCfg, char *buf, unsi
   unsigned int numFlvLive = 0;
   unsigned int numMkvLive = 0;
   unsigned int numActive = 0;
+  unsigned int numLevels = 0;
+  uint64_t kernelDrops = 0;
+  uint64_t netLoss = 0;
   char bpsdescr[256]; 
 
   bpsdescr[0] = '\0';
@@ -62,6 +65,13 @@ static int ctrl_status_show_output(STREAMER_CFG_T *pStreamerCfg, char *buf, unsi
       numActive += (numTsLive += pStreamerCfg->liveQs[outidx].numActive);
       numActive += (numRtspInterleaved += pStreamerCfg->liveQ2s[outidx].numActive);
     }
+
+    pthread_mutex_lock(&pStreamerCfg->sharedCtxt.mtxRtcpHdlr);
+    for(outidx = 0; outidx < 2; outidx++) {
+      kernelDrops += pStreamerCfg->sharedCtxt.capDrops[outidx].kernelDrops;
+      netLoss += pStreamerCfg->sharedCtxt.capDrops[outidx].netLoss;
+    }
+    pthread_mutex_unlock(&pStreamerCfg->sharedCtxt.mtxRtcpHdlr);
   }
 
 
@@ -85,6 +95,30 @@ static int ctrl_status_show_output(STREAMER_CFG_T *pStreamerCfg, char *buf, unsi
     idx += rc;
   }
 
+  //
+  // Input packets dropped by the local capture socket receive queue vs. lost in the network
+  //
+  if(pStreamerCfg && pStreamerCfg->running >= 0 &&
+     (rc = snprintf(&buf[idx], szbuf - idx, "&inputKernelDrops=%llu&inputNetworkLoss=%llu",
+                    (unsigned long long) kernelDrops, (unsigned long long) netLoss)) > 0) {
+    idx += rc;
+  }
+
+  //
+  // Encoder governor speed level of each transcoded video output, 0 being the configured speed
+  //
+  if(pStreamerCfg && pStreamerCfg->running >= 0 && pStreamerCfg->xcode.vid.common.cfgDo_xcode) {
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+      if(!pStreamerCfg->xcode.vid.out[outidx].active || pStreamerCfg->xcode.vid.out[outidx].passthru) {
+        continue;
+      }
+      if((rc = snprintf(&buf[idx], szbuf - idx, "%s%d", numLevels++ > 0 ? "," : 
+                        "&videoEncoderSpeedLevel=", pStreamerCfg->xcode.vid.out[outidx].governor.level)) > 0) {
+        idx += rc;
+      }
+    }
+  }
+
 
   return rc;
 }
@@ -241,7 +275,10 @@ int srv_ctrl_status(CLIENT_CONN_T *pConn) {
 
     } else  {
 
-      rc = ctrl_status_show_output(pStreamerCfg, buf, sizeof(buf));
+      if((rc = ctrl_status_show_output(pStreamerCfg, buf, sizeof(buf))) >= 0 && pConn->pListenCfg) {
+        idx = strlen(buf);
+        srv_ratelimit_dump(pConn->pListenCfg->pRateLimit, &buf[idx], sizeof(buf) - idx);
+      }
 
     }
 
@@ -188,7 +188,16 @@ int streamxmit_sendto(STREAM_RTP_DEST_T *pDest, const unsigned char *data, unsig
 
   //LOG(X_DEBUG("STREAMXMIT_SENDTO len:%d, rtcp:%d, drop:%d, pDest: 0x%x, srtp:0x%x, pSrtpShared: 0x%x, 0x%x, lenK:%d"), len, rtcp, drop, pDest, &pDest->srtps[rtcp ? 1 : 0], pDest->srtps[rtcp ? 1 : 0].pSrtpShared, SRTP_CTXT_PTR(&pDest->srtps[rtcp ? 1 : 0]), SRTP_CTXT_PTR(&pDest->srtps[rtcp ? 1 : 0])->k.lenKey);LOGHEX_DEBUG(data, MIN(16, len));
 
-  if((rc = srtp_dtls_protect(pnetsock, data, len, encBuf, sizeof(encBuf),
+  //
+  // Use any output already protected for this destination by streamxmit_srtp_prepare
+  //
+  if(!rtcp && streamxmit_srtp_lookup(pDest, data, len, &rc, &pData)) {
+    if(rc < 0) {
+      return -1;
+    } else if(rc > 0) {
+      len = rc;
+    }
+  } else if((rc = srtp_dtls_protect(pnetsock, data, len, encBuf, sizeof(encBuf),
                       (const struct sockaddr *) (rtcp ? &pDest->saDstsRtcp : &pDest->saDsts), 
                       pDest->srtps[rtcp ? 1 : 0].pSrtpShared,
                       rtcp ? SENDTO_PKT_TYPE_RTCP : SENDTO_PKT_TYPE_RTP)) < 0) {
@@ -1480,6 +1480,7 @@ int pip_start(const PIP_CFG_T *pPipCfgArg, STREAMER_CFG_T *pCfgOverlay, IXCODE_P
 	participantCfg.id = idxPip + 1;
 	participantCfg.input.type = PARTICIPANT_TYPE_CB_PCM;
 	participantCfg.output.type = PARTICIPANT_TYPE_PCM_POLL;
+	participantCfg.output.shareEncoded = 1;
 	//audioCfg.decodedWavPath = "decoded.wav";
 	//audioCfg.mixedWavPath = "mixed.wav";
 	//participantCfg.pAudioConfig = &audioCfg;
@@ -1635,6 +1636,9 @@ int pip_create_mixer(STREAMER_CFG_T *pStreamerCfg, int includeMainSrc) {
   mixerCfg.ac.includeSelfChannel = pStreamerCfg->pip.pMixerCfg->includeSelfChannel;
 //mixerCfg.ac.includeSelfChannel = 1;
   mixerCfg.highPriority = pStreamerCfg->pip.pMixerCfg->highPriority;
+  mixerCfg.schedulerWorkers = pStreamerCfg->pip.pMixerCfg->schedulerWorkers;
+  mixerCfg.maxSpeakers = pStreamerCfg->pip.pMixerCfg->maxSpeakers;
+  mixerCfg.speakerHoldMs = pStreamerCfg->pip.pMixerCfg->speakerHoldMs;
   // The mixer vad value is the mixer vad (webrtc) mode -1 (1: vad mode 0, 4: vad mode 3)
   mixerCfg.ac.mixerVad = pStreamerCfg->pip.pMixerCfg->vad; 
   mixerCfg.ac.mixerAgc = pStreamerCfg->pip.pMixerCfg->agc;
@@ -1653,6 +1657,7 @@ int pip_create_mixer(STREAMER_CFG_T *pStreamerCfg, int includeMainSrc) {
     participantCfg.id = 0;
     participantCfg.input.type = PARTICIPANT_TYPE_CB_PCM;
     participantCfg.output.type = PARTICIPANT_TYPE_PCM_POLL;
+    participantCfg.output.shareEncoded = 1;
     //audioCfg.decodedWavPath = "decoded.wav";
     //audioCfg.mixedWavPath = "mixed.wav";
     //participantCfg.pAudioConfig = &audioCfg;
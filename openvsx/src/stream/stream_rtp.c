@@ -22,10 +22,19 @@
  */
 
 
+#if defined(__linux__)
+#define _GNU_SOURCE 1
+#endif // __linux__
+
 #include "vsx_common.h"
 
 #if defined(VSX_HAVE_STREAMER)
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define STREAM_RTCP_SHARED_RECEIVER 1
+#endif // __linux__
+
 #define RTCP_SDES_TXT   VSX_APPNAME
 
 #define RTP_SET_IP4_LEN(pRtp) (pRtp)->packet.u_ip.pip4->ip_len =  \
@@ -36,6 +45,8 @@
 
 static int stream_rtcp_responder_start(STREAM_RTP_MULTI_T *pRtp, int lock);
 static int stream_rtcp_responder_stop(STREAM_RTP_MULTI_T *pRtp);
+static void rtcp_rcv_adddest(STREAM_RTP_MULTI_T *pRtp, unsigned int idxDest);
+static void rtcp_rcv_removedest(STREAM_RTP_MULTI_T *pRtp, unsigned int idxDest);
 static int stream_rtcp_createbye(STREAM_RTP_MULTI_T *pRtp, unsigned int idxDest,
                                  unsigned char *pBuf, unsigned int lenbuf);
 
@@ -208,6 +219,11 @@ int stream_rtp_init(STREAM_RTP_MULTI_T *pRtp, const STREAM_RTP_INIT_T *pInit, in
     pRtp->pdests[idx].tmLastRtcpSr = 0;
   }
 
+  if(stream_rtpdests_init(&pRtp->destTable, pRtp->maxDests) < 0) {
+    LOG(X_ERROR("Failed to initialize RTP destination table for %d destinations"), pRtp->maxDests);
+    return -1;
+  }
+
   if((rc = stream_rtp_reset(pRtp, is_dtls)) < 0) {
     return rc;
   }
@@ -317,6 +333,9 @@ int stream_rtp_updatedest(STREAM_RTP_DEST_T *pDest, const STREAM_DEST_CFG_T *pDe
     INET_PORT(pDest->saDstsRtcp) = htons(rtcpPort);
 
     pthread_mutex_unlock(&STREAM_RTCP_PSTUNSOCK(*pDest)->mtxXmit);
+
+    stream_rtpdests_rehash(&pRtp->destTable, (unsigned int) (pDest - pRtp->pdests), 
+                           (const struct sockaddr *) &pDest->saDstsRtcp);
   }
 
   pthread_mutex_unlock(&pRtp->mtx);
@@ -583,6 +602,7 @@ STREAM_RTP_DEST_T *stream_rtp_adddest(STREAM_RTP_MULTI_T *pRtp, const STREAM_DES
   struct sockaddr *psa;
   char tmp[128];
   unsigned int idxStream = 0;
+  int idx;
   int is_audvidmux = 0;
   int do_rtcp = 0;
   int rc = 0;
@@ -599,15 +619,11 @@ STREAM_RTP_DEST_T *stream_rtp_adddest(STREAM_RTP_MULTI_T *pRtp, const STREAM_DES
   }
 
   if(rc == 0) {
-    for(idxStream = 0; idxStream < pRtp->maxDests; idxStream++) {
-      if(!pRtp->pdests[idxStream].isactive) {
-        pDest = &pRtp->pdests[idxStream];
-        pDest->pRtpMulti = pRtp;
-        break;
-      }
-    }
-
-    if(!pDest) {
+    if((idx = stream_rtpdests_alloc(&pRtp->destTable)) >= 0) {
+      idxStream = (unsigned int) idx;
+      pDest = &pRtp->pdests[idxStream];
+      pDest->pRtpMulti = pRtp;
+    } else {
       rc = -1;
     }
   }
@@ -907,6 +923,7 @@ STREAM_RTP_DEST_T *stream_rtp_adddest(STREAM_RTP_MULTI_T *pRtp, const STREAM_DES
   if(rc == 0) {
     pDest->isactive = 1;
     pRtp->numDests++;
+    stream_rtpdests_activate(&pRtp->destTable, idxStream, (const struct sockaddr *) &pDest->saDstsRtcp);
 
     if(pDestCfg->pMonitor && pDestCfg->pMonitor->active) {
 
@@ -1041,10 +1058,19 @@ STREAM_RTP_DEST_T *stream_rtp_adddest(STREAM_RTP_MULTI_T *pRtp, const STREAM_DES
 
   } if(!pDest) {
     LOG(X_ERROR("No available RTP session %d/%d"), pRtp->numDests, pRtp->maxDests);
+  } else if(!pDest->isactive) {
+    stream_rtpdests_release(&pRtp->destTable, idxStream);
+  } else if(pRtp->doRrListener > 0) {
+    //
+    // Start receiving on the destination sockets, including any TURN relayed socket
+    //
+    rtcp_rcv_adddest(pRtp, idxStream);
   }
 
   pthread_mutex_unlock(&pRtp->mtx); 
 
+  stream_rtpdests_reclaim(&pRtp->destTable);
+
   return rc == 0 ? pDest : NULL;
 }
 
@@ -1070,6 +1096,7 @@ static int stream_rtp_removedestidx(STREAM_RTP_MULTI_T *pRtp,
 
   if(pRtp->init.raw.haveRaw) {
     pDest->isactive = 0;
+    stream_rtpdests_release(&pRtp->destTable, idxDest);
     pDest->ptvlastupdate = NULL;
     pDest->outCb.pliveQIdx = NULL;
     if(lock) {
@@ -1078,6 +1105,13 @@ static int stream_rtp_removedestidx(STREAM_RTP_MULTI_T *pRtp,
     return 0;
   }
 
+  //
+  // Stop receiving on the destination sockets before they are closed
+  //
+  if(pRtp->doRrListener > 0) {
+    rtcp_rcv_removedest(pRtp, idxDest);
+  }
+
   streamxmit_close(pDest, 0);
 
   if(INET_PORT(pDest->saDstsRtcp) != 0 && 
@@ -1156,6 +1190,7 @@ static int stream_rtp_removedestidx(STREAM_RTP_MULTI_T *pRtp,
       pRtp->numDests--;
     }
   }
+  stream_rtpdests_release(&pRtp->destTable, idxDest);
 
   if(lock) {
     pthread_mutex_unlock(&pRtp->mtx);
@@ -1177,17 +1212,22 @@ int stream_rtp_removedest(STREAM_RTP_MULTI_T *pRtp, const STREAM_RTP_DEST_T *pDe
     return -1;
   }
 
+  if(pDest < pRtp->pdests || pDest >= &pRtp->pdests[pRtp->maxDests]) {
+    return -1;
+  }
+
+  idxDest = (unsigned int) (pDest - pRtp->pdests);
+
   pthread_mutex_lock(&pRtp->mtx);
 
-  for(idxDest = 0; idxDest < pRtp->maxDests; idxDest++) {
-    if(pRtp->pdests[idxDest].isactive && pDest == &pRtp->pdests[idxDest]) {
-      rc = stream_rtp_removedestidx(pRtp, idxDest, 0);
-      break;
-    }
+  if(pRtp->pdests[idxDest].isactive) {
+    rc = stream_rtp_removedestidx(pRtp, idxDest, 0);
   }
 
   pthread_mutex_unlock(&pRtp->mtx);
 
+  stream_rtpdests_reclaim(&pRtp->destTable);
+
   return rc;
 }
 
@@ -1207,6 +1247,10 @@ int stream_rtp_close(STREAM_RTP_MULTI_T *pRtp) {
 
   pthread_mutex_unlock(&pRtp->mtx);
 
+  stream_rtpdests_reclaim(&pRtp->destTable);
+
+  streamxmit_srtp_close(pRtp);
+
   stream_stun_stop(pRtp);
 
   stream_rtcp_responder_stop(pRtp);
@@ -1224,6 +1268,8 @@ int stream_rtp_close(STREAM_RTP_MULTI_T *pRtp) {
   pRtp->dtls.pDtlsShared = NULL;
 #endif // (VSX_HAVE_SSL_DTLS)
 
+  stream_rtpdests_close(&pRtp->destTable);
+
   pthread_mutex_destroy(&pRtp->mtx);
   pRtp->isinit = 0;
 
@@ -1855,9 +1901,47 @@ int stream_rtp_handlertcp(STREAM_RTP_DEST_T *pRtpDest, const RTCP_PKT_HDR_T *pDa
   return rc;
 }
 
+static STREAM_RTP_DEST_T *find_rtcp_dest_idx(STREAM_RTP_MULTI_T *pRtpCur, const struct sockaddr *psaSrc) {
+  int idx;
+  unsigned int cnt = 0;
+  unsigned int idxActive;
+  const STREAM_RTP_DESTS_T *pTable = &pRtpCur->destTable;
+
+  //
+  // Walk the destinations hashed by RTCP address and port
+  //
+  idx = stream_rtpdests_lookup_first(pTable, psaSrc);
+
+  while(idx >= 0 && cnt++ < pRtpCur->maxDests) {
+
+    if(pRtpCur->pdests[idx].isactive && INET_PORT(pRtpCur->pdests[idx].saDstsRtcp) == PINET_PORT(psaSrc) &&
+       INET_IS_SAMEADDR(pRtpCur->pdests[idx].saDstsRtcp, *((const struct sockaddr_storage *) psaSrc))) {
+      return &pRtpCur->pdests[idx];
+    }
+
+    idx = stream_rtpdests_lookup_next(pTable, idx);
+  }
+
+  //
+  // RTCP from an address other than the destination address, such as with a localhost, virtual IP
+  // or proxy mapping, is matched on the port alone.  This only happens when no destination 
+  // matches the sender address.
+  //
+  for(idxActive = 0; idxActive < pTable->numActive; idxActive++) {
+    idx = pTable->pActiveIdxs[idxActive];
+    if(pRtpCur->pdests[idx].isactive && INET_PORT(pRtpCur->pdests[idx].saDstsRtcp) == PINET_PORT(psaSrc)) {
+      return &pRtpCur->pdests[idx];
+    }
+  }
+
+  return NULL;
+}
+
 static STREAM_RTP_DEST_T *find_rtcp_dest(STREAM_RTP_MULTI_T *pRtp, const RTCP_PKT_HDR_T *pHdr, 
-                                         unsigned int len, uint16_t port) {
+                                         unsigned int len, const struct sockaddr *psaSrc) {
   unsigned int idx;
+  uint16_t port = PINET_PORT(psaSrc);
+  STREAM_RTP_DEST_T *pDest;
   int match_ssrc = 1;
   STREAM_RTP_MULTI_T *pRtpCur = pRtp->pheadall;
   uint32_t ssrc = 0;
@@ -1877,14 +1961,26 @@ static STREAM_RTP_DEST_T *find_rtcp_dest(STREAM_RTP_MULTI_T *pRtp, const RTCP_PK
   }
 
   while(pRtpCur) {
-    
-    if(pRtpCur->numDests > 0) {
+
+    if(pRtpCur->numDests > 0 && pRtpCur->destTable.active) {
+
+      //
+      // The output SSRC separates outputs which share a destination address and port, 
+      // such as audio and video multiplexed onto one port
+      //
+      if((!match_ssrc || ssrc == pRtpCur->init.ssrc) && (pDest = find_rtcp_dest_idx(pRtpCur, psaSrc))) {
+        return pDest;
+      }
+
+    } else if(pRtpCur->numDests > 0) {
       for(idx = 0; idx < pRtp->maxDests; idx++) {
 
         //fprintf(stderr, "RTSP RTCP RR try %s:%d pRtpCur:0x%x, ssrc: 0x%x numDests:%d active:%d %d/%d\n", inet_ntoa(pRtpCur->pdests[idx].saDstsRtcp.sin_addr), ntohs(pRtpCur->pdests[idx].saDstsRtcp.sin_port), pRtpCur, pRtpCur->init.ssrc, pRtpCur->numDests, pRtpCur->pdests[idx].isactive, idx, pRtp->maxDests);
 
         //
-        // TODO: this match is only done on port to allow localhost / virtual IP / proxy mappings
+        // Without the destination index the match is done on port only, since the sender
+        // address may differ from the destination address under localhost, virtual IP or 
+        // proxy mappings
         //
         if(pRtpCur->pdests[idx].isactive) {
           if(match_ssrc) {
@@ -1930,7 +2026,7 @@ int stream_process_rtcp(STREAM_RTP_MULTI_T *pRtpHeadall,
 
   pthread_mutex_lock(&pRtpHeadall->mtx);
 
-  if(!(pRtpDest = find_rtcp_dest(pRtpHeadall, pHdr, len, PINET_PORT(psaSrc)))) {
+  if(!(pRtpDest = find_rtcp_dest(pRtpHeadall, pHdr, len, psaSrc))) {
     LOG(X_ERROR("recv[rtcp] RTCP ssrc: 0x%x unable to find RTP stream %s:%d -> :%d"), 
       htonl(*((uint32_t *) &(((uint8_t *) pHdr)[8]))), FORMAT_NETADDR(*psaSrc, tmp, sizeof(tmp)), 
       ntohs(PINET_PORT(psaSrc)), ntohs(PINET_PORT(psaDst)));
@@ -1956,15 +2052,693 @@ int stream_process_rtcp(STREAM_RTP_MULTI_T *pRtpHeadall,
 }
 
 
+//
+// Handles any TURN or DTLS data received on an output RTP socket
+//
+static void rtcp_responder_onrtp(STREAM_RTP_DEST_T *pDest, unsigned char *buf, int pktlen,
+                                 const struct sockaddr *psaSrc, const struct sockaddr *psaDst) {
+  int rc;
+  unsigned char *pData = buf;
+  int is_turn = 0;
+  int is_turn_indication = 0;
+  int is_turn_channeldata = 0;
+
+  //
+  // Receive any TURN data
+  //
+  if(pDest->xmit.netsock.turn.use_turn_indication_in &&
+     (stun_ispacket(buf, pktlen) || (is_turn_channeldata = turn_ischanneldata(buf, pktlen)))) {
+
+    if((rc = turn_onrcv_pkt(&pDest->turns[0], &pDest->stun, is_turn_channeldata, 
+                            &is_turn, &is_turn_indication, &pData, &pktlen, 
+                            psaSrc, psaDst, &pDest->xmit.netsock)) < 0) {
+    }
+  }
+
+  if((!is_turn || is_turn_indication || is_turn_channeldata) && DTLS_ISPACKET(buf, pktlen) && 
+    (pktlen = dtls_netsock_ondata(&pDest->xmit.netsock, buf, pktlen, psaSrc)) < 0) {
+
+  }
+
+}
+
+//
+// Handles any RTCP, TURN or DTLS data received on an output RTCP socket of pRtp->pdests[idx]
+//
+static void rtcp_responder_onrtcp(STREAM_RTP_MULTI_T *pRtp, unsigned int idx, unsigned char *buf, int pktlen,
+                                  const struct sockaddr *psaSrc, const struct sockaddr *psaDst) {
+  int rc;
+  STREAM_RTP_DEST_T *pdest;
+  unsigned char *pData = buf;
+  int is_turn = 0;
+  int is_turn_indication = 0;
+  int is_turn_channeldata = 0;
+  char tmp[128];
+
+  //LOG(X_DEBUGV("recv[rtcp rr:%u] %s:%d -> :%d pktlen:%d, ssrc: 0x%x, pt:%d"), idx, FORMAT_NETADDR(*psaSrc, tmp, sizeof(tmp)), ntohs(PINET_PORT(psaSrc)), ntohs(PINET_PORT(psaDst)), pktlen, htonl(*(uint32_t *) (&buf[8])), buf[1]);
+
+  //
+  // Receive any TURN data on the RTCP socket
+  //
+  if(pRtp->pdests[idx].xmit.netsock.turn.use_turn_indication_in &&
+      (stun_ispacket(buf, pktlen) || (is_turn_channeldata = turn_ischanneldata(buf, pktlen)))) {
+
+    if((rc = turn_onrcv_pkt(INET_PORT(pRtp->pdests[idx].saDstsRtcp) == INET_PORT(pRtp->pdests[idx].saDsts) ?
+                            &pRtp->pdests[idx].turns[0] : &pRtp->pdests[idx].turns[1], 
+                            &pRtp->pdests[idx].stun, is_turn_channeldata,
+                            &is_turn, &is_turn_indication, &pData, &pktlen, psaSrc, psaDst,
+                            STREAM_RTCP_PNETIOSOCK(pRtp->pdests[idx]))) < 0) {
+    }
+  }
+
+  if((!is_turn || is_turn_indication || is_turn_channeldata) &&
+    STREAM_RTCP_PNETIOSOCK(pRtp->pdests[idx])->ssl.pCtxt && DTLS_ISPACKET(buf, pktlen)) {
+    pktlen = dtls_netsock_ondata(STREAM_RTCP_PNETIOSOCK(pRtp->pdests[idx]), buf, pktlen, psaSrc);
+    LOG(X_DEBUG("DTLS packet pktlen:%d"), pktlen); 
+    if(pktlen <= 0) {
+      return;
+    }
+  }
+
+  pdest = NULL;
+  //
+  // If overlappingPorts is set, assume that all RTP (RTCP) listener ports are the same, so each
+  // incoming RTCP message may not come in on the right socket
+  //
+  if(!pRtp->overlappingPorts) {
+    pdest = &pRtp->pdests[idx];
+  } else if(pktlen >= RTCP_HDR_LEN + 4 && 
+    !(pdest = find_rtcp_dest(pRtp, (RTCP_PKT_HDR_T *) buf, pktlen, psaSrc))) {
+    LOG(X_ERROR("recv[rtcp rr:%u] RTCP ssrc: 0x%x unable to find RTP stream %s:%d -> :%d"), idx,
+        htonl(*((uint32_t *) &(((uint8_t *) buf)[8]))), FORMAT_NETADDR(*psaSrc, tmp, sizeof(tmp)), 
+        ntohs(PINET_PORT(psaSrc)), ntohs(PINET_PORT(psaDst)));
+  }
+
+  if(pdest) {
+    if(pdest->pRtpMulti != pRtp) {
+      pthread_mutex_lock(&((STREAM_RTP_MULTI_T *) pdest->pRtpMulti)->mtx);
+    }
+
+    stream_rtp_handlertcp(pdest, (RTCP_PKT_HDR_T *) buf, pktlen, psaSrc, psaDst);
+
+    if(pdest->pRtpMulti != pRtp) {
+      pthread_mutex_unlock(&((STREAM_RTP_MULTI_T *) pdest->pRtpMulti)->mtx);
+    }
+  }
+
+}
+
+#if defined(STREAM_RTCP_SHARED_RECEIVER)
+
+//
+// All outputs registered for RTCP reception are serviced by a single receiver thread which 
+// multiplexes every output RTP / RTCP socket using one epoll instance.  The receiver thread is
+// started upon registration of the first output and exits when no more outputs are registered.
+//
+
+#define RTCP_RCV_BATCH           16
+#define RTCP_RCV_PKT_SZ          4096
+#define RTCP_RCV_WAIT_MS         300
+
+//
+// The epoll registration of each socket is owned by one slot.  Destinations sharing a socket,
+// such as with rtcp-mux or a shared capture socket, each get their own slot but only the first
+// registers the socket.  Epoll event data holds the slot index and the slot generation so that 
+// events of a since removed slot are ignored.
+//
+typedef struct RTCP_RCV_SLOT {
+  int                         inuse;
+  int                         registered;   // this slot owns the epoll registration of fd
+  uint32_t                    gen;
+  STREAM_RTP_MULTI_T         *pRtp;
+  unsigned int                idxDest;
+  int                         is_rtcp;
+  SOCKET                      fd;
+  struct sockaddr_storage     saLocal;
+} RTCP_RCV_SLOT_T;
+
+typedef struct RTCP_RCV {
+  pthread_mutex_t             mtx;          // protects the registered outputs list and the slots
+  pthread_mutex_t             mtxDispatch;  // held by the receiver while referencing any registered output
+  STREAM_RTP_MULTI_T        **ppRtps;
+  unsigned int                numRtps;
+  unsigned int                maxRtps;
+  int                         running;
+  int                         epollfd;
+  RTCP_RCV_SLOT_T            *pSlots;
+  unsigned int                numSlots;     // high water mark of pSlots in use
+  unsigned int                maxSlots;
+  char                        tid_tag[LOGUTIL_TAG_LENGTH];
+} RTCP_RCV_T;
+
+typedef struct RTCP_RCV_CTXT {
+  struct mmsghdr              msgs[RTCP_RCV_BATCH];
+  struct iovec                iovs[RTCP_RCV_BATCH];
+  struct sockaddr_storage     saSrcs[RTCP_RCV_BATCH];
+  unsigned char               bufs[RTCP_RCV_BATCH][RTCP_RCV_PKT_SZ];
+} RTCP_RCV_CTXT_T;
+
+static RTCP_RCV_T g_rtcp_rcv = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0, -1, 
+                                 NULL, 0, 0, "" };
+
+#define RTCP_RCV_EVENT_DATA(idx, gen)  (((uint64_t) (gen) << 32) | (idx))
+
+static int rtcp_rcv_register(RTCP_RCV_T *pRcv, unsigned int idxSlot) {
+  struct epoll_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.u64 = RTCP_RCV_EVENT_DATA(idxSlot, pRcv->pSlots[idxSlot].gen);
+
+  if(epoll_ctl(pRcv->epollfd, EPOLL_CTL_ADD, pRcv->pSlots[idxSlot].fd, &ev) != 0) {
+    LOG(X_ERROR("RTCP receiver failed to add socket %d "ERRNO_FMT_STR), pRcv->pSlots[idxSlot].fd, ERRNO_FMT_ARGS);
+    return -1;
+  }
+
+  pRcv->pSlots[idxSlot].registered = 1;
+
+  return 0;
+}
+
+//
+// Called with pRcv->mtx held
+//
+static int rtcp_rcv_addslot(RTCP_RCV_T *pRcv, STREAM_RTP_MULTI_T *pRtp, unsigned int idxDest, 
+                            int is_rtcp, SOCKET fd) {
+  RTCP_RCV_SLOT_T *pSlot;
+  unsigned int idx;
+  unsigned int idxSlot;
+  int registered = 0;
+  socklen_t len;
+
+  for(idxSlot = 0; idxSlot < pRcv->numSlots; idxSlot++) {
+    if(!pRcv->pSlots[idxSlot].inuse) {
+      break;
+    }
+  }
+
+  if(idxSlot >= pRcv->maxSlots) {
+    if(!(pSlot = (RTCP_RCV_SLOT_T *) avc_realloc(pRcv->pSlots, 
+                                                 (pRcv->maxSlots + 64) * sizeof(RTCP_RCV_SLOT_T)))) {
+      return -1;
+    }
+    memset(&pSlot[pRcv->maxSlots], 0, 64 * sizeof(RTCP_RCV_SLOT_T));
+    pRcv->pSlots = pSlot;
+    pRcv->maxSlots += 64;
+  }
+
+  for(idx = 0; idx < pRcv->numSlots; idx++) {
+    if(pRcv->pSlots[idx].inuse && pRcv->pSlots[idx].registered && pRcv->pSlots[idx].fd == fd) {
+      registered = 1;
+      break;
+    }
+  }
+
+  pSlot = &pRcv->pSlots[idxSlot];
+  pSlot->inuse = 1;
+  pSlot->registered = 0;
+  pSlot->gen++;
+  pSlot->pRtp = pRtp;
+  pSlot->idxDest = idxDest;
+  pSlot->is_rtcp = is_rtcp;
+  pSlot->fd = fd;
+  len = sizeof(pSlot->saLocal);
+  memset(&pSlot->saLocal, 0, sizeof(pSlot->saLocal));
+  getsockname(fd, (struct sockaddr *) &pSlot->saLocal, &len);
+
+  if(idxSlot >= pRcv->numSlots) {
+    pRcv->numSlots = idxSlot + 1;
+  }
+
+  if(!registered && rtcp_rcv_register(pRcv, idxSlot) < 0) {
+    pSlot->inuse = 0;
+    return -1;
+  }
+
+  return 0;
+}
+
+//
+// Called with pRcv->mtx held.  A socket which is about to be closed is removed from the epoll set 
+// before the close, since the descriptor may otherwise be reused before the removal.
+//
+static void rtcp_rcv_removeslot(RTCP_RCV_T *pRcv, unsigned int idxSlot, int closing) {
+  RTCP_RCV_SLOT_T *pSlot = &pRcv->pSlots[idxSlot];
+  unsigned int idx;
+
+  pSlot->inuse = 0;
+
+  if(!pSlot->registered) {
+    return;
+  }
+
+  pSlot->registered = 0;
+  epoll_ctl(pRcv->epollfd, EPOLL_CTL_DEL, pSlot->fd, NULL);
+
+  if(closing) {
+    return;
+  }
+
+  //
+  // Hand the registration of a still open shared socket over to another slot
+  //
+  for(idx = 0; idx < pRcv->numSlots; idx++) {
+    if(pRcv->pSlots[idx].inuse && pRcv->pSlots[idx].fd == pSlot->fd) {
+      rtcp_rcv_register(pRcv, idx);
+      break;
+    }
+  }
+
+}
+
+//
+// Adds the receive sockets of an output destination.  Called with pRtp->mtx held.
+//
+static void rtcp_rcv_adddest(STREAM_RTP_MULTI_T *pRtp, unsigned int idxDest) {
+  RTCP_RCV_T *pRcv = &g_rtcp_rcv;
+  STREAM_RTP_DEST_T *pDest = &pRtp->pdests[idxDest];
+  unsigned int idxSlot;
+
+  pthread_mutex_lock(&pRcv->mtx);
+
+  if(pRcv->epollfd < 0) {
+    pthread_mutex_unlock(&pRcv->mtx);
+    return;
+  }
+
+  //
+  // Re-adding a destination picks up any socket which has since become eligible, such as after
+  // a TURN relay setup
+  //
+  for(idxSlot = 0; idxSlot < pRcv->numSlots; idxSlot++) {
+    if(pRcv->pSlots[idxSlot].inuse && pRcv->pSlots[idxSlot].pRtp == pRtp && 
+       pRcv->pSlots[idxSlot].idxDest == idxDest) {
+      rtcp_rcv_removeslot(pRcv, idxSlot, 0);
+    }
+  }
+
+  if(pDest->isactive) {
+
+    if(pDest->sendrtcpsr && STREAM_RTCP_FD(*pDest) != INVALID_SOCKET) {
+      rtcp_rcv_addslot(pRcv, pRtp, idxDest, 1, STREAM_RTCP_FD(*pDest));
+    }
+
+    if(PNETIOSOCK_FD(&pDest->xmit.netsock) != INVALID_SOCKET &&
+       PNETIOSOCK_FD(&pDest->xmit.netsock) != STREAM_RTCP_FD(*pDest) &&
+       (pDest->xmit.netsock.ssl.pCtxt || pDest->xmit.netsock.turn.use_turn_indication_in)) {
+      rtcp_rcv_addslot(pRcv, pRtp, idxDest, 0, PNETIOSOCK_FD(&pDest->xmit.netsock));
+    }
+  }
+
+  VSX_DEBUG_RTCP( LOG(X_DEBUG("RTCP - receiver add dest[%d] pt:%d, slots:%d"), idxDest, pRtp->init.pt, 
+                      pRcv->numSlots); );
+
+  pthread_mutex_unlock(&pRcv->mtx);
+}
+
+//
+// Removes the receive sockets of an output destination prior to the destination sockets
+// being closed.  Called with pRtp->mtx held.
+//
+static void rtcp_rcv_removedest(STREAM_RTP_MULTI_T *pRtp, unsigned int idxDest) {
+  RTCP_RCV_T *pRcv = &g_rtcp_rcv;
+  STREAM_RTP_DEST_T *pDest = &pRtp->pdests[idxDest];
+  SOCKET fdRtp = NETIOSOCK_FD(pDest->xmit.netsock);
+  SOCKET fdRtcp = NETIOSOCK_FD(pDest->xmit.netsockRtcp);
+  RTCP_RCV_SLOT_T *pSlot;
+  unsigned int idxSlot;
+  int closing;
+
+  pthread_mutex_lock(&pRcv->mtx);
+
+  for(idxSlot = 0; idxSlot < pRcv->numSlots; idxSlot++) {
+
+    pSlot = &pRcv->pSlots[idxSlot];
+    if(!pSlot->inuse) {
+      continue;
+    }
+
+    //
+    // Any other destination slot using a socket owned by this destination is removed as well
+    //
+    closing = (pSlot->fd != INVALID_SOCKET && (pSlot->fd == fdRtp || pSlot->fd == fdRtcp));
+
+    if(closing || (pSlot->pRtp == pRtp && pSlot->idxDest == idxDest)) {
+      rtcp_rcv_removeslot(pRcv, idxSlot, closing);
+    }
+  }
+
+  pthread_mutex_unlock(&pRcv->mtx);
+}
+
+//
+// Reads and processes a batch of packets from one ready socket
+//
+static int rtcp_rcv_onslot(RTCP_RCV_CTXT_T *pCtxt, const RTCP_RCV_SLOT_T *pSlot) {
+  STREAM_RTP_MULTI_T *pRtp = pSlot->pRtp;
+  STREAM_RTP_DEST_T *pDest;
+  int numPkts;
+  int idx;
+  int rc = 0;
+  char tmp[128];
+
+  pthread_mutex_lock(&pRtp->mtx);
+
+  pDest = &pRtp->pdests[pSlot->idxDest];
+
+  //
+  // Make sure the destination has not been removed or had its socket replaced
+  //
+  if(!pDest->isactive ||
+     (pSlot->is_rtcp && (!pDest->sendrtcpsr || STREAM_RTCP_FD(*pDest) != pSlot->fd)) ||
+     (!pSlot->is_rtcp && PNETIOSOCK_FD(&pDest->xmit.netsock) != pSlot->fd)) {
+    pthread_mutex_unlock(&pRtp->mtx);
+    return -1;
+  }
+
+  for(idx = 0; idx < RTCP_RCV_BATCH; idx++) {
+    pCtxt->msgs[idx].msg_hdr.msg_namelen = sizeof(pCtxt->saSrcs[idx]);
+    pCtxt->iovs[idx].iov_len = RTCP_RCV_PKT_SZ;
+  }
+
+  if((numPkts = recvmmsg(pSlot->fd, pCtxt->msgs, RTCP_RCV_BATCH, MSG_DONTWAIT, NULL)) < 0) {
+
+    if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      LOG(X_ERROR("recv[%s rr:%u] :%d failed "ERRNO_FMT_STR), pSlot->is_rtcp ? "rtcp" : "rtp", pSlot->idxDest,
+                  ntohs(INET_PORT(pSlot->saLocal)), ERRNO_FMT_ARGS);
+      rc = -1;
+    }
+    pthread_mutex_unlock(&pRtp->mtx);
+    return rc;
+  }
+
+  for(idx = 0; idx < numPkts; idx++) {
+
+    if(pCtxt->msgs[idx].msg_len <= 0) {
+      continue;
+    }
+
+    VSX_DEBUG_RTCP( LOG(X_DEBUGV("RTCP - receiver recv[%s rr:%u] %s:%d -> :%d pktlen:%d"), 
+                        pSlot->is_rtcp ? "rtcp" : "rtp", pSlot->idxDest, 
+                        FORMAT_NETADDR(pCtxt->saSrcs[idx], tmp, sizeof(tmp)), ntohs(INET_PORT(pCtxt->saSrcs[idx])),
+                        ntohs(INET_PORT(pSlot->saLocal)), pCtxt->msgs[idx].msg_len); );
+
+    if(pSlot->is_rtcp) {
+      rtcp_responder_onrtcp(pRtp, pSlot->idxDest, pCtxt->bufs[idx], pCtxt->msgs[idx].msg_len,
+                            (const struct sockaddr *) &pCtxt->saSrcs[idx], 
+                            (const struct sockaddr *) &pSlot->saLocal);
+    } else {
+      rtcp_responder_onrtp(pDest, pCtxt->bufs[idx], pCtxt->msgs[idx].msg_len,
+                           (const struct sockaddr *) &pCtxt->saSrcs[idx], 
+                           (const struct sockaddr *) &pSlot->saLocal);
+    }
+
+    //
+    // A packet handler may have removed the destination
+    //
+    if(!pDest->isactive) {
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&pRtp->mtx);
+
+  return rc;
+}
+
+//
+// Releases the epoll instance together with the running state, so that a subsequent registration 
+// starts a new receiver with a new epoll instance.  Called with pRcv->mtx held.
+//
+static void rtcp_rcv_close(RTCP_RCV_T *pRcv) {
+  unsigned int idxSlot;
+
+  pRcv->running = 0;
+  if(pRcv->epollfd >= 0) {
+    close(pRcv->epollfd);
+    pRcv->epollfd = -1;
+  }
+  for(idxSlot = 0; idxSlot < pRcv->numSlots; idxSlot++) {
+    pRcv->pSlots[idxSlot].inuse = 0;
+    pRcv->pSlots[idxSlot].registered = 0;
+  }
+  pRcv->numSlots = 0;
+}
+
+static void rtcp_rcv_proc(void *pArg) {
+  RTCP_RCV_T *pRcv = &g_rtcp_rcv;
+  RTCP_RCV_CTXT_T *pCtxt = NULL;
+  RTCP_RCV_SLOT_T slot;
+  char tid_tag[LOGUTIL_TAG_LENGTH];
+  struct epoll_event events[RTCP_RCV_BATCH];
+  unsigned int idx;
+  unsigned int idxSlot;
+  int numEvents;
+  int epollfd;
+  int running = 1;
+
+  pthread_mutex_lock(&pRcv->mtx);
+  memcpy(tid_tag, pRcv->tid_tag, sizeof(tid_tag));
+  epollfd = pRcv->epollfd;
+  pthread_mutex_unlock(&pRcv->mtx);
+  logutil_tid_add(pthread_self(), tid_tag);
+
+  if((pCtxt = (RTCP_RCV_CTXT_T *) avc_calloc(1, sizeof(RTCP_RCV_CTXT_T)))) {
+    for(idx = 0; idx < RTCP_RCV_BATCH; idx++) {
+      pCtxt->iovs[idx].iov_base = pCtxt->bufs[idx];
+      pCtxt->msgs[idx].msg_hdr.msg_iov = &pCtxt->iovs[idx];
+      pCtxt->msgs[idx].msg_hdr.msg_iovlen = 1;
+      pCtxt->msgs[idx].msg_hdr.msg_name = &pCtxt->saSrcs[idx];
+    }
+  }
+
+  LOG(X_DEBUG("RTCP receiver thread started"));
+
+  while(running && pCtxt) {
+
+    if((numEvents = epoll_wait(epollfd, events, RTCP_RCV_BATCH, RTCP_RCV_WAIT_MS)) < 0 && 
+       errno != EINTR) {
+      LOG(X_ERROR("RTCP receiver epoll_wait failed "ERRNO_FMT_STR), ERRNO_FMT_ARGS);
+      usleep(RTCP_RCV_WAIT_MS * 1000);
+    }
+
+    pthread_mutex_lock(&pRcv->mtxDispatch);
+
+    for(idx = 0; idx < (unsigned int) numEvents; idx++) {
+
+      //
+      // Copy the slot since it may be removed once the slot lock is released.  Its output 
+      // remains valid until mtxDispatch is released.
+      //
+      idxSlot = (uint32_t) events[idx].data.u64;
+      pthread_mutex_lock(&pRcv->mtx);
+      if(idxSlot < pRcv->numSlots && pRcv->pSlots[idxSlot].inuse &&
+         pRcv->pSlots[idxSlot].gen == (uint32_t) (events[idx].data.u64 >> 32)) {
+        memcpy(&slot, &pRcv->pSlots[idxSlot], sizeof(slot));
+      } else {
+        slot.inuse = 0;
+      }
+      pthread_mutex_unlock(&pRcv->mtx);
+
+      if(slot.inuse && rtcp_rcv_onslot(pCtxt, &slot) < 0) {
+
+        VSX_DEBUG_RTCP( LOG(X_DEBUG("RTCP - receiver slot[%d] dest[%d] fd:%d no longer valid"), 
+                            idxSlot, slot.idxDest, slot.fd); );
+
+        //
+        // Stop polling a socket which is no longer used for reception by its destination
+        //
+        pthread_mutex_lock(&pRcv->mtx);
+        if(pRcv->pSlots[idxSlot].inuse && pRcv->pSlots[idxSlot].gen == slot.gen) {
+          rtcp_rcv_removeslot(pRcv, idxSlot, 0);
+        }
+        pthread_mutex_unlock(&pRcv->mtx);
+      }
+    }
+
+    pthread_mutex_unlock(&pRcv->mtxDispatch);
+
+    pthread_mutex_lock(&pRcv->mtx);
+    if(pRcv->numRtps == 0 || g_proc_exit) {
+      running = 0;
+      rtcp_rcv_close(pRcv);
+    }
+    pthread_mutex_unlock(&pRcv->mtx);
+  }
+
+  if(running) {
+    pthread_mutex_lock(&pRcv->mtx);
+    rtcp_rcv_close(pRcv);
+    pthread_mutex_unlock(&pRcv->mtx);
+  }
+
+  if(pCtxt) {
+    avc_free((void **) &pCtxt);
+  }
+
+  LOG(X_DEBUG("RTCP receiver thread ending"));
+
+  logutil_tid_remove(pthread_self());
+}
+
+static int stream_rtcp_responder_stop(STREAM_RTP_MULTI_T *pRtp) {
+  RTCP_RCV_T *pRcv = &g_rtcp_rcv;
+  unsigned int idx;
+  int found = 0;
+
+  pthread_mutex_lock(&pRtp->mtx);
+  if(pRtp->doRrListener <= 0) {
+    pthread_mutex_unlock(&pRtp->mtx);
+    return 0;
+  }
+  pRtp->doRrListener = 0;
+  pthread_mutex_unlock(&pRtp->mtx);
+
+  pthread_mutex_lock(&pRcv->mtx);
+  for(idx = 0; idx < pRcv->numRtps; idx++) {
+    if(pRcv->ppRtps[idx] == pRtp) {
+      pRcv->ppRtps[idx] = pRcv->ppRtps[--pRcv->numRtps];
+      found = 1;
+      break;
+    }
+  }
+
+  //
+  // Destination slots are normally removed as each destination is closed
+  //
+  for(idx = 0; idx < pRcv->numSlots; idx++) {
+    if(pRcv->pSlots[idx].inuse && pRcv->pSlots[idx].pRtp == pRtp) {
+      rtcp_rcv_removeslot(pRcv, idx, 0);
+    }
+  }
+  pthread_mutex_unlock(&pRcv->mtx);
+
+  //
+  // Wait for the receiver to finish any dispatch which may still reference this output
+  //
+  if(found) {
+    pthread_mutex_lock(&pRcv->mtxDispatch);
+    pthread_mutex_unlock(&pRcv->mtxDispatch);
+  }
+
+  pthread_mutex_lock(&pRtp->mtx);
+  pRtp->doRrListener = -1;
+  pthread_mutex_unlock(&pRtp->mtx);
+
+  LOG(X_DEBUG("RTCP receiver removed output pt:%d"), pRtp->init.pt);
+
+  return 0;
+}
+
+static int stream_rtcp_responder_start(STREAM_RTP_MULTI_T *pRtp, int lock) {
+  RTCP_RCV_T *pRcv = &g_rtcp_rcv;
+  STREAM_RTP_MULTI_T **ppRtps;
+  pthread_t ptdRcv;
+  pthread_attr_t attrRcv;
+  unsigned int idx;
+  const char *s;
+  int rc = 0;
+
+  if(lock) {
+    pthread_mutex_lock(&pRtp->mtx);
+  }
+
+  if(!pRtp->init.sendrtcpsr) {
+    if(lock) {
+      pthread_mutex_unlock(&pRtp->mtx);
+    }
+    return 0;
+  } else if(pRtp->doRrListener > 0) {
+    //
+    // Already registered, new destination sockets are added by stream_rtp_adddest
+    //
+    if(lock) {
+      pthread_mutex_unlock(&pRtp->mtx);
+    }
+    return 0;
+  }
+
+  pthread_mutex_lock(&pRcv->mtx);
+
+  if(pRcv->epollfd < 0 && (pRcv->epollfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+    LOG(X_ERROR("RTCP receiver epoll_create failed "ERRNO_FMT_STR), ERRNO_FMT_ARGS);
+    pthread_mutex_unlock(&pRcv->mtx);
+    if(lock) {
+      pthread_mutex_unlock(&pRtp->mtx);
+    }
+    return -1;
+  }
+
+  if(pRcv->numRtps >= pRcv->maxRtps) {
+    if(!(ppRtps = (STREAM_RTP_MULTI_T **) avc_realloc(pRcv->ppRtps, 
+                                                      (pRcv->maxRtps + 16) * sizeof(STREAM_RTP_MULTI_T *)))) {
+      pthread_mutex_unlock(&pRcv->mtx);
+      if(lock) {
+        pthread_mutex_unlock(&pRtp->mtx);
+      }
+      return -1;
+    }
+    pRcv->ppRtps = ppRtps;
+    pRcv->maxRtps += 16;
+  }
+
+  pRcv->ppRtps[pRcv->numRtps++] = pRtp;
+  pRtp->doRrListener = 1;
+
+  if(!pRcv->running) {
+
+    pRcv->tid_tag[0] = '\0'; 
+    if((s = logutil_tid_lookup(pthread_self(), 0)) && s[0] != '\0') {
+      snprintf(pRcv->tid_tag, sizeof(pRcv->tid_tag), "%s-rtcp", s);
+    }
+    PHTREAD_INIT_ATTR(&attrRcv);
+    pRcv->running = 1;
+
+    if(pthread_create(&ptdRcv, &attrRcv, (void *) rtcp_rcv_proc, NULL) != 0) {
+      LOG(X_ERROR("Unable to create RTCP receiver thread"));
+      pRcv->numRtps--;
+      pRtp->doRrListener = 0;
+      if(pRcv->numRtps == 0) {
+        rtcp_rcv_close(pRcv);
+      }
+      pRcv->running = 0;
+      rc = -1;
+    }
+
+    pthread_attr_destroy(&attrRcv);
+  }
+
+  if(rc == 0) {
+    LOG(X_DEBUG("RTCP receiver added output pt:%d, outputs:%d"), pRtp->init.pt, pRcv->numRtps);
+  }
+
+  pthread_mutex_unlock(&pRcv->mtx);
+
+  if(rc == 0) {
+    for(idx = 0; idx < pRtp->maxDests; idx++) {
+      if(pRtp->pdests[idx].isactive) {
+        rtcp_rcv_adddest(pRtp, idx);
+      }
+    }
+  }
+
+  if(lock) {
+    pthread_mutex_unlock(&pRtp->mtx);
+  }
+
+  return rc;
+}
+
+#else // STREAM_RTCP_SHARED_RECEIVER
+
 typedef struct RR_LISTENER_WRAP {
   STREAM_RTP_MULTI_T *pRtp;
   char                tid_tag[LOGUTIL_TAG_LENGTH];
 } RR_LISTENER_WRAP_T;
 
-void stream_rtcp_responder_listener_proc(void *pArg) {
+static void stream_rtcp_responder_listener_proc(void *pArg) {
   RR_LISTENER_WRAP_T rrListenerWrap;
   STREAM_RTP_MULTI_T *pRtp;
-  STREAM_RTP_DEST_T *pdest;
   int numDests;
   fd_set fdsetRd;
   int fdHighest = 0;
@@ -1973,11 +2747,7 @@ void stream_rtcp_responder_listener_proc(void *pArg) {
   struct sockaddr_storage saSrc, saDst, saDstRtp;
   int len;
   int rc = 0;
-  unsigned char *pData;
   int pktlen;
-  int is_turn_channeldata;
-  int is_turn;
-  int is_turn_indication;
   char tmp[128];
   unsigned char buf[4096];
 #if defined(WIN32) 
@@ -2114,35 +2884,15 @@ void stream_rtcp_responder_listener_proc(void *pArg) {
           ) {
 
           //LOG(X_DEBUG("tid:0x%x, CALLING RECVFROM RTP SOCK [idx:%d]"), pthread_self(), idx);
-          pData = buf;
-          is_turn = 0;
-          is_turn_indication = 0;
-          is_turn_channeldata = 0;
           len = sizeof(saSrc);
           if((pktlen = recvfrom(PNETIOSOCK_FD(&pRtp->pdests[idx].xmit.netsock),
-                          (void *) pData, sizeof(buf), 0,
+                          (void *) buf, sizeof(buf), 0,
                           (struct sockaddr *) &saSrc,
                           (socklen_t *) &len)) > 0) {
 
             //LOG(X_DEBUG("tid:0x%x, RECVFROM RTP [idx:%d] pnetsock: 0x%x, GOT %d 0x%x, is_dtls:%d, is_turn:%d"), pthread_self(), idx, &pRtp->pdests[idx].xmit.netsock, pktlen, buf[0], DTLS_ISPACKET(buf, pktlen), stun_ispacket(buf, pktlen));
-            //
-            // Receive any TURN data
-            //
-            if(pRtp->pdests[idx].xmit.netsock.turn.use_turn_indication_in &&
-                (stun_ispacket(buf, pktlen) || (is_turn_channeldata = turn_ischanneldata(buf, pktlen)))) {
-
-              if((rc = turn_onrcv_pkt(&pRtp->pdests[idx].turns[0], &pRtp->pdests[idx].stun, is_turn_channeldata, 
-                                      &is_turn, &is_turn_indication, &pData, &pktlen, 
-                                      (const struct sockaddr *) &saSrc, (const struct sockaddr *) &saDstRtp, 
-                                      &pRtp->pdests[idx].xmit.netsock)) < 0) {
-              }
-            }
-
-            if((!is_turn || is_turn_indication || is_turn_channeldata) && DTLS_ISPACKET(buf, pktlen) && 
-              (pktlen = dtls_netsock_ondata(&pRtp->pdests[idx].xmit.netsock, buf, pktlen, 
-                                            (const struct sockaddr *) &saSrc)) < 0) {
-
-            }
+            rtcp_responder_onrtp(&pRtp->pdests[idx], buf, pktlen, (const struct sockaddr *) &saSrc, 
+                                 (const struct sockaddr *) &saDstRtp);
 
           } else {
 
@@ -2174,72 +2924,16 @@ void stream_rtcp_responder_listener_proc(void *pArg) {
         }
 
         //LOG(X_DEBUG("tid:0x%x, CALLING RECVFROM RTCP SOCK [idx:%d]"), pthread_self(), idx);
-        pData = buf;
-        is_turn = 0;
-        is_turn_indication = 0;
-        is_turn_channeldata = 0;
         len = sizeof(saSrc);
         if((pktlen = recvfrom(STREAM_RTCP_FD(pRtp->pdests[idx]),
-                          (void *) pData, sizeof(buf), 0,
+                          (void *) buf, sizeof(buf), 0,
                           (struct sockaddr *) &saSrc,
                           (socklen_t *) &len)) > 0) {
 
           len = sizeof(saDst); 
           getsockname(STREAM_RTCP_FD(pRtp->pdests[idx]), (struct sockaddr *) &saDst,  (socklen_t *) &len);
-          //LOG(X_DEBUGV("recv[rtcp rr:%u] %s:%d -> :%d pktlen:%d, ssrc: 0x%x, pt:%d"), idx, inet_ntoa(saSrc.sin_addr), ntohs(saSrc.sin_port), ntohs(saDst.sin_port), pktlen, htonl(*(uint32_t *) (&buf[8])), buf[1]);
-          //LOG(X_DEBUG("tid:0x%x, RECVFROM RTCP [idx:%d] pnetsock: 0x%x, GOT %d 0x%x, is_dtls:%d, is_turn:%d"), pthread_self(), idx, STREAM_RTCP_PNETIOSOCK(pRtp->pdests[idx]), pktlen, buf[0], DTLS_ISPACKET(buf, pktlen), stun_ispacket(buf, pktlen));
-
-          //
-          // Receive any TURN data on the RTCP socket
-          //
-          if(pRtp->pdests[idx].xmit.netsock.turn.use_turn_indication_in &&
-              (stun_ispacket(buf, pktlen) || (is_turn_channeldata = turn_ischanneldata(buf, pktlen)))) {
-
-            if((rc = turn_onrcv_pkt(INET_PORT(pRtp->pdests[idx].saDstsRtcp) == INET_PORT(pRtp->pdests[idx].saDsts) ?
-                                    &pRtp->pdests[idx].turns[0] : &pRtp->pdests[idx].turns[1], 
-                                    &pRtp->pdests[idx].stun, is_turn_channeldata,
-                                    &is_turn, &is_turn_indication, &pData, &pktlen, 
-                                    (const struct sockaddr *) &saSrc, (const struct sockaddr *) &saDst, 
-                                    STREAM_RTCP_PNETIOSOCK(pRtp->pdests[idx]))) < 0) {
-            }
-          }
-
-          if((!is_turn || is_turn_indication || is_turn_channeldata) &&
-            STREAM_RTCP_PNETIOSOCK(pRtp->pdests[idx])->ssl.pCtxt && DTLS_ISPACKET(buf, pktlen)) {
-            pktlen = dtls_netsock_ondata(STREAM_RTCP_PNETIOSOCK(pRtp->pdests[idx]), buf, pktlen, 
-                                         (const struct sockaddr *) &saSrc);
-            LOG(X_DEBUG("DTLS packet pktlen:%d"), pktlen); 
-            if(pktlen <= 0) {
-              continue;
-            }
-          }
-
-          pdest = NULL;
-          //
-          // If overlappingPorts is set, assume that all RTP (RTCP) listener ports are the same, so each
-          // incoming RTCP message may not come in on the right socket
-          //
-          if(!pRtp->overlappingPorts) {
-            pdest = &pRtp->pdests[idx];
-          } else if(len >= RTCP_HDR_LEN + 4 && 
-            !(pdest = find_rtcp_dest(pRtp, (RTCP_PKT_HDR_T *) buf, len, INET_PORT(saSrc)))) {
-            LOG(X_ERROR("recv[rtcp rr:%u] RTCP ssrc: 0x%x unable to find RTP stream %s:%d -> :%d"), idx,
-                htonl(*((uint32_t *) &(((uint8_t *) buf)[8]))), FORMAT_NETADDR(saSrc, tmp, sizeof(tmp)), 
-                ntohs(INET_PORT(saSrc)), ntohs(INET_PORT(saDst)));
-          }
-
-          if(pdest) {
-            if(pdest->pRtpMulti != pRtp) {
-              pthread_mutex_lock(&((STREAM_RTP_MULTI_T *) pdest->pRtpMulti)->mtx);
-            }
-
-            stream_rtp_handlertcp(pdest, (RTCP_PKT_HDR_T *) buf, pktlen, (const struct sockaddr *) &saSrc, 
-                                  (const struct sockaddr *) &saDst);
-
-            if(pdest->pRtpMulti != pRtp) {
-              pthread_mutex_unlock(&((STREAM_RTP_MULTI_T *) pdest->pRtpMulti)->mtx);
-            }
-          }
+          rtcp_responder_onrtcp(pRtp, idx, buf, pktlen, (const struct sockaddr *) &saSrc, 
+                                (const struct sockaddr *) &saDst);
 
         } else {
 
@@ -2309,6 +3003,14 @@ static int stream_rtcp_responder_stop(STREAM_RTP_MULTI_T *pRtp) {
   return rc;
 }
 
+static void rtcp_rcv_adddest(STREAM_RTP_MULTI_T *pRtp, unsigned int idxDest) {
+
+}
+
+static void rtcp_rcv_removedest(STREAM_RTP_MULTI_T *pRtp, unsigned int idxDest) {
+
+}
+
 static int stream_rtcp_responder_start(STREAM_RTP_MULTI_T *pRtp, int lock) {
   int rc = 0;
   const char *s;
@@ -2364,4 +3066,6 @@ static int stream_rtcp_responder_start(STREAM_RTP_MULTI_T *pRtp, int lock) {
   return rc;
 }
 
+#endif // STREAM_RTCP_SHARED_RECEIVER
+
 #endif // VSX_HAVE_STREAMER
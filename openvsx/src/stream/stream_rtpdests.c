@@ -0,0 +1,373 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#include "vsx_common.h"
+
+#if defined(VSX_HAVE_STREAMER)
+
+#define RTPDESTS_HASH(addrKey, port, size) ((((addrKey) * 2654435761u) ^ ((port) * 31) ^ ((port) >> 8)) & ((size) - 1))
+
+static uint32_t rtpdests_addrkey(const struct sockaddr *psa) {
+  const uint32_t *p;
+
+  if(psa->sa_family == AF_INET6) {
+    p = (const uint32_t *) &((const struct sockaddr_in6 *) psa)->sin6_addr;
+    return p[0] ^ p[1] ^ p[2] ^ p[3];
+  }
+
+  return ((const struct sockaddr_in *) psa)->sin_addr.s_addr;
+}
+
+int stream_rtpdests_init(STREAM_RTP_DESTS_T *pTable, unsigned int maxDests) {
+  unsigned int idx;
+
+  if(!pTable || maxDests == 0) {
+    return -1;
+  }
+
+  if(pTable->active) {
+    stream_rtpdests_close(pTable);
+  }
+
+  memset(pTable, 0, sizeof(STREAM_RTP_DESTS_T));
+  pTable->maxDests = maxDests;
+
+  for(pTable->hashSize = 16; pTable->hashSize < maxDests; pTable->hashSize <<= 1);
+
+  if(!(pTable->pNodes = (STREAM_RTP_DESTS_NODE_T *) avc_calloc(maxDests, sizeof(STREAM_RTP_DESTS_NODE_T))) ||
+     !(pTable->pFreeIdxs = (unsigned int *) avc_calloc(maxDests, sizeof(unsigned int))) ||
+     !(pTable->pActiveIdxs = (unsigned int *) avc_calloc(maxDests, sizeof(unsigned int))) ||
+     !(pTable->pHashBuckets = (int *) avc_calloc(pTable->hashSize, sizeof(int))) ||
+     !(pTable->pPublished = (STREAM_RTP_DESTS_ACTIVE_T *) avc_calloc(1, sizeof(STREAM_RTP_DESTS_ACTIVE_T)))) {
+    pTable->active = 1;
+    stream_rtpdests_close(pTable);
+    return -1;
+  }
+
+  //
+  // Hand out the lowest slot indexes first
+  //
+  for(idx = 0; idx < maxDests; idx++) {
+    pTable->pFreeIdxs[idx] = maxDests - idx - 1;
+    pTable->pNodes[idx].next = -1;
+    pTable->pNodes[idx].posActive = -1;
+  }
+  pTable->numFree = maxDests;
+
+  for(idx = 0; idx < pTable->hashSize; idx++) {
+    pTable->pHashBuckets[idx] = -1;
+  }
+
+  pthread_mutex_init(&pTable->mtxRetired, NULL);
+  pTable->active = 1;
+
+  return 0;
+}
+
+void stream_rtpdests_close(STREAM_RTP_DESTS_T *pTable) {
+  STREAM_RTP_DESTS_ACTIVE_T *pActive;
+
+  if(!pTable || !pTable->active) {
+    return;
+  }
+
+  stream_rtpdests_reclaim(pTable);
+
+  if((pActive = pTable->pPublished)) {
+    pTable->pPublished = NULL;
+    avc_free((void **) &pActive);
+  }
+  if(pTable->pNodes) {
+    avc_free((void **) &pTable->pNodes);
+  }
+  if(pTable->pFreeIdxs) {
+    avc_free((void **) &pTable->pFreeIdxs);
+  }
+  if(pTable->pActiveIdxs) {
+    avc_free((void **) &pTable->pActiveIdxs);
+  }
+  if(pTable->pHashBuckets) {
+    avc_free((void **) &pTable->pHashBuckets);
+  }
+
+  pthread_mutex_destroy(&pTable->mtxRetired);
+  pTable->active = 0;
+}
+
+int stream_rtpdests_alloc(STREAM_RTP_DESTS_T *pTable) {
+  int idxDest;
+
+  if(!pTable || !pTable->active || pTable->numFree == 0) {
+    return -1;
+  }
+
+  idxDest = (int) pTable->pFreeIdxs[--pTable->numFree];
+  pTable->pNodes[idxDest].inuse = 1;
+
+  return idxDest;
+}
+
+int stream_rtpdests_release(STREAM_RTP_DESTS_T *pTable, unsigned int idxDest) {
+
+  if(!pTable || !pTable->active || idxDest >= pTable->maxDests || !pTable->pNodes[idxDest].inuse) {
+    return -1;
+  }
+
+  stream_rtpdests_deactivate(pTable, idxDest);
+
+  pTable->pNodes[idxDest].inuse = 0;
+  pTable->pFreeIdxs[pTable->numFree++] = idxDest;
+
+  return 0;
+}
+
+static void rtpdests_hash_remove(STREAM_RTP_DESTS_T *pTable, unsigned int idxDest) {
+  STREAM_RTP_DESTS_NODE_T *pNode = &pTable->pNodes[idxDest];
+  int *pidx;
+
+  if(!pNode->inhash) {
+    return;
+  }
+
+  pidx = &pTable->pHashBuckets[RTPDESTS_HASH(pNode->addrKey, pNode->port, pTable->hashSize)];
+  while(*pidx != -1) {
+    if(*pidx == (int) idxDest) {
+      *pidx = pNode->next;
+      break;
+    }
+    pidx = &pTable->pNodes[*pidx].next;
+  }
+
+  pNode->next = -1;
+  pNode->inhash = 0;
+}
+
+static void rtpdests_hash_add(STREAM_RTP_DESTS_T *pTable, unsigned int idxDest, const struct sockaddr *psaRtcp) {
+  STREAM_RTP_DESTS_NODE_T *pNode = &pTable->pNodes[idxDest];
+  int *pidx;
+
+  pNode->addrKey = rtpdests_addrkey(psaRtcp);
+  pNode->port = PINET_PORT(psaRtcp);
+  pidx = &pTable->pHashBuckets[RTPDESTS_HASH(pNode->addrKey, pNode->port, pTable->hashSize)];
+  pNode->next = *pidx;
+  *pidx = idxDest;
+  pNode->inhash = 1;
+}
+
+static int rtpdests_publish(STREAM_RTP_DESTS_T *pTable) {
+  STREAM_RTP_DESTS_ACTIVE_T *pActive;
+  STREAM_RTP_DESTS_ACTIVE_T *pActiveOld;
+
+  if(!(pActive = (STREAM_RTP_DESTS_ACTIVE_T *) avc_calloc(1, sizeof(STREAM_RTP_DESTS_ACTIVE_T) + 
+                                                         pTable->numActive * sizeof(unsigned int)))) {
+    return -1;
+  }
+
+  pActive->numDests = pTable->numActive;
+  memcpy(pActive->idxDests, pTable->pActiveIdxs, pTable->numActive * sizeof(unsigned int));
+
+  //
+  // Make the snapshot contents visible before the pointer itself
+  //
+  STREAM_RTP_DESTS_BARRIER();
+  pActiveOld = pTable->pPublished;
+  pTable->pPublished = pActive;
+
+  if(pActiveOld) {
+    pthread_mutex_lock(&pTable->mtxRetired);
+    pActiveOld->pnext = pTable->pRetired;
+    pTable->pRetired = pActiveOld;
+    pthread_mutex_unlock(&pTable->mtxRetired);
+  }
+
+  return 0;
+}
+
+int stream_rtpdests_activate(STREAM_RTP_DESTS_T *pTable, unsigned int idxDest, const struct sockaddr *psaRtcp) {
+  STREAM_RTP_DESTS_NODE_T *pNode;
+
+  if(!pTable || !pTable->active || idxDest >= pTable->maxDests || !psaRtcp) {
+    return -1;
+  }
+
+  pNode = &pTable->pNodes[idxDest];
+
+  if(pNode->posActive < 0) {
+    pNode->posActive = pTable->numActive;
+    pTable->pActiveIdxs[pTable->numActive++] = idxDest;
+  }
+
+  rtpdests_hash_remove(pTable, idxDest);
+  rtpdests_hash_add(pTable, idxDest, psaRtcp);
+
+  return rtpdests_publish(pTable);
+}
+
+int stream_rtpdests_deactivate(STREAM_RTP_DESTS_T *pTable, unsigned int idxDest) {
+  STREAM_RTP_DESTS_NODE_T *pNode;
+  unsigned int idxLast;
+
+  if(!pTable || !pTable->active || idxDest >= pTable->maxDests) {
+    return -1;
+  }
+
+  pNode = &pTable->pNodes[idxDest];
+
+  rtpdests_hash_remove(pTable, idxDest);
+
+  if(pNode->posActive < 0) {
+    return 0;
+  }
+
+  //
+  // Move the last active entry into the vacated position
+  //
+  idxLast = pTable->pActiveIdxs[--pTable->numActive];
+  pTable->pActiveIdxs[pNode->posActive] = idxLast;
+  pTable->pNodes[idxLast].posActive = pNode->posActive;
+  pNode->posActive = -1;
+
+  return rtpdests_publish(pTable);
+}
+
+int stream_rtpdests_rehash(STREAM_RTP_DESTS_T *pTable, unsigned int idxDest, const struct sockaddr *psaRtcp) {
+
+  if(!pTable || !pTable->active || idxDest >= pTable->maxDests || pTable->pNodes[idxDest].posActive < 0 ||
+     !psaRtcp) {
+    return -1;
+  }
+
+  rtpdests_hash_remove(pTable, idxDest);
+  rtpdests_hash_add(pTable, idxDest, psaRtcp);
+
+  return 0;
+}
+
+//
+// Returns the first destination whose hashed RTCP address key and port match.  Since the address
+// key is a digest, the caller compares the full address.
+//
+int stream_rtpdests_lookup_first(const STREAM_RTP_DESTS_T *pTable, const struct sockaddr *psaRtcp) {
+  int idxDest;
+  uint32_t addrKey;
+  uint16_t port;
+
+  if(!pTable || !pTable->active || !psaRtcp) {
+    return -1;
+  }
+
+  addrKey = rtpdests_addrkey(psaRtcp);
+  port = PINET_PORT(psaRtcp);
+  idxDest = pTable->pHashBuckets[RTPDESTS_HASH(addrKey, port, pTable->hashSize)];
+  while(idxDest != -1 && (pTable->pNodes[idxDest].port != port || pTable->pNodes[idxDest].addrKey != addrKey)) {
+    idxDest = pTable->pNodes[idxDest].next;
+  }
+
+  return idxDest;
+}
+
+int stream_rtpdests_lookup_next(const STREAM_RTP_DESTS_T *pTable, int idxDest) {
+  uint32_t addrKey;
+  uint16_t port;
+
+  if(!pTable || !pTable->active || idxDest < 0 || idxDest >= (int) pTable->maxDests) {
+    return -1;
+  }
+
+  addrKey = pTable->pNodes[idxDest].addrKey;
+  port = pTable->pNodes[idxDest].port;
+  idxDest = pTable->pNodes[idxDest].next;
+  while(idxDest != -1 && (pTable->pNodes[idxDest].port != port || pTable->pNodes[idxDest].addrKey != addrKey)) {
+    idxDest = pTable->pNodes[idxDest].next;
+  }
+
+  return idxDest;
+}
+
+const STREAM_RTP_DESTS_ACTIVE_T *stream_rtpdests_read_lock(STREAM_RTP_DESTS_T *pTable, unsigned int *pEpoch) {
+  unsigned int epoch;
+
+  if(!pTable->active) {
+    return NULL;
+  }
+
+  epoch = pTable->epoch;
+  STREAM_RTP_DESTS_ATOMIC_INC(&pTable->readers[epoch & 1]);
+  *pEpoch = epoch;
+
+  return pTable->pPublished;
+}
+
+void stream_rtpdests_read_unlock(STREAM_RTP_DESTS_T *pTable, unsigned int epoch) {
+  STREAM_RTP_DESTS_ATOMIC_DEC(&pTable->readers[epoch & 1]);
+}
+
+//
+// Waits until every reader which may have obtained a snapshot published prior to this call
+// has exited.  The epoch is advanced first so that new readers count against the other parity,
+// allowing the parity being waited on to drain.
+//
+static void rtpdests_synchronize(STREAM_RTP_DESTS_T *pTable) {
+  unsigned int epoch;
+
+  epoch = STREAM_RTP_DESTS_ATOMIC_INC(&pTable->epoch) - 1;
+  while(pTable->readers[epoch & 1] > 0) {
+    usleep(100);
+  }
+
+  STREAM_RTP_DESTS_ATOMIC_INC(&pTable->epoch);
+  while(pTable->readers[(epoch & 1) ^ 1] > 0) {
+    usleep(100);
+  }
+
+}
+
+void stream_rtpdests_reclaim(STREAM_RTP_DESTS_T *pTable) {
+  STREAM_RTP_DESTS_ACTIVE_T *pRetired;
+  STREAM_RTP_DESTS_ACTIVE_T *pNext;
+
+  if(!pTable || !pTable->active) {
+    return;
+  }
+
+  pthread_mutex_lock(&pTable->mtxRetired);
+  pRetired = pTable->pRetired;
+  pTable->pRetired = NULL;
+  pthread_mutex_unlock(&pTable->mtxRetired);
+
+  if(!pRetired) {
+    return;
+  }
+
+  rtpdests_synchronize(pTable);
+
+  while(pRetired) {
+    pNext = pRetired->pnext;
+    avc_free((void **) &pRetired);
+    pRetired = pNext;
+  }
+
+}
+
+#endif // VSX_HAVE_STREAMER
@@ -275,8 +275,49 @@ typedef struct SRTP_CTXT_INT {
   srtp_policy_t             policy;
   uint32_t                  ssrc;
   pthread_mutex_t           mtx;
+
+  //
+  // Mirror of the libsrtp outbound RTP packet index (ROC << 16 | seq) used to determine if 
+  // output contexts sharing the same key would produce identical ciphertext
+  //
+  uint64_t                  rtpIndex;            // highest index estimated for this context
+  uint64_t                  rtpIndexProtected;   // highest index actually protected by libsrtp
 } SRTP_CTXT_INT_T;
 
+#define SRTP_RTP_SEQ_MEDIAN         0x8000
+
+//
+// Maximum distance between the last index protected by libsrtp and a shared packet index. 
+// Keeping this well below SRTP_RTP_SEQ_MEDIAN ensures libsrtp's own index estimate 
+// remains identical to the mirrored index once the context resumes protecting packets.
+//
+#define SRTP_RTP_SHARE_INDEX_MAX    0x4000
+
+//
+// Same estimation as libsrtp rdbx_estimate_index / index_guess
+//
+static uint64_t rtp_index_guess(uint64_t index, uint16_t seq) {
+  uint32_t roc;
+  uint16_t seqLocal;
+
+  if(index <= SRTP_RTP_SEQ_MEDIAN) {
+    return seq;
+  }
+
+  roc = (uint32_t) (index >> 16);
+  seqLocal = (uint16_t) (index & 0xffff);
+
+  if(seqLocal < SRTP_RTP_SEQ_MEDIAN) {
+    if((int) seq - (int) seqLocal > SRTP_RTP_SEQ_MEDIAN) {
+      roc--;
+    }
+  } else if((int) seqLocal - SRTP_RTP_SEQ_MEDIAN > (int) seq) {
+    roc++;
+  }
+
+  return (((uint64_t) roc) << 16) | seq;
+}
+
 
 static int srtp_initialize() {
   int rc = 0;
@@ -716,6 +757,11 @@ int srtp_encryptPacket(const SRTP_CTXT_T *pCtxt, const unsigned char *pIn, unsig
       return -1;
     }
 
+    pSrtp->rtpIndexProtected = rtp_index_guess(pSrtp->rtpIndex, htons(((const struct rtphdr *) pIn)->sequence_num));
+    if(pSrtp->rtpIndexProtected > pSrtp->rtpIndex) {
+      pSrtp->rtpIndex = pSrtp->rtpIndexProtected;
+    }
+
     pthread_mutex_unlock(&pSrtp->mtx);
 
   }
@@ -729,6 +775,56 @@ int srtp_encryptPacket(const SRTP_CTXT_T *pCtxt, const unsigned char *pIn, unsig
   return rc;
 }
 
+int srtp_canShareEncryptedPacket(const SRTP_CTXT_T *pCtxt, const SRTP_CTXT_T *pCtxtSrc, uint16_t seq) {
+  const SRTP_CTXT_INT_T *pSrtp;
+  const SRTP_CTXT_INT_T *pSrtpSrc;
+  uint64_t index;
+
+  if(!pCtxt || !pCtxtSrc || !(pSrtp = (const SRTP_CTXT_INT_T *) pCtxt->privData) || 
+     !(pSrtpSrc = (const SRTP_CTXT_INT_T *) pCtxtSrc->privData)) {
+    return 0;
+  } else if(pCtxt == pCtxtSrc) {
+    return 1;
+  }
+
+  if(pCtxt->kt.k.lenKey <= 0 || pCtxt->kt.k.lenKey != pCtxtSrc->kt.k.lenKey ||
+     memcmp(pCtxt->kt.k.key, pCtxtSrc->kt.k.key, pCtxt->kt.k.lenKey) ||
+     pCtxt->kt.type.authType != pCtxtSrc->kt.type.authType ||
+     pCtxt->kt.type.confType != pCtxtSrc->kt.type.confType ||
+     pSrtp->ssrc != pSrtpSrc->ssrc) {
+    return 0;
+  }
+
+  //
+  // The rollover counter of each context has to agree for this sequence number
+  //
+  if((index = rtp_index_guess(pSrtp->rtpIndex, seq)) != rtp_index_guess(pSrtpSrc->rtpIndex, seq) ||
+     index <= pSrtp->rtpIndexProtected || index - pSrtp->rtpIndexProtected >= SRTP_RTP_SHARE_INDEX_MAX) {
+    return 0;
+  }
+
+  return 1;
+}
+
+int srtp_skipEncryptPacket(const SRTP_CTXT_T *pCtxt, uint16_t seq) {
+  SRTP_CTXT_INT_T *pSrtp;
+  uint64_t index;
+
+  if(!pCtxt || !(pSrtp = (SRTP_CTXT_INT_T *) pCtxt->privData)) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&pSrtp->mtx);
+
+  if((index = rtp_index_guess(pSrtp->rtpIndex, seq)) > pSrtp->rtpIndex) {
+    pSrtp->rtpIndex = index;
+  }
+
+  pthread_mutex_unlock(&pSrtp->mtx);
+
+  return 0;
+}
+
 int srtp_initOutputStream(SRTP_CTXT_T *pCtxt, uint32_t ssrc, int rtcp) {
   int rc = 0;
 
@@ -881,6 +977,12 @@ int srtp_encryptPacket(const SRTP_CTXT_T *pCtxt, const unsigned char *pIn, unsig
                        unsigned char *pOut, unsigned int *pLenOut, int rtcp) {
   return -1;
 }
+int srtp_canShareEncryptedPacket(const SRTP_CTXT_T *pCtxt, const SRTP_CTXT_T *pCtxtSrc, uint16_t seq) {
+  return 0;
+}
+int srtp_skipEncryptPacket(const SRTP_CTXT_T *pCtxt, uint16_t seq) {
+  return -1;
+}
 int srtp_initOutputStream(SRTP_CTXT_T *pCtxt, uint32_t ssrc, int rtcp) {
   return -1;
 }
@@ -401,6 +401,10 @@ int streamxmit_sendpkt(STREAM_XMIT_NODE_T *pStream) {
   int szPkt;
   TIME_VAL tvNow;
   unsigned int idxDest;
+  unsigned int idxIter;
+  unsigned int numIter;
+  unsigned int epochDests = 0;
+  const STREAM_RTP_DESTS_ACTIVE_T *pActiveDests;
   unsigned int szData;
   const unsigned char *pData;
   unsigned int szDataPayload;
@@ -431,7 +435,22 @@ int streamxmit_sendpkt(STREAM_XMIT_NODE_T *pStream) {
     if(pStream->pXmitAction->do_output && pStream->pRtpMulti->numDests > 0) {
 
       szPkt = 0;
-      for(idxDest = 0; idxDest < pStream->pRtpMulti->maxDests; idxDest++) {
+
+      //
+      // Only iterate the published snapshot of active destinations
+      //
+      if((pActiveDests = stream_rtpdests_read_lock(&pStream->pRtpMulti->destTable, &epochDests))) {
+        numIter = pActiveDests->numDests;
+        if(!pStream->rawSend && pStream->pXmitAction->do_output_rtphdr) {
+          streamxmit_srtp_prepare(pStream->pRtpMulti, pActiveDests, pStream->pXmitDestRc, pData, szData);
+        }
+      } else {
+        numIter = pStream->pRtpMulti->maxDests;
+      }
+
+      for(idxIter = 0; idxIter < numIter; idxIter++) {
+
+        idxDest = pActiveDests ? pActiveDests->idxDests[idxIter] : idxIter;
 
         if(!pStream->pRtpMulti->pdests[idxDest].isactive || pStream->pXmitDestRc[idxDest] != 0) {
          continue;
@@ -468,6 +487,11 @@ int streamxmit_sendpkt(STREAM_XMIT_NODE_T *pStream) {
         }
       } // end of for
 
+      if(pActiveDests) {
+        streamxmit_srtp_done(pStream->pRtpMulti);
+        stream_rtpdests_read_unlock(&pStream->pRtpMulti->destTable, epochDests);
+      }
+
       // Exit if there are no good transmitters in the list
       if(pStream->pRtpMulti->numDests > 0 && pStream->pXmitAction->do_output && szPkt == 0) {
         return -1;
@@ -0,0 +1,499 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#include "vsx_common.h"
+
+#if defined(VSX_HAVE_STREAMER)
+
+#define STREAMXMIT_SRTP_BUF_SZ    PACKETGEN_PKT_UDP_DATA_SZ
+#define STREAMXMIT_SRTP_PBUF(pX, idx)  (&(pX)->pBufs[(idx) * STREAMXMIT_SRTP_BUF_SZ])
+
+typedef struct STREAMXMIT_SRTP_BATCH {
+  STREAM_RTP_MULTI_T           *pRtp;
+  unsigned int                  next;
+  unsigned int                  num;
+  unsigned int                  remaining;
+} STREAMXMIT_SRTP_BATCH_T;
+
+typedef struct STREAMXMIT_SRTP_POOL {
+  pthread_mutex_t               mtx;
+  pthread_mutex_t               mtxBatch;    // serializes batch submission
+  int                           condInit;
+  pthread_cond_t                cond;        // signals workers of a new batch or shutdown
+  pthread_cond_t                condDone;    // signals batch completion or worker exit
+  STREAMXMIT_SRTP_BATCH_T      *pBatch;
+  unsigned int                  numThreads;
+  unsigned int                  refCnt;
+  int                           shutdown;
+  char                          tid_tag[LOGUTIL_TAG_LENGTH];
+} STREAMXMIT_SRTP_POOL_T;
+
+static STREAMXMIT_SRTP_POOL_T g_srtp_pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, 0 };
+
+static void srtp_protect_dest(STREAM_RTP_MULTI_T *pRtp, unsigned int idxBuf) {
+  STREAMXMIT_SRTP_T *pX = &pRtp->xmitSrtp;
+  unsigned int idxDest = pX->pIdxSrcs[idxBuf];
+  STREAM_RTP_DEST_T *pDest = &pRtp->pdests[idxDest];
+
+  pX->pResults[idxDest].rc = srtp_dtls_protect(STREAM_RTP_PNETIOSOCK(*pDest), pX->pData, pX->len, 
+                                               STREAMXMIT_SRTP_PBUF(pX, idxBuf), STREAMXMIT_SRTP_BUF_SZ,
+                                               (const struct sockaddr *) &pDest->saDsts,
+                                               pDest->srtps[0].pSrtpShared, SENDTO_PKT_TYPE_RTP);
+}
+
+static void srtp_pool_proc(void *pArg) {
+  STREAMXMIT_SRTP_POOL_T *pPool = &g_srtp_pool;
+  STREAMXMIT_SRTP_BATCH_T *pBatch;
+  char tid_tag[LOGUTIL_TAG_LENGTH];
+  unsigned int idx;
+
+  pthread_mutex_lock(&pPool->mtx);
+  memcpy(tid_tag, pPool->tid_tag, sizeof(tid_tag));
+  pthread_mutex_unlock(&pPool->mtx);
+  logutil_tid_add(pthread_self(), tid_tag);
+
+  pthread_mutex_lock(&pPool->mtx);
+
+  while(!pPool->shutdown && !g_proc_exit) {
+
+    if(!(pBatch = pPool->pBatch) || pBatch->next >= pBatch->num) {
+      pthread_cond_wait(&pPool->cond, &pPool->mtx);
+      continue;
+    }
+
+    idx = pBatch->next++;
+    pthread_mutex_unlock(&pPool->mtx);
+
+    srtp_protect_dest(pBatch->pRtp, idx);
+
+    pthread_mutex_lock(&pPool->mtx);
+    if(--pBatch->remaining == 0) {
+      pthread_cond_broadcast(&pPool->condDone);
+    }
+  }
+
+  pPool->numThreads--;
+  pthread_cond_broadcast(&pPool->condDone);
+  pthread_mutex_unlock(&pPool->mtx);
+
+  logutil_tid_remove(pthread_self());
+}
+
+static int srtp_pool_start(unsigned int numThreads) {
+  STREAMXMIT_SRTP_POOL_T *pPool = &g_srtp_pool;
+  pthread_t ptd;
+  pthread_attr_t attr;
+  const char *s;
+  int rc = 0;
+
+  pthread_mutex_lock(&pPool->mtx);
+
+  if(!pPool->condInit) {
+    pthread_cond_init(&pPool->cond, NULL);
+    pthread_cond_init(&pPool->condDone, NULL);
+    pPool->condInit = 1;
+  }
+
+  while(pPool->shutdown) {
+    pthread_cond_wait(&pPool->condDone, &pPool->mtx);
+  }
+
+  pPool->refCnt++;
+
+  if(pPool->numThreads > 0) {
+    pthread_mutex_unlock(&pPool->mtx);
+    return 0;
+  }
+
+  if((s = logutil_tid_lookup(pthread_self(), 0)) && s[0] != '\0') {
+    snprintf(pPool->tid_tag, sizeof(pPool->tid_tag), "%s-srtp", s);
+  } else {
+    snprintf(pPool->tid_tag, sizeof(pPool->tid_tag), "srtp");
+  }
+
+  while(pPool->numThreads < MIN(numThreads, STREAMXMIT_SRTP_THREADS_MAX)) {
+
+    PHTREAD_INIT_ATTR(&attr);
+
+    if(pthread_create(&ptd, &attr, (void *) srtp_pool_proc, NULL) != 0) {
+      LOG(X_ERROR("Unable to create SRTP output thread"));
+      pthread_attr_destroy(&attr);
+      break;
+    }
+
+    pthread_attr_destroy(&attr);
+    pPool->numThreads++;
+  }
+
+  if(pPool->numThreads == 0) {
+    pPool->refCnt--;
+    rc = -1;
+  } else {
+    LOG(X_DEBUG("Started %d SRTP output protection thread(s)"), pPool->numThreads);
+  }
+
+  pthread_mutex_unlock(&pPool->mtx);
+
+  return rc;
+}
+
+static void srtp_pool_release(void) {
+  STREAMXMIT_SRTP_POOL_T *pPool = &g_srtp_pool;
+
+  pthread_mutex_lock(&pPool->mtx);
+
+  if(pPool->refCnt > 0 && --pPool->refCnt == 0) {
+    pPool->shutdown = 1;
+    pthread_cond_broadcast(&pPool->cond);
+    while(pPool->numThreads > 0) {
+      pthread_cond_wait(&pPool->condDone, &pPool->mtx);
+    }
+    pPool->shutdown = 0;
+    pthread_cond_broadcast(&pPool->condDone);
+  }
+
+  pthread_mutex_unlock(&pPool->mtx);
+}
+
+static int srtp_pool_run(STREAM_RTP_MULTI_T *pRtp) {
+  STREAMXMIT_SRTP_POOL_T *pPool = &g_srtp_pool;
+  STREAMXMIT_SRTP_BATCH_T batch;
+  unsigned int idx;
+
+  //
+  // If another output is already using the pool then protect the packet on this thread
+  //
+  if(pthread_mutex_trylock(&pPool->mtxBatch) != 0) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&pPool->mtx);
+
+  if(pPool->numThreads == 0) {
+    pthread_mutex_unlock(&pPool->mtx);
+    pthread_mutex_unlock(&pPool->mtxBatch);
+    return -1;
+  }
+
+  batch.pRtp = pRtp;
+  batch.next = 0;
+  batch.num = batch.remaining = pRtp->xmitSrtp.numSrcs;
+  pPool->pBatch = &batch;
+  pthread_cond_broadcast(&pPool->cond);
+
+  //
+  // The calling thread works on the batch as well
+  //
+  while(batch.next < batch.num) {
+    idx = batch.next++;
+    pthread_mutex_unlock(&pPool->mtx);
+
+    srtp_protect_dest(pRtp, idx);
+
+    pthread_mutex_lock(&pPool->mtx);
+    batch.remaining--;
+  }
+
+  while(batch.remaining > 0) {
+    pthread_cond_wait(&pPool->condDone, &pPool->mtx);
+  }
+
+  pPool->pBatch = NULL;
+
+  pthread_mutex_unlock(&pPool->mtx);
+  pthread_mutex_unlock(&pPool->mtxBatch);
+
+  return 0;
+}
+
+static int srtp_xmit_init(STREAM_RTP_MULTI_T *pRtp) {
+  STREAMXMIT_SRTP_T *pX = &pRtp->xmitSrtp;
+
+  pX->active = -1;
+
+  if(!pRtp->pStreamerCfg || pRtp->maxDests <= 1) {
+    return 0;
+  }
+
+  pX->encryptOnce = pRtp->pStreamerCfg->cfgrtp.srtpEncryptOnce;
+
+  if(pRtp->pStreamerCfg->cfgrtp.srtpXmitThreads > 0 && 
+     srtp_pool_start(pRtp->pStreamerCfg->cfgrtp.srtpXmitThreads) == 0) {
+    pX->usePool = 1;
+  }
+
+  if(!pX->encryptOnce && !pX->usePool) {
+    return 0;
+  }
+
+  pX->maxDests = pRtp->maxDests;
+  pX->pktId = 0;
+  pX->active = 1;
+
+  return 0;
+}
+
+static int srtp_xmit_alloc(STREAMXMIT_SRTP_T *pX) {
+
+  if(!(pX->pResults = (STREAMXMIT_SRTP_RESULT_T *) avc_calloc(pX->maxDests, 
+                                                              sizeof(STREAMXMIT_SRTP_RESULT_T))) ||
+     !(pX->pIdxSrcs = (unsigned int *) avc_calloc(pX->maxDests, sizeof(unsigned int)))) {
+    return -1;
+  }
+
+  return 0;
+}
+
+//
+// Grows the protected output buffers to hold numBufs packets.  The buffers are only sized to the 
+// peak number of destinations requiring their own protection, not to maxDests.
+//
+static int srtp_xmit_allocbufs(STREAMXMIT_SRTP_T *pX, unsigned int numBufs) {
+  unsigned char *pBufs;
+
+  if(numBufs <= pX->numBufs) {
+    return 0;
+  } else if(!(pBufs = (unsigned char *) avc_realloc(pX->pBufs, numBufs * STREAMXMIT_SRTP_BUF_SZ))) {
+    return -1;
+  }
+
+  pX->pBufs = pBufs;
+  pX->numBufs = numBufs;
+
+  return 0;
+}
+
+static int srtp_xmit_iseligible(const STREAM_RTP_DEST_T *pDest) {
+  const NETIO_SOCK_T *pnetsock;
+  const SRTP_CTXT_T *pCtxt;
+
+  if(!pDest->isactive || pDest->noxmit || !(pCtxt = pDest->srtps[0].pSrtpShared) || 
+     pCtxt->kt.k.lenKey <= 0 || !pCtxt->privData) {
+    return 0;
+  }
+
+  //
+  // DTLS-SRTP destinations are only eligible once the handshake has completed
+  //
+  pnetsock = STREAM_RTP_PNETIOSOCK(*pDest);
+  if((pnetsock->flags & NETIO_FLAG_SSL_DTLS) && 
+     (!(pnetsock->flags & NETIO_FLAG_SRTP) || pnetsock->ssl.state != SSL_SOCK_STATE_HANDSHAKE_COMPLETED)) {
+    return 0;
+  }
+
+  return 1;
+}
+
+int streamxmit_srtp_prepare(STREAM_RTP_MULTI_T *pRtp, const STREAM_RTP_DESTS_ACTIVE_T *pActive,
+                            const int *pXmitDestRc, const unsigned char *pData, unsigned int len) {
+  STREAMXMIT_SRTP_T *pX;
+  const STREAM_RTP_DEST_T *pDest;
+  const SRTP_CTXT_T *pCtxt;
+  const SRTP_CTXT_T *pGroupCtxts[STREAMXMIT_SRTP_GROUPS_MAX];
+  unsigned int idxGroups[STREAMXMIT_SRTP_GROUPS_MAX];
+  unsigned int numGroups = 0;
+  unsigned int idxActive;
+  unsigned int idxDest;
+  unsigned int idx;
+  unsigned int numReused = 0;
+  uint16_t seq;
+  int idxSrc;
+  int rc;
+
+  if(!pRtp || !pActive || pActive->numDests <= 1 || !pData || len < RTP_HEADER_LEN || 
+     len > STREAMXMIT_SRTP_BUF_SZ) {
+    return 0;
+  }
+
+  pX = &pRtp->xmitSrtp;
+
+  if(pX->active == 0) {
+    srtp_xmit_init(pRtp);
+  }
+
+  if(pX->active <= 0) {
+    return 0;
+  }
+
+  if(++pX->pktId == 0) {
+    pX->pktId++;
+  }
+  pX->pData = pData;
+  pX->len = len;
+  pX->numSrcs = 0;
+  seq = htons(((const struct rtphdr *) pData)->sequence_num);
+
+  for(idxActive = 0; idxActive < pActive->numDests; idxActive++) {
+
+    idxDest = pActive->idxDests[idxActive];
+    pDest = &pRtp->pdests[idxDest];
+
+    //
+    // Skip destinations the send loop will not send to, so that their packet index is not advanced
+    //
+    if((pXmitDestRc && pXmitDestRc[idxDest] != 0) || !srtp_xmit_iseligible(pDest)) {
+      continue;
+    } else if(!pX->pResults && srtp_xmit_alloc(pX) < 0) {
+      streamxmit_srtp_close(pRtp);
+      pX->active = -1;
+      return -1;
+    }
+
+    pCtxt = pDest->srtps[0].pSrtpShared;
+    idxSrc = -1;
+
+    if(pX->encryptOnce) {
+      for(idx = 0; idx < numGroups; idx++) {
+        if(srtp_canShareEncryptedPacket(pCtxt, pGroupCtxts[idx], seq)) {
+          idxSrc = idxGroups[idx];
+          break;
+        }
+      }
+    }
+
+    pX->pResults[idxDest].pktId = pX->pktId;
+
+    if(idxSrc >= 0) {
+      pX->pResults[idxDest].idxSrc = idxSrc;
+      pX->pResults[idxDest].idxBuf = pX->pResults[idxSrc].idxBuf;
+      numReused++;
+    } else {
+      pX->pResults[idxDest].idxSrc = idxDest;
+      pX->pResults[idxDest].idxBuf = pX->numSrcs;
+      pX->pIdxSrcs[pX->numSrcs++] = idxDest;
+      if(pX->encryptOnce && numGroups < STREAMXMIT_SRTP_GROUPS_MAX) {
+        pGroupCtxts[numGroups] = pCtxt;
+        idxGroups[numGroups++] = idxDest;
+      }
+    }
+  }
+
+  if(pX->numSrcs == 0) {
+    return 0;
+  } else if(srtp_xmit_allocbufs(pX, pX->numSrcs) < 0) {
+    // Fall back to protecting the packet in the send path
+    pX->pData = NULL;
+    return -1;
+  }
+
+  //
+  // Protect the packet for each unique SRTP context
+  //
+  if(pX->usePool && pX->numSrcs >= STREAMXMIT_SRTP_PARALLEL_MIN && srtp_pool_run(pRtp) == 0) {
+    pX->numParallel += pX->numSrcs;
+  } else {
+    for(idx = 0; idx < pX->numSrcs; idx++) {
+      srtp_protect_dest(pRtp, idx);
+    }
+  }
+  pX->numProtected += pX->numSrcs;
+
+  if(numReused == 0) {
+    return pX->numSrcs;
+  }
+
+  //
+  // Destinations sharing another destination's output still need to advance their packet index
+  //
+  for(idxActive = 0; idxActive < pActive->numDests; idxActive++) {
+
+    idxDest = pActive->idxDests[idxActive];
+
+    if(pX->pResults[idxDest].pktId != pX->pktId || (idxSrc = pX->pResults[idxDest].idxSrc) == (int) idxDest) {
+      continue;
+    }
+
+    if((rc = pX->pResults[idxSrc].rc) > 0 && 
+       srtp_skipEncryptPacket(pRtp->pdests[idxDest].srtps[0].pSrtpShared, seq) == 0) {
+      pX->pResults[idxDest].rc = rc;
+      pX->numReused++;
+    } else {
+      // Fall back to protecting the packet in the send path
+      pX->pResults[idxDest].pktId = 0;
+    }
+  }
+
+  return pX->numSrcs;
+}
+
+void streamxmit_srtp_done(STREAM_RTP_MULTI_T *pRtp) {
+  if(pRtp) {
+    pRtp->xmitSrtp.pData = NULL;
+  }
+}
+
+int streamxmit_srtp_lookup(const STREAM_RTP_DEST_T *pDest, const unsigned char *pData, unsigned int len,
+                           int *prc, const unsigned char **ppOut) {
+  const STREAM_RTP_MULTI_T *pRtp;
+  const STREAMXMIT_SRTP_T *pX;
+  const STREAMXMIT_SRTP_RESULT_T *pResult;
+  unsigned int idxDest;
+
+  if(!pDest || !(pRtp = pDest->pRtpMulti) || (pX = &pRtp->xmitSrtp)->active <= 0 || !pX->pData || 
+     pX->pData != pData || pX->len != len || !pX->pResults) {
+    return 0;
+  }
+
+  if((idxDest = (unsigned int) (pDest - pRtp->pdests)) >= pX->maxDests ||
+     (pResult = &pX->pResults[idxDest])->pktId != pX->pktId) {
+    return 0;
+  }
+
+  *prc = pResult->rc;
+  *ppOut = pResult->rc > 0 ? STREAMXMIT_SRTP_PBUF(pX, pResult->idxBuf) : pData;
+
+  return 1;
+}
+
+void streamxmit_srtp_close(STREAM_RTP_MULTI_T *pRtp) {
+  STREAMXMIT_SRTP_T *pX;
+
+  if(!pRtp || (pX = &pRtp->xmitSrtp)->active == 0) {
+    return;
+  }
+
+  if(pX->numProtected > 0) {
+    LOG(X_DEBUG("SRTP output ssrc: 0x%x protected: %llu, reused: %llu, parallel: %llu"), pRtp->init.ssrc,
+               (unsigned long long) pX->numProtected, (unsigned long long) pX->numReused, 
+               (unsigned long long) pX->numParallel);
+  }
+
+  if(pX->usePool) {
+    srtp_pool_release();
+  }
+
+  if(pX->pResults) {
+    avc_free((void **) &pX->pResults);
+  }
+  if(pX->pIdxSrcs) {
+    avc_free((void **) &pX->pIdxSrcs);
+  }
+  if(pX->pBufs) {
+    avc_free((void **) &pX->pBufs);
+  }
+
+  memset(pX, 0, sizeof(STREAMXMIT_SRTP_T));
+}
+
+#endif // VSX_HAVE_STREAMER
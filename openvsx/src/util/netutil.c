@@ -615,6 +615,67 @@ SOCKET net_listen(const struct sockaddr *psa, int backlog) {
   return socksrv;
 }
 
+SOCKET net_listen_reuseport(const struct sockaddr *psa, int backlog) {
+
+#if defined(SO_REUSEPORT)
+
+  SOCKET socksrv;
+  int val;
+  char tmp[128];
+
+  if(!psa) {
+    return INVALID_SOCKET;
+  }
+
+  if((socksrv = socket(psa->sa_family == AF_INET6 ? AF_INET6 : AF_INET, SOCK_STREAM, 0)) == INVALID_SOCKET) {
+    LOG(X_ERROR("Unable to create socket type %d"), SOCK_STREAM);
+    return INVALID_SOCKET;
+  }
+
+  val = 1;
+  if(setsockopt(socksrv, SOL_SOCKET, SO_REUSEADDR, (char *) &val, sizeof(val)) != 0) {
+    LOG(X_WARNING("setsockopt SOL_SOCKET SO_REUSEADDR fail "ERRNO_FMT_STR), ERRNO_FMT_ARGS);
+  }
+
+  //
+  // Each socket bound with SO_REUSEPORT to the same address gets its own accept queue
+  // and the kernel distributes incoming connections across all of them
+  //
+  val = 1;
+  if(setsockopt(socksrv, SOL_SOCKET, SO_REUSEPORT, (char *) &val, sizeof(val)) != 0) {
+    LOG(X_ERROR("setsockopt SOL_SOCKET SO_REUSEPORT fail "ERRNO_FMT_STR), ERRNO_FMT_ARGS);
+    closesocket(socksrv);
+    return INVALID_SOCKET;
+  }
+
+  if(bind(socksrv, psa, INET_SIZE(*psa)) < 0) {
+    LOG(X_ERROR("Unable to bind to local port %s:%d "ERRNO_FMT_STR),
+                FORMAT_NETADDR(*psa, tmp, sizeof(tmp)), ntohs(PINET_PORT(psa)), ERRNO_FMT_ARGS);
+    closesocket(socksrv);
+    return INVALID_SOCKET;
+  }
+
+  if(listen(socksrv, backlog) < 0) {
+    LOG(X_ERROR("Unable to listen on local port %s:%d (backlog:%d"),
+          FORMAT_NETADDR(*psa, tmp, sizeof(tmp)), ntohs(PINET_PORT(psa)), backlog);
+    closesocket(socksrv);
+    return INVALID_SOCKET;
+  }
+
+  VSX_DEBUG_NET( LOG(X_DEBUG("NET - net_listen_reuseport: family: %d, fd: %d, on %s:%d"),
+                psa->sa_family, socksrv, FORMAT_NETADDR(*psa, tmp, sizeof(tmp)), ntohs(PINET_PORT(psa))) );
+
+  return socksrv;
+
+#else // SO_REUSEPORT
+
+  LOG(X_ERROR("SO_REUSEPORT not supported on this system type"));
+  return INVALID_SOCKET;
+
+#endif // SO_REUSEPORT
+
+}
+
 static in_addr_t net_resolvehost4(const char *host) {
   struct hostent *pHost;
   struct in_addr addr;
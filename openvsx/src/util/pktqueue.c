@@ -26,6 +26,7 @@
 
 
 #define PKTQUEUE_TMP_PKT                   1
+#define PKTQUEUE_WR_PKT                    1
 
 #define PKTQ_ADVANCE_RD2(pQ, idxRd)   if(++idxRd >= (pQ)->cfg.maxPkts) { idxRd = 0; } 
 #define PKTQ_ADVANCE_WR2(pQ, idxWr)   if(++idxWr >= (pQ)->cfg.maxPkts) { idxWr = 0; } 
@@ -213,7 +214,8 @@ PKTQUEUE_T *pktqueue_create(unsigned int maxPkts, unsigned int szPkt,
     return NULL;
   }
 
-  if(!(pQ->pkts = (PKTQUEUE_PKT_T *) avc_calloc(growMaxPkts + PKTQUEUE_TMP_PKT, sizeof(PKTQUEUE_PKT_T)))) {
+  if(!(pQ->pkts = (PKTQUEUE_PKT_T *) avc_calloc(growMaxPkts + PKTQUEUE_TMP_PKT + PKTQUEUE_WR_PKT, 
+                                                sizeof(PKTQUEUE_PKT_T)))) {
     free(pQ);
     return NULL;
   }
@@ -245,7 +247,7 @@ PKTQUEUE_T *pktqueue_create(unsigned int maxPkts, unsigned int szPkt,
   pthread_cond_init(&pQ->notify.cond, NULL);
 
   if(prealloc) {
-    for(idx = 0; idx < maxPkts + PKTQUEUE_TMP_PKT; idx++) {
+    for(idx = 0; idx < maxPkts + PKTQUEUE_TMP_PKT + PKTQUEUE_WR_PKT; idx++) {
 
       if(alloc_slot(pQ, idx) < 0) {
         pktqueue_destroy(pQ);
@@ -258,6 +260,9 @@ PKTQUEUE_T *pktqueue_create(unsigned int maxPkts, unsigned int szPkt,
   if(PKTQUEUE_TMP_PKT) {
     pQ->pktTmp = &pQ->pkts[maxPkts];
   }
+  if(PKTQUEUE_WR_PKT) {
+    pQ->pktWr = &pQ->pkts[maxPkts + PKTQUEUE_TMP_PKT];
+  }
 
   pktqueue_reset(pQ, 0);
 
@@ -271,7 +276,7 @@ void pktqueue_destroy(PKTQUEUE_T *pQ) {
     return;
   }
 
-  for(idx = 0; idx < pQ->cfg.growMaxPkts + PKTQUEUE_TMP_PKT; idx++) {
+  for(idx = 0; idx < pQ->cfg.growMaxPkts + PKTQUEUE_TMP_PKT + PKTQUEUE_WR_PKT; idx++) {
     if(pQ->pkts[idx].pBuf) {
       avc_free((void **) &pQ->pkts[idx].pBuf);
     }
@@ -1107,6 +1112,131 @@ enum PKTQUEUE_RC pktqueue_addpkt(PKTQUEUE_T *pQ,
   return PKTQUEUE_RC_OK;
 }
 
+//
+// Direct write interface used by a single producer to assemble a frame in place.
+// The frame is appended to a writer owned staging slot, which is never visible to
+// a reader, so no queue lock is taken while appending.  pktqueue_writepktdirect_done
+// exchanges the staging slot buffer with the current write slot buffer, so the
+// frame contents are never copied again.
+//
+unsigned char *pktqueue_writepktdirect(PKTQUEUE_T *pQ, unsigned int len) {
+  PKTQUEUE_PKT_T *pPkt;
+  unsigned char *pData;
+  int rc;
+
+  if(!pQ || !pQ->pktWr || pQ->cfg.type != PKTQ_TYPE_DEFAULT) {
+    return NULL;
+  }
+
+  pPkt = pQ->pktWr;
+
+  if(!pPkt->pBuf || pPkt->len + len > pPkt->allocSz) {
+    rc = 0;
+    if(pPkt->len + len > pQ->cfg.growMaxPktLen || 
+       (rc = realloc_slot(pQ, (unsigned int) (pPkt - pQ->pkts), pPkt->len + len)) <= 0) {
+
+      LOG(X_WARNING("pkt queue(id:%d) direct write slot too small %u + %u / %u, resize %s"), 
+            pQ->cfg.id, pPkt->len, len, pPkt->allocSz,
+            (rc > 0 ? "ok" : (rc < 0 ? "error" : "none")));
+      return NULL;
+    }
+  }
+
+  pData = &pPkt->pData[pPkt->len];
+  pPkt->len += len;
+
+  return pData;
+}
+
+unsigned int pktqueue_writepktdirect_len(const PKTQUEUE_T *pQ) {
+
+  if(!pQ || !pQ->pktWr) {
+    return 0;
+  }
+
+  return pQ->pktWr->len;
+}
+
+void pktqueue_writepktdirect_abort(PKTQUEUE_T *pQ) {
+
+  if(pQ && pQ->pktWr) {
+    pQ->pktWr->len = 0;
+  }
+}
+
+enum PKTQUEUE_RC pktqueue_writepktdirect_done(PKTQUEUE_T *pQ, PKTQ_EXTRADATA_T *pXtra, int keyframe) {
+  PKTQUEUE_PKT_T *pSlot;
+  unsigned char *pBuf;
+  unsigned char *pData;
+  unsigned int allocSz;
+  unsigned int len;
+
+  if(!pQ || !pQ->pktWr || pQ->cfg.type != PKTQ_TYPE_DEFAULT) {
+    return PKTQUEUE_RC_ERROR;
+  } else if((len = pQ->pktWr->len) == 0) {
+    return PKTQUEUE_RC_OK;
+  }
+
+  qlock(pQ, 1);
+
+  check_overwrite(pQ, 1, pXtra);
+
+  //
+  // Swap the staging buffer holding the assembled frame into the write slot 
+  //
+  pSlot = &pQ->pkts[pQ->idxWr];
+  pBuf = pSlot->pBuf;
+  pData = pSlot->pData;
+  allocSz = pSlot->allocSz;
+
+  pSlot->pBuf = pQ->pktWr->pBuf;
+  pSlot->pData = pQ->pktWr->pData;
+  pSlot->allocSz = pQ->pktWr->allocSz;
+  pSlot->len = len;
+  pSlot->flags = (PKTQUEUE_FLAG_HAVEPKTDATA | PKTQUEUE_FLAG_HAVECOMPLETE);
+  if(keyframe) {
+    pSlot->flags |= PKTQUEUE_FLAG_KEYFRAME;
+  }
+
+  pQ->pktWr->pBuf = pBuf;
+  pQ->pktWr->pData = pData;
+  pQ->pktWr->allocSz = allocSz;
+  pQ->pktWr->len = 0;
+
+  if(pQ->haveRdr && pQ->pstats) {
+    pQ->pstats->written.bytes += len;
+    pktqueue_addburstsample(pQ->pstats, 0, len, pXtra);
+  }
+
+  if(pXtra) {
+    memcpy(&pSlot->xtra, pXtra, sizeof(pSlot->xtra));
+    pSlot->xtra.pQUserData = NULL;
+    pQ->ptsLastWr = pXtra->tm.pts;
+
+    if(pQ->cfg.userDataLen > 0 && pXtra->pQUserData) {
+      pSlot->xtra.pQUserData = pktqueue_getUserData(pSlot, &pQ->cfg);
+      memcpy(pSlot->xtra.pQUserData, pXtra->pQUserData,  pQ->cfg.userDataLen);
+    }
+  }
+
+  if(pQ->haveRdr) {
+    if(pQ->pstats) {
+      pQ->pstats->written.slots++;
+    }
+    PKTQ_ADVANCE_WR(pQ);
+  }
+  pQ->pkts[pQ->idxWr].idx = ++pQ->uniqueWrIdx;
+  pQ->haveData = 1;
+
+  if(pQ->cfg.uselock) {
+    wakeup_listeners(pQ);
+  }
+
+  qlock(pQ, 0);
+
+  return PKTQUEUE_RC_OK;
+}
+
 static void set_rdr_pos(PKTQUEUE_T *pQ) {
 
   pQ->idxRd = pQ->idxWr;
@@ -713,7 +713,14 @@ VSX_RC_T vsxlib_captureNet(VSXLIB_STREAM_PARAMS_T *pParams) {
   recCfg.outDir = pParams->dir;
   recCfg.overwriteOut = pParams->overwritefile;
 
-  if(isdev || (capCfg.common.filt.numFilters > 0 && pParams->pktqslots > 0 &&
+  if(pParams->capture_bench > 0) {
+
+    if(cap_pcapBench(capCfg.common.localAddrs[0], capCfg.common.filt.filters, 
+                     capCfg.common.filt.numFilters, pParams->capture_bench) < 0) {
+      rc = VSX_RC_ERROR;
+    }
+
+  } else if(isdev || (capCfg.common.filt.numFilters > 0 && pParams->pktqslots > 0 &&
                capture_parseLocalAddr(capCfg.common.localAddrs[0], &sockList)) > 0) {
 
     for(idx = 0; idx < capCfg.common.filt.numFilters; idx++) {
@@ -2810,6 +2817,7 @@ VSX_RC_T vsxlib_open(VSXLIB_STREAM_PARAMS_T *pParams) {
   pParams->extractpes = BOOL_DISABLED_DFLT;
 
   pParams->srtpCfgs[0].dtls_handshake_server = -1;
+  pParams->srtpEncryptOnce = BOOL_ENABLED_DFLT;
 
   pParams->capture_idletmt_ms = STREAM_CAPTURE_IDLETMT_MS;
   pParams->capture_idletmt_1stpkt_ms = STREAM_CAPTURE_IDLETMT_1STPKT_MS;
@@ -657,6 +657,16 @@ SRV_CONF_T *vsxlib_loadconf(VSXLIB_STREAM_PARAMS_T *pParams) {
     pParams->httpmax = atoi(parg);
   }
 
+  if((pParams->listenershards == 0) &&
+     (parg = conf_find_keyval(pConf->pKeyvals, SRV_CONF_KEY_LISTENSHARDS))) {
+    pParams->listenershards = atoi(parg);
+  }
+
+  if(BOOL_ISDFLT(pParams->listenercpuaffinity) &&
+     (parg = conf_find_keyval(pConf->pKeyvals, SRV_CONF_KEY_LISTENCPUAFFINITY))) {
+    pParams->listenercpuaffinity = MAKE_BOOL(IS_CONF_VAL_TRUE(parg));
+  }
+
   //
   // Get live auto-detect server broadcast config settings
   //
@@ -873,6 +883,16 @@ SRV_CONF_T *vsxlib_loadconf(VSXLIB_STREAM_PARAMS_T *pParams) {
     }
   }
 
+  if(pParams->capture_rcvbuf_max == 0 &&
+     (parg = conf_find_keyval(pConf->pKeyvals, SRV_CONF_KEY_RTPRCVBUFMAX))) {
+    pParams->capture_rcvbuf_max = atoi(parg);
+  }
+
+  if(pParams->capture_rcvthreads == 0 &&
+     (parg = conf_find_keyval(pConf->pKeyvals, SRV_CONF_KEY_RTPRCVTHREADS))) {
+    pParams->capture_rcvthreads = atoi(parg);
+  }
+
   if(pParams->frtcp_rr_intervalsec == 0 &&
      (parg = conf_find_keyval(pConf->pKeyvals, SRV_CONF_KEY_RTCP_RR_INTERVAL))) {
       if((f = (float) atof(parg)) >= 0) {
@@ -1130,6 +1150,14 @@ SRV_CONF_T *vsxlib_loadconf(VSXLIB_STREAM_PARAMS_T *pParams) {
     pParams->statusallowlist = parg;
   }
 
+  if(!pParams->ratelimitip && (parg = conf_find_keyval(pConf->pKeyvals, SRV_CONF_KEY_RATELIMITIP))) {
+    pParams->ratelimitip = parg;
+  }
+
+  if(!pParams->ratelimitsubnet && (parg = conf_find_keyval(pConf->pKeyvals, SRV_CONF_KEY_RATELIMITSUBNET))) {
+    pParams->ratelimitsubnet = parg;
+  }
+
   //
   // Packetization config
   //
@@ -1213,6 +1241,19 @@ SRV_CONF_T *vsxlib_loadconf(VSXLIB_STREAM_PARAMS_T *pParams) {
     pParams->srtpCfgs[0].dtlsTimeouts.handshakeRtcpAdditionalGiveupMs = atoi(parg);
   }
 
+  //
+  // SRTP output protection configs
+  //
+  if(BOOL_ISDFLT(pParams->srtpEncryptOnce) &&
+     (parg = conf_find_keyval(pConf->pKeyvals, SRV_CONF_KEY_SRTPENCRYPTONCE))) {
+    pParams->srtpEncryptOnce = MAKE_BOOL(IS_CONF_VAL_TRUE(parg));
+  }
+
+  if(pParams->srtpXmitThreads == 0 &&
+     (parg = conf_find_keyval(pConf->pKeyvals, SRV_CONF_KEY_SRTPXMITTHREADS))) {
+    pParams->srtpXmitThreads = atoi(parg);
+  }
+
 
   //
   // Get the license contents
@@ -1315,6 +1356,8 @@ int vsxlib_stream_setupcap_params(const VSXLIB_STREAM_PARAMS_T *pParams,
      pCapCfg->common.rtp_frame_drop_policy >= CAPTURE_FRAME_DROP_POLICY_MAX_VAL) {
     pCapCfg->common.rtp_frame_drop_policy =  CAPTURE_FRAME_DROP_POLICY_DEFAULT;
   }
+  pCapCfg->common.rcvbuf_max = pParams->capture_rcvbuf_max;
+  pCapCfg->common.rcvthreads = MIN(pParams->capture_rcvthreads, CAPTURE_RCVWORKERS_MAX);
   pCapCfg->common.rtcp_reply_from_mcast = pParams->rtcp_reply_from_mcast;
   pCapCfg->common.caprealtime = pParams->caprealtime;
   vsxlib_stream_setup_rtmpclient(&pCapCfg->common.rtmpcfg, pParams);
@@ -1850,6 +1893,8 @@ void vsxlib_setup_rtpout(STREAMER_CFG_T *pStreamerCfg, const VSXLIB_STREAM_PARAM
   pStreamerCfg->cfgrtp.audioAggregatePktsMs = pParams->audioAggregatePktsMs;
   pStreamerCfg->cfgrtp.rtpPktzMode = pParams->rtpPktzMode;
   pStreamerCfg->cfgrtp.rtp_useCaptureSrcPort = pParams->rtp_useCaptureSrcPort;
+  pStreamerCfg->cfgrtp.srtpEncryptOnce = BOOL_ISENABLED(pParams->srtpEncryptOnce);
+  pStreamerCfg->cfgrtp.srtpXmitThreads = MIN(pParams->srtpXmitThreads, STREAMXMIT_SRTP_THREADS_MAX);
 
   //
   // Get the RTP payload types string
@@ -2652,6 +2697,44 @@ int vsxlib_parseaddrfilters(SRV_LISTENER_CFG_T *pListenerCfg,
   return rc;
 }
 
+int vsxlib_initratelimit(SRV_RATELIMIT_T *pRateLimit, const VSXLIB_STREAM_PARAMS_T *pParams) {
+  SRV_RATELIMIT_CFG_T cfg;
+  unsigned int prefix = 0;
+  const char *p;
+
+  if(!pRateLimit || !pParams) {
+    return -1;
+  }
+
+  memset(&cfg, 0, sizeof(cfg));
+
+  if(pParams->ratelimitip) {
+    p = avc_dequote(pParams->ratelimitip, NULL, 0);
+    if(srv_ratelimit_parse(p, &cfg.ip, NULL) < 0) {
+      LOG(X_ERROR("Invalid per IP rate limit '%s'"), pParams->ratelimitip);
+      return -1;
+    }
+  }
+
+  if(pParams->ratelimitsubnet) {
+    p = avc_dequote(pParams->ratelimitsubnet, NULL, 0);
+    if(srv_ratelimit_parse(p, &cfg.subnet, &prefix) < 0) {
+      LOG(X_ERROR("Invalid per subnet rate limit '%s'"), pParams->ratelimitsubnet);
+      return -1;
+    }
+    //
+    // A prefix of up to 32 bits applies to IPv4 subnets, a longer prefix to IPv6 subnets
+    //
+    if(prefix > 0 && prefix <= ADDR_LEN_IPV4 * 8) {
+      cfg.subnetPrefix4 = prefix;
+    } else if(prefix > 0) {
+      cfg.subnetPrefix6 = prefix;
+    }
+  }
+
+  return srv_ratelimit_init(pRateLimit, &cfg);
+}
+
 static int ismatchAddrFilter(const SRV_ADDR_FILTER_T *pFilter, const struct sockaddr *psa) {
 
   if(pFilter->sa.ss_family != psa->sa_family) {
@@ -134,8 +134,9 @@ void vsxlib_closeaddrfilters(SRV_START_CFG_T *pStartCfg) {
 }
 
 void vsxlib_closeServer(SRV_PARAM_T *pSrv) {
-  unsigned int idx, outidx;
+  unsigned int idx, outidx, idxShard;
   CLIENT_CONN_T *pConn;
+  TIME_VAL tv0;
 
   if(!pSrv) {
     return;
@@ -206,10 +207,37 @@ void vsxlib_closeServer(SRV_PARAM_T *pSrv) {
     if(pSrv->startcfg.listenMedia[idx].active) {
       pthread_mutex_lock(&pSrv->startcfg.listenMedia[idx].mtx);
       if(pSrv->startcfg.listenMedia[idx].pnetsockSrv) {
+        if(pSrv->startcfg.listenMedia[idx].shardsRunning &&
+           PNETIOSOCK_FD(pSrv->startcfg.listenMedia[idx].pnetsockSrv) != INVALID_SOCKET) {
+          shutdown(PNETIOSOCK_FD(pSrv->startcfg.listenMedia[idx].pnetsockSrv), SHUT_RDWR);
+        }
         netio_closesocket(pSrv->startcfg.listenMedia[idx].pnetsockSrv);
       }
+      for(idxShard = 0; idxShard < SRV_LISTENER_SHARDS_MAX; idxShard++) {
+        if(pSrv->startcfg.listenMedia[idx].pnetsockShards[idxShard]) {
+          if(PNETIOSOCK_FD(pSrv->startcfg.listenMedia[idx].pnetsockShards[idxShard]) != INVALID_SOCKET) {
+            shutdown(PNETIOSOCK_FD(pSrv->startcfg.listenMedia[idx].pnetsockShards[idxShard]), SHUT_RDWR);
+          }
+          netio_closesocket(pSrv->startcfg.listenMedia[idx].pnetsockShards[idxShard]);
+        }
+      }
       pthread_mutex_unlock(&pSrv->startcfg.listenMedia[idx].mtx);
-      pthread_mutex_destroy(&pSrv->startcfg.listenMedia[idx].mtx);
+
+      //
+      // The listener thread joins its accept shard threads after its own accept loop exits.
+      // The shard threads use the listener mutex, so it can only be destroyed after they are gone.
+      //
+      tv0 = timer_GetTime();
+      while(pSrv->startcfg.listenMedia[idx].shardsRunning && 
+            (timer_GetTime() - tv0) / TIME_VAL_MS < 3000) {
+        usleep(10000);
+      }
+
+      if(pSrv->startcfg.listenMedia[idx].shardsRunning) {
+        LOG(X_WARNING("Listener accept shard threads still running on close"));
+      } else {
+        pthread_mutex_destroy(&pSrv->startcfg.listenMedia[idx].mtx);
+      }
     }
   }
 
@@ -217,6 +245,8 @@ void vsxlib_closeServer(SRV_PARAM_T *pSrv) {
 
   pool_close(&pSrv->poolHttp, 3000);
 
+  srv_ratelimit_close(&pSrv->startcfg.rateLimit);
+
   vsxlib_closeOutFmt(&pSrv->pStreamerCfg->action.liveFmts.out[STREAMER_OUTFMT_IDX_RTMP]);
   vsxlib_closeOutFmt(&pSrv->pStreamerCfg->action.liveFmts.out[STREAMER_OUTFMT_IDX_FLV]);
   vsxlib_closeOutFmt(&pSrv->pStreamerCfg->action.liveFmts.out[STREAMER_OUTFMT_IDX_MKV]);
@@ -803,6 +833,14 @@ int vsxlib_setupServer(SRV_PARAM_T *pSrv, const VSXLIB_STREAM_PARAMS_T *pParams,
   vsxlib_parseaddrfilters(&pSrv->startcfg.listenMedia[0], pParams->allowlist, pParams->denylist,
                           pParams->statusallowlist);
 
+  //
+  // Init any per client address admission control
+  //
+  if((rc = vsxlib_initratelimit(&pSrv->startcfg.rateLimit, pParams)) < 0) {
+    vsxlib_closeServer(pSrv);
+    return rc;
+  }
+
   //
   // Start the media listener server(s)
   //
@@ -820,6 +858,10 @@ int vsxlib_setupServer(SRV_PARAM_T *pSrv, const VSXLIB_STREAM_PARAMS_T *pParams,
         pSrv->startcfg.listenMedia[idx].pConnPool = &pSrv->poolHttp;
         pSrv->startcfg.listenMedia[idx].pCfg = &pSrv->startcfg;
         pSrv->startcfg.listenMedia[idx].pAuthTokenId = pParams->tokenid;
+        pSrv->startcfg.listenMedia[idx].pRateLimit = pSrv->startcfg.rateLimit.active ? 
+                                                     &pSrv->startcfg.rateLimit : NULL;
+        pSrv->startcfg.listenMedia[idx].numShards = MIN(pParams->listenershards, SRV_LISTENER_SHARDS_MAX);
+        pSrv->startcfg.listenMedia[idx].cpuAffinity = BOOL_ISENABLED(pParams->listenercpuaffinity);
         pthread_mutex_init(&pSrv->startcfg.listenMedia[idx].mtx, NULL);
 
         if((rc = vsxlib_ssl_initserver(pParams, &pSrv->startcfg.listenMedia[idx])) < 0 ||
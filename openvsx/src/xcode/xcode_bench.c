@@ -0,0 +1,600 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#include "vsx_common.h"
+
+#if !defined(WIN32)
+#include <sys/resource.h>
+#endif // WIN32
+
+//
+// Offline transcode throughput benchmark.
+// Raw YUV420P / PCM16LE input is either read from file or synthesized, preloaded into memory,
+// and run through each 'xcode=' configuration of the benchmark file.  One JSON object
+// is emitted per configuration.
+//
+
+#define XCODE_BENCH_KEY_INPUT            "input"
+#define XCODE_BENCH_KEY_WIDTH            "width"
+#define XCODE_BENCH_KEY_HEIGHT           "height"
+#define XCODE_BENCH_KEY_FPS              "fps"
+#define XCODE_BENCH_KEY_FRAMES           "frames"
+#define XCODE_BENCH_KEY_INPUT_AUDIO      "inputAudio"
+#define XCODE_BENCH_KEY_AUDIO_RATE       "audioRate"
+#define XCODE_BENCH_KEY_AUDIO_CHANNELS   "audioChannels"
+#define XCODE_BENCH_KEY_XCODE            "xcode"
+#define XCODE_BENCH_KEY_OUTPUT           "output"
+
+#define XCODE_BENCH_CONFIGS_MAX          32
+#define XCODE_BENCH_BUFFRAMES_MAX        60
+#define XCODE_BENCH_FRAMES_DEFAULT       300
+#define XCODE_BENCH_AUDIO_CHUNK_MS       20
+#define XCODE_BENCH_AUDIO_LENOUT         0x4000
+
+typedef struct XCODE_BENCH_INPUT {
+  unsigned int           width;
+  unsigned int           height;
+  unsigned int           clockHz;
+  unsigned int           frameDeltaHz;
+  unsigned int           numFrames;       // frames to transcode per configuration
+  unsigned int           frameSz;
+  unsigned int           numBufFrames;    // distinct frames preloaded in pVidBuf
+  unsigned char         *pVidBuf;
+  unsigned int           audioRate;
+  unsigned int           audioChannels;
+  unsigned int           audioChunkSz;
+  unsigned int           numBufChunks;    // distinct chunks preloaded in pAudBuf
+  unsigned char         *pAudBuf;
+  const char            *pathVid;
+  const char            *pathAud;
+} XCODE_BENCH_INPUT_T;
+
+typedef struct XCODE_BENCH_RESULT {
+  unsigned int           framesIn;
+  unsigned int           framesOut[IXCODE_VIDEO_OUT_MAX];
+  uint64_t               bytesOut[IXCODE_VIDEO_OUT_MAX];
+  TIME_VAL               tmVid;
+  IXCODE_STAGE_STATS_T   statsVid;
+  unsigned int           chunksIn;
+  unsigned int           framesOutAud;
+  uint64_t               bytesOutAud;
+  TIME_VAL               tmAud;
+  IXCODE_STAGE_STATS_T   statsAud;
+} XCODE_BENCH_RESULT_T;
+
+static unsigned int bench_load(const char *path, unsigned char *pBuf, unsigned int szUnit, 
+                               unsigned int maxUnits) {
+  FILE_HANDLE fp;
+  unsigned int numUnits = 0;
+
+  if((fp = fileops_Open(path, O_RDONLY)) == FILEOPS_INVALID_FP) {
+    LOG(X_ERROR("Unable to open benchmark input file for reading: %s"), path);
+    return 0;
+  }
+
+  while(numUnits < maxUnits && fileops_Read(&pBuf[numUnits * szUnit], 1, szUnit, fp) == (int) szUnit) {
+    numUnits++;
+  }
+
+  fileops_Close(fp);
+
+  if(numUnits == 0) {
+    LOG(X_ERROR("Benchmark input file %s is smaller than one unit of %d bytes"), path, szUnit);
+  }
+
+  return numUnits;
+}
+
+static void bench_gen_vid(unsigned char *p, unsigned int width, unsigned int height, unsigned int idx) {
+  unsigned int x, y;
+  unsigned char *pU = p + width * height;
+  unsigned char *pV = pU + (width / 2) * (height / 2);
+
+  //
+  // Diagonal luma gradient moving by a few pixels per frame over a slowly varying chroma field
+  //
+  for(y = 0; y < height; y++) {
+    for(x = 0; x < width; x++) {
+      p[y * width + x] = (unsigned char) (x + y + idx * 4);
+    }
+  }
+  for(y = 0; y < height / 2; y++) {
+    for(x = 0; x < width / 2; x++) {
+      pU[y * (width / 2) + x] = (unsigned char) (128 + ((x + idx) & 0x3f) - 32);
+      pV[y * (width / 2) + x] = (unsigned char) (128 + ((y + idx) & 0x3f) - 32);
+    }
+  }
+}
+
+static void bench_gen_aud(int16_t *p, unsigned int numSamples, unsigned int channels, 
+                          unsigned int rate, unsigned int offset) {
+  unsigned int idx, ch;
+  int16_t val;
+
+  //
+  // 440Hz tone
+  //
+  for(idx = 0; idx < numSamples; idx++) {
+    val = (int16_t) (8000.0 * sin(2 * M_PI * 440 * (double) (offset + idx) / rate));
+    for(ch = 0; ch < channels; ch++) {
+      p[idx * channels + ch] = val;
+    }
+  }
+}
+
+static int bench_input_init(XCODE_BENCH_INPUT_T *pIn) {
+  unsigned int idx;
+
+  pIn->frameSz = pIn->width * pIn->height * 3 / 2;
+  pIn->numBufFrames = MIN(pIn->numFrames, XCODE_BENCH_BUFFRAMES_MAX);
+
+  if(!(pIn->pVidBuf = (unsigned char *) avc_calloc(pIn->numBufFrames, pIn->frameSz))) {
+    return -1;
+  }
+
+  if(pIn->pathVid) {
+    if((pIn->numBufFrames = bench_load(pIn->pathVid, pIn->pVidBuf, pIn->frameSz, pIn->numBufFrames)) == 0) {
+      return -1;
+    }
+  } else {
+    for(idx = 0; idx < pIn->numBufFrames; idx++) {
+      bench_gen_vid(&pIn->pVidBuf[idx * pIn->frameSz], pIn->width, pIn->height, idx);
+    }
+  }
+
+  //
+  // Preload one second of audio which is looped for the duration of the video input
+  //
+  pIn->audioChunkSz = pIn->audioRate * XCODE_BENCH_AUDIO_CHUNK_MS / 1000 * pIn->audioChannels * 2;
+  pIn->numBufChunks = 1000 / XCODE_BENCH_AUDIO_CHUNK_MS;
+
+  if(!(pIn->pAudBuf = (unsigned char *) avc_calloc(pIn->numBufChunks, pIn->audioChunkSz))) {
+    return -1;
+  }
+
+  if(pIn->pathAud) {
+    if((pIn->numBufChunks = bench_load(pIn->pathAud, pIn->pAudBuf, pIn->audioChunkSz, pIn->numBufChunks)) == 0) {
+      return -1;
+    }
+  } else {
+    bench_gen_aud((int16_t *) pIn->pAudBuf, pIn->numBufChunks * pIn->audioChunkSz / 2 / pIn->audioChannels,
+                  pIn->audioChannels, pIn->audioRate, 0);
+  }
+
+  return 0;
+}
+
+static void bench_input_free(XCODE_BENCH_INPUT_T *pIn) {
+  if(pIn->pVidBuf) {
+    avc_free((void **) &pIn->pVidBuf);
+  }
+  if(pIn->pAudBuf) {
+    avc_free((void **) &pIn->pAudBuf);
+  }
+}
+
+//
+// Resolve the output resolution from the input dimensions as done by xcode_vid.c setresolution
+//
+static void bench_setresolution(IXCODE_VIDEO_OUT_T *pOut, unsigned int width, unsigned int height) {
+  float aspectr;
+
+  if(pOut->cfgOutH > 0 && pOut->cfgOutV > 0) {
+    pOut->resOutH = pOut->cfgOutH;
+    pOut->resOutV = pOut->cfgOutV;
+  } else {
+
+    if(IXCODE_FILTER_ROTATE_90(*pOut)) {
+      aspectr = (float) height / width;
+    } else {
+      aspectr = (float) width / height;
+    }
+
+    if(pOut->cfgOutV) {
+      pOut->resOutV = pOut->cfgOutV;
+      pOut->resOutH = (unsigned int) (aspectr * (float) pOut->cfgOutV);
+    } else if(pOut->cfgOutH) {
+      pOut->resOutH = pOut->cfgOutH;
+      pOut->resOutV = (unsigned int) ((float) pOut->cfgOutH / aspectr);
+    } else if(IXCODE_FILTER_ROTATE_90(*pOut)) {
+      pOut->resOutH = height;
+      pOut->resOutV = width;
+    } else {
+      pOut->resOutH = width;
+      pOut->resOutV = height;
+    }
+  }
+
+  if(pOut->resOutH & 0x01) {
+    pOut->resOutH++;
+  }
+  if(pOut->resOutV & 0x01) {
+    pOut->resOutV++;
+  }
+}
+
+static int bench_run_vid(IXCODE_VIDEO_CTXT_T *pXcode, const XCODE_BENCH_INPUT_T *pIn, 
+                         XCODE_BENCH_RESULT_T *pRes) {
+  IXCODE_OUTBUF_T outbuf;
+  unsigned char *pOutBuf = NULL;
+  unsigned int outidx;
+  unsigned int idx;
+  uint64_t outDeltaHz;
+  int doEncode;
+  int rc = 0;
+  TIME_VAL tm0;
+
+  pXcode->common.cfgFileTypeIn = XC_CODEC_TYPE_RAWV_YUV420P;
+  pXcode->common.cfgStageStats = 1;
+  pXcode->inH = pIn->width;
+  pXcode->inV = pIn->height;
+  pXcode->inClockHz = pIn->clockHz;
+  pXcode->inFrameDeltaHz = pIn->frameDeltaHz;
+
+  if(pXcode->cfgOutClockHz > 0) {
+    pXcode->resOutClockHz = pXcode->cfgOutClockHz;
+    pXcode->resOutFrameDeltaHz = pXcode->cfgOutFrameDeltaHz;
+  } else {
+    pXcode->resOutClockHz = pXcode->inClockHz;
+    pXcode->resOutFrameDeltaHz = pXcode->inFrameDeltaHz;
+  }
+  if(!pXcode->common.cfgAllowUpsample && 
+     (double) pXcode->resOutClockHz / pXcode->resOutFrameDeltaHz > 
+     (double) pXcode->inClockHz / pXcode->inFrameDeltaHz) {
+    pXcode->resOutClockHz = pXcode->inClockHz;
+    pXcode->resOutFrameDeltaHz = pXcode->inFrameDeltaHz;
+  }
+
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+    if(pXcode->out[outidx].active) {
+      if((pXcode->out[outidx].cfgLookaheadmin1 & ~XCODE_VID_LOOKAHEAD_AUTO_FLAG) > 0) {
+        pXcode->out[outidx].resLookaheadmin1 = (pXcode->out[outidx].cfgLookaheadmin1 & ~XCODE_VID_LOOKAHEAD_AUTO_FLAG);
+      }
+      bench_setresolution(&pXcode->out[outidx], pIn->width, pIn->height);
+    }
+  }
+
+  if(xcode_set_crop_pad(&pXcode->out[0].crop, &pXcode->out[0], pXcode->out[0].crop.padAspectR,
+                        pXcode->out[0].resOutH, pXcode->out[0].resOutV, pIn->width, pIn->height) < 0) {
+    return -1;
+  }
+
+  if(xcode_init_vid(pXcode) != 0) {
+    LOG(X_ERROR("Failed to initialize video transcoder"));
+    return -1;
+  }
+
+  if(!(pOutBuf = (unsigned char *) avc_calloc(1, IXCODE_SZFRAME_MAX))) {
+    xcode_close_vid(pXcode);
+    return -1;
+  }
+
+  outDeltaHz = (uint64_t) PTS_HZ_SEC * pXcode->resOutFrameDeltaHz / pXcode->resOutClockHz;
+  tm0 = timer_GetTime();
+
+  for(idx = 0; idx < pIn->numFrames; idx++) {
+
+    pXcode->common.inpts90Khz = (uint64_t) idx * PTS_HZ_SEC * pIn->frameDeltaHz / pIn->clockHz;
+    doEncode = (pXcode->common.inpts90Khz + 150 >= pXcode->common.outpts90Khz);
+
+    memset(&outbuf, 0, sizeof(outbuf));
+    outbuf.buf = pOutBuf;
+    outbuf.lenbuf = IXCODE_SZFRAME_MAX;
+
+    if((rc = xcode_frame_vid(pXcode, &pIn->pVidBuf[(idx % pIn->numBufFrames) * pIn->frameSz], 
+                             pIn->frameSz, &outbuf)) < 0) {
+      LOG(X_ERROR("xcode_frame_vid frame[%d] error rc:%d"), idx, rc);
+      break;
+    }
+    rc = 0;
+
+    if(doEncode) {
+      pXcode->common.outpts90Khz += outDeltaHz;
+    }
+
+    pRes->framesIn++;
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+      if(outbuf.lens[outidx] > 0) {
+        pRes->framesOut[outidx]++;
+        pRes->bytesOut[outidx] += outbuf.lens[outidx];
+      }
+    }
+  }
+
+  pRes->tmVid = timer_GetTime() - tm0;
+  memcpy(&pRes->statsVid, &pXcode->common.stageStats, sizeof(pRes->statsVid));
+
+  xcode_close_vid(pXcode);
+  avc_free((void **) &pOutBuf);
+
+  return rc;
+}
+
+static int bench_run_aud(IXCODE_AUDIO_CTXT_T *pXcode, const XCODE_BENCH_INPUT_T *pIn, 
+                         XCODE_BENCH_RESULT_T *pRes) {
+  unsigned char *pOutBuf = NULL;
+  unsigned int idx;
+  unsigned int numChunks;
+  int rc = 0;
+  TIME_VAL tm0;
+
+  pXcode->common.cfgFileTypeIn = XC_CODEC_TYPE_RAWA_PCM16LE;
+  pXcode->common.cfgStageStats = 1;
+  pXcode->cfgSampleRateIn = pIn->audioRate;
+  pXcode->cfgChannelsIn = pIn->audioChannels;
+  if(pXcode->cfgSampleRateOut == 0) {
+    pXcode->cfgSampleRateOut = pXcode->cfgSampleRateIn;
+  }
+  if(pXcode->cfgChannelsOut == 0) {
+    pXcode->cfgChannelsOut = pXcode->cfgChannelsIn;
+  }
+
+  if(xcode_init_aud(pXcode) != 0) {
+    LOG(X_ERROR("Failed to initialize audio transcoder"));
+    return -1;
+  }
+
+  if(!(pOutBuf = (unsigned char *) avc_calloc(1, XCODE_BENCH_AUDIO_LENOUT))) {
+    xcode_close_aud(pXcode);
+    return -1;
+  }
+
+  //
+  // Cover the same duration as the video input
+  //
+  numChunks = (unsigned int) ((uint64_t) pIn->numFrames * pIn->frameDeltaHz * 1000 / 
+                              pIn->clockHz / XCODE_BENCH_AUDIO_CHUNK_MS);
+  tm0 = timer_GetTime();
+
+  for(idx = 0; idx < numChunks; idx++) {
+
+    pXcode->common.inpts90Khz = (uint64_t) idx * XCODE_BENCH_AUDIO_CHUNK_MS * PTS_HZ_SEC / 1000;
+
+    if((rc = xcode_frame_aud(pXcode, &pIn->pAudBuf[(idx % pIn->numBufChunks) * pIn->audioChunkSz],
+                             pIn->audioChunkSz, pOutBuf, XCODE_BENCH_AUDIO_LENOUT)) < 0) {
+      LOG(X_ERROR("xcode_frame_aud chunk[%d] error rc:%d"), idx, rc);
+      break;
+    }
+
+    pRes->chunksIn++;
+    if(rc > 0) {
+      pRes->framesOutAud++;
+      pRes->bytesOutAud += rc;
+    }
+    rc = 0;
+  }
+
+  pRes->tmAud = timer_GetTime() - tm0;
+  memcpy(&pRes->statsAud, &pXcode->common.stageStats, sizeof(pRes->statsAud));
+
+  xcode_close_aud(pXcode);
+  avc_free((void **) &pOutBuf);
+
+  return rc;
+}
+
+static long bench_maxrss_kb() {
+#if !defined(WIN32)
+  struct rusage ru;
+
+  if(getrusage(RUSAGE_SELF, &ru) == 0) {
+    return ru.ru_maxrss;
+  }
+#endif // WIN32
+  return -1;
+}
+
+#define BENCH_AVG_US(us, num) ((num) > 0 ? (double) (us) / (num) : 0.0)
+
+static void bench_write_stats(FILE_HANDLE fp, const char *name, const IXCODE_STAGE_STATS_T *pStats,
+                              const char *nameScale) {
+  fileops_Write(fp, "\"%s\":{\"decodeUs\":%.1f,\"%sUs\":%.1f,", name, 
+                BENCH_AVG_US(pStats->usDecode, pStats->numDecode), nameScale, 
+                BENCH_AVG_US(pStats->usScale, pStats->numScale));
+  if(pStats->numFilter > 0) {
+    fileops_Write(fp, "\"filterUs\":%.1f,", BENCH_AVG_US(pStats->usFilter, pStats->numFilter));
+  }
+  fileops_Write(fp, "\"encodeUs\":%.1f}", BENCH_AVG_US(pStats->usEncode, pStats->numEncode));
+}
+
+static void bench_write_result(FILE_HANDLE fp, const char *strxcode, int rc, const IXCODE_CTXT_T *pXcode,
+                               const XCODE_BENCH_INPUT_T *pIn, const XCODE_BENCH_RESULT_T *pRes) {
+  const char *p;
+  unsigned int outidx;
+  int haveOut = 0;
+
+  fileops_Write(fp, "{\"xcode\":\"");
+  for(p = strxcode; *p != '\0'; p++) {
+    if(*p == '"' || *p == '\\') {
+      fileops_Write(fp, "\\");
+    }
+    fileops_Write(fp, "%c", *p);
+  }
+  fileops_Write(fp, "\",\"status\":\"%s\",\"input\":\"%dx%d@%.3f\",\"maxRssKb\":%ld", 
+                AVC_RC_STR(rc), pIn->width, pIn->height, (double) pIn->clockHz / pIn->frameDeltaHz, 
+                bench_maxrss_kb());
+
+  if(pXcode->vid.common.cfgDo_xcode) {
+    fileops_Write(fp, ",\"frames\":%d,\"elapsedMs\":%.3f,\"fps\":%.2f,",
+                  pRes->framesIn, (double) pRes->tmVid / 1000, 
+                  pRes->tmVid > 0 ? (double) pRes->framesIn * TIME_VAL_US / pRes->tmVid : 0.0);
+    bench_write_stats(fp, "video", &pRes->statsVid, "scale");
+    fileops_Write(fp, ",\"outputs\":[");
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+      if(!pXcode->vid.out[outidx].active) {
+        continue;
+      }
+      fileops_Write(fp, "%s{\"index\":%d,\"resolution\":\"%dx%d\",\"frames\":%d,\"kbps\":%.1f}",
+                    haveOut++ ? "," : "", outidx, 
+                    pXcode->vid.out[outidx].resOutH, pXcode->vid.out[outidx].resOutV, pRes->framesOut[outidx],
+                    pRes->framesIn > 0 ? (double) pRes->bytesOut[outidx] * 8 * pIn->clockHz / 
+                                         pIn->frameDeltaHz / pRes->framesIn / 1000 : 0.0);
+    }
+    fileops_Write(fp, "]");
+  }
+
+  if(pXcode->aud.common.cfgDo_xcode) {
+    fileops_Write(fp, ",\"audioChunks\":%d,\"audioElapsedMs\":%.3f,\"audioRealtimeX\":%.1f,",
+                  pRes->chunksIn, (double) pRes->tmAud / 1000,
+                  pRes->tmAud > 0 ? (double) pRes->chunksIn * XCODE_BENCH_AUDIO_CHUNK_MS * 1000 / pRes->tmAud : 0.0);
+    bench_write_stats(fp, "audio", &pRes->statsAud, "resample");
+  }
+
+  fileops_Write(fp, "}\n");
+  fflush(fp);
+}
+
+int xcode_benchmark(const char *path) {
+  SRV_CONF_T *pConf = NULL;
+  XCODE_BENCH_INPUT_T input;
+  XCODE_BENCH_RESULT_T res;
+  IXCODE_CTXT_T *pXcode = NULL;
+  const char *strxcodes[XCODE_BENCH_CONFIGS_MAX];
+  const char *parg;
+  FILE_HANDLE fp = stdout;
+  void *pIpc = NULL;
+  unsigned int numConfigs;
+  unsigned int idx;
+  int numErrors = 0;
+  int rc = 0;
+
+  if(!path || path[0] == '\0') {
+    LOG(X_ERROR("No xcode benchmark file given"));
+    return -1;
+  } else if(xcode_enabled(1) < XCODE_CFG_OK) {
+    return -1;
+  } else if(!(pConf = conf_parse(path))) {
+    return -1;
+  }
+
+  memset(&input, 0, sizeof(input));
+  memset(strxcodes, 0, sizeof(strxcodes));
+  input.pathVid = conf_find_keyval(pConf->pKeyvals, XCODE_BENCH_KEY_INPUT);
+  input.pathAud = conf_find_keyval(pConf->pKeyvals, XCODE_BENCH_KEY_INPUT_AUDIO);
+  if((parg = conf_find_keyval(pConf->pKeyvals, XCODE_BENCH_KEY_WIDTH))) {
+    input.width = atoi(parg);
+  }
+  if((parg = conf_find_keyval(pConf->pKeyvals, XCODE_BENCH_KEY_HEIGHT))) {
+    input.height = atoi(parg);
+  }
+  if((parg = conf_find_keyval(pConf->pKeyvals, XCODE_BENCH_KEY_FRAMES))) {
+    input.numFrames = atoi(parg);
+  }
+  if((parg = conf_find_keyval(pConf->pKeyvals, XCODE_BENCH_KEY_AUDIO_RATE))) {
+    input.audioRate = atoi(parg);
+  }
+  if((parg = conf_find_keyval(pConf->pKeyvals, XCODE_BENCH_KEY_AUDIO_CHANNELS))) {
+    input.audioChannels = atoi(parg);
+  }
+  if(!(parg = conf_find_keyval(pConf->pKeyvals, XCODE_BENCH_KEY_FPS)) || 
+     vid_convert_fps(atof(parg), &input.clockHz, &input.frameDeltaHz) < 0) {
+    vid_convert_fps(30, &input.clockHz, &input.frameDeltaHz);
+  }
+
+  if(input.width == 0 || input.height == 0) {
+    input.width = 1280;
+    input.height = 720;
+  }
+  if(input.numFrames == 0) {
+    input.numFrames = XCODE_BENCH_FRAMES_DEFAULT;
+  }
+  if(input.audioRate == 0) {
+    input.audioRate = 48000;
+  }
+  if(input.audioChannels == 0) {
+    input.audioChannels = 2;
+  }
+
+  if((input.width & 0x01) || (input.height & 0x01)) {
+    LOG(X_ERROR("Benchmark input dimensions %dx%d must be even"), input.width, input.height);
+    rc = -1;
+  } else if((numConfigs = conf_load_vals_multi(pConf, strxcodes, XCODE_BENCH_CONFIGS_MAX, 
+                                               XCODE_BENCH_KEY_XCODE)) == 0) {
+    LOG(X_ERROR("No '%s=' transcode configurations found in %s"), XCODE_BENCH_KEY_XCODE, path);
+    rc = -1;
+  } else if(bench_input_init(&input) < 0) {
+    rc = -1;
+  } else if((parg = conf_find_keyval(pConf->pKeyvals, XCODE_BENCH_KEY_OUTPUT)) &&
+            (fp = fileops_Open(parg, O_RDWR | O_CREAT)) == FILEOPS_INVALID_FP) {
+    LOG(X_ERROR("Unable to open benchmark output file for writing: %s"), parg);
+    rc = -1;
+  }
+
+#if defined(XCODE_IPC)
+  if(rc == 0 && !(pIpc = xcode_ipc_open(XCODE_IPC_MEM_SZ, XCODE_IPC_SHMKEY))) {
+    rc = -1;
+  }
+#endif // XCODE_IPC
+
+  if(rc == 0 && !(pXcode = (IXCODE_CTXT_T *) avc_calloc(1, sizeof(IXCODE_CTXT_T)))) {
+    rc = -1;
+  }
+
+  if(rc == 0) {
+    LOG(X_INFO("Running %d transcode configuration(s) on %s %dx%d@%.3ffps input for %d frames"),
+         numConfigs, input.pathVid ? input.pathVid : "generated", input.width, input.height, 
+         (double) input.clockHz / input.frameDeltaHz, input.numFrames);
+  }
+
+  for(idx = 0; rc == 0 && idx < numConfigs; idx++) {
+
+    memset(pXcode, 0, sizeof(IXCODE_CTXT_T));
+    memset(&res, 0, sizeof(res));
+    pthread_mutex_init(&pXcode->vid.overlay.mtx, NULL);
+    pXcode->vid.common.pIpc = pXcode->aud.common.pIpc = pIpc;
+
+    if(xcode_parse_configstr(strxcodes[idx], pXcode, 1, 1) < 0) {
+      bench_write_result(fp, strxcodes[idx], -1, pXcode, &input, &res);
+      numErrors++;
+    } else {
+
+      if((pXcode->vid.common.cfgDo_xcode && bench_run_vid(&pXcode->vid, &input, &res) < 0) ||
+         (pXcode->aud.common.cfgDo_xcode && bench_run_aud(&pXcode->aud, &input, &res) < 0)) {
+        bench_write_result(fp, strxcodes[idx], -1, pXcode, &input, &res);
+        numErrors++;
+      } else {
+        bench_write_result(fp, strxcodes[idx], 0, pXcode, &input, &res);
+      }
+    }
+
+    pthread_mutex_destroy(&pXcode->vid.overlay.mtx);
+  }
+
+#if defined(XCODE_IPC)
+  if(pIpc) {
+    xcode_ipc_close(pIpc);
+  }
+#endif // XCODE_IPC
+
+  if(pXcode) {
+    avc_free((void **) &pXcode);
+  }
+  if(fp && fp != stdout) {
+    fileops_Close(fp);
+  }
+  bench_input_free(&input);
+  conf_free(pConf);
+
+  return (rc == 0 && numErrors == 0) ? 0 : -1;
+}
@@ -39,6 +39,13 @@
 #include <sys/sem.h>
 #endif // WIN32
 
+#if defined(XCODE_IPC_HAVE_RING)
+#include <signal.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif // XCODE_IPC_HAVE_RING
+
 
 
 #if defined(WIN32)
@@ -189,6 +196,26 @@ XCODE_IPC_DESCR_T *xcode_ipc_open(unsigned int sz, key_t key) {
 
   pIpc->pmem->hdr.cmd = XCODE_IPC_CMD_NONE;
 
+#if defined(XCODE_IPC_HAVE_RING)
+  //
+  // Use the multi-slot ring if the server created one, otherwise fall back to the 
+  // single command region
+  //
+  if(buf.shm_segsz >= XCODE_IPC_MEM_RING_SZ &&
+     XCODE_IPC_RING_PTR(pIpc->pmem)->magic == XCODE_IPC_RING_MAGIC) {
+    __sync_synchronize();
+    if(XCODE_IPC_RING_PTR(pIpc->pmem)->version == XCODE_IPC_RING_VERSION &&
+       XCODE_IPC_RING_PTR(pIpc->pmem)->sz == XCODE_IPC_RING_SZ) {
+      pIpc->pRing = XCODE_IPC_RING_PTR(pIpc->pmem);
+    } else {
+      LOG(X_WARNING("xcode ipc ring version %d size %u not supported"), 
+                    XCODE_IPC_RING_PTR(pIpc->pmem)->version, XCODE_IPC_RING_PTR(pIpc->pmem)->sz);
+    }
+  }
+#endif // XCODE_IPC_HAVE_RING
+
+  LOG(X_DEBUG("xcode ipc using %s"), pIpc->pRing ? "multi-slot ring" : "single command region");
+
   //fprintf(stderr, "init ipc ok\n");
 
   return pIpc;
@@ -224,10 +251,294 @@ void xcode_ipc_close(XCODE_IPC_DESCR_T *pIpc) {
 
 #endif // WIN32
 
+#if defined(XCODE_IPC_HAVE_RING)
+
+static int ring_futex(volatile int *paddr, int op, int val, const struct timespec *pts) {
+  return syscall(SYS_futex, (int *) paddr, op, val, pts, NULL, 0);
+}
+
+static void ring_event_signal(XCODE_IPC_EVENT_T *pEv) {
+  __sync_fetch_and_add(&pEv->seq, 1);
+  if(pEv->waiters > 0) {
+    ring_futex(&pEv->seq, FUTEX_WAKE, INT_MAX, NULL);
+  }
+}
+
+//
+// Sleeps until pEv is signalled after seq was sampled.  The caller must sample seq before
+// checking its wait condition.  Returns 1 on timeout.
+//
+static int ring_event_wait(XCODE_IPC_EVENT_T *pEv, int seq, unsigned int ms) {
+  struct timespec ts;
+  int rc;
+
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (ms % 1000) * 1000000;
+
+  __sync_fetch_and_add(&pEv->waiters, 1);
+  rc = ring_futex(&pEv->seq, FUTEX_WAIT, seq, &ts);
+  __sync_fetch_and_sub(&pEv->waiters, 1);
+
+  return (rc == -1 && errno == ETIMEDOUT) ? 1 : 0;
+}
+
+static int ring_server_alive(XCODE_IPC_RING_T *pRing) {
+  if(pRing->srvExited) {
+    return 0;
+  } else if(kill(pRing->srvPid, 0) != 0 && errno == ESRCH) {
+    LOG(X_ERROR("xcode ipc server pid %d is no longer running"), pRing->srvPid);
+    pRing->srvExited = 1;
+    return 0;
+  }
+  return 1;
+}
+
+//
+// Takes a ticket on the channel and waits until the slot it maps to has been released 
+// by the previous owner.  The slot is claimed by recording the caller's pid, which lets the 
+// server reclaim it should this process exit without releasing it.  The server also skips a
+// ticket which is never claimed, in which case the turn of the slot has moved past it.
+//
+static XCODE_IPC_RING_SLOT_T *ring_slot_acquire(XCODE_IPC_RING_T *pRing,
+                                                XCODE_IPC_RING_CHAN_T *pChan) {
+  XCODE_IPC_RING_SLOT_T *pSlot;
+  unsigned int ticket;
+  int pid = getpid();
+  int seq;
+
+  if(pRing->srvExited) {
+    return NULL;
+  }
+
+  ticket = __sync_fetch_and_add(&pChan->submitSeq, 1);
+  pSlot = &pChan->slots[ticket & (XCODE_IPC_RING_SLOTS - 1)];
+
+  while(1) {
+    seq = pChan->evCli.seq;
+    __sync_synchronize();
+    if(pSlot->turn == ticket && __sync_bool_compare_and_swap(&pSlot->ownerPid, 0, pid)) {
+      if(pSlot->turn == ticket) {
+        break;
+      }
+      pSlot->ownerPid = 0;
+      ring_event_signal(&pChan->evCli);
+    }
+    if((int) (pSlot->turn - ticket) > 0) {
+      LOG(X_ERROR("xcode ipc ring ticket %u was reclaimed by the server"), ticket);
+      return NULL;
+    }
+    if(ring_event_wait(&pChan->evCli, seq, XCODE_IPC_RING_WAIT_MS) && !ring_server_alive(pRing)) {
+      return NULL;
+    }
+  }
+
+  __sync_synchronize();
+
+  return pSlot;
+}
+
+static int ring_slot_exec(XCODE_IPC_RING_T *pRing, XCODE_IPC_RING_CHAN_T *pChan,
+                          XCODE_IPC_RING_SLOT_T *pSlot, enum XCODE_IPC_CMD cmd) {
+  int seq;
+
+  pSlot->cmd = cmd;
+  pSlot->cmdrc = IXCODE_RC_ERROR;
+  __sync_synchronize();
+  pSlot->state = XCODE_IPC_SLOT_SUBMITTED;
+  ring_event_signal(&pChan->evSrv);
+
+  while(1) {
+    seq = pChan->evCli.seq;
+    __sync_synchronize();
+    if(pSlot->state == XCODE_IPC_SLOT_DONE) {
+      break;
+    }
+    if(ring_event_wait(&pChan->evCli, seq, XCODE_IPC_RING_WAIT_MS) && !ring_server_alive(pRing)) {
+      LOG(X_ERROR("ipc ring cmd: %d not completed"), cmd);
+      return -1;
+    }
+  }
+
+  __sync_synchronize();
+
+  return pSlot->cmdrc;
+}
+
+static void ring_slot_release(XCODE_IPC_RING_CHAN_T *pChan, XCODE_IPC_RING_SLOT_T *pSlot) {
+  pSlot->state = XCODE_IPC_SLOT_FREE;
+  pSlot->ownerPid = 0;
+  __sync_fetch_and_add(&pSlot->turn, XCODE_IPC_RING_SLOTS);
+  ring_event_signal(&pChan->evCli);
+}
+
+static int xcode_call_ring(XCODE_IPC_DESCR_T *pIpc, enum XCODE_IPC_CHAN chanIdx,
+                           enum XCODE_IPC_CMD cmd) {
+  XCODE_IPC_RING_CHAN_T *pChan = &pIpc->pRing->chans[chanIdx];
+  XCODE_IPC_RING_SLOT_T *pSlot;
+  int rc;
+
+  if(!(pSlot = ring_slot_acquire(pIpc->pRing, pChan))) {
+    return -1;
+  }
+
+  pSlot->lenIn = 0;
+  pSlot->offsetOut = 0;
+
+  rc = ring_slot_exec(pIpc->pRing, pChan, pSlot, cmd);
+
+  if(pSlot->state == XCODE_IPC_SLOT_DONE) {
+    ring_slot_release(pChan, pSlot);
+  }
+
+  return rc;
+}
+
+static void ring_params_set(XCODE_IPC_FRAME_PARAMS_T *pParams, const IXCODE_COMMON_CTXT_T *pCommon) {
+  pParams->inpts90Khz = pCommon->inpts90Khz;
+  pParams->outpts90Khz = pCommon->outpts90Khz;
+  pParams->decodeInIdx = pCommon->decodeInIdx;
+  pParams->decodeOutIdx = pCommon->decodeOutIdx;
+  pParams->encodeInIdx = pCommon->encodeInIdx;
+  pParams->encodeOutIdx = pCommon->encodeOutIdx;
+}
+
+static void ring_params_get(IXCODE_COMMON_CTXT_T *pCommon, const XCODE_IPC_FRAME_PARAMS_T *pParams) {
+  pCommon->inpts90Khz = pParams->inpts90Khz;
+  pCommon->outpts90Khz = pParams->outpts90Khz;
+  pCommon->decodeInIdx = pParams->decodeInIdx;
+  pCommon->decodeOutIdx = pParams->decodeOutIdx;
+  pCommon->encodeInIdx = pParams->encodeInIdx;
+  pCommon->encodeOutIdx = pParams->encodeOutIdx;
+  pCommon->stageStats = pParams->stageStats;
+}
+
+static int xcode_frame_vid_ring(XCODE_IPC_DESCR_T *pIpc, IXCODE_VIDEO_CTXT_T *pIn, 
+                                unsigned char *bufIn, unsigned int lenIn,
+                                unsigned char *bufOut, unsigned int lenOut) {
+  XCODE_IPC_RING_CHAN_T *pChan = &pIpc->pRing->chans[XCODE_IPC_CHAN_VID];
+  XCODE_IPC_RING_SLOT_T *pSlot;
+  unsigned int lenCopied;
+  int rc;
+
+  if(!(pSlot = ring_slot_acquire(pIpc->pRing, pChan))) {
+    return -1;
+  }
+
+  ring_params_set(&pSlot->params, &pIn->common);
+  pSlot->params.cfgForceIDR = pIn->out[0].cfgForceIDR;
+  pSlot->params.qTot = pIn->out[0].qTot;
+  pSlot->params.qSamples = pIn->out[0].qSamples;
+  pSlot->params.pts = pIn->out[0].pts;
+  pSlot->params.dts = pIn->out[0].dts;
+
+  if((lenCopied = lenIn) > pSlot->dataSz) {
+    lenCopied = pSlot->dataSz;
+    LOG(X_WARNING("Video frame length to be decoded truncated from %d to %d"), lenIn, lenCopied);
+  }
+  if(bufIn) {
+    memcpy(XCODE_IPC_RING_DATA(pIpc->pRing, pSlot), bufIn, lenCopied);
+  }
+  pSlot->lenIn = lenCopied;
+  pSlot->offsetOut = 0;
+
+  if((rc = ring_slot_exec(pIpc->pRing, pChan, pSlot, XCODE_IPC_CMD_ENCODE_VID)) != -1) {
+    ring_params_get(&pIn->common, &pSlot->params);
+    pIn->out[0].qTot = pSlot->params.qTot;
+    pIn->out[0].qSamples = pSlot->params.qSamples;
+    pIn->out[0].frameType = pSlot->params.frameType;
+    pIn->out[0].governor.level = pSlot->params.governorLevel;
+    pIn->out[0].pts = pSlot->params.pts;
+    pIn->out[0].dts = pSlot->params.dts;
+
+    if((lenCopied = rc) > pSlot->dataSz) {
+      lenCopied = pSlot->dataSz;
+      LOG(X_WARNING("Encoded video frame length truncated from %d to %d"), rc, lenCopied);
+      rc = lenCopied;
+    } else if(lenCopied > lenOut) {
+      lenCopied = lenOut;
+      LOG(X_WARNING("Encoded video frame length truncated from %d to %d"), rc, lenCopied);
+      rc = lenCopied;
+    }
+    memcpy(bufOut, XCODE_IPC_RING_DATA(pIpc->pRing, pSlot), lenCopied);
+  }
+
+  if(pSlot->state == XCODE_IPC_SLOT_DONE) {
+    ring_slot_release(pChan, pSlot);
+  }
+
+  return rc;
+}
+
+static int xcode_frame_aud_ring(XCODE_IPC_DESCR_T *pIpc, IXCODE_AUDIO_CTXT_T *pIn, 
+                                unsigned char *bufIn, unsigned int lenIn,
+                                unsigned char *bufOut, unsigned int lenOut) {
+  XCODE_IPC_RING_CHAN_T *pChan = &pIpc->pRing->chans[XCODE_IPC_CHAN_AUD];
+  XCODE_IPC_RING_SLOT_T *pSlot;
+  int rc, rcorig;
+
+  if(lenIn >= XCODE_IPC_RING_SLOTSZ_AUD) {
+    LOG(X_ERROR("shared mem ring slot size %d too small for %d"), XCODE_IPC_RING_SLOTSZ_AUD, lenIn); 
+    return -1;
+  }
+
+  if(!(pSlot = ring_slot_acquire(pIpc->pRing, pChan))) {
+    return -1;
+  }
+
+  ring_params_set(&pSlot->params, &pIn->common);
+  pSlot->params.pts = pIn->pts;
+
+  if(bufIn) {
+    memcpy(XCODE_IPC_RING_DATA(pIpc->pRing, pSlot), bufIn, lenIn);
+  }
+  pSlot->lenIn = lenIn;
+  pSlot->offsetOut = lenIn;
+
+  if((rc = rcorig = ring_slot_exec(pIpc->pRing, pChan, pSlot, XCODE_IPC_CMD_ENCODE_AUD)) != -1) {
+    ring_params_get(&pIn->common, &pSlot->params);
+    pIn->pts = pSlot->params.pts;
+
+    if(rcorig > (int) (pSlot->dataSz - lenIn)) {
+      rc = pSlot->dataSz - lenIn;
+      LOG(X_WARNING("Encoded audio frame length truncated from %d to %d"), rcorig, rc);
+    } else if(rc > (int) lenOut) {
+      rc = lenOut;
+      LOG(X_WARNING("Encoded audio frame length truncated from %d to %d"), rcorig, rc);
+    }
+    if(rc > 0) {
+      memcpy(bufOut, XCODE_IPC_RING_DATA(pIpc->pRing, pSlot) + lenIn, rc);
+    }
+  }
+
+  if(pSlot->state == XCODE_IPC_SLOT_DONE) {
+    ring_slot_release(pChan, pSlot);
+  }
+
+  return rc;
+}
+
+#endif // XCODE_IPC_HAVE_RING
+
+static IXCODE_CTXT_T *xcode_ipc_ctxt(XCODE_IPC_DESCR_T *pIpc, enum XCODE_IPC_CHAN chanIdx) {
+#if defined(XCODE_IPC_HAVE_RING)
+  if(pIpc->pRing) {
+    return &pIpc->pRing->chans[chanIdx].ctxt;
+  }
+#endif // XCODE_IPC_HAVE_RING
+  return &pIpc->pmem->hdr.ctxt;
+}
+
 static int xcode_call_ipc(XCODE_IPC_DESCR_T *pIpc,
                           enum XCODE_IPC_CMD cmd) {
   int rc = 0;
 
+#if defined(XCODE_IPC_HAVE_RING)
+  if(pIpc->pRing) {
+    return xcode_call_ring(pIpc, (cmd == XCODE_IPC_CMD_INIT_AUD || cmd == XCODE_IPC_CMD_CLOSE_AUD) ? 
+                           XCODE_IPC_CHAN_AUD : XCODE_IPC_CHAN_VID, cmd);
+  }
+#endif // XCODE_IPC_HAVE_RING
+
   pIpc->pmem->hdr.cmd = cmd;
 
   //fprintf(stderr, "ipc call cmd: %d\n", cmd);
@@ -271,13 +582,14 @@ int xcode_init_vid(IXCODE_VIDEO_CTXT_T *pIn) {
     return -1;
   }
 
-  pXcode = &((XCODE_IPC_DESCR_T *) pIn->common.pIpc)->pmem->hdr.ctxt;
+  pXcode = xcode_ipc_ctxt(pIn->common.pIpc, XCODE_IPC_CHAN_VID);
   pXcodeV = &pXcode->vid;
 
   pXcodeV->common.cfgFileTypeIn = pIn->common.cfgFileTypeIn;
   pXcodeV->common.cfgFileTypeOut = pIn->common.cfgFileTypeOut;
   pXcodeV->common.cfgVerbosity = pIn->common.cfgVerbosity;
   pXcodeV->common.cfgFlags = pIn->common.cfgFlags;
+  pXcodeV->common.cfgStageStats = pIn->common.cfgStageStats;
   pXcodeV->inH = pIn->inH;
   pXcodeV->inV = pIn->inV;
   pXcodeV->out[0].resOutH = pIn->out[0].resOutH;
@@ -286,8 +598,8 @@ int xcode_init_vid(IXCODE_VIDEO_CTXT_T *pIn) {
   pXcodeV->resOutClockHz = pIn->resOutClockHz;
   pXcodeV->resOutFrameDeltaHz = pIn->resOutFrameDeltaHz;
   pXcodeV->out[0].resLookaheadmin1 = pIn->out[0].resLookaheadmin1;
-  pXcodeV->out[0].rate.cfgBitRateOut = pIn->out[0].rate.cfgBitRateOut;
-  pXcodeV->out[0].rate.cfgBitRateTolOut = pIn->out[0].rate.cfgBitRateTolOut;
+  pXcodeV->out[0].cfgBitRateOut = pIn->out[0].cfgBitRateOut;
+  pXcodeV->out[0].cfgBitRateTolOut = pIn->out[0].cfgBitRateTolOut;
   pXcodeV->out[0].cfgMaxSliceSz = pIn->out[0].cfgMaxSliceSz;
   pXcodeV->out[0].cfgThreads = pIn->out[0].cfgThreads;
   pXcodeV->out[0].cfgFast = pIn->out[0].cfgFast;
@@ -305,9 +617,11 @@ int xcode_init_vid(IXCODE_VIDEO_CTXT_T *pIn) {
   pXcodeV->out[0].cfgGopMinMs = pIn->out[0].cfgGopMinMs;
   pXcodeV->out[0].cfgScaler = pIn->out[0].cfgScaler;
   pXcodeV->out[0].cfgSceneCut = pIn->out[0].cfgSceneCut;
+  pXcodeV->out[0].cfgGovernor = pIn->out[0].cfgGovernor;
   pXcodeV->inClockHz = pIn->inClockHz;
   pXcodeV->inFrameDeltaHz = pIn->inFrameDeltaHz;
   pXcodeV->usewatermark = pIn->usewatermark;
+  pXcodeV->cfgPipelineDepth = pIn->cfgPipelineDepth;
   if((pXcodeV->extradatasize = pIn->extradatasize) > sizeof(pXcodeV->extradata)) {
     return -1;
   }
@@ -340,13 +654,14 @@ int xcode_init_aud(IXCODE_AUDIO_CTXT_T *pIn) {
     return -1;
   }
 
-  pXcode = &((XCODE_IPC_DESCR_T *) pIn->common.pIpc)->pmem->hdr.ctxt;
+  pXcode = xcode_ipc_ctxt(pIn->common.pIpc, XCODE_IPC_CHAN_AUD);
   pXcodeA = &pXcode->aud;
 
   pXcodeA->common.cfgFileTypeIn = pIn->common.cfgFileTypeIn;
   pXcodeA->common.cfgFileTypeOut = pIn->common.cfgFileTypeOut;
   pXcodeA->cfgBitRateOut = pIn->cfgBitRateOut;
   pXcodeA->common.cfgVerbosity = pIn->common.cfgVerbosity;
+  pXcodeA->common.cfgStageStats = pIn->common.cfgStageStats;
   pXcodeA->cfgSampleRateIn = pIn->cfgSampleRateIn;
   pXcodeA->cfgSampleRateOut = pIn->cfgSampleRateOut;
   pXcodeA->cfgChannelsOut = pIn->cfgChannelsOut;
@@ -381,7 +696,7 @@ void xcode_close_vid(IXCODE_VIDEO_CTXT_T *pIn) {
     return;
   }
 
-  pXcode = &((XCODE_IPC_DESCR_T *) pIn->common.pIpc)->pmem->hdr.ctxt;
+  pXcode = xcode_ipc_ctxt(pIn->common.pIpc, XCODE_IPC_CHAN_VID);
   pXcodeV = &pXcode->vid;
 
   if((rc = xcode_call_ipc(pIn->common.pIpc, XCODE_IPC_CMD_CLOSE_VID)) == 0) {
@@ -420,6 +735,12 @@ int xcode_frame_vid(IXCODE_VIDEO_CTXT_T *pIn, unsigned char *bufIn, unsigned int
     return -1;
   }
 
+#if defined(XCODE_IPC_HAVE_RING)
+  if(((XCODE_IPC_DESCR_T *) pIn->common.pIpc)->pRing) {
+    return xcode_frame_vid_ring(pIn->common.pIpc, pIn, bufIn, lenIn, bufOut, lenOut);
+  }
+#endif // XCODE_IPC_HAVE_RING
+
   pMem = ((XCODE_IPC_DESCR_T *) pIn->common.pIpc)->pmem;
   pXcodeV = &pMem->hdr.ctxt.vid;
 
@@ -452,9 +773,11 @@ int xcode_frame_vid(IXCODE_VIDEO_CTXT_T *pIn, unsigned char *bufIn, unsigned int
     pIn->common.decodeOutIdx = pXcodeV->common.decodeOutIdx;
     pIn->common.encodeInIdx = pXcodeV->common.encodeInIdx;
     pIn->common.encodeOutIdx = pXcodeV->common.encodeOutIdx;
+    pIn->common.stageStats = pXcodeV->common.stageStats;
     pIn->out[0].qTot = pXcodeV->out[0].qTot;
     pIn->out[0].qSamples = pXcodeV->out[0].qSamples;
     pIn->out[0].frameType = pXcodeV->out[0].frameType;
+    pIn->out[0].governor.level = pXcodeV->out[0].governor.level;
     pIn->out[0].pts = pXcodeV->out[0].pts;
     pIn->out[0].dts = pXcodeV->out[0].dts;
 
@@ -482,6 +805,12 @@ int xcode_frame_aud(IXCODE_AUDIO_CTXT_T *pIn, unsigned char *bufIn, unsigned int
     return -1;
   }
 
+#if defined(XCODE_IPC_HAVE_RING)
+  if(((XCODE_IPC_DESCR_T *) pIn->common.pIpc)->pRing) {
+    return xcode_frame_aud_ring(pIn->common.pIpc, pIn, bufIn, lenIn, bufOut, lenOut);
+  }
+#endif // XCODE_IPC_HAVE_RING
+
   pMem = ((XCODE_IPC_DESCR_T *) pIn->common.pIpc)->pmem;
   pXcodeA = &pMem->hdr.ctxt.aud;
 
@@ -516,6 +845,7 @@ int xcode_frame_aud(IXCODE_AUDIO_CTXT_T *pIn, unsigned char *bufIn, unsigned int
     pIn->common.decodeOutIdx = pXcodeA->common.decodeOutIdx;
     pIn->common.encodeInIdx = pXcodeA->common.encodeInIdx;
     pIn->common.encodeOutIdx = pXcodeA->common.encodeOutIdx;
+    pIn->common.stageStats = pXcodeA->common.stageStats;
     pIn->pts = pXcodeA->pts;
 
     if(rcorig > (int) (XCODE_IPC_MEM_DATASZ(pMem) - lenIn)) {
@@ -70,6 +70,9 @@ typedef enum XCODE_PARAM_ID {
   XCODE_PARAM_VIDEO_SLICESZMAX                ,
   XCODE_PARAM_VIDEO_THREADS_ENC               ,
   XCODE_PARAM_VIDEO_THREADS_DEC               ,
+  XCODE_PARAM_VIDEO_PIPELINE                  ,
+  XCODE_PARAM_VIDEO_GOVERNOR                  ,
+  XCODE_PARAM_VIDEO_THREADS_FILTER            ,
   XCODE_PARAM_VIDEO_UPSAMPLING                ,
   //XCODE_PARAM_VIDEO_NODECODE                  ,
   XCODE_PARAM_VIDEO_MBTREE                    ,
@@ -167,6 +170,9 @@ static struct XCODE_PARAM XCODE_PARAM_LIST[] = {
                   { XCODE_PARAM_VIDEO_SLICESZMAX,          "vslmax", "videoSliceSizeMax", NULL },
                   { XCODE_PARAM_VIDEO_THREADS_ENC ,        "vth", "videoThreads", "th" },
                   { XCODE_PARAM_VIDEO_THREADS_DEC ,        "vthd", "videoDecoderThreads", "thd" },
+                  { XCODE_PARAM_VIDEO_PIPELINE ,           "vpipe", "videoPipelineDepth", NULL },
+                  { XCODE_PARAM_VIDEO_GOVERNOR ,           "vgov", "videoEncoderGovernor", NULL },
+                  { XCODE_PARAM_VIDEO_THREADS_FILTER ,     "vthf", "videoFilterThreads", NULL },
                   { XCODE_PARAM_VIDEO_UPSAMPLING ,         "vup", "videoUpsampling", NULL },
                   //{ XCODE_PARAM_VIDEO_NODECODE ,         "vnd", "videoNoDecode", NULL },
                   { XCODE_PARAM_VIDEO_MBTREE ,             "mbtree", "mb-tree", "" },
@@ -485,6 +491,7 @@ static int parse_configstr_vid_general(IXCODE_VIDEO_CTXT_T *pV, const KEYVAL_PAI
   unsigned int ui1, ui2;
   unsigned int outidx;
   int passthru;
+  int threadsFilter;
 
   for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
 
@@ -630,6 +637,37 @@ static int parse_configstr_vid_general(IXCODE_VIDEO_CTXT_T *pV, const KEYVAL_PAI
     pV->cfgThreadsDec = atoi(p);
   }
 
+  if((p = conf_find_keyval2(kv, XCODE_PARAM_VIDEO_PIPELINE))) {
+    if((pV->cfgPipelineDepth = atoi(p)) > IXCODE_VIDEO_PIPELINE_MAX) {
+      LOG(X_WARNING("Video transcoder pipeline depth %d limited to %d"), 
+                    pV->cfgPipelineDepth, IXCODE_VIDEO_PIPELINE_MAX);
+      pV->cfgPipelineDepth = IXCODE_VIDEO_PIPELINE_MAX;
+    }
+  }
+
+  //
+  // Slice threads used by each of the unsharp, denoise, color and rotate filters.  Each filter
+  // context owns its own pool, so filters are single threaded unless explicitly configured.
+  //
+  if((p = conf_find_keyval2(kv, XCODE_PARAM_VIDEO_THREADS_FILTER))) {
+    threadsFilter = atoi(p);
+  } else {
+    threadsFilter = 1;
+  }
+  if(threadsFilter > IXCODE_FILTER_THREADS_MAX) {
+    LOG(X_WARNING("Video filter threads %d limited to %d"), threadsFilter, IXCODE_FILTER_THREADS_MAX);
+    threadsFilter = IXCODE_FILTER_THREADS_MAX;
+  } else if(threadsFilter <= 0) {
+    threadsFilter = 1;
+  }
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+    pV->out[outidx].unsharp.common.threads = threadsFilter;
+    pV->out[outidx].denoise.common.threads = threadsFilter;
+    pV->out[outidx].color.common.threads = threadsFilter;
+    pV->out[outidx].rotate.common.threads = threadsFilter;
+    pV->out[outidx].testFilter.common.threads = threadsFilter;
+  }
+
   //if((p = conf_find_keyval2(kv, XCODE_PARAM_VIDEO_NODECODE))) {
   //  pV->common.cfgNoDecode = atoi(p);
   //}
@@ -966,6 +1004,12 @@ static int parse_configstr_vid_encoder(IXCODE_VIDEO_CTXT_T *pV, const KEYVAL_PAI
       pV->out[outidx].cfgQCompress = pV->out[outidx - 1].cfgQCompress;
     }
 
+    if(rc == 0 && (p = conf_find_keyval_index2(kv, XCODE_PARAM_VIDEO_GOVERNOR, outidx))) {
+      pV->out[outidx].cfgGovernor = atoi(p);
+    } else if(outidx > 0) {
+      pV->out[outidx].cfgGovernor = pV->out[outidx - 1].cfgGovernor;
+    }
+
     if((p = conf_find_keyval2(kv, XCODE_PARAM_VIDEO_FPS_ABRMAX))) {
       fpsMax = atof(p);
       if(vid_convert_fps(fpsMax, &ui1, &ui2) == 0) {
@@ -1319,6 +1363,7 @@ void xcode_dump_conf_video(IXCODE_VIDEO_CTXT_T *pXcode, unsigned int outidx, int
 
   int resOutH, resOutV;
   char buf[2][64];
+  int len;
 
   if(pXcode->out[outidx].passthru) {
     LOG(logLevel, "video xcode[%d] pass-through\n", outidx);
@@ -1333,9 +1378,13 @@ void xcode_dump_conf_video(IXCODE_VIDEO_CTXT_T *pXcode, unsigned int outidx, int
   }
 
   if(pXcode->cfgThreadsDec > 0) {
-    snprintf(buf[1], sizeof(buf[1]), " (dec:%d)", pXcode->cfgThreadsDec);
+    len = snprintf(buf[1], sizeof(buf[1]), " (dec:%d)", pXcode->cfgThreadsDec);
   } else {
     buf[1][0] = '\0';
+    len = 0;
+  }
+  if(pXcode->cfgPipelineDepth > 1) {
+    snprintf(&buf[1][len], sizeof(buf[1]) - len, " (pipeline:%d)", pXcode->cfgPipelineDepth);
   }
 
   resOutH = pXcode->out[outidx].cfgOutH;
@@ -1737,6 +1786,7 @@ int xcode_parse_configstr(const char *pstr, IXCODE_CTXT_T *pXcode,
   pXcode->vid.out[0].cfgLookaheadmin1 |= XCODE_VID_LOOKAHEAD_AUTO_FLAG;
   pXcode->vid.out[0].cfgMBTree = -1;
   pXcode->vid.out[0].cfgQCompress = -1;
+  pXcode->vid.out[0].cfgGovernor = 1;
 
   pXcode->aud.common.cfgFileTypeIn = XC_CODEC_TYPE_UNKNOWN;
   pXcode->aud.common.cfgVerbosity = g_verbosity;
@@ -38,6 +38,11 @@
 
 #define IXCODE_COMPOUND_FRAMES_MAX        24
 
+//
+// Maximum number of frames queued in the pipelined video transcoder
+//
+#define IXCODE_VIDEO_PIPELINE_MAX         8
+
 typedef enum FRAME_TYPE {
   FRAME_TYPE_UNKNOWN    = 0,
   FRAME_TYPE_I          = 1,
@@ -74,6 +79,21 @@ typedef enum ENCODER_QUALITY {
 //
 //
 
+//
+// Per-stage wall clock accumulators populated when cfgStageStats is set.
+// For audio, the scale counters hold the resampler time.
+//
+typedef struct IXCODE_STAGE_STATS {
+  uint64_t                     usDecode;
+  uint64_t                     usScale;
+  uint64_t                     usFilter;
+  uint64_t                     usEncode;
+  unsigned int                 numDecode;
+  unsigned int                 numScale;
+  unsigned int                 numFilter;
+  unsigned int                 numEncode;
+} IXCODE_STAGE_STATS_T;
+
 typedef struct IXCODE_COMMON_CTXT {
   int                          cfgDo_xcode;
   int                          cfgNoDecode;      // used when swithching to sendonly (input on hold)
@@ -87,6 +107,7 @@ typedef struct IXCODE_COMMON_CTXT {
   XC_CODEC_TYPE_T              cfgFileTypeOut;
   int                          cfgVerbosity;
   int                          cfgFlags;
+  int                          cfgStageStats;     // accumulate per-stage timing into stageStats
 
   // Set by ixcode internally
   uint64_t                     inpts90Khz;
@@ -95,6 +116,7 @@ typedef struct IXCODE_COMMON_CTXT {
   unsigned int                 decodeOutIdx;     // count of frames from decoder
   unsigned int                 encodeInIdx;      // count of frames into encoder
   unsigned int                 encodeOutIdx;     // count of frames from encoder
+  IXCODE_STAGE_STATS_T         stageStats;
 
   void                        *pPrivData;         // private date managed internally by
                                                   // ixcode
@@ -130,6 +152,20 @@ typedef struct IXCODE_VIDEO_ABR {
 
 } IXCODE_VIDEO_ABR_T;
 
+//
+// Encoder speed governor state.  Level 0 is the configured encoder quality, each
+// higher level trades picture quality for encode speed, up to IXCODE_GOVERNOR_LEVEL_MAX.
+//
+#define IXCODE_GOVERNOR_LEVEL_MAX      4
+
+typedef struct IXCODE_VIDEO_GOVERNOR {
+  int                          active;        // encoder supports speed adaptation
+  int                          level;
+  unsigned int                 numAdapt;
+  unsigned int                 usEncodeAvg;   // average encode time of the last window
+  uint64_t                     usEncodeTot;
+  unsigned int                 numEncode;
+} IXCODE_VIDEO_GOVERNOR_T;
 
 typedef struct IXCODE_VIDEO_OUT {
   int                          active;
@@ -173,6 +209,7 @@ typedef struct IXCODE_VIDEO_OUT {
                                                    // x > 1, # of fo lookahead frames 
   int                          cfgMBTree;
   float                        cfgQCompress;
+  int                          cfgGovernor;   // adapt encoder speed to keep up with real time
 
   IXCODE_VIDEO_CROP_T          crop;
   IXCODE_FILTER_UNSHARP_T      unsharp;
@@ -201,6 +238,7 @@ typedef struct IXCODE_VIDEO_OUT {
   int64_t                      dts;
   unsigned char                hdr[256];
   unsigned int                 hdrLen;
+  IXCODE_VIDEO_GOVERNOR_T      governor;
 
 } IXCODE_VIDEO_OUT_T;
 
@@ -212,6 +250,8 @@ typedef struct IXCODE_VIDEO_CTXT {
   unsigned int                 cfgOutClockHz;
   unsigned int                 cfgOutFrameDeltaHz;
   int                          cfgThreadsDec;
+  int                          cfgPipelineDepth;   // > 1 to run decode, scale and encode
+                                                   // as pipelined stages on separate threads
   unsigned int                 inClockHz;
   unsigned int                 inFrameDeltaHz;
   int                          usewatermark;
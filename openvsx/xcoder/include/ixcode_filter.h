@@ -29,8 +29,11 @@ typedef void (* FUNC_FILTER_FREE) (void *);
 typedef int (* FUNC_FILTER_EXEC) (void *, const unsigned char *[4], const int *, unsigned char *[4],  \
                                   const int *, unsigned int, unsigned int);
 
+#define IXCODE_FILTER_THREADS_MAX            16
+
 typedef struct FILTER_COMMON {
   int                          active;
+  int                          threads;
 } FILTER_COMMON_T;
 
 typedef struct FILTER_UNSHARP_PLANE {
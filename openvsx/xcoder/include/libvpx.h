@@ -63,8 +63,14 @@ typedef struct _VP8Context {
     int crf;
     int is_init;
 
+    int speed_level;     // encoder governor speed level, 0 for configured values
+    int cpu_used_base;
+    int deadline_base;
+
 } VP8Context;
 
+int vp8ext_set_speed(AVCodecContext *avctx, int level);
+
 
 #endif // ENABLE_XCODE
 
@@ -45,6 +45,8 @@ typedef struct AUDIO_PREPROC {
   u_int64_t                    tsHz;            // timestamp of first sample within the buffer
   unsigned char               *vad_buffer;      // buffer storing VAD value of each chunkHz duration
                                                 // of samples relative to MIXER_SOURCE::samplesWrIdx
+  uint16_t                    *energy_buffer;   // RMS level of each preprocessed chunkHz duration
+                                                // of samples, indexed the same as vad_buffer
   unsigned int                 cfg_vad_persist; // VAD flag will be persisted up to this value
                                                 // after the last VAD samples chunk was set (deprecated)
   unsigned int                 vad_persist;     // running counter of the current VAD persistance (deprecated)
@@ -66,6 +68,8 @@ void audio_preproc_free(AUDIO_PREPROC_T *pPreproc);
 
 int audio_preproc_exec(AUDIO_PREPROC_T *pPreproc, int16_t *samples, unsigned int sz);
 
+uint16_t audio_preproc_energy(const int16_t *samples, unsigned int sz);
+
 
 
 
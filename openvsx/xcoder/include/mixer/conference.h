@@ -32,6 +32,7 @@
 #include "mixer/participant.h"
 #include "mixer/mixer.h"
 #include "mixer/configfile.h"
+#include "mixer/enccache.h"
 #include "mixer/util.h"
 //#include "ntp_query.h"
 
@@ -58,7 +59,15 @@ typedef struct AUDIO_CONFERENCE {
   pthread_t                   ptdMixer;
   pthread_cond_t              condOutput;
   pthread_mutex_t             mtxOutput;
+  TIME_STAMP_T                tmOffsetFromStartHz;
+  unsigned int                resetThresholdHz;
+  uint64_t                    tsHzProduced;
+  int                         scheduled;         // run by the shared mixer scheduler
+  ENC_CACHE_T                *pEncCache;         // encoded output shared by participants hearing the same mix
 } AUDIO_CONFERENCE_T;
 
+void conference_mix_start(AUDIO_CONFERENCE_T *pConference);
+int conference_mix_step(AUDIO_CONFERENCE_T *pConference);
+
 
 #endif // __CONFERENCE_H__
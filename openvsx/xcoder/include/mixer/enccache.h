@@ -0,0 +1,108 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#ifndef __ENC_CACHE_H__
+#define __ENC_CACHE_H__
+
+#include <pthread.h>
+#include "mixer/mixdefaults.h"
+#include "mixer/util.h"
+#include "mixer/mixer_api.h"
+
+#define ENC_CACHE_ENTRIES            (MAX_PARTICIPANTS * 2)
+#define ENC_CACHE_FRAME_MAX          4096
+
+//
+// Time a participant waits for another participant to finish encoding a frame it wants
+// to share before it encodes the frame itself
+//
+#define ENC_CACHE_CLAIM_WAIT_MS      20
+
+typedef enum ENC_CACHE_STATE {
+  ENC_CACHE_STATE_FREE         = 0,
+  ENC_CACHE_STATE_INFLIGHT     = 1,  // claimed by a participant which is encoding the frame
+  ENC_CACHE_STATE_VALID        = 2,
+} ENC_CACHE_STATE_T;
+
+typedef struct ENC_CACHE_ENTRY {
+  ENC_CACHE_STATE_T           state;
+  unsigned int                gen;          // claim generation
+  uint64_t                    sig;          // mix signature of the encoded samples
+  uint64_t                    tsHz;         // mixer timestamp of the first encoded sample
+  MIXER_ENCODED_KEY_T         key;
+  int                         len;
+  unsigned char               data[ENC_CACHE_FRAME_MAX];
+} ENC_CACHE_ENTRY_T;
+
+//
+// Per conference cache of recently encoded frames, shared by participants which hear the
+// same mix with the same encoder configuration
+//
+typedef struct ENC_CACHE {
+  pthread_mutex_t             mtx;
+  pthread_cond_t              cond;
+  unsigned int                idxWr;
+  unsigned int                gen;
+  ENC_CACHE_ENTRY_T           entries[ENC_CACHE_ENTRIES];
+} ENC_CACHE_T;
+
+ENC_CACHE_T *enccache_create();
+void enccache_free(ENC_CACHE_T *pCache);
+
+/**
+ *
+ * enccache_claim
+ *
+ * Looks up an encoded frame.  If another participant is still encoding the frame the
+ * call waits for it.  If no participant has encoded the frame the caller is given the
+ * claim to encode it.
+ *
+ * @return - The length of the encoded frame copied to pData, MIXER_ENCODED_CLAIMED if the
+ *           caller must encode the frame and call enccache_store, or -1 if the caller should
+ *           encode the frame without storing it.
+ *
+ */
+int enccache_claim(ENC_CACHE_T *pCache,
+                   const MIXER_ENCODED_KEY_T *pKey,
+                   uint64_t sig,
+                   uint64_t tsHz,
+                   unsigned char *pData,
+                   unsigned int len);
+
+/**
+ *
+ * enccache_store
+ *
+ * Stores the frame encoded after a successful enccache_claim.  A negative len releases 
+ * the claim so that waiting participants encode the frame themselves.
+ *
+ */
+void enccache_store(ENC_CACHE_T *pCache,
+                    const MIXER_ENCODED_KEY_T *pKey,
+                    uint64_t sig,
+                    uint64_t tsHz,
+                    const unsigned char *pData,
+                    int len);
+
+#endif // __ENC_CACHE_H__
@@ -37,6 +37,8 @@
 
 #define MIXER_LATE_THRESHOLD_MS     80
 
+#define MIXER_SPEAKER_HOLD_MS       600
+
 #define MIXER_CONFIG_PATH           "etc/mixer.conf"
 
 #define RTP_PAYLOAD_MTU_SILK        1400
@@ -42,6 +42,9 @@ typedef struct MIXER_OUTPUT {
   unsigned int                 vad_bufsz;
   unsigned char               *vad_buffer; 
   int                          priorVadIdx;
+  unsigned int                 sig_bufsz;
+  uint64_t                    *sig_buffer;   // mix signature of each chunkHz duration of output samples.
+                                             // Outputs with equal signatures have identical samples.
 } MIXER_OUTPUT_T;
 
 typedef struct MIXER_SOURCE {
@@ -63,6 +66,10 @@ typedef struct MIXER_SOURCE {
   //int                          setOutputVad;
   int                          acceptInputVad;
   int64_t                      thresholdHz;
+  float                        speechEnergy; // smoothed VAD gated RMS level used for speaker selection
+  int                          isSpeaker;    // source is one of the top N mixed speakers
+  u_int64_t                    speakerHoldTsHz; // speaker status is held until this time 
+  uint64_t                     sig;          // mix signature term of this source
 } MIXER_SOURCE_T;
 
 
@@ -76,6 +83,9 @@ typedef struct MIXER {
                                              // empty samples are substituted
   int64_t                      idleSourceThresholdHz;
   unsigned int                 outChunkHz;   // output chunk size of the mixer
+  unsigned int                 maxSpeakers;  // if > 0 only the top N active speakers are mixed
+  int64_t                      speakerHoldHz; // minimum duration a selected speaker remains selected
+  unsigned int                 numSigOutputs; // sources with an output mix signature buffer
   pthread_mutex_t              mtx;
 } MIXER_T;
 
@@ -126,6 +136,18 @@ MIXER_SOURCE_T *mixer_source_init(LOG_CTXT_T *logCtxt,
  */
 void mixer_source_free(MIXER_SOURCE_T *pSource);
 
+/**
+ *
+ * mixer_source_init_sig
+ *
+ * Enables recording of the mix signature of the output samples of an audio source.  
+ * Should be called prior to mixer_addsource.
+ *
+ * pSource - the audio source returned from a call to mixer_source_init.
+ *
+ */
+int mixer_source_init_sig(MIXER_SOURCE_T *pSource);
+
 /**
  *
  * mixer_init
@@ -144,6 +166,24 @@ MIXER_T *mixer_init(LOG_CTXT_T *logCtxt,
                     unsigned int thresholdHz,
                     unsigned int outChunkHz);
 
+/**
+ *
+ * mixer_set_speakers
+ *
+ * Enables active speaker selection.  Each source's smoothed speech energy is tracked from the
+ * preprocessor output and only the top maxSpeakers sources are mixed.  Every listener which is
+ * not itself a selected speaker receives the same common mix, so the mixing cost is linear in
+ * the number of sources.
+ *
+ * pMixer - the mixer instance returned from a call to mixer_init.
+ * maxSpeakers - the maximum number of simultaneously mixed speakers.  0 mixes all sources.
+ * holdHz - the minimum duration in Hz that a newly selected speaker remains selected.
+ *
+ */
+int mixer_set_speakers(MIXER_T *pMixer,
+                       unsigned int maxSpeakers,
+                       unsigned int holdHz);
+
 /**
  *
  * mixer_free
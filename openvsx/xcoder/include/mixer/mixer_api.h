@@ -132,6 +132,8 @@ typedef struct PARTICIPANT_INPUT_TYPE {
 
 typedef struct PARTICIPANT_OUTPUT_TYPE {
   PARTICIPANT_TYPE_T                     type;
+  int                                    shareEncoded;  // share encoded frames with participants 
+                                                        // hearing the same mix
 
   union {
     PARTICIPANT_OUTPUT_TYPE_RTP_PCM_T    rtpPcm;
@@ -170,6 +172,9 @@ typedef struct MIXER_CONFIG {
   int                         mixerLateThresholdMs;
   int                         highPriority;
   int                         enableNtp;
+  int                         schedulerWorkers;  // > 0 to run on the shared mixer scheduler
+  int                         maxSpeakers;       // > 0 to only mix the top N active speakers
+  int                         speakerHoldMs;     // active speaker hold time
 } MIXER_CONFIG_T;
 
 typedef struct PARTICIPANT_CONFIG {
@@ -179,6 +184,29 @@ typedef struct PARTICIPANT_CONFIG {
   AUDIO_CONFIG_T             *pAudioConfig;
 } PARTICIPANT_CONFIG_T;
 
+//
+// Mix signature of output samples which contain more than one distinct mix
+//
+#define MIXER_OUTPUT_SIG_NONE ((uint64_t) -1)
+
+//
+// Encoder configuration of a frame shared via mixer_encoded_claim.  Participants with equal
+// keys produce identical frames from identical samples.
+//
+typedef struct MIXER_ENCODED_KEY {
+  PARTICIPANT_TYPE_T          type;         // participant output type
+  int                         codec;
+  unsigned int                sampleRate;
+  unsigned int                channels;
+  unsigned int                bitRate;
+  unsigned int                complexity;
+  unsigned int                frameHz;
+  int                         param;        // codec specific parameter
+  int                         flags;        // codec specific output flags
+} MIXER_ENCODED_KEY_T;
+
+#define MIXER_ENCODED_CLAIMED           -2
+
 
 
 /**
@@ -300,13 +328,57 @@ void mixer_on_receive_audio_pcm(void *pContext,
  * numSamplesMax - maximum count of input samples to read.
  * pvad - Optional output parameter to store the computed VAD of the aggregate
  *        output samples.
+ * ptsHz - Optional output parameter to store the mixer timestamp of the first sample.
+ * psig - Optional output parameter to store the mix signature of the output samples,
+ *        or MIXER_OUTPUT_SIG_NONE.  Requires output.shareEncoded to be set in the
+ *        participant configuration.
  *
  */
 int mixer_read_audio_pcm(void *pContext,
                          int16_t *pcmSamples,
                          unsigned int numSamplesMin,
                          unsigned int numSamplesMax,
-                         int *pvad);
+                         int *pvad,
+                         u_int64_t *ptsHz,
+                         uint64_t *psig);
+
+/**
+ *
+ * mixer_encoded_claim
+ * Used to share an encoded frame among participants hearing the same mix.  Only frames of
+ * stateless codecs, which depend solely on the samples of the frame, should be shared.
+ *
+ * @return - The length of the encoded frame copied to pData, MIXER_ENCODED_CLAIMED if 
+ *           the caller should encode the frame and pass it to mixer_encoded_store, or -1
+ *           if the caller should encode the frame on its own.
+ * pContext - The participant context instance returned by a call to participant_add.
+ * pKey - The encoder configuration.
+ * sig - The mix signature of the samples returned by mixer_read_audio_pcm.
+ * tsHz - The mixer timestamp of the first sample of the frame.
+ * pData - Output buffer of the encoded frame.
+ * len - Size of pData.
+ *
+ */
+int mixer_encoded_claim(void *pContext,
+                        const MIXER_ENCODED_KEY_T *pKey,
+                        uint64_t sig,
+                        u_int64_t tsHz,
+                        unsigned char *pData,
+                        unsigned int len);
+
+/**
+ *
+ * mixer_encoded_store
+ * Stores the frame encoded following a return of MIXER_ENCODED_CLAIMED from 
+ * mixer_encoded_claim.  len should be < 0 if the frame could not be encoded.
+ *
+ */
+void mixer_encoded_store(void *pContext,
+                         const MIXER_ENCODED_KEY_T *pKey,
+                         uint64_t sig,
+                         u_int64_t tsHz,
+                         const unsigned char *pData,
+                         int len);
 
 
 #if defined(MIXER_HAVE_NTP) && (MIXER_HAVE_NTP > 0)
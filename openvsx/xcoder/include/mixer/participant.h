@@ -92,8 +92,17 @@ typedef struct PARTICIPANT {
   unsigned int                audioFrameDurationHz;
   int16_t                    *pAudioBuf;
   unsigned int                audioBufIndexHz;
+#if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+  uint64_t                    audioBufSig;    // mix signature of pAudioBuf contents
+#endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+  unsigned int                framesEncoded;  // frames encoded and stored in the conference encoded cache
+  unsigned int                framesShared;   // frames sent using another participant's encoding
   WAV_FILE_T                 *pWavDecoded;
   WAV_FILE_T                 *pWavOutput;
+  unsigned int                outSamplesTot;
+  TIME_STAMP_T                tmOutputStart;
+  int                         schedReady;   // participant may be run by the mixer scheduler
+  int                         schedPending; // queued or running mixer scheduler tasks
   struct AUDIO_CONFERENCE    *pConference;
   struct PARTICIPANT         *pnext;
 } PARTICIPANT_T;
@@ -113,6 +122,12 @@ int participant_add_samples_to_mixer(PARTICIPANT_T *pParticipant,
                                      int vad,
                                      int *pvad);
 
+int participant_output_process(PARTICIPANT_T *pParticipant);
+
+#if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+int participant_unpack_pending(PARTICIPANT_T *pParticipant);
+#endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+
 #define PARTICIPANT_DESCRIPTION_BUFSZ 256
 
 const char *participant_description(const PARTICIPANT_CONFIG_T *pConfig, char *buffer, size_t sz);
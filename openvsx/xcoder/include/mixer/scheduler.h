@@ -0,0 +1,95 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#ifndef __MIXER_SCHEDULER_H__
+#define __MIXER_SCHEDULER_H__
+
+#include <pthread.h>
+#include "mixer/util.h"
+
+struct AUDIO_CONFERENCE;
+struct PARTICIPANT;
+
+#define MIXER_SCHEDULER_MAX_WORKERS         16
+#define MIXER_SCHEDULER_STATS_INTERVAL_MS   10000
+
+typedef struct MIXER_SCHEDULER_STATS {
+  uint64_t                    ticks;
+  uint64_t                    missedTicks;       // timer expirations coalesced into a later tick
+  uint64_t                    overruns;          // conference still busy with the previous tick
+  uint64_t                    jitterUsTot;       // tick wake-up latency past the scheduled deadline
+  unsigned int                jitterUsMax;
+  uint64_t                    procUsTot;         // tick start to last output task completion
+  unsigned int                procUsMax;
+  uint64_t                    numProc;
+} MIXER_SCHEDULER_STATS_T;
+
+/**
+ *
+ * mixer_scheduler_register
+ * Attaches a conference to the process wide mixer scheduler.  The scheduler, a single tick thread
+ * and a fixed pool of cfg.schedulerWorkers worker threads, is created on the first registration
+ * and shared by all conferences.  Each MIXER_CHUNKSZ_MS tick runs the participant unpack tasks, 
+ * the conference mix and the participant output tasks of every registered conference. 
+ *
+ * @return - 0 on success, < 0 on error
+ * pConference - the conference instance
+ *
+ */
+int mixer_scheduler_register(struct AUDIO_CONFERENCE *pConference);
+
+/**
+ *
+ * mixer_scheduler_unregister
+ * Detaches a conference from the mixer scheduler, waiting for any in-progress tick to complete.
+ * The scheduler threads are stopped when the last conference is unregistered.
+ *
+ * pConference - the conference instance
+ *
+ */
+void mixer_scheduler_unregister(struct AUDIO_CONFERENCE *pConference);
+
+/**
+ *
+ * mixer_scheduler_participant_wait
+ * Prevents any further scheduler tasks from being queued for the participant and waits for 
+ * any queued or running tasks to complete.
+ *
+ * pParticipant - the participant instance, already removed from the conference participant list
+ *
+ */
+void mixer_scheduler_participant_wait(struct PARTICIPANT *pParticipant);
+
+/**
+ *
+ * mixer_scheduler_get_stats
+ * Returns the tick statistics of the current measurement interval
+ *
+ * @return - 0 on success, < 0 if the scheduler is not running
+ * pStats - output statistics
+ *
+ */
+int mixer_scheduler_get_stats(MIXER_SCHEDULER_STATS_T *pStats);
+
+#endif // __MIXER_SCHEDULER_H__
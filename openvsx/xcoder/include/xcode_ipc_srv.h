@@ -36,8 +36,8 @@
 #endif // WIN32
 
 #define XCODE_IPC_SHMKEY		 0x00007700
-#define XCODE_IPC_MEM_SZ                 IXCODE_SZFRAME_MAX + \
-                                           sizeof(XCODE_IPC_MEM_HDR_T)
+#define XCODE_IPC_MEM_SZ                 (IXCODE_SZFRAME_MAX + \
+                                           sizeof(XCODE_IPC_MEM_HDR_T))
 
 #ifdef __linux__
 #define XCODE_IPC_SEM_NAME_SRV           "sem_xcodex_srv"
@@ -77,6 +77,109 @@ typedef struct XCODE_IPC_MEM {
   XCODE_IPC_MEM_HDR_T hdr;
 } XCODE_IPC_MEM_T;
 
+#if defined(__linux__)
+
+//
+// Multi-slot request ring placed in the same shared memory segment, directly after the 
+// legacy single command region.  Audio and video each use a separate channel so that 
+// requests of one media type are not serialized behind the other.  A client which finds 
+// no ring (older vsxxcode, or a non linux build) falls back to the legacy semaphore
+// handshake using XCODE_IPC_MEM_HDR_T.
+//
+#define XCODE_IPC_HAVE_RING              1
+
+#endif // __linux__
+
+#define XCODE_IPC_RING_MAGIC             0x78726e67
+#define XCODE_IPC_RING_VERSION           2
+#define XCODE_IPC_RING_SLOTS             4         // must be a power of 2
+#define XCODE_IPC_RING_SLOTSZ_VID        IXCODE_SZFRAME_MAX
+#define XCODE_IPC_RING_SLOTSZ_AUD        (IXCODE_SZFRAME_MAX / 4)
+#define XCODE_IPC_RING_WAIT_MS           1000
+#define XCODE_IPC_RING_RECLAIM_WAITS     5         // server waits before skipping an unclaimed ticket
+#define XCODE_IPC_RING_OWNER_RECLAIM     -1        // ownerPid while the server reclaims a slot
+
+enum XCODE_IPC_CHAN {
+  XCODE_IPC_CHAN_VID            = 0,
+  XCODE_IPC_CHAN_AUD            = 1,
+  XCODE_IPC_CHAN_MAX            = 2
+};
+
+enum XCODE_IPC_SLOT_STATE {
+  XCODE_IPC_SLOT_FREE           = 0,
+  XCODE_IPC_SLOT_SUBMITTED      = 1,
+  XCODE_IPC_SLOT_DONE           = 2
+};
+
+//
+// Futex backed event count.  A waiter samples seq, re-checks its condition and only then 
+// sleeps on seq.  A signaller bumps seq and only enters the kernel if there are waiters.
+//
+typedef struct XCODE_IPC_EVENT {
+  volatile int                 seq;
+  volatile int                 waiters;
+} XCODE_IPC_EVENT_T;
+
+//
+// Per frame parameters exchanged with each encode request, kept in the slot rather than 
+// the channel context so that several requests may be queued at once
+//
+typedef struct XCODE_IPC_FRAME_PARAMS {
+  uint64_t                     inpts90Khz;
+  uint64_t                     outpts90Khz;
+  unsigned int                 decodeInIdx;
+  unsigned int                 decodeOutIdx;
+  unsigned int                 encodeInIdx;
+  unsigned int                 encodeOutIdx;
+  int64_t                      pts;
+  int64_t                      dts;
+  int                          cfgForceIDR;
+  float                        qTot;
+  int                          qSamples;
+  FRAME_TYPE_T                 frameType;
+  int                          governorLevel;
+  IXCODE_STAGE_STATS_T         stageStats;
+} XCODE_IPC_FRAME_PARAMS_T;
+
+typedef struct XCODE_IPC_RING_SLOT {
+  volatile int                 state;        // enum XCODE_IPC_SLOT_STATE
+  volatile unsigned int        turn;         // ticket allowed to use the slot next
+  volatile int                 ownerPid;     // client holding the slot, 0 if not claimed
+  enum XCODE_IPC_CMD           cmd;
+  int                          cmdrc;
+  unsigned int                 lenIn;
+  unsigned int                 offsetOut;
+  XCODE_IPC_FRAME_PARAMS_T     params;
+  unsigned int                 dataOffset;   // offset of slot data from XCODE_IPC_RING_T
+  unsigned int                 dataSz;
+} XCODE_IPC_RING_SLOT_T;
+
+typedef struct XCODE_IPC_RING_CHAN {
+  volatile unsigned int        submitSeq;    // next ticket handed to a client
+  volatile unsigned int        serveSeq;     // next ticket executed by the server
+  XCODE_IPC_EVENT_T            evSrv;        // signalled on submission
+  XCODE_IPC_EVENT_T            evCli;        // signalled on completion and slot release
+  IXCODE_CTXT_T                ctxt;
+  XCODE_IPC_RING_SLOT_T        slots[XCODE_IPC_RING_SLOTS];
+} XCODE_IPC_RING_CHAN_T;
+
+typedef struct XCODE_IPC_RING {
+  volatile uint32_t            magic;        // set last by the server once initialized
+  uint32_t                     version;
+  int                          srvPid;
+  volatile int                 srvExited;    // set by a client which found srvPid gone
+  unsigned int                 sz;
+  XCODE_IPC_RING_CHAN_T        chans[XCODE_IPC_CHAN_MAX];
+} XCODE_IPC_RING_T;
+
+#define XCODE_IPC_RING_OFFSET      (((XCODE_IPC_MEM_SZ) + 63) & ~63)
+#define XCODE_IPC_RING_HDRSZ       ((sizeof(XCODE_IPC_RING_T) + 63) & ~63)
+#define XCODE_IPC_RING_SZ          (XCODE_IPC_RING_HDRSZ + XCODE_IPC_RING_SLOTS * \
+                                    (XCODE_IPC_RING_SLOTSZ_VID + XCODE_IPC_RING_SLOTSZ_AUD))
+#define XCODE_IPC_MEM_RING_SZ      (XCODE_IPC_RING_OFFSET + XCODE_IPC_RING_SZ)
+#define XCODE_IPC_RING_PTR(p)      ((XCODE_IPC_RING_T *) ((unsigned char *) (p) + XCODE_IPC_RING_OFFSET))
+#define XCODE_IPC_RING_DATA(r, s)  ((unsigned char *) (r) + (s)->dataOffset)
+
 
 typedef struct XCODE_IPC_DESCR {
 #ifdef WIN32
@@ -100,6 +203,7 @@ typedef struct XCODE_IPC_DESCR {
 #endif // WIN32
   unsigned int        sz;
   XCODE_IPC_MEM_T    *pmem;
+  XCODE_IPC_RING_T   *pRing;       // NULL when using the legacy single command region
 } XCODE_IPC_DESCR_T;
 
 
@@ -41,6 +41,7 @@
 typedef struct XCODER_PROFILE_DATA {
   unsigned int num_vdecodes;
   unsigned int num_vscales;
+  unsigned int num_vscales_saved;
   unsigned int num_vfilters;
   unsigned int num_vrotate;
   unsigned int num_vencodes;
@@ -132,12 +133,71 @@ typedef struct IXCODE_AVCTXT_OUT {
   int                    setBorderColor;
   unsigned char          colorBorderRGB[4];
   unsigned char          colorBorderYUV[4];
+
+  int                    scaleShareIdx;   // >= 0 if the scaled frame of this output index is re-used 
+  int                    scaleSrcIdx;     // >= 0 if scaled from the scaled frame of this output index
 } IXCODE_AVCTXT_OUT_T;
 
+typedef enum XCODE_VIDPIPE_SLOT_STATE {
+  XCODE_VIDPIPE_SLOT_FREE     = 0,
+  XCODE_VIDPIPE_SLOT_INPUT    = 1,
+  XCODE_VIDPIPE_SLOT_DECODED  = 2,
+  XCODE_VIDPIPE_SLOT_SCALED   = 3
+} XCODE_VIDPIPE_SLOT_STATE_T;
+
+typedef struct XCODE_VIDPIPE_SLOT {
+  XCODE_VIDPIPE_SLOT_STATE_T state;
+  int                    rc;              // stage error code, < 0 on failure
+  unsigned char         *pBufIn;          // copy of the encoded input frame
+  unsigned int           allocIn;
+  unsigned int           lenIn;
+  int                    dupFrame;
+  int                    doEncode;
+  int                    decoded;         // decoder output count was advanced by this input
+  int                    havePic;         // framedec holds a picture to be scaled and encoded
+  VID_DIMENSIONS_T       dimDec;
+  AVFrame                framedec;        // slot owned copy of the decoded picture
+  VID_DIMENSIONS_T       dimsOut[IXCODE_VIDEO_OUT_MAX];
+  AVFrame                framesout[IXCODE_VIDEO_OUT_MAX]; // slot owned scaled + filtered pictures
+} XCODE_VIDPIPE_SLOT_T;
+
+//
+// Pipelined video transcoder, with decode and scale / filter stages running on their 
+// own threads and the encoder run by the caller of ixcode_frame_vid
+//
+typedef struct XCODE_VIDPIPE {
+  unsigned int           depth;
+  XCODE_VIDPIPE_SLOT_T   slots[IXCODE_VIDEO_PIPELINE_MAX];
+  unsigned int           idxIn;           // next slot to be filled by the caller
+  unsigned int           idxDecode;       // next slot to be decoded
+  unsigned int           idxScale;        // next slot to be scaled
+  unsigned int           idxOut;          // next slot to be encoded by the caller
+  unsigned int           numInFlight;
+  unsigned int           decodeInIdx;     // decode stage private frame counters
+  unsigned int           decodeOutIdx;
+  unsigned int           encodeIdx;       // encoder input picture pts
+  int                    running;
+  int                    haveTdDecode;
+  int                    haveTdScale;
+  pthread_t              tdDecode;
+  pthread_t              tdScale;
+  pthread_mutex_t        mtx;
+  pthread_cond_t         cond;
+} XCODE_VIDPIPE_T;
+
 typedef struct IXCODE_AVCTXT_RESAMPLE {
   ReSampleContext       *presample;
   int                    needresample;
   unsigned char         *decbufresample;
+
+  //
+  // Shared resampler (see xcoder_audio_dsp.h).  presample is only set alongside pShared 
+  // while probing whether the input matches the other users of the shared resampler.
+  //
+  struct AUDIO_RESAMPLE_SHARED *pShared;
+  unsigned int           sharedSeq;
+  int                    sharedProbe;
+  int                    fastconvert;
   
   int                   *pin_codec;
   int                   *pin_samplerate;
@@ -157,6 +217,21 @@ typedef struct IXCODE_AVCTXT_RESAMPLE {
 
 } IXCODE_AVCTXT_RESAMPLE_T;
 
+#if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+
+#define XCODE_MIXSIG_RUNS_MAX    8
+
+//
+// Consecutive samples read from the audio mixer which carry the same mix signature
+//
+typedef struct XCODE_MIXSIG_RUN {
+  uint64_t               sig;
+  uint64_t               tsHz;            // mixer timestamp of the first sample
+  unsigned int           numSamples;
+} XCODE_MIXSIG_RUN_T;
+
+#endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+
 typedef struct IXCODE_AVCTXT {
 
   //
@@ -172,6 +247,9 @@ typedef struct IXCODE_AVCTXT {
   int                    framedecidxok;
 
   IXCODE_AVCTXT_OUT_T    out[IXCODE_VIDEO_OUT_MAX];
+  int                    haveScaleGraph;
+  unsigned int           scaleOrder[IXCODE_VIDEO_OUT_MAX]; // output scaling order, sources first
+  unsigned int           numScalesSaved;  // scale operations saved per frame by sharing
 
   int                    pipposxCfg;
   int                    pipposyCfg;
@@ -182,6 +260,12 @@ typedef struct IXCODE_AVCTXT {
   int                    piphavepos0;
   pthread_mutex_t       *pframepipmtx;
   unsigned char         *piprawDataBufs[PIP_ADD_MAX]; // YUV contents buffer
+  XCODE_VIDPIPE_T       *pVidPipe;
+  int                    governorOn;      // encoder speed governor enabled on any output
+  unsigned int           governorSlow;    // consecutive overloaded encode windows
+  unsigned int           governorFast;    // consecutive underloaded encode windows
+  unsigned int           governorFastNeeded; // underloaded windows required to step up
+  unsigned int           governorSinceUp; // windows since the last step up
 
   //
   // Audio params
@@ -212,6 +296,11 @@ typedef struct IXCODE_AVCTXT {
   unsigned int           audioFrameLen;
   int                    havePrevVidFrame;
 
+#if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+  XCODE_MIXSIG_RUN_T     mixRuns[XCODE_MIXSIG_RUNS_MAX]; // mix signature runs of the decbufout samples
+  unsigned int           numMixRuns;
+#endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+
 #if defined(XCODE_PROFILE)
   XCODER_PROFILE_DATA_T  prof;
 #endif // XCODE_PROFILE
@@ -220,6 +309,17 @@ typedef struct IXCODE_AVCTXT {
 
 
 void xcode_fill_yuv420p(unsigned char *data[4], int linesize[4], unsigned char *p, unsigned int ht);
+void ixcode_init_common(IXCODE_COMMON_CTXT_T *pCommon);
+uint64_t ixcode_stage_time_us();
+
+//
+// Runtime stage timing, enabled per context via common.cfgStageStats
+//
+#define IXCODE_STAGE_BEGIN(pcommon, tm) if((pcommon)->cfgStageStats) { \
+                                          (tm) = ixcode_stage_time_us(); }
+#define IXCODE_STAGE_END(pcommon, tm, us, num) if((pcommon)->cfgStageStats) { \
+                                          (pcommon)->stageStats.us += ixcode_stage_time_us() - (tm); \
+                                          (pcommon)->stageStats.num++; }
 
 
 #endif // __XCODER_H___
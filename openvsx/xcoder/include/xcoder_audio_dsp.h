@@ -0,0 +1,73 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+
+#ifndef __XCODER_AUDIO_DSP_H__
+#define __XCODER_AUDIO_DSP_H__
+
+#include <stdint.h>
+
+struct IXCODE_AVCTXT_RESAMPLE;
+
+//
+// Number of recently resampled frames kept by a shared resampler so that outputs which 
+// run slightly behind can still pick up the converted result
+//
+#define AUDIO_RESAMPLE_HISTORY           8
+
+//
+// Number of frames a late joiner of a shared resampler spends looking for its input
+// in the shared history before settling on a private resampler
+//
+#define AUDIO_RESAMPLE_PROBE_FRAMES      50
+
+#define AUDIO_DSP_RESAMPLE_ACTIVE(p)     ((p)->presample || (p)->pShared || (p)->fastconvert)
+
+//
+// Vectorized sample kernels, dispatched at runtime to the best available implementation
+//
+void audio_dsp_gain_s16(int16_t *samples, unsigned int numsamples, int adjustment);
+void audio_dsp_s16_to_flt(float *out, const int16_t *in, unsigned int numsamples);
+void audio_dsp_flt_to_s16(int16_t *out, const float *in, unsigned int numsamples);
+void audio_dsp_mono_to_stereo_s16(int16_t *out, const int16_t *in, unsigned int numframes);
+void audio_dsp_stereo_to_mono_s16(int16_t *out, const int16_t *in, unsigned int numframes);
+
+int audio_dsp_can_convert(int infmt, int inchannels, int outfmt, int outchannels);
+int audio_dsp_convert(void *out, int outfmt, int outchannels, 
+                      const void *in, int infmt, int inchannels, unsigned int numframes);
+
+//
+// Sample rate / format / channel conversion for an IXCODE_AVCTXT_RESAMPLE_T.  Conversions 
+// which keep the sample rate use the sample kernels directly.  Rate conversions share one 
+// ffmpeg resampler among all contexts with the same conversion parameters, as long as 
+// their input stays identical.
+//
+int audio_dsp_resample_open(struct IXCODE_AVCTXT_RESAMPLE *pResample);
+int audio_dsp_resample_run(struct IXCODE_AVCTXT_RESAMPLE *pResample, int16_t *out, 
+                           const int16_t *in, int numSamples);
+void audio_dsp_resample_close(struct IXCODE_AVCTXT_RESAMPLE *pResample);
+
+int audio_dsp_benchmark(unsigned int outputs, unsigned int frames);
+
+#endif // __XCODER_AUDIO_DSP_H__
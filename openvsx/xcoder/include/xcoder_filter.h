@@ -86,5 +86,10 @@ int filter_test(void *pCtx, const unsigned char *src_data[4], const int src_line
 
 #endif // (XCODE_FILTER_TEST) && (XCODE_FILTER_TEST > 0)
 
+#if defined(XCODE_FILTER_ON) && (XCODE_FILTER_ON > 0)
+
+int filter_benchmark(unsigned int threads, unsigned int frames);
+
+#endif // (XCODE_FILTER_ON) && (XCODE_FILTER_ON > 0)
 
 #endif // __XCODER_FILTER_H___
@@ -0,0 +1,65 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+
+#ifndef __XCODER_FRAMEPOOL_H__
+#define __XCODER_FRAMEPOOL_H__
+
+#include "libavcodec/avcodec.h"
+
+//
+// Refcounted pool of picture buffers keyed by (width, height, pix_fmt).  Buffers are 
+// aligned to FRAMEPOOL_ALIGN, pre-faulted when first allocated and returned to a per-key
+// idle list once the last reference is released.
+//
+
+#define FRAMEPOOL_ALIGN                 64
+#define FRAMEPOOL_KEYS_MAX              32
+#define FRAMEPOOL_IDLE_PER_KEY          8
+#define FRAMEPOOL_IDLE_BYTES_MAX        (256 * 1024 * 1024)
+
+typedef struct FRAMEPOOL_STATS {
+  uint64_t                   hits;
+  uint64_t                   misses;
+  unsigned int               numKeys;
+  unsigned int               numInUse;
+  unsigned int               numIdle;
+  uint64_t                   bytesInUse;
+  uint64_t                   bytesIdle;
+  uint64_t                   bytesResidentPeak;
+} FRAMEPOOL_STATS_T;
+
+unsigned char *framepool_get(enum PixelFormat pix_fmt, int width, int height);
+void framepool_ref(unsigned char *pdata);
+void framepool_unref(unsigned char *pdata);
+
+int framepool_picture_alloc(AVPicture *picture, enum PixelFormat pix_fmt, int width, int height);
+void framepool_picture_free(AVPicture *picture);
+
+void framepool_getstats(FRAMEPOOL_STATS_T *pStats);
+void framepool_logstats(void);
+void framepool_trim(void);
+
+
+#endif // __XCODER_FRAMEPOOL_H__
@@ -48,6 +48,7 @@ int xcoder_libavcodec_video_encode(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx
                                    const struct AVFrame *raw, unsigned char *out, unsigned int outlen);
 int xcoder_libavcodec_video_decode(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx,
                                    struct AVFrame *raw, const unsigned char *in, unsigned int inlen);
+int xcoder_libavcodec_video_speed(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx, int level);
 
 
 
@@ -50,6 +50,7 @@ int pip_fill_rect(unsigned char *data[4], int linesize[4], unsigned int width, u
                   unsigned int startx, unsigned int starty, unsigned int fillwidth, unsigned int fillheight,
                   const unsigned char *rgb);
 int pip_mark(unsigned char *dst_data[4], int dst_linesize[4], unsigned int ht);
+int pip_blend_benchmark(unsigned int numOverlays, unsigned int frames);
 //int pip_draw_grid(unsigned char *data[4], int linesize[4], int height, unsigned int hcount, 
 //                  unsigned int vcount, int *parrhdividers, unsigned int borderpx, 
 //                  const unsigned char *colorYUV);
@@ -46,6 +46,7 @@ typedef int (* XCODER_VIDEO_ENCODE)(CODEC_WRAP_CTXT_T *, unsigned int, const str
                                     unsigned char *, unsigned int);
 typedef int (* XCODER_VIDEO_DECODE)(CODEC_WRAP_CTXT_T *, unsigned int, struct AVFrame *, 
                                     const unsigned char *, unsigned int);
+typedef int (* XCODER_VIDEO_SPEED)(CODEC_WRAP_CTXT_T *, unsigned int, int);
 
 typedef struct CODEC_WRAP_AUDIO_DECODER {
   CODEC_WRAP_CTXT_T          ctxt;
@@ -73,6 +74,7 @@ typedef struct CODEC_WRAP_VIDEO_ENCODER {
   XCODER_VIDEO_INIT          fInit;
   XCODER_VIDEO_CLOSE         fClose;
   XCODER_VIDEO_ENCODE        fEncode;
+  XCODER_VIDEO_SPEED         fSpeed;   // optional, sets the encoder speed level
 } CODEC_WRAP_VIDEO_ENCODER_T;
 
 typedef struct CODEC_WRAP_ENCODER {
@@ -34,6 +34,7 @@ void xcoder_x264_close(CODEC_WRAP_CTXT_T *pCtxt);
 int xcoder_x264_init(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx);
 int xcoder_x264_encode(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx,
                              const struct AVFrame *raw, unsigned char *out, unsigned int outlen);
+int xcoder_x264_speed(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx, int level);
 
 
 
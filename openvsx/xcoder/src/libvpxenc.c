@@ -303,6 +303,13 @@ static av_cold int vp8ext_init(AVCodecContext *avctx)
 
         LOG(X_DEBUG("Doing full VP8 re-init"));
         vp8ext_free(avctx);
+
+        // Start over from the configured speed, the caller re-applies any speed level
+        if (ctx->speed_level > 0) {
+            ctx->cpu_used = ctx->cpu_used_base;
+            ctx->deadline = ctx->deadline_base;
+            ctx->speed_level = 0;
+        }
     } else {
       LOG(X_DEBUG("VP8 init"));
     }
@@ -609,6 +616,52 @@ static int vp8ext_encode(AVCodecContext *avctx, uint8_t *buf, int buf_size,
     return coded_size;
 }
 
+//
+// Encoder governor speed levels.  cpu-used and the encode deadline are the only
+// speed controls which libvpx honours without re-creating the encoder.
+//
+static const int vp8_speed_cpu_used[] = { 0, 4, 8, 12, 16 };
+
+int vp8ext_set_speed(AVCodecContext *avctx, int level)
+{
+    VP8Context *ctx = avctx->priv_data;
+    int cpu_used;
+
+    if (level < 0 || level >= (int) (sizeof(vp8_speed_cpu_used) / sizeof(vp8_speed_cpu_used[0])))
+        return AVERROR(EINVAL);
+    if (level == ctx->speed_level)
+        return 0;
+
+    if (ctx->speed_level == 0) {
+        ctx->cpu_used_base = ctx->cpu_used;
+        ctx->deadline_base = ctx->deadline;
+    }
+
+    if (level == 0) {
+        cpu_used = ctx->cpu_used_base;
+        ctx->deadline = ctx->deadline_base;
+    } else {
+        cpu_used = ctx->cpu_used_base == INT_MIN ? 0 : ctx->cpu_used_base;
+        cpu_used = FFMAX(cpu_used, vp8_speed_cpu_used[level]);
+        if (level >= 2)
+            ctx->deadline = VPX_DL_REALTIME;
+        else if (ctx->deadline_base == VPX_DL_BEST_QUALITY)
+            ctx->deadline = VPX_DL_GOOD_QUALITY;
+        else
+            ctx->deadline = ctx->deadline_base;
+    }
+
+    if (cpu_used != INT_MIN && codecctl_int(avctx, VP8E_SET_CPUUSED, cpu_used) < 0)
+        return AVERROR(EINVAL);
+
+    ctx->cpu_used = cpu_used;
+    ctx->speed_level = level;
+
+    LOG(X_DEBUG("VP8 speed level %d cpu_used:%d, deadline: %d"), level, ctx->cpu_used, ctx->deadline);
+
+    return 0;
+}
+
 #define OFFSET(x) offsetof(VP8Context, x)
 #define VE AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_ENCODING_PARAM
 static const AVOption options[] = {
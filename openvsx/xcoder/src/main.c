@@ -48,6 +48,12 @@
 #include "xcode_ipc_srv.h"
 #include "version.h"
 
+#if defined(XCODE_HAVE_PIP) && (XCODE_HAVE_PIP > 0)
+#include "xcoder_pip.h"
+#endif // XCODE_HAVE_PIP
+#include "xcoder_filter.h"
+#include "xcoder_audio_dsp.h"
+
 
 #define SEM_MAX_ERRORS 10
 
@@ -57,6 +63,314 @@ static XCODE_IPC_DESCR_T *g_pXcodeIpc;
 
 void xcode_ipc_close(XCODE_IPC_DESCR_T *pXcodeIpc);
 
+#if defined(XCODE_IPC_HAVE_RING)
+
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+typedef struct XCODE_IPC_RING_THREAD {
+  XCODE_IPC_RING_T            *pRing;
+  XCODE_IPC_RING_CHAN_T       *pChan;
+  pthread_t                    tid;
+  int                          running;
+  unsigned int                 stallWaits;
+} XCODE_IPC_RING_THREAD_T;
+
+static XCODE_IPC_RING_THREAD_T g_ringThreads[XCODE_IPC_CHAN_MAX];
+static volatile int g_ringRunning;
+
+static int ring_futex(volatile int *paddr, int op, int val, const struct timespec *pts) {
+  return syscall(SYS_futex, (int *) paddr, op, val, pts, NULL, 0);
+}
+
+static void ring_event_signal(XCODE_IPC_EVENT_T *pEv) {
+  __sync_fetch_and_add(&pEv->seq, 1);
+  if(pEv->waiters > 0) {
+    ring_futex(&pEv->seq, FUTEX_WAKE, INT_MAX, NULL);
+  }
+}
+
+//
+// Returns 1 on timeout
+//
+static int ring_event_wait(XCODE_IPC_EVENT_T *pEv, int seq, unsigned int ms) {
+  struct timespec ts;
+  int rc;
+
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (ms % 1000) * 1000000;
+
+  __sync_fetch_and_add(&pEv->waiters, 1);
+  rc = ring_futex(&pEv->seq, FUTEX_WAIT, seq, &ts);
+  __sync_fetch_and_sub(&pEv->waiters, 1);
+
+  return (rc == -1 && errno == ETIMEDOUT) ? 1 : 0;
+}
+
+static int ring_owner_gone(int pid) {
+  return (pid > 0 && kill(pid, 0) != 0 && errno == ESRCH) ? 1 : 0;
+}
+
+//
+// Frees a slot claimed by ownerPid and hands it to the next ticket.  The slot is marked
+// as being reclaimed while its turn is advanced so that a late claim by the skipped ticket 
+// holder fails.
+//
+static int ring_slot_reclaim(XCODE_IPC_RING_CHAN_T *pChan, XCODE_IPC_RING_SLOT_T *pSlot, int ownerPid) {
+
+  if(!__sync_bool_compare_and_swap(&pSlot->ownerPid, ownerPid, XCODE_IPC_RING_OWNER_RECLAIM)) {
+    return 0;
+  }
+
+  pSlot->state = XCODE_IPC_SLOT_FREE;
+  __sync_fetch_and_add(&pSlot->turn, XCODE_IPC_RING_SLOTS);
+  __sync_synchronize();
+  pSlot->ownerPid = 0;
+  ring_event_signal(&pChan->evCli);
+
+  return 1;
+}
+
+//
+// Recovers the channel from clients which exited while holding a ticket.  A completed slot 
+// whose owner is gone is released.  The slot of the next ticket to be served is skipped if
+// its owner is gone, or if nobody claimed it for XCODE_IPC_RING_RECLAIM_WAITS server waits,
+// which is the case when the ticket holder exited before its turn.
+//
+static void xcode_ipc_ring_reclaim(XCODE_IPC_RING_THREAD_T *pThread) {
+  XCODE_IPC_RING_CHAN_T *pChan = pThread->pChan;
+  XCODE_IPC_RING_SLOT_T *pSlot;
+  unsigned int idx;
+  int pid;
+
+  for(idx = 0; idx < XCODE_IPC_RING_SLOTS; idx++) {
+    pSlot = &pChan->slots[idx];
+    pid = pSlot->ownerPid;
+    if(pSlot->state == XCODE_IPC_SLOT_DONE && ring_owner_gone(pid) && 
+       ring_slot_reclaim(pChan, pSlot, pid)) {
+      LOG(X_WARNING("Reclaimed ipc ring slot of exited client pid %d"), pid);
+    }
+  }
+
+  pSlot = &pChan->slots[pChan->serveSeq & (XCODE_IPC_RING_SLOTS - 1)];
+  pid = pSlot->ownerPid;
+
+  if(pChan->submitSeq == pChan->serveSeq || pSlot->state != XCODE_IPC_SLOT_FREE || 
+     pSlot->turn != pChan->serveSeq) {
+    pThread->stallWaits = 0;
+    return;
+  }
+
+  if((pid == 0 && ++pThread->stallWaits >= XCODE_IPC_RING_RECLAIM_WAITS) || ring_owner_gone(pid)) {
+    if(ring_slot_reclaim(pChan, pSlot, pid)) {
+      LOG(X_WARNING("Skipped ipc ring ticket %u of exited client pid %d"), pChan->serveSeq, pid);
+      pChan->serveSeq++;
+    }
+    pThread->stallWaits = 0;
+  }
+}
+
+static void ring_params_apply(IXCODE_COMMON_CTXT_T *pCommon, const XCODE_IPC_FRAME_PARAMS_T *pParams) {
+  pCommon->inpts90Khz = pParams->inpts90Khz;
+  pCommon->outpts90Khz = pParams->outpts90Khz;
+  pCommon->decodeInIdx = pParams->decodeInIdx;
+  pCommon->decodeOutIdx = pParams->decodeOutIdx;
+  pCommon->encodeInIdx = pParams->encodeInIdx;
+  pCommon->encodeOutIdx = pParams->encodeOutIdx;
+}
+
+static void ring_params_store(XCODE_IPC_FRAME_PARAMS_T *pParams, const IXCODE_COMMON_CTXT_T *pCommon) {
+  pParams->inpts90Khz = pCommon->inpts90Khz;
+  pParams->outpts90Khz = pCommon->outpts90Khz;
+  pParams->decodeInIdx = pCommon->decodeInIdx;
+  pParams->decodeOutIdx = pCommon->decodeOutIdx;
+  pParams->encodeInIdx = pCommon->encodeInIdx;
+  pParams->encodeOutIdx = pCommon->encodeOutIdx;
+  pParams->stageStats = pCommon->stageStats;
+}
+
+static int xcode_ipc_ring_exec(XCODE_IPC_RING_T *pRing, XCODE_IPC_RING_CHAN_T *pChan,
+                               XCODE_IPC_RING_SLOT_T *pSlot) {
+  IXCODE_VIDEO_CTXT_T *pXcodeV = &pChan->ctxt.vid;
+  IXCODE_AUDIO_CTXT_T *pXcodeA = &pChan->ctxt.aud;
+  unsigned char *pData = XCODE_IPC_RING_DATA(pRing, pSlot);
+  IXCODE_OUTBUF_T outbuf;
+  int rc = IXCODE_RC_ERROR;
+
+  switch(pSlot->cmd) {
+    case XCODE_IPC_CMD_INIT_VID:
+      rc = ixcode_init_vid(pXcodeV);
+      break;
+    case XCODE_IPC_CMD_INIT_AUD:
+      rc = ixcode_init_aud(pXcodeA);
+      break;
+    case XCODE_IPC_CMD_CLOSE_VID:
+      ixcode_close_vid(pXcodeV);
+      rc = 0;
+      break;
+    case XCODE_IPC_CMD_CLOSE_AUD:
+      ixcode_close_aud(pXcodeA);
+      rc = 0;
+      break;
+    case XCODE_IPC_CMD_ENCODE_VID:
+      if(pSlot->lenIn > pSlot->dataSz) {
+        break;
+      }
+      ring_params_apply(&pXcodeV->common, &pSlot->params);
+      pXcodeV->out[0].cfgForceIDR = pSlot->params.cfgForceIDR;
+      pXcodeV->out[0].qTot = pSlot->params.qTot;
+      pXcodeV->out[0].qSamples = pSlot->params.qSamples;
+      pXcodeV->out[0].pts = pSlot->params.pts;
+      pXcodeV->out[0].dts = pSlot->params.dts;
+
+      memset(&outbuf, 0, sizeof(outbuf));
+      outbuf.buf = pData;
+      outbuf.lenbuf = pSlot->dataSz;
+      rc = ixcode_frame_vid(pXcodeV, pData, pSlot->lenIn, &outbuf);
+
+      ring_params_store(&pSlot->params, &pXcodeV->common);
+      pSlot->params.qTot = pXcodeV->out[0].qTot;
+      pSlot->params.qSamples = pXcodeV->out[0].qSamples;
+      pSlot->params.frameType = pXcodeV->out[0].frameType;
+      pSlot->params.governorLevel = pXcodeV->out[0].governor.level;
+      pSlot->params.pts = pXcodeV->out[0].pts;
+      pSlot->params.dts = pXcodeV->out[0].dts;
+      break;
+    case XCODE_IPC_CMD_ENCODE_AUD:
+      if(pSlot->offsetOut > pSlot->dataSz || pSlot->lenIn > pSlot->offsetOut) {
+        break;
+      }
+      ring_params_apply(&pXcodeA->common, &pSlot->params);
+      pXcodeA->pts = pSlot->params.pts;
+
+      rc = ixcode_frame_aud(pXcodeA, pData, pSlot->lenIn, pData + pSlot->offsetOut, 
+                            pSlot->dataSz - pSlot->offsetOut);
+
+      ring_params_store(&pSlot->params, &pXcodeA->common);
+      pSlot->params.pts = pXcodeA->pts;
+      break;
+    default:
+      LOG(X_ERROR("Invalid ipc ring command: %d"), pSlot->cmd);
+      break;
+  }
+
+  if(rc < IXCODE_RC_OK) {
+    LOG(X_ERROR("ipc ring exec cmd: %d rc: %d"), pSlot->cmd, rc);
+  }
+
+  return rc;
+}
+
+//
+// Executes the requests of one channel in ticket order
+//
+static void *xcode_ipc_ring_proc(void *pArg) {
+  XCODE_IPC_RING_THREAD_T *pThread = (XCODE_IPC_RING_THREAD_T *) pArg;
+  XCODE_IPC_RING_CHAN_T *pChan = pThread->pChan;
+  XCODE_IPC_RING_SLOT_T *pSlot;
+  int seq;
+
+  while(g_ringRunning) {
+
+    pSlot = &pChan->slots[pChan->serveSeq & (XCODE_IPC_RING_SLOTS - 1)];
+    seq = pChan->evSrv.seq;
+    __sync_synchronize();
+
+    if(pSlot->state != XCODE_IPC_SLOT_SUBMITTED || pSlot->turn != pChan->serveSeq) {
+      if(ring_event_wait(&pChan->evSrv, seq, XCODE_IPC_RING_WAIT_MS)) {
+        xcode_ipc_ring_reclaim(pThread);
+      }
+      continue;
+    }
+
+    pThread->stallWaits = 0;
+
+    __sync_synchronize();
+    pSlot->cmdrc = xcode_ipc_ring_exec(pThread->pRing, pChan, pSlot);
+    __sync_synchronize();
+
+    pSlot->state = XCODE_IPC_SLOT_DONE;
+    pChan->serveSeq++;
+    ring_event_signal(&pChan->evCli);
+  }
+
+  return NULL;
+}
+
+static void xcode_ipc_ring_stop(XCODE_IPC_DESCR_T *pXcodeIpc) {
+  unsigned int idx;
+
+  if(!pXcodeIpc->pRing) {
+    return;
+  }
+
+  pXcodeIpc->pRing->magic = 0;
+  g_ringRunning = 0;
+
+  for(idx = 0; idx < XCODE_IPC_CHAN_MAX; idx++) {
+    if(g_ringThreads[idx].running) {
+      ring_event_signal(&g_ringThreads[idx].pChan->evSrv);
+      pthread_join(g_ringThreads[idx].tid, NULL);
+      g_ringThreads[idx].running = 0;
+    }
+  }
+
+  pXcodeIpc->pRing = NULL;
+}
+
+static int xcode_ipc_ring_start(XCODE_IPC_DESCR_T *pXcodeIpc) {
+  XCODE_IPC_RING_T *pRing;
+  XCODE_IPC_RING_CHAN_T *pChan;
+  unsigned int offset = XCODE_IPC_RING_HDRSZ;
+  unsigned int idx, idxSlot;
+
+  if(pXcodeIpc->sz < XCODE_IPC_MEM_RING_SZ) {
+    return -1;
+  }
+
+  pRing = XCODE_IPC_RING_PTR(pXcodeIpc->pmem);
+  memset(pRing, 0, sizeof(XCODE_IPC_RING_T));
+  pRing->version = XCODE_IPC_RING_VERSION;
+  pRing->sz = XCODE_IPC_RING_SZ;
+  pRing->srvPid = getpid();
+
+  for(idx = 0; idx < XCODE_IPC_CHAN_MAX; idx++) {
+    pChan = &pRing->chans[idx];
+    for(idxSlot = 0; idxSlot < XCODE_IPC_RING_SLOTS; idxSlot++) {
+      pChan->slots[idxSlot].turn = idxSlot;
+      pChan->slots[idxSlot].dataOffset = offset;
+      pChan->slots[idxSlot].dataSz = (idx == XCODE_IPC_CHAN_VID ? XCODE_IPC_RING_SLOTSZ_VID : 
+                                                                 XCODE_IPC_RING_SLOTSZ_AUD);
+      offset += pChan->slots[idxSlot].dataSz;
+    }
+  }
+
+  pXcodeIpc->pRing = pRing;
+  g_ringRunning = 1;
+
+  for(idx = 0; idx < XCODE_IPC_CHAN_MAX; idx++) {
+    g_ringThreads[idx].pRing = pRing;
+    g_ringThreads[idx].pChan = &pRing->chans[idx];
+    if(pthread_create(&g_ringThreads[idx].tid, NULL, xcode_ipc_ring_proc, &g_ringThreads[idx]) != 0) {
+      LOG(X_ERROR("Unable to create ipc ring thread with errno: %d"), errno);
+      xcode_ipc_ring_stop(pXcodeIpc);
+      return -1;
+    }
+    g_ringThreads[idx].running = 1;
+  }
+
+  __sync_synchronize();
+  pRing->magic = XCODE_IPC_RING_MAGIC;
+
+  LOG(X_DEBUG("Initialized shared memory ring with %d channels of %d slots"), 
+              XCODE_IPC_CHAN_MAX, XCODE_IPC_RING_SLOTS);
+
+  return 0;
+}
+
+#endif // XCODE_IPC_HAVE_RING
+
 #if defined(WIN32)
 
 int xcode_ipc_init(XCODE_IPC_DESCR_T *pXcodeIpc) {
@@ -199,7 +513,10 @@ int xcode_ipc_init(XCODE_IPC_DESCR_T *pXcodeIpc) {
 
   if((flags & IPC_CREAT) || buf.shm_nattch == 0) {
 
-    pXcodeIpc->pmem->hdr.sz = pXcodeIpc->sz;
+    //
+    // The legacy command region never extends into the ring which may follow it
+    //
+    pXcodeIpc->pmem->hdr.sz = pXcodeIpc->sz > XCODE_IPC_MEM_SZ ? XCODE_IPC_MEM_SZ : pXcodeIpc->sz;
     pXcodeIpc->pmem->hdr.cmd = XCODE_IPC_CMD_NONE;
 
     if((pXcodeIpc->sem_srv = sem_open(XCODE_IPC_SEM_NAME_SRV, 0,
@@ -241,6 +558,10 @@ int xcode_ipc_init(XCODE_IPC_DESCR_T *pXcodeIpc) {
 void xcode_ipc_close(XCODE_IPC_DESCR_T *pXcodeIpc) {
   struct shmid_ds buf;
 
+#if defined(XCODE_IPC_HAVE_RING)
+  xcode_ipc_ring_stop(pXcodeIpc);
+#endif // XCODE_IPC_HAVE_RING
+
   memset(&buf, 0, sizeof(buf));
 
   if(pXcodeIpc->shmid > 0) {
@@ -361,6 +682,16 @@ static int xcode_ipc_dispatch(XCODE_IPC_DESCR_T *pXcodeIpc) {
 static void usage(int argc, char *argv[]) {
   fprintf(stdout, "usage: %s \n", argv[0]);
   fprintf(stdout, "Used in conjunction with OpenVSX to transcode video\n\n");
+#if defined(XCODE_HAVE_PIP) && (XCODE_HAVE_PIP > 0)
+  fprintf(stdout, "   --pipbench=[ number of overlays ] Benchmark picture-in-picture alpha blending\n"
+                  "          using each available set of blend kernels and verify the output matches.\n\n");
+#endif // XCODE_HAVE_PIP
+#if defined(XCODE_FILTER_ON) && (XCODE_FILTER_ON > 0)
+  fprintf(stdout, "   --filterbench=[ number of threads ] Benchmark the video filters using the scalar,\n"
+                  "          SIMD and threaded implementations and verify the output matches.\n\n");
+#endif // XCODE_FILTER_ON
+  fprintf(stdout, "   --audiobench=[ number of outputs ] Benchmark the audio sample conversion kernels\n"
+                  "          and the shared resampler and verify the output matches.\n\n");
 }
 
 int main(int argc, char *argv[]) {
@@ -369,6 +700,25 @@ int main(int argc, char *argv[]) {
 
   fprintf(stdout, "\n"XCODE_BANNER" "ARCH"\n\n", BUILD_INFO_NUM);
 
+#if defined(XCODE_HAVE_PIP) && (XCODE_HAVE_PIP > 0)
+  if(argc > 1 && !strncmp(argv[1], "--pipbench", 10) && 
+     (argv[1][10] == '\0' || argv[1][10] == '=')) {
+    return pip_blend_benchmark(argv[1][10] == '=' ? atoi(&argv[1][11]) : 4, 200) == 0 ? 0 : 1;
+  }
+#endif // XCODE_HAVE_PIP
+
+#if defined(XCODE_FILTER_ON) && (XCODE_FILTER_ON > 0)
+  if(argc > 1 && !strncmp(argv[1], "--filterbench", 13) && 
+     (argv[1][13] == '\0' || argv[1][13] == '=')) {
+    return filter_benchmark(argv[1][13] == '=' ? atoi(&argv[1][14]) : 4, 50) == 0 ? 0 : 1;
+  }
+#endif // XCODE_FILTER_ON
+
+  if(argc > 1 && !strncmp(argv[1], "--audiobench", 12) && 
+     (argv[1][12] == '\0' || argv[1][12] == '=')) {
+    return audio_dsp_benchmark(argv[1][12] == '=' ? atoi(&argv[1][13]) : 4, 500) == 0 ? 0 : 1;
+  }
+
   if(argc > 1) {
     usage(argc, argv);
     return 0;
@@ -385,7 +735,11 @@ int main(int argc, char *argv[]) {
   memset(&xcodeIpc, 0, sizeof(xcodeIpc));
   g_pXcodeIpc = &xcodeIpc;
 
+#if defined(XCODE_IPC_HAVE_RING)
+  xcodeIpc.sz = XCODE_IPC_MEM_RING_SZ;
+#else // XCODE_IPC_HAVE_RING
   xcodeIpc.sz = XCODE_IPC_MEM_SZ;
+#endif // XCODE_IPC_HAVE_RING
 
 #if !defined(WIN32)
   xcodeIpc.key = XCODE_IPC_SHMKEY;
@@ -396,7 +750,17 @@ int main(int argc, char *argv[]) {
 
   rc = xcode_ipc_init(&xcodeIpc);
 
+#if defined(XCODE_IPC_HAVE_RING)
+  if(rc == 0 && xcode_ipc_ring_start(&xcodeIpc) != 0) {
+    LOG(X_WARNING("Shared memory ring unavailable.  Using single command region only."));
+  }
+#endif // XCODE_IPC_HAVE_RING
+
   if(rc == 0) {
+    //
+    // The legacy single command handshake remains serviced for clients which do not use 
+    // the ring
+    //
     xcode_ipc_dispatch(&xcodeIpc);
   }
 
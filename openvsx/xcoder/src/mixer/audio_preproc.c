@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 #include "logutil.h"
 #include "mixer/mixdefaults.h"
 #include "mixer/audio_preproc.h"
@@ -70,6 +71,11 @@ void audio_preproc_free(AUDIO_PREPROC_T *pPreproc) {
     pPreproc->vad_buffer = NULL;
   }
 
+  if(pPreproc->energy_buffer) {
+    free(pPreproc->energy_buffer);
+    pPreproc->energy_buffer = NULL;
+  }
+
   pthread_mutex_destroy(&pPreproc->mtx);
 
 }
@@ -193,7 +199,8 @@ int audio_preproc_init(AUDIO_PREPROC_T *pPreproc,
   //
   //if(pPreproc->cfg_vad) {
     unsigned int vad_bufsz = samplesSz / pPreproc->chunkHz + 1;
-    if(!(pPreproc->vad_buffer = (unsigned char *) calloc(1, vad_bufsz))) {
+    if(!(pPreproc->vad_buffer = (unsigned char *) calloc(1, vad_bufsz)) ||
+       !(pPreproc->energy_buffer = (uint16_t *) calloc(sizeof(uint16_t), vad_bufsz))) {
       audio_preproc_free(pPreproc);
       return -1;
     }
@@ -229,6 +236,24 @@ int audio_preproc_exec(AUDIO_PREPROC_T *pPreproc, int16_t *samples, unsigned int
   return rc;
 }
 
+uint16_t audio_preproc_energy(const int16_t *samples, unsigned int sz) {
+  unsigned int idx;
+  int64_t tot = 0;
+
+  //
+  // Returns the RMS level of the samples
+  //
+  if(sz == 0) {
+    return 0;
+  }
+
+  for(idx = 0; idx < sz; idx++) {
+    tot += (int32_t) samples[idx] * samples[idx];
+  }
+
+  return (uint16_t) sqrtf((float) (tot / sz));
+}
+
 
 #if 0
 int audio_preproc_init(AUDIO_PREPROC_T *pPreproc,
@@ -29,6 +29,7 @@
 #include "logutil.h"
 #include "mixer/configfile.h"
 #include "mixer/conference.h"
+#include "mixer/scheduler.h"
 
 #define LOG_CTXT  (pConference ? pConference->logCtxt : NULL)
 
@@ -70,126 +71,128 @@ static uint64_t setConferenceTsHz(AUDIO_CONFERENCE_T *pConference, u_int64_t tsH
 }
 
 
-static void mixer_runproc(void *pArg) {
+void conference_mix_start(AUDIO_CONFERENCE_T *pConference) {
+
+  pConference->tmOffsetFromStartHz = conference_getAbsoluteTimeHz(pConference);
+  pConference->resetThresholdHz = pConference->pMixer->thresholdHz * 2;
+  pConference->tsHzProduced = 0;
+
+  setConferenceTsHz(pConference, pConference->tmOffsetFromStartHz);
+}
+
+int conference_mix_step(AUDIO_CONFERENCE_T *pConference) {
   int rc;
-  AUDIO_CONFERENCE_T *pConference = (AUDIO_CONFERENCE_T *) pArg;
-  u_int64_t tsHzProduced = 0;
-  const unsigned int sleepMs = 5;
-  unsigned int resetThresholdHz;
   int participantCount;
   TIME_STAMP_T tmHzNow;
   TIME_STAMP_T tmHzElapsed = 0;
-  TIME_STAMP_T tmOffsetFromStartHz;
-#if defined(DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
-  TIME_STAMP_T tmLastDump = time_getTime();
-#endif // (DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
 
   //
-  // This thread procedure is used to run the mixer
+  // Runs one pass of the mixer clock.  Returns the number of output samples produced,
+  // or <= 0 if no output is available yet.
   //
 
-  logutil_tid_add(pthread_self(), pConference->tid_tag);
+  participantCount = mixer_count_active(pConference->pMixer);
 
-  pConference->tdFlagMixer = THREAD_FLAG_RUNNING;
-
-  LOG(X_DEBUG("Mixer master thread for conference id %d started"), pConference->id);
+  tmHzNow = conference_getAbsoluteTimeHz(pConference);
+  tmHzElapsed = tmHzNow - pConference->tmOffsetFromStartHz;
 
-  tmOffsetFromStartHz = conference_getAbsoluteTimeHz(pConference);
+  mixer_check_idle(pConference->pMixer, tmHzElapsed);
 
-  resetThresholdHz = pConference->pMixer->thresholdHz * 2;
-
-  setConferenceTsHz(pConference, tmOffsetFromStartHz);
+  //if(tmHzNow > tmHzMark + pConference->cfg.sampleRate) {
+    //fprintf(stderr, "\n\n%llu\n", time_getTime()/1000);
+    //mixer_dump(stderr, pConference->pMixer, 1, NULL);
+  //  tmHzMark = tmHzNow;
+  //}
+  //fprintf(stderr, "tsHzNow:%lluHz, actual tm:%lluHz delta:%lluHz\n", pConference->tsHzNow, tmHzElapsed, pConference->tsHzNow < tmHzElapsed ? tmHzElapsed-pConference->tsHzNow : pConference->tsHzNow-tmHzElapsed);
 
-  while(pConference->tdFlagMixer == THREAD_FLAG_RUNNING) {
+  if(pConference->tsHzNow + pConference->resetThresholdHz < tmHzElapsed) {
 
-    participantCount = mixer_count_active(pConference->pMixer);
+    if(participantCount > 0) {
+      LOG(X_WARNING("Reset mixer clock by %lluHz, %llu -> %llu, threshold: %uHz, after %lluHz output samples"), 
+         (tmHzElapsed - pConference->tsHzNow), pConference->tsHzNow, tmHzElapsed, pConference->resetThresholdHz, 
+         pConference->tsHzProduced);
+      mixer_dumpLog(S_DEBUG, pConference->pMixer, 1, "after mixer clock reset");
+      //tmHzMark = tmHzNow;
+      //mixer_reset_sources(pConference->pMixer);
 
-    tmHzNow = conference_getAbsoluteTimeHz(pConference);
-    tmHzElapsed = tmHzNow - tmOffsetFromStartHz;
 
-    mixer_check_idle(pConference->pMixer, tmHzElapsed);
+    }
 
-    //if(tmHzNow > tmHzMark + pConference->cfg.sampleRate) {
-      //fprintf(stderr, "\n\n%llu\n", time_getTime()/1000);
-      //mixer_dump(stderr, pConference->pMixer, 1, NULL);
-    //  tmHzMark = tmHzNow;
-    //}
-    //fprintf(stderr, "tsHzNow:%lluHz, actual tm:%lluHz delta:%lluHz\n", pConference->tsHzNow, tmHzElapsed, pConference->tsHzNow < tmHzElapsed ? tmHzElapsed-pConference->tsHzNow : pConference->tsHzNow-tmHzElapsed);
+    //TODO: since the time skips forward, allow the mixer to de-activate any idle streams
+    // and then need to get all the queued samples from other active streams, w/o time skip
 
-    if(pConference->tsHzNow + resetThresholdHz < tmHzElapsed) {
+    setConferenceTsHz(pConference, tmHzElapsed);
 
-      if(participantCount > 0) {
-        LOG(X_WARNING("Reset mixer clock by %lluHz, %llu -> %llu, threshold: %uHz, after %lluHz output samples"), 
-           (tmHzElapsed - pConference->tsHzNow), pConference->tsHzNow, tmHzElapsed, resetThresholdHz, tsHzProduced);
-        mixer_dumpLog(S_DEBUG, pConference->pMixer, 1, "after mixer clock reset");
-        //tmHzMark = tmHzNow;
-        //mixer_reset_sources(pConference->pMixer);
+    //TODO: should we run mixer_check_idle here since the time skipped forward
+    mixer_check_idle(pConference->pMixer, tmHzElapsed);
 
+  }
 
-      }
+  if(participantCount < 1) {
 
-      //TODO: since the time skips forward, allow the mixer to de-activate any idle streams
-      // and then need to get all the queued samples from other active streams, w/o time skip
+    setConferenceTsHz(pConference, tmHzElapsed);
+    pConference->tsHzProduced = 0;
+    rc = -1;
 
-      setConferenceTsHz(pConference, tmHzElapsed);
+  } else if((rc = mixer_mix(pConference->pMixer, pConference->tsHzNow)) > 0) {
 
-      //TODO: should we run mixer_check_idle here since the time skipped forward
-      mixer_check_idle(pConference->pMixer, tmHzElapsed);
+    setConferenceTsHz(pConference, pConference->tsHzNow + rc);
+    pConference->tsHzProduced += rc;
 
-    }
+#if defined(DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
+    //LOG(X_DEBUG("---mixer %llu.%llu produced rc:%d (tsHzProduced:%llu), tsHzNow at: %lluHz"), time_getTime()/1000000, time_getTime()%1000000, rc, pConference->tsHzProduced, pConference->tsHzNow);
+#endif // (DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
 
+  }
 
-    //TODO: mixer needs to be called in a loop while rc > 0
+  return rc;
+}
 
-    if(participantCount < 1) {
+static void mixer_runproc(void *pArg) {
+  int rc;
+  AUDIO_CONFERENCE_T *pConference = (AUDIO_CONFERENCE_T *) pArg;
+  const unsigned int sleepMs = 5;
+#if defined(DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
+  TIME_STAMP_T tmLastDump = time_getTime();
+  TIME_STAMP_T t0;
+#endif // (DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
 
-        setConferenceTsHz(pConference, tmHzElapsed);
-        tsHzProduced = 0;
+  //
+  // This thread procedure is used to run the mixer
+  //
 
-        usleep(sleepMs * 1000);
+  logutil_tid_add(pthread_self(), pConference->tid_tag);
 
-    } else if((rc = mixer_mix(pConference->pMixer, pConference->tsHzNow)) < 0) {
+  pConference->tdFlagMixer = THREAD_FLAG_RUNNING;
 
-#if defined(DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
-        TIME_STAMP_T t0 = time_getTime();
-#endif // (DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
+  LOG(X_DEBUG("Mixer master thread for conference id %d started"), pConference->id);
 
-        usleep(sleepMs * 1000);
+  conference_mix_start(pConference);
 
-#if defined(DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
-        LOG(X_DEBUG("---mixer (rc:%d) slept for %lld ns"), rc, time_getTime() - t0);
-#endif // (DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
+  while(pConference->tdFlagMixer == THREAD_FLAG_RUNNING) {
 
-    } else if(rc == 0) {
+    if((rc = conference_mix_step(pConference)) > 0) {
 
-#if defined(DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
-        TIME_STAMP_T t0 = time_getTime();
-        //LOG(X_DEBUG("---mixer %llu.%llu (rc:0) sleeping)", t0/1000000, t0%1000000);
-#endif // (DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
+      mixer_cond_broadcast(&pConference->condOutput, &pConference->mtxOutput);
 
-        usleep(sleepMs * 1000);
+    } else {
 
 #if defined(DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
-        //LOG(X_DEBUG("---mixer %llu.%llu (rc:0) slept for %lld ns"), time_getTime()/1000000, time_getTime()%1000000, time_getTime() - t0);
+      t0 = time_getTime();
 #endif // (DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
 
-    } else if(rc > 0) {
-
-      setConferenceTsHz(pConference, pConference->tsHzNow + rc);
-      tsHzProduced += rc;
+      usleep(sleepMs * 1000);
 
 #if defined(DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
-      //LOG(X_DEBUG("---mixer %llu.%llu produced rc:%d (tsHzProduced:%llu), tsHzNow at: %lluHz"), time_getTime()/1000000, time_getTime()%1000000, rc, tsHzProduced + rc, pConference->tsHzNow);
+      LOG(X_DEBUG("---mixer (rc:%d) slept for %lld ns"), rc, time_getTime() - t0);
 #endif // (DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
 
-      mixer_cond_broadcast(&pConference->condOutput, &pConference->mtxOutput);
-
     }
 
 #if defined(DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
     if(time_getTime() - tmLastDump > 200000) {
       tmLastDump = time_getTime();
-      //LOG(X_DEBUG("---mixer %llu.%llu dumping mixer, tsHzProduced:%lluHz"), time_getTime()/1000000, time_getTime()%1000000,  tsHzProduced);
+      //LOG(X_DEBUG("---mixer %llu.%llu dumping mixer, tsHzProduced:%lluHz"), time_getTime()/1000000, time_getTime()%1000000,  pConference->tsHzProduced);
       mixer_dumpLog(S_DEBUG, pConference->pMixer, 1, "from conf");
     }
 #endif // (DEBUG_MIXER_TIMING) && (DEBUG_MIXER_TIMING > 0)
@@ -288,12 +291,47 @@ static AUDIO_CONFERENCE_T *conference_create_internal(LOG_CTXT_T *logCtxt,
     return NULL;
   }
 
+  if(!(pConference->pEncCache = enccache_create())) {
+    conference_destroy(pConference);
+    return NULL;
+  }
+
+  if(pConference->cfg.maxSpeakers > 0) {
+
+    if(pConference->cfg.speakerHoldMs <= 0) {
+      pConference->cfg.speakerHoldMs = MIXER_SPEAKER_HOLD_MS;
+    }
+
+    LOG(X_DEBUG("Mixing top %d active speakers with %dms hold time"), 
+        pConference->cfg.maxSpeakers, pConference->cfg.speakerHoldMs);
+
+    mixer_set_speakers(pConference->pMixer, pConference->cfg.maxSpeakers,
+                       pConference->cfg.speakerHoldMs * pConference->cfg.sampleRate / 1000);
+  }
+
 
   //
   // Record the start of absolute time for the mixer conference
   //
   pConference->tmStart = time_getTime();
 
+  if(pConference->cfg.schedulerWorkers > 0) {
+
+    //
+    // Run the conference on the shared mixer scheduler instead of a dedicated mixer thread
+    //
+    pConference->scheduled = 1;
+    conference_mix_start(pConference);
+
+    if(mixer_scheduler_register(pConference) < 0) {
+      pConference->scheduled = 0;
+      conference_destroy(pConference);
+      return NULL;
+    }
+
+    return pConference;
+  }
+
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
 
@@ -424,6 +462,11 @@ void conference_destroy(AUDIO_CONFERENCE_T *pConference) {
     }
   }
 
+  if(pConference->scheduled) {
+    mixer_scheduler_unregister(pConference);
+    pConference->scheduled = 0;
+  }
+
   while(pConference->tdFlagMixer > THREAD_FLAG_STOPPED) {
     pConference->tdFlagMixer = THREAD_FLAG_DOEXIT;
     usleep(5000);
@@ -434,6 +477,11 @@ void conference_destroy(AUDIO_CONFERENCE_T *pConference) {
     pConference->pMixer = NULL;
   }
 
+  if(pConference->pEncCache) {
+    enccache_free(pConference->pEncCache);
+    pConference->pEncCache = NULL;
+  }
+
   if(pConference->pConfig) {
     config_free(pConference->pConfig);
     pConference->pConfig = NULL;
@@ -0,0 +1,172 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include "mixer/enccache.h"
+
+
+ENC_CACHE_T *enccache_create() {
+  ENC_CACHE_T *pCache;
+
+  if(!(pCache = (ENC_CACHE_T *) calloc(1, sizeof(ENC_CACHE_T)))) {
+    return NULL;
+  }
+
+  pthread_mutex_init(&pCache->mtx, NULL);
+  pthread_cond_init(&pCache->cond, NULL);
+
+  return pCache;
+}
+
+void enccache_free(ENC_CACHE_T *pCache) {
+
+  if(pCache) {
+    pthread_cond_destroy(&pCache->cond);
+    pthread_mutex_destroy(&pCache->mtx);
+    free(pCache);
+  }
+
+}
+
+static ENC_CACHE_ENTRY_T *enccache_find(ENC_CACHE_T *pCache,
+                                        const MIXER_ENCODED_KEY_T *pKey,
+                                        uint64_t sig,
+                                        uint64_t tsHz) {
+  unsigned int idx;
+
+  for(idx = 0; idx < ENC_CACHE_ENTRIES; idx++) {
+    if(pCache->entries[idx].state != ENC_CACHE_STATE_FREE &&
+       pCache->entries[idx].sig == sig &&
+       pCache->entries[idx].tsHz == tsHz &&
+       !memcmp(&pCache->entries[idx].key, pKey, sizeof(MIXER_ENCODED_KEY_T))) {
+      return &pCache->entries[idx];
+    }
+  }
+
+  return NULL;
+}
+
+int enccache_claim(ENC_CACHE_T *pCache,
+                   const MIXER_ENCODED_KEY_T *pKey,
+                   uint64_t sig,
+                   uint64_t tsHz,
+                   unsigned char *pData,
+                   unsigned int len) {
+  ENC_CACHE_ENTRY_T *pEntry;
+  unsigned int idx, gen;
+  TIME_STAMP_T tmEnd;
+  struct timespec ts;
+  int rc = -1;
+
+  if(!pCache || !pKey || sig == MIXER_OUTPUT_SIG_NONE) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&pCache->mtx);
+
+  if((pEntry = enccache_find(pCache, pKey, sig, tsHz))) {
+
+    //
+    // Wait for the participant holding the claim to finish encoding the frame
+    //
+    gen = pEntry->gen;
+    tmEnd = time_getTime() + ENC_CACHE_CLAIM_WAIT_MS * 1000;
+    ts.tv_sec = tmEnd / TIME_VAL_US;
+    ts.tv_nsec = (tmEnd % TIME_VAL_US) * 1000;
+
+    while(pEntry->state == ENC_CACHE_STATE_INFLIGHT && pEntry->gen == gen) {
+      if(pthread_cond_timedwait(&pCache->cond, &pCache->mtx, &ts) != 0) {
+        break;
+      }
+    }
+
+    if(pEntry->state == ENC_CACHE_STATE_VALID && pEntry->gen == gen && pEntry->len <= len) {
+      memcpy(pData, pEntry->data, pEntry->len);
+      rc = pEntry->len;
+    }
+
+  } else {
+
+    //
+    // Claim the oldest entry which is not being encoded
+    //
+    for(idx = 0; idx < ENC_CACHE_ENTRIES; idx++) {
+
+      pEntry = &pCache->entries[pCache->idxWr];
+      if(++pCache->idxWr >= ENC_CACHE_ENTRIES) {
+        pCache->idxWr = 0;
+      }
+
+      if(pEntry->state != ENC_CACHE_STATE_INFLIGHT) {
+        pEntry->state = ENC_CACHE_STATE_INFLIGHT;
+        pEntry->gen = ++pCache->gen;
+        pEntry->sig = sig;
+        pEntry->tsHz = tsHz;
+        memcpy(&pEntry->key, pKey, sizeof(MIXER_ENCODED_KEY_T));
+        pEntry->len = 0;
+        rc = MIXER_ENCODED_CLAIMED;
+        break;
+      }
+    }
+
+  }
+
+  pthread_mutex_unlock(&pCache->mtx);
+
+  return rc;
+}
+
+void enccache_store(ENC_CACHE_T *pCache,
+                    const MIXER_ENCODED_KEY_T *pKey,
+                    uint64_t sig,
+                    uint64_t tsHz,
+                    const unsigned char *pData,
+                    int len) {
+  ENC_CACHE_ENTRY_T *pEntry;
+
+  if(!pCache || !pKey) {
+    return;
+  }
+
+  pthread_mutex_lock(&pCache->mtx);
+
+  if((pEntry = enccache_find(pCache, pKey, sig, tsHz)) && pEntry->state == ENC_CACHE_STATE_INFLIGHT) {
+
+    if(len >= 0 && len <= sizeof(pEntry->data)) {
+      memcpy(pEntry->data, pData, len);
+      pEntry->len = len;
+      pEntry->state = ENC_CACHE_STATE_VALID;
+    } else {
+      pEntry->state = ENC_CACHE_STATE_FREE;
+    }
+
+    pthread_cond_broadcast(&pCache->cond);
+  }
+
+  pthread_mutex_unlock(&pCache->mtx);
+
+}
@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 #include <pthread.h>
 #include "logutil.h"
 #include "mixer/mixer_int.h"
@@ -67,6 +68,81 @@ static void dump_vad(MIXER_SOURCE_T *pSource) {
 }
 #endif // (MIXER_DUMP_VAD)
 
+static uint64_t source_sig(MIXER_ID id) {
+  uint64_t sig = (uint64_t) id;
+
+  //
+  // Per source mix signature term.  The signature of a mix is the sum of the terms
+  // of its contributing sources, so a source can be removed from a mix signature by subtraction.
+  //
+  sig = (sig ^ (sig >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  sig = (sig ^ (sig >> 27)) * 0x94d049bb133111ebULL;
+
+  return sig ^ (sig >> 31);
+}
+
+static void mixchannels_output(MIXER_SOURCE_T *pSourceSelf,
+                               float val,
+                               int vad_tot,
+                               unsigned int mixedSources,
+                               uint64_t sig) {
+  float gain;
+  unsigned int sigIdx;
+
+  //
+  // Determine a reasonable gain multiplier for the output channel
+  //
+  if(mixedSources > 1) {
+    gain = 0.9f;
+    val *= gain;
+  }
+
+  if(val > 1.0f) {
+    val = 1.0f;
+  } else if(val < -1.0f) {
+    val = -1.0f;
+  }
+
+//fprintf(stderr, "vad: %d val:%.3f  %d,   ", vad, val, (int16_t) (val * 32768.0f));
+
+  if(pSourceSelf->pOutput->buf.buffer) {
+    pSourceSelf->pOutput->buf.buffer[pSourceSelf->pOutput->buf.samplesWrIdx] = (int16_t) (val * 32768.0f);
+    //fprintf(stderr, "SAMPLE[%d] %d, gain:%.3f, vad:%d\n", pSourceSelf->pOutput->buf.samplesWrIdx, (int16_t) (val * 32768.0f), pSources[idxSource]->gain, vad);
+
+    //
+    // Set the output channel VAD confidence value
+    //
+    if(pSourceSelf->pOutput->vad_buffer) {
+      unsigned int vadIdx = pSourceSelf->pOutput->buf.samplesWrIdx / pSourceSelf->preproc.chunkHz;
+
+      if(vadIdx != pSourceSelf->pOutput->priorVadIdx) {
+
+        pSourceSelf->pOutput->vad_buffer[vadIdx] = mixedSources > 0 ? (vad_tot / mixedSources) : 0;
+
+        pSourceSelf->pOutput->priorVadIdx = vadIdx;
+      }
+
+    }
+
+    //
+    // Record the mix signature of each output chunk, or MIXER_OUTPUT_SIG_NONE if the chunk
+    // contains samples of differing mixes
+    //
+    if(pSourceSelf->pOutput->sig_buffer) {
+      sigIdx = pSourceSelf->pOutput->buf.samplesWrIdx / pSourceSelf->preproc.chunkHz;
+
+      if(pSourceSelf->pOutput->buf.samplesWrIdx % pSourceSelf->preproc.chunkHz == 0) {
+        pSourceSelf->pOutput->sig_buffer[sigIdx] = sig;
+      } else if(pSourceSelf->pOutput->sig_buffer[sigIdx] != sig) {
+        pSourceSelf->pOutput->sig_buffer[sigIdx] = MIXER_OUTPUT_SIG_NONE;
+      }
+    }
+
+    ADVANCE_WR(pSourceSelf->pOutput->buf);
+  }
+
+}
+
 static void mixchannels_noself(MIXER_T *pMixer,
                                MIXER_SOURCE_T *pSources[], 
                                unsigned int numSources,
@@ -76,7 +152,8 @@ static void mixchannels_noself(MIXER_T *pMixer,
   unsigned int mixedSources = 0;
   unsigned int idxSource, vadIdx;
   float val = 0;
-  float gain;
+  uint64_t sig = 0;
+  int haveSig = pSourceSelf->pOutput->sig_buffer ? 1 : 0;
 
   for(idxSource = 0; idxSource < numSources; idxSource++) {
 
@@ -112,46 +189,217 @@ if(vad != s_vad) { fprintf(stderr, "mixing source id:%d change in vad[%d]:%d (sa
               pSources[idxSource]->gain );
       mixedSources++;
       vad_tot += vad;
+      if(haveSig) {
+        sig += pSources[idxSource]->sig;
+      }
     }
 
   }
 
-  //
-  // Determine a reasonable gain multiplier for the output channel
-  //
-  if(mixedSources > 1) {
-    gain = 0.9f;
-    val *= gain;
+  mixchannels_output(pSourceSelf, val, vad_tot, mixedSources, sig);
+
+}
+
+static void mixchannels_all(MIXER_T *pMixer,
+                            MIXER_SOURCE_T *pSources[], 
+                            unsigned int numSources,
+                            u_int64_t tsHz) {
+  unsigned int idxSource;
+
+  for(idxSource = 0; idxSource < numSources; idxSource++) {
+
+    if(!pSources[idxSource]->pOutput) {
+      continue;
+    }
+
+    if(!pSources[idxSource]->pOutput->buf.haveTsHz) {
+
+      //
+      // Set tsHz as the time of the first stored sample in the buffer
+      //
+      pSources[idxSource]->pOutput->buf.tsHz = tsHz;
+      pSources[idxSource]->pOutput->buf.haveTsHz = 1;
+    }
+
+    mixchannels_noself(pMixer, pSources, numSources, pSources[idxSource]);
   }
 
-  if(val > 1.0f) {
-    val = 1.0f;
-  } else if(val < -1.0f) {
-    val = -1.0f;
+}
+
+static int source_vad(const MIXER_SOURCE_T *pSource) {
+  unsigned int vadIdx;
+
+  if(pSource->preproc.vad_buffer) {
+    vadIdx = pSource->buf.samplesRdIdx / pSource->preproc.chunkHz;
+    return pSource->preproc.vad_buffer[vadIdx];
   }
 
-//fprintf(stderr, "vad: %d val:%.3f  %d,   ", vad, val, (int16_t) (val * 32768.0f));
+  return 1;
+}
 
-  if(pSourceSelf->pOutput->buf.buffer) {
-    pSourceSelf->pOutput->buf.buffer[pSourceSelf->pOutput->buf.samplesWrIdx] = (int16_t) (val * 32768.0f);
-    //fprintf(stderr, "SAMPLE[%d] %d, gain:%.3f, vad:%d\n", pSourceSelf->pOutput->buf.samplesWrIdx, (int16_t) (val * 32768.0f), pSources[idxSource]->gain, vad);
+static float source_energy(const MIXER_SOURCE_T *pSource, unsigned int numSamples) {
+  unsigned int idx, rdIdx;
+  int64_t tot = 0;
 
+  if(pSource->preproc.energy_buffer) {
     //
-    // Set the output channel VAD confidence value
+    // Use the level of the preprocessed chunk at the current read position
     //
-    if(pSourceSelf->pOutput->vad_buffer) {
-      unsigned int vadIdx = pSourceSelf->pOutput->buf.samplesWrIdx / pSourceSelf->preproc.chunkHz;
+    return pSource->preproc.energy_buffer[pSource->buf.samplesRdIdx / pSource->preproc.chunkHz];
+  }
 
-      if(vadIdx != pSourceSelf->pOutput->priorVadIdx) {
+  //
+  // Without a preprocessor compute the level of the samples about to be mixed
+  //
+  numSamples = MIN(numSamples, pSource->preproc.chunkHz);
+  rdIdx = pSource->buf.samplesRdIdx;
+  for(idx = 0; idx < numSamples; idx++) {
+    tot += (int32_t) pSource->buf.buffer[rdIdx] * pSource->buf.buffer[rdIdx];
+    if(++rdIdx >= pSource->buf.samplesSz) {
+      rdIdx = 0;
+    }
+  }
 
-        pSourceSelf->pOutput->vad_buffer[vadIdx] = mixedSources > 0 ? (vad_tot / mixedSources) : 0;
+  return numSamples > 0 ? sqrtf((float) (tot / numSamples)) : 0;
+}
 
-        pSourceSelf->pOutput->priorVadIdx = vadIdx;
+#define SPEAKER_SMOOTHING_RAISE_FACTOR  2.0f
+#define SPEAKER_SMOOTHING_LOWER_FACTOR  8.0f
+#define SPEAKER_MIN_ENERGY              64.0f
+
+static void select_speakers(MIXER_T *pMixer,
+                            MIXER_SOURCE_T *pSources[], 
+                            unsigned int numSources, 
+                            unsigned int numSamples,
+                            u_int64_t tsHz) {
+  unsigned int idxSource;
+  unsigned int numSelected = 0;
+  int selected[MAX_MIXER_SOURCES];
+  int held[MAX_MIXER_SOURCES];
+  int idxBest;
+  float level;
+  MIXER_SOURCE_T *pSource;
+
+  //
+  // Update the smoothed speech level of each source.  Only samples flagged as speech by 
+  // the VAD contribute, so background noise from idle microphones decays away.
+  //
+  for(idxSource = 0; idxSource < numSources; idxSource++) {
+
+    pSource = pSources[idxSource];
+    selected[idxSource] = 0;
+
+    level = (pSource->active && source_vad(pSource) > 0) ? source_energy(pSource, numSamples) : 0;
+    pSource->speechEnergy += (level - pSource->speechEnergy) / 
+           (level > pSource->speechEnergy ? SPEAKER_SMOOTHING_RAISE_FACTOR : SPEAKER_SMOOTHING_LOWER_FACTOR);
+
+    if(pSource->isSpeaker && level > 0) {
+      pSource->speakerHoldTsHz = tsHz + pMixer->speakerHoldHz;
+    }
+
+    held[idxSource] = (pSource->active && pSource->isSpeaker && pSource->speakerHoldTsHz > tsHz) ? 1 : 0;
+  }
+
+  //
+  // Select up to maxSpeakers sources, preferring speakers still within their hold time
+  // and then the loudest
+  //
+  while(numSelected < pMixer->maxSpeakers) {
+
+    idxBest = -1;
+
+    for(idxSource = 0; idxSource < numSources; idxSource++) {
+
+      if(selected[idxSource] || (!held[idxSource] && pSources[idxSource]->speechEnergy < SPEAKER_MIN_ENERGY)) {
+        continue;
       }
 
+      if(idxBest < 0 || held[idxSource] > held[idxBest] || 
+         (held[idxSource] == held[idxBest] && 
+          pSources[idxSource]->speechEnergy > pSources[idxBest]->speechEnergy)) {
+        idxBest = idxSource;
+      }
     }
 
-    ADVANCE_WR(pSourceSelf->pOutput->buf);
+    if(idxBest < 0) {
+      break;
+    }
+
+    selected[idxBest] = 1;
+    numSelected++;
+  }
+
+  for(idxSource = 0; idxSource < numSources; idxSource++) {
+
+    pSource = pSources[idxSource];
+
+    if(selected[idxSource] && !pSource->isSpeaker) {
+
+      LOG(X_DEBUGV("mixer sourceid:%d selected as active speaker, level:%.1f"), pSource->id, pSource->speechEnergy);
+      pSource->isSpeaker = 1;
+      pSource->speakerHoldTsHz = tsHz + pMixer->speakerHoldHz;
+
+    } else if(!selected[idxSource] && pSource->isSpeaker) {
+
+      LOG(X_DEBUGV("mixer sourceid:%d no longer an active speaker, level:%.1f"), pSource->id, pSource->speechEnergy);
+      pSource->isSpeaker = 0;
+    }
+  }
+
+}
+
+static void mixchannels_speakers(MIXER_T *pMixer,
+                                 MIXER_SOURCE_T *pSources[], 
+                                 unsigned int numSources,
+                                 u_int64_t tsHz) {
+  unsigned int idxSource;
+  float vals[MAX_MIXER_SOURCES];
+  int vads[MAX_MIXER_SOURCES];
+  float valTot = 0;
+  int vadTot = 0;
+  unsigned int mixedTot = 0;
+  uint64_t sigTot = 0;
+  int haveSig = pMixer->numSigOutputs > 0 ? 1 : 0;
+  MIXER_SOURCE_T *pSource;
+
+  //
+  // Sum the selected speakers once.  Each speaker hears the common mix less its own 
+  // contribution, every other listener hears the common mix as is.
+  //
+  for(idxSource = 0; idxSource < numSources; idxSource++) {
+
+    pSource = pSources[idxSource];
+    vals[idxSource] = 0;
+    vads[idxSource] = 0;
+
+    if(pSource->active && pSource->isSpeaker && (vads[idxSource] = source_vad(pSource)) > 0) {
+      vals[idxSource] = pSource->buf.buffer[pSource->buf.samplesRdIdx] / 32768.0f * pSource->gain;
+      valTot += vals[idxSource];
+      vadTot += vads[idxSource];
+      mixedTot++;
+      if(haveSig) {
+        sigTot += pSource->sig;
+      }
+    }
+  }
+
+  for(idxSource = 0; idxSource < numSources; idxSource++) {
+
+    if(!(pSource = pSources[idxSource])->pOutput) {
+      continue;
+    }
+
+    if(!pSource->pOutput->buf.haveTsHz) {
+      pSource->pOutput->buf.tsHz = tsHz;
+      pSource->pOutput->buf.haveTsHz = 1;
+    }
+
+    if(vads[idxSource] > 0 && pSource->includeSelfChannel == 0) {
+      mixchannels_output(pSource, valTot - vals[idxSource], vadTot - vads[idxSource], mixedTot - 1, 
+                         sigTot - pSource->sig);
+    } else {
+      mixchannels_output(pSource, valTot, vadTot, mixedTot, sigTot);
+    }
   }
 
 }
@@ -170,24 +418,16 @@ static int mixchannels(MIXER_T *pMixer,
 
 //fprintf(stderr, "MIX START rd:%d, wr:%d, numS:%d\n", pSources[0]->output.samplesRdIdx, pSources[0]->output.samplesWrIdx, pSources[0]->output.numSamples);
 
-  for(idxSample = 0; idxSample < numSamples; idxSample++) {
-
-    for(idxSource = 0; idxSource < numSources; idxSource++) {
-
-      if(!pSources[idxSource]->pOutput) {
-        continue;
-      }
-
-      if(!pSources[idxSource]->pOutput->buf.haveTsHz) {
+  if(pMixer->maxSpeakers > 0) {
+    select_speakers(pMixer, pSources, numSources, numSamples, tsHz);
+  }
 
-        //
-        // Set tsHz as the time of the first stored sample in the buffer
-        //
-        pSources[idxSource]->pOutput->buf.tsHz = tsHz;
-        pSources[idxSource]->pOutput->buf.haveTsHz = 1;
-      }
+  for(idxSample = 0; idxSample < numSamples; idxSample++) {
 
-      mixchannels_noself(pMixer, pSources, numSources, pSources[idxSource]);
+    if(pMixer->maxSpeakers > 0) {
+      mixchannels_speakers(pMixer, pSources, numSources, tsHz);
+    } else {
+      mixchannels_all(pMixer, pSources, numSources, tsHz);
     }
 
     for(idxSource = 0; idxSource < numSources; idxSource++) {
@@ -555,6 +795,24 @@ MIXER_T *mixer_init(LOG_CTXT_T *logCtxt,
   return pMixer;
 }
 
+int mixer_set_speakers(MIXER_T *pMixer,
+                       unsigned int maxSpeakers,
+                       unsigned int holdHz) {
+
+  if(!pMixer) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&pMixer->mtx);
+
+  pMixer->maxSpeakers = MIN(maxSpeakers, MAX_MIXER_SOURCES);
+  pMixer->speakerHoldHz = holdHz;
+
+  pthread_mutex_unlock(&pMixer->mtx);
+
+  return 0;
+}
+
 void mixer_free(MIXER_T *pMixer) {
 
   if(pMixer) {
@@ -583,6 +841,10 @@ int mixer_addsource(MIXER_T *pMixer,
 
       pMixer->p_sources[idx] = pSource;
       pMixer->numSources++;
+      pSource->sig = source_sig(pSource->id);
+      if(pSource->pOutput && pSource->pOutput->sig_buffer) {
+        pMixer->numSigOutputs++;
+      }
       //pSource->active = 1;
       rc = 0;
       break;
@@ -616,6 +878,9 @@ int mixer_removesource(MIXER_T *pMixer,
       if(pMixer->numSources > 0) {
         pMixer->numSources--;
       }
+      if(pSource->pOutput && pSource->pOutput->sig_buffer && pMixer->numSigOutputs > 0) {
+        pMixer->numSigOutputs--;
+      }
       rc = 0;
       break;
     }
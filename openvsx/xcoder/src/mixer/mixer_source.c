@@ -54,6 +54,10 @@ static void source_reset(MIXER_SOURCE_T *pSource, int lock) {
       pSource->pOutput->priorVadIdx = -1;
       memset(pSource->pOutput->vad_buffer, 0,  pSource->pOutput->vad_bufsz);
     }
+
+    if(pSource->pOutput->sig_buffer) {
+      memset(pSource->pOutput->sig_buffer, 0xff, pSource->pOutput->sig_bufsz * sizeof(uint64_t));
+    }
   }
 
 }
@@ -314,6 +318,13 @@ int addbuffered(MIXER_SOURCE_T *pSource,
 
         vadIdx = pSource->buf.samplesWrIdx / pPreproc->chunkHz;
         pPreproc->vad_buffer[vadIdx] = rc_vad;
+
+        //
+        // Store the level of the preprocessed chunk for active speaker selection
+        //
+        if(pPreproc->energy_buffer) {
+          pPreproc->energy_buffer[vadIdx] = audio_preproc_energy(pPreproc->buffer, pPreproc->bufferIdx);
+        }
       }
       
       //fprintf(stderr, "audio_preproc_exec: vadIdx[%d], vad:%d (persist:%d/%d), tsHz:%llu\n", vadIdx, rc_vad, pPreproc->vad_persist, pPreproc->cfg_vad_persist, pPreproc->tsHz);
@@ -493,6 +504,24 @@ MIXER_SOURCE_T *mixer_source_init(LOG_CTXT_T *logCtxt,
   return pSource;
 }
 
+int mixer_source_init_sig(MIXER_SOURCE_T *pSource) {
+
+  if(!pSource || !pSource->pOutput) {
+    return -1;
+  } else if(pSource->pOutput->sig_buffer) {
+    return 0;
+  }
+
+  pSource->pOutput->sig_bufsz = (pSource->pOutput->buf.samplesSz + pSource->preproc.chunkHz - 1) / 
+                                pSource->preproc.chunkHz;
+  if(!(pSource->pOutput->sig_buffer = (uint64_t *) malloc(pSource->pOutput->sig_bufsz * sizeof(uint64_t)))) {
+    return -1;
+  }
+  memset(pSource->pOutput->sig_buffer, 0xff, pSource->pOutput->sig_bufsz * sizeof(uint64_t));
+
+  return 0;
+}
+
 void mixer_source_free(MIXER_SOURCE_T *pSource) {
 
   if(!pSource) {
@@ -518,6 +547,11 @@ void mixer_source_free(MIXER_SOURCE_T *pSource) {
       pSource->pOutput->vad_buffer = NULL;
     }
 
+    if(pSource->pOutput->sig_buffer) {
+      free(pSource->pOutput->sig_buffer);
+      pSource->pOutput->sig_buffer = NULL;
+    }
+
     free(pSource->pOutput);
     pSource->pOutput = NULL;
   }
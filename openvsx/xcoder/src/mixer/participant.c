@@ -38,6 +38,7 @@
 #endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
 #include "mixer/conference.h"
 #include "mixer/participant.h"
+#include "mixer/scheduler.h"
 
 #define LOG_CTXT  (pParticipant ? pParticipant->logCtxt : NULL)
 
@@ -247,6 +248,19 @@ static PARTICIPANT_T *participant_create(AUDIO_CONFERENCE_T *pConference,
   pParticipant->pMixerSource->id = pParticipant->config.id;
   pParticipant->pMixerSource->pMixer = pParticipant->pConference->pMixer;
 
+  //
+  // Only record the output mix signature if the participant shares encoded output
+  //
+  if((pParticipant->config.output.shareEncoded 
+#if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+      || pParticipant->config.output.type == PARTICIPANT_TYPE_RTP_PCM
+#endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+     ) && mixer_source_init_sig(pParticipant->pMixerSource) < 0) {
+    LOG(X_ERROR("Failed to initialize mix signature for source participant id %d"), pParticipant->config.id);
+    participant_destroy(&pParticipant);
+    return NULL;
+  }
+
 #if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
 
   //
@@ -460,112 +474,135 @@ static void participant_reset(PARTICIPANT_T *pParticipant) {
 
 }
 
-static void participant_unpackdata_runproc(void *pArg) {
+static void participant_unpack_frame(PARTICIPANT_T *pParticipant, FRAME_NODE_T *pNode) {
   int rc;
-  PARTICIPANT_T *pParticipant = (PARTICIPANT_T *) pArg;
-  FRAME_NODE_T *pNode;
   int lostFrames;
   int16_t pcmSamplesBuf[sizeof(int16_t) * 4096];
   int16_t *pcmSamples;
   uint64_t tsHz;
   int vad = -1;
 
-  //
-  // This thread procedure is used to read en-queued RTP frames 
-  //
+  if(pParticipant->framesRcvd == 0 || pParticipant->pMixerSource->needInputReset) {
 
-  LOG(X_DEBUG("Mixer decoder thread starting for source participant %s"), 
-    participant_description(&pParticipant->config, (char *) pcmSamplesBuf, sizeof(pcmSamplesBuf)));
+    pParticipant->tmOffsetFromStartHz = participant_on_first_pcm(pParticipant, pNode->captureTm, pNode->ts);
+    pParticipant->pMixerSource->needInputReset = 0;
+
+  }
+  
+  tsHz = (pNode->ts - pParticipant->tsFirstFrame) + pParticipant->tmOffsetFromStartHz;
+
+  LOG(X_DEBUGV("frameq_pop audio len:%d seq:%u, ts:%u, tsHz:%lluHz, tmOffsetFromStart:%lluHz"), 
+      pNode->lenData, pNode->sequence, pNode->ts, tsHz, pParticipant->tmOffsetFromStartHz);
 
   //
-  // Initialization
+  // Handle any lost packets by looking at the gap in sequence #
   //
-  pParticipant->tdFlagUnpack = THREAD_FLAG_RUNNING;
-  participant_reset(pParticipant);
+  if(pParticipant->framesRcvd > 0 && 
+    (lostFrames = pNode->sequence - pParticipant->lastRcvdSeq - 1) > 0) {
 
-  while(pParticipant->tdFlagUnpack == THREAD_FLAG_RUNNING) {
+    tsHz = handle_lost_input(pParticipant, pNode, lostFrames);
+
+  }
+
+  rc = 0;
+  pcmSamples = pcmSamplesBuf;
+
+#if defined(MIXER_HAVE_SILK) && (MIXER_HAVE_SILK > 0)
+
+  if(IS_PARTICIPANT_TYPE_SILK(pParticipant->config.input.type)) {
 
     //
-    // Get a frame from the frame queue
-    //
-    if((pNode = frameq_popWait(pParticipant->pFrameQ))) {
+    // Decode the received audio frame
+    // 
+    if((rc = decoder_silk_decode(pParticipant->pSilkDecoder,
+                           pNode->pData,
+                           pNode->lenData,
+                           pcmSamplesBuf,
+                           sizeof(pcmSamplesBuf))) < 0) {
+      LOG(X_ERROR("decoder_silk_decode failed %d for frame length %d, rtp seq:%u, ts:%u"), rc, 
+                         pNode->sequence, pNode->lenData, pNode->ts);
+    }
 
-      if(pParticipant->framesRcvd == 0 || pParticipant->pMixerSource->needInputReset) {
+  } else 
+#endif // (MIXER_HAVE_SILK) && (MIXER_HAVE_SILK > 0)
 
-        pParticipant->tmOffsetFromStartHz = participant_on_first_pcm(pParticipant, pNode->captureTm, pNode->ts);
-        pParticipant->pMixerSource->needInputReset = 0;
+  if(IS_PARTICIPANT_TYPE_PCM(pParticipant->config.input.type)) {
 
-      }
-      
-      tsHz = (pNode->ts - pParticipant->tsFirstFrame) + pParticipant->tmOffsetFromStartHz;
+    if(pNode->lenData % sizeof(int16_t) == 1) {
+      vad = ((unsigned char *) pNode->pData)[pNode->lenData - 1];
+    } else {
+      vad = -1;
+    }
 
-      LOG(X_DEBUGV("frameq_pop audio len:%d seq:%u, ts:%u, tsHz:%lluHz, tmOffsetFromStart:%lluHz"), 
-          pNode->lenData, pNode->sequence, pNode->ts, tsHz, pParticipant->tmOffsetFromStartHz);
+    pcmSamples = pNode->pData;
+    rc = pNode->lenData / sizeof(int16_t); 
 
-      //
-      // Handle any lost packets by looking at the gap in sequence #
-      //
-      if(pParticipant->framesRcvd > 0 && 
-        (lostFrames = pNode->sequence - pParticipant->lastRcvdSeq - 1) > 0) {
+    //fprintf(stderr, "PCM INPUT FROM RTP samples:%d, length:%d haveVad:%d, vad:%d\n", rc, pNode->lenData, haveVad, vad);
+  }
 
-        tsHz = handle_lost_input(pParticipant, pNode, lostFrames);
+  if(rc > 0) {
+    participant_add_samples_to_mixer(pParticipant, pcmSamples, rc, tsHz, vad, NULL);
+    tsHz += rc; 
+  }
 
-      }
+  //fprintf(stderr, "decoder node len:%d seq:%u, ts:%u 0x%x 0x%x 0x%x 0x%x decoded %d samples, tsHz:%lluHz\n", pNode->lenData, pNode->sequence, pNode->ts, ((unsigned char *)pNode->pData)[0], ((unsigned char *)pNode->pData)[1], ((unsigned char *)pNode->pData)[2], ((unsigned char *)pNode->pData)[3] , rc, tsHz);
+//for(i=0;i<rc;i++)fprintf(stderr, "0x%x ", pcmSamplesBuf[i]);
 
-      rc = 0;
-      pcmSamples = pcmSamplesBuf;
+  //
+  // Update frame based statistics counters
+  //
+  pParticipant->framesRcvd++; 
+  pParticipant->lastRcvdSeq = pNode->sequence;
+  pParticipant->lastRcvdTs = tsHz;
 
-#if defined(MIXER_HAVE_SILK) && (MIXER_HAVE_SILK > 0)
 
-      if(IS_PARTICIPANT_TYPE_SILK(pParticipant->config.input.type)) {
+//static int fd; if(!fd) fd = open("decoded.pcm", O_RDWR | O_CREAT, 0666);
+//write(fd, pcmSamplesBuf, rc);
 
-        //
-        // Decode the received audio frame
-        // 
-        if((rc = decoder_silk_decode(pParticipant->pSilkDecoder,
-                               pNode->pData,
-                               pNode->lenData,
-                               pcmSamplesBuf,
-                               sizeof(pcmSamplesBuf))) < 0) {
-          LOG(X_ERROR("decoder_silk_decode failed %d for frame length %d, rtp seq:%u, ts:%u"), rc, 
-                             pNode->sequence, pNode->lenData, pNode->ts);
-        }
+}
 
-      } else 
-#endif // (MIXER_HAVE_SILK) && (MIXER_HAVE_SILK > 0)
+int participant_unpack_pending(PARTICIPANT_T *pParticipant) {
+  FRAME_NODE_T *pNode;
+  int count = 0;
 
-      if(IS_PARTICIPANT_TYPE_PCM(pParticipant->config.input.type)) {
+  //
+  // Non-blocking drain of the frame queue, used by the mixer scheduler unpack task
+  //
+  while((pNode = frameq_pop(pParticipant->pFrameQ))) {
+    participant_unpack_frame(pParticipant, pNode);
+    frameq_recycle(pParticipant->pFrameQ, pNode);
+    count++;
+  }
 
-        if(pNode->lenData % sizeof(int16_t) == 1) {
-          vad = ((unsigned char *) pNode->pData)[pNode->lenData - 1];
-        } else {
-          vad = -1;
-        }
+  return count;
+}
 
-        pcmSamples = pNode->pData;
-        rc = pNode->lenData / sizeof(int16_t); 
+static void participant_unpackdata_runproc(void *pArg) {
+  PARTICIPANT_T *pParticipant = (PARTICIPANT_T *) pArg;
+  FRAME_NODE_T *pNode;
+  char buf[PARTICIPANT_DESCRIPTION_BUFSZ];
 
-        //fprintf(stderr, "PCM INPUT FROM RTP samples:%d, length:%d haveVad:%d, vad:%d\n", rc, pNode->lenData, haveVad, vad);
-      }
+  //
+  // This thread procedure is used to read en-queued RTP frames 
+  //
 
-      if(rc > 0) {
-        participant_add_samples_to_mixer(pParticipant, pcmSamples, rc, tsHz, vad, NULL);
-        tsHz += rc; 
-      }
+  LOG(X_DEBUG("Mixer decoder thread starting for source participant %s"), 
+    participant_description(&pParticipant->config, buf, sizeof(buf)));
 
-      //fprintf(stderr, "decoder node len:%d seq:%u, ts:%u 0x%x 0x%x 0x%x 0x%x decoded %d samples, tsHz:%lluHz\n", pNode->lenData, pNode->sequence, pNode->ts, ((unsigned char *)pNode->pData)[0], ((unsigned char *)pNode->pData)[1], ((unsigned char *)pNode->pData)[2], ((unsigned char *)pNode->pData)[3] , rc, tsHz);
-//for(i=0;i<rc;i++)fprintf(stderr, "0x%x ", pcmSamplesBuf[i]);
+  //
+  // Initialization
+  //
+  pParticipant->tdFlagUnpack = THREAD_FLAG_RUNNING;
+  participant_reset(pParticipant);
 
-      //
-      // Update frame based statistics counters
-      //
-      pParticipant->framesRcvd++; 
-      pParticipant->lastRcvdSeq = pNode->sequence;
-      pParticipant->lastRcvdTs = tsHz;
+  while(pParticipant->tdFlagUnpack == THREAD_FLAG_RUNNING) {
 
+    //
+    // Get a frame from the frame queue
+    //
+    if((pNode = frameq_popWait(pParticipant->pFrameQ))) {
 
-//static int fd; if(!fd) fd = open("decoded.pcm", O_RDWR | O_CREAT, 0666);
-//write(fd, pcmSamplesBuf, rc);
+      participant_unpack_frame(pParticipant, pNode);
 
       //
       // Return the borrowed frame to the frame queue
@@ -587,7 +624,7 @@ static void participant_unpackdata_runproc(void *pArg) {
   mixer_removesource(pParticipant->pConference->pMixer, pParticipant->pMixerSource);
 
   LOG(X_DEBUG("Mixer decoder thread ending for source participant %s"), 
-    participant_description(&pParticipant->config, (char *) pcmSamplesBuf, sizeof(pcmSamplesBuf)));
+    participant_description(&pParticipant->config, buf, sizeof(buf)));
 
   //
   // Terminate this participant
@@ -627,15 +664,55 @@ static void participant_recvdata_runproc(void *pArg) {
 }
 
 
+static void encoded_cache_key(const PARTICIPANT_T *pParticipant, MIXER_ENCODED_KEY_T *pKey) {
+
+  //
+  // Participants with equal keys produce identical payloads from identical samples
+  //
+  memset(pKey, 0, sizeof(MIXER_ENCODED_KEY_T));
+  pKey->type = pParticipant->config.output.type;
+
+#if defined(MIXER_HAVE_SILK) && (MIXER_HAVE_SILK > 0)
+  if(IS_PARTICIPANT_TYPE_SILK(pParticipant->config.output.type)) {
+    pKey->sampleRate = pParticipant->encoderConfig.sampleRate;
+    pKey->bitRate = pParticipant->encoderConfig.bitRate;
+    pKey->complexity = pParticipant->encoderConfig.complexity;
+  } else 
+#endif // (MIXER_HAVE_SILK) && (MIXER_HAVE_SILK > 0)
+  if(pParticipant->config.output.type == PARTICIPANT_TYPE_RTP_PCM) {
+    pKey->param = pParticipant->config.output.u.rtpPcm.payloadMTU;
+    pKey->flags = pParticipant->pMixerSource->setOutputVad;
+  }
+
+}
+
 static int xmitAudio(PARTICIPANT_T *pParticipant,
                        const int16_t *pcmSamples,
                        unsigned int numSamples,
                        uint64_t tsHz,
-                       int vad) {
+                       int vad,
+                       uint64_t sig) {
   int rc = 0;
+  int claim;
   unsigned int indexHz = 0;
+  unsigned int frameHz;
   unsigned char buf[sizeof(int16_t) * ENCODED_AUDIO_BUF_SAMPLES_SZ];
   unsigned char *pOutData = NULL;
+  ENC_CACHE_T *pCache = pParticipant->pConference->pEncCache;
+  MIXER_ENCODED_KEY_T key;
+
+  //
+  // Track the mix signature of all the samples buffered for encoding
+  //
+  if(pParticipant->audioBufIndexHz == 0) {
+    pParticipant->audioBufSig = sig;
+  } else if(pParticipant->audioBufSig != sig) {
+    pParticipant->audioBufSig = MIXER_OUTPUT_SIG_NONE;
+  }
+
+  if(pCache) {
+    encoded_cache_key(pParticipant, &key);
+  }
 
   memcpy(&pParticipant->pAudioBuf[pParticipant->audioBufIndexHz], pcmSamples, sizeof(int16_t) * numSamples);
   pParticipant->audioBufIndexHz += numSamples;
@@ -643,6 +720,33 @@ static int xmitAudio(PARTICIPANT_T *pParticipant,
   while(indexHz < pParticipant->audioBufIndexHz) {
 
     rc = -1;
+    claim = -1;
+
+    if(pParticipant->config.output.type == PARTICIPANT_TYPE_RTP_PCM) {
+      frameHz = pParticipant->audioBufIndexHz - indexHz;
+    } else {
+      frameHz = pParticipant->audioFrameDurationHz;
+    }
+
+    //
+    // Participants hearing the same mix with the same codec parameters share the payload
+    // of whichever participant claimed the frame first.  Only stateless PCM output is 
+    // shared, since a SILK frame also depends on the prior frames seen by its encoder.
+    //
+    if(pCache && pParticipant->audioBufSig != MIXER_OUTPUT_SIG_NONE &&
+       pParticipant->config.output.type == PARTICIPANT_TYPE_RTP_PCM) {
+      key.frameHz = frameHz;
+      claim = enccache_claim(pCache, &key, pParticipant->audioBufSig, tsHz, buf, sizeof(buf));
+    }
+
+    if(claim >= 0) {
+
+      rc = claim;
+      pOutData = buf;
+      pParticipant->audioFrameDurationHz = frameHz;
+      pParticipant->framesShared++;
+
+    } else 
 
 #if defined(MIXER_HAVE_SILK) && (MIXER_HAVE_SILK > 0)
 
@@ -659,7 +763,8 @@ static int xmitAudio(PARTICIPANT_T *pParticipant,
           participant_description(&pParticipant->config, (char *) buf, sizeof(buf)));
 
         rc = 0;
-      } 
+      }
+      pParticipant->framesEncoded++;
 
     } else 
 
@@ -680,6 +785,10 @@ static int xmitAudio(PARTICIPANT_T *pParticipant,
         ((unsigned char *)pOutData)[rc++] = vad ? 0xff : 0x00;
       }
       //fprintf(stderr, "calling rtpstream_addpayload RAW PCM length:%d, vad:%d\n", rc, vad);
+      if(claim == MIXER_ENCODED_CLAIMED) {
+        enccache_store(pCache, &key, pParticipant->audioBufSig, tsHz, pOutData, rc);
+      }
+      pParticipant->framesEncoded++;
     }
 
     if(rc >= 0) {
@@ -720,10 +829,13 @@ static int participant_read_samples(PARTICIPANT_T *pParticipant,
                                     int16_t *pcmSamples, 
                                     unsigned int numSamplesMin,
                                     unsigned int numSamplesMax,
-                                    u_int64_t *ptsHz) {
+                                    u_int64_t *ptsHz,
+                                    uint64_t *psig) {
   int pcmCount = 0;
   unsigned int vadIdx, vadIdxStart = 0, vadIdxEnd;
   unsigned int vadChunkCnt = 0;
+  unsigned int sigIdx, sigIdxStart = 0, sigIdxEnd;
+  uint64_t sig;
   int vad;
   float vadTotal = 0, vadAvg = 0;
 
@@ -746,6 +858,14 @@ static int participant_read_samples(PARTICIPANT_T *pParticipant,
                                pParticipant->pMixerSource->preproc.chunkHz;
   }
 
+  if(psig) {
+    *psig = MIXER_OUTPUT_SIG_NONE;
+    if(pParticipant->pMixerSource->pOutput->sig_buffer) {
+      sigIdxStart = pParticipant->pMixerSource->pOutput->buf.samplesRdIdx /
+                                 pParticipant->pMixerSource->preproc.chunkHz;
+    }
+  }
+
   pcmCount = ringbuf_get(&pParticipant->pMixerSource->pOutput->buf,
                          pcmSamples,
                          pcmCount,
@@ -779,24 +899,128 @@ static int participant_read_samples(PARTICIPANT_T *pParticipant,
 #endif // (MIXER_DUMP_VAD)
   }
 
+  //
+  // The mix signature is only valid if every chunk read out carries the same signature
+  //
+  if(psig && pcmCount > 0 && pParticipant->pMixerSource->pOutput->sig_buffer) {
+    //
+    // Include the chunk of the last sample read, which may only have been partially read
+    //
+    sigIdxEnd = ((pParticipant->pMixerSource->pOutput->buf.samplesRdIdx + 
+                  pParticipant->pMixerSource->pOutput->buf.samplesSz - 1) % 
+                 pParticipant->pMixerSource->pOutput->buf.samplesSz) /
+                pParticipant->pMixerSource->preproc.chunkHz;
+    sigIdx = sigIdxStart;
+    sig = pParticipant->pMixerSource->pOutput->sig_buffer[sigIdx];
+    while(sigIdx != sigIdxEnd && sig != MIXER_OUTPUT_SIG_NONE) {
+
+      if(++sigIdx >= pParticipant->pMixerSource->pOutput->sig_bufsz) {
+        sigIdx = 0;
+      }
+
+      if(pParticipant->pMixerSource->pOutput->sig_buffer[sigIdx] != sig) {
+        sig = MIXER_OUTPUT_SIG_NONE;
+      }
+    }
+    *psig = sig;
+  }
+
   pthread_mutex_unlock(&pParticipant->pMixerSource->pOutput->buf.mtx);
 
   return pcmCount;
 }
 
 
-static void participant_output_runproc(void *pArg) {
+int participant_output_process(PARTICIPANT_T *pParticipant) {
+#if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
   int rc;
+#endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
   int pcmCount;
+  int outSamples = 0;
   u_int64_t tsHz;
-  unsigned int outSamplesTot = 0;
   //int16_t pcmSamples[sizeof(int16_t) * 4096];
   int16_t pcmSamples[sizeof(int16_t) * MIXER_MAX_SAMPLE_RATE * MIXER_OUTPUT_CHUNKSZ_MS / 1000];
   int vad = 0;
+  uint64_t sig = MIXER_OUTPUT_SIG_NONE;
+  TIME_STAMP_T tm;
+  int64_t jitterUs;
+
+  do { 
+
+    //
+    // Read a MIXER_OUTPUT_CHUNK_MS (20ms) chunk of output samples
+    //
+    pcmCount = pParticipant->pMixerSource->clockHz * MIXER_OUTPUT_CHUNKSZ_MS / 1000;
+
+    if((pcmCount = participant_read_samples(pParticipant, 
+                                            &vad, 
+                                            pcmSamples, 
+                                            pcmCount,
+                                            pcmCount,
+                                            &tsHz,
+                                            &sig)) <= 0) {
+      break;
+    }
+
+    tm = time_getTime();
+    if(pParticipant->outSamplesTot == 0) {
+      pParticipant->tmOutputStart = tm;
+    } 
+
+    jitterUs = (tm - pParticipant->tmOutputStart) - 
+               ((int64_t) pParticipant->outSamplesTot *1000000 / pParticipant->pMixerSource->clockHz);
+
+    pParticipant->outSamplesTot += pcmCount;
+    outSamples += pcmCount;
+
+    //fprintf(stderr, "----- elapsed:%llu us, %uHz (%llu us), jitter:%lld us\n", (tm - pParticipant->tmOutputStart), pParticipant->outSamplesTot, ((int64_t)pParticipant->outSamplesTot *1000000 / pParticipant->pMixerSource->clockHz), jitterUs);
+    LOG(X_DEBUGV("output_runproc %llu.%llu jitter:%lldms, sourceid:%d ringbuf_get %d samples, rd[%d], wr[%d]/%d, numS:%d %lluHz"), 
+        tm/1000000, tm%1000000, jitterUs/1000, pParticipant->pMixerSource->id, pcmCount, 
+        pParticipant->pMixerSource->pOutput->buf.samplesRdIdx, pParticipant->pMixerSource->pOutput->buf.samplesWrIdx,
+        pParticipant->pMixerSource->pOutput->buf.samplesSz, pParticipant->pMixerSource->pOutput->buf.numSamples, 
+        pParticipant->pMixerSource->pOutput->buf.tsHz);
+
+
+    //
+    // Call any user-supplied callback to process the output samples 
+    //
+    if(pParticipant->config.output.type == PARTICIPANT_TYPE_CB_PCM &&
+       pParticipant->config.output.u.cb.cbSendSamples) {
+
+
+      pParticipant->config.output.u.cb.cbSendSamples(pParticipant->config.output.u.cb.pContext,
+                                                      pcmSamples,
+                                                      pcmCount,
+                                                      tsHz);
+                                                      
+    } 
+
+#if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+    else if(IS_PARTICIPANT_TYPE_RTP(pParticipant->config.output.type)) {
+
+      rc = xmitAudio(pParticipant,
+                       pcmSamples,
+                       pcmCount,
+                       tsHz,
+                       vad,
+                       sig);
+    }
+#endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+
+    if(pParticipant->pWavOutput) {
+      wav_write(pParticipant->pWavOutput, pcmSamples, pcmCount);
+    }
+
+  } while(pcmCount > 0);
+
+  return outSamples;
+}
+
+static void participant_output_runproc(void *pArg) {
+  int rc;
   PARTICIPANT_T *pParticipant = (PARTICIPANT_T *) pArg;
+  char buf[PARTICIPANT_DESCRIPTION_BUFSZ];
   //int logLevel = logger_GetLogLevel(LOG_CTXT);
-  TIME_STAMP_T tm, tm0 = 0;
-  int64_t jitterUs;
 
   //
   // This thread procedure is used to process mixed output PCM output
@@ -805,7 +1029,7 @@ static void participant_output_runproc(void *pArg) {
   pParticipant->tdFlagOutput = THREAD_FLAG_RUNNING;
 
   LOG(X_DEBUG("Mixer output thread for participant source participant %s"), 
-     participant_description(&pParticipant->config, (char *) pcmSamples, sizeof(pcmSamples)));
+     participant_description(&pParticipant->config, buf, sizeof(buf)));
  
   while(pParticipant->tdFlagOutput == THREAD_FLAG_RUNNING) {
 
@@ -820,70 +1044,7 @@ static void participant_output_runproc(void *pArg) {
 
     if(rc == 0) {
 
-      do { 
-
-        //
-        // Read a MIXER_OUTPUT_CHUNK_MS (20ms) chunk of output samples
-        //
-        pcmCount = pParticipant->pMixerSource->clockHz * MIXER_OUTPUT_CHUNKSZ_MS / 1000;
-
-        if((pcmCount = participant_read_samples(pParticipant, 
-                                                &vad, 
-                                                pcmSamples, 
-                                                pcmCount,
-                                                pcmCount,
-                                                &tsHz)) <= 0) {
-          break;
-        }
-
-        tm = time_getTime();
-        if(outSamplesTot == 0) {
-          tm0 = tm;
-        } 
-
-        jitterUs = (tm - tm0) - ((int64_t) outSamplesTot *1000000 / pParticipant->pMixerSource->clockHz);
-
-        outSamplesTot += pcmCount;
-
-        //fprintf(stderr, "----- elapsed:%llu us, %uHz (%llu us), jitter:%lld us\n", (tm - tm0), outSamplesTot, ((int64_t)outSamplesTot *1000000 / pParticipant->pMixerSource->clockHz), jitterUs);
-        //fprintf(stderr, "output_runproc %llu.%llu jitter:%lldms, sourceid:%d ringbuf_get %d samples, rd[%d], wr[%d]/%d, numS:%d %lluHz\n", 
-        LOG(X_DEBUGV("output_runproc %llu.%llu jitter:%lldms, sourceid:%d ringbuf_get %d samples, rd[%d], wr[%d]/%d, numS:%d %lluHz"), 
-            tm/1000000, tm%1000000, jitterUs/1000, pParticipant->pMixerSource->id, pcmCount, 
-            pParticipant->pMixerSource->pOutput->buf.samplesRdIdx, pParticipant->pMixerSource->pOutput->buf.samplesWrIdx,
-            pParticipant->pMixerSource->pOutput->buf.samplesSz, pParticipant->pMixerSource->pOutput->buf.numSamples, 
-            pParticipant->pMixerSource->pOutput->buf.tsHz);
-
-
-        //
-        // Call any user-supplied callback to process the output samples 
-        //
-        if(pParticipant->config.output.type == PARTICIPANT_TYPE_CB_PCM &&
-           pParticipant->config.output.u.cb.cbSendSamples) {
-
-
-          pParticipant->config.output.u.cb.cbSendSamples(pParticipant->config.output.u.cb.pContext,
-                                                          pcmSamples,
-                                                          pcmCount,
-                                                          tsHz);
-                                                          
-        } 
-
-#if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
-        else if(IS_PARTICIPANT_TYPE_RTP(pParticipant->config.output.type)) {
-
-          rc = xmitAudio(pParticipant,
-                           pcmSamples,
-                           pcmCount,
-                           tsHz,
-                           vad);
-        }
-#endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
-
-        if(pParticipant->pWavOutput) {
-          wav_write(pParticipant->pWavOutput, pcmSamples, pcmCount);
-        }
-
-      } while(pcmCount > 0);
+      participant_output_process(pParticipant);
 
       //pthread_mutex_unlock(&pParticipant->pMixerSource->output.mtx);
 
@@ -898,7 +1059,7 @@ static void participant_output_runproc(void *pArg) {
   } 
 
   LOG(X_DEBUG("Mixer output thread for source participant %s ending."),
-    participant_description(&pParticipant->config, (char *) pcmSamples, sizeof(pcmSamples)));
+    participant_description(&pParticipant->config, buf, sizeof(buf)));
 
   participant_stop(pParticipant);
 
@@ -910,9 +1071,11 @@ int mixer_read_audio_pcm(void *pContext,
                          int16_t *pcmSamples,
                          unsigned int numSamplesMin,
                          unsigned int numSamplesMax,
-                         int *pvad) {
+                         int *pvad,
+                         u_int64_t *ptsHz,
+                         uint64_t *psig) {
   int pcmCount;
-  u_int64_t tsHz;
+  u_int64_t tsHz = 0;
   PARTICIPANT_T *pParticipant = (PARTICIPANT_T *) pContext;
 
   if(!pParticipant || !pParticipant->pMixerSource || !pParticipant->pMixerSource->pOutput) {
@@ -926,15 +1089,60 @@ int mixer_read_audio_pcm(void *pContext,
                                       pcmSamples, 
                                       numSamplesMin,
                                       numSamplesMax,
-                                      &tsHz);
+                                      &tsHz,
+                                      psig);
 
   if(pcmCount > 0 && pParticipant->pWavOutput) {
     wav_write(pParticipant->pWavOutput, pcmSamples, pcmCount);
   }
 
+  if(ptsHz) {
+    *ptsHz = tsHz;
+  }
+
   return pcmCount;
 }
 
+int mixer_encoded_claim(void *pContext,
+                        const MIXER_ENCODED_KEY_T *pKey,
+                        uint64_t sig,
+                        u_int64_t tsHz,
+                        unsigned char *pData,
+                        unsigned int len) {
+  int rc;
+  PARTICIPANT_T *pParticipant = (PARTICIPANT_T *) pContext;
+
+  if(!pParticipant || !pParticipant->pConference) {
+    return -1;
+  }
+
+  if((rc = enccache_claim(pParticipant->pConference->pEncCache, pKey, sig, tsHz, pData, len)) >= 0) {
+    pParticipant->framesShared++;
+  }
+
+  return rc;
+}
+
+void mixer_encoded_store(void *pContext,
+                         const MIXER_ENCODED_KEY_T *pKey,
+                         uint64_t sig,
+                         u_int64_t tsHz,
+                         const unsigned char *pData,
+                         int len) {
+  PARTICIPANT_T *pParticipant = (PARTICIPANT_T *) pContext;
+
+  if(!pParticipant || !pParticipant->pConference) {
+    return;
+  }
+
+  enccache_store(pParticipant->pConference->pEncCache, pKey, sig, tsHz, pData, len);
+
+  if(len >= 0) {
+    pParticipant->framesEncoded++;
+  }
+
+}
+
 static int participant_startListener(PARTICIPANT_T *pParticipant) {
   pthread_attr_t attr;
   int rc = 0;
@@ -1011,7 +1219,14 @@ static int participant_startListener(PARTICIPANT_T *pParticipant) {
     pthread_attr_destroy(&attr);
   }
 
-  if(rc == 0 && (IS_PARTICIPANT_TYPE_RTP(pParticipant->config.input.type) ||
+  if(rc == 0 && pParticipant->pConference->scheduled) {
+
+    //
+    // Decoding of queued input frames is run as a mixer scheduler task 
+    //
+    participant_reset(pParticipant);
+
+  } else if(rc == 0 && (IS_PARTICIPANT_TYPE_RTP(pParticipant->config.input.type) ||
                  pParticipant->config.input.type == PARTICIPANT_TYPE_CB_SILK)) {
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
@@ -1030,7 +1245,8 @@ static int participant_startListener(PARTICIPANT_T *pParticipant) {
 
 #endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
 
-  if(rc == 0 && PARTICIPANT_HAVE_OUTPUT(pParticipant->config.output.type)) {
+  if(rc == 0 && PARTICIPANT_HAVE_OUTPUT(pParticipant->config.output.type) &&
+     !pParticipant->pConference->scheduled) {
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
     pParticipant->tdFlagOutput = THREAD_FLAG_STARTING;
@@ -1070,14 +1286,20 @@ static int participant_startListener(PARTICIPANT_T *pParticipant) {
   if(
 #if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
      (IS_PARTICIPANT_TYPE_RTP(pParticipant->config.input.type) && pParticipant->tdFlagCap == THREAD_FLAG_STOPPED) ||
-     (IS_PARTICIPANT_TYPE_RTP(pParticipant->config.input.type) && pParticipant->tdFlagUnpack == THREAD_FLAG_STOPPED) ||
+     (IS_PARTICIPANT_TYPE_RTP(pParticipant->config.input.type) && !pParticipant->pConference->scheduled &&
+      pParticipant->tdFlagUnpack == THREAD_FLAG_STOPPED) ||
 #endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
-     (PARTICIPANT_HAVE_OUTPUT(pParticipant->config.output.type) &&pParticipant->tdFlagOutput == THREAD_FLAG_STOPPED)) {
+     (PARTICIPANT_HAVE_OUTPUT(pParticipant->config.output.type) && !pParticipant->pConference->scheduled &&
+      pParticipant->tdFlagOutput == THREAD_FLAG_STOPPED)) {
 
     participant_stop(pParticipant);
     rc = -1; 
   }
 
+  if(rc == 0 && pParticipant->pConference->scheduled) {
+    pParticipant->schedReady = 1;
+  }
+
   return rc;
 }
 
@@ -1330,6 +1552,18 @@ int participant_remove_id(AUDIO_CONFERENCE_T *pConference, PARTICIPANT_ID id) {
 
   if(pParticipant) {
 
+    if(pConference->scheduled) {
+      //
+      // Wait for any mixer scheduler tasks referencing this participant to complete
+      //
+      mixer_scheduler_participant_wait(pParticipant);
+    }
+
+    if(pParticipant->framesEncoded + pParticipant->framesShared > 0) {
+      LOG(X_DEBUG("Mixer participant id %d output frames encoded: %u, shared: %u"), 
+          id, pParticipant->framesEncoded, pParticipant->framesShared);
+    }
+
 #if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
 
     //pthread_mutex_lock(&pParticipant->mtx);
@@ -0,0 +1,741 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#endif // __linux__
+#include "logutil.h"
+#include "mixer/conference.h"
+#include "mixer/scheduler.h"
+
+#define LOG_CTXT  NULL
+
+#define MIXER_SCHED_TASK_QUEUE_SZ    64
+#define MIXER_SCHED_MAX_MIX_LOOPS    16
+
+typedef enum MIXER_SCHED_TASK_TYPE {
+  MIXER_SCHED_TASK_TICK              = 0,
+  MIXER_SCHED_TASK_UNPACK            = 1,
+  MIXER_SCHED_TASK_OUTPUT            = 2,
+} MIXER_SCHED_TASK_TYPE_T;
+
+typedef struct MIXER_SCHED_CONF {
+  AUDIO_CONFERENCE_T         *pConference;
+  int                         busy;             // a tick is in progress
+  int                         removed;
+  unsigned int                pending;          // outstanding tasks of the current phase
+  TIME_STAMP_T                tmTick;           // start of the current tick
+  struct MIXER_SCHED_CONF    *pnext;
+} MIXER_SCHED_CONF_T;
+
+typedef struct MIXER_SCHED_TASK {
+  MIXER_SCHED_TASK_TYPE_T     type;
+  MIXER_SCHED_CONF_T         *pNode;
+  PARTICIPANT_T              *pParticipant;
+} MIXER_SCHED_TASK_T;
+
+typedef struct MIXER_SCHEDULER {
+  pthread_mutex_t             mtx;
+  pthread_cond_t              condWork;
+  pthread_cond_t              condIdle;
+  MIXER_SCHED_CONF_T         *pConfs;
+  unsigned int                refCount;
+  MIXER_SCHED_TASK_T         *pTasks;          // task ring
+  unsigned int                tasksSz;
+  unsigned int                tasksRdIdx;
+  unsigned int                numTasks;
+  unsigned int                numWorkers;
+  unsigned int                tickMs;
+  pthread_t                   ptdWorkers[MIXER_SCHEDULER_MAX_WORKERS];
+  enum THREAD_FLAG            tdFlagWorkers[MIXER_SCHEDULER_MAX_WORKERS];
+  pthread_t                   ptdTick;
+  enum THREAD_FLAG            tdFlagTick;
+  int                         fdEpoll;
+  int                         fdTimer;
+  int                         fdWake;
+  MIXER_SCHEDULER_STATS_T     stats;
+  TIME_STAMP_T                tmStats;
+} MIXER_SCHEDULER_T;
+
+static pthread_mutex_t g_mtxScheduler = PTHREAD_MUTEX_INITIALIZER;
+static MIXER_SCHEDULER_T *g_pScheduler;
+
+static TIME_STAMP_T sched_monotonic_us() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (TIME_STAMP_T) ts.tv_sec * TIME_VAL_US + ts.tv_nsec / 1000;
+}
+
+//
+// All task queue helpers are called with pSched->mtx held
+//
+static int sched_push(MIXER_SCHEDULER_T *pSched, MIXER_SCHED_TASK_TYPE_T type,
+                      MIXER_SCHED_CONF_T *pNode, PARTICIPANT_T *pParticipant) {
+  MIXER_SCHED_TASK_T *pTasks;
+  unsigned int idx;
+  unsigned int sz;
+
+  if(pSched->numTasks >= pSched->tasksSz) {
+
+    //
+    // Grow the ring, unrolling any wrapped entries into the new allocation
+    //
+    sz = pSched->tasksSz > 0 ? pSched->tasksSz * 2 : MIXER_SCHED_TASK_QUEUE_SZ;
+    if(!(pTasks = (MIXER_SCHED_TASK_T *) calloc(sz, sizeof(MIXER_SCHED_TASK_T)))) {
+      return -1;
+    }
+    for(idx = 0; idx < pSched->numTasks; idx++) {
+      pTasks[idx] = pSched->pTasks[(pSched->tasksRdIdx + idx) % pSched->tasksSz];
+    }
+    free(pSched->pTasks);
+    pSched->pTasks = pTasks;
+    pSched->tasksSz = sz;
+    pSched->tasksRdIdx = 0;
+  }
+
+  idx = (pSched->tasksRdIdx + pSched->numTasks) % pSched->tasksSz;
+  pSched->pTasks[idx].type = type;
+  pSched->pTasks[idx].pNode = pNode;
+  pSched->pTasks[idx].pParticipant = pParticipant;
+  pSched->numTasks++;
+
+  return 0;
+}
+
+static int sched_pop(MIXER_SCHEDULER_T *pSched, MIXER_SCHED_TASK_T *pTask) {
+
+  if(pSched->numTasks == 0) {
+    return -1;
+  }
+
+  *pTask = pSched->pTasks[pSched->tasksRdIdx];
+  pSched->tasksRdIdx = (pSched->tasksRdIdx + 1) % pSched->tasksSz;
+  pSched->numTasks--;
+
+  return 0;
+}
+
+static void sched_finish_tick(MIXER_SCHEDULER_T *pSched, MIXER_SCHED_CONF_T *pNode) {
+  unsigned int procUs;
+
+  pthread_mutex_lock(&pSched->mtx);
+
+  procUs = (unsigned int) (sched_monotonic_us() - pNode->tmTick);
+  pSched->stats.procUsTot += procUs;
+  pSched->stats.numProc++;
+  if(procUs > pSched->stats.procUsMax) {
+    pSched->stats.procUsMax = procUs;
+  }
+
+  pNode->busy = 0;
+  pthread_cond_broadcast(&pSched->condIdle);
+
+  pthread_mutex_unlock(&pSched->mtx);
+}
+
+static int sched_have_task(const PARTICIPANT_T *pParticipant, MIXER_SCHED_TASK_TYPE_T type) {
+
+  switch(type) {
+    case MIXER_SCHED_TASK_UNPACK:
+#if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+      return pParticipant->pFrameQ ? 1 : 0;
+#else
+      return 0;
+#endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+    case MIXER_SCHED_TASK_OUTPUT:
+      return PARTICIPANT_HAVE_OUTPUT(pParticipant->config.output.type);
+    default:
+      return 0;
+  }
+}
+
+static int sched_fanout(MIXER_SCHEDULER_T *pSched, MIXER_SCHED_CONF_T *pNode, MIXER_SCHED_TASK_TYPE_T type) {
+  AUDIO_CONFERENCE_T *pConference = pNode->pConference;
+  PARTICIPANT_T *pParticipant;
+  int count = 0;
+
+  //
+  // Queue one task per participant for the next phase of the tick.  The conference lock
+  // prevents participants from being unlinked while their pending count is raised.
+  //
+  pthread_mutex_lock(&pConference->mtx);
+  pthread_mutex_lock(&pSched->mtx);
+
+  pParticipant = pConference->participants;
+  while(pParticipant) {
+
+    if(pParticipant->schedReady && sched_have_task(pParticipant, type)) {
+
+      if(sched_push(pSched, type, pNode, pParticipant) == 0) {
+        pParticipant->schedPending++;
+        count++;
+      }
+    }
+
+    pParticipant = pParticipant->pnext;
+  }
+
+  pNode->pending = count;
+  if(count > 0) {
+    pthread_cond_broadcast(&pSched->condWork);
+  }
+
+  pthread_mutex_unlock(&pSched->mtx);
+  pthread_mutex_unlock(&pConference->mtx);
+
+  return count;
+}
+
+static void sched_run_mix(MIXER_SCHEDULER_T *pSched, MIXER_SCHED_CONF_T *pNode) {
+  int loops = 0;
+
+  //
+  // Drain all available mixer output for this tick, as the dedicated mixer thread would
+  // over multiple passes
+  //
+  while(conference_mix_step(pNode->pConference) > 0 && ++loops < MIXER_SCHED_MAX_MIX_LOOPS) {
+    ;
+  }
+
+  if(sched_fanout(pSched, pNode, MIXER_SCHED_TASK_OUTPUT) == 0) {
+    sched_finish_tick(pSched, pNode);
+  }
+}
+
+static void sched_run_task(MIXER_SCHEDULER_T *pSched, MIXER_SCHED_TASK_T *pTask) {
+  MIXER_SCHED_CONF_T *pNode = pTask->pNode;
+  unsigned int pending;
+
+  switch(pTask->type) {
+
+    case MIXER_SCHED_TASK_TICK:
+
+      if(sched_fanout(pSched, pNode, MIXER_SCHED_TASK_UNPACK) == 0) {
+        sched_run_mix(pSched, pNode);
+      }
+      return;
+
+    case MIXER_SCHED_TASK_UNPACK:
+#if defined(MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+      participant_unpack_pending(pTask->pParticipant);
+#endif // (MIXER_HAVE_RTP) && (MIXER_HAVE_RTP > 0)
+      break;
+
+    case MIXER_SCHED_TASK_OUTPUT:
+      participant_output_process(pTask->pParticipant);
+      break;
+
+    default:
+      return;
+  }
+
+  //
+  // The last participant task of a phase advances the conference to the next phase
+  //
+  pthread_mutex_lock(&pSched->mtx);
+  pTask->pParticipant->schedPending--;
+  pending = --pNode->pending;
+  pthread_cond_broadcast(&pSched->condIdle);
+  pthread_mutex_unlock(&pSched->mtx);
+
+  if(pending == 0) {
+    if(pTask->type == MIXER_SCHED_TASK_UNPACK) {
+      sched_run_mix(pSched, pNode);
+    } else {
+      sched_finish_tick(pSched, pNode);
+    }
+  }
+
+}
+
+static void sched_worker_runproc(void *pArg) {
+  MIXER_SCHEDULER_T *pSched = g_pScheduler;
+  enum THREAD_FLAG *pFlag = (enum THREAD_FLAG *) pArg;
+  MIXER_SCHED_TASK_T task;
+  char tag[LOGUTIL_TAG_LENGTH];
+
+  snprintf(tag, sizeof(tag), "mixwrk%d", (int) (pFlag - pSched->tdFlagWorkers));
+  logutil_tid_add(pthread_self(), tag);
+
+  pthread_mutex_lock(&pSched->mtx);
+  *pFlag = THREAD_FLAG_RUNNING;
+
+  while(*pFlag == THREAD_FLAG_RUNNING) {
+
+    if(sched_pop(pSched, &task) < 0) {
+      pthread_cond_wait(&pSched->condWork, &pSched->mtx);
+      continue;
+    }
+
+    pthread_mutex_unlock(&pSched->mtx);
+
+    sched_run_task(pSched, &task);
+
+    pthread_mutex_lock(&pSched->mtx);
+  }
+
+  *pFlag = THREAD_FLAG_STOPPED;
+  pthread_mutex_unlock(&pSched->mtx);
+
+  logutil_tid_remove(pthread_self());
+}
+
+static void sched_on_tick(MIXER_SCHEDULER_T *pSched, TIME_STAMP_T tmNow, 
+                          TIME_STAMP_T tmDeadline, unsigned int missed) {
+  MIXER_SCHED_CONF_T *pNode;
+  MIXER_SCHEDULER_STATS_T *pStats = &pSched->stats;
+  unsigned int jitterUs;
+
+  pthread_mutex_lock(&pSched->mtx);
+
+  jitterUs = tmNow > tmDeadline ? (unsigned int) (tmNow - tmDeadline) : 0;
+  pStats->ticks++;
+  pStats->missedTicks += missed;
+  pStats->jitterUsTot += jitterUs;
+  if(jitterUs > pStats->jitterUsMax) {
+    pStats->jitterUsMax = jitterUs;
+  }
+
+  pNode = pSched->pConfs;
+  while(pNode) {
+    if(pNode->removed) {
+      ;
+    } else if(pNode->busy) {
+      pStats->overruns++;
+    } else if(sched_push(pSched, MIXER_SCHED_TASK_TICK, pNode, NULL) == 0) {
+      pNode->busy = 1;
+      pNode->tmTick = tmNow;
+    }
+    pNode = pNode->pnext;
+  }
+
+  if(pSched->numTasks > 0) {
+    pthread_cond_broadcast(&pSched->condWork);
+  }
+
+  if(tmNow - pSched->tmStats >= (TIME_STAMP_T) MIXER_SCHEDULER_STATS_INTERVAL_MS * 1000 && pStats->ticks > 0) {
+    LOG(X_DEBUG("Mixer scheduler %u workers, ticks: %llu, jitter avg: %lluus, max: %uus, missed: %llu, "
+                "overruns: %llu, tick processing avg: %lluus, max: %uus"), 
+        pSched->numWorkers, pStats->ticks, pStats->jitterUsTot / pStats->ticks, pStats->jitterUsMax,
+        pStats->missedTicks, pStats->overruns, 
+        pStats->numProc > 0 ? pStats->procUsTot / pStats->numProc : 0, pStats->procUsMax);
+    memset(pStats, 0, sizeof(MIXER_SCHEDULER_STATS_T));
+    pSched->tmStats = tmNow;
+  }
+
+  pthread_mutex_unlock(&pSched->mtx);
+}
+
+static void sched_tick_runproc(void *pArg) {
+  MIXER_SCHEDULER_T *pSched = (MIXER_SCHEDULER_T *) pArg;
+  const TIME_STAMP_T periodUs = pSched->tickMs * 1000;
+  TIME_STAMP_T tmStart, tmNow, tmDeadline;
+  uint64_t expirations = 0;
+#if defined(__linux__)
+  struct itimerspec its;
+  struct epoll_event events[2];
+  uint64_t val;
+  int numEvents;
+  int idx;
+#else
+  TIME_STAMP_T tmNext;
+#endif // __linux__
+
+  logutil_tid_add(pthread_self(), "mixsched");
+
+  pSched->tdFlagTick = THREAD_FLAG_RUNNING;
+
+  LOG(X_DEBUG("Mixer scheduler tick thread started with %dms period, %d workers"), 
+      pSched->tickMs, pSched->numWorkers);
+
+  tmStart = sched_monotonic_us();
+  pSched->tmStats = tmStart;
+
+#if defined(__linux__)
+
+  //
+  // The tick is driven by an absolute periodic timerfd so that wake-up latency does not accumulate.
+  // The eventfd is used to interrupt epoll_wait on shutdown.
+  //
+  memset(&its, 0, sizeof(its));
+  its.it_interval.tv_sec = periodUs / TIME_VAL_US;
+  its.it_interval.tv_nsec = (periodUs % TIME_VAL_US) * 1000;
+  its.it_value.tv_sec = (tmStart + periodUs) / TIME_VAL_US;
+  its.it_value.tv_nsec = ((tmStart + periodUs) % TIME_VAL_US) * 1000;
+
+  if(timerfd_settime(pSched->fdTimer, TFD_TIMER_ABSTIME, &its, NULL) != 0) {
+    LOG(X_ERROR("Mixer scheduler timerfd_settime failed, errno: %d"), errno);
+    pSched->tdFlagTick = THREAD_FLAG_DOEXIT;
+  }
+
+  while(pSched->tdFlagTick == THREAD_FLAG_RUNNING) {
+
+    if((numEvents = epoll_wait(pSched->fdEpoll, events, 2, -1)) < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      LOG(X_ERROR("Mixer scheduler epoll_wait failed, errno: %d"), errno);
+      break;
+    }
+
+    tmNow = sched_monotonic_us();
+
+    for(idx = 0; idx < numEvents; idx++) {
+
+      if(events[idx].data.fd != pSched->fdTimer || read(pSched->fdTimer, &val, sizeof(val)) != sizeof(val)) {
+        continue;
+      }
+
+      expirations += val;
+      tmDeadline = tmStart + expirations * periodUs;
+
+      sched_on_tick(pSched, tmNow, tmDeadline, (unsigned int) (val - 1));
+    }
+  }
+
+#else // __linux__
+
+  tmNext = tmStart;
+
+  while(pSched->tdFlagTick == THREAD_FLAG_RUNNING) {
+
+    tmNext += periodUs;
+    tmNow = sched_monotonic_us();
+
+    if(tmNext > tmNow) {
+      usleep(tmNext - tmNow);
+      tmNow = sched_monotonic_us();
+    }
+
+    tmDeadline = tmNext;
+    expirations = 0;
+    if(tmNow >= tmNext + periodUs) {
+      //
+      // Skip over any whole periods which were overslept
+      //
+      expirations = (tmNow - tmNext) / periodUs;
+      tmNext += expirations * periodUs;
+    }
+
+    sched_on_tick(pSched, tmNow, tmDeadline, (unsigned int) expirations);
+  }
+
+#endif // __linux__
+
+  LOG(X_DEBUG("Mixer scheduler tick thread ending"));
+
+  pSched->tdFlagTick = THREAD_FLAG_STOPPED;
+
+  logutil_tid_remove(pthread_self());
+}
+
+static void sched_destroy(MIXER_SCHEDULER_T *pSched) {
+  unsigned int idx;
+#if defined(__linux__)
+  uint64_t val = 1;
+#endif // __linux__
+
+  while(pSched->tdFlagTick > THREAD_FLAG_STOPPED) {
+    pSched->tdFlagTick = THREAD_FLAG_DOEXIT;
+#if defined(__linux__)
+    if(pSched->fdWake >= 0 && write(pSched->fdWake, &val, sizeof(val)) != sizeof(val)) {
+      LOG(X_WARNING("Mixer scheduler failed to wake tick thread"));
+    }
+#endif // __linux__
+    usleep(5000);
+  }
+
+  for(idx = 0; idx < pSched->numWorkers; idx++) {
+    while(pSched->tdFlagWorkers[idx] > THREAD_FLAG_STOPPED) {
+      pthread_mutex_lock(&pSched->mtx);
+      pSched->tdFlagWorkers[idx] = THREAD_FLAG_DOEXIT;
+      pthread_cond_broadcast(&pSched->condWork);
+      pthread_mutex_unlock(&pSched->mtx);
+      usleep(5000);
+    }
+  }
+
+#if defined(__linux__)
+  if(pSched->fdEpoll >= 0) {
+    close(pSched->fdEpoll);
+  }
+  if(pSched->fdTimer >= 0) {
+    close(pSched->fdTimer);
+  }
+  if(pSched->fdWake >= 0) {
+    close(pSched->fdWake);
+  }
+#endif // __linux__
+
+  free(pSched->pTasks);
+  pthread_mutex_destroy(&pSched->mtx);
+  pthread_cond_destroy(&pSched->condWork);
+  pthread_cond_destroy(&pSched->condIdle);
+  free(pSched);
+}
+
+static MIXER_SCHEDULER_T *sched_create(const MIXER_CONFIG_T *pCfg) {
+  MIXER_SCHEDULER_T *pSched;
+  pthread_attr_t attr;
+  struct sched_param param;
+  unsigned int idx;
+  int rc = 0;
+#if defined(__linux__)
+  struct epoll_event ev;
+#endif // __linux__
+
+  if(!(pSched = (MIXER_SCHEDULER_T *) calloc(1, sizeof(MIXER_SCHEDULER_T)))) {
+    return NULL;
+  }
+
+  pthread_mutex_init(&pSched->mtx, NULL);
+  pthread_cond_init(&pSched->condWork, NULL);
+  pthread_cond_init(&pSched->condIdle, NULL);
+  pSched->tickMs = MIXER_CHUNKSZ_MS;
+  pSched->numWorkers = MIN(pCfg->schedulerWorkers, MIXER_SCHEDULER_MAX_WORKERS);
+  pSched->fdEpoll = pSched->fdTimer = pSched->fdWake = -1;
+
+  // The worker threads reference the global instance
+  g_pScheduler = pSched;
+
+#if defined(__linux__)
+
+  if((pSched->fdTimer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)) < 0 ||
+     (pSched->fdWake = eventfd(0, EFD_CLOEXEC)) < 0 ||
+     (pSched->fdEpoll = epoll_create(2)) < 0) {
+    LOG(X_ERROR("Failed to create mixer scheduler timer descriptors, errno: %d"), errno);
+    rc = -1;
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  if(rc == 0) {
+    ev.data.fd = pSched->fdTimer;
+    rc = epoll_ctl(pSched->fdEpoll, EPOLL_CTL_ADD, pSched->fdTimer, &ev);
+  }
+  if(rc == 0) {
+    ev.data.fd = pSched->fdWake;
+    rc = epoll_ctl(pSched->fdEpoll, EPOLL_CTL_ADD, pSched->fdWake, &ev);
+  }
+
+#endif // __linux__
+
+  for(idx = 0; rc == 0 && idx < pSched->numWorkers; idx++) {
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pSched->tdFlagWorkers[idx] = THREAD_FLAG_STARTING;
+    if(pthread_create(&pSched->ptdWorkers[idx],
+                      &attr,
+                      (void *) sched_worker_runproc,
+                      (void *) &pSched->tdFlagWorkers[idx]) != 0) {
+      LOG(X_ERROR("Unable to create mixer scheduler worker thread"));
+      pSched->tdFlagWorkers[idx] = THREAD_FLAG_STOPPED;
+      rc = -1;
+    }
+    pthread_attr_destroy(&attr);
+  }
+
+  if(rc == 0) {
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    if(pCfg->highPriority) {
+      LOG(X_DEBUG("Setting mixer scheduler tick thread to high priority"));
+      pthread_attr_setschedpolicy(&attr, SCHED_RR);
+      param.sched_priority = sched_get_priority_max(SCHED_RR);
+      pthread_attr_setschedparam(&attr, &param);
+    }
+
+    pSched->tdFlagTick = THREAD_FLAG_STARTING;
+    if(pthread_create(&pSched->ptdTick,
+                      &attr,
+                      (void *) sched_tick_runproc,
+                      (void *) pSched) != 0) {
+      LOG(X_ERROR("Unable to create mixer scheduler tick thread"));
+      pSched->tdFlagTick = THREAD_FLAG_STOPPED;
+      rc = -1;
+    }
+    pthread_attr_destroy(&attr);
+  }
+
+  while(pSched->tdFlagTick == THREAD_FLAG_STARTING) {
+    usleep(5000);
+  }
+
+  for(idx = 0; idx < pSched->numWorkers; idx++) {
+    while(pSched->tdFlagWorkers[idx] == THREAD_FLAG_STARTING) {
+      usleep(5000);
+    }
+  }
+
+  if(rc < 0 || pSched->tdFlagTick != THREAD_FLAG_RUNNING) {
+    sched_destroy(pSched);
+    g_pScheduler = NULL;
+    return NULL;
+  }
+
+  LOG(X_INFO("Created mixer scheduler with %d worker threads, %dms tick"), pSched->numWorkers, pSched->tickMs);
+
+  return pSched;
+}
+
+int mixer_scheduler_register(AUDIO_CONFERENCE_T *pConference) {
+  MIXER_SCHEDULER_T *pSched;
+  MIXER_SCHED_CONF_T *pNode;
+
+  if(!pConference) {
+    return -1;
+  }
+
+  if(!(pNode = (MIXER_SCHED_CONF_T *) calloc(1, sizeof(MIXER_SCHED_CONF_T)))) {
+    return -1;
+  }
+  pNode->pConference = pConference;
+
+  pthread_mutex_lock(&g_mtxScheduler);
+
+  if(!(pSched = g_pScheduler) && !(pSched = sched_create(&pConference->cfg))) {
+    pthread_mutex_unlock(&g_mtxScheduler);
+    free(pNode);
+    return -1;
+  }
+
+  if(pConference->cfg.schedulerWorkers != pSched->numWorkers) {
+    LOG(X_DEBUG("Conference id %d using existing mixer scheduler with %d workers"), 
+        pConference->id, pSched->numWorkers);
+  }
+
+  pthread_mutex_lock(&pSched->mtx);
+  pNode->pnext = pSched->pConfs;
+  pSched->pConfs = pNode;
+  pSched->refCount++;
+  pthread_mutex_unlock(&pSched->mtx);
+
+  pthread_mutex_unlock(&g_mtxScheduler);
+
+  LOG(X_DEBUG("Added conference id %d to mixer scheduler"), pConference->id);
+
+  return 0;
+}
+
+void mixer_scheduler_unregister(AUDIO_CONFERENCE_T *pConference) {
+  MIXER_SCHEDULER_T *pSched;
+  MIXER_SCHED_CONF_T *pNode, *pPrev = NULL;
+
+  pthread_mutex_lock(&g_mtxScheduler);
+
+  if(!(pSched = g_pScheduler)) {
+    pthread_mutex_unlock(&g_mtxScheduler);
+    return;
+  }
+
+  pthread_mutex_lock(&pSched->mtx);
+
+  pNode = pSched->pConfs;
+  while(pNode && pNode->pConference != pConference) {
+    pPrev = pNode;
+    pNode = pNode->pnext;
+  }
+
+  if(pNode) {
+
+    //
+    // Wait for any in-progress tick of this conference to complete
+    //
+    pNode->removed = 1;
+    while(pNode->busy) {
+      pthread_cond_wait(&pSched->condIdle, &pSched->mtx);
+    }
+
+    if(pPrev) {
+      pPrev->pnext = pNode->pnext;
+    } else {
+      pSched->pConfs = pNode->pnext;
+    }
+    free(pNode);
+    pSched->refCount--;
+  }
+
+  pthread_mutex_unlock(&pSched->mtx);
+
+  if(pSched->refCount == 0) {
+    LOG(X_DEBUG("Stopping mixer scheduler"));
+    sched_destroy(pSched);
+    g_pScheduler = NULL;
+  }
+
+  pthread_mutex_unlock(&g_mtxScheduler);
+
+}
+
+void mixer_scheduler_participant_wait(PARTICIPANT_T *pParticipant) {
+  MIXER_SCHEDULER_T *pSched;
+
+  if(!pParticipant || !(pSched = g_pScheduler)) {
+    return;
+  }
+
+  pthread_mutex_lock(&pSched->mtx);
+
+  pParticipant->schedReady = 0;
+  while(pParticipant->schedPending > 0) {
+    pthread_cond_wait(&pSched->condIdle, &pSched->mtx);
+  }
+
+  pthread_mutex_unlock(&pSched->mtx);
+}
+
+int mixer_scheduler_get_stats(MIXER_SCHEDULER_STATS_T *pStats) {
+  MIXER_SCHEDULER_T *pSched;
+
+  if(!pStats) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&g_mtxScheduler);
+
+  if(!(pSched = g_pScheduler)) {
+    pthread_mutex_unlock(&g_mtxScheduler);
+    return -1;
+  }
+
+  pthread_mutex_lock(&pSched->mtx);
+  memcpy(pStats, &pSched->stats, sizeof(MIXER_SCHEDULER_STATS_T));
+  pthread_mutex_unlock(&pSched->mtx);
+
+  pthread_mutex_unlock(&g_mtxScheduler);
+
+  return 0;
+}
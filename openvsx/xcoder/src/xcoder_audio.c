@@ -42,6 +42,7 @@
 #include "ixcode.h"
 #include "xcoder_libavcodec.h"
 #include "xcoder.h"
+#include "xcoder_audio_dsp.h"
 #if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
 #include "mixer/mixer_api.h"
 #endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
@@ -64,7 +65,6 @@
 //extern void av_log_set_level(int);
 
 extern pthread_mutex_t g_xcode_mtx;
-extern void ixcode_init_common(IXCODE_COMMON_CTXT_T *pCommon);
 
 //#include "mixer/wav.h"
 //static WAV_FILE_T g_wav; 
@@ -372,10 +372,7 @@ void ixcode_close_aud(IXCODE_AUDIO_CTXT_T *pXcodeA) {
     }
 
     for(idx = 0; idx < 2; idx++) {
-      if(pAvCtx->resample[idx].presample) {
-        audio_resample_close(pAvCtx->resample[idx].presample);
-        pAvCtx->resample[idx].presample = NULL;
-      }
+      audio_dsp_resample_close(&pAvCtx->resample[idx]);
 
       if(pAvCtx->resample[idx].decbufresample) {
         av_free(pAvCtx->resample[idx].decbufresample);
@@ -406,26 +403,6 @@ void ixcode_close_aud(IXCODE_AUDIO_CTXT_T *pXcodeA) {
 }
 
 
-static void adjust_volume(int16_t *samples, uint32_t numsamples, int adjustment) {
-  unsigned int idx;
-  int volume;
-  int16_t *pvolume = samples;
-
-  for(idx=0; idx < numsamples; idx++) {
-
-    volume = ((*pvolume) * adjustment + 128) >> 8;
-
-    if (volume < -32768) {
-      volume = -32768;
-    } else if (volume >  32767) {
-      volume = 32767;
-    }
-
-    *pvolume++ = volume;
-  }
-
-}
-
 /*
 void testaudio(unsigned char *p, unsigned int cnt) {
   unsigned int i;
@@ -536,7 +513,7 @@ static int ixcode_audio_resample(IXCODE_AVCTXT_RESAMPLE_T *pResample,
 
   //LOG(X_DEBUG("needresample:%d, %dHz->%dHz, presample: 0x%x"), pResample->needresample, pResample->pin_samplerate ? *pResample->pin_samplerate : -1, pResample->pin_samplerate ? *pResample->pout_samplerate : -1, pResample->presample);
 
-  if(pResample->needresample && !pResample->presample &&
+  if(pResample->needresample && !AUDIO_DSP_RESAMPLE_ACTIVE(pResample) &&
      (*pResample->pin_samplerate != *pResample->pout_samplerate ||
       *pResample->pin_samplefmt != *pResample->pout_samplefmt ||
       *pResample->pin_channels != *pResample->pout_channels)) {
@@ -547,16 +524,7 @@ static int ixcode_audio_resample(IXCODE_AVCTXT_RESAMPLE_T *pResample,
         *pResample->pout_codec, *pResample->pout_samplerate,
         *pResample->pout_channels, *pResample->pout_samplefmt);
 
-    if((pResample->presample = av_audio_resample_init(
-                     *pResample->pout_channels, *pResample->pin_channels,
-                     *pResample->pout_samplerate, *pResample->pin_samplerate,
-                     *pResample->pout_samplefmt, *pResample->pin_samplefmt,
-                     16, 10, 0, 0.8)) == NULL) {
-
-      LOG(X_ERROR("Failed to init audio channel resampling context %dHz/%d (%d) -> %dHz/%d (%d)"),
-              *pResample->pin_samplerate, *pResample->pin_channels, *pResample->pin_samplefmt, 
-              *pResample->pout_samplerate, *pResample->pout_channels, *pResample->pout_samplefmt);
-
+    if(audio_dsp_resample_open(pResample) < 0) {
       return IXCODE_RC_ERROR_SCALE;
     }
 
@@ -565,11 +533,11 @@ static int ixcode_audio_resample(IXCODE_AVCTXT_RESAMPLE_T *pResample,
 
   }
 
-  if(pResample->presample && *pnumSamples > 0) {
+  if(AUDIO_DSP_RESAMPLE_ACTIVE(pResample) && *pnumSamples > 0) {
 
-    if((*pnumSamples = audio_resample(pResample->presample,
+    if((*pnumSamples = audio_dsp_resample_run(pResample,
                        (int16_t *) pResample->decbufresample,   // output
-                       (int16_t *) *ppdecdatain,  // input
+                       (const int16_t *) *ppdecdatain,  // input
                        *pnumSamples)) < 0) {
       LOG(X_ERROR("Failed to resample audio"));
       return IXCODE_RC_ERROR_SCALE;
@@ -587,6 +555,96 @@ static int ixcode_audio_resample(IXCODE_AVCTXT_RESAMPLE_T *pResample,
   return szRawSamples;
 }
 
+#if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+
+//
+// Encoded frames can only be shared with other mixer participants if the encoder is 
+// stateless, so that a frame depends on nothing but its own samples, and consumes the
+// mixer output samples as is.  Stateful codecs (AAC, Opus, SILK) would need one encoder
+// instance per mix to be shared.
+//
+#define AUDIO_MIX_CODEC_STATELESS(codec) ((codec) == XC_CODEC_TYPE_G711_MULAW || \
+                                          (codec) == XC_CODEC_TYPE_RAWA_PCMULAW || \
+                                          (codec) == XC_CODEC_TYPE_G711_ALAW || \
+                                          (codec) == XC_CODEC_TYPE_RAWA_PCMALAW)
+
+#define AUDIO_MIX_CAN_SHARE(pXcode, pAvCtx) ((pXcode)->pMixerParticipant && (pXcode)->pXcodeV && \
+                                    AUDIO_MIX_CODEC_STATELESS((pXcode)->common.cfgFileTypeOut) && \
+                                    !(pAvCtx)->resample[1].needresample && \
+                                    !AUDIO_DSP_RESAMPLE_ACTIVE(&(pAvCtx)->resample[1]))
+
+static void audio_mixsig_add(IXCODE_AVCTXT_T *pAvCtx, uint64_t sig, uint64_t tsHz, unsigned int numSamples) {
+  XCODE_MIXSIG_RUN_T *pRun;
+
+  if(numSamples == 0) {
+    return;
+  }
+
+  if(pAvCtx->numMixRuns > 0) {
+    pRun = &pAvCtx->mixRuns[pAvCtx->numMixRuns - 1];
+
+    if(pRun->sig == sig && pRun->tsHz + pRun->numSamples == tsHz) {
+      pRun->numSamples += numSamples;
+      return;
+    } else if(pAvCtx->numMixRuns >= XCODE_MIXSIG_RUNS_MAX) {
+      //
+      // Out of runs, the newest run can no longer be shared
+      //
+      pRun->sig = MIXER_OUTPUT_SIG_NONE;
+      pRun->numSamples += numSamples;
+      return;
+    }
+  }
+
+  pRun = &pAvCtx->mixRuns[pAvCtx->numMixRuns++];
+  pRun->sig = sig;
+  pRun->tsHz = tsHz;
+  pRun->numSamples = numSamples;
+}
+
+static uint64_t audio_mixsig_frame(IXCODE_AVCTXT_T *pAvCtx, unsigned int numSamples, uint64_t *ptsHz) {
+  XCODE_MIXSIG_RUN_T *pRun = &pAvCtx->mixRuns[0];
+  uint64_t sig = MIXER_OUTPUT_SIG_NONE;
+  unsigned int consume;
+
+  //
+  // A frame has a mix signature only if all its samples come from one run
+  //
+  if(pAvCtx->numMixRuns > 0 && pRun->numSamples >= numSamples) {
+    sig = pRun->sig;
+    *ptsHz = pRun->tsHz;
+  }
+
+  while(numSamples > 0 && pAvCtx->numMixRuns > 0) {
+
+    consume = MIN(numSamples, pRun->numSamples);
+    pRun->numSamples -= consume;
+    pRun->tsHz += consume;
+    numSamples -= consume;
+
+    if(pRun->numSamples == 0) {
+      memmove(&pAvCtx->mixRuns[0], &pAvCtx->mixRuns[1], --pAvCtx->numMixRuns * sizeof(XCODE_MIXSIG_RUN_T));
+    }
+  }
+
+  return sig;
+}
+
+static void audio_mixsig_key(const IXCODE_AUDIO_CTXT_T *pXcode, const IXCODE_AVCTXT_T *pAvCtx, 
+                             MIXER_ENCODED_KEY_T *pKey) {
+
+  memset(pKey, 0, sizeof(MIXER_ENCODED_KEY_T));
+  pKey->type = PARTICIPANT_TYPE_PCM_POLL;
+  pKey->codec = pXcode->common.cfgFileTypeOut;
+  pKey->sampleRate = pAvCtx->enc_samplerate;
+  pKey->channels = pAvCtx->enc_channels;
+  pKey->bitRate = pXcode->cfgBitRateOut;
+  pKey->frameHz = pXcode->encoderSamplesInFrame;
+  pKey->param = pXcode->cfgProfile;
+}
+
+#endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+
 static int ixcode_audio_encode(IXCODE_AUDIO_CTXT_T *pXcode,
                                int szRawSamples,
                                int numSamples,
@@ -600,6 +658,13 @@ static int ixcode_audio_encode(IXCODE_AUDIO_CTXT_T *pXcode,
   unsigned int compoundPktIdx = 0;
   unsigned int lenEncode = 0;
   int64_t pts = 0;
+#if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+  MIXER_ENCODED_KEY_T key;
+  uint64_t sig = MIXER_OUTPUT_SIG_NONE;
+  uint64_t tsHz = 0;
+  int share = 0;
+#endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+  int claim = -1;
 
   IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
 
@@ -619,6 +684,12 @@ static int ixcode_audio_encode(IXCODE_AUDIO_CTXT_T *pXcode,
 
     memset(&pXcode->compoundLens, 0, sizeof(pXcode->compoundLens));
 
+#if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+    if((share = AUDIO_MIX_CAN_SHARE(pXcode, pAvCtx))) {
+      audio_mixsig_key(pXcode, pAvCtx, &key);
+    }
+#endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+
     //fprintf(stderr, "numS:%d, decbufidxrd:%d, encbps:%d, enc_channels:%d, encSamplesInFr:%d, decbufidxwr:%d\n", numSamples, pAvCtx->decbufidxrd, pAvCtx->encbps,  pAvCtx->enc_channels,  pXcode->encoderSamplesInFrame, pAvCtx->decbufidxwr);
 
     while(numSamples > 0 && pAvCtx->decbufidxrd + 
@@ -651,15 +722,41 @@ static int ixcode_audio_encode(IXCODE_AUDIO_CTXT_T *pXcode,
 //wav_write(&g_wav, &pAvCtx->decbufout[pAvCtx->decbufidxrd],pAvCtx->enc_channels * pXcode->encoderSamplesInFrame);
 
 
+#if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+      //
+      // Participants hearing the same mix share the frame of whichever participant claimed
+      // it first instead of each running its own encoder
+      //
+      if(share && (sig = audio_mixsig_frame(pAvCtx, pXcode->encoderSamplesInFrame, &tsHz)) != 
+                  MIXER_OUTPUT_SIG_NONE) {
+        claim = mixer_encoded_claim(pXcode->pMixerParticipant, &key, sig, tsHz, &bufOut[lenOutRes], lenEncode);
+      } else {
+        claim = -1;
+      }
+#endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+
 #if 1
-      if((rc = pAvCtx->out[0].encWrap.u.a.fEncode(&pAvCtx->out[0].encWrap.u.a.ctxt, 
+      if(claim >= 0) {
+        rc = claim;
+        pts = 0;
+      } else if((rc = pAvCtx->out[0].encWrap.u.a.fEncode(&pAvCtx->out[0].encWrap.u.a.ctxt, 
                                                    &bufOut[lenOutRes], 
                                                    lenEncode, 
                                                    (const short *) &pAvCtx->decbufout[pAvCtx->decbufidxrd],
                                                    &pts)) < 0) {
         LOG(X_ERROR("Failed to encode audio frame"));
+#if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+        if(claim == MIXER_ENCODED_CLAIMED) {
+          mixer_encoded_store(pXcode->pMixerParticipant, &key, sig, tsHz, NULL, -1);
+        }
+#endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
         return IXCODE_RC_ERROR_ENCODE;
       }
+#if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+      else if(claim == MIXER_ENCODED_CLAIMED) {
+        mixer_encoded_store(pXcode->pMixerParticipant, &key, sig, tsHz, &bufOut[lenOutRes], rc);
+      }
+#endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
 #else
       // Raw PCM out
       //rc = 960; // 24000 / 50 * 2 
@@ -702,6 +799,9 @@ static int ixcode_audio_encode(IXCODE_AUDIO_CTXT_T *pXcode,
         LOG(X_WARNING("xcode_aud setting decoder wr idx to 0. out:%d idxrd:%d idxwr:%d"), 
                      lenOutRes, pAvCtx->decbufidxrd, pAvCtx->decbufidxwr);
         pAvCtx->decbufidxwr = 0;
+#if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
+        pAvCtx->numMixRuns = 0;
+#endif // (XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
       } else {
 
         memcpy(pAvCtx->decbufout,
@@ -743,7 +843,10 @@ enum IXCODE_RC ixcode_frame_aud(IXCODE_AUDIO_CTXT_T *pXcode,
   //unsigned int numSamplesConsumed;
   //uint64_t pts;
   IXCODE_VIDEO_CTXT_T *pXcodeV = NULL;
+  u_int64_t mixTsHz = 0;
+  uint64_t mixSig = MIXER_OUTPUT_SIG_NONE;
 #endif // XCODE_HAVE_PIP_AUDIO
+  uint64_t tmStage = 0;
 
 
 #if defined(XCODE_PROFILE_AUD)
@@ -762,6 +865,8 @@ enum IXCODE_RC ixcode_frame_aud(IXCODE_AUDIO_CTXT_T *pXcode,
   gettimeofday(&gtv[2], NULL);
 #endif // XCODE_PROFILE_AUD
 
+  IXCODE_STAGE_BEGIN(&pXcode->common, tmStage);
+
   //fprintf(stderr, "xcoder xcode_aud tid:0x%x, bufIn:0x%x, lenIn:%d, bufOut:0x%x, lenOut:%d, pMixerParticipant:0x%x\n", pthread_self(), bufIn, lenIn, bufOut, lenOut, pXcode->pMixerParticipant);
 
   //
@@ -778,6 +883,8 @@ enum IXCODE_RC ixcode_frame_aud(IXCODE_AUDIO_CTXT_T *pXcode,
     return IXCODE_RC_OK; 
   }
 
+  IXCODE_STAGE_END(&pXcode->common, tmStage, usDecode, numDecode);
+
 #if defined(XCODE_PROFILE_AUD)
   gettimeofday(&gtv[3], NULL);
   pAvCtx->prof.num_adecodes++;
@@ -796,15 +903,17 @@ enum IXCODE_RC ixcode_frame_aud(IXCODE_AUDIO_CTXT_T *pXcode,
   //
   if(pAvCtx->volumeadjustment != 0 && pdecdatain && pAvCtx->volumeadjustment != 256 &&
      pAvCtx->dec_samplefmt == SAMPLE_FMT_S16) {
-    adjust_volume((int16_t *) pdecdatain, szRawSamples / 2, pAvCtx->volumeadjustment);
+    audio_dsp_gain_s16((int16_t *) pdecdatain, szRawSamples / 2, pAvCtx->volumeadjustment);
   }
 
   //
   // Resample the input frequency to the output
   //
+  IXCODE_STAGE_BEGIN(&pXcode->common, tmStage);
   if((szRawSamples = ixcode_audio_resample(&pAvCtx->resample[0], szRawSamples, &numSamples, &pdecdatain)) < 0) {
     return (enum IXCODE_RC) szRawSamples;
   }
+  IXCODE_STAGE_END(&pXcode->common, tmStage, usScale, numScale);
 
 #if defined(XCODE_HAVE_PIP_AUDIO) && (XCODE_HAVE_PIP_AUDIO > 0)
   pXcodeV = pXcode->pXcodeV;
@@ -844,10 +953,26 @@ enum IXCODE_RC ixcode_frame_aud(IXCODE_AUDIO_CTXT_T *pXcode,
     numSamples = 0;
     pdecdatain = pAvCtx->decbufin;
 
-    if((numSamples = mixer_read_audio_pcm(pXcode->pMixerParticipant, 
+    if(AUDIO_MIX_CAN_SHARE(pXcode, pAvCtx)) {
+
+      if((numSamples = mixer_read_audio_pcm(pXcode->pMixerParticipant, 
+                                        (int16_t *) pdecdatain,
+                                        0,
+                                        AVCODEC_MAX_AUDIO_FRAME_SIZE,
+                                        NULL,
+                                        &mixTsHz,
+                                        &mixSig)) < 0) {
+        return IXCODE_RC_ERROR_MIXER;
+      }
+
+      audio_mixsig_add(pAvCtx, mixSig, mixTsHz, numSamples);
+
+    } else if((numSamples = mixer_read_audio_pcm(pXcode->pMixerParticipant, 
                                       (int16_t *) pdecdatain,
                                       0,
                                       AVCODEC_MAX_AUDIO_FRAME_SIZE,
+                                      NULL,
+                                      NULL,
                                       NULL)) < 0) {
       return IXCODE_RC_ERROR_MIXER;
     }
@@ -881,6 +1006,8 @@ enum IXCODE_RC ixcode_frame_aud(IXCODE_AUDIO_CTXT_T *pXcode,
   gettimeofday(&gtv[4], NULL);
 #endif // XCODE_PROFILE_AUD
 
+  IXCODE_STAGE_BEGIN(&pXcode->common, tmStage);
+
 
   //
   // Encode the PCM samples
@@ -891,6 +1018,8 @@ enum IXCODE_RC ixcode_frame_aud(IXCODE_AUDIO_CTXT_T *pXcode,
 
   //fprintf(stderr, "xcode_aud tid:0x%x called ixcode_audio_encode numS:%d, pXcodeV:0x%x, pip.active:%d, lenOutRes:%d, fEncode:0x%x\n", pthread_self(), numSamples, pXcodeV, pXcodeV ? pXcodeV->pip.active : 0, lenOutRes, pAvCtx->out[0].encWrap.u.a.fEncode);
 
+  IXCODE_STAGE_END(&pXcode->common, tmStage, usEncode, numEncode);
+
 #if defined(XCODE_PROFILE_AUD)
   gettimeofday(&gtv[5], NULL);
   gettimeofday(&gtv[1], NULL);
@@ -0,0 +1,1130 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+
+#ifdef WIN32
+
+#include <windows.h>
+#include "unixcompat.h"
+
+#else // WIN32
+
+#include <unistd.h>
+#include <sys/time.h>
+
+#endif // WIN32
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <math.h>
+#include "logutil.h"
+#include "ixcode.h"
+#include "xcoder.h"
+#include "xcoder_audio_dsp.h"
+
+typedef struct AUDIO_DSP_KERNELS {
+  const char                 *name;
+
+  //
+  // s[k] = clamp((s[k] * adjustment + 128) >> 8)
+  //
+  void (*gain_s16)(int16_t *samples, unsigned int numsamples, int adjustment);
+
+  //
+  // out[k] = in[k] / 32768
+  //
+  void (*s16_to_flt)(float *out, const int16_t *in, unsigned int numsamples);
+
+  //
+  // out[k] = clamp(lrintf(in[k] * 32768))
+  //
+  void (*flt_to_s16)(int16_t *out, const float *in, unsigned int numsamples);
+
+  //
+  // out[2k] = out[2k+1] = in[k]
+  //
+  void (*mono_to_stereo)(int16_t *out, const int16_t *in, unsigned int numframes);
+
+  //
+  // out[k] = (in[2k] + in[2k+1]) >> 1, the same downmix as the ffmpeg resampler
+  //
+  void (*stereo_to_mono)(int16_t *out, const int16_t *in, unsigned int numframes);
+} AUDIO_DSP_KERNELS_T;
+
+static void gain_s16_c(int16_t *samples, unsigned int numsamples, int adjustment) {
+  unsigned int k;
+  int volume;
+
+  for(k = 0; k < numsamples; k++) {
+
+    volume = (samples[k] * adjustment + 128) >> 8;
+
+    if(volume < -32768) {
+      volume = -32768;
+    } else if(volume > 32767) {
+      volume = 32767;
+    }
+
+    samples[k] = volume;
+  }
+}
+
+static void s16_to_flt_c(float *out, const int16_t *in, unsigned int numsamples) {
+  unsigned int k;
+
+  for(k = 0; k < numsamples; k++) {
+    out[k] = in[k] * (1.0f / 32768.0f);
+  }
+}
+
+static void flt_to_s16_c(int16_t *out, const float *in, unsigned int numsamples) {
+  unsigned int k;
+  float f;
+
+  for(k = 0; k < numsamples; k++) {
+
+    //
+    // Clamp before rounding, treating NaN as the lower bound the same as the vector kernels
+    //
+    f = in[k] * 32768.0f;
+    if(!(f >= -32768.0f)) {
+      f = -32768.0f;
+    } else if(f > 32767.0f) {
+      f = 32767.0f;
+    }
+
+    out[k] = (int16_t) lrintf(f);
+  }
+}
+
+static void mono_to_stereo_c(int16_t *out, const int16_t *in, unsigned int numframes) {
+  unsigned int k;
+
+  for(k = 0; k < numframes; k++) {
+    out[2 * k] = out[2 * k + 1] = in[k];
+  }
+}
+
+static void stereo_to_mono_c(int16_t *out, const int16_t *in, unsigned int numframes) {
+  unsigned int k;
+
+  for(k = 0; k < numframes; k++) {
+    out[k] = (in[2 * k] + in[2 * k + 1]) >> 1;
+  }
+}
+
+static const AUDIO_DSP_KERNELS_T g_dsp_c = { "c", gain_s16_c, s16_to_flt_c, flt_to_s16_c,
+                                             mono_to_stereo_c, stereo_to_mono_c };
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#define AUDIO_DSP_X86 1
+
+#include <immintrin.h>
+
+//
+// The gain is computed as a single multiply-add of the interleaved pair (s, 1) with 
+// (adjustment, 128), which is exact as long as adjustment fits in 16 bits.  The saturating
+// pack performs the clamp to the int16 range.
+//
+__attribute__((target("sse2")))
+static void gain_s16_sse2(int16_t *samples, unsigned int numsamples, int adjustment) {
+  __m128i coef, one, x, lo, hi;
+  unsigned int k = 0;
+
+  if(adjustment >= -32768 && adjustment <= 32767) {
+
+    coef = _mm_set1_epi32((128 << 16) | (adjustment & 0xffff));
+    one = _mm_set1_epi16(1);
+
+    for(k = 0; k + 8 <= numsamples; k += 8) {
+      x = _mm_loadu_si128((const __m128i *) &samples[k]);
+      lo = _mm_madd_epi16(_mm_unpacklo_epi16(x, one), coef);
+      hi = _mm_madd_epi16(_mm_unpackhi_epi16(x, one), coef);
+      _mm_storeu_si128((__m128i *) &samples[k], 
+                       _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8)));
+    }
+  }
+
+  gain_s16_c(&samples[k], numsamples - k, adjustment);
+}
+
+__attribute__((target("sse2")))
+static void s16_to_flt_sse2(float *out, const int16_t *in, unsigned int numsamples) {
+  const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+  __m128i x;
+  unsigned int k;
+
+  for(k = 0; k + 8 <= numsamples; k += 8) {
+    x = _mm_loadu_si128((const __m128i *) &in[k]);
+    _mm_storeu_ps(&out[k], 
+                  _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)), scale));
+    _mm_storeu_ps(&out[k + 4], 
+                  _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)), scale));
+  }
+
+  s16_to_flt_c(&out[k], &in[k], numsamples - k);
+}
+
+__attribute__((target("sse2")))
+static void flt_to_s16_sse2(int16_t *out, const float *in, unsigned int numsamples) {
+  const __m128 scale = _mm_set1_ps(32768.0f);
+  const __m128 fmin = _mm_set1_ps(-32768.0f);
+  const __m128 fmax = _mm_set1_ps(32767.0f);
+  __m128 a, b;
+  unsigned int k;
+
+  for(k = 0; k + 8 <= numsamples; k += 8) {
+    a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&in[k]), scale), fmin), fmax);
+    b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&in[k + 4]), scale), fmin), fmax);
+    _mm_storeu_si128((__m128i *) &out[k], _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+  }
+
+  flt_to_s16_c(&out[k], &in[k], numsamples - k);
+}
+
+__attribute__((target("sse2")))
+static void mono_to_stereo_sse2(int16_t *out, const int16_t *in, unsigned int numframes) {
+  __m128i x;
+  unsigned int k;
+
+  for(k = 0; k + 8 <= numframes; k += 8) {
+    x = _mm_loadu_si128((const __m128i *) &in[k]);
+    _mm_storeu_si128((__m128i *) &out[2 * k], _mm_unpacklo_epi16(x, x));
+    _mm_storeu_si128((__m128i *) &out[2 * k + 8], _mm_unpackhi_epi16(x, x));
+  }
+
+  mono_to_stereo_c(&out[2 * k], &in[k], numframes - k);
+}
+
+__attribute__((target("sse2")))
+static void stereo_to_mono_sse2(int16_t *out, const int16_t *in, unsigned int numframes) {
+  const __m128i one = _mm_set1_epi16(1);
+  __m128i a, b;
+  unsigned int k;
+
+  for(k = 0; k + 8 <= numframes; k += 8) {
+    a = _mm_madd_epi16(_mm_loadu_si128((const __m128i *) &in[2 * k]), one);
+    b = _mm_madd_epi16(_mm_loadu_si128((const __m128i *) &in[2 * k + 8]), one);
+    _mm_storeu_si128((__m128i *) &out[k], _mm_packs_epi32(_mm_srai_epi32(a, 1), _mm_srai_epi32(b, 1)));
+  }
+
+  stereo_to_mono_c(&out[k], &in[2 * k], numframes - k);
+}
+
+static const AUDIO_DSP_KERNELS_T g_dsp_sse2 = { "sse2", gain_s16_sse2, s16_to_flt_sse2, flt_to_s16_sse2,
+                                                mono_to_stereo_sse2, stereo_to_mono_sse2 };
+
+//
+// The AVX2 pack and unpack instructions operate within each 128 bit lane, so results 
+// which must keep their order across lanes are fixed up with a 64 bit permute.
+//
+__attribute__((target("avx2")))
+static void gain_s16_avx2(int16_t *samples, unsigned int numsamples, int adjustment) {
+  __m256i coef, one, x, lo, hi;
+  unsigned int k = 0;
+
+  if(adjustment >= -32768 && adjustment <= 32767) {
+
+    coef = _mm256_set1_epi32((128 << 16) | (adjustment & 0xffff));
+    one = _mm256_set1_epi16(1);
+
+    for(k = 0; k + 16 <= numsamples; k += 16) {
+      x = _mm256_loadu_si256((const __m256i *) &samples[k]);
+      lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(x, one), coef);
+      hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(x, one), coef);
+      _mm256_storeu_si256((__m256i *) &samples[k], 
+                          _mm256_packs_epi32(_mm256_srai_epi32(lo, 8), _mm256_srai_epi32(hi, 8)));
+    }
+  }
+
+  gain_s16_c(&samples[k], numsamples - k, adjustment);
+}
+
+__attribute__((target("avx2")))
+static void s16_to_flt_avx2(float *out, const int16_t *in, unsigned int numsamples) {
+  const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+  unsigned int k;
+
+  for(k = 0; k + 8 <= numsamples; k += 8) {
+    _mm256_storeu_ps(&out[k], _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(
+                     _mm_loadu_si128((const __m128i *) &in[k]))), scale));
+  }
+
+  s16_to_flt_c(&out[k], &in[k], numsamples - k);
+}
+
+__attribute__((target("avx2")))
+static void flt_to_s16_avx2(int16_t *out, const float *in, unsigned int numsamples) {
+  const __m256 scale = _mm256_set1_ps(32768.0f);
+  const __m256 fmin = _mm256_set1_ps(-32768.0f);
+  const __m256 fmax = _mm256_set1_ps(32767.0f);
+  __m256 a, b;
+  unsigned int k;
+
+  for(k = 0; k + 16 <= numsamples; k += 16) {
+    a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(&in[k]), scale), fmin), fmax);
+    b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(&in[k + 8]), scale), fmin), fmax);
+    _mm256_storeu_si256((__m256i *) &out[k], _mm256_permute4x64_epi64(
+                        _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b)), 0xd8));
+  }
+
+  flt_to_s16_c(&out[k], &in[k], numsamples - k);
+}
+
+__attribute__((target("avx2")))
+static void mono_to_stereo_avx2(int16_t *out, const int16_t *in, unsigned int numframes) {
+  __m256i x, lo, hi;
+  unsigned int k;
+
+  for(k = 0; k + 16 <= numframes; k += 16) {
+    x = _mm256_loadu_si256((const __m256i *) &in[k]);
+    lo = _mm256_unpacklo_epi16(x, x);
+    hi = _mm256_unpackhi_epi16(x, x);
+    _mm256_storeu_si256((__m256i *) &out[2 * k], _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i *) &out[2 * k + 16], _mm256_permute2x128_si256(lo, hi, 0x31));
+  }
+
+  mono_to_stereo_c(&out[2 * k], &in[k], numframes - k);
+}
+
+__attribute__((target("avx2")))
+static void stereo_to_mono_avx2(int16_t *out, const int16_t *in, unsigned int numframes) {
+  const __m256i one = _mm256_set1_epi16(1);
+  __m256i a, b;
+  unsigned int k;
+
+  for(k = 0; k + 16 <= numframes; k += 16) {
+    a = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *) &in[2 * k]), one);
+    b = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *) &in[2 * k + 16]), one);
+    _mm256_storeu_si256((__m256i *) &out[k], _mm256_permute4x64_epi64(
+                        _mm256_packs_epi32(_mm256_srai_epi32(a, 1), _mm256_srai_epi32(b, 1)), 0xd8));
+  }
+
+  stereo_to_mono_c(&out[k], &in[2 * k], numframes - k);
+}
+
+static const AUDIO_DSP_KERNELS_T g_dsp_avx2 = { "avx2", gain_s16_avx2, s16_to_flt_avx2, flt_to_s16_avx2,
+                                                mono_to_stereo_avx2, stereo_to_mono_avx2 };
+
+#endif // (__GNUC__) && (__x86_64__) || (__i386__)
+
+static const AUDIO_DSP_KERNELS_T *g_pdsp;
+static pthread_once_t g_dsp_once = PTHREAD_ONCE_INIT;
+
+static void dsp_kernels_init(void) {
+
+  g_pdsp = &g_dsp_c;
+
+#if defined(AUDIO_DSP_X86)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")) {
+    g_pdsp = &g_dsp_avx2;
+  } else if(__builtin_cpu_supports("sse2")) {
+    g_pdsp = &g_dsp_sse2;
+  }
+#endif // AUDIO_DSP_X86
+
+  LOG(X_DEBUG("Audio sample conversion using %s kernels"), g_pdsp->name);
+}
+
+static const AUDIO_DSP_KERNELS_T *dsp_kernels_get(void) {
+  pthread_once(&g_dsp_once, dsp_kernels_init);
+  return g_pdsp;
+}
+
+void audio_dsp_gain_s16(int16_t *samples, unsigned int numsamples, int adjustment) {
+  dsp_kernels_get()->gain_s16(samples, numsamples, adjustment);
+}
+
+void audio_dsp_s16_to_flt(float *out, const int16_t *in, unsigned int numsamples) {
+  dsp_kernels_get()->s16_to_flt(out, in, numsamples);
+}
+
+void audio_dsp_flt_to_s16(int16_t *out, const float *in, unsigned int numsamples) {
+  dsp_kernels_get()->flt_to_s16(out, in, numsamples);
+}
+
+void audio_dsp_mono_to_stereo_s16(int16_t *out, const int16_t *in, unsigned int numframes) {
+  dsp_kernels_get()->mono_to_stereo(out, in, numframes);
+}
+
+void audio_dsp_stereo_to_mono_s16(int16_t *out, const int16_t *in, unsigned int numframes) {
+  dsp_kernels_get()->stereo_to_mono(out, in, numframes);
+}
+
+//
+// Format and channel conversion without a change in sample rate.  Float input is 
+// converted to int16 before any channel mixing, the same as the ffmpeg resampler, so float
+// to float conversions with a channel change are left to ffmpeg.
+//
+int audio_dsp_can_convert(int infmt, int inchannels, int outfmt, int outchannels) {
+
+  if((infmt != SAMPLE_FMT_S16 && infmt != SAMPLE_FMT_FLT) ||
+     (outfmt != SAMPLE_FMT_S16 && outfmt != SAMPLE_FMT_FLT) ||
+     (infmt == SAMPLE_FMT_FLT && outfmt == SAMPLE_FMT_FLT) ||
+     inchannels < 1 || inchannels > 2 || outchannels < 1 || outchannels > 2) {
+    return 0;
+  }
+
+  return 1;
+}
+
+#define AUDIO_DSP_CONVERT_CHUNK   512
+
+static void dsp_convert_chunk(const AUDIO_DSP_KERNELS_T *pKernels, 
+                              void *out, int outfmt, int outchannels,
+                              const void *in, int infmt, int inchannels, unsigned int numframes) {
+  int16_t bufin[AUDIO_DSP_CONVERT_CHUNK * 2];
+  int16_t bufmix[AUDIO_DSP_CONVERT_CHUNK * 2];
+  const int16_t *pin = (const int16_t *) in;
+  int16_t *pmix;
+
+  if(infmt == SAMPLE_FMT_FLT) {
+    pKernels->flt_to_s16(bufin, (const float *) in, numframes * inchannels);
+    pin = bufin;
+  }
+
+  if(inchannels != outchannels) {
+    pmix = outfmt == SAMPLE_FMT_S16 ? (int16_t *) out : bufmix;
+    if(inchannels == 1) {
+      pKernels->mono_to_stereo(pmix, pin, numframes);
+    } else {
+      pKernels->stereo_to_mono(pmix, pin, numframes);
+    }
+    pin = pmix;
+  }
+
+  if(outfmt == SAMPLE_FMT_FLT) {
+    pKernels->s16_to_flt((float *) out, pin, numframes * outchannels);
+  } else if(pin != (const int16_t *) out) {
+    memcpy(out, pin, numframes * outchannels * sizeof(int16_t));
+  }
+
+}
+
+static int dsp_convert(const AUDIO_DSP_KERNELS_T *pKernels,
+                       void *out, int outfmt, int outchannels,
+                       const void *in, int infmt, int inchannels, unsigned int numframes) {
+  const unsigned int inbps = infmt == SAMPLE_FMT_FLT ? sizeof(float) : sizeof(int16_t);
+  const unsigned int outbps = outfmt == SAMPLE_FMT_FLT ? sizeof(float) : sizeof(int16_t);
+  unsigned int idx, num;
+
+  if(!audio_dsp_can_convert(infmt, inchannels, outfmt, outchannels)) {
+    return -1;
+  }
+
+  for(idx = 0; idx < numframes; idx += num) {
+    num = MIN(numframes - idx, AUDIO_DSP_CONVERT_CHUNK);
+    dsp_convert_chunk(pKernels, 
+                      (unsigned char *) out + idx * outbps * outchannels, outfmt, outchannels,
+                      (const unsigned char *) in + idx * inbps * inchannels, infmt, inchannels, num);
+  }
+
+  return (int) numframes;
+}
+
+int audio_dsp_convert(void *out, int outfmt, int outchannels,
+                      const void *in, int infmt, int inchannels, unsigned int numframes) {
+  return dsp_convert(dsp_kernels_get(), out, outfmt, outchannels, in, infmt, inchannels, numframes);
+}
+
+//
+// Shared ffmpeg resamplers.  Outputs which convert the same input, such as several 
+// conference legs receiving an identical mix, attach to one resampler per conversion.  Each
+// user tracks the sequence number of the next frame it expects.  The user which reaches a 
+// new frame first runs the resampler and, while other users are attached, keeps the input
+// and output in a short history.  The other users compare their input against the history 
+// and copy the stored output.  A user whose input does not match falls back to a private 
+// resampler.  Because the resampler keeps filter state across frames, a user which attaches 
+// to a resampler already in use first runs privately until its input shows up in the 
+// history.
+//
+typedef struct AUDIO_RESAMPLE_KEY {
+  int                            inRate;
+  int                            outRate;
+  int                            inChannels;
+  int                            outChannels;
+  int                            inFmt;
+  int                            outFmt;
+} AUDIO_RESAMPLE_KEY_T;
+
+typedef struct AUDIO_RESAMPLE_FRAME {
+  unsigned int                   seq;
+  int                            valid;
+  unsigned char                 *pin;
+  unsigned int                   inlen;
+  unsigned int                   szin;
+  unsigned char                 *pout;
+  unsigned int                   outlen;
+  unsigned int                   szout;
+  int                            numSamples;
+} AUDIO_RESAMPLE_FRAME_T;
+
+typedef struct AUDIO_RESAMPLE_SHARED {
+  struct AUDIO_RESAMPLE_SHARED  *pnext;
+  AUDIO_RESAMPLE_KEY_T           key;
+  ReSampleContext               *presample;
+  pthread_mutex_t                mtx;
+  int                            refcnt;
+  unsigned int                   seq;
+  unsigned int                   hits;
+  AUDIO_RESAMPLE_FRAME_T         history[AUDIO_RESAMPLE_HISTORY];
+} AUDIO_RESAMPLE_SHARED_T;
+
+#define AUDIO_RESAMPLE_RC_DIVERGED     -2
+
+static AUDIO_RESAMPLE_SHARED_T *g_presample_shared;
+static pthread_mutex_t g_resample_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static ReSampleContext *resample_init(const AUDIO_RESAMPLE_KEY_T *pKey) {
+  ReSampleContext *presample;
+
+  if(!(presample = av_audio_resample_init(pKey->outChannels, pKey->inChannels, 
+                                          pKey->outRate, pKey->inRate,
+                                          pKey->outFmt, pKey->inFmt, 16, 10, 0, 0.8))) {
+
+    LOG(X_ERROR("Failed to init audio channel resampling context %dHz/%d (%d) -> %dHz/%d (%d)"),
+            pKey->inRate, pKey->inChannels, pKey->inFmt, pKey->outRate, pKey->outChannels, pKey->outFmt);
+  }
+
+  return presample;
+}
+
+static void resample_key(const IXCODE_AVCTXT_RESAMPLE_T *pResample, AUDIO_RESAMPLE_KEY_T *pKey) {
+  memset(pKey, 0, sizeof(AUDIO_RESAMPLE_KEY_T));
+  pKey->inRate = *pResample->pin_samplerate;
+  pKey->outRate = *pResample->pout_samplerate;
+  pKey->inChannels = *pResample->pin_channels;
+  pKey->outChannels = *pResample->pout_channels;
+  pKey->inFmt = *pResample->pin_samplefmt;
+  pKey->outFmt = *pResample->pout_samplefmt;
+}
+
+static unsigned int resample_frame_len(int numSamples, int fmt, int channels) {
+  return numSamples * av_get_bytes_per_sample(fmt) * channels;
+}
+
+static int resample_store(unsigned char **pp, unsigned int *psz, const void *pdata, unsigned int len) {
+
+  if(len > *psz) {
+    if(*pp) {
+      av_free(*pp);
+    }
+    if(!(*pp = av_malloc(len))) {
+      *psz = 0;
+      return -1;
+    }
+    *psz = len;
+  }
+
+  memcpy(*pp, pdata, len);
+
+  return 0;
+}
+
+static AUDIO_RESAMPLE_SHARED_T *resample_shared_attach(const AUDIO_RESAMPLE_KEY_T *pKey, 
+                                                       unsigned int *pseq, int *pinstep) {
+  AUDIO_RESAMPLE_SHARED_T *pShared;
+
+  pthread_mutex_lock(&g_resample_mtx);
+
+  for(pShared = g_presample_shared; pShared; pShared = pShared->pnext) {
+    if(!memcmp(&pShared->key, pKey, sizeof(AUDIO_RESAMPLE_KEY_T))) {
+      break;
+    }
+  }
+
+  if(pShared) {
+
+    pthread_mutex_lock(&pShared->mtx);
+    pShared->refcnt++;
+    *pseq = pShared->seq;
+    *pinstep = 0;
+    pthread_mutex_unlock(&pShared->mtx);
+
+    LOG(X_DEBUG("Joining shared audio resampler %dHz/%d -> %dHz/%d, users: %d"), 
+        pKey->inRate, pKey->inChannels, pKey->outRate, pKey->outChannels, pShared->refcnt);
+
+  } else if((pShared = (AUDIO_RESAMPLE_SHARED_T *) calloc(1, sizeof(AUDIO_RESAMPLE_SHARED_T)))) {
+
+    if(!(pShared->presample = resample_init(pKey))) {
+      free(pShared);
+      pShared = NULL;
+    } else {
+      memcpy(&pShared->key, pKey, sizeof(AUDIO_RESAMPLE_KEY_T));
+      pthread_mutex_init(&pShared->mtx, NULL);
+      pShared->refcnt = 1;
+      pShared->pnext = g_presample_shared;
+      g_presample_shared = pShared;
+      *pseq = 0;
+      *pinstep = 1;
+    }
+  }
+
+  pthread_mutex_unlock(&g_resample_mtx);
+
+  return pShared;
+}
+
+static void resample_shared_detach(AUDIO_RESAMPLE_SHARED_T *pShared) {
+  AUDIO_RESAMPLE_SHARED_T *pPrev = NULL, *pCur;
+  unsigned int idx;
+  int refcnt;
+
+  pthread_mutex_lock(&g_resample_mtx);
+
+  pthread_mutex_lock(&pShared->mtx);
+  refcnt = --pShared->refcnt;
+  pthread_mutex_unlock(&pShared->mtx);
+
+  if(refcnt <= 0) {
+
+    for(pCur = g_presample_shared; pCur && pCur != pShared; pCur = pCur->pnext) {
+      pPrev = pCur;
+    }
+    if(pCur) {
+      if(pPrev) {
+        pPrev->pnext = pCur->pnext;
+      } else {
+        g_presample_shared = pCur->pnext;
+      }
+    }
+
+    if(pShared->hits > 0) {
+      LOG(X_DEBUG("Closing shared audio resampler %dHz/%d -> %dHz/%d after %u frames, %u shared"),
+          pShared->key.inRate, pShared->key.inChannels, pShared->key.outRate, pShared->key.outChannels,
+          pShared->seq, pShared->hits);
+    }
+
+    audio_resample_close(pShared->presample);
+    for(idx = 0; idx < AUDIO_RESAMPLE_HISTORY; idx++) {
+      if(pShared->history[idx].pin) {
+        av_free(pShared->history[idx].pin);
+      }
+      if(pShared->history[idx].pout) {
+        av_free(pShared->history[idx].pout);
+      }
+    }
+    pthread_mutex_destroy(&pShared->mtx);
+    free(pShared);
+  }
+
+  pthread_mutex_unlock(&g_resample_mtx);
+}
+
+static const AUDIO_RESAMPLE_FRAME_T *resample_shared_find(const AUDIO_RESAMPLE_SHARED_T *pShared, 
+                                                         unsigned int seq, 
+                                                         const void *pin, unsigned int inlen) {
+  const AUDIO_RESAMPLE_FRAME_T *pFrame = &pShared->history[seq % AUDIO_RESAMPLE_HISTORY];
+
+  if(pFrame->valid && pFrame->seq == seq && pFrame->inlen == inlen && !memcmp(pFrame->pin, pin, inlen)) {
+    return pFrame;
+  }
+
+  return NULL;
+}
+
+//
+// Resamples the next frame for a user which is in step with the shared resampler.  Returns
+// AUDIO_RESAMPLE_RC_DIVERGED if the input differs from what the other users provided.
+//
+static int resample_shared_run(AUDIO_RESAMPLE_SHARED_T *pShared, unsigned int *pseq,
+                               int16_t *out, const int16_t *in, int numSamples) {
+  const AUDIO_RESAMPLE_FRAME_T *pFound;
+  AUDIO_RESAMPLE_FRAME_T *pFrame;
+  const unsigned int inlen = resample_frame_len(numSamples, pShared->key.inFmt, pShared->key.inChannels);
+  int rc;
+
+  pthread_mutex_lock(&pShared->mtx);
+
+  if(*pseq == pShared->seq) {
+
+    if((rc = audio_resample(pShared->presample, out, (int16_t *) in, numSamples)) >= 0) {
+
+      pFrame = &pShared->history[pShared->seq % AUDIO_RESAMPLE_HISTORY];
+      pFrame->valid = 0;
+
+      if(pShared->refcnt > 1) {
+        pFrame->seq = pShared->seq;
+        pFrame->numSamples = rc;
+        pFrame->inlen = inlen;
+        pFrame->outlen = resample_frame_len(rc, pShared->key.outFmt, pShared->key.outChannels);
+        if(resample_store(&pFrame->pin, &pFrame->szin, in, pFrame->inlen) == 0 &&
+           resample_store(&pFrame->pout, &pFrame->szout, out, pFrame->outlen) == 0) {
+          pFrame->valid = 1;
+        }
+      }
+
+      *pseq = ++pShared->seq;
+    }
+
+  } else if(pShared->seq - *pseq <= AUDIO_RESAMPLE_HISTORY &&
+            (pFound = resample_shared_find(pShared, *pseq, in, inlen))) {
+
+    memcpy(out, pFound->pout, pFound->outlen);
+    rc = pFound->numSamples;
+    pShared->hits++;
+    (*pseq)++;
+
+  } else {
+    rc = AUDIO_RESAMPLE_RC_DIVERGED;
+  }
+
+  pthread_mutex_unlock(&pShared->mtx);
+
+  return rc;
+}
+
+//
+// Looks for the input of a user which is still running privately in the shared history.
+// Returns 1 if found, in which case the user continues in step with the shared resampler.
+//
+static int resample_shared_probe(AUDIO_RESAMPLE_SHARED_T *pShared, unsigned int *pseq,
+                                 const int16_t *in, int numSamples) {
+  const unsigned int inlen = resample_frame_len(numSamples, pShared->key.inFmt, pShared->key.inChannels);
+  unsigned int idx, seq;
+  int rc = 0;
+
+  pthread_mutex_lock(&pShared->mtx);
+
+  for(idx = 1; idx <= AUDIO_RESAMPLE_HISTORY && idx <= pShared->seq; idx++) {
+    seq = pShared->seq - idx;
+    if(resample_shared_find(pShared, seq, in, inlen)) {
+      *pseq = seq + 1;
+      rc = 1;
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&pShared->mtx);
+
+  return rc;
+}
+
+//
+// Primes a private resampler with the last input frame a diverging user shared, so that its
+// filter state continues from the shared resampler rather than starting from silence
+//
+static void resample_shared_prime(AUDIO_RESAMPLE_SHARED_T *pShared, unsigned int seq, 
+                                  ReSampleContext *presample, int16_t *out) {
+  const AUDIO_RESAMPLE_FRAME_T *pFrame = &pShared->history[(seq - 1) % AUDIO_RESAMPLE_HISTORY];
+  const unsigned int bps = av_get_bytes_per_sample(pShared->key.inFmt) * pShared->key.inChannels;
+
+  pthread_mutex_lock(&pShared->mtx);
+
+  if(seq > 0 && pFrame->valid && pFrame->seq == seq - 1) {
+    audio_resample(presample, out, (int16_t *) pFrame->pin, pFrame->inlen / bps);
+  }
+
+  pthread_mutex_unlock(&pShared->mtx);
+}
+
+int audio_dsp_resample_open(struct IXCODE_AVCTXT_RESAMPLE *pResample) {
+  AUDIO_RESAMPLE_KEY_T key;
+  int instep = 0;
+
+  resample_key(pResample, &key);
+
+  if(key.inRate == key.outRate && 
+     audio_dsp_can_convert(key.inFmt, key.inChannels, key.outFmt, key.outChannels)) {
+    pResample->fastconvert = 1;
+    return 0;
+  }
+
+  if((pResample->pShared = resample_shared_attach(&key, &pResample->sharedSeq, &instep)) && instep) {
+    return 0;
+  }
+
+  pResample->sharedProbe = AUDIO_RESAMPLE_PROBE_FRAMES;
+  if(!(pResample->presample = resample_init(&key))) {
+    audio_dsp_resample_close(pResample);
+    return -1;
+  }
+
+  return 0;
+}
+
+int audio_dsp_resample_run(struct IXCODE_AVCTXT_RESAMPLE *pResample, int16_t *out, 
+                           const int16_t *in, int numSamples) {
+  AUDIO_RESAMPLE_KEY_T key;
+  int rc;
+
+  if(pResample->fastconvert) {
+    return audio_dsp_convert(out, *pResample->pout_samplefmt, *pResample->pout_channels,
+                             in, *pResample->pin_samplefmt, *pResample->pin_channels, numSamples);
+  }
+
+  if(pResample->pShared && !pResample->presample) {
+
+    if((rc = resample_shared_run(pResample->pShared, &pResample->sharedSeq, out, in, numSamples)) != 
+       AUDIO_RESAMPLE_RC_DIVERGED) {
+      return rc;
+    }
+
+    //
+    // The input no longer matches the other users, continue on a private resampler
+    //
+    resample_key(pResample, &key);
+    LOG(X_DEBUG("Audio resampler %dHz/%d -> %dHz/%d input differs from shared resampler"), 
+        key.inRate, key.inChannels, key.outRate, key.outChannels);
+
+    if((pResample->presample = resample_init(&key))) {
+      resample_shared_prime(pResample->pShared, pResample->sharedSeq, pResample->presample, out);
+    }
+    resample_shared_detach(pResample->pShared);
+    pResample->pShared = NULL;
+    if(!pResample->presample) {
+      return -1;
+    }
+  }
+
+  if(!pResample->presample) {
+    return -1;
+  }
+
+  if((rc = audio_resample(pResample->presample, out, (int16_t *) in, numSamples)) < 0) {
+    return rc;
+  }
+
+  if(pResample->pShared) {
+
+    if(resample_shared_probe(pResample->pShared, &pResample->sharedSeq, in, numSamples) > 0) {
+      audio_resample_close(pResample->presample);
+      pResample->presample = NULL;
+      pResample->sharedProbe = 0;
+    } else if(--pResample->sharedProbe <= 0) {
+      resample_shared_detach(pResample->pShared);
+      pResample->pShared = NULL;
+    }
+  }
+
+  return rc;
+}
+
+void audio_dsp_resample_close(struct IXCODE_AVCTXT_RESAMPLE *pResample) {
+
+  if(pResample->presample) {
+    audio_resample_close(pResample->presample);
+    pResample->presample = NULL;
+  }
+
+  if(pResample->pShared) {
+    resample_shared_detach(pResample->pShared);
+    pResample->pShared = NULL;
+  }
+
+  pResample->sharedSeq = 0;
+  pResample->sharedProbe = 0;
+  pResample->fastconvert = 0;
+}
+
+#define AUDIO_DSP_BENCH_SAMPLES         960
+#define AUDIO_DSP_BENCH_RATE_IN         16000
+#define AUDIO_DSP_BENCH_RATE_OUT        48000
+
+enum AUDIO_DSP_BENCH_OP {
+  AUDIO_DSP_BENCH_GAIN              = 0,
+  AUDIO_DSP_BENCH_S16_TO_FLT        = 1,
+  AUDIO_DSP_BENCH_FLT_TO_S16        = 2,
+  AUDIO_DSP_BENCH_MONO_TO_STEREO    = 3,
+  AUDIO_DSP_BENCH_STEREO_TO_MONO    = 4,
+  AUDIO_DSP_BENCH_OP_MAX            = 5
+};
+
+static const char *g_dsp_bench_names[] = { "gain", "s16-to-flt", "flt-to-s16", 
+                                           "mono-to-stereo", "stereo-to-mono" };
+
+static double dsp_bench_time_ms(const struct timeval *ptv0) {
+  struct timeval tv1;
+
+  gettimeofday(&tv1, NULL);
+
+  return ((tv1.tv_sec - ptv0->tv_sec) * 1000.0) + ((tv1.tv_usec - ptv0->tv_usec) / 1000.0);
+}
+
+//
+// Runs one kernel over a 20ms 48KHz stereo frame and returns the output and its length 
+//
+static double dsp_bench_op(const AUDIO_DSP_KERNELS_T *pKernels, enum AUDIO_DSP_BENCH_OP op, 
+                           unsigned int frames, const int16_t *in16, const float *inflt, 
+                           int16_t *out16, float *outflt, void **ppout, unsigned int *poutlen) {
+  const unsigned int num = AUDIO_DSP_BENCH_SAMPLES * 2;
+  struct timeval tv0;
+  unsigned int idx;
+
+  if(op == AUDIO_DSP_BENCH_GAIN) {
+    memcpy(out16, in16, num * sizeof(int16_t));
+  }
+
+  gettimeofday(&tv0, NULL);
+
+  for(idx = 0; idx < frames; idx++) {
+    switch(op) {
+      case AUDIO_DSP_BENCH_GAIN:
+        //
+        // Alternate between boosting, which saturates the loudest samples, and attenuating
+        //
+        pKernels->gain_s16(out16, num, (idx & 1) ? 170 : 384);
+        break;
+      case AUDIO_DSP_BENCH_S16_TO_FLT:
+        pKernels->s16_to_flt(outflt, in16, num);
+        break;
+      case AUDIO_DSP_BENCH_FLT_TO_S16:
+        pKernels->flt_to_s16(out16, inflt, num);
+        break;
+      case AUDIO_DSP_BENCH_MONO_TO_STEREO:
+        pKernels->mono_to_stereo(out16, in16, num / 2);
+        break;
+      case AUDIO_DSP_BENCH_STEREO_TO_MONO:
+        pKernels->stereo_to_mono(out16, in16, num / 2);
+        break;
+      default:
+        break;
+    }
+  }
+
+  *ppout = op == AUDIO_DSP_BENCH_S16_TO_FLT ? (void *) outflt : (void *) out16;
+  *poutlen = op == AUDIO_DSP_BENCH_S16_TO_FLT ? num * sizeof(float) : 
+             op == AUDIO_DSP_BENCH_STEREO_TO_MONO ? num / 2 * sizeof(int16_t) : num * sizeof(int16_t);
+
+  return dsp_bench_time_ms(&tv0);
+}
+
+static int dsp_bench_kernels(unsigned int frames) {
+  const AUDIO_DSP_KERNELS_T *arrKernels[3];
+  unsigned int numKernels = 0;
+  const unsigned int num = AUDIO_DSP_BENCH_SAMPLES * 2;
+  int16_t *in16 = NULL, *out16, *ref16;
+  float *inflt, *outflt, *refflt;
+  void *pout, *pref;
+  unsigned int outlen, reflen, i, lcg = 1;
+  enum AUDIO_DSP_BENCH_OP op;
+  double ms, ms_c = 0;
+  int exact;
+  int rc = 0;
+
+  arrKernels[numKernels++] = &g_dsp_c;
+#if defined(AUDIO_DSP_X86)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("sse2")) {
+    arrKernels[numKernels++] = &g_dsp_sse2;
+  }
+  if(__builtin_cpu_supports("avx2")) {
+    arrKernels[numKernels++] = &g_dsp_avx2;
+  }
+#endif // AUDIO_DSP_X86
+
+  if(!(in16 = (int16_t *) malloc(num * 3 * sizeof(int16_t) + num * 3 * sizeof(float)))) {
+    return -1;
+  }
+  out16 = in16 + num;
+  ref16 = out16 + num;
+  inflt = (float *) (ref16 + num);
+  outflt = inflt + num;
+  refflt = outflt + num;
+
+  //
+  // Float input extends past full scale to exercise the clamp 
+  //
+  for(i = 0; i < num; i++) {
+    lcg = lcg * 1103515245 + 12345;
+    in16[i] = (int16_t) (lcg >> 16);
+    inflt[i] = ((int) (lcg >> 8) % 80000) / 65536.0f;
+  }
+
+  fprintf(stdout, "Audio sample conversion benchmark: %u samples x 2 channels, %u frames\n", 
+          AUDIO_DSP_BENCH_SAMPLES, frames);
+
+  for(op = 0; op < AUDIO_DSP_BENCH_OP_MAX; op++) {
+    for(i = 0; i < numKernels; i++) {
+
+      ms = dsp_bench_op(arrKernels[i], op, frames, in16, inflt, out16, outflt, &pout, &outlen);
+
+      if(i == 0) {
+        ms_c = ms;
+        pref = op == AUDIO_DSP_BENCH_S16_TO_FLT ? (void *) refflt : (void *) ref16;
+        reflen = outlen;
+        memcpy(pref, pout, outlen);
+      }
+      exact = (outlen == reflen && !memcmp(pref, pout, outlen));
+
+      fprintf(stdout, "  %-15s %-5s %8.3f us/frame  speedup: %5.2fx  bit-exact: %s\n",
+              g_dsp_bench_names[op], arrKernels[i]->name, ms * 1000.0 / frames,
+              ms > 0 ? ms_c / ms : 0, exact ? "yes" : "no");
+
+      if(!exact) {
+        rc = -1;
+      }
+    }
+  }
+
+  free(in16);
+
+  return rc;
+}
+
+//
+// Resamples the same input for a number of outputs using one private resampler per output,
+// then again through the shared resampler, and verifies every output matches
+//
+static int dsp_bench_resample(unsigned int outputs, unsigned int frames) {
+  const unsigned int numIn = AUDIO_DSP_BENCH_RATE_IN / 50;
+  const unsigned int szOut = numIn * (AUDIO_DSP_BENCH_RATE_OUT / AUDIO_DSP_BENCH_RATE_IN) * 2 + 256;
+  IXCODE_AVCTXT_RESAMPLE_T *pResamples = NULL;
+  AUDIO_RESAMPLE_KEY_T key;
+  int inRate = AUDIO_DSP_BENCH_RATE_IN, outRate = AUDIO_DSP_BENCH_RATE_OUT;
+  int channels = 1, fmt = SAMPLE_FMT_S16;
+  int16_t *in = NULL, *out, *ref;
+  int *refNum = NULL;
+  struct timeval tv0;
+  double ms_private, ms_shared;
+  unsigned int frameIdx, idx, i, lcg = 1;
+  int numOut;
+  int exact = 1;
+  int rc = 0;
+
+  if(!(pResamples = (IXCODE_AVCTXT_RESAMPLE_T *) calloc(outputs, sizeof(IXCODE_AVCTXT_RESAMPLE_T))) ||
+     !(refNum = (int *) calloc(frames, sizeof(int))) ||
+     !(in = (int16_t *) malloc((numIn * frames + szOut + szOut * frames) * sizeof(int16_t)))) {
+    free(pResamples);
+    free(refNum);
+    return -1;
+  }
+  out = in + numIn * frames;
+  ref = out + szOut;
+
+  for(i = 0; i < numIn * frames; i++) {
+    lcg = lcg * 1103515245 + 12345;
+    in[i] = (int16_t) (sin(i * 0.05) * 8000 + (int) ((lcg >> 16) & 0x3ff) - 512);
+  }
+
+  memset(&key, 0, sizeof(key));
+  key.inRate = inRate;
+  key.outRate = outRate;
+  key.inChannels = key.outChannels = channels;
+  key.inFmt = key.outFmt = fmt;
+
+  for(idx = 0; idx < outputs; idx++) {
+    pResamples[idx].pin_samplerate = &inRate;
+    pResamples[idx].pout_samplerate = &outRate;
+    pResamples[idx].pin_channels = pResamples[idx].pout_channels = &channels;
+    pResamples[idx].pin_samplefmt = pResamples[idx].pout_samplefmt = &fmt;
+    if(!(pResamples[idx].presample = resample_init(&key))) {
+      rc = -1;
+    }
+  }
+
+  //
+  // One private resampler per output
+  //
+  gettimeofday(&tv0, NULL);
+  for(frameIdx = 0; frameIdx < frames && rc == 0; frameIdx++) {
+    for(idx = 0; idx < outputs; idx++) {
+      if((numOut = audio_resample(pResamples[idx].presample, idx == 0 ? &ref[frameIdx * szOut] : out,
+                                  &in[frameIdx * numIn], numIn)) < 0) {
+        rc = -1;
+        break;
+      }
+      if(idx == 0) {
+        refNum[frameIdx] = numOut;
+      }
+    }
+  }
+  ms_private = dsp_bench_time_ms(&tv0);
+
+  for(idx = 0; idx < outputs; idx++) {
+    audio_dsp_resample_close(&pResamples[idx]);
+    if(rc == 0 && audio_dsp_resample_open(&pResamples[idx]) < 0) {
+      rc = -1;
+    }
+  }
+
+  //
+  // All outputs attached to one shared resampler
+  //
+  gettimeofday(&tv0, NULL);
+  for(frameIdx = 0; frameIdx < frames && rc == 0; frameIdx++) {
+    for(idx = 0; idx < outputs; idx++) {
+      if((numOut = audio_dsp_resample_run(&pResamples[idx], out, &in[frameIdx * numIn], numIn)) < 0) {
+        rc = -1;
+        break;
+      }
+      if(numOut != refNum[frameIdx] || 
+         memcmp(out, &ref[frameIdx * szOut], numOut * channels * sizeof(int16_t))) {
+        exact = 0;
+      }
+    }
+  }
+  ms_shared = dsp_bench_time_ms(&tv0);
+
+  for(idx = 0; idx < outputs; idx++) {
+    audio_dsp_resample_close(&pResamples[idx]);
+  }
+
+  if(rc == 0) {
+    fprintf(stdout, "Audio resampler benchmark: %dHz -> %dHz, %u outputs, %u frames\n",
+            inRate, outRate, outputs, frames);
+    fprintf(stdout, "  private %8.3f us/frame\n", ms_private * 1000.0 / frames);
+    fprintf(stdout, "  shared  %8.3f us/frame  speedup: %5.2fx  bit-exact: %s\n", 
+            ms_shared * 1000.0 / frames, ms_shared > 0 ? ms_private / ms_shared : 0, 
+            exact ? "yes" : "no");
+  }
+
+  if(!exact) {
+    rc = -1;
+  }
+
+  free(in);
+  free(refNum);
+  free(pResamples);
+
+  return rc;
+}
+
+int audio_dsp_benchmark(unsigned int outputs, unsigned int frames) {
+  int rc = 0;
+
+  if(outputs == 0) {
+    outputs = 1;
+  }
+  if(frames == 0) {
+    frames = 1;
+  }
+
+  if(dsp_bench_kernels(frames) < 0) {
+    rc = -1;
+  }
+
+  fprintf(stdout, "\n");
+
+  if(dsp_bench_resample(outputs, frames) < 0) {
+    rc = -1;
+  }
+
+  return rc;
+}
@@ -30,6 +30,7 @@
 #else // WIN32
 
 #include <unistd.h>
+#include <sys/time.h>
 
 #endif // WIN32
 
@@ -43,6 +44,197 @@
 #include "xcoder.h"
 #include "xcoder_filter.h"
 
+#if (XCODE_FILTER_ON)
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FILTER_X86 1
+#include <emmintrin.h>
+#endif // (__GNUC__) && (__x86_64__) || (__i386__)
+
+//
+// Filters split each plane into bands which are run on a pool of slice threads owned by 
+// the filter context.  The calling thread runs slices too, so a pool of N threads
+// only creates N - 1 additional threads.
+//
+typedef void (* FILTER_SLICE_FUNC) (void *, unsigned int, unsigned int);
+
+typedef struct FILTER_POOL {
+  pthread_mutex_t              mtx;
+  pthread_cond_t               cond;
+  pthread_cond_t               condDone;
+  pthread_t                    tds[IXCODE_FILTER_THREADS_MAX];
+  unsigned int                 numTds;
+  int                          running;
+  unsigned int                 jobId;
+  FILTER_SLICE_FUNC            func;
+  void                        *pArg;
+  unsigned int                 numSlices;
+  unsigned int                 nextSlice;
+  unsigned int                 numDone;
+} FILTER_POOL_T;
+
+//
+// Called with the pool mutex held.  Slices are handed out in increasing order, which the 
+// denoise wavefront relies upon, since a slice may wait for its predecessor.
+//
+static void filter_pool_slices(FILTER_POOL_T *pPool) {
+  unsigned int slice;
+
+  while(pPool->nextSlice < pPool->numSlices) {
+    slice = pPool->nextSlice++;
+    pthread_mutex_unlock(&pPool->mtx);
+
+    pPool->func(pPool->pArg, slice, pPool->numSlices);
+
+    pthread_mutex_lock(&pPool->mtx);
+    if(++pPool->numDone >= pPool->numSlices) {
+      pthread_cond_broadcast(&pPool->condDone);
+    }
+  }
+
+}
+
+static void *filter_pool_proc(void *pArg) {
+  FILTER_POOL_T *pPool = (FILTER_POOL_T *) pArg;
+  unsigned int jobId = 0;
+
+  pthread_mutex_lock(&pPool->mtx);
+
+  while(1) {
+
+    while(pPool->running && pPool->jobId == jobId) {
+      pthread_cond_wait(&pPool->cond, &pPool->mtx);
+    }
+
+    if(!pPool->running) {
+      break;
+    }
+
+    jobId = pPool->jobId;
+    filter_pool_slices(pPool);
+  }
+
+  pthread_mutex_unlock(&pPool->mtx);
+
+  return NULL;
+}
+
+static void filter_pool_destroy(FILTER_POOL_T *pPool) {
+  unsigned int idx;
+
+  if(!pPool) {
+    return;
+  }
+
+  pthread_mutex_lock(&pPool->mtx);
+  pPool->running = 0;
+  pthread_cond_broadcast(&pPool->cond);
+  pthread_mutex_unlock(&pPool->mtx);
+
+  for(idx = 0; idx < pPool->numTds; idx++) {
+    pthread_join(pPool->tds[idx], NULL);
+  }
+
+  pthread_cond_destroy(&pPool->condDone);
+  pthread_cond_destroy(&pPool->cond);
+  pthread_mutex_destroy(&pPool->mtx);
+  free(pPool);
+}
+
+static FILTER_POOL_T *filter_pool_create(int threads) {
+  FILTER_POOL_T *pPool;
+
+  if(threads > IXCODE_FILTER_THREADS_MAX) {
+    threads = IXCODE_FILTER_THREADS_MAX;
+  }
+
+  if(threads <= 1 || !(pPool = (FILTER_POOL_T *) calloc(1, sizeof(FILTER_POOL_T)))) {
+    return NULL;
+  }
+
+  pthread_mutex_init(&pPool->mtx, NULL);
+  pthread_cond_init(&pPool->cond, NULL);
+  pthread_cond_init(&pPool->condDone, NULL);
+  pPool->running = 1;
+
+  while(pPool->numTds < (unsigned int) threads - 1) {
+    if(pthread_create(&pPool->tds[pPool->numTds], NULL, filter_pool_proc, pPool) != 0) {
+      LOG(X_WARNING("Unable to create filter thread %d / %d"), pPool->numTds + 1, threads - 1);
+      break;
+    }
+    pPool->numTds++;
+  }
+
+  if(pPool->numTds == 0) {
+    filter_pool_destroy(pPool);
+    return NULL;
+  }
+
+  return pPool;
+}
+
+static unsigned int filter_pool_threads(const FILTER_POOL_T *pPool) {
+  return pPool ? pPool->numTds + 1 : 1;
+}
+
+static void filter_pool_run(FILTER_POOL_T *pPool, FILTER_SLICE_FUNC func, void *pArg, 
+                            unsigned int numSlices) {
+  unsigned int slice;
+
+  if(!pPool || numSlices <= 1) {
+    for(slice = 0; slice < numSlices; slice++) {
+      func(pArg, slice, numSlices);
+    }
+    return;
+  }
+
+  pthread_mutex_lock(&pPool->mtx);
+
+  pPool->func = func;
+  pPool->pArg = pArg;
+  pPool->numSlices = numSlices;
+  pPool->nextSlice = 0;
+  pPool->numDone = 0;
+  pPool->jobId++;
+  pthread_cond_broadcast(&pPool->cond);
+
+  filter_pool_slices(pPool);
+
+  while(pPool->numDone < pPool->numSlices) {
+    pthread_cond_wait(&pPool->condDone, &pPool->mtx);
+  }
+
+  pthread_mutex_unlock(&pPool->mtx);
+
+}
+
+static unsigned int filter_slices(const FILTER_POOL_T *pPool, unsigned int units, unsigned int minUnits) {
+  unsigned int numSlices = filter_pool_threads(pPool);
+
+  if(minUnits > 0 && numSlices > units / minUnits) {
+    numSlices = units / minUnits;
+  }
+
+  return numSlices > 0 ? numSlices : 1;
+}
+
+static pthread_once_t g_filter_simd_once = PTHREAD_ONCE_INIT;
+static int g_filter_simd;
+
+static void filter_simd_init(void) {
+#if defined(FILTER_X86)
+  __builtin_cpu_init();
+  g_filter_simd = __builtin_cpu_supports("sse2") ? 1 : 0;
+#endif // FILTER_X86
+}
+
+static int filter_have_simd(void) {
+  pthread_once(&g_filter_simd_once, filter_simd_init);
+  return g_filter_simd;
+}
+
+#endif // XCODE_FILTER_ON
+
 #if defined(XCODE_FILTER_UNSHARP) && (XCODE_FILTER_UNSHARP > 0)
 
 #define FILTER_UNSHARP_MIN_SIZE 2
@@ -61,15 +253,45 @@ typedef struct FilterParam {
     int steps_y;                             ///< vertical step count
     int scalebits;                           ///< bits to shift pixel
     int32_t halfscale;                       ///< amount to add to pixel
-    uint32_t *sc[(FILTER_UNSHARP_MAX_SIZE * FILTER_UNSHARP_MAX_SIZE) - 1]; ///< finite state machine storage
+    int rowlen;                              ///< length of a padded row of sums
+    uint32_t *scratch;                       ///< per slice row sums and finite state machine storage
 } FilterParam;
 
 typedef struct UnsharpContext {
     FilterParam luma;   ///< luma parameters (width, height, amount)
     FilterParam chroma; ///< chroma parameters (width, height, amount)
     int hsub, vsub;
+    FILTER_POOL_T *pPool;
+    unsigned int numSlicesMax;
+
+    //
+    // sum[k] = src[k] + src[k - 1]
+    //
+    void (*hsum)(uint32_t *, const uint32_t *, int);
+
+    //
+    // Run a column sum through each stage of the vertical finite state machine
+    //
+    void (*vsum)(uint32_t *, uint32_t *const *, int, int);
+
+    //
+    // Blend the source row with the blurred sums
+    //
+    void (*apply)(uint8_t *, const uint8_t *, const uint32_t *, int, const FilterParam *);
 } UnsharpContext;
 
+typedef struct UNSHARP_JOB {
+    const UnsharpContext *pCtx;
+    const FilterParam *fp;
+    uint8_t *dst;
+    int dst_stride;
+    const uint8_t *src;
+    int src_stride;
+    int width;
+    int height;
+    unsigned int numSlices;
+} UNSHARP_JOB_T;
+
 
 #if 0
 
@@ -87,16 +309,143 @@ static av_always_inline av_const uint8_t av_clip_uint8_arm(int a)
 }
 #endif // 0
 
-void filter_unsharp_free(void *pArg) {
-  UnsharpContext *pCtx = (UnsharpContext *) pArg;
-  unsigned int i;
+static void unsharp_hsum_c(uint32_t *dst, const uint32_t *src, int n) {
+  int x;
 
-  for (i = 0; i < 2 * pCtx->luma.steps_y; i++) {
-    av_free(pCtx->luma.sc[i]);
+  for(x = 0; x < n; x++) {
+    dst[x] = src[x] + src[x - 1];
   }
-  for (i = 0; i < 2 * pCtx->chroma.steps_y; i++) {
-    av_free(pCtx->chroma.sc[i]);
+}
+
+static void unsharp_vsum_c(uint32_t *tmp, uint32_t *const *sc, int stages, int n) {
+  uint32_t tmp1, tmp2;
+  int x, z;
+
+  for(x = 0; x < n; x++) {
+    tmp1 = tmp[x];
+    for(z = 0; z < stages; z++) {
+      tmp2 = sc[z][x] + tmp1; sc[z][x] = tmp1;
+      tmp1 = tmp2;
+    }
+    tmp[x] = tmp1;
   }
+}
+
+static void unsharp_apply_c(uint8_t *dst, const uint8_t *src, const uint32_t *sum, int n, 
+                            const FilterParam *fp) {
+  int32_t res;
+  int x;
+
+  for(x = 0; x < n; x++) {
+    res = (int32_t)src[x] + ((((int32_t) src[x] - (int32_t)((sum[x] + fp->halfscale) >> fp->scalebits)) * 
+          fp->amount) >> 16);
+    dst[x] = av_clip_uint8(res);
+  }
+}
+
+#if defined(FILTER_X86)
+
+__attribute__((target("sse2")))
+static void unsharp_hsum_sse2(uint32_t *dst, const uint32_t *src, int n) {
+  int x;
+
+  for(x = 0; x + 4 <= n; x += 4) {
+    _mm_storeu_si128((__m128i *) &dst[x], _mm_add_epi32(_mm_loadu_si128((const __m128i *) &src[x]),
+                                                        _mm_loadu_si128((const __m128i *) &src[x - 1])));
+  }
+
+  unsharp_hsum_c(&dst[x], &src[x], n - x);
+}
+
+__attribute__((target("sse2")))
+static void unsharp_vsum_sse2(uint32_t *tmp, uint32_t *const *sc, int stages, int n) {
+  __m128i tmp1, tmp2;
+  int x, z;
+
+  for(x = 0; x + 4 <= n; x += 4) {
+    tmp1 = _mm_loadu_si128((const __m128i *) &tmp[x]);
+    for(z = 0; z < stages; z++) {
+      tmp2 = _mm_add_epi32(_mm_loadu_si128((const __m128i *) &sc[z][x]), tmp1);
+      _mm_storeu_si128((__m128i *) &sc[z][x], tmp1);
+      tmp1 = tmp2;
+    }
+    _mm_storeu_si128((__m128i *) &tmp[x], tmp1);
+  }
+
+  for(; x < n; x++) {
+    uint32_t t1 = tmp[x], t2;
+    for(z = 0; z < stages; z++) {
+      t2 = sc[z][x] + t1; sc[z][x] = t1;
+      t1 = t2;
+    }
+    tmp[x] = t1;
+  }
+}
+
+//
+// SSE2 has no 32 bit low multiply.  The low 32 bits of the product are the same for 
+// signed and unsigned operands.
+//
+__attribute__((target("sse2")))
+static inline __m128i mullo_epi32_sse2(__m128i a, __m128i b) {
+  __m128i t0 = _mm_mul_epu32(a, b);
+  __m128i t1 = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(t0, _MM_SHUFFLE(0, 0, 2, 0)), 
+                            _mm_shuffle_epi32(t1, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+__attribute__((target("sse2")))
+static void unsharp_apply_sse2(uint8_t *dst, const uint8_t *src, const uint32_t *sum, int n, 
+                               const FilterParam *fp) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i half = _mm_set1_epi32(fp->halfscale);
+  const __m128i amount = _mm_set1_epi32(fp->amount);
+  const __m128i bits = _mm_cvtsi32_si128(fp->scalebits);
+  __m128i s8, s16, s32, res[4];
+  int x, idx;
+
+  for(x = 0; x + 16 <= n; x += 16) {
+    s8 = _mm_loadu_si128((const __m128i *) &src[x]);
+    for(idx = 0; idx < 4; idx++) {
+      s16 = idx < 2 ? _mm_unpacklo_epi8(s8, zero) : _mm_unpackhi_epi8(s8, zero);
+      s32 = (idx & 1) ? _mm_unpackhi_epi16(s16, zero) : _mm_unpacklo_epi16(s16, zero);
+      res[idx] = _mm_srl_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i *) &sum[x + idx * 4]), half), 
+                               bits);
+      res[idx] = _mm_srai_epi32(mullo_epi32_sse2(_mm_sub_epi32(s32, res[idx]), amount), 16);
+      res[idx] = _mm_add_epi32(s32, res[idx]);
+    }
+    _mm_storeu_si128((__m128i *) &dst[x], _mm_packus_epi16(_mm_packs_epi32(res[0], res[1]), 
+                                                           _mm_packs_epi32(res[2], res[3])));
+  }
+
+  unsharp_apply_c(&dst[x], &src[x], &sum[x], n - x, fp);
+}
+
+#endif // FILTER_X86
+
+static void unsharp_set_kernels(UnsharpContext *pCtx, int simd) {
+
+  pCtx->hsum = unsharp_hsum_c;
+  pCtx->vsum = unsharp_vsum_c;
+  pCtx->apply = unsharp_apply_c;
+
+#if defined(FILTER_X86)
+  if(simd) {
+    pCtx->hsum = unsharp_hsum_sse2;
+    pCtx->vsum = unsharp_vsum_sse2;
+    pCtx->apply = unsharp_apply_sse2;
+  }
+#endif // FILTER_X86
+
+}
+
+void filter_unsharp_free(void *pArg) {
+  UnsharpContext *pCtx = (UnsharpContext *) pArg;
+
+  filter_pool_destroy(pCtx->pPool);
+  av_free(pCtx->luma.scratch);
+  av_free(pCtx->chroma.scratch);
 
   free(pCtx);
 }
@@ -117,10 +466,18 @@ static void check_limit_strength(float *pf) {
   }
 }
 
+//
+// Each slice has 2 * steps_y rows of finite state machine storage followed by two rows
+// used for the horizontal sums
+//
+static uint32_t *unsharp_alloc_scratch(FilterParam *fp, int width, unsigned int numSlices) {
+  fp->rowlen = width + 2 * fp->steps_x;
+  return av_malloc(sizeof(uint32_t) * fp->rowlen * (2 * fp->steps_y + 2) * numSlices);
+}
+
 void *filter_unsharp_init(int width, void *pArg) {
   IXCODE_FILTER_UNSHARP_T *pCfg = (IXCODE_FILTER_UNSHARP_T *) pArg;
   UnsharpContext *pCtx;
-  int i;
 
   if((pCfg->luma.strength != 0 && (pCfg->luma.sizeX < 2 || pCfg->luma.sizeY < 2)) ||
      (pCfg->chroma.strength != 0 && (pCfg->chroma.sizeX < 2 || pCfg->chroma.sizeY < 2))) { 
@@ -135,11 +492,14 @@ void *filter_unsharp_init(int width, void *pArg) {
   check_limit_strength(&pCfg->luma.strength);
   check_limit_strength(&pCfg->chroma.strength);
 
-  if(!(pCtx = av_malloc(sizeof(struct UnsharpContext)))) {
+  if(!(pCtx = calloc(1, sizeof(struct UnsharpContext)))) {
     return NULL;
   }
 
   pCtx->hsub = pCtx->vsub = 1;
+  pCtx->pPool = filter_pool_create(pCfg->common.threads);
+  pCtx->numSlicesMax = filter_pool_threads(pCtx->pPool);
+  unsharp_set_kernels(pCtx, filter_have_simd());
 
   pCtx->luma.msize_x = pCfg->luma.sizeX;
   pCtx->luma.msize_y = pCfg->luma.sizeY;
@@ -148,10 +508,7 @@ void *filter_unsharp_init(int width, void *pArg) {
   pCtx->luma.steps_y = pCtx->luma.msize_y / 2;
   pCtx->luma.scalebits = (pCtx->luma.steps_x + pCtx->luma.steps_y) * 2;
   pCtx->luma.halfscale = 1 << (pCtx->luma.scalebits - 1);
-
-  for (i = 0; i < 2 * pCtx->luma.steps_y; i++) {
-    pCtx->luma.sc[i] = av_malloc(sizeof(*(pCtx->luma.sc[i])) * (width + 2 * pCtx->luma.steps_x));
-  }
+  pCtx->luma.scratch = unsharp_alloc_scratch(&pCtx->luma, width, pCtx->numSlicesMax);
 
   pCtx->chroma.msize_x = pCfg->chroma.sizeX;
   pCtx->chroma.msize_y = pCfg->chroma.sizeY;
@@ -163,26 +520,88 @@ void *filter_unsharp_init(int width, void *pArg) {
 
   width = SHIFTUP(width, 1); // hsub
 
-  for (i = 0; i < 2 * pCtx->chroma.steps_y; i++) {
-    pCtx->chroma.sc[i] = av_malloc(sizeof(*(pCtx->chroma.sc[i])) * (width + 2 * pCtx->chroma.steps_x));
+  pCtx->chroma.scratch = unsharp_alloc_scratch(&pCtx->chroma, width, pCtx->numSlicesMax);
+
+  if(!pCtx->luma.scratch || !pCtx->chroma.scratch) {
+    filter_unsharp_free(pCtx);
+    return NULL;
   }
 
-  LOG(X_DEBUG("Filter %s luma x:%d, y:%d, %.2f, chroma x:%d, y:%d, %.2f"),
+  LOG(X_DEBUG("Filter %s luma x:%d, y:%d, %.2f, chroma x:%d, y:%d, %.2f, threads:%d"),
               pCfg->luma.strength > 0 || pCfg->luma.strength > 0 ? "sharpen" : "blur",
               pCtx->luma.msize_x, pCtx->luma.msize_y, pCfg->luma.strength,
-              pCtx->chroma.msize_x, pCtx->chroma.msize_y, pCfg->chroma.strength);
+              pCtx->chroma.msize_x, pCtx->chroma.msize_y, pCfg->chroma.strength,
+              pCtx->numSlicesMax);
 
   return pCtx;
 }
 
-static void apply_unsharp(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
-                          int width, int height, FilterParam *fp) {
-    uint32_t **sc = fp->sc;
-    uint32_t sr[(FILTER_UNSHARP_MAX_SIZE * FILTER_UNSHARP_MAX_SIZE) - 1], tmp1, tmp2;
+//
+// The horizontal and vertical finite state machines are cascades of 2 tap sums, so an 
+// output row only depends upon the steps_y input rows above and below it.  Each slice
+// primes its own state machine from the rows above its band, producing the same output
+// as a single pass over the whole plane.  Each stage is run across the whole row at once
+// rather than per pixel so that it can be vectorized.
+//
+static void unsharp_slice(void *pArg, unsigned int slice, unsigned int numSlices) {
+    const UNSHARP_JOB_T *pJob = (const UNSHARP_JOB_T *) pArg;
+    const UnsharpContext *pCtx = pJob->pCtx;
+    const FilterParam *fp = pJob->fp;
+    const int width = pJob->width;
+    const int height = pJob->height;
+    const int stages_x = 2 * fp->steps_x;
+    const int stages_y = 2 * fp->steps_y;
+    uint32_t *sc[(FILTER_UNSHARP_MAX_SIZE / 2) * 2];
+    uint32_t *scratch, *sum, *sumtmp, *ptmp;
+    const uint8_t *src2;
+    int x, y, z, y0, y1;
+
+    y0 = (int) (((int64_t) height * slice) / numSlices);
+    y1 = (int) (((int64_t) height * (slice + 1)) / numSlices);
+
+    if(y0 >= y1) {
+        return;
+    }
+
+    scratch = fp->scratch + (size_t) fp->rowlen * (stages_y + 2) * slice;
+    for(z = 0; z < stages_y; z++) {
+        sc[z] = scratch + (size_t) fp->rowlen * z;
+        memset(sc[z], 0, sizeof(sc[z][0]) * fp->rowlen);
+        sc[z] += stages_x;
+    }
+    sum = scratch + (size_t) fp->rowlen * stages_y;
+    sumtmp = sum + fp->rowlen;
 
-    int32_t res;
-    int x, y, z;
-    const uint8_t *src2 = NULL;  //silence a warning
+    for (y = y0 - fp->steps_y; y < y1 + fp->steps_y; y++) {
+
+        src2 = pJob->src + (y <= 0 ? 0 : y >= height ? height - 1 : y) * pJob->src_stride;
+
+        for (x = -fp->steps_x; x < width + fp->steps_x; x++) {
+            sum[x + fp->steps_x] = x <= 0 ? src2[0] : x >= width ? src2[width-1] : src2[x];
+        }
+
+        //
+        // Only the last (width) sums of the last stage are used 
+        //
+        for (z = 1; z <= stages_x; z++) {
+            pCtx->hsum(&sumtmp[z], &sum[z], fp->rowlen - z);
+            ptmp = sum; sum = sumtmp; sumtmp = ptmp;
+        }
+
+        pCtx->vsum(&sum[stages_x], sc, stages_y, width);
+
+        if (y >= y0 + fp->steps_y) {
+            pCtx->apply(pJob->dst + (y - fp->steps_y) * pJob->dst_stride, 
+                        pJob->src + (y - fp->steps_y) * pJob->src_stride, &sum[stages_x], width, fp);
+        }
+    }
+}
+
+static void apply_unsharp(const UnsharpContext *pCtx, uint8_t *dst, int dst_stride, 
+                          const uint8_t *src, int src_stride, int width, int height, 
+                          const FilterParam *fp) {
+    UNSHARP_JOB_T job;
+    int y;
 
     if (fp->amount == 0.0f) {
         if (dst_stride == src_stride)
@@ -193,39 +612,25 @@ static void apply_unsharp(uint8_t *dst, int dst_stride, const uint8_t *src, int
         return;
     }
 
-    for(y = 0; y < 2 * fp->steps_y; y++) {
-        memset(sc[y], 0, sizeof(sc[y][0]) * (width + 2 * fp->steps_x));
+    if (width <= 0 || height <= 0 || width + 2 * fp->steps_x > fp->rowlen) {
+        return;
     }
 
-    for (y = -fp->steps_y; y < height + fp->steps_y; y++) {
-        if (y < height)
-            src2 = src;
-
-        memset(sr, 0, sizeof(sr[0]) * (2 * fp->steps_x - 1));
-        for (x = -fp->steps_x; x < width + fp->steps_x; x++) {
-            tmp1 = x <= 0 ? src2[0] : x >= width ? src2[width-1] : src2[x];
-            for (z = 0; z < fp->steps_x * 2; z += 2) {
-                tmp2 = sr[z + 0] + tmp1; sr[z + 0] = tmp1;
-                tmp1 = sr[z + 1] + tmp2; sr[z + 1] = tmp2;
-            }
-            for (z = 0; z < fp->steps_y * 2; z += 2) {
-                tmp2 = sc[z + 0][x + fp->steps_x] + tmp1; sc[z + 0][x + fp->steps_x] = tmp1;
-                tmp1 = sc[z + 1][x + fp->steps_x] + tmp2; sc[z + 1][x + fp->steps_x] = tmp2;
-            }
-            if (x >= fp->steps_x && y >= fp->steps_y) {
-                const uint8_t *srx = src - fp->steps_y * src_stride + x - fp->steps_x;
-                uint8_t       *dsx = dst - fp->steps_y * dst_stride + x - fp->steps_x;
-
-                res = (int32_t)*srx + ((((int32_t) * srx - (int32_t)((tmp1 + fp->halfscale) >> fp->scalebits)) * fp->amount) >> 16);
-
-                *dsx = av_clip_uint8(res);
-            }
-        }
-        if (y >= 0) {
-            dst += dst_stride;
-            src += src_stride;
-        }
-    }
+    job.pCtx = pCtx;
+    job.fp = fp;
+    job.dst = dst;
+    job.dst_stride = dst_stride;
+    job.src = src;
+    job.src_stride = src_stride;
+    job.width = width;
+    job.height = height;
+
+    //
+    // Each band re-reads 2 * steps_y rows, so keep the bands reasonably tall
+    //
+    job.numSlices = filter_slices(pCtx->pPool, height, 8 * fp->steps_y);
+
+    filter_pool_run(pCtx->pPool, unsharp_slice, &job, job.numSlices);
 }
 
 int filter_unsharp(void *pArg, const unsigned char *src_data[4], const int src_linesize[4],
@@ -241,27 +646,81 @@ int filter_unsharp(void *pArg, const unsigned char *src_data[4], const int src_l
 
   //fprintf(stderr, "UNSHARP data: 0x%x 0x%x 0x%x ls:%d,%d,%d, amount luma:%d, chroma: %d, cw:%d, ch:%d\n", dst_data[0], dst_data[1], dst_data[2], dst_linesize[0], dst_linesize[1], dst_linesize[2], pCtx->luma.amount, pCtx->chroma.amount, cw, ch);
 
-  apply_unsharp(dst_data[0], dst_linesize[0], src_data[0], src_linesize[0], width, height, &pCtx->luma);
-  apply_unsharp(dst_data[1], dst_linesize[1], src_data[1], src_linesize[1], cw, ch, &pCtx->chroma);
-  apply_unsharp(dst_data[2], dst_linesize[2], src_data[2], src_linesize[2], cw, ch, &pCtx->chroma);
+  apply_unsharp(pCtx, dst_data[0], dst_linesize[0], src_data[0], src_linesize[0], width, height, &pCtx->luma);
+  apply_unsharp(pCtx, dst_data[1], dst_linesize[1], src_data[1], src_linesize[1], cw, ch, &pCtx->chroma);
+  apply_unsharp(pCtx, dst_data[2], dst_linesize[2], src_data[2], src_linesize[2], cw, ch, &pCtx->chroma);
 
   return rc;
 }
 
 #endif // (XCODE_FILTER_UNSHARP) && (XCODE_FILTER_UNSHARP > 0)
 
-
 #if defined(XCODE_FILTER_DENOISE) && (XCODE_FILTER_DENOISE > 0)
 
+//
+// Denoise bands are vertical strips of the plane.  The spacial filter is recursive in 
+// both directions, so a band waits for the band to its left to publish the running 
+// horizontal value at the end of each row, forming a wavefront across the slice threads.
+//
+#define DENOISE_BAND_MIN_WIDTH     64
+#define DENOISE_BAND_SPINS         64
+#define DENOISE_BAND_WAIT_ROWS     16
+
+//
+// Hand-off of the horizontal antecedent column between adjacent denoise bands.  A band 
+// waiting on its predecessor blocks on the condition instead of spinning, until a batch of
+// rows is available.  The predecessor only takes the mutex once it reaches waitRows.
+//
+typedef struct DENOISE_BAND_SYNC {
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    volatile int waitRows;
+} DENOISE_BAND_SYNC_T;
+
 typedef struct HQDN3DContext {
     int Coefs[4][512*16];
+    int CoefsEnd;         /* LowPassMul can index one past the last table on wrap-around */
     unsigned int *Line;
     unsigned short *Frame[3];
     int hsub, vsub;
+    FILTER_POOL_T *pPool;
+    unsigned int *pBandAnt;
+    unsigned int bandAntRows;
+    volatile int bandRows[IXCODE_FILTER_THREADS_MAX];
+    DENOISE_BAND_SYNC_T bandSync[IXCODE_FILTER_THREADS_MAX];
 } HQDN3DContext;
 
+typedef struct DENOISE_BAND {
+    long X0;
+    long X1;
+    const unsigned int *pAntIn;
+    volatile int *pRowsIn;
+    DENOISE_BAND_SYNC_T *pSyncIn;
+    unsigned int *pAntOut;
+    volatile int *pRowsOut;
+    DENOISE_BAND_SYNC_T *pSyncOut;
+    long H;
+} DENOISE_BAND_T;
+
+typedef struct DENOISE_JOB {
+    HQDN3DContext *pCtx;
+    const unsigned char *Frame;
+    unsigned char *FrameDest;
+    unsigned short *FrameAnt;
+    int W, H, sStride, dStride;
+    int *Horizontal, *Vertical, *Temporal;
+} DENOISE_JOB_T;
+
 void filter_denoise_free(void *pArg) {
   HQDN3DContext *pCtx = (HQDN3DContext *) pArg;
+  unsigned int idx;
+
+  filter_pool_destroy(pCtx->pPool);
+
+  for(idx = 0; idx < IXCODE_FILTER_THREADS_MAX; idx++) {
+    pthread_cond_destroy(&pCtx->bandSync[idx].cond);
+    pthread_mutex_destroy(&pCtx->bandSync[idx].mtx);
+  }
 
   if(pCtx->Line) {
     av_freep(&pCtx->Line);
@@ -275,6 +734,9 @@ void filter_denoise_free(void *pArg) {
   if(pCtx->Frame[2]) {
     av_freep(&pCtx->Frame[2]);
   }
+  if(pCtx->pBandAnt) {
+    av_freep(&pCtx->pBandAnt);
+  }
   
   av_free(pCtx);
 }
@@ -297,11 +759,17 @@ static void precalcCoefs(int *Ct, double Dist25) {
 void *filter_denoise_init(int width, void *pArg) {
   IXCODE_FILTER_DENOISE_T *pCfg = (IXCODE_FILTER_DENOISE_T *) pArg;
   HQDN3DContext *pCtx;
+  unsigned int idx;
 
   if(!(pCtx = av_mallocz(sizeof(struct HQDN3DContext)))) {
     return NULL;
   }
 
+  for(idx = 0; idx < IXCODE_FILTER_THREADS_MAX; idx++) {
+    pthread_mutex_init(&pCtx->bandSync[idx].mtx, NULL);
+    pthread_cond_init(&pCtx->bandSync[idx].cond, NULL);
+  }
+
 #define PARAM1_DEFAULT 4.0
 #define PARAM2_DEFAULT 3.0
 #define PARAM3_DEFAULT 6.0
@@ -327,9 +795,11 @@ void *filter_denoise_init(int width, void *pArg) {
   pCtx->hsub = 1;
   pCtx->vsub = 1;
   pCtx->Line = av_malloc(width * sizeof(*pCtx->Line));
+  pCtx->pPool = filter_pool_create(pCfg->common.threads);
 
-  LOG(X_DEBUG("Filter denoise spacial luma:%.2f, chroma:%.2f, temporal luma:%.2f, chroma:%.2f"),
-               pCfg->lumaSpacial, pCfg->chromaSpacial, pCfg->lumaTemporal, pCfg->chromaTemporal);
+  LOG(X_DEBUG("Filter denoise spacial luma:%.2f, chroma:%.2f, temporal luma:%.2f, chroma:%.2f, threads:%d"),
+               pCfg->lumaSpacial, pCfg->chromaSpacial, pCfg->lumaTemporal, pCfg->chromaTemporal,
+               filter_pool_threads(pCtx->pPool));
 
   return pCtx;
 }
@@ -341,16 +811,59 @@ static inline unsigned int LowPassMul(unsigned int PrevMul, unsigned int CurrMul
     return CurrMul + Coef[d];
 }
 
+static void band_ant_wait(const DENOISE_BAND_T *pBand, long Y) {
+    DENOISE_BAND_SYNC_T *pSync = pBand->pSyncIn;
+
+    pthread_mutex_lock(&pSync->mtx);
+    pSync->waitRows = (int) FFMIN(Y + DENOISE_BAND_WAIT_ROWS, pBand->H);
+    __sync_synchronize();
+    while (*pBand->pRowsIn < pSync->waitRows) {
+        pthread_cond_wait(&pSync->cond, &pSync->mtx);
+    }
+    pSync->waitRows = 0;
+    pthread_mutex_unlock(&pSync->mtx);
+}
+
+static inline unsigned int band_ant_get(const DENOISE_BAND_T *pBand, long Y) {
+    unsigned int spins = 0;
+
+    while (*pBand->pRowsIn <= Y) {
+        if (++spins >= DENOISE_BAND_SPINS) {
+            band_ant_wait(pBand, Y);
+            break;
+        }
+    }
+    __sync_synchronize();
+
+    return pBand->pAntIn[Y];
+}
+
+static inline void band_ant_put(const DENOISE_BAND_T *pBand, long Y, unsigned int PixelAnt) {
+    DENOISE_BAND_SYNC_T *pSync;
+
+    if (pBand->pAntOut) {
+        pBand->pAntOut[Y] = PixelAnt;
+        __sync_synchronize();
+        *pBand->pRowsOut = Y + 1;
+        __sync_synchronize();
+        if ((pSync = pBand->pSyncOut)->waitRows > 0 && Y + 1 >= pSync->waitRows) {
+            pthread_mutex_lock(&pSync->mtx);
+            pthread_cond_signal(&pSync->cond);
+            pthread_mutex_unlock(&pSync->mtx);
+        }
+    }
+}
+
 static void deNoiseTemporal(const unsigned char *FrameSrc,
                             unsigned char *FrameDest,
                             unsigned short *FrameAnt,
                             int W, int H, int sStride, int dStride,
-                            int *Temporal) {
+                            int *Temporal, const DENOISE_BAND_T *pBand) {
     long X, Y;
     unsigned int PixelDst;
 
     for (Y = 0; Y < H; Y++) {
-        for (X = 0; X < W; X++) {
+        for (X = pBand->X0; X < pBand->X1; X++) {
             PixelDst = LowPassMul(FrameAnt[X]<<8, FrameSrc[X]<<16, Temporal);
             FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
             FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
@@ -365,99 +878,117 @@ static void deNoiseSpacial(const unsigned char *Frame,
                            unsigned char *FrameDest,
                            unsigned int *LineAnt,
                            int W, int H, int sStride, int dStride,
-                           int *Horizontal, int *Vertical) {
+                           int *Horizontal, int *Vertical, const DENOISE_BAND_T *pBand) {
     long X, Y;
     long sLineOffs = 0, dLineOffs = 0;
     unsigned int PixelAnt;
     unsigned int PixelDst;
 
-    /* First pixel has no left nor top neighbor. */
-    PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+    if (pBand->X0 == 0) {
+        /* First pixel has no left nor top neighbor. */
+        PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
+        FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+        X = 1;
+    } else {
+        PixelAnt = band_ant_get(pBand, 0);
+        X = pBand->X0;
+    }
 
     /* First line has no top neighbor, only left. */
-    for (X = 1; X < W; X++) {
+    for (; X < pBand->X1; X++) {
         PixelDst = LineAnt[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
         FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
     }
+    band_ant_put(pBand, 0, PixelAnt);
 
     for (Y = 1; Y < H; Y++) {
         unsigned int PixelAnt;
         sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        PixelDst = LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
+        if (pBand->X0 == 0) {
+            /* First pixel on each line doesn't have previous pixel */
+            PixelAnt = Frame[sLineOffs]<<16;
+            PixelDst = LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
+            FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
+            X = 1;
+        } else {
+            PixelAnt = band_ant_get(pBand, Y);
+            X = pBand->X0;
+        }
 
-        for (X = 1; X < W; X++) {
+        for (; X < pBand->X1; X++) {
             unsigned int PixelDst;
             /* The rest are normal */
             PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
             PixelDst = LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
             FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
         }
+        band_ant_put(pBand, Y, PixelAnt);
     }
 }
 
-static void deNoise(const unsigned char *Frame,
-                    unsigned char *FrameDest,
-                    unsigned int *LineAnt,
-                    unsigned short **FrameAntPtr,
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical, int *Temporal) {
+static void deNoiseBand(const DENOISE_JOB_T *pJob, const DENOISE_BAND_T *pBand) {
+    const unsigned char *Frame = pJob->Frame;
+    unsigned char *FrameDest = pJob->FrameDest;
+    unsigned int *LineAnt = pJob->pCtx->Line;
+    unsigned short *FrameAnt = pJob->FrameAnt;
+    const int W = pJob->W, H = pJob->H, sStride = pJob->sStride, dStride = pJob->dStride;
+    int *Horizontal = pJob->Horizontal, *Vertical = pJob->Vertical, *Temporal = pJob->Temporal;
     long X, Y;
     long sLineOffs = 0, dLineOffs = 0;
     unsigned int PixelAnt;
     unsigned int PixelDst;
-    unsigned short* FrameAnt=(*FrameAntPtr);
-
-    if (!FrameAnt) {
-        (*FrameAntPtr) = FrameAnt = av_malloc(W*H*sizeof(unsigned short));
-        for (Y = 0; Y < H; Y++) {
-            unsigned short* dst=&FrameAnt[Y*W];
-            const unsigned char* src=Frame+Y*sStride;
-            for (X = 0; X < W; X++) dst[X]=src[X]<<8;
-        }
-    }
 
     if (!Horizontal[0] && !Vertical[0]) {
         deNoiseTemporal(Frame, FrameDest, FrameAnt,
-                        W, H, sStride, dStride, Temporal);
+                        W, H, sStride, dStride, Temporal, pBand);
         return;
     }
     if (!Temporal[0]) {
         deNoiseSpacial(Frame, FrameDest, LineAnt,
-                       W, H, sStride, dStride, Horizontal, Vertical);
+                       W, H, sStride, dStride, Horizontal, Vertical, pBand);
         return;
     }
 
-    /* First pixel has no left nor top neighbor. Only previous frame */
-    LineAnt[0] = PixelAnt = Frame[0]<<16;
-    PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
-    FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+    if (pBand->X0 == 0) {
+        /* First pixel has no left nor top neighbor. Only previous frame */
+        LineAnt[0] = PixelAnt = Frame[0]<<16;
+        PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
+        FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
+        FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+        X = 1;
+    } else {
+        PixelAnt = band_ant_get(pBand, 0);
+        X = pBand->X0;
+    }
 
     /* First line has no top neighbor. Only left one for each pixel and
      * last frame */
-    for (X = 1; X < W; X++) {
+    for (; X < pBand->X1; X++) {
         LineAnt[X] = PixelAnt = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
         PixelDst = LowPassMul(FrameAnt[X]<<8, PixelAnt, Temporal);
         FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
         FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
     }
+    band_ant_put(pBand, 0, PixelAnt);
 
     for (Y = 1; Y < H; Y++) {
         unsigned int PixelAnt;
         unsigned short* LinePrev=&FrameAnt[Y*W];
         sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        PixelDst = LowPassMul(LinePrev[0]<<8, LineAnt[0], Temporal);
-        LinePrev[0] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (X = 1; X < W; X++) {
+        if (pBand->X0 == 0) {
+            /* First pixel on each line doesn't have previous pixel */
+            PixelAnt = Frame[sLineOffs]<<16;
+            LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
+            PixelDst = LowPassMul(LinePrev[0]<<8, LineAnt[0], Temporal);
+            LinePrev[0] = ((PixelDst+0x1000007F)>>8);
+            FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
+            X = 1;
+        } else {
+            PixelAnt = band_ant_get(pBand, Y);
+            X = pBand->X0;
+        }
+
+        for (; X < pBand->X1; X++) {
             unsigned int PixelDst;
             /* The rest are normal */
             PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
@@ -466,7 +997,79 @@ static void deNoise(const unsigned char *Frame,
             LinePrev[X] = ((PixelDst+0x1000007F)>>8);
             FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
         }
+        band_ant_put(pBand, Y, PixelAnt);
+    }
+}
+
+static void deNoise_slice(void *pArg, unsigned int slice, unsigned int numSlices) {
+    const DENOISE_JOB_T *pJob = (const DENOISE_JOB_T *) pArg;
+    HQDN3DContext *pCtx = pJob->pCtx;
+    DENOISE_BAND_T band;
+
+    band.X0 = (long) pJob->W * slice / numSlices;
+    band.X1 = (long) pJob->W * (slice + 1) / numSlices;
+    band.pAntIn = slice > 0 ? &pCtx->pBandAnt[(slice - 1) * pCtx->bandAntRows] : NULL;
+    band.pRowsIn = slice > 0 ? &pCtx->bandRows[slice - 1] : NULL;
+    band.pSyncIn = slice > 0 ? &pCtx->bandSync[slice - 1] : NULL;
+    band.pAntOut = slice + 1 < numSlices ? &pCtx->pBandAnt[slice * pCtx->bandAntRows] : NULL;
+    band.pRowsOut = &pCtx->bandRows[slice];
+    band.pSyncOut = &pCtx->bandSync[slice];
+    band.H = pJob->H;
+
+    deNoiseBand(pJob, &band);
+}
+
+static void deNoise(HQDN3DContext *pCtx,
+                    const unsigned char *Frame,
+                    unsigned char *FrameDest,
+                    unsigned short **FrameAntPtr,
+                    int W, int H, int sStride, int dStride,
+                    int *Horizontal, int *Vertical, int *Temporal) {
+    long X, Y;
+    unsigned short* FrameAnt=(*FrameAntPtr);
+    unsigned int numSlices, slice;
+    DENOISE_JOB_T job;
+
+    if (!FrameAnt) {
+        (*FrameAntPtr) = FrameAnt = av_malloc(W*H*sizeof(unsigned short));
+        for (Y = 0; Y < H; Y++) {
+            unsigned short* dst=&FrameAnt[Y*W];
+            const unsigned char* src=Frame+Y*sStride;
+            for (X = 0; X < W; X++) dst[X]=src[X]<<8;
+        }
     }
+
+    numSlices = filter_slices(pCtx->pPool, W, DENOISE_BAND_MIN_WIDTH);
+
+    if (numSlices > 1 && (!pCtx->pBandAnt || pCtx->bandAntRows < (unsigned int) H)) {
+        if (pCtx->pBandAnt) {
+            av_freep(&pCtx->pBandAnt);
+        }
+        if ((pCtx->pBandAnt = av_malloc(sizeof(unsigned int) * H * IXCODE_FILTER_THREADS_MAX))) {
+            pCtx->bandAntRows = H;
+        } else {
+            pCtx->bandAntRows = 0;
+            numSlices = 1;
+        }
+    }
+
+    for (slice = 0; slice < numSlices; slice++) {
+        pCtx->bandRows[slice] = 0;
+    }
+
+    job.pCtx = pCtx;
+    job.Frame = Frame;
+    job.FrameDest = FrameDest;
+    job.FrameAnt = FrameAnt;
+    job.W = W;
+    job.H = H;
+    job.sStride = sStride;
+    job.dStride = dStride;
+    job.Horizontal = Horizontal;
+    job.Vertical = Vertical;
+    job.Temporal = Temporal;
+
+    filter_pool_run(pCtx->pPool, deNoise_slice, &job, numSlices);
 }
 
 
@@ -478,15 +1081,15 @@ int filter_denoise(void *pArg, const unsigned char *src_data[4], const int src_l
   int cw = width >> pCtx->hsub;
   int ch = height >> pCtx->vsub;
 
-  deNoise(src_data[0], dst_data[0], pCtx->Line, &pCtx->Frame[0], width, height,
+  deNoise(pCtx, src_data[0], dst_data[0], &pCtx->Frame[0], width, height,
             src_linesize[0], dst_linesize[0], pCtx->Coefs[0],
             pCtx->Coefs[0], pCtx->Coefs[1]);
 
-  deNoise(src_data[1], dst_data[1], pCtx->Line, &pCtx->Frame[1], cw, ch,
+  deNoise(pCtx, src_data[1], dst_data[1], &pCtx->Frame[1], cw, ch,
           src_linesize[1], dst_linesize[1], pCtx->Coefs[2],
           pCtx->Coefs[2], pCtx->Coefs[3]);
 
-  deNoise(src_data[2], dst_data[2], pCtx->Line, &pCtx->Frame[2], cw, ch,
+  deNoise(pCtx, src_data[2], dst_data[2], &pCtx->Frame[2], cw, ch,
           src_linesize[2], dst_linesize[2], pCtx->Coefs[2],
           pCtx->Coefs[2], pCtx->Coefs[3]);
 
@@ -505,8 +1108,20 @@ typedef struct COLOR_CTX {
   int            i_cos;
   int            i_x;
   int            i_y;
+  FILTER_POOL_T *pPool;
+  void         (*color_uv)(const struct COLOR_CTX *, const uint8_t *, const uint8_t *, 
+                           uint8_t *, uint8_t *, unsigned int);
 } COLOR_CTX_T;
 
+typedef struct COLOR_JOB {
+  const COLOR_CTX_T    *pCtx;
+  const unsigned char **src_data;
+  const int            *src_linesize;
+  unsigned char       **dst_data;
+  const int            *dst_linesize;
+  unsigned int          height;
+} COLOR_JOB_T;
+
 
 #define ADJUST_8_TIMES(x) x; x; x; x; x; x; x; x
 
@@ -530,75 +1145,144 @@ static av_always_inline av_const uint8_t av_clip_uint8_arm(int a)
 }
 #endif // 0
 
-static void filter_color_uv(const COLOR_CTX_T *pCtx, 
-                           const unsigned char *src_data[4], const int src_linesize[4],
-                           unsigned char *dst_data[4], const int dst_linesize[4],
-                           unsigned int height) {
-
-  const uint8_t *p_in_u, *p_in_v;
-  uint8_t *p_out_u, *p_out_v;
+static void filter_color_uv_c(const COLOR_CTX_T *pCtx, const uint8_t *p_in_u, const uint8_t *p_in_v, 
+                              uint8_t *p_out_u, uint8_t *p_out_v, unsigned int len) {
   uint8_t i_u, i_v;
-  unsigned int x, y;
+  unsigned int x = 0;
 
-  for(y = 0; y < height/2; y++) {
+  while(x + 8 < len) {
 
-    x = 0;
-    p_in_u = src_data[1] + (y * src_linesize[1]);
-    p_in_v = src_data[2] + (y * src_linesize[2]);
-    p_out_u = dst_data[1] + (y * dst_linesize[1]);
-    p_out_v = dst_data[2] + (y * dst_linesize[2]);
-
-    while(x < src_linesize[1] - 8) {
-
-      ADJUST_8_TIMES(
-        i_u = *p_in_u++; 
-        i_v = *p_in_v++; 
-        if(pCtx->i_sat > 256) {
-          *p_out_u++ = av_clip_uint8( (( ((i_u * pCtx->i_cos + i_v * pCtx->i_sin - pCtx->i_x) >> 8) * 
-                                pCtx->i_sat) >> 8) + 128); 
-          *p_out_v++ = av_clip_uint8( (( ((i_v * pCtx->i_cos - i_u * pCtx->i_sin - pCtx->i_y) >> 8) * 
-                                pCtx->i_sat) >> 8) + 128);
-        } else {
-          *p_out_u++ =  (( ((i_u * pCtx->i_cos + i_v * pCtx->i_sin - pCtx->i_x) >> 8) * 
-                                pCtx->i_sat) >> 8) + 128; 
-          *p_out_v++ =  (( ((i_v * pCtx->i_cos - i_u * pCtx->i_sin - pCtx->i_y) >> 8) * 
-                                pCtx->i_sat) >> 8) + 128;
-        }
-      );
-      x+= 8;
-    }
-
-    while(x < src_linesize[1]) {
+    ADJUST_8_TIMES(
       i_u = *p_in_u++; 
       i_v = *p_in_v++; 
       if(pCtx->i_sat > 256) {
         *p_out_u++ = av_clip_uint8( (( ((i_u * pCtx->i_cos + i_v * pCtx->i_sin - pCtx->i_x) >> 8) * 
-                                pCtx->i_sat) >> 8) + 128); 
+                              pCtx->i_sat) >> 8) + 128); 
         *p_out_v++ = av_clip_uint8( (( ((i_v * pCtx->i_cos - i_u * pCtx->i_sin - pCtx->i_y) >> 8) * 
-                                pCtx->i_sat) >> 8) + 128);
+                              pCtx->i_sat) >> 8) + 128);
       } else {
-        *p_out_u++ = (( ((i_u * pCtx->i_cos + i_v * pCtx->i_sin - pCtx->i_x) >> 8) * 
-                                pCtx->i_sat) >> 8) + 128; 
-        *p_out_v++ = (( ((i_v * pCtx->i_cos - i_u * pCtx->i_sin - pCtx->i_y) >> 8) * 
-                                pCtx->i_sat) >> 8) + 128;
+        *p_out_u++ =  (( ((i_u * pCtx->i_cos + i_v * pCtx->i_sin - pCtx->i_x) >> 8) * 
+                              pCtx->i_sat) >> 8) + 128; 
+        *p_out_v++ =  (( ((i_v * pCtx->i_cos - i_u * pCtx->i_sin - pCtx->i_y) >> 8) * 
+                              pCtx->i_sat) >> 8) + 128;
       }
-      x++;
+    );
+    x+= 8;
+  }
+
+  while(x < len) {
+    i_u = *p_in_u++; 
+    i_v = *p_in_v++; 
+    if(pCtx->i_sat > 256) {
+      *p_out_u++ = av_clip_uint8( (( ((i_u * pCtx->i_cos + i_v * pCtx->i_sin - pCtx->i_x) >> 8) * 
+                              pCtx->i_sat) >> 8) + 128); 
+      *p_out_v++ = av_clip_uint8( (( ((i_v * pCtx->i_cos - i_u * pCtx->i_sin - pCtx->i_y) >> 8) * 
+                              pCtx->i_sat) >> 8) + 128);
+    } else {
+      *p_out_u++ = (( ((i_u * pCtx->i_cos + i_v * pCtx->i_sin - pCtx->i_x) >> 8) * 
+                              pCtx->i_sat) >> 8) + 128; 
+      *p_out_v++ = (( ((i_v * pCtx->i_cos - i_u * pCtx->i_sin - pCtx->i_y) >> 8) * 
+                              pCtx->i_sat) >> 8) + 128;
     }
+    x++;
+  }
 
+}
+
+#if defined(FILTER_X86)
+
+//
+// (u * cos + v * sin) is a 16 bit multiply-add of interleaved (u, v) pairs.  The rotated 
+// value fits in 16 bits before it is scaled by the saturation.
+//
+__attribute__((target("sse2")))
+static inline __m128i color_uv_sse2(__m128i uv, __m128i coefs, __m128i offset, __m128i sat) {
+  __m128i t, lo, hi;
+
+  t = _mm_srai_epi32(_mm_sub_epi32(_mm_madd_epi16(uv, coefs), offset), 8);
+  t = _mm_packs_epi32(t, t);
+  lo = _mm_mullo_epi16(t, sat);
+  hi = _mm_mulhi_epi16(t, sat);
+  t = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 8);
+
+  return _mm_add_epi32(t, _mm_set1_epi32(128));
+}
+
+__attribute__((target("sse2")))
+static void filter_color_uv_sse2(const COLOR_CTX_T *pCtx, const uint8_t *p_in_u, const uint8_t *p_in_v, 
+                                 uint8_t *p_out_u, uint8_t *p_out_v, unsigned int len) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i mask = _mm_set1_epi16(0xff);
+  const __m128i coefs_u = _mm_set1_epi32((int) (((unsigned int) pCtx->i_cos & 0xffff) | 
+                                                ((unsigned int) pCtx->i_sin << 16)));
+  const __m128i coefs_v = _mm_set1_epi32((int) (((unsigned int) -pCtx->i_sin & 0xffff) | 
+                                                ((unsigned int) pCtx->i_cos << 16)));
+  const __m128i off_u = _mm_set1_epi32(pCtx->i_x);
+  const __m128i off_v = _mm_set1_epi32(pCtx->i_y);
+  const __m128i sat = _mm_set1_epi16(pCtx->i_sat);
+  const int clip = pCtx->i_sat > 256 ? 1 : 0;
+  __m128i u8, v8, u16, v16, uv, ru[4], rv[4], out_u, out_v;
+  unsigned int x = 0;
+  int idx;
+
+  for(x = 0; x + 16 <= len; x += 16) {
+    u8 = _mm_loadu_si128((const __m128i *) &p_in_u[x]);
+    v8 = _mm_loadu_si128((const __m128i *) &p_in_v[x]);
+
+    for(idx = 0; idx < 4; idx++) {
+      u16 = idx < 2 ? _mm_unpacklo_epi8(u8, zero) : _mm_unpackhi_epi8(u8, zero);
+      v16 = idx < 2 ? _mm_unpacklo_epi8(v8, zero) : _mm_unpackhi_epi8(v8, zero);
+      uv = (idx & 1) ? _mm_unpackhi_epi16(u16, v16) : _mm_unpacklo_epi16(u16, v16);
+      ru[idx] = color_uv_sse2(uv, coefs_u, off_u, sat);
+      rv[idx] = color_uv_sse2(uv, coefs_v, off_v, sat);
+    }
+
+    out_u = _mm_packs_epi32(ru[0], ru[1]);
+    u16 = _mm_packs_epi32(ru[2], ru[3]);
+    out_v = _mm_packs_epi32(rv[0], rv[1]);
+    v16 = _mm_packs_epi32(rv[2], rv[3]);
+
+    if(!clip) {
+      //
+      // Without clipping the result is truncated to 8 bits
+      //
+      out_u = _mm_and_si128(out_u, mask);
+      u16 = _mm_and_si128(u16, mask);
+      out_v = _mm_and_si128(out_v, mask);
+      v16 = _mm_and_si128(v16, mask);
+    }
+
+    _mm_storeu_si128((__m128i *) &p_out_u[x], _mm_packus_epi16(out_u, u16));
+    _mm_storeu_si128((__m128i *) &p_out_v[x], _mm_packus_epi16(out_v, v16));
   }
 
+  filter_color_uv_c(pCtx, &p_in_u[x], &p_in_v[x], &p_out_u[x], &p_out_v[x], len - x);
+}
+
+#endif // FILTER_X86
+
+static void filter_color_set_kernels(COLOR_CTX_T *pCtx, int simd) {
+
+  pCtx->color_uv = filter_color_uv_c;
+
+#if defined(FILTER_X86)
+  if(simd) {
+    pCtx->color_uv = filter_color_uv_sse2;
+  }
+#endif // FILTER_X86
+
 }
 
 static void filter_color_y(const COLOR_CTX_T *pCtx, 
                            const unsigned char *src_data[4], const int src_linesize[4],
                            unsigned char *dst_data[4], const int dst_linesize[4],
-                           unsigned int height) {
+                           unsigned int y0, unsigned int y1) {
 
   const uint8_t *p_in;
   uint8_t *p_out;
   unsigned int x, y;
 
-  for(y = 0; y < height; y++) {
+  for(y = y0; y < y1; y++) {
     x = 0;
     p_in = src_data[0] + (y * src_linesize[0]);
     p_out = dst_data[0] + (y * dst_linesize[0]);
@@ -616,6 +1300,25 @@ static void filter_color_y(const COLOR_CTX_T *pCtx,
 
 }
 
+static void filter_color_slice(void *pArg, unsigned int slice, unsigned int numSlices) {
+  const COLOR_JOB_T *pJob = (const COLOR_JOB_T *) pArg;
+  const COLOR_CTX_T *pCtx = pJob->pCtx;
+  const unsigned int heightuv = pJob->height / 2;
+  unsigned int y, y1;
+
+  filter_color_y(pCtx, pJob->src_data, pJob->src_linesize, pJob->dst_data, pJob->dst_linesize,
+                 pJob->height * slice / numSlices, pJob->height * (slice + 1) / numSlices);
+
+  y1 = heightuv * (slice + 1) / numSlices;
+
+  for(y = heightuv * slice / numSlices; y < y1; y++) {
+    pCtx->color_uv(pCtx, pJob->src_data[1] + (y * pJob->src_linesize[1]), 
+                   pJob->src_data[2] + (y * pJob->src_linesize[2]),
+                   pJob->dst_data[1] + (y * pJob->dst_linesize[1]),
+                   pJob->dst_data[2] + (y * pJob->dst_linesize[2]), pJob->src_linesize[1]);
+  }
+
+}
 
 void *filter_color_init(int width, void *pArg) {
   IXCODE_FILTER_COLOR_T *pCfg = (IXCODE_FILTER_COLOR_T *) pArg;
@@ -670,6 +1373,9 @@ void *filter_color_init(int width, void *pArg) {
     return NULL;
   }
 
+  pCtx->pPool = filter_pool_create(pCfg->common.threads);
+  filter_color_set_kernels(pCtx, filter_have_simd());
+
   i_cont = (int32_t) (pCfg->fContrast * 255);
   i_lum = (int32_t) ((pCfg->fBrightness - 1.0f) * 255);
   f_hue = (float) (pCfg->fHue * M_PI / 180);
@@ -697,6 +1403,7 @@ void *filter_color_init(int width, void *pArg) {
 void filter_color_free(void *pArg) {
   COLOR_CTX_T *pCtx = (COLOR_CTX_T *) pArg;
 
+  filter_pool_destroy(pCtx->pPool);
   free(pCtx);
 
 }
@@ -706,11 +1413,18 @@ int filter_color(void *pArg, const unsigned char *src_data[4], const int src_lin
                  unsigned int width, unsigned int height) {
 
   COLOR_CTX_T *pCtx = (COLOR_CTX_T *) pArg;
+  COLOR_JOB_T job;
   int rc = 0;
 
   //fprintf(stderr, "filter_color %d,%d, height:%d\n", src_linesize[0], dst_linesize[0], height);
-  filter_color_y(pCtx, src_data, src_linesize, dst_data, dst_linesize, height);
-  filter_color_uv(pCtx, src_data, src_linesize, dst_data, dst_linesize, height);
+  job.pCtx = pCtx;
+  job.src_data = src_data;
+  job.src_linesize = src_linesize;
+  job.dst_data = dst_data;
+  job.dst_linesize = dst_linesize;
+  job.height = height;
+
+  filter_pool_run(pCtx->pPool, filter_color_slice, &job, filter_slices(pCtx->pPool, height / 2, 16));
 
   return rc;
 }
@@ -719,10 +1433,123 @@ int filter_color(void *pArg, const unsigned char *src_data[4], const int src_lin
 
 #if defined(XCODE_FILTER_ROTATE) && (XCODE_FILTER_ROTATE > 0)
 
+//
+// Rotation is done in 16 x 16 tiles so that both the source and destination are 
+// accessed a cache line at a time.  Bands are runs of destination tile rows.
+//
+#define ROTATE_TILE    16
+
 typedef struct ROTATE_CTX {
   int            degrees;
+  FILTER_POOL_T *pPool;
+
+  //
+  // dst[c * dst_stride + r] = src[r * src_stride + c] for a 16 x 16 tile
+  //
+  void         (*transpose)(uint8_t *, int, const uint8_t *, int);
+
+  //
+  // dst[x] = src[len - x - 1]
+  //
+  void         (*reverse)(uint8_t *, const uint8_t *, unsigned int);
 } ROTATE_CTX_T;
 
+typedef struct ROTATE_JOB {
+  const ROTATE_CTX_T   *pCtx;
+  const unsigned char **src_data;
+  unsigned char       **dst_data;
+  unsigned int          width;
+  unsigned int          height;
+} ROTATE_JOB_T;
+
+static void rotate_transpose_c(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride) {
+  int r, c;
+
+  for(c = 0; c < ROTATE_TILE; c++) {
+    for(r = 0; r < ROTATE_TILE; r++) {
+      dst[c * dst_stride + r] = src[r * src_stride + c];
+    }
+  }
+}
+
+static void rotate_reverse_c(uint8_t *dst, const uint8_t *src, unsigned int len) {
+  unsigned int x;
+
+  for(x = 0; x < len; x++) {
+    dst[x] = src[len - x - 1];
+  }
+}
+
+#if defined(FILTER_X86)
+
+__attribute__((target("sse2")))
+static void rotate_transpose_sse2(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride) {
+  __m128i a[16], b[16];
+  int idx, j, h;
+
+  for(idx = 0; idx < 16; idx++) {
+    a[idx] = _mm_loadu_si128((const __m128i *) (src + idx * src_stride));
+  }
+
+  //
+  // Interleave bytes, words, dwords and qwords of successive row groups 
+  //
+  for(idx = 0; idx < 8; idx++) {
+    b[2 * idx] = _mm_unpacklo_epi8(a[2 * idx], a[2 * idx + 1]);
+    b[2 * idx + 1] = _mm_unpackhi_epi8(a[2 * idx], a[2 * idx + 1]);
+  }
+  for(j = 0; j < 4; j++) {
+    for(h = 0; h < 2; h++) {
+      a[4 * j + 2 * h] = _mm_unpacklo_epi16(b[4 * j + h], b[4 * j + 2 + h]);
+      a[4 * j + 2 * h + 1] = _mm_unpackhi_epi16(b[4 * j + h], b[4 * j + 2 + h]);
+    }
+  }
+  for(j = 0; j < 2; j++) {
+    for(h = 0; h < 4; h++) {
+      b[8 * j + 2 * h] = _mm_unpacklo_epi32(a[8 * j + h], a[8 * j + 4 + h]);
+      b[8 * j + 2 * h + 1] = _mm_unpackhi_epi32(a[8 * j + h], a[8 * j + 4 + h]);
+    }
+  }
+  for(idx = 0; idx < 8; idx++) {
+    _mm_storeu_si128((__m128i *) (dst + (2 * idx) * dst_stride), _mm_unpacklo_epi64(b[idx], b[8 + idx]));
+    _mm_storeu_si128((__m128i *) (dst + (2 * idx + 1) * dst_stride), _mm_unpackhi_epi64(b[idx], b[8 + idx]));
+  }
+}
+
+__attribute__((target("sse2")))
+static void rotate_reverse_sse2(uint8_t *dst, const uint8_t *src, unsigned int len) {
+  __m128i v;
+  unsigned int x;
+
+  for(x = 0; x + 16 <= len; x += 16) {
+    v = _mm_loadu_si128((const __m128i *) &src[len - x - 16]);
+    v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    _mm_storeu_si128((__m128i *) &dst[x], v);
+  }
+
+  for(; x < len; x++) {
+    dst[x] = src[len - x - 1];
+  }
+}
+
+#endif // FILTER_X86
+
+static void filter_rotate_set_kernels(ROTATE_CTX_T *pCtx, int simd) {
+
+  pCtx->transpose = rotate_transpose_c;
+  pCtx->reverse = rotate_reverse_c;
+
+#if defined(FILTER_X86)
+  if(simd) {
+    pCtx->transpose = rotate_transpose_sse2;
+    pCtx->reverse = rotate_reverse_sse2;
+  }
+#endif // FILTER_X86
+
+}
 
 void *filter_rotate_init(int width, void *pArg) {
   IXCODE_FILTER_ROTATE_T *pCfg = (IXCODE_FILTER_ROTATE_T *) pArg;
@@ -748,121 +1575,124 @@ void *filter_rotate_init(int width, void *pArg) {
 
 
   pCtx->degrees= pCfg->degrees;
+  pCtx->pPool = filter_pool_create(pCfg->common.threads);
+  filter_rotate_set_kernels(pCtx, filter_have_simd());
 
-  LOG(X_DEBUG("Filter rotate degrees:%d"), pCtx->degrees);
+  LOG(X_DEBUG("Filter rotate degrees:%d, threads:%d"), pCtx->degrees, filter_pool_threads(pCtx->pPool));
 
   return pCtx;
 }
 void filter_rotate_free(void *pArg) {
   ROTATE_CTX_T *pCtx = (ROTATE_CTX_T *) pArg;
 
+  filter_pool_destroy(pCtx->pPool);
   free(pCtx);
 
 }
 
-static int filter_rotate_90(ROTATE_CTX_T *pCtx, const unsigned char *src_data[4], const int src_linesize[4],
-                 unsigned char *dst_data[4], const int dst_linesize[4],
-                 unsigned int width, unsigned int height) {
-
-  unsigned int x, y;
+//
+// Output rows [y0, y1) of dst[y * width + x] = src[height * (width - x - 1) + y]
+//
+static void filter_rotate_90_plane(const ROTATE_CTX_T *pCtx, unsigned char *dst, const unsigned char *src,
+                                   unsigned int width, unsigned int height, 
+                                   unsigned int y0, unsigned int y1) {
+  unsigned int x, y, ty, tx;
   unsigned int ybase;
-  unsigned int heightuv = height/2;
-  unsigned int widthuv = width/2;
 
-  for(y = 0; y < height; y++) {
-    ybase = y * width;
-    for(x = 0; x < width; x++) {
-      dst_data[0][ybase + x] = src_data[0][(height * (width - x - 1)) + y];
-    }
-  }
+  for(y = y0; y < y1; y += ROTATE_TILE) {
+    for(x = 0; x < width; x += ROTATE_TILE) {
 
-  for(y = 0; y < heightuv; y++) {
-    ybase = y * widthuv;
-    for(x = 0; x < widthuv; x++) {
-      dst_data[1][ybase + x] = src_data[1][(heightuv * (widthuv - x - 1)) + y];
-    }
-  }
+      if(y + ROTATE_TILE <= y1 && x + ROTATE_TILE <= width) {
+        pCtx->transpose(&dst[y * width + x], width, &src[height * (width - x - 1) + y], -((int) height));
+        continue;
+      }
 
-  for(y = 0; y < heightuv; y++) {
-    ybase = y * widthuv;
-    for(x = 0; x < widthuv; x++) {
-      dst_data[2][ybase + x] = src_data[2][(heightuv * (widthuv - x - 1)) + y];
+      for(ty = y; ty < MIN(y + ROTATE_TILE, y1); ty++) {
+        ybase = ty * width;
+        for(tx = x; tx < MIN(x + ROTATE_TILE, width); tx++) {
+          dst[ybase + tx] = src[(height * (width - tx - 1)) + ty];
+        }
+      }
     }
   }
 
-  return 0;
 }
 
-static int filter_rotate_270(ROTATE_CTX_T *pCtx, const unsigned char *src_data[4], const int src_linesize[4],
-                 unsigned char *dst_data[4], const int dst_linesize[4],
-                 unsigned int width, unsigned int height) {
-
-  unsigned int x, y;
+//
+// Output rows [y0, y1) of dst[y * width + x] = src[(x * height) + height - y - 1]
+//
+static void filter_rotate_270_plane(const ROTATE_CTX_T *pCtx, unsigned char *dst, const unsigned char *src,
+                                    unsigned int width, unsigned int height, 
+                                    unsigned int y0, unsigned int y1) {
+  unsigned int x, y, ty, tx;
   unsigned int ybase, yoffset;
-  unsigned int heightuv = height/2;
-  unsigned int widthuv = width/2;
 
-  for(y = 0; y < height; y++) {
-    ybase = y * width;
-    yoffset = height - y - 1;
-    for(x = 0; x < width; x++) {
-      dst_data[0][ybase + x] = src_data[0][(x * height) + yoffset];
-    }
-  }
+  for(y = y0; y < y1; y += ROTATE_TILE) {
+    for(x = 0; x < width; x += ROTATE_TILE) {
 
-  for(y = 0; y < heightuv; y++) {
-    ybase = y * widthuv;
-    yoffset = heightuv - y - 1;
-    for(x = 0; x < widthuv; x++) {
-      dst_data[1][ybase + x] = src_data[1][(x * heightuv) + yoffset];
-    }
-  }
+      if(y + ROTATE_TILE <= y1 && x + ROTATE_TILE <= width) {
+        pCtx->transpose(&dst[(y + ROTATE_TILE - 1) * width + x], -((int) width), 
+                        &src[(x * height) + height - y - ROTATE_TILE], height);
+        continue;
+      }
 
-  for(y = 0; y < heightuv; y++) {
-    ybase = y * widthuv;
-    yoffset = heightuv - y - 1;
-    for(x = 0; x < widthuv; x++) {
-      dst_data[2][ybase + x] = src_data[2][(x * heightuv) + yoffset];
+      for(ty = y; ty < MIN(y + ROTATE_TILE, y1); ty++) {
+        ybase = ty * width;
+        yoffset = height - ty - 1;
+        for(tx = x; tx < MIN(x + ROTATE_TILE, width); tx++) {
+          dst[ybase + tx] = src[(tx * height) + yoffset];
+        }
+      }
     }
   }
 
-  return 0;
 }
 
-static int filter_rotate_180(ROTATE_CTX_T *pCtx, const unsigned char *src_data[4], const int src_linesize[4],
-                 unsigned char *dst_data[4], const int dst_linesize[4],
-                 unsigned int width, unsigned int height) {
-
-  unsigned int x, y;
-  unsigned int ybase, yoffset;
-  unsigned int heightuv = height/2;
-  unsigned int widthuv = width/2;
+//
+// Output rows [y0, y1) of dst[y * width + x] = src[width * (height - y - 1) + (width - x - 1)]
+//
+static void filter_rotate_180_plane(const ROTATE_CTX_T *pCtx, unsigned char *dst, const unsigned char *src,
+                                    unsigned int width, unsigned int height, 
+                                    unsigned int y0, unsigned int y1) {
+  unsigned int y;
 
-  for(y = 0; y < height; y++) {
-    ybase = y * width;
-    yoffset = width * (height - y - 1);
-    for(x = 0; x < width; x++) {
-      dst_data[0][ybase + x] = src_data[0][yoffset + (width - x - 1)];
-    }
+  for(y = y0; y < y1; y++) {
+    pCtx->reverse(&dst[y * width], &src[width * (height - y - 1)], width);
   }
 
-  for(y = 0; y < heightuv; y++) {
-    ybase = y * widthuv;
-    yoffset = widthuv * (heightuv - y - 1);
-    for(x = 0; x < widthuv; x++) {
-      dst_data[1][ybase + x] = src_data[1][yoffset + (widthuv - x - 1)];
-    }
-  }
+}
 
-  for(y = 0; y < heightuv; y++) {
-    ybase = y * widthuv;
-    yoffset = widthuv * (heightuv - y - 1);
-    for(x = 0; x < widthuv; x++) {
-      dst_data[2][ybase + x] = src_data[2][yoffset + (widthuv - x - 1)];
+static void filter_rotate_slice(void *pArg, unsigned int slice, unsigned int numSlices) {
+  const ROTATE_JOB_T *pJob = (const ROTATE_JOB_T *) pArg;
+  const ROTATE_CTX_T *pCtx = pJob->pCtx;
+  unsigned int plane, width, height, tiles, y0, y1;
+
+  for(plane = 0; plane < 3; plane++) {
+
+    width = plane ? pJob->width / 2 : pJob->width;
+    height = plane ? pJob->height / 2 : pJob->height;
+    tiles = (height + ROTATE_TILE - 1) / ROTATE_TILE;
+    y0 = MIN(height, (tiles * slice / numSlices) * ROTATE_TILE);
+    y1 = MIN(height, (tiles * (slice + 1) / numSlices) * ROTATE_TILE);
+
+    switch(pCtx->degrees) {
+      case 90:
+      case -270:
+        filter_rotate_90_plane(pCtx, pJob->dst_data[plane], pJob->src_data[plane], width, height, y0, y1);
+        break;
+      case -90:
+      case 270:
+        filter_rotate_270_plane(pCtx, pJob->dst_data[plane], pJob->src_data[plane], width, height, y0, y1);
+        break;
+      case 180:
+      case -180:
+        filter_rotate_180_plane(pCtx, pJob->dst_data[plane], pJob->src_data[plane], width, height, y0, y1);
+        break;
+      default:
+        break;
     }
   }
 
-  return 0;
 }
 
 int filter_rotate(void *pArg, const unsigned char *src_data[4], const int src_linesize[4],
@@ -870,22 +1700,32 @@ int filter_rotate(void *pArg, const unsigned char *src_data[4], const int src_li
                  unsigned int width, unsigned int height) {
 
   ROTATE_CTX_T *pCtx = (ROTATE_CTX_T *) pArg;
+  ROTATE_JOB_T job;
 
   //fprintf(stderr, "FILTER ROTATE deg:%d src_ls:%d,%d, dst_ls:%d,%d, w:%d, h:%d, diff:%d,%d\n", pCtx->degrees, src_linesize[0], src_linesize[1], dst_linesize[0], dst_linesize[1], width, height, dst_data[1] - dst_data[0], dst_data[2] - dst_data[1]);
 
   switch(pCtx->degrees) {
     case 90:
     case -270:
-      return filter_rotate_90(pCtx, src_data, src_linesize, dst_data, dst_linesize, width, height);
     case -90:
     case 270:
-      return filter_rotate_270(pCtx, src_data, src_linesize, dst_data, dst_linesize, width, height);
     case 180:
     case -180:
-      return filter_rotate_180(pCtx, src_data, src_linesize, dst_data, dst_linesize, width, height);
+      break;
     default:
       return -1;
   }
+
+  job.pCtx = pCtx;
+  job.src_data = src_data;
+  job.dst_data = dst_data;
+  job.width = width;
+  job.height = height;
+
+  filter_pool_run(pCtx->pPool, filter_rotate_slice, &job, 
+                  filter_slices(pCtx->pPool, height / 2, 2 * ROTATE_TILE));
+
+  return 0;
 }
 
 #endif // (XCODE_FILTER_ROTATE) && (XCODE_FILTER_ROTATE > 0)
@@ -934,3 +1774,205 @@ int filter_test(void *pArg, const unsigned char *src_data[4], const int src_line
 }
 
 #endif // (XCODE_FILTER_TEST) && (XCODE_FILTER_TEST > 0)
+
+#if (XCODE_FILTER_ON)
+
+#define FILTER_BENCH_WIDTH      1920
+#define FILTER_BENCH_HEIGHT     1080
+
+typedef struct FILTER_BENCH_FRAME {
+  unsigned char               *data[4];
+  int                          linesize[4];
+} FILTER_BENCH_FRAME_T;
+
+typedef struct FILTER_BENCH_DESCR {
+  const char                  *name;
+  FUNC_FILTER_FREE             fFree;
+  FUNC_FILTER_EXEC             fExec;
+  int                          haveSimd;
+} FILTER_BENCH_DESCR_T;
+
+static void *filter_bench_init(const char *name, int threads, int simd) {
+  void *pCtx = NULL;
+
+#if defined(XCODE_FILTER_UNSHARP) && (XCODE_FILTER_UNSHARP > 0)
+  if(!strcmp(name, "unsharp")) {
+    IXCODE_FILTER_UNSHARP_T cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.common.threads = threads;
+    cfg.luma.sizeX = cfg.luma.sizeY = 5;
+    cfg.luma.strength = 1.0f;
+    cfg.chroma.sizeX = cfg.chroma.sizeY = 3;
+    cfg.chroma.strength = 0.5f;
+    if((pCtx = filter_unsharp_init(FILTER_BENCH_WIDTH, &cfg))) {
+      unsharp_set_kernels((UnsharpContext *) pCtx, simd);
+    }
+  }
+#endif // (XCODE_FILTER_UNSHARP) && (XCODE_FILTER_UNSHARP > 0)
+
+#if defined(XCODE_FILTER_DENOISE) && (XCODE_FILTER_DENOISE > 0)
+  if(!strcmp(name, "denoise")) {
+    IXCODE_FILTER_DENOISE_T cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.common.threads = threads;
+    pCtx = filter_denoise_init(FILTER_BENCH_WIDTH, &cfg);
+  }
+#endif // (XCODE_FILTER_DENOISE) && (XCODE_FILTER_DENOISE > 0)
+
+#if defined(XCODE_FILTER_COLOR) && (XCODE_FILTER_COLOR > 0)
+  if(!strcmp(name, "color")) {
+    IXCODE_FILTER_COLOR_T cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.common.threads = threads;
+    cfg.fContrast = 1.2f;
+    cfg.fBrightness = 1.1f;
+    cfg.fHue = 30.0f;
+    cfg.fSaturation = 1.5f;
+    cfg.fGamma = 1.2f;
+    if((pCtx = filter_color_init(FILTER_BENCH_WIDTH, &cfg))) {
+      filter_color_set_kernels((COLOR_CTX_T *) pCtx, simd);
+    }
+  }
+#endif // (XCODE_FILTER_COLOR) && (XCODE_FILTER_COLOR > 0)
+
+#if defined(XCODE_FILTER_ROTATE) && (XCODE_FILTER_ROTATE > 0)
+  if(!strncmp(name, "rotate", 6)) {
+    IXCODE_FILTER_ROTATE_T cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.common.threads = threads;
+    cfg.degrees = atoi(&name[6]);
+    if((pCtx = filter_rotate_init(FILTER_BENCH_WIDTH, &cfg))) {
+      filter_rotate_set_kernels((ROTATE_CTX_T *) pCtx, simd);
+    }
+  }
+#endif // (XCODE_FILTER_ROTATE) && (XCODE_FILTER_ROTATE > 0)
+
+  return pCtx;
+}
+
+static double filter_bench_run(const FILTER_BENCH_DESCR_T *pDescr, int threads, int simd, 
+                               unsigned int frames, FILTER_BENCH_FRAME_T in[2], FILTER_BENCH_FRAME_T *pOut) {
+  struct timeval tv0, tv1;
+  unsigned int idx;
+  void *pCtx;
+
+  if(!(pCtx = filter_bench_init(pDescr->name, threads, simd))) {
+    return -1;
+  }
+
+  gettimeofday(&tv0, NULL);
+
+  for(idx = 0; idx < frames; idx++) {
+    pDescr->fExec(pCtx, (const unsigned char **) in[idx & 1].data, in[idx & 1].linesize, 
+                  pOut->data, pOut->linesize, FILTER_BENCH_WIDTH, FILTER_BENCH_HEIGHT);
+  }
+
+  gettimeofday(&tv1, NULL);
+
+  pDescr->fFree(pCtx);
+
+  return ((tv1.tv_sec - tv0.tv_sec) * 1000.0) + ((tv1.tv_usec - tv0.tv_usec) / 1000.0);
+}
+
+static void filter_bench_frame(FILTER_BENCH_FRAME_T *pFrame, unsigned char *pbuf) {
+  const int w = FILTER_BENCH_WIDTH, h = FILTER_BENCH_HEIGHT;
+
+  pFrame->data[0] = pbuf;
+  pFrame->data[1] = pbuf + w * h;
+  pFrame->data[2] = pbuf + w * h + (w / 2) * (h / 2);
+  pFrame->data[3] = NULL;
+  pFrame->linesize[0] = w;
+  pFrame->linesize[1] = pFrame->linesize[2] = w / 2;
+  pFrame->linesize[3] = 0;
+}
+
+int filter_benchmark(unsigned int threads, unsigned int frames) {
+  const FILTER_BENCH_DESCR_T arrDescr[] = {
+#if defined(XCODE_FILTER_UNSHARP) && (XCODE_FILTER_UNSHARP > 0)
+    { "unsharp", filter_unsharp_free, filter_unsharp, 1 },
+#endif // (XCODE_FILTER_UNSHARP) && (XCODE_FILTER_UNSHARP > 0)
+#if defined(XCODE_FILTER_DENOISE) && (XCODE_FILTER_DENOISE > 0)
+    { "denoise", filter_denoise_free, filter_denoise, 0 },
+#endif // (XCODE_FILTER_DENOISE) && (XCODE_FILTER_DENOISE > 0)
+#if defined(XCODE_FILTER_COLOR) && (XCODE_FILTER_COLOR > 0)
+    { "color", filter_color_free, filter_color, 1 },
+#endif // (XCODE_FILTER_COLOR) && (XCODE_FILTER_COLOR > 0)
+
+#if defined(XCODE_FILTER_ROTATE) && (XCODE_FILTER_ROTATE > 0)
+    { "rotate90", filter_rotate_free, filter_rotate, 1 },
+    { "rotate180", filter_rotate_free, filter_rotate, 1 },
+    { "rotate270", filter_rotate_free, filter_rotate, 1 },
+#endif // (XCODE_FILTER_ROTATE) && (XCODE_FILTER_ROTATE > 0)
+    { NULL, NULL, NULL, 0 }
+  };
+  const unsigned int framesz = FILTER_BENCH_WIDTH * FILTER_BENCH_HEIGHT * 3 / 2;
+  const int simd = filter_have_simd();
+  FILTER_BENCH_FRAME_T in[2], out[2];
+  unsigned char *pbufs;
+  unsigned int idx, i, lcg = 1;
+  double ms_c, ms_simd, ms_threads;
+  int exact;
+  int rc = 0;
+
+  if(threads <= 1) {
+    threads = 4;
+  }
+  if(frames == 0) {
+    frames = 1;
+  }
+
+  if(!(pbufs = (unsigned char *) malloc(4 * framesz))) {
+    return -1;
+  }
+
+  for(idx = 0; idx < 2; idx++) {
+    filter_bench_frame(&in[idx], pbufs + idx * framesz);
+    filter_bench_frame(&out[idx], pbufs + (2 + idx) * framesz);
+    for(i = 0; i < framesz; i++) {
+      lcg = lcg * 1103515245 + 12345;
+      in[idx].data[0][i] = (unsigned char) (((i % FILTER_BENCH_WIDTH) >> 3) + ((lcg >> 16) & 0x1f) + idx * 8);
+    }
+  }
+
+  fprintf(stdout, "Filter benchmark: %dx%d, %u frames, %u threads (%s)\n", 
+          FILTER_BENCH_WIDTH, FILTER_BENCH_HEIGHT, frames, threads, simd ? "sse2" : "no simd");
+
+  for(idx = 0; arrDescr[idx].name; idx++) {
+
+    //
+    // The reference output is the scalar filter on a single thread 
+    //
+    ms_c = filter_bench_run(&arrDescr[idx], 1, 0, frames, in, &out[0]);
+    ms_simd = -1;
+    if(simd && arrDescr[idx].haveSimd) {
+      memset(out[1].data[0], 0, framesz);
+      ms_simd = filter_bench_run(&arrDescr[idx], 1, 1, frames, in, &out[1]);
+    }
+    exact = (ms_simd < 0 || !memcmp(out[0].data[0], out[1].data[0], framesz));
+
+    memset(out[1].data[0], 0, framesz);
+    ms_threads = filter_bench_run(&arrDescr[idx], threads, simd, frames, in, &out[1]);
+    if(memcmp(out[0].data[0], out[1].data[0], framesz)) {
+      exact = 0;
+    }
+
+    if(ms_c < 0 || ms_threads < 0 || !exact) {
+      rc = -1;
+    }
+
+    fprintf(stdout, "  %-10s c: %7.3f ms/frame", arrDescr[idx].name, ms_c / frames);
+    if(ms_simd >= 0) {
+      fprintf(stdout, "  simd: %7.3f ms/frame (%.2fx)", ms_simd / frames, ms_simd > 0 ? ms_c / ms_simd : 0);
+    } else {
+      fprintf(stdout, "  simd:     n/a                  ");
+    }
+    fprintf(stdout, "  x%u: %7.3f ms/frame (%.2fx)  bit-exact: %s\n", threads, ms_threads / frames,
+            ms_threads > 0 ? ms_c / ms_threads : 0, exact ? "yes" : "no");
+  }
+
+  free(pbufs);
+
+  return rc;
+}
+
+#endif // XCODE_FILTER_ON
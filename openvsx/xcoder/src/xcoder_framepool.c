@@ -0,0 +1,376 @@
+/** <!--
+ *
+ *  Copyright (C) 2014 OpenVCX openvcx@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  If you would like this software to be made available to you under an 
+ *  alternate license please email openvcx@gmail.com for more information.
+ *
+ * -->
+ */
+
+
+
+#ifdef WIN32
+
+#include <windows.h>
+#include "unixcompat.h"
+
+#else // WIN32
+
+#include <unistd.h>
+
+#endif // WIN32
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "logutil.h"
+#include "xcoder_framepool.h"
+
+#define FRAMEPOOL_MAGIC         0x46504f4c
+#define FRAMEPOOL_PADDING       64
+
+typedef struct FRAMEPOOL_HDR {
+  struct FRAMEPOOL_HDR      *pnext;
+  void                      *pmem;
+  unsigned int               size;
+  int                        keyIdx;
+  volatile int               refcnt;
+  uint32_t                   magic;
+} FRAMEPOOL_HDR_T;
+
+#define FRAMEPOOL_HDR_SZ        ((sizeof(FRAMEPOOL_HDR_T) + FRAMEPOOL_ALIGN - 1) & ~(FRAMEPOOL_ALIGN - 1))
+#define FRAMEPOOL_HDR(p)        ((FRAMEPOOL_HDR_T *) ((p) - FRAMEPOOL_HDR_SZ))
+
+typedef struct FRAMEPOOL_KEY {
+  int                        active;
+  int                        width;
+  int                        height;
+  enum PixelFormat           pix_fmt;
+  unsigned int               size;
+  FRAMEPOOL_HDR_T           *pIdle;
+  unsigned int               numIdle;
+  unsigned int               numInUse;
+  uint64_t                   lastUse;
+} FRAMEPOOL_KEY_T;
+
+typedef struct FRAMEPOOL {
+  pthread_mutex_t            mtx;
+  FRAMEPOOL_KEY_T            keys[FRAMEPOOL_KEYS_MAX];
+  uint64_t                   useCnt;
+  unsigned int               numUncached;
+  FRAMEPOOL_STATS_T          stats;
+} FRAMEPOOL_T;
+
+static FRAMEPOOL_T g_framepool = { PTHREAD_MUTEX_INITIALIZER };
+
+//
+// Called with the pool mutex held.  Returns the idle buffer list of the key to the 
+// caller, which should free it outside of the lock.
+//
+static FRAMEPOOL_HDR_T *framepool_key_reset(FRAMEPOOL_T *pPool, FRAMEPOOL_KEY_T *pKey) {
+  FRAMEPOOL_HDR_T *pIdle = pKey->pIdle;
+
+  pPool->stats.numIdle -= pKey->numIdle;
+  pPool->stats.bytesIdle -= (uint64_t) pKey->numIdle * pKey->size;
+  pKey->pIdle = NULL;
+  pKey->numIdle = 0;
+
+  return pIdle;
+}
+
+static void framepool_free_list(FRAMEPOOL_HDR_T *pHdr) {
+  FRAMEPOOL_HDR_T *pnext;
+
+  while(pHdr) {
+    pnext = pHdr->pnext;
+    pHdr->magic = 0;
+    av_free(pHdr->pmem);
+    pHdr = pnext;
+  }
+}
+
+//
+// Called with the pool mutex held.  Finds the key for the picture dimensions, claiming
+// an unused slot, or the least recently used slot without any buffers in use, for a new key.
+//
+static int framepool_key_get(FRAMEPOOL_T *pPool, enum PixelFormat pix_fmt, int width, int height, 
+                             unsigned int size, FRAMEPOOL_HDR_T **ppEvicted) {
+  FRAMEPOOL_KEY_T *pKey;
+  int idx;
+  int idxFree = -1;
+  int idxLru = -1;
+
+  for(idx = 0; idx < FRAMEPOOL_KEYS_MAX; idx++) {
+    pKey = &pPool->keys[idx];
+    if(!pKey->active) {
+      if(idxFree < 0) {
+        idxFree = idx;
+      }
+    } else if(pKey->width == width && pKey->height == height && pKey->pix_fmt == pix_fmt) {
+      return idx;
+    } else if(pKey->numInUse == 0 && (idxLru < 0 || pKey->lastUse < pPool->keys[idxLru].lastUse)) {
+      idxLru = idx;
+    }
+  }
+
+  if(idxFree < 0) {
+    if((idxFree = idxLru) < 0) {
+      return -1;
+    }
+    *ppEvicted = framepool_key_reset(pPool, &pPool->keys[idxFree]);
+  } else {
+    pPool->stats.numKeys++;
+  }
+
+  pKey = &pPool->keys[idxFree];
+  pKey->active = 1;
+  pKey->width = width;
+  pKey->height = height;
+  pKey->pix_fmt = pix_fmt;
+  pKey->size = size;
+  pKey->numInUse = 0;
+
+  return idxFree;
+}
+
+unsigned char *framepool_get(enum PixelFormat pix_fmt, int width, int height) {
+  FRAMEPOOL_T *pPool = &g_framepool;
+  FRAMEPOOL_KEY_T *pKey = NULL;
+  FRAMEPOOL_HDR_T *pHdr = NULL;
+  FRAMEPOOL_HDR_T *pEvicted = NULL;
+  unsigned char *pmem;
+  unsigned char *pdata;
+  int keyIdx;
+  int sz;
+
+  if((sz = avpicture_get_size(pix_fmt, width, height)) <= 0) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&pPool->mtx);
+
+  if((keyIdx = framepool_key_get(pPool, pix_fmt, width, height, sz, &pEvicted)) >= 0) {
+    pKey = &pPool->keys[keyIdx];
+    pKey->lastUse = ++pPool->useCnt;
+    pKey->numInUse++;
+    if((pHdr = pKey->pIdle)) {
+      pKey->pIdle = pHdr->pnext;
+      pKey->numIdle--;
+      pPool->stats.numIdle--;
+      pPool->stats.bytesIdle -= sz;
+    }
+  } else {
+    pPool->numUncached++;
+  }
+
+  if(pHdr) {
+    pPool->stats.hits++;
+  } else {
+    pPool->stats.misses++;
+  }
+  pPool->stats.numInUse++;
+  pPool->stats.bytesInUse += sz;
+  if(pPool->stats.bytesInUse + pPool->stats.bytesIdle > pPool->stats.bytesResidentPeak) {
+    pPool->stats.bytesResidentPeak = pPool->stats.bytesInUse + pPool->stats.bytesIdle;
+  }
+
+  pthread_mutex_unlock(&pPool->mtx);
+
+  framepool_free_list(pEvicted);
+
+  if(pHdr) {
+    pHdr->pnext = NULL;
+    pHdr->refcnt = 1;
+    return ((unsigned char *) pHdr) + FRAMEPOOL_HDR_SZ;
+  }
+
+  //
+  // Allocate a new buffer aligned to FRAMEPOOL_ALIGN, and touch every page now rather 
+  // than taking the page faults in the middle of the frame processing path
+  //
+  if((pmem = av_malloc(FRAMEPOOL_HDR_SZ + sz + FRAMEPOOL_PADDING + FRAMEPOOL_ALIGN))) {
+    pdata = (unsigned char *) (((uintptr_t) pmem + FRAMEPOOL_HDR_SZ + FRAMEPOOL_ALIGN - 1) & 
+                               ~((uintptr_t) FRAMEPOOL_ALIGN - 1));
+    memset(pdata, 0, sz + FRAMEPOOL_PADDING);
+    pHdr = FRAMEPOOL_HDR(pdata);
+    pHdr->pnext = NULL;
+    pHdr->pmem = pmem;
+    pHdr->size = sz;
+    pHdr->keyIdx = keyIdx;
+    pHdr->refcnt = 1;
+    pHdr->magic = FRAMEPOOL_MAGIC;
+    return pdata;
+  }
+
+  LOG(X_ERROR("Failed to allocate %d bytes for %dx%d picture (pix_fmt:%d)"), sz, width, height, pix_fmt);
+
+  pthread_mutex_lock(&pPool->mtx);
+  if(pKey) {
+    pKey->numInUse--;
+  } else {
+    pPool->numUncached--;
+  }
+  pPool->stats.numInUse--;
+  pPool->stats.bytesInUse -= sz;
+  pthread_mutex_unlock(&pPool->mtx);
+
+  return NULL;
+}
+
+void framepool_ref(unsigned char *pdata) {
+  FRAMEPOOL_HDR_T *pHdr;
+
+  if(pdata) {
+    pHdr = FRAMEPOOL_HDR(pdata);
+    __sync_add_and_fetch(&pHdr->refcnt, 1);
+  }
+}
+
+void framepool_unref(unsigned char *pdata) {
+  FRAMEPOOL_T *pPool = &g_framepool;
+  FRAMEPOOL_KEY_T *pKey = NULL;
+  FRAMEPOOL_HDR_T *pHdr;
+  void *pfree = NULL;
+
+  if(!pdata) {
+    return;
+  }
+
+  pHdr = FRAMEPOOL_HDR(pdata);
+
+  if(pHdr->magic != FRAMEPOOL_MAGIC) {
+    LOG(X_ERROR("Frame pool buffer 0x%x is not valid"), pdata);
+    return;
+  }
+
+  if(__sync_sub_and_fetch(&pHdr->refcnt, 1) > 0) {
+    return;
+  }
+
+  pthread_mutex_lock(&pPool->mtx);
+
+  pPool->stats.numInUse--;
+  pPool->stats.bytesInUse -= pHdr->size;
+
+  if(pHdr->keyIdx >= 0) {
+    pKey = &pPool->keys[pHdr->keyIdx];
+    pKey->numInUse--;
+  } else {
+    pPool->numUncached--;
+  }
+
+  if(pKey && pKey->numIdle < FRAMEPOOL_IDLE_PER_KEY &&
+     pPool->stats.bytesIdle + pHdr->size <= FRAMEPOOL_IDLE_BYTES_MAX) {
+    pHdr->pnext = pKey->pIdle;
+    pKey->pIdle = pHdr;
+    pKey->numIdle++;
+    pPool->stats.numIdle++;
+    pPool->stats.bytesIdle += pHdr->size;
+  } else {
+    pfree = pHdr->pmem;
+    pHdr->magic = 0;
+  }
+
+  pthread_mutex_unlock(&pPool->mtx);
+
+  if(pfree) {
+    av_free(pfree);
+  }
+
+}
+
+int framepool_picture_alloc(AVPicture *picture, enum PixelFormat pix_fmt, int width, int height) {
+  unsigned char *pdata;
+
+  if(!(pdata = framepool_get(pix_fmt, width, height))) {
+    memset(picture, 0, sizeof(AVPicture));
+    return -1;
+  }
+
+  if(avpicture_fill(picture, pdata, pix_fmt, width, height) < 0) {
+    framepool_unref(pdata);
+    memset(picture, 0, sizeof(AVPicture));
+    return -1;
+  }
+
+  return 0;
+}
+
+void framepool_picture_free(AVPicture *picture) {
+
+  framepool_unref(picture->data[0]);
+  memset(picture->data, 0, sizeof(picture->data));
+
+}
+
+//
+// Releases the idle buffers of any key which does not have buffers in use
+//
+void framepool_trim(void) {
+  FRAMEPOOL_T *pPool = &g_framepool;
+  FRAMEPOOL_HDR_T *pFree[FRAMEPOOL_KEYS_MAX];
+  FRAMEPOOL_KEY_T *pKey;
+  unsigned int idx;
+
+  pthread_mutex_lock(&pPool->mtx);
+
+  for(idx = 0; idx < FRAMEPOOL_KEYS_MAX; idx++) {
+    pKey = &pPool->keys[idx];
+    pFree[idx] = NULL;
+    if(pKey->active && pKey->numInUse == 0) {
+      pFree[idx] = framepool_key_reset(pPool, pKey);
+      pKey->active = 0;
+      pPool->stats.numKeys--;
+    }
+  }
+
+  pthread_mutex_unlock(&pPool->mtx);
+
+  for(idx = 0; idx < FRAMEPOOL_KEYS_MAX; idx++) {
+    framepool_free_list(pFree[idx]);
+  }
+
+}
+
+void framepool_getstats(FRAMEPOOL_STATS_T *pStats) {
+  FRAMEPOOL_T *pPool = &g_framepool;
+
+  pthread_mutex_lock(&pPool->mtx);
+  memcpy(pStats, &pPool->stats, sizeof(FRAMEPOOL_STATS_T));
+  pthread_mutex_unlock(&pPool->mtx);
+}
+
+void framepool_logstats(void) {
+  FRAMEPOOL_STATS_T stats;
+  uint64_t total;
+
+  framepool_getstats(&stats);
+
+  if((total = stats.hits + stats.misses) == 0) {
+    return;
+  }
+
+  LOG(X_DEBUG("Frame pool hits:%llu, misses:%llu (%.1f%% hit), keys:%u, in use:%u (%llu KB), "
+              "idle:%u (%llu KB), peak resident:%llu KB"),
+              (unsigned long long) stats.hits, (unsigned long long) stats.misses, 
+              (double) stats.hits * 100 / total, stats.numKeys,
+              stats.numInUse, (unsigned long long) stats.bytesInUse / 1024, 
+              stats.numIdle, (unsigned long long) stats.bytesIdle / 1024,
+              (unsigned long long) stats.bytesResidentPeak / 1024);
+}
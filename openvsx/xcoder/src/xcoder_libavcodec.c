@@ -1706,6 +1706,25 @@ int xcoder_libavcodec_video_decode(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx
   return lenRaw;
 }
 
+int xcoder_libavcodec_video_speed(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx, int level) {
+  FFMPEG_AVCODEC_CTXT_T *pFFCtx = NULL;
+
+  if(!pCtxt || !(pFFCtx = (FFMPEG_AVCODEC_CTXT_T *) pCtxt->pctxt) || !pFFCtx->pavctx) {
+    return -1;
+  }
+
+#if defined(XCODE_HAVE_VP8) && (XCODE_HAVE_VP8 > 0)
+  if(pFFCtx->pavcodec == &libvpxext_encoder) {
+    return vp8ext_set_speed(pFFCtx->pavctx, level) < 0 ? -1 : 0;
+  }
+#endif // (XCODE_HAVE_VP8) && (XCODE_HAVE_VP8 > 0)
+
+  //
+  // No runtime speed control for any other libavcodec encoder
+  //
+  return -1;
+}
+
 int xcoder_libavcodec_video_encode(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx,
                                    const struct AVFrame *rawin, unsigned char *out, unsigned int outlen) {
   IXCODE_VIDEO_CTXT_T *pXcode = NULL;
@@ -30,6 +30,7 @@
 #else // WIN32
 
 #include <unistd.h>
+#include <sys/time.h>
 
 #endif // WIN32
 
@@ -163,7 +164,251 @@ static void blend_pixels_noalpha(unsigned char *dst_data[4],
 
 }
 
-static void blend_pixels(unsigned char *dst_data[4], 
+//
+// Alpha clamping applied to every blended pixel.  When alphamin <= alphamax the
+// clamp reduces to MIN(MAX(alpha, lo), hi), which the vector kernels use.
+//
+typedef struct PIP_ALPHA_CLAMP {
+  int                         max_min1;
+  int                         min_min1;
+  uint8_t                     lo;
+  uint8_t                     hi;
+  int                         minmax;
+} PIP_ALPHA_CLAMP_T;
+
+typedef struct PIP_BLEND_KERNELS {
+  const char                 *name;
+
+  //
+  // d[k] = (d[k] * (255 - alpha[k]) + s[k] * alpha[k] + 128) >> 8
+  //
+  void (*blend_row)(uint8_t *d, const uint8_t *s, const uint8_t *alpha, int n);
+
+  //
+  // alpha[k] = clamp(a[k]), used for the luma plane
+  //
+  void (*alpha_row)(uint8_t *alpha, const uint8_t *a, int n, const PIP_ALPHA_CLAMP_T *pClamp);
+
+  //
+  // alpha[k] = clamp((a0[2k] + a0[2k+1] + a1[2k] + a1[2k+1]) >> 2), used for the
+  // chroma planes on every column which has a right and lower neighbor 
+  //
+  void (*alpha_row_2x2)(uint8_t *alpha, const uint8_t *a0, const uint8_t *a1, int n, 
+                        const PIP_ALPHA_CLAMP_T *pClamp);
+} PIP_BLEND_KERNELS_T;
+
+static inline int alpha_clamp(int alpha, const PIP_ALPHA_CLAMP_T *pClamp) {
+
+  if(pClamp->max_min1 != 0 && alpha >= pClamp->max_min1) {
+    alpha = pClamp->max_min1 - 1;
+  } else if(pClamp->min_min1 != 0 && alpha < pClamp->min_min1) {
+    alpha = pClamp->min_min1 - 1;
+  }
+
+  return alpha;
+}
+
+static void blend_row_c(uint8_t *d, const uint8_t *s, const uint8_t *alpha, int n) {
+  int k;
+
+  for(k = 0; k < n; k++) {
+    d[k] = (d[k] * (0xff - alpha[k]) + s[k] * alpha[k] + 128) >> 8;
+  }
+}
+
+static void alpha_row_c(uint8_t *alpha, const uint8_t *a, int n, const PIP_ALPHA_CLAMP_T *pClamp) {
+  int k;
+
+  for(k = 0; k < n; k++) {
+    alpha[k] = alpha_clamp(a[k], pClamp);
+  }
+}
+
+static void alpha_row_2x2_c(uint8_t *alpha, const uint8_t *a0, const uint8_t *a1, int n,
+                            const PIP_ALPHA_CLAMP_T *pClamp) {
+  int k;
+
+  for(k = 0; k < n; k++) {
+    alpha[k] = alpha_clamp((a0[2*k] + a0[2*k+1] + a1[2*k] + a1[2*k+1]) >> 2, pClamp);
+  }
+}
+
+static const PIP_BLEND_KERNELS_T g_blend_c = { "c", blend_row_c, alpha_row_c, alpha_row_2x2_c };
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#define PIP_BLEND_X86 1
+
+#include <immintrin.h>
+
+//
+// All products fit in 16 bits: 255 * 255 + 128 < 65536, so the vector kernels
+// are bit-exact with the scalar versions.
+//
+
+__attribute__((target("sse2")))
+static void blend_row_sse2(uint8_t *d, const uint8_t *s, const uint8_t *alpha, int n) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i v255 = _mm_set1_epi16(0xff);
+  const __m128i v128 = _mm_set1_epi16(128);
+  __m128i vd, vs, va, lo, hi;
+  int k;
+
+  for(k = 0; k + 16 <= n; k += 16) {
+    vd = _mm_loadu_si128((const __m128i *) &d[k]);
+    vs = _mm_loadu_si128((const __m128i *) &s[k]);
+    va = _mm_loadu_si128((const __m128i *) &alpha[k]);
+
+    lo = _mm_unpacklo_epi8(va, zero);
+    lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(vd, zero), _mm_sub_epi16(v255, lo)),
+                                     _mm_mullo_epi16(_mm_unpacklo_epi8(vs, zero), lo)), v128);
+    hi = _mm_unpackhi_epi8(va, zero);
+    hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(vd, zero), _mm_sub_epi16(v255, hi)),
+                                     _mm_mullo_epi16(_mm_unpackhi_epi8(vs, zero), hi)), v128);
+
+    _mm_storeu_si128((__m128i *) &d[k], _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+  }
+
+  blend_row_c(&d[k], &s[k], &alpha[k], n - k);
+}
+
+__attribute__((target("sse2")))
+static void alpha_row_sse2(uint8_t *alpha, const uint8_t *a, int n, const PIP_ALPHA_CLAMP_T *pClamp) {
+  const __m128i vlo = _mm_set1_epi8((char) pClamp->lo);
+  const __m128i vhi = _mm_set1_epi8((char) pClamp->hi);
+  int k;
+
+  for(k = 0; k + 16 <= n; k += 16) {
+    _mm_storeu_si128((__m128i *) &alpha[k], 
+         _mm_min_epu8(_mm_max_epu8(_mm_loadu_si128((const __m128i *) &a[k]), vlo), vhi));
+  }
+
+  alpha_row_c(&alpha[k], &a[k], n - k, pClamp);
+}
+
+__attribute__((target("sse2")))
+static void alpha_row_2x2_sse2(uint8_t *alpha, const uint8_t *a0, const uint8_t *a1, int n,
+                               const PIP_ALPHA_CLAMP_T *pClamp) {
+  const __m128i vlo = _mm_set1_epi8((char) pClamp->lo);
+  const __m128i vhi = _mm_set1_epi8((char) pClamp->hi);
+  const __m128i mask = _mm_set1_epi16(0xff);
+  __m128i r0, r1, sum0, sum1;
+  int k;
+
+  for(k = 0; k + 16 <= n; k += 16) {
+    r0 = _mm_loadu_si128((const __m128i *) &a0[2*k]);
+    r1 = _mm_loadu_si128((const __m128i *) &a1[2*k]);
+    sum0 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(r0, mask), _mm_srli_epi16(r0, 8)),
+                         _mm_add_epi16(_mm_and_si128(r1, mask), _mm_srli_epi16(r1, 8)));
+    r0 = _mm_loadu_si128((const __m128i *) &a0[2*k + 16]);
+    r1 = _mm_loadu_si128((const __m128i *) &a1[2*k + 16]);
+    sum1 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(r0, mask), _mm_srli_epi16(r0, 8)),
+                         _mm_add_epi16(_mm_and_si128(r1, mask), _mm_srli_epi16(r1, 8)));
+    r0 = _mm_packus_epi16(_mm_srli_epi16(sum0, 2), _mm_srli_epi16(sum1, 2));
+    _mm_storeu_si128((__m128i *) &alpha[k], _mm_min_epu8(_mm_max_epu8(r0, vlo), vhi));
+  }
+
+  alpha_row_2x2_c(&alpha[k], &a0[2*k], &a1[2*k], n - k, pClamp);
+}
+
+static const PIP_BLEND_KERNELS_T g_blend_sse2 = { "sse2", blend_row_sse2, alpha_row_sse2, 
+                                                  alpha_row_2x2_sse2 };
+
+__attribute__((target("avx2")))
+static void blend_row_avx2(uint8_t *d, const uint8_t *s, const uint8_t *alpha, int n) {
+  const __m256i v255 = _mm256_set1_epi16(0xff);
+  const __m256i v128 = _mm256_set1_epi16(128);
+  __m256i vd, vs, va;
+  int k;
+
+  for(k = 0; k + 16 <= n; k += 16) {
+    vd = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) &d[k]));
+    vs = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) &s[k]));
+    va = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) &alpha[k]));
+
+    vd = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(vd, _mm256_sub_epi16(v255, va)),
+                                           _mm256_mullo_epi16(vs, va)), v128);
+    vd = _mm256_srli_epi16(vd, 8);
+
+    //
+    // packus operates per 128-bit lane, so pack the two halves explicitly
+    //
+    _mm_storeu_si128((__m128i *) &d[k], _mm_packus_epi16(_mm256_castsi256_si128(vd), 
+                                                         _mm256_extracti128_si256(vd, 1)));
+  }
+
+  blend_row_c(&d[k], &s[k], &alpha[k], n - k);
+}
+
+__attribute__((target("avx2")))
+static void alpha_row_avx2(uint8_t *alpha, const uint8_t *a, int n, const PIP_ALPHA_CLAMP_T *pClamp) {
+  const __m256i vlo = _mm256_set1_epi8((char) pClamp->lo);
+  const __m256i vhi = _mm256_set1_epi8((char) pClamp->hi);
+  int k;
+
+  for(k = 0; k + 32 <= n; k += 32) {
+    _mm256_storeu_si256((__m256i *) &alpha[k], 
+         _mm256_min_epu8(_mm256_max_epu8(_mm256_loadu_si256((const __m256i *) &a[k]), vlo), vhi));
+  }
+
+  alpha_row_c(&alpha[k], &a[k], n - k, pClamp);
+}
+
+__attribute__((target("avx2")))
+static void alpha_row_2x2_avx2(uint8_t *alpha, const uint8_t *a0, const uint8_t *a1, int n,
+                               const PIP_ALPHA_CLAMP_T *pClamp) {
+  const __m256i vlo = _mm256_set1_epi8((char) pClamp->lo);
+  const __m256i vhi = _mm256_set1_epi8((char) pClamp->hi);
+  const __m256i mask = _mm256_set1_epi16(0xff);
+  __m256i r0, r1, sum;
+  __m128i out;
+  int k;
+
+  for(k = 0; k + 16 <= n; k += 16) {
+    r0 = _mm256_loadu_si256((const __m256i *) &a0[2*k]);
+    r1 = _mm256_loadu_si256((const __m256i *) &a1[2*k]);
+    sum = _mm256_add_epi16(_mm256_add_epi16(_mm256_and_si256(r0, mask), _mm256_srli_epi16(r0, 8)),
+                           _mm256_add_epi16(_mm256_and_si256(r1, mask), _mm256_srli_epi16(r1, 8)));
+    sum = _mm256_srli_epi16(sum, 2);
+    out = _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    _mm_storeu_si128((__m128i *) &alpha[k], 
+       _mm_min_epu8(_mm_max_epu8(out, _mm256_castsi256_si128(vlo)), _mm256_castsi256_si128(vhi)));
+  }
+
+  alpha_row_2x2_c(&alpha[k], &a0[2*k], &a1[2*k], n - k, pClamp);
+}
+
+static const PIP_BLEND_KERNELS_T g_blend_avx2 = { "avx2", blend_row_avx2, alpha_row_avx2, 
+                                                  alpha_row_2x2_avx2 };
+
+#endif // (__GNUC__) && (__x86_64__) || (__i386__)
+
+static const PIP_BLEND_KERNELS_T *g_pblend;
+static pthread_once_t g_blend_once = PTHREAD_ONCE_INIT;
+
+static void blend_kernels_init(void) {
+
+  g_pblend = &g_blend_c;
+
+#if defined(PIP_BLEND_X86)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")) {
+    g_pblend = &g_blend_avx2;
+  } else if(__builtin_cpu_supports("sse2")) {
+    g_pblend = &g_blend_sse2;
+  }
+#endif // PIP_BLEND_X86
+
+  LOG(X_DEBUG("PIP blend using %s kernels"), g_pblend->name);
+}
+
+static const PIP_BLEND_KERNELS_T *blend_kernels_get(void) {
+  pthread_once(&g_blend_once, blend_kernels_init);
+  return g_pblend;
+}
+
+static void blend_pixels_kernels(const PIP_BLEND_KERNELS_T *pKernels,
+                         unsigned char *dst_data[4], 
                          int dst_linesize[4], 
                          const unsigned char *src_data[4], 
                          const int src_linesize[4], 
@@ -184,10 +429,13 @@ static void blend_pixels(unsigned char *dst_data[4],
   int end_y, start_y;
   int width, height;
   int hsub, vsub;
-  uint8_t *dp, *d;
-  const uint8_t *sp, *ap, *s, *a;
+  uint8_t *dp;
+  const uint8_t *sp, *ap, *a;
   int wp, hp;
-  int alpha_v, alpha_h, alpha;
+  int alpha_v, alpha_h;
+  PIP_ALPHA_CLAMP_T clamp;
+  uint8_t *palpha;
+  uint8_t alphabuf[2048];
 
   if(offsetx > src_w) {
     offsetx = src_w;
@@ -200,8 +448,28 @@ static void blend_pixels(unsigned char *dst_data[4],
   width = MIN(dst_w - posx - offsetx, src_w - offsetx) ;
   height = end_y - start_y;
 
-//fprintf(stderr, "W:%d H:%d, x:%d y:%d\n", width, height, posx, posy);
-//fprintf(stderr, "blend x:%d, y:%d, w:%d, h:%d, slice_y:%d, slice_w:%d, slice_h:%d, width:%d, height:%d, start_y:%d, end_y:%d src{%d,%d,%d,%d}, dst{ %d,%d,%d,%d}\n", posx, posy, src_w, src_h, slice_y, dst_w, dst_h, width, height, start_y, end_y,  src->linesize[0], src->linesize[1], src->linesize[2], src->linesize[3], dst->linesize[0], dst->linesize[1], dst->linesize[2], dst->linesize[3]);
+  if(width <= 0 || height <= 0) {
+    return;
+  }
+
+  if(alphamax_min1 == 0 && pPip->alphamax_min1 > 0) {
+    alphamax_min1 = pPip->alphamax_min1;
+  }
+  clamp.max_min1 = alphamax_min1;
+  clamp.min_min1 = pPip->alphamin_min1;
+  clamp.lo = clamp.min_min1 > 0 ? clamp.min_min1 - 1 : 0;
+  clamp.hi = clamp.max_min1 > 0 ? clamp.max_min1 - 1 : 0xff;
+  clamp.minmax = (clamp.lo <= clamp.hi);
+
+  if(!clamp.minmax) {
+    pKernels = &g_blend_c;
+  }
+
+  if(width <= (int) sizeof(alphabuf)) {
+    palpha = alphabuf;
+  } else if(!(palpha = (uint8_t *) malloc(width))) {
+    return;
+  }
 
   //
   // assuming src YUVA420p -> YUV420p
@@ -224,36 +492,35 @@ static void blend_pixels(unsigned char *dst_data[4],
 
     for(j = 0; j < hp; j++) {
 
-      d = dp;
-      s = sp;
-      a = ap;
+      if(!hsub) {
 
-      for (k = 0; k < wp; k++) {
+        pKernels->alpha_row(palpha, ap, wp, &clamp);
 
-        if(hsub && vsub && j+1 < hp && k+1 < wp) {
-	  alpha = (a[0] + a[src_linesize[3]] + a[1] + a[src_linesize[3]+1]) >> 2;
-	} else if (hsub || vsub) {
-	  alpha_h = hsub && k+1 < wp ?  (a[0] + a[1]) >> 1 : a[0];
-          alpha_v = vsub && j+1 < hp ?  (a[0] + a[src_linesize[3]]) >> 1 : a[0];
-          alpha = (alpha_v + alpha_h) >> 1;
-        } else {
-          alpha = a[0];
-        }
+      } else if(j + 1 < hp) {
+
+        //
+        // Average the 2x2 alpha block for each chroma sample, except for the last
+        // column which only has a lower neighbor
+        //
+        pKernels->alpha_row_2x2(palpha, ap, ap + src_linesize[3], wp - 1, &clamp);
+        a = &ap[(wp - 1) << hsub];
+        alpha_v = (a[0] + a[src_linesize[3]]) >> 1;
+        palpha[wp - 1] = alpha_clamp((alpha_v + a[0]) >> 1, &clamp);
+
+      } else {
 
-        if(alphamax_min1 == 0 && pPip->alphamax_min1 > 0) {
-          alphamax_min1 = pPip->alphamax_min1;
+        //
+        // The last chroma row has no lower alpha neighbor
+        //
+        for(k = 0; k < wp; k++) {
+          a = &ap[k << hsub];
+          alpha_h = k + 1 < wp ? (a[0] + a[1]) >> 1 : a[0];
+          palpha[k] = alpha_clamp((a[0] + alpha_h) >> 1, &clamp);
         }
-        if(alphamax_min1 != 0 && alpha >= alphamax_min1) {
-          alpha = alphamax_min1 - 1;
-        } else if(pPip->alphamin_min1 != 0 && alpha < pPip->alphamin_min1) {
-          alpha = pPip->alphamin_min1 - 1;
-        } 
 
-	*d = (*d * (0xff - alpha) + *s++ * alpha + 128) >> 8;
-	d++;
-	a += 1 << hsub;
+      }
 
-      } // end of for k
+      pKernels->blend_row(dp, sp, palpha, wp);
 
       dp += dst_linesize[i];
       sp += src_linesize[i];
@@ -263,6 +530,28 @@ static void blend_pixels(unsigned char *dst_data[4],
 
   } // end of for i
 
+  if(palpha != alphabuf) {
+    free(palpha);
+  }
+
+}
+
+static void blend_pixels(unsigned char *dst_data[4], 
+                         int dst_linesize[4], 
+                         const unsigned char *src_data[4], 
+                         const int src_linesize[4], 
+                         const IXCODE_VIDEO_PIP_T *pPip,
+                         unsigned int src_w,
+                         unsigned int src_h,
+                         int posx, 
+                         int posy, 
+                         int offsetx, 
+                         int dst_w, 
+                         int dst_h,
+                         int alphamax_min1) {
+
+  blend_pixels_kernels(blend_kernels_get(), dst_data, dst_linesize, src_data, src_linesize, pPip,
+                       src_w, src_h, posx, posy, offsetx, dst_w, dst_h, alphamax_min1);
 }
 
 int pip_add(IXCODE_VIDEO_CTXT_T *pXcode, unsigned int outidx, struct AVFrame *pframesPipIn[PIP_ADD_MAX], struct AVFrame *pframesPipOut[PIP_ADD_MAX]) {
@@ -1130,3 +1419,151 @@ static int pip_draw_grid(unsigned char *data[4], int linesize[4], int origHeight
   return rc;
 }
 
+
+#define PIP_BENCH_CANVAS_W       1280
+#define PIP_BENCH_CANVAS_H       720
+#define PIP_BENCH_OVERLAY_W      318
+#define PIP_BENCH_OVERLAY_H      178
+
+static void pip_bench_canvas(PIX_PLANE_T *pCanvas, unsigned char *pbuf) {
+  const int w = PIP_BENCH_CANVAS_W, h = PIP_BENCH_CANVAS_H;
+  int i;
+
+  pCanvas->data[0] = pbuf;
+  pCanvas->data[1] = pbuf + w * h;
+  pCanvas->data[2] = pbuf + w * h + (w / 2) * (h / 2);
+  pCanvas->data[3] = NULL;
+  pCanvas->linesize[0] = w;
+  pCanvas->linesize[1] = pCanvas->linesize[2] = w / 2;
+  pCanvas->linesize[3] = 0;
+
+  for(i = 0; i < w * h * 3 / 2; i++) {
+    pbuf[i] = (unsigned char) (i * 7 + (i >> 9));
+  }
+}
+
+static double pip_bench_run(const PIP_BLEND_KERNELS_T *pKernels, PIX_PLANE_T *pCanvas, 
+                            unsigned char *pcanvasbuf, PIX_PLANE_T *pOverlays, 
+                            unsigned int numOverlays, unsigned int frames,
+                            const IXCODE_VIDEO_PIP_T *pPip) {
+  struct timeval tv0, tv1;
+  unsigned int frameIdx, idx;
+  int posx, posy;
+
+  pip_bench_canvas(pCanvas, pcanvasbuf);
+
+  gettimeofday(&tv0, NULL);
+
+  for(frameIdx = 0; frameIdx < frames; frameIdx++) {
+    for(idx = 0; idx < numOverlays; idx++) {
+
+      //
+      // Stagger the overlays across the canvas, some clipped at the right and bottom edges 
+      //
+      posx = ((idx * 241 + frameIdx * 2) % (PIP_BENCH_CANVAS_W - 64)) & ~1;
+      posy = ((idx * 137 + frameIdx * 2) % (PIP_BENCH_CANVAS_H - 64)) & ~1;
+
+      blend_pixels_kernels(pKernels, pCanvas->data, pCanvas->linesize, 
+                           (const unsigned char **) pOverlays[idx].data, pOverlays[idx].linesize, 
+                           pPip, PIP_BENCH_OVERLAY_W, PIP_BENCH_OVERLAY_H, posx, posy, 0,
+                           PIP_BENCH_CANVAS_W, PIP_BENCH_CANVAS_H, 0);
+    }
+  }
+
+  gettimeofday(&tv1, NULL);
+
+  return ((tv1.tv_sec - tv0.tv_sec) * 1000.0) + ((tv1.tv_usec - tv0.tv_usec) / 1000.0);
+}
+
+int pip_blend_benchmark(unsigned int numOverlays, unsigned int frames) {
+  const PIP_BLEND_KERNELS_T *arrKernels[3];
+  unsigned int numKernels = 0;
+  const unsigned int canvassz = PIP_BENCH_CANVAS_W * PIP_BENCH_CANVAS_H * 3 / 2;
+  const unsigned int overlaysz = PIP_BENCH_OVERLAY_W * PIP_BENCH_OVERLAY_H;
+  IXCODE_VIDEO_PIP_T pip;
+  PIX_PLANE_T canvas;
+  PIX_PLANE_T *pOverlays = NULL;
+  unsigned char *pbufs = NULL;
+  unsigned char *pcanvasbuf, *pcanvasref;
+  unsigned int idx, i;
+  double ms, ms_c = 0;
+  int rc = 0;
+
+  if(numOverlays == 0) {
+    numOverlays = 1;
+  }
+  if(frames == 0) {
+    frames = 1;
+  }
+
+  arrKernels[numKernels++] = &g_blend_c;
+#if defined(PIP_BLEND_X86)
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("sse2")) {
+    arrKernels[numKernels++] = &g_blend_sse2;
+  }
+  if(__builtin_cpu_supports("avx2")) {
+    arrKernels[numKernels++] = &g_blend_avx2;
+  }
+#endif // PIP_BLEND_X86
+
+  if(!(pOverlays = (PIX_PLANE_T *) calloc(numOverlays, sizeof(PIX_PLANE_T))) ||
+     !(pbufs = (unsigned char *) malloc(2 * canvassz + numOverlays * overlaysz * 3))) {
+    free(pOverlays);
+    return -1;
+  }
+
+  pcanvasbuf = pbufs;
+  pcanvasref = pbufs + canvassz;
+
+  //
+  // YUVA420P overlays with a varying alpha ramp
+  //
+  for(idx = 0; idx < numOverlays; idx++) {
+    pOverlays[idx].data[0] = pbufs + 2 * canvassz + idx * overlaysz * 3;
+    pOverlays[idx].data[1] = pOverlays[idx].data[0] + overlaysz;
+    pOverlays[idx].data[2] = pOverlays[idx].data[1] + overlaysz / 4;
+    pOverlays[idx].data[3] = pOverlays[idx].data[2] + overlaysz / 4;
+    pOverlays[idx].linesize[0] = pOverlays[idx].linesize[3] = PIP_BENCH_OVERLAY_W;
+    pOverlays[idx].linesize[1] = pOverlays[idx].linesize[2] = PIP_BENCH_OVERLAY_W / 2;
+    for(i = 0; i < overlaysz * 3 / 2; i++) {
+      pOverlays[idx].data[0][i] = (unsigned char) (i * 13 + idx * 31);
+    }
+    for(i = 0; i < overlaysz; i++) {
+      pOverlays[idx].data[3][i] = (unsigned char) ((i % PIP_BENCH_OVERLAY_W) + (i / PIP_BENCH_OVERLAY_W) + idx * 17);
+    }
+  }
+
+  memset(&pip, 0, sizeof(pip));
+  pip.alphamax_min1 = 240 + 1;
+  pip.alphamin_min1 = 16 + 1;
+
+  fprintf(stdout, "PIP blend benchmark: %u overlays %dx%d on %dx%d canvas, %u frames\n",
+          numOverlays, PIP_BENCH_OVERLAY_W, PIP_BENCH_OVERLAY_H, 
+          PIP_BENCH_CANVAS_W, PIP_BENCH_CANVAS_H, frames);
+
+  for(i = 0; i < numKernels; i++) {
+
+    ms = pip_bench_run(arrKernels[i], &canvas, pcanvasbuf, pOverlays, numOverlays, frames, &pip);
+
+    if(i == 0) {
+      ms_c = ms;
+      memcpy(pcanvasref, pcanvasbuf, canvassz);
+    }
+
+    fprintf(stdout, "  %-5s %8.3f ms/frame  %8.1f Mpix/s  speedup: %.2fx  bit-exact: %s\n",
+            arrKernels[i]->name, ms / frames, 
+            ms > 0 ? (double) overlaysz * numOverlays * frames / (ms * 1000.0) : 0,
+            ms > 0 ? ms_c / ms : 0,
+            memcmp(pcanvasref, pcanvasbuf, canvassz) ? "no" : "yes");
+
+    if(memcmp(pcanvasref, pcanvasbuf, canvassz)) {
+      rc = -1;
+    }
+  }
+
+  free(pbufs);
+  free(pOverlays);
+
+  return rc;
+}
@@ -30,6 +30,7 @@
 #else // WIN32
 
 #include <unistd.h>
+#include <sys/time.h>
 
 #endif // WIN32
 
@@ -43,6 +44,7 @@
 #include "xcoder_libavcodec.h"
 #include "xcoder.h"
 #include "xcoder_filter.h"
+#include "xcoder_framepool.h"
 #include "libswscale/swscale.h"
 #include "vsxlib.h"
 
@@ -161,6 +163,8 @@ int g_debug_flags;
                               (out).color.common.active || \
                               (out).testFilter.common.active)
 
+static void vidpipe_stop(IXCODE_VIDEO_CTXT_T *pXcode);
+
 
 void xcode_fill_yuv420p(unsigned char *data[4], int linesize[4], unsigned char *p, unsigned int ht) {     
 
@@ -185,6 +189,184 @@ void ixcode_init_common(IXCODE_COMMON_CTXT_T *pCommon) {
   pCommon->decodeOutIdx = 0;
   pCommon->encodeInIdx = 0;
   pCommon->encodeOutIdx = 0;
+  memset(&pCommon->stageStats, 0, sizeof(pCommon->stageStats));
+}
+
+uint64_t ixcode_stage_time_us() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return ((uint64_t) tv.tv_sec * 1000000) + tv.tv_usec;
+}
+
+//
+// Encoder speed governor.  The encode time of every output is compared against the
+// output frame interval once per window of roughly one second of frames.  The most
+// expensive governed encoder is stepped to a faster level after IXCODE_GOVERNOR_SLOW_WINDOWS
+// consecutive overloaded windows, and the most degraded one is stepped back only after
+// a longer run of underloaded windows.  That run doubles each time a step back has to
+// be undone, to keep an encoder from flapping around the load limit.
+//
+#define IXCODE_GOVERNOR_SLOW_PCT          90
+#define IXCODE_GOVERNOR_FAST_PCT          55
+#define IXCODE_GOVERNOR_SLOW_WINDOWS      2
+#define IXCODE_GOVERNOR_FAST_WINDOWS      10
+#define IXCODE_GOVERNOR_FAST_WINDOWS_MAX  160
+
+static void governor_init(IXCODE_VIDEO_CTXT_T *pXcode, unsigned int outidx) {
+  IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  IXCODE_VIDEO_GOVERNOR_T *pGov = &pXcode->out[outidx].governor;
+
+  memset(pGov, 0, sizeof(IXCODE_VIDEO_GOVERNOR_T));
+
+  if(pXcode->out[outidx].cfgGovernor > 0 && pAvCtx->out[outidx].encWrap.u.v.fEncode &&
+     pAvCtx->out[outidx].encWrap.u.v.fSpeed) {
+    pGov->active = 1;
+    pAvCtx->governorOn = 1;
+  }
+
+  pAvCtx->governorSlow = 0;
+  pAvCtx->governorFast = 0;
+  pAvCtx->governorFastNeeded = IXCODE_GOVERNOR_FAST_WINDOWS;
+  pAvCtx->governorSinceUp = IXCODE_GOVERNOR_FAST_WINDOWS;
+}
+
+static int governor_set_level(IXCODE_VIDEO_CTXT_T *pXcode, unsigned int outidx, int level) {
+  IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  IXCODE_VIDEO_GOVERNOR_T *pGov = &pXcode->out[outidx].governor;
+
+  if(pAvCtx->out[outidx].encWrap.u.v.fSpeed(&pAvCtx->out[outidx].encWrap.u.v.ctxt, outidx, level) < 0) {
+    LOG(X_WARNING("Video encoder[%d] speed cannot be adjusted, disabling encoder governor"), outidx);
+    pGov->active = 0;
+    pGov->level = 0;
+    return -1;
+  }
+
+  pGov->level = level;
+
+  return 0;
+}
+
+//
+// An encoder re-init starts over from the configured speed
+//
+static void governor_restore(IXCODE_VIDEO_CTXT_T *pXcode, unsigned int outidx) {
+  IXCODE_VIDEO_GOVERNOR_T *pGov = &pXcode->out[outidx].governor;
+
+  if(pGov->active && pGov->level > 0) {
+    governor_set_level(pXcode, outidx, pGov->level);
+  }
+}
+
+static void governor_update(IXCODE_VIDEO_CTXT_T *pXcode) {
+  IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  IXCODE_VIDEO_GOVERNOR_T *pGov;
+  unsigned int outidx;
+  unsigned int window;
+  unsigned int usInterval;
+  unsigned int usTot = 0;
+  unsigned int pct;
+  int idx = -1;
+  int level;
+
+  if(pXcode->resOutClockHz == 0 || pXcode->resOutFrameDeltaHz == 0) {
+    return;
+  }
+
+  if((window = pXcode->resOutClockHz / pXcode->resOutFrameDeltaHz) < 1) {
+    window = 1;
+  }
+  usInterval = (unsigned int) ((uint64_t) 1000000 * pXcode->resOutFrameDeltaHz / pXcode->resOutClockHz);
+
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+    if(pAvCtx->out[outidx].encWrap.u.v.fEncode && pXcode->out[outidx].active && 
+       !pXcode->out[outidx].passthru && pXcode->out[outidx].governor.numEncode < window) {
+      return;
+    }
+  }
+
+  //
+  // Every encoder counts towards the load, only governed encoders are adjusted
+  //
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+    pGov = &pXcode->out[outidx].governor;
+    if(pGov->numEncode > 0) {
+      pGov->usEncodeAvg = (unsigned int) (pGov->usEncodeTot / pGov->numEncode);
+      usTot += pGov->usEncodeAvg;
+      pGov->usEncodeTot = 0;
+      pGov->numEncode = 0;
+    }
+  }
+
+  pct = (unsigned int) ((uint64_t) usTot * 100 / MAX(usInterval, 1));
+  pAvCtx->governorSinceUp++;
+
+  if(pct >= IXCODE_GOVERNOR_SLOW_PCT) {
+    pAvCtx->governorSlow++;
+    pAvCtx->governorFast = 0;
+  } else if(pct <= IXCODE_GOVERNOR_FAST_PCT) {
+    pAvCtx->governorFast++;
+    pAvCtx->governorSlow = 0;
+  } else {
+    pAvCtx->governorSlow = 0;
+    pAvCtx->governorFast = 0;
+  }
+
+  if(pAvCtx->governorSlow >= IXCODE_GOVERNOR_SLOW_WINDOWS) {
+
+    pAvCtx->governorSlow = 0;
+
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+      pGov = &pXcode->out[outidx].governor;
+      if(pGov->active && pGov->level < IXCODE_GOVERNOR_LEVEL_MAX &&
+         (idx < 0 || pGov->usEncodeAvg > pXcode->out[idx].governor.usEncodeAvg)) {
+        idx = outidx;
+      }
+    }
+
+    if(idx < 0) {
+      return;
+    }
+
+    if(pAvCtx->governorSinceUp < pAvCtx->governorFastNeeded) {
+      pAvCtx->governorFastNeeded = MIN(pAvCtx->governorFastNeeded * 2, IXCODE_GOVERNOR_FAST_WINDOWS_MAX);
+    }
+    level = pXcode->out[idx].governor.level + 1;
+
+  } else if(pAvCtx->governorFast >= pAvCtx->governorFastNeeded) {
+
+    pAvCtx->governorFast = 0;
+
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+      pGov = &pXcode->out[outidx].governor;
+      if(pGov->active && pGov->level > 0 && (idx < 0 || pGov->level > pXcode->out[idx].governor.level ||
+         (pGov->level == pXcode->out[idx].governor.level && 
+          pGov->usEncodeAvg < pXcode->out[idx].governor.usEncodeAvg))) {
+        idx = outidx;
+      }
+    }
+
+    if(idx < 0) {
+      return;
+    }
+
+    pAvCtx->governorSinceUp = 0;
+    level = pXcode->out[idx].governor.level - 1;
+
+  } else {
+    return;
+  }
+
+  pGov = &pXcode->out[idx].governor;
+
+  LOG(X_INFO("Video encoder[%d] %s speed level %d -> %d, encode %.1f ms/frame, all encoders %.1f ms "
+             "of %.1f ms frame interval (%d%%)"), idx, level > pGov->level ? "raising" : "lowering",
+             pGov->level, level, (float) pGov->usEncodeAvg / 1000.0f, (float) usTot / 1000.0f, 
+             (float) usInterval / 1000.0f, pct);
+
+  if(governor_set_level(pXcode, idx, level) == 0) {
+    pGov->numAdapt++;
+  }
+
 }
 
 static int init_pip_dimensions(IXCODE_VIDEO_CTXT_T *pXcode, unsigned int scaleIdx, unsigned int frameidx) {
@@ -219,7 +401,7 @@ static int init_pip_dimensions(IXCODE_VIDEO_CTXT_T *pXcode, unsigned int scaleId
     // Force any filter buffers to reset since the output dimensions have changed 
     //
     if(FILTER_ENABLED(pXcode->out[idx]) && pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufFilter) {
-      av_free(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufFilter);
+      framepool_unref(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufFilter);
       pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufFilter = NULL;
     }
 #endif // XCODE_FILTER_ON
@@ -236,11 +418,14 @@ static int init_pip_dimensions(IXCODE_VIDEO_CTXT_T *pXcode, unsigned int scaleId
   }
 
   if(pAvCtx->piprawDataBufs[frameidx] && pip_pic_sz_orig != pAvCtx->out[0].dim_pips[frameidx].pic_sz) {
-    av_free(pAvCtx->piprawDataBufs[frameidx]);
+    framepool_unref(pAvCtx->piprawDataBufs[frameidx]);
     pAvCtx->piprawDataBufs[frameidx] = NULL;
   }
   
-  if(!pAvCtx->piprawDataBufs[frameidx] && !(pAvCtx->piprawDataBufs[frameidx] = av_malloc(pAvCtx->out[0].dim_pips[frameidx].pic_sz))) {
+  if(!pAvCtx->piprawDataBufs[frameidx] && 
+     !(pAvCtx->piprawDataBufs[frameidx] = framepool_get(pAvCtx->out[0].dim_pips[frameidx].pix_fmt, 
+                                                         pAvCtx->out[0].dim_pips[frameidx].width,
+                                                         pAvCtx->out[0].dim_pips[frameidx].height))) {
     rc = -1;
   }
 
@@ -369,6 +554,7 @@ int ixcode_init_vid(IXCODE_VIDEO_CTXT_T *pXcode) {
   enc.fInit = xcoder_libavcodec_video_init_encoder;
   enc.fClose = xcoder_libavcodec_video_close_encoder;
   enc.fEncode = xcoder_libavcodec_video_encode;
+  enc.fSpeed = xcoder_libavcodec_video_speed;
   enc.ctxt.pXcode = pXcode;
 
   memset(&dec, 0, sizeof(dec));
@@ -449,6 +635,7 @@ int ixcode_init_vid(IXCODE_VIDEO_CTXT_T *pXcode) {
         enc.fInit = xcoder_x264_init;
         enc.fClose = xcoder_x264_close;
         enc.fEncode = xcoder_x264_encode;
+        enc.fSpeed = xcoder_x264_speed;
 
 #endif // (XCODE_HAVE_X264_AVCODEC) || (XCODE_HAVE_X264_AVCODEC == 0)
 
@@ -497,6 +684,7 @@ int ixcode_init_vid(IXCODE_VIDEO_CTXT_T *pXcode) {
           rc = -1;
           break;
         }  
+        governor_restore(pXcode, idx);
       } 
     }
     pthread_mutex_unlock(&g_xcode_mtx);
@@ -588,6 +776,7 @@ int ixcode_init_vid(IXCODE_VIDEO_CTXT_T *pXcode) {
     pXcode->out[idx].qTot = 0;
     pXcode->out[idx].qSamples = 0;
 
+    governor_init(pXcode, idx);
   }
 
   //TODO: set resOutH, resOutV, pix_fmt, if this is a pip and
@@ -663,6 +852,8 @@ void ixcode_close_vid(IXCODE_VIDEO_CTXT_T *pXcodeV) {
     return;
   }
 
+  vidpipe_stop(pXcodeV);
+
   pthread_mutex_lock(&g_xcode_mtx);
 
   if((pAvCtx = pXcodeV->common.pPrivData)) {
@@ -687,36 +878,36 @@ void ixcode_close_vid(IXCODE_VIDEO_CTXT_T *pXcodeV) {
         pAvCtx->out[idx].scale[scaleIdx].forcescaler = 0; 
 
         if(pAvCtx->out[idx].scale[scaleIdx].pframeScaled) {
-          avpicture_free((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeScaled);
+          framepool_picture_free((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeScaled);
           av_free(pAvCtx->out[idx].scale[scaleIdx].pframeScaled);
           pAvCtx->out[idx].scale[scaleIdx].pframeScaled = NULL;
         }
 
         if(pAvCtx->out[idx].scale[scaleIdx].pframeRotate) {
-          avpicture_free((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeRotate);
+          framepool_picture_free((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeRotate);
           av_free(pAvCtx->out[idx].scale[scaleIdx].pframeRotate);
           pAvCtx->out[idx].scale[scaleIdx].pframeRotate = NULL;
         }
 
         if(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufPad) {
-          av_free(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufPad);
+          framepool_unref(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufPad);
           pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufPad = NULL;
         }
 
         if(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufCrop) {
-          av_free(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufCrop);
+          framepool_unref(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufCrop);
           pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufCrop = NULL;
         }
 
         if(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufFilter) {
-          av_free(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufFilter);
+          framepool_unref(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufFilter);
           pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufFilter = NULL;
         }
 
       }
 
       if(pAvCtx->out[idx].pPipBufEncoderIn) {
-        av_free(pAvCtx->out[idx].pPipBufEncoderIn);
+        framepool_unref(pAvCtx->out[idx].pPipBufEncoderIn);
         pAvCtx->out[idx].pPipBufEncoderIn = NULL;
       }
 
@@ -759,7 +950,7 @@ void ixcode_close_vid(IXCODE_VIDEO_CTXT_T *pXcodeV) {
 
     for(idx = 0; idx < PIP_ADD_MAX; idx++) {
       if(pAvCtx->piprawDataBufs[idx]) {
-        av_free(pAvCtx->piprawDataBufs[idx]);
+        framepool_unref(pAvCtx->piprawDataBufs[idx]);
         pAvCtx->piprawDataBufs[idx] = NULL;
       }
     }
@@ -783,6 +974,9 @@ void ixcode_close_vid(IXCODE_VIDEO_CTXT_T *pXcodeV) {
     free(pAvCtx);
     pXcodeV->common.pPrivData = NULL;
 
+    framepool_logstats();
+    framepool_trim();
+
   }
 
   pthread_mutex_unlock(&g_xcode_mtx);
@@ -878,18 +1072,15 @@ static int runfilter(const FILTER_COMMON_T *pFilter,
                      unsigned int scaleIdx) {
 
   AVFrame outFrame;
-  AVPicture pic;
-  int sz;
 
   if(!pFilter->active) {
     return 0;
   }
 
-  if(!pOutCtx->scale[scaleIdx].pScaleDataBufFilter &&
-     (sz = avpicture_fill(&pic, NULL, pOutCtx->dim_enc.pix_fmt,
-                            pOutCtx->dim_enc.width,
-                            pOutCtx->dim_enc.height)) > 0) {
-    pOutCtx->scale[scaleIdx].pScaleDataBufFilter = (unsigned char *) av_malloc(sz);
+  if(!pOutCtx->scale[scaleIdx].pScaleDataBufFilter) {
+    pOutCtx->scale[scaleIdx].pScaleDataBufFilter = framepool_get(pOutCtx->dim_enc.pix_fmt,
+                                                                 pOutCtx->dim_enc.width,
+                                                                 pOutCtx->dim_enc.height);
   }
 
   if(!pOutCtx->scale[scaleIdx].pScaleDataBufFilter) {
@@ -961,11 +1152,14 @@ static void runfilters(IXCODE_VIDEO_CTXT_T *pXcode, AVFrame *pframesout[IXCODE_V
   //int sz;
   //AVPicture pic;
   IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  uint64_t tmStage = 0;
 
 #if defined(XCODE_PROFILE_VID)
       gettimeofday(&gtv[10], NULL); 
 #endif // XCODE_PROFILE_VID
 
+      IXCODE_STAGE_BEGIN(&pXcode->common, tmStage);
+
 
       for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
 
@@ -1038,6 +1232,8 @@ static void runfilters(IXCODE_VIDEO_CTXT_T *pXcode, AVFrame *pframesout[IXCODE_V
 
 //fprintf(stderr, "encoder in: 0x%x, filterbuf:0x%x\n", pframesout[0]->data[0], pAvCtx->out[0].pScaleDataBufFilter);
 
+      IXCODE_STAGE_END(&pXcode->common, tmStage, usFilter, numFilter);
+
 #if defined(XCODE_PROFILE_VID)
       gettimeofday(&gtv[11], NULL); 
       pAvCtx->prof.num_vfilters++;
@@ -1052,9 +1248,7 @@ static enum IXCODE_RC init_scaler(IXCODE_VIDEO_CTXT_T *pXcode,
                                   unsigned int scaleIdx,
                                   const VID_DIMENSIONS_T *pDimensionsOut, 
                                   const VID_DIMENSIONS_T *pDimensionsIn) {
-  int sz = 0;
   int width, height;
-  AVPicture pic;
   
   IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
 
@@ -1081,7 +1275,7 @@ static enum IXCODE_RC init_scaler(IXCODE_VIDEO_CTXT_T *pXcode,
     }
 
     if(pAvCtx->out[idx].scale[scaleIdx].pframeRotate) {
-      avpicture_free((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeRotate);
+      framepool_picture_free((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeRotate);
       av_free(pAvCtx->out[idx].scale[scaleIdx].pframeRotate);
       pAvCtx->out[idx].scale[scaleIdx].pframeRotate = NULL;
     }
@@ -1089,7 +1283,7 @@ static enum IXCODE_RC init_scaler(IXCODE_VIDEO_CTXT_T *pXcode,
     //LOG(X_DEBUG("CALLING AVPICTURE_ALLOC rotate out[%d] scale[%d] pix_fmt:%d, %dx%d"), idx, scaleIdx, pDimensionsOut->pix_fmt, width, height);
 
     if((pAvCtx->out[idx].scale[scaleIdx].pframeRotate = avcodec_alloc_frame()) == NULL ||
-      avpicture_alloc((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeRotate,
+      framepool_picture_alloc((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeRotate,
                     pDimensionsOut->pix_fmt, width, height) < 0) {
       return IXCODE_RC_ERROR_SCALE;
     }
@@ -1119,7 +1313,7 @@ static enum IXCODE_RC init_scaler(IXCODE_VIDEO_CTXT_T *pXcode,
   }
 
   if(pAvCtx->out[idx].scale[scaleIdx].pframeScaled) {
-    avpicture_free((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeScaled);
+    framepool_picture_free((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeScaled);
     av_free(pAvCtx->out[idx].scale[scaleIdx].pframeScaled);
     pAvCtx->out[idx].scale[scaleIdx].pframeScaled = NULL;
   }
@@ -1127,7 +1321,7 @@ static enum IXCODE_RC init_scaler(IXCODE_VIDEO_CTXT_T *pXcode,
   //LOG(X_DEBUG("CALLING AVPICTURE_ALLOC pframeScaled out[%d] scale[%d] pix_fmt:%d, %dx%d"), idx, scaleIdx, pDimensionsOut->pix_fmt, pDimensionsOut->width, pDimensionsOut->height);
 
   if((pAvCtx->out[idx].scale[scaleIdx].pframeScaled = avcodec_alloc_frame()) == NULL ||
-    avpicture_alloc((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeScaled,
+    framepool_picture_alloc((AVPicture *)pAvCtx->out[idx].scale[scaleIdx].pframeScaled,
                     pDimensionsOut->pix_fmt, pDimensionsOut->width, pDimensionsOut->height) < 0) {
     return IXCODE_RC_ERROR_SCALE;
   }
@@ -1144,30 +1338,25 @@ static enum IXCODE_RC init_scaler(IXCODE_VIDEO_CTXT_T *pXcode,
       return IXCODE_RC_ERROR_SCALE;
     }
 
-    if((sz = avpicture_fill(&pic, NULL, pDimensionsOut->pix_fmt, pDimensionsOut->width, 
-                            pDimensionsOut->height)) > 0) {
-      if(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufPad) {
-        av_free(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufPad);
-      }
-      pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufPad = (unsigned char *) av_malloc(sz);
- 
+    if(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufPad) {
+      framepool_unref(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufPad);
     }
+    pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufPad = framepool_get(pDimensionsOut->pix_fmt, 
+                                                                      pDimensionsOut->width, 
+                                                                      pDimensionsOut->height);
   }
 
   if(pAvCtx->out[idx].scale[scaleIdx].cropLeft > 0 || pAvCtx->out[idx].scale[scaleIdx].cropRight > 0 || 
      pAvCtx->out[idx].scale[scaleIdx].cropTop > 0 || pAvCtx->out[idx].scale[scaleIdx].cropBottom > 0) {
 
-    if((sz = avpicture_fill(&pic, NULL, pDimensionsIn->pix_fmt, 
+    if(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufCrop) {
+      framepool_unref(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufCrop);
+    }
+    pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufCrop = framepool_get(pDimensionsIn->pix_fmt, 
                  pDimensionsIn->width - pAvCtx->out[idx].scale[scaleIdx].cropLeft - 
                                         pAvCtx->out[idx].scale[scaleIdx].cropRight,
                  pDimensionsIn->height - pAvCtx->out[idx].scale[scaleIdx].cropTop - 
-                                         pAvCtx->out[idx].scale[scaleIdx].cropBottom)) > 0) {
-
-      if(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufCrop) {
-        av_free(pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufCrop);
-      }
-      pAvCtx->out[idx].scale[scaleIdx].pScaleDataBufCrop = (unsigned char *) av_malloc(sz);
-    }
+                                         pAvCtx->out[idx].scale[scaleIdx].cropBottom);
   }
 
   if(pAvCtx->decIsImage >  1) {
@@ -1306,6 +1495,249 @@ static enum IXCODE_RC scale_frame(IXCODE_VIDEO_CTXT_T *pXcode,
   return IXCODE_RC_OK;
 }
 
+//
+// Scaling graph
+//
+// Outputs requiring an identical scale of the decoded picture (dimensions, pixel format, 
+// crop / pad and scaler type) re-use the scaled frame of the first such output by reference.
+// An output which is smaller than another output's scaled picture is cascaded, being scaled 
+// from that (already reduced) picture instead of from the full size decoded picture.
+//
+
+#define SCALE_HAVE_CROP(s) ((s).cropTop > 0 || (s).cropBottom > 0 || (s).cropLeft > 0 || (s).cropRight > 0)
+#define SCALE_HAVE_PAD(s) ((s).padTop > 0 || (s).padBottom > 0 || (s).padLeft > 0 || (s).padRight > 0)
+
+static int scale_needed(const IXCODE_AVCTXT_OUT_T *pOut, const VID_DIMENSIONS_T *pDimensionsIn) {
+
+  return (pOut->scale[0].forcescaler == 1 ||
+          pDimensionsIn->width != pOut->dim_enc.width ||
+          pDimensionsIn->height != pOut->dim_enc.height ||
+          pDimensionsIn->pix_fmt != pOut->dim_enc.pix_fmt);
+}
+
+static int scale_same(const IXCODE_AVCTXT_OUT_T *pOut1, const IXCODE_AVCTXT_OUT_T *pOut2) {
+  const IXCODE_AVCTXT_SCALE_T *pS1 = &pOut1->scale[0];
+  const IXCODE_AVCTXT_SCALE_T *pS2 = &pOut2->scale[0];
+
+  return (pOut1->dim_enc.width == pOut2->dim_enc.width &&
+          pOut1->dim_enc.height == pOut2->dim_enc.height &&
+          pOut1->dim_enc.pix_fmt == pOut2->dim_enc.pix_fmt &&
+          pS1->scalertype == pS2->scalertype &&
+          pS1->cropTop == pS2->cropTop && pS1->cropBottom == pS2->cropBottom &&
+          pS1->cropLeft == pS2->cropLeft && pS1->cropRight == pS2->cropRight &&
+          pS1->padTop == pS2->padTop && pS1->padBottom == pS2->padBottom &&
+          pS1->padLeft == pS2->padLeft && pS1->padRight == pS2->padRight &&
+          (!SCALE_HAVE_PAD(*pS1) || !memcmp(pS1->padRGB, pS2->padRGB, sizeof(pS1->padRGB))));
+}
+
+static int scale_graph_node(const IXCODE_VIDEO_CTXT_T *pXcode, unsigned int outidx,
+                            const VID_DIMENSIONS_T *pDimensionsIn) {
+  const IXCODE_AVCTXT_T *pAvCtx = (const IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+
+  //
+  // Rotation and raw (non-encoded) output write their own buffers, so are always scaled 
+  // directly from the decoded picture
+  //
+  return (pXcode->out[outidx].active && !pXcode->out[outidx].passthru &&
+          pAvCtx->out[outidx].encWrap.u.v.fEncode &&
+          !pXcode->out[outidx].rotate.common.active &&
+          scale_needed(&pAvCtx->out[outidx], pDimensionsIn));
+}
+
+static void build_scale_graph(IXCODE_VIDEO_CTXT_T *pXcode, const VID_DIMENSIONS_T *pDimensionsIn) {
+  IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  int shareIdx[IXCODE_VIDEO_OUT_MAX];
+  int srcIdx[IXCODE_VIDEO_OUT_MAX];
+  unsigned int order[IXCODE_VIDEO_OUT_MAX];
+  unsigned int outidx, idx, orderidx, numOrdered = 0;
+  unsigned int numScales = 0, numShared = 0, numCascaded = 0;
+  int width, height, bestIdx;
+  int changed = !pAvCtx->haveScaleGraph;
+  const VID_DIMENSIONS_T *pDim;
+
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+    shareIdx[outidx] = -1;
+    srcIdx[outidx] = -1;
+  }
+
+  //
+  // Any in-place drawing onto the scaled frame prevents it from being shared
+  //
+  if(!pXcode->pip.active && !pXcode->overlay.havePip && !pXcode->usewatermark) {
+
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+
+      if(!scale_graph_node(pXcode, outidx, pDimensionsIn) || FILTER_ENABLED(pXcode->out[outidx])) {
+        continue;
+      }
+
+      for(idx = 0; idx < outidx; idx++) {
+        if(shareIdx[idx] < 0 && scale_graph_node(pXcode, idx, pDimensionsIn) && 
+           !FILTER_ENABLED(pXcode->out[idx]) && scale_same(&pAvCtx->out[idx], &pAvCtx->out[outidx])) {
+          shareIdx[outidx] = idx;
+          numShared++;
+          break;
+        }
+      }
+    }
+
+    //
+    // Order the remaining outputs by decreasing picture area so that any cascade source is 
+    // decided and scaled before the outputs derived from it
+    //
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+      if(shareIdx[outidx] < 0 && scale_graph_node(pXcode, outidx, pDimensionsIn)) {
+        pDim = &pAvCtx->out[outidx].dim_enc;
+        for(orderidx = numOrdered; orderidx > 0 &&
+            pAvCtx->out[order[orderidx - 1]].dim_enc.width * pAvCtx->out[order[orderidx - 1]].dim_enc.height <
+            pDim->width * pDim->height; orderidx--) {
+          order[orderidx] = order[orderidx - 1];
+        }
+        order[orderidx] = outidx;
+        numOrdered++;
+      }
+    }
+
+    for(orderidx = 1; orderidx < numOrdered; orderidx++) {
+
+      outidx = order[orderidx];
+      if(SCALE_HAVE_CROP(pAvCtx->out[outidx].scale[0])) {
+        continue;
+      }
+
+      width = pAvCtx->out[outidx].dim_enc.width - pAvCtx->out[outidx].scale[0].padLeft - 
+                                                 pAvCtx->out[outidx].scale[0].padRight;
+      height = pAvCtx->out[outidx].dim_enc.height - pAvCtx->out[outidx].scale[0].padTop - 
+                                                   pAvCtx->out[outidx].scale[0].padBottom;
+      bestIdx = -1;
+
+      for(idx = 0; idx < orderidx; idx++) {
+
+        pDim = &pAvCtx->out[order[idx]].dim_enc;
+
+        if(srcIdx[order[idx]] >= 0 || 
+           SCALE_HAVE_CROP(pAvCtx->out[order[idx]].scale[0]) || 
+           SCALE_HAVE_PAD(pAvCtx->out[order[idx]].scale[0]) ||
+           pDim->pix_fmt != pAvCtx->out[outidx].dim_enc.pix_fmt ||
+           pDim->width < width || pDim->height < height ||
+           pDim->width * pDim->height >= pDimensionsIn->width * pDimensionsIn->height ||
+           pDim->width * pDim->height <= width * height) {
+          continue;
+        }
+
+        if(bestIdx < 0 || pDim->width * pDim->height < 
+           pAvCtx->out[bestIdx].dim_enc.width * pAvCtx->out[bestIdx].dim_enc.height) {
+          bestIdx = order[idx];
+        }
+      }
+
+      if(bestIdx >= 0) {
+        srcIdx[outidx] = bestIdx;
+        numCascaded++;
+      }
+    }
+
+  }
+
+  //
+  // Scale outputs from the decoded picture first, followed by shared and cascaded outputs
+  //
+  numOrdered = 0;
+  for(orderidx = 0; orderidx < 2; orderidx++) {
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+      if((shareIdx[outidx] >= 0 || srcIdx[outidx] >= 0) == (int) orderidx) {
+        order[numOrdered++] = outidx;
+      }
+    }
+  }
+
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+
+    if(pXcode->out[outidx].active && !pXcode->out[outidx].passthru && shareIdx[outidx] < 0 &&
+       scale_needed(&pAvCtx->out[outidx], pDimensionsIn)) {
+      numScales++;
+    }
+
+    if(changed || pAvCtx->out[outidx].scaleShareIdx != shareIdx[outidx] ||
+       pAvCtx->out[outidx].scaleSrcIdx != srcIdx[outidx]) {
+
+      //
+      // The scaler input dimensions depend on the source
+      //
+      if(pAvCtx->haveScaleGraph && pAvCtx->out[outidx].scaleSrcIdx != srcIdx[outidx] &&
+         pAvCtx->out[outidx].scale[0].pswsctx) {
+        sws_freeContext(pAvCtx->out[outidx].scale[0].pswsctx);
+        pAvCtx->out[outidx].scale[0].pswsctx = NULL;
+      }
+
+      pAvCtx->out[outidx].scaleShareIdx = shareIdx[outidx];
+      pAvCtx->out[outidx].scaleSrcIdx = srcIdx[outidx];
+      changed = 1;
+    }
+  }
+
+  memcpy(pAvCtx->scaleOrder, order, sizeof(pAvCtx->scaleOrder));
+  pAvCtx->haveScaleGraph = 1;
+
+  if(changed && numScales > 0) {
+    LOG(X_DEBUG("Video scaler graph has %d scale(s) per frame, saved: %d, cascaded: %d"), 
+                numScales, numShared, numCascaded);
+  }
+  pAvCtx->numScalesSaved = numShared;
+
+}
+
+static enum IXCODE_RC init_scalers(IXCODE_VIDEO_CTXT_T *pXcode, 
+                                   const VID_DIMENSIONS_T *pDimensionsIn[IXCODE_VIDEO_OUT_MAX],
+                                   const VID_DIMENSIONS_T *pDimensionsDec) {
+  IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  unsigned int outidx;
+  enum IXCODE_RC rc;
+
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+
+    pDimensionsIn[outidx] = pDimensionsDec;
+
+    if(!pXcode->out[outidx].active || pXcode->out[outidx].passthru) {
+      continue;
+    }
+
+    check_dimensions(pXcode, outidx, 0, 0);
+  }
+
+  build_scale_graph(pXcode, pDimensionsDec);
+
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+
+    if(!pXcode->out[outidx].active || pXcode->out[outidx].passthru || 
+       pAvCtx->out[outidx].scaleShareIdx >= 0) {
+      continue;
+    }
+
+    if(pAvCtx->out[outidx].scaleSrcIdx >= 0) {
+      pDimensionsIn[outidx] = &pAvCtx->out[pAvCtx->out[outidx].scaleSrcIdx].dim_enc;
+    }
+
+    //fprintf(stderr, "SHOULD I CALL INIT_SCALER tid:0x%x pXcode:0x%x outidx[%d], pip.active:%d wid:%d->%d, ht:%d->%d, pix_fmt:%d->%d, force:%d\n", pthread_self(), pXcode, outidx, pXcode->pip.active, pAvCtx->dim_in.width, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx])->width, pAvCtx->dim_in.height, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx])->height, pAvCtx->dim_in.pix_fmt, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx])->pix_fmt, pAvCtx->out[outidx].scale[0].forcescaler);
+
+    if(pAvCtx->out[outidx].scale[0].pswsctx == NULL &&
+      (pAvCtx->out[outidx].scale[0].forcescaler == 1 ||
+       pDimensionsIn[outidx]->width != OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx], 0)->width ||
+       pDimensionsIn[outidx]->height != OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx], 0)->height ||
+       pDimensionsIn[outidx]->pix_fmt != OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx], 0)->pix_fmt)) {
+
+      if((rc = init_scaler(pXcode, outidx, 0, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx], 0),
+                           pDimensionsIn[outidx])) != IXCODE_RC_OK) {
+        return rc;
+      }
+
+    }
+
+  } // end of for(outidx
+
+  return IXCODE_RC_OK;
+}
+
 static int ixcode_video_scale(IXCODE_VIDEO_CTXT_T *pXcode, 
                               AVFrame *pframesout[IXCODE_VIDEO_OUT_MAX],
                               AVFrame *pframein,
@@ -1316,21 +1748,28 @@ static int ixcode_video_scale(IXCODE_VIDEO_CTXT_T *pXcode,
                               unsigned int scaleIdx,
                               int is_pip) {
   int rc = 0;
-  unsigned int outidx;
+  unsigned int outidx, orderidx;
   IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
   VID_DIMENSIONS_T *pDimensionsOut;
+  const AVFrame *pframeSrc;
   unsigned int pipframeidx = 0;
+  int useGraph = (scaleIdx == 0 && !is_pip && pAvCtx->haveScaleGraph);
+  uint64_t tmStage = 0;
 
 #if defined(XCODE_PROFILE_VID)
    gettimeofday(&gtv[4], NULL); 
 #endif // XCODE_PROFILE_VID
 
+  IXCODE_STAGE_BEGIN(&pXcode->common, tmStage);
+
   if(is_pip && scaleIdx >= 2) {
     // This is the nth PIP output unique resolution 
     pipframeidx = scaleIdx - 1;
   }
 
-  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+  for(orderidx = 0; orderidx < IXCODE_VIDEO_OUT_MAX; orderidx++) {
+
+    outidx = useGraph ? pAvCtx->scaleOrder[orderidx] : orderidx;
 
     if(!pXcode->out[outidx].active || pXcode->out[outidx].passthru) {
       continue;
@@ -1338,10 +1777,23 @@ static int ixcode_video_scale(IXCODE_VIDEO_CTXT_T *pXcode,
 
     pDimensionsOut = is_pip ?  &pAvCtx->out[outidx].dim_pips[pipframeidx] : &pAvCtx->out[outidx].dim_enc;
 
+    //
+    // Re-use the identically scaled frame of another output
+    //
+    if(useGraph && pAvCtx->out[outidx].scaleShareIdx >= 0) {
+      *pframesout[outidx] = *pframesout[pAvCtx->out[outidx].scaleShareIdx];
+      pframesout[outidx]->pict_type = 0;
+      pframesout[outidx]->pts = pXcode->common.encodeInIdx;
+      continue;
+    }
+
+    pframeSrc = (useGraph && pAvCtx->out[outidx].scaleSrcIdx >= 0) ? 
+                pframesout[pAvCtx->out[outidx].scaleSrcIdx] : pframein;
+
     if(pAvCtx->out[outidx].scale[scaleIdx].pframeScaled) {
       *pframesout[outidx] = *(pAvCtx->out[outidx].scale[scaleIdx].pframeScaled);
     } else {
-      *pframesout[outidx] = *pframein;
+      *pframesout[outidx] = *pframeSrc;
     }
 
     if(!pAvCtx->out[outidx].encWrap.u.v.fEncode && (pout && lenOutRes)) {
@@ -1374,30 +1826,38 @@ static int ixcode_video_scale(IXCODE_VIDEO_CTXT_T *pXcode,
         pAvCtx->decIsImage++;
       }
       PIPXLOG("SCALE_FRAME pip.active:%d, outidx[%d].scale[%d].pframeScaled:0x%x decodeInIdx:%d -> %dx%d", pXcode->pip.active, outidx, scaleIdx, pAvCtx->out[outidx].scale[scaleIdx].pframeScaled, pXcode->common.decodeInIdx, pDimensionsOut->width, pDimensionsOut->height);
-      if((rc = scale_frame(pXcode, pframein, pframesout[outidx], outidx, scaleIdx,
+      if((rc = scale_frame(pXcode, pframeSrc, pframesout[outidx], outidx, scaleIdx,
                            pDimensionsOut, pDimensionsIn[outidx])) != IXCODE_RC_OK) {
         return rc;
       }
 
     }
 
-  } // end of for(outidx = 0 ...
+  } // end of for(orderidx = 0 ...
+
+  IXCODE_STAGE_END(&pXcode->common, tmStage, usScale, numScale);
 
 #if defined(XCODE_PROFILE_VID)
       gettimeofday(&gtv[5], NULL); 
       pAvCtx->prof.num_vscales++;
+      if(useGraph && !dupFrame) {
+        pAvCtx->prof.num_vscales_saved += pAvCtx->numScalesSaved;
+      }
 #endif // XCODE_PROFILE_VID
 
   return 0;
 }
 
 static int ixcode_video_decode(IXCODE_VIDEO_CTXT_T *pXcode,
+                               unsigned int *pdecodeInIdx,
+                               unsigned int *pdecodeOutIdx,
                                unsigned char *bufIn,
                                unsigned int lenIn,
                                int *pdupFrame,
                                AVFrame **ppframein) {
 
   int lenRaw = 0;
+  uint64_t tmStage = 0;
   IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
 
   pAvCtx->framedecidx = pAvCtx->framedecidxok == 0 ? 1 : 0;
@@ -1419,18 +1879,20 @@ static int ixcode_video_decode(IXCODE_VIDEO_CTXT_T *pXcode,
 
     avcodec_get_frame_defaults(*ppframein);
 
-    pXcode->common.decodeInIdx++;
+    (*pdecodeInIdx)++;
 
 #if defined(XCODE_PROFILE_VID)
     gettimeofday(&gtv[2], NULL);
 #endif // XCODE_PROFILE_VID
 
+    IXCODE_STAGE_BEGIN(&pXcode->common, tmStage);
+
     if(pAvCtx->decWrap.u.v.fDecode) {
 
       if(pXcode->common.cfgNoDecode) {
         *ppframein = &pAvCtx->framedec[pAvCtx->framedecidxok];
         lenRaw = 1;
-      } else if(pAvCtx->decIsImage && pXcode->common.decodeInIdx > 1) {
+      } else if(pAvCtx->decIsImage && *pdecodeInIdx > 1) {
         *ppframein = &pAvCtx->framedec[pAvCtx->framedecidxok];
         //*ppframein = &pAvCtx->framedec[1];
         lenRaw = 1;
@@ -1473,6 +1935,8 @@ static int ixcode_video_decode(IXCODE_VIDEO_CTXT_T *pXcode,
 
     }
 
+    IXCODE_STAGE_END(&pXcode->common, tmStage, usDecode, numDecode);
+
 #if defined(XCODE_PROFILE_VID)
     gettimeofday(&gtv[3], NULL);
     pAvCtx->prof.num_vdecodes++;
@@ -1480,7 +1944,7 @@ static int ixcode_video_decode(IXCODE_VIDEO_CTXT_T *pXcode,
 
     if((pAvCtx->havePrevVidFrame && lenRaw > 0)) {
 
-      pXcode->common.decodeOutIdx++;
+      (*pdecodeOutIdx)++;
 
   //fprintf(stderr, "DEC_PIX_FMT:%d, %dx%d, lenRaw:%d\n",pAvCtx->dec_pix_fmt, pAvCtx->dec_width, pAvCtx->dec_height, lenRaw);
   //if(pXcode->common.decodeOutIdx%10 == 0) dumpyuv(*ppframein, pAvCtx->dec_width, pAvCtx->dec_height);
@@ -1529,6 +1993,8 @@ static int ixcode_video_encode(IXCODE_VIDEO_CTXT_T *pXcode,
 
   unsigned int outidx;
   unsigned int bufOutIdx = 0;
+  uint64_t tmStage = 0;
+  uint64_t tmEncode = 0;
   IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
 
   //fprintf(stderr, "encode_video[%d]\n", pXcode->common.encodeOutIdx);
@@ -1537,7 +2003,7 @@ static int ixcode_video_encode(IXCODE_VIDEO_CTXT_T *pXcode,
   gettimeofday(&gtv[6], NULL);
 #endif // XCODE_PROFILE_VID
 
-  pXcode->common.encodeInIdx++;
+  IXCODE_STAGE_BEGIN(&pXcode->common, tmStage);
 
   for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
 
@@ -1560,6 +2026,10 @@ static int ixcode_video_encode(IXCODE_VIDEO_CTXT_T *pXcode,
 
       //LOG(X_DEBUG("fEncode outidx:%d, linesize:%d,%d,%d,%d"), outidx, pframesout[outidx]->linesize[0], pframesout[outidx]->linesize[1], pframesout[outidx]->linesize[2], pframesout[outidx]->linesize[3]);
 
+        if(pAvCtx->governorOn) {
+          tmEncode = ixcode_stage_time_us();
+        }
+
         //fprintf(stderr, "encode_video data[0]:0x%x -> 0x%x\n", pframesout[outidx]->data[0], &pout->buf[bufOutIdx]);
         lenOutRes[outidx] = pAvCtx->out[outidx].encWrap.u.v.fEncode(
                                                      &pAvCtx->out[outidx].encWrap.u.v.ctxt,
@@ -1567,6 +2037,11 @@ static int ixcode_video_encode(IXCODE_VIDEO_CTXT_T *pXcode,
                                                      pframesout[outidx],
                                                      &pout->buf[bufOutIdx], 
                                                      pout->lenbuf - bufOutIdx);
+
+        if(pAvCtx->governorOn) {
+          pXcode->out[outidx].governor.usEncodeTot += ixcode_stage_time_us() - tmEncode;
+          pXcode->out[outidx].governor.numEncode++;
+        }
         //static int g_encodeidx; fprintf(stderr, "ENCODE_VIDEO [%d] [outidx:%d] len-out:%d, frameType:%s, in:0x%x out:0x%x { [bufOutIdx:%d]: 0x%x 0x%x 0x%x 0x%x }\n", g_encodeidx++, outidx, lenOutRes[outidx], pXcode->out[outidx].frameType == FRAME_TYPE_I ? "I\n\n\n" : pXcode->out[outidx].frameType == FRAME_TYPE_P ? "P" : pXcode->out[outidx].frameType == FRAME_TYPE_B ? "B" : "", (int64_t)pframesout[outidx]%16, (int64_t)(&pout->buf[bufOutIdx])%16, bufOutIdx, pout->buf[bufOutIdx], pout->buf[bufOutIdx+1],pout->buf[bufOutIdx+2],pout->buf[bufOutIdx+3]);
 
 //lenOutRes[outidx] = 0;
@@ -1593,6 +2068,12 @@ static int ixcode_video_encode(IXCODE_VIDEO_CTXT_T *pXcode,
 
   } // end of for(outidx ...
 
+  IXCODE_STAGE_END(&pXcode->common, tmStage, usEncode, numEncode);
+
+  if(pAvCtx->governorOn) {
+    governor_update(pXcode);
+  }
+
 #if defined(XCODE_PROFILE_VID)
   gettimeofday(&gtv[7], NULL); 
   pAvCtx->prof.num_vencodes++;
@@ -1629,7 +2110,6 @@ static enum IXCODE_RC encode_shared_pip_out(IXCODE_VIDEO_CTXT_T *pXcode) {
   const VID_DIMENSIONS_T *pDimensionsIn[IXCODE_VIDEO_OUT_MAX];
   unsigned int outidx;
   int width, height;
-  unsigned int sz;
   AVFrame frameIn;
   AVFrame *pframeIn;
 
@@ -1652,8 +2132,8 @@ static enum IXCODE_RC encode_shared_pip_out(IXCODE_VIDEO_CTXT_T *pXcode) {
 
     if(!pAvCtx->out[0].pPipBufEncoderIn) {
       //sz = avpicture_get_size(PIX_FMT_YUVA420P, pAvCtxOverlay->out[0].dim_enc.width,
-      sz = avpicture_get_size(pAvCtxOverlay->out[0].dim_enc.pix_fmt, width, height);
-      if(!(pAvCtx->out[0].pPipBufEncoderIn = av_malloc(sz))) {
+      if(!(pAvCtx->out[0].pPipBufEncoderIn = framepool_get(pAvCtxOverlay->out[0].dim_enc.pix_fmt, 
+                                                           width, height))) {
         return IXCODE_RC_ERROR;
       }
     }
@@ -1704,9 +2184,9 @@ static enum IXCODE_RC encode_shared_pip_out(IXCODE_VIDEO_CTXT_T *pXcode) {
     pframeIn = &pAvCtxOverlay->out[0].scale[0].frameenc;
 
     if(!pAvCtx->out[0].pPipBufEncoderIn) {
-      sz = avpicture_get_size(pAvCtxOverlay->out[0].dim_enc.pix_fmt, pAvCtxOverlay->out[0].dim_enc.width, 
-                              pAvCtxOverlay->out[0].dim_enc.height);
-      if(!(pAvCtx->out[0].pPipBufEncoderIn = av_malloc(sz))) {
+      if(!(pAvCtx->out[0].pPipBufEncoderIn = framepool_get(pAvCtxOverlay->out[0].dim_enc.pix_fmt, 
+                                                           pAvCtxOverlay->out[0].dim_enc.width, 
+                                                           pAvCtxOverlay->out[0].dim_enc.height))) {
         pthread_mutex_unlock(&pXcode->pip.pXOverlay->overlay.mtx);
         return IXCODE_RC_ERROR;
       }
@@ -1760,6 +2240,442 @@ static enum IXCODE_RC encode_shared_pip_out(IXCODE_VIDEO_CTXT_T *pXcode) {
   return rc;
 }
 
+//
+// Pipelined transcoding
+//
+// The decoder and the scaler + filters each run on their own thread, handing frames
+// along a ring of XCODE_VIDPIPE_T slots.  The encoder is run by the caller of ixcode_frame_vid, 
+// so that encoder state and any per frame output attributes are only ever accessed 
+// from one thread.  The output of ixcode_frame_vid lags the input by (depth - 1) frames,
+// which is reflected in the encodeInIdx / encodeOutIdx counters used to compute 
+// the encoder delay.
+//
+
+static int vidpipe_can_run(const IXCODE_VIDEO_CTXT_T *pXcode) {
+  const IXCODE_AVCTXT_T *pAvCtx = (const IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  unsigned int outidx;
+
+  if(pXcode->cfgPipelineDepth <= 1 || pXcode->pip.active || pXcode->overlay.havePip) {
+    return 0;
+  }
+
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+    if(pXcode->out[outidx].active && 
+       (pXcode->out[outidx].passthru || !pAvCtx->out[outidx].encWrap.u.v.fEncode)) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static int vidpipe_copy_frame(AVFrame *pframeDst, VID_DIMENSIONS_T *pDimensionsDst,
+                              const AVFrame *pframeSrc, const VID_DIMENSIONS_T *pDimensionsSrc) {
+
+  if(!pframeDst->data[0] || 
+     pDimensionsDst->width != pDimensionsSrc->width ||
+     pDimensionsDst->height != pDimensionsSrc->height ||
+     pDimensionsDst->pix_fmt != pDimensionsSrc->pix_fmt) {
+
+    if(pframeDst->data[0]) {
+      framepool_picture_free((AVPicture *) pframeDst);
+    }
+    avcodec_get_frame_defaults(pframeDst);
+    memset(pDimensionsDst, 0, sizeof(VID_DIMENSIONS_T));
+
+    if(framepool_picture_alloc((AVPicture *) pframeDst, pDimensionsSrc->pix_fmt, 
+                       pDimensionsSrc->width, pDimensionsSrc->height) < 0) {
+      LOG(X_ERROR("Failed to allocate pipeline video frame %dx%d"), 
+                  pDimensionsSrc->width, pDimensionsSrc->height);
+      return IXCODE_RC_ERROR;
+    }
+    memcpy(pDimensionsDst, pDimensionsSrc, sizeof(VID_DIMENSIONS_T));
+  }
+
+  av_picture_copy((AVPicture *) pframeDst, (const AVPicture *) pframeSrc, 
+                  pDimensionsSrc->pix_fmt, pDimensionsSrc->width, pDimensionsSrc->height);
+
+  return IXCODE_RC_OK;
+}
+
+static void vidpipe_decode(IXCODE_VIDEO_CTXT_T *pXcode, XCODE_VIDPIPE_SLOT_T *pSlot) {
+  IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  XCODE_VIDPIPE_T *pPipe = pAvCtx->pVidPipe;
+  unsigned int decodeOutIdx = pPipe->decodeOutIdx;
+  AVFrame *pframein = NULL;
+  int dupFrame = 0;
+  int lenRaw;
+
+  if((lenRaw = ixcode_video_decode(pXcode, &pPipe->decodeInIdx, &pPipe->decodeOutIdx,
+                                   pSlot->lenIn > 0 ? pSlot->pBufIn : NULL, pSlot->lenIn, 
+                                   &dupFrame, &pframein)) < 0) {
+    pSlot->rc = lenRaw;
+    return;
+  }
+
+  pSlot->dupFrame = dupFrame;
+  pSlot->decoded = (pPipe->decodeOutIdx != decodeOutIdx);
+
+  if(pSlot->doEncode && (dupFrame || (pAvCtx->havePrevVidFrame && lenRaw > 0))) {
+
+    //
+    // The decoder owns pframein until the next decode, so the picture is copied into the slot
+    //
+    if((pSlot->rc = vidpipe_copy_frame(&pSlot->framedec, &pSlot->dimDec, 
+                                       pframein, &pAvCtx->dim_in)) == IXCODE_RC_OK) {
+      pSlot->havePic = 1;
+    }
+  }
+
+}
+
+static void vidpipe_scale(IXCODE_VIDEO_CTXT_T *pXcode, XCODE_VIDPIPE_SLOT_T *pSlot) {
+  IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  const VID_DIMENSIONS_T *pDimensionsIn[IXCODE_VIDEO_OUT_MAX];
+  const VID_DIMENSIONS_T *pDimensionsOut;
+  AVFrame *pframesout[IXCODE_VIDEO_OUT_MAX];
+  unsigned int outidx;
+  enum IXCODE_RC rc;
+
+  if(pSlot->rc < 0 || !pSlot->havePic) {
+    return;
+  }
+
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+    pframesout[outidx] = &pAvCtx->out[outidx].scale[0].frameenc;
+  }
+
+  if((rc = init_scalers(pXcode, pDimensionsIn, &pSlot->dimDec)) != IXCODE_RC_OK) {
+    pSlot->rc = rc;
+    return;
+  }
+
+  if(ixcode_video_scale(pXcode, pframesout, &pSlot->framedec, pSlot->dupFrame, NULL, NULL,
+                        pDimensionsIn, 0, 0) < 0) {
+    pSlot->rc = IXCODE_RC_ERROR_ENCODE;
+    return;
+  }
+
+#if defined(XCODE_HAVE_PIP) && (XCODE_HAVE_PIP > 0)
+
+  if(!pSlot->dupFrame && pXcode->usewatermark) {
+
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+
+      if(!pXcode->out[outidx].active) {
+        continue;
+      }
+
+      pip_mark(pframesout[outidx]->data, pframesout[outidx]->linesize, 
+               pAvCtx->out[outidx].dim_enc.height ?  pAvCtx->out[outidx].dim_enc.height : pSlot->dimDec.height);
+    }
+  }
+
+#endif // XCODE_HAVE_PIP
+
+#if (XCODE_FILTER_ON)
+
+  runfilters(pXcode, pframesout, 0);
+
+#endif // XCODE_FILTER_ON
+
+  //
+  // The scaler and filter output buffers are re-used for the next frame, so the 
+  // encoder input picture is copied into the slot
+  //
+  for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+
+    if(!pXcode->out[outidx].active) {
+      continue;
+    }
+
+    pDimensionsOut = pAvCtx->out[outidx].dim_enc.width > 0 ? &pAvCtx->out[outidx].dim_enc : &pSlot->dimDec;
+
+    if((pSlot->rc = vidpipe_copy_frame(&pSlot->framesout[outidx], &pSlot->dimsOut[outidx],
+                                       pframesout[outidx], pDimensionsOut)) != IXCODE_RC_OK) {
+      return;
+    }
+    pSlot->framesout[outidx].pict_type = 0;
+  }
+
+}
+
+static void *vidpipe_decode_proc(void *pArg) {
+  IXCODE_VIDEO_CTXT_T *pXcode = (IXCODE_VIDEO_CTXT_T *) pArg;
+  XCODE_VIDPIPE_T *pPipe = ((IXCODE_AVCTXT_T *) pXcode->common.pPrivData)->pVidPipe;
+  XCODE_VIDPIPE_SLOT_T *pSlot;
+
+  pthread_mutex_lock(&pPipe->mtx);
+
+  while(pPipe->running) {
+
+    pSlot = &pPipe->slots[pPipe->idxDecode];
+    if(pSlot->state != XCODE_VIDPIPE_SLOT_INPUT) {
+      pthread_cond_wait(&pPipe->cond, &pPipe->mtx);
+      continue;
+    }
+
+    pthread_mutex_unlock(&pPipe->mtx);
+
+    vidpipe_decode(pXcode, pSlot);
+
+    pthread_mutex_lock(&pPipe->mtx);
+    pSlot->state = XCODE_VIDPIPE_SLOT_DECODED;
+    pPipe->idxDecode = (pPipe->idxDecode + 1) % pPipe->depth;
+    pthread_cond_broadcast(&pPipe->cond);
+  }
+
+  pthread_mutex_unlock(&pPipe->mtx);
+
+  return NULL;
+}
+
+static void *vidpipe_scale_proc(void *pArg) {
+  IXCODE_VIDEO_CTXT_T *pXcode = (IXCODE_VIDEO_CTXT_T *) pArg;
+  XCODE_VIDPIPE_T *pPipe = ((IXCODE_AVCTXT_T *) pXcode->common.pPrivData)->pVidPipe;
+  XCODE_VIDPIPE_SLOT_T *pSlot;
+
+  pthread_mutex_lock(&pPipe->mtx);
+
+  while(pPipe->running) {
+
+    pSlot = &pPipe->slots[pPipe->idxScale];
+    if(pSlot->state != XCODE_VIDPIPE_SLOT_DECODED) {
+      pthread_cond_wait(&pPipe->cond, &pPipe->mtx);
+      continue;
+    }
+
+    pthread_mutex_unlock(&pPipe->mtx);
+
+    vidpipe_scale(pXcode, pSlot);
+
+    pthread_mutex_lock(&pPipe->mtx);
+    pSlot->state = XCODE_VIDPIPE_SLOT_SCALED;
+    pPipe->idxScale = (pPipe->idxScale + 1) % pPipe->depth;
+    pthread_cond_broadcast(&pPipe->cond);
+  }
+
+  pthread_mutex_unlock(&pPipe->mtx);
+
+  return NULL;
+}
+
+static void vidpipe_stop(IXCODE_VIDEO_CTXT_T *pXcode) {
+  IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  XCODE_VIDPIPE_T *pPipe;
+  XCODE_VIDPIPE_SLOT_T *pSlot;
+  unsigned int idx, outidx;
+
+  if(!pAvCtx || !(pPipe = pAvCtx->pVidPipe)) {
+    return;
+  }
+
+  pthread_mutex_lock(&pPipe->mtx);
+
+  //
+  // Let the decoder finish every queued frame so that the decoder state and frame counters
+  // are consistent if decoding continues on the caller's thread
+  //
+  if(pPipe->haveTdDecode && pPipe->haveTdScale && pPipe->numInFlight > 0) {
+    pSlot = &pPipe->slots[(pPipe->idxOut + pPipe->numInFlight - 1) % pPipe->depth];
+    while(pSlot->state != XCODE_VIDPIPE_SLOT_SCALED) {
+      pthread_cond_wait(&pPipe->cond, &pPipe->mtx);
+    }
+  }
+
+  pPipe->running = 0;
+  pthread_cond_broadcast(&pPipe->cond);
+  pthread_mutex_unlock(&pPipe->mtx);
+
+  if(pPipe->haveTdDecode) {
+    pthread_join(pPipe->tdDecode, NULL);
+  }
+  if(pPipe->haveTdScale) {
+    pthread_join(pPipe->tdScale, NULL);
+  }
+
+  //
+  // Frames still queued for the encoder are dropped.  vidpipe_frame counted them as being 
+  // in the decoder and encoder, so the counters are rolled back to what was actually decoded
+  // and encoded, keeping the encoder delay and output pts accounting intact.
+  //
+  if(pPipe->numInFlight > 0) {
+
+    for(idx = 0; idx < pPipe->numInFlight; idx++) {
+      pSlot = &pPipe->slots[(pPipe->idxOut + idx) % pPipe->depth];
+      if(pSlot->doEncode) {
+        pXcode->common.encodeInIdx--;
+      }
+    }
+    pXcode->common.decodeInIdx = pPipe->decodeInIdx;
+    pXcode->common.decodeOutIdx = pPipe->decodeOutIdx;
+
+    LOG(X_DEBUG("Discarding %d video frame(s) queued in transcoder pipeline"), pPipe->numInFlight);
+  }
+
+  for(idx = 0; idx < IXCODE_VIDEO_PIPELINE_MAX; idx++) {
+    if(pPipe->slots[idx].pBufIn) {
+      av_free(pPipe->slots[idx].pBufIn);
+    }
+    if(pPipe->slots[idx].framedec.data[0]) {
+      framepool_picture_free((AVPicture *) &pPipe->slots[idx].framedec);
+    }
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+      if(pPipe->slots[idx].framesout[outidx].data[0]) {
+        framepool_picture_free((AVPicture *) &pPipe->slots[idx].framesout[outidx]);
+      }
+    }
+  }
+
+  pthread_cond_destroy(&pPipe->cond);
+  pthread_mutex_destroy(&pPipe->mtx);
+  free(pPipe);
+  pAvCtx->pVidPipe = NULL;
+
+}
+
+static int vidpipe_start(IXCODE_VIDEO_CTXT_T *pXcode) {
+  IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  XCODE_VIDPIPE_T *pPipe;
+
+  if(!(pPipe = (XCODE_VIDPIPE_T *) calloc(1, sizeof(XCODE_VIDPIPE_T)))) {
+    return -1;
+  }
+
+  pPipe->depth = MIN(pXcode->cfgPipelineDepth, IXCODE_VIDEO_PIPELINE_MAX);
+  pPipe->decodeInIdx = pXcode->common.decodeInIdx;
+  pPipe->decodeOutIdx = pXcode->common.decodeOutIdx;
+  pPipe->running = 1;
+  pthread_mutex_init(&pPipe->mtx, NULL);
+  pthread_cond_init(&pPipe->cond, NULL);
+  pAvCtx->pVidPipe = pPipe;
+
+  if(pthread_create(&pPipe->tdDecode, NULL, vidpipe_decode_proc, pXcode) != 0) {
+    LOG(X_ERROR("Unable to create video transcoder pipeline decoder thread"));
+    vidpipe_stop(pXcode);
+    return -1;
+  }
+  pPipe->haveTdDecode = 1;
+
+  if(pthread_create(&pPipe->tdScale, NULL, vidpipe_scale_proc, pXcode) != 0) {
+    LOG(X_ERROR("Unable to create video transcoder pipeline scaler thread"));
+    vidpipe_stop(pXcode);
+    return -1;
+  }
+  pPipe->haveTdScale = 1;
+
+  LOG(X_DEBUG("Started video transcoder pipeline with depth %d"), pPipe->depth);
+
+  return 0;
+}
+
+static enum IXCODE_RC vidpipe_frame(IXCODE_VIDEO_CTXT_T *pXcode, 
+                                    unsigned char *bufIn, 
+                                    unsigned int lenIn,
+                                    IXCODE_OUTBUF_T *pout) {
+
+  IXCODE_AVCTXT_T *pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+  XCODE_VIDPIPE_T *pPipe = pAvCtx->pVidPipe;
+  XCODE_VIDPIPE_SLOT_T *pSlot;
+  AVFrame *pframesout[IXCODE_VIDEO_OUT_MAX];
+  int lenOutRes[IXCODE_VIDEO_OUT_MAX];
+  enum IXCODE_RC rc = IXCODE_RC_OK;
+  unsigned int outidx;
+
+  if(!bufIn) {
+    lenIn = 0;
+  }
+
+  //
+  // Queue the input frame.  The input slot is always free here since a slot is 
+  // retired on every call once the pipeline is full.
+  //
+  pSlot = &pPipe->slots[pPipe->idxIn];
+
+  if(lenIn + FF_INPUT_BUFFER_PADDING_SIZE > pSlot->allocIn) {
+    if(pSlot->pBufIn) {
+      av_free(pSlot->pBufIn);
+    }
+    pSlot->allocIn = lenIn + FF_INPUT_BUFFER_PADDING_SIZE;
+    if(!(pSlot->pBufIn = av_malloc(pSlot->allocIn))) {
+      pSlot->allocIn = 0;
+      return IXCODE_RC_ERROR;
+    }
+  }
+  if(lenIn > 0) {
+    memcpy(pSlot->pBufIn, bufIn, lenIn);
+  }
+  memset(&pSlot->pBufIn[lenIn], 0, FF_INPUT_BUFFER_PADDING_SIZE);
+  pSlot->lenIn = lenIn;
+  pSlot->rc = IXCODE_RC_OK;
+  pSlot->dupFrame = 0;
+  pSlot->decoded = 0;
+  pSlot->havePic = 0;
+  pSlot->doEncode = (lenIn == 0 || pXcode->common.inpts90Khz + 150 >= pXcode->common.outpts90Khz);
+
+  //
+  // Frames in the pipeline are counted as being in the encoder, so that the encoder delay 
+  // includes the pipeline latency
+  //
+  if(lenIn > 0) {
+    pXcode->common.decodeInIdx++;
+  }
+  if(pSlot->doEncode) {
+    pXcode->common.encodeInIdx++;
+  }
+
+  pthread_mutex_lock(&pPipe->mtx);
+  pSlot->state = XCODE_VIDPIPE_SLOT_INPUT;
+  pPipe->idxIn = (pPipe->idxIn + 1) % pPipe->depth;
+  pPipe->numInFlight++;
+  pthread_cond_broadcast(&pPipe->cond);
+
+  if(pPipe->numInFlight < pPipe->depth) {
+    pthread_mutex_unlock(&pPipe->mtx);
+    return IXCODE_RC_OK;
+  }
+
+  //
+  // Wait for the oldest frame to come out of the scaler
+  //
+  pSlot = &pPipe->slots[pPipe->idxOut];
+  while(pSlot->state != XCODE_VIDPIPE_SLOT_SCALED) {
+    pthread_cond_wait(&pPipe->cond, &pPipe->mtx);
+  }
+
+  pthread_mutex_unlock(&pPipe->mtx);
+
+  if(pSlot->decoded) {
+    pXcode->common.decodeOutIdx++;
+  }
+  if(pSlot->doEncode && (pSlot->rc < 0 || !pSlot->havePic)) {
+    pXcode->common.encodeInIdx--;
+  }
+
+  if(pSlot->rc < 0) {
+    rc = pSlot->rc;
+  } else if(pSlot->doEncode && pSlot->havePic) {
+
+    for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
+      lenOutRes[outidx] = 0;
+      pframesout[outidx] = &pSlot->framesout[outidx];
+      pframesout[outidx]->pts = pPipe->encodeIdx;
+    }
+    pPipe->encodeIdx++;
+
+    ixcode_video_encode(pXcode, lenOutRes, pframesout, pout);
+    rc = (enum IXCODE_RC) lenOutRes[0];
+  }
+
+  pthread_mutex_lock(&pPipe->mtx);
+  pSlot->state = XCODE_VIDPIPE_SLOT_FREE;
+  pPipe->idxOut = (pPipe->idxOut + 1) % pPipe->depth;
+  pPipe->numInFlight--;
+  pthread_mutex_unlock(&pPipe->mtx);
+
+  return rc;
+}
+
 enum IXCODE_RC ixcode_frame_vid(IXCODE_VIDEO_CTXT_T *pXcode, 
                                 unsigned char *bufIn, 
                                 unsigned int lenIn,
@@ -1774,7 +2690,6 @@ enum IXCODE_RC ixcode_frame_vid(IXCODE_VIDEO_CTXT_T *pXcode,
   int doPipAdd = 0;
   unsigned int outidx;
   const VID_DIMENSIONS_T *pDimensionsIn[IXCODE_VIDEO_OUT_MAX];
-  const VID_DIMENSIONS_T *pDimensionsInTmp[IXCODE_VIDEO_OUT_MAX];
   AVFrame *pframein = NULL;
   AVFrame *pframesout[IXCODE_VIDEO_OUT_MAX];
   AVFrame *pframesoutTmp[IXCODE_VIDEO_OUT_MAX];
@@ -1802,6 +2717,18 @@ enum IXCODE_RC ixcode_frame_vid(IXCODE_VIDEO_CTXT_T *pXcode,
   }
 
   pAvCtx = (IXCODE_AVCTXT_T *) pXcode->common.pPrivData;
+
+  //
+  // Run the decoder, scaler and encoder as pipelined stages 
+  //
+  if(vidpipe_can_run(pXcode)) {
+    if(pAvCtx->pVidPipe || vidpipe_start(pXcode) == 0) {
+      return vidpipe_frame(pXcode, bufIn, lenIn, pout);
+    }
+  } else if(pAvCtx->pVidPipe) {
+    vidpipe_stop(pXcode);
+  }
+
   for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
     lenOutRes[outidx] = 0;
     pframesout[outidx] = &pAvCtx->out[outidx].scale[0].frameenc;
@@ -1811,7 +2738,8 @@ enum IXCODE_RC ixcode_frame_vid(IXCODE_VIDEO_CTXT_T *pXcode,
   //
   // Decode the encoded frame
   //
-  if((lenRaw = ixcode_video_decode(pXcode, bufIn, lenIn, &dupFrame, &pframein)) < 0) {
+  if((lenRaw = ixcode_video_decode(pXcode, &pXcode->common.decodeInIdx, &pXcode->common.decodeOutIdx,
+                                    bufIn, lenIn, &dupFrame, &pframein)) < 0) {
     return (enum IXCODE_RC) lenRaw;
   }
 
@@ -1841,36 +2769,9 @@ enum IXCODE_RC ixcode_frame_vid(IXCODE_VIDEO_CTXT_T *pXcode,
       //
       // Initialize any scaler(s)
       //
-      for(outidx = 0; outidx < IXCODE_VIDEO_OUT_MAX; outidx++) {
-
-        pDimensionsIn[outidx] = &pAvCtx->dim_in; 
-        pDimensionsInTmp[outidx] = &pAvCtx->dim_in; 
-
-        if(!pXcode->out[outidx].active || pXcode->out[outidx].passthru) {
-          continue;
-        }
-
-        check_dimensions(pXcode, outidx, 0, 0);
-
-        //fprintf(stderr, "SHOULD I CALL INIT_SCALER tid:0x%x pXcode:0x%x outidx[%d], pip.active:%d wid:%d->%d, ht:%d->%d, pix_fmt:%d->%d, force:%d\n", pthread_self(), pXcode, outidx, pXcode->pip.active, pAvCtx->dim_in.width, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx])->width, pAvCtx->dim_in.height, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx])->height, pAvCtx->dim_in.pix_fmt, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx])->pix_fmt, pAvCtx->out[outidx].scale[0].forcescaler);
-
-
-        if(pAvCtx->out[outidx].scale[0].pswsctx == NULL &&
-          (pAvCtx->out[outidx].scale[0].forcescaler == 1 ||
-           pAvCtx->dim_in.width != OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx], 0)->width ||
-           pAvCtx->dim_in.height != OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx], 0)->height ||
-           pAvCtx->dim_in.pix_fmt != OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx], 0)->pix_fmt)) {
-
-        //fprintf(stderr, "XCODE... CALLING INIT_SCALERtid:0x%x pXcode:0x%x outidx[%d], pip.active:%d wid:%d->%d, ht:%d->%d, pix_fmt:%d->%d, force:%d\n", pthread_self(), pXcode, outidx, pXcode->pip.active, pAvCtx->dim_in.width, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx])->width, pAvCtx->dim_in.height, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx])->height, pAvCtx->dim_in.pix_fmt, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx])->pix_fmt, pAvCtx->out[outidx].scale[0].forcescaler);
-
-          if((rc = init_scaler(pXcode, outidx, 0, OUT_DIMENSIONS(pXcode, pAvCtx->out[outidx], 0),
-                               &pAvCtx->dim_in)) != IXCODE_RC_OK) {
-            return rc;
-          }
-
-        } // end of if(pXcode->out[outidx].active
-
-      } // end of for(outidx
+      if((rc = init_scalers(pXcode, pDimensionsIn, &pAvCtx->dim_in)) != IXCODE_RC_OK) {
+        return rc;
+      }
 
       //
       // Resize the raw image
@@ -2021,6 +2922,7 @@ enum IXCODE_RC ixcode_frame_vid(IXCODE_VIDEO_CTXT_T *pXcode,
       //
       // Encode the video frame
       //
+      pXcode->common.encodeInIdx++;
       if(ixcode_video_encode(pXcode, lenOutRes, pframesout, pout) < 0) {
       
       }
@@ -2047,7 +2949,7 @@ enum IXCODE_RC ixcode_frame_vid(IXCODE_VIDEO_CTXT_T *pXcode,
   pAvCtx->prof.tottime_v +=       (uint64_t)  ((gtv[1].tv_sec-gtv[0].tv_sec)*1000000)+
                                  ((gtv[1].tv_usec-gtv[0].tv_usec));
 
-  LOG(X_DEBUG("xcode_vid done in %ld(%.1f) (dec:%ld(%.1f), scale:%ld(%.1f) filter:%ld(%.1f) rotate:%ld(%.1f) ovl:%ld(%.1f), enc:%ld(%.1f)) (len:%d)"), 
+  LOG(X_DEBUG("xcode_vid done in %ld(%.1f) (dec:%ld(%.1f), scale:%ld(%.1f) saved:%.2f/fr filter:%ld(%.1f) rotate:%ld(%.1f) ovl:%ld(%.1f), enc:%ld(%.1f)) (len:%d)"), 
 
      (uint32_t)((gtv[1].tv_sec-gtv[0].tv_sec)*1000000)+((gtv[1].tv_usec-gtv[0].tv_usec)),
      (float)pAvCtx->prof.tottime_v / pAvCtx->prof.num_v/1000.0f,
@@ -2056,6 +2958,7 @@ enum IXCODE_RC ixcode_frame_vid(IXCODE_VIDEO_CTXT_T *pXcode,
      pAvCtx->prof.num_vdecodes > 0 ? (float)pAvCtx->prof.tottime_vdecodes / pAvCtx->prof.num_vdecodes/1000.0f : 0,
      ((gtv[5].tv_sec-gtv[4].tv_sec)*1000000)+((gtv[5].tv_usec-gtv[4].tv_usec)),
      pAvCtx->prof.num_vscales > 0 ? (float)pAvCtx->prof.tottime_vscales / pAvCtx->prof.num_vscales/1000.0f : 0,
+     pAvCtx->prof.num_vscales > 0 ? (float)pAvCtx->prof.num_vscales_saved / pAvCtx->prof.num_vscales : 0,
 
      ((gtv[11].tv_sec-gtv[10].tv_sec)*1000000)+((gtv[11].tv_usec-gtv[10].tv_usec)),
      pAvCtx->prof.num_vfilters > 0 ? (float)pAvCtx->prof.tottime_vfilters / pAvCtx->prof.num_vfilters/1000.0f : 0,
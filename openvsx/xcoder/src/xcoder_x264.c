@@ -562,6 +562,73 @@ static int xcoder_x264_reinit(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx) {
   return 0;
 }
 
+//
+// Encoder speed levels used by the encoder governor.  Each level caps the analysis
+// settings which x264_encoder_reconfig can change on the fly, roughly following the
+// faster, veryfast, superfast and ultrafast presets.  Presets themselves cannot be
+// switched without re-opening the encoder.
+//
+static const struct X264_SPEED_LEVEL {
+  const char *name;
+  int         subme;
+  int         refs;
+  int         me;
+  int         inter;
+} g_x264_speed[IXCODE_GOVERNOR_LEVEL_MAX + 1] = {
+  { "configured", 11, 16, X264_ME_TESA, -1 },
+  { "faster",      4,  2, X264_ME_HEX, X264_ANALYSE_I8x8 | X264_ANALYSE_I4x4 | X264_ANALYSE_PSUB16x16 | 
+                                       X264_ANALYSE_BSUB16x16 },
+  { "veryfast",    2,  1, X264_ME_HEX, X264_ANALYSE_I8x8 | X264_ANALYSE_I4x4 },
+  { "superfast",   1,  1, X264_ME_DIA, X264_ANALYSE_I8x8 | X264_ANALYSE_I4x4 },
+  { "ultrafast",   0,  1, X264_ME_DIA, 0 }
+};
+
+static void apply_speed_level(const x264_param_t *pBase, x264_param_t *params, int level) {
+  const struct X264_SPEED_LEVEL *pSpeed = &g_x264_speed[level];
+
+  params->analyse.i_subpel_refine = MIN(pBase->analyse.i_subpel_refine, pSpeed->subme);
+  params->i_frame_reference = MIN(pBase->i_frame_reference, pSpeed->refs);
+  params->analyse.i_me_method = MIN(pBase->analyse.i_me_method, pSpeed->me);
+  params->analyse.inter = pBase->analyse.inter;
+  params->analyse.b_mixed_references = pBase->analyse.b_mixed_references;
+  params->analyse.b_fast_pskip = pBase->analyse.b_fast_pskip;
+
+  if(level > 0) {
+    params->analyse.inter &= pSpeed->inter;
+    params->analyse.b_mixed_references = 0;
+    params->analyse.b_fast_pskip = 1;
+  }
+}
+
+int xcoder_x264_speed(CODEC_WRAP_CTXT_T *pCtxt, unsigned int outidx, int level) {
+  X264_AVCODEC_CTXT_T *pXCtx = NULL;
+  x264_param_t params;
+
+  if(!pCtxt || !(pXCtx = ((X264_AVCODEC_CTXT_T *) pCtxt->pctxt)) || !pXCtx->enc ||
+     level < 0 || level > IXCODE_GOVERNOR_LEVEL_MAX) {
+    return -1;
+  }
+
+  //
+  // pXCtx->params always holds the configured settings, which are the upper bound for
+  // every speed level
+  //
+  memset(&params, 0, sizeof(params));
+  pXCtx->fEncoderParameters(pXCtx->enc, &params);
+  apply_speed_level(&pXCtx->params, &params, level);
+
+  if(pXCtx->fReconfig(pXCtx->enc, &params) != 0) {
+    LOG(X_ERROR("x264 encoder[%d] failed to set speed level %d"), outidx, level);
+    return -1;
+  }
+
+  LOG(X_DEBUG("x264 encoder[%d] speed level %d (%s) subme:%d, refs:%d, me:%d"), outidx, level, 
+              g_x264_speed[level].name, params.analyse.i_subpel_refine, params.i_frame_reference,
+              params.analyse.i_me_method);
+
+  return 0;
+}
+
 static int encode_nals(X264_AVCODEC_CTXT_T *pXCtx, uint8_t *buf, int size,
                        x264_nal_t *nals, int nnal, int skip_sei)
 {